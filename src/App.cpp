@@ -1,6 +1,7 @@
 #include "App.h"
 #include <assert.h>
 #include "imgui.h"
+#include <chrono>
 #include <iostream>
 #include <format>
 #include <stdexcept>
@@ -199,7 +200,9 @@ void App::run()
 	std::cout << std::format("Platform: {}, Renderer: {}\n", m_window->GetPlatformName(), m_renderer->GetRendererName());
 
 	// Initialize Graphics Capture API
-	m_graphicsCapture = IGraphicsCapture::Create();
+	// Sessions of the platform backend behind one capture, so several sources
+	// can be combined into one stream
+	m_graphicsCapture = std::make_unique<CompositeGraphicsCapture>();
 	if (m_graphicsCapture && m_graphicsCapture->Initialize())
 	{
 		std::cout << std::format("Graphics Capture API ({}) initialized successfully!\n", m_graphicsCapture->GetPlatformName());
@@ -218,6 +221,15 @@ void App::run()
 		// Set up frame callback
 		m_graphicsCapture->SetFrameCallback([this](const FrameData &frame)
 											{ this->OnFrameArrived(frame); });
+		m_graphicsCapture->SetCursorCallback([this](const CursorState &cursor)
+											 {
+			m_cursorUpdates.fetch_add(1, std::memory_order_relaxed);
+			const uint64_t position = cursor.visible ? (static_cast<uint64_t>(static_cast<uint32_t>(cursor.x)) << 32) | static_cast<uint32_t>(cursor.y) : UINT64_MAX;
+			m_cursorPosition.store(position, std::memory_order_relaxed); });
+
+		// Monitor and window lists are enumerated in the background, not per UI frame
+		m_sourceRegistry = std::make_unique<SourceRegistry>(*m_graphicsCapture);
+		m_sourceRegistry->Start();
 	}
 	else
 	{
@@ -270,7 +282,82 @@ void App::RenderUI()
 			ImGui::Text("Statistics:");
 			ImGui::Text("  Frames Captured: %llu", stats.framesCapture);
 			ImGui::Text("  Frames Dropped: %llu", stats.framesDropped);
+			ImGui::Text("  Frames Overwritten: %llu", stats.framesOverwritten);
+			ImGui::Text("  Frames Decimated: %llu", stats.framesDecimated);
+			ImGui::Text("  Frames Duplicate: %llu", stats.framesDuplicate);
 			ImGui::Text("  Average FPS: %.1f", stats.averageFps);
+			ImGui::Text("  Frame Jitter: %.2f ms", stats.frameJitterMs);
+			ImGui::Text("  CPU Usage: %.1f%%", stats.cpuUsage);
+			ImGui::Text("  Memory Usage: %.1f MB", stats.memoryUsage / (1024.0 * 1024.0));
+			if (m_graphicsCapture->GetCaptureConfig().cursorMode == CursorMode::Metadata)
+			{
+				const uint64_t position = m_cursorPosition.load(std::memory_order_relaxed);
+				if (position == UINT64_MAX)
+					ImGui::Text("  Cursor Updates: %llu (hidden)", m_cursorUpdates.load(std::memory_order_relaxed));
+				else
+					ImGui::Text("  Cursor Updates: %llu (%d, %d)", m_cursorUpdates.load(std::memory_order_relaxed),
+								static_cast<int>(position >> 32), static_cast<int>(position & 0xFFFFFFFF));
+			}
+
+			ImGui::Spacing();
+			ImGui::Text("Latency (ms):");
+			if (ImGui::BeginTable("Latency", 5, ImGuiTableFlags_Borders | ImGuiTableFlags_SizingFixedFit))
+			{
+				ImGui::TableSetupColumn("Stage");
+				ImGui::TableSetupColumn("p50");
+				ImGui::TableSetupColumn("p95");
+				ImGui::TableSetupColumn("p99");
+				ImGui::TableSetupColumn("max");
+				ImGui::TableHeadersRow();
+
+				auto latencyRow = [](const char *stage, const LatencyPercentiles &latency)
+				{
+					ImGui::TableNextRow();
+					ImGui::TableNextColumn();
+					ImGui::TextUnformatted(stage);
+					ImGui::TableNextColumn();
+					ImGui::Text("%.2f", latency.p50Ms);
+					ImGui::TableNextColumn();
+					ImGui::Text("%.2f", latency.p95Ms);
+					ImGui::TableNextColumn();
+					ImGui::Text("%.2f", latency.p99Ms);
+					ImGui::TableNextColumn();
+					ImGui::Text("%.2f", latency.maxMs);
+				};
+				latencyRow("Capture", stats.captureLatency);
+				latencyRow("Queue", stats.queueLatency);
+				latencyRow("Upload", stats.callbackLatency);
+				latencyRow("Total", stats.totalLatency);
+				ImGui::EndTable();
+			}
+
+			// Where the last displayed frame spent its time, stage by stage
+			FrameLatencyBreakdown breakdown;
+			if (FrameTracer::Shared().GetBreakdown(m_lastTraceId.load(std::memory_order_relaxed), breakdown))
+			{
+				ImGui::Spacing();
+				ImGui::Text("Last frame (ms):");
+				if (ImGui::BeginTable("LastFrame", 2, ImGuiTableFlags_Borders | ImGuiTableFlags_SizingFixedFit))
+				{
+					for (size_t i = 1; i < static_cast<size_t>(FrameStage::Count); ++i)
+					{
+						const auto stage = static_cast<FrameStage>(i);
+						if (!breakdown.HasStage(stage))
+							continue;
+						ImGui::TableNextRow();
+						ImGui::TableNextColumn();
+						ImGui::TextUnformatted(FrameLatencyBreakdown::GetStageName(stage));
+						ImGui::TableNextColumn();
+						ImGui::Text("%.2f", breakdown.GetStageMs(stage));
+					}
+					ImGui::TableNextRow();
+					ImGui::TableNextColumn();
+					ImGui::TextUnformatted("Total");
+					ImGui::TableNextColumn();
+					ImGui::Text("%.2f", breakdown.GetTotalMs());
+					ImGui::EndTable();
+				}
+			}
 		}
 		else
 		{
@@ -311,11 +398,16 @@ void App::RenderUI()
 
 			ImGui::Spacing();
 
+			const auto sources = m_sourceRegistry->GetSnapshot();
+			if (ImGui::SmallButton("Refresh Sources"))
+			{
+				m_sourceRegistry->Refresh();
+			}
+
 			// Monitors section
 			if (ImGui::CollapsingHeader("📺 Monitors", ImGuiTreeNodeFlags_DefaultOpen))
 			{
-				auto monitors = m_graphicsCapture->GetMonitors();
-				for (const auto &monitor : monitors)
+				for (const auto &monitor : sources->monitors)
 				{
 					std::string label = monitor.name +
 										(monitor.isPrimary ? " (Primary)" : "") +
@@ -325,12 +417,7 @@ void App::RenderUI()
 
 					if (ImGui::RadioButton(("##monitor_" + monitor.id).c_str(), isSelected))
 					{
-						// Stop current capture if any
-						if (m_graphicsCapture->IsCapturing())
-						{
-							m_graphicsCapture->StopCapture();
-						}
-
+						// Switches sources in place; sessions still needed keep running
 						m_selectedSourceId = monitor.id;
 						m_selectedSourceName = label;
 						m_selectedIsMonitor = true;
@@ -349,15 +436,31 @@ void App::RenderUI()
 										  monitor.x, monitor.y, monitor.dpiScale);
 					}
 				}
+
+				// Every monitor on one canvas, laid out like the desktop
+				if (sources->monitors.size() > 1)
+				{
+					const bool isSelected = m_selectedSourceId == CompositeGraphicsCapture::kAllMonitorsSourceId;
+					if (ImGui::RadioButton("##monitor_all", isSelected))
+					{
+						m_selectedSourceId = CompositeGraphicsCapture::kAllMonitorsSourceId;
+						m_selectedSourceName = std::format("All Monitors ({})", sources->monitors.size());
+						m_selectedIsMonitor = true;
+						std::cout << "Selected all monitors\n";
+
+						m_graphicsCapture->StartCapture(m_selectedSourceId);
+					}
+
+					ImGui::SameLine();
+					ImGui::Text("All Monitors (%d)", static_cast<int>(sources->monitors.size()));
+				}
 			}
 
 			// Windows section
 			if (ImGui::CollapsingHeader("🪟 Applications", ImGuiTreeNodeFlags_DefaultOpen))
 			{
-				auto windows = m_graphicsCapture->GetWindows();
-
 				ImGui::BeginChild("WindowSelection", ImVec2(0, 150), true);
-				for (const auto &window : windows)
+				for (const auto &window : sources->windows)
 				{
 					// Only filter out windows with no title
 					if (!window.title.empty())
@@ -384,12 +487,6 @@ void App::RenderUI()
 
 						if (ImGui::RadioButton(("##window_" + window.id).c_str(), isSelected))
 						{
-							// Stop current capture if any
-							if (m_graphicsCapture->IsCapturing())
-							{
-								m_graphicsCapture->StopCapture();
-							}
-
 							m_selectedSourceId = window.id;
 							m_selectedSourceName = full_label;
 							m_selectedIsMonitor = false;
@@ -425,6 +522,14 @@ void App::RenderUI()
 			if (m_graphicsCapture->IsCapturing())
 			{
 				ImGui::TextColored(ImVec4(0.0f, 1.0f, 0.0f, 1.0f), "● Live Mirror Active");
+
+				// Source resolution, written in the background
+				ImGui::SameLine();
+				if (ImGui::SmallButton("Save Screenshot"))
+				{
+					const auto now = std::chrono::floor<std::chrono::seconds>(std::chrono::system_clock::now());
+					m_graphicsCapture->SaveScreenshot(m_selectedSourceId, std::format("screenshot_{:%Y%m%d_%H%M%S}.png", now));
+				}
 			}
 			else
 			{
@@ -435,17 +540,69 @@ void App::RenderUI()
 			ImGui::Spacing();
 			if (ImGui::CollapsingHeader("Capture Settings"))
 			{
-				auto config = m_graphicsCapture->GetCaptureConfig();
-
-				// Cursor and borders
-				if (ImGui::Checkbox("Include Cursor", &config.includeCursor))
+				// Changing any of these restarts a running capture
+				auto config = m_editedCaptureConfig.value_or(m_graphicsCapture->GetCaptureConfig());
+
+				// Cursor and borders. Metadata keeps the cursor out of the frames
+				// and reports it through the cursor callback.
+				const char *cursorModes[] = {"Hidden", "Embedded", "Metadata"};
+				int cursorMode = static_cast<int>(config.cursorMode);
+				if (ImGui::Combo("Cursor", &cursorMode, cursorModes, IM_ARRAYSIZE(cursorModes)))
 				{
-					m_graphicsCapture->SetCaptureConfig(config);
+					config.cursorMode = static_cast<CursorMode>(cursorMode);
+					ApplyCaptureConfig(config);
 				}
 
 				if (ImGui::Checkbox("Include Borders", &config.includeBorders))
 				{
-					m_graphicsCapture->SetCaptureConfig(config);
+					ApplyCaptureConfig(config);
+				}
+
+				// Delivered size and scaling filter
+				const char *qualities[] = {"Low (720p)", "Medium (1080p)", "High (Native)"};
+				int quality = static_cast<int>(config.quality);
+				if (ImGui::Combo("Quality", &quality, qualities, IM_ARRAYSIZE(qualities)))
+				{
+					config.quality = static_cast<CaptureQuality>(quality);
+					ApplyCaptureConfig(config);
+				}
+
+				// Part of the source to capture in source pixels, 0 size for all
+				// of it; applied when the field is left
+				int region[4] = {config.region.x, config.region.y, config.region.width, config.region.height};
+				if (ImGui::InputInt4("Region (x, y, w, h)", region))
+				{
+					config.region = {region[0], region[1], std::max(region[2], 0), std::max(region[3], 0)};
+					m_editedCaptureConfig = config;
+				}
+				if (ImGui::IsItemDeactivatedAfterEdit())
+				{
+					ApplyCaptureConfig(config);
+				}
+
+				// Tile compare for dirty rects and duplicate frames
+				if (ImGui::Checkbox("Detect Changes", &config.detectChanges))
+				{
+					ApplyCaptureConfig(config);
+				}
+
+				// Worker queue between capture and the frame callback
+				const char *dropPolicies[] = {"Drop Oldest", "Drop Newest", "Block"};
+				int dropPolicy = static_cast<int>(config.dropPolicy);
+				if (ImGui::Combo("Drop Policy", &dropPolicy, dropPolicies, IM_ARRAYSIZE(dropPolicies)))
+				{
+					config.dropPolicy = static_cast<FrameDropPolicy>(dropPolicy);
+					ApplyCaptureConfig(config);
+				}
+
+				// Applied on release
+				if (ImGui::SliderInt("Queue Depth", &config.queueDepth, 1, 8))
+				{
+					m_editedCaptureConfig = config;
+				}
+				if (ImGui::IsItemDeactivatedAfterEdit())
+				{
+					ApplyCaptureConfig(config);
 				}
 
 				// Cursor info
@@ -543,7 +700,13 @@ void App::OnWindowEvent(const WindowEvent &event)
 
 void App::OnFrameArrived(const FrameData &frame)
 {
-	if (!frame.data || frame.size == 0)
+	const BgraView view = frame.GetView();
+	if (view.IsEmpty())
+		return;
+
+	// The texture already shows these pixels
+	if (frame.isDuplicate && m_captureTexture && m_captureTexture->GetWidth() == frame.width &&
+		m_captureTexture->GetHeight() == frame.height)
 		return;
 
 	// Create texture if needed or if size changed
@@ -567,11 +730,38 @@ void App::OnFrameArrived(const FrameData &frame)
 		}
 
 		// Update the texture data
-		bool success = m_captureTexture->Update(frame.data, frame.size, frame.stride);
+		bool success = m_captureTexture->Update(view.data, view.SizeBytes(), view.stride);
 		if (!success)
 		{
 			std::cout << "Failed to update capture texture\n";
 		}
+		else
+		{
+			FrameTracer::Shared().Stamp(frame.traceId, FrameStage::Uploaded);
+			m_lastTraceId.store(frame.traceId, std::memory_order_relaxed);
+		}
+	}
+}
+
+void App::ApplyCaptureConfig(const CaptureConfig& config)
+{
+	m_editedCaptureConfig.reset();
+
+	// A running capture only takes a new frame rate, so anything else stops
+	// it and starts it again on the same source
+	const bool restart = m_graphicsCapture->IsCapturing() &&
+						 !IsFrameRateChangeOnly(m_graphicsCapture->GetCaptureConfig(), config);
+	if (restart)
+	{
+		m_graphicsCapture->StopCapture();
+	}
+	if (!m_graphicsCapture->SetCaptureConfig(config))
+	{
+		std::cout << "Failed to apply capture settings\n";
+	}
+	if (restart && !m_graphicsCapture->StartCapture(m_selectedSourceId))
+	{
+		std::cout << std::format("Failed to restart capture of {}\n", m_selectedSourceName);
 	}
 }
 
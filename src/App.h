@@ -2,9 +2,13 @@
 
 #include <imgui.h>
 #include <stdint.h>
+#include <atomic>
 #include <memory>
+#include <optional>
 #include <string>
 #include "capture/IGraphicsCapture.h"
+#include "capture/composite/CompositeGraphicsCapture.h"
+#include "capture/SourceRegistry.h"
 #include "platform/IWindow.h"
 #include "platform/IRenderer.h"
 #include "platform/ITexture.h"
@@ -29,6 +33,7 @@ private:
 	void RenderUI();
 	void OnFrameArrived(const FrameData& frame);
 	void CreateCaptureTexture(int width, int height);
+	void ApplyCaptureConfig(const CaptureConfig& config);
 	void OnWindowEvent(const WindowEvent& event);
 
 private:
@@ -45,14 +50,24 @@ private:
 	uint32_t m_height = 1080;
 
 	std::unique_ptr<IGraphicsCapture> m_graphicsCapture;
+	// Declared after the capture so it stops before the backend goes away
+	std::unique_ptr<SourceRegistry> m_sourceRegistry;
 	
 	// Capture selection state
 	std::string m_selectedSourceId;
 	std::string m_selectedSourceName;
 	bool m_selectedIsMonitor = false;
+	// Capture Settings while a slider or text field is being dragged or
+	// typed in; applied when it is released, since that may restart capture
+	std::optional<CaptureConfig> m_editedCaptureConfig;
 	
 	// Capture rendering
 	std::unique_ptr<ITexture> m_captureTexture;
+	// Trace of the frame last uploaded, for the per-stage latency readout
+	std::atomic<uint64_t> m_lastTraceId = 0;
+	// Cursor reports (CursorMode::Metadata), packed x/y of the latest one
+	std::atomic<uint64_t> m_cursorUpdates = 0;
+	std::atomic<uint64_t> m_cursorPosition = 0;
 
 
 	std::unique_ptr<ImGuiManager> m_imguiManager;
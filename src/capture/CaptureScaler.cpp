@@ -0,0 +1,104 @@
+#include "CaptureScaler.h"
+#include "../video/ThreadPool.h"
+
+#include <algorithm>
+
+namespace
+{
+	struct QualityProfile
+	{
+		int maxWidth;
+		int maxHeight;
+		ScaleFilter filter;
+	};
+
+	QualityProfile GetProfile(CaptureQuality quality)
+	{
+		switch (quality)
+		{
+		case CaptureQuality::Low:
+			return { 1280, 720, ScaleFilter::Box };
+		case CaptureQuality::Medium:
+			return { 1920, 1080, ScaleFilter::Bilinear };
+		case CaptureQuality::High:
+			return { 0, 0, ScaleFilter::Lanczos3 };
+		}
+		return { 0, 0, ScaleFilter::Bilinear };
+	}
+}
+
+void CaptureScaler::Configure(const CaptureConfig& config)
+{
+	m_config = config;
+	m_scaler = FrameScaler();
+	m_lastOutput.Reset();
+}
+
+ScaleFilter CaptureScaler::GetFilter(CaptureQuality quality)
+{
+	return GetProfile(quality).filter;
+}
+
+void CaptureScaler::GetOutputSize(const CaptureConfig& config, int width, int height, int& outWidth, int& outHeight)
+{
+	if (config.outputWidth > 0 || config.outputHeight > 0)
+	{
+		FrameScaler::FitWithin(width, height, config.outputWidth, config.outputHeight, outWidth, outHeight);
+		return;
+	}
+
+	const QualityProfile profile = GetProfile(config.quality);
+	FrameScaler::FitWithin(width, height, profile.maxWidth, profile.maxHeight, outWidth, outHeight);
+}
+
+void CaptureScaler::Process(FrameData& frame)
+{
+	if (!frame.data || frame.width <= 0 || frame.height <= 0)
+		return;
+
+	int width, height;
+	GetOutputSize(m_config, frame.width, frame.height, width, height);
+	if (width == frame.width && height == frame.height)
+		return;
+
+	const bool sameGeometry = m_scaler.GetSourceWidth() == frame.width && m_scaler.GetSourceHeight() == frame.height &&
+							  m_scaler.GetWidth() == width && m_scaler.GetHeight() == height;
+	if (!sameGeometry)
+		m_scaler.Configure(frame.width, frame.height, width, height, GetFilter(m_config.quality));
+
+	// Same input, same output: hand out the previous result again
+	const int stride = width * 4;
+	FrameBufferHandle buffer;
+	if (frame.isDuplicate && sameGeometry && m_lastOutput)
+	{
+		buffer = m_lastOutput;
+	}
+	else
+	{
+		buffer = m_bufferPool->Acquire(static_cast<size_t>(stride) * height);
+		m_scaler.Scale(frame.GetView(), MutableBgraView(buffer.Data(), width, height, stride), &ThreadPool::Shared());
+		m_lastOutput = buffer;
+	}
+
+	// The filter spreads each changed source pixel over its support
+	m_dirtyRects.clear();
+	for (size_t i = 0; i < frame.dirtyRectCount; ++i)
+	{
+		const FrameRect& rect = frame.dirtyRects[i];
+		int left, right, top, bottom;
+		m_scaler.MapSourceSpan(true, rect.x, rect.x + rect.width, left, right);
+		m_scaler.MapSourceSpan(false, rect.y, rect.y + rect.height, top, bottom);
+		if (right > left && bottom > top)
+			m_dirtyRects.push_back({ left, top, right - left, bottom - top });
+	}
+
+	const bool fullFrame = frame.dirtyRectCount == 0;
+	frame.data = buffer.Data();
+	frame.width = width;
+	frame.height = height;
+	frame.stride = stride;
+	frame.size = static_cast<size_t>(stride) * height;
+	frame.buffer = std::move(buffer);
+	frame.dirtyRects = fullFrame ? nullptr : m_dirtyRects.data();
+	frame.dirtyRectCount = fullFrame ? 0 : m_dirtyRects.size();
+}
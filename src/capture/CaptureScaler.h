@@ -0,0 +1,35 @@
+#pragma once
+
+#include "IGraphicsCapture.h"
+#include "../video/FrameScaler.h"
+
+#include <memory>
+#include <vector>
+
+// Capture pipeline stage that shrinks frames to the size CaptureConfig asks
+// for before they are published, so conversion and encoding only ever see
+// the reduced frame. Runs on the capture thread and spreads the work over
+// the shared ThreadPool in row bands.
+class CaptureScaler
+{
+public:
+	void Configure(const CaptureConfig& config);
+
+	// Replaces `frame` with a scaled copy from the scaler's own pool when the
+	// configuration calls for a different size; otherwise leaves it as is.
+	// Dirty rects are mapped to output coordinates and stay valid until the
+	// next call. Duplicate frames share the previous output without scaling.
+	void Process(FrameData& frame);
+
+	// Output size for a source of width x height under `config`:
+	// outputWidth/outputHeight if set, otherwise the quality's size cap
+	static void GetOutputSize(const CaptureConfig& config, int width, int height, int& outWidth, int& outHeight);
+	static ScaleFilter GetFilter(CaptureQuality quality);
+
+private:
+	CaptureConfig m_config;
+	FrameScaler m_scaler;
+	std::shared_ptr<FrameBufferPool> m_bufferPool = FrameBufferPool::Create();
+	std::vector<FrameRect> m_dirtyRects;
+	FrameBufferHandle m_lastOutput; // Reused for duplicate frames
+};
@@ -0,0 +1,226 @@
+#include "CaptureWorker.h"
+
+#include <algorithm>
+#include <utility>
+
+namespace
+{
+	// Typical damage lists are short; anything longer grows once and stays
+	constexpr size_t kReservedDirtyRects = 64;
+
+	uint64_t ElapsedMicroseconds(CaptureWorker::Clock::time_point from, CaptureWorker::Clock::time_point to)
+	{
+		return static_cast<uint64_t>(std::max<int64_t>(0, std::chrono::duration_cast<std::chrono::microseconds>(to - from).count()));
+	}
+}
+
+CaptureWorker::~CaptureWorker()
+{
+	Stop();
+}
+
+void CaptureWorker::Start(int queueDepth, FrameDropPolicy policy)
+{
+	Stop();
+
+	std::lock_guard lock(m_mutex);
+	m_ring.assign(static_cast<size_t>(std::max(queueDepth, 1)), Slot{});
+	for (auto& slot : m_ring)
+		slot.dirtyRects.reserve(kReservedDirtyRects);
+	m_rejected.dirtyRects.reserve(kReservedDirtyRects);
+	m_hasRejected = false;
+	m_head = 0;
+	m_count = 0;
+	m_policy = policy;
+	m_running = true;
+
+	m_captureLatency.Reset();
+	m_queueLatency.Reset();
+	m_callbackLatency.Reset();
+	m_totalLatency.Reset();
+	m_thread = std::thread(&CaptureWorker::WorkerThread, this);
+}
+
+void CaptureWorker::Stop()
+{
+	{
+		std::lock_guard lock(m_mutex);
+		m_running = false;
+	}
+	m_notEmpty.notify_all();
+	m_notFull.notify_all();
+
+	if (m_thread.joinable())
+		m_thread.join();
+
+	std::lock_guard lock(m_mutex);
+	for (auto& slot : m_ring)
+		slot.frame = {};
+	m_head = 0;
+	m_count = 0;
+	m_hasRejected = false;
+}
+
+void CaptureWorker::SetCallback(const FrameCallback& callback)
+{
+	std::lock_guard lock(m_callbackMutex);
+	m_callback = callback;
+}
+
+int CaptureWorker::GetQueueDepth() const
+{
+	std::lock_guard lock(m_mutex);
+	return static_cast<int>(m_count);
+}
+
+void CaptureWorker::FillStatistics(CaptureStatistics& statistics) const
+{
+	statistics.framesDropped = GetDroppedCount();
+	statistics.captureLatency = m_captureLatency.Summarize();
+	statistics.queueLatency = m_queueLatency.Summarize();
+	statistics.callbackLatency = m_callbackLatency.Summarize();
+	statistics.totalLatency = m_totalLatency.Summarize();
+}
+
+void CaptureWorker::StoreDirtyRects(Slot& slot, const FrameData& frame)
+{
+	slot.fullFrame = frame.dirtyRectCount == 0 && !frame.isDuplicate;
+	slot.dirtyRects.assign(frame.dirtyRects, frame.dirtyRects + frame.dirtyRectCount);
+}
+
+void CaptureWorker::MergeDirtyRects(Slot& into, bool fullFrame, const FrameRect* rects, size_t count)
+{
+	// A duplicate of a frame the consumer never saw is not a duplicate to it
+	if (fullFrame || count > 0)
+		into.frame.isDuplicate = false;
+
+	if (into.fullFrame || fullFrame)
+	{
+		into.fullFrame = true;
+		into.dirtyRects.clear();
+		return;
+	}
+	into.dirtyRects.insert(into.dirtyRects.end(), rects, rects + count);
+}
+
+void CaptureWorker::MergeDirtyRects(Slot& into, const Slot& from)
+{
+	MergeDirtyRects(into, from.fullFrame, from.dirtyRects.data(), from.dirtyRects.size());
+}
+
+bool CaptureWorker::Push(const FrameData& frame, Clock::time_point arrival)
+{
+	const auto queued = Clock::now();
+	m_captureLatency.Record(ElapsedMicroseconds(arrival, queued));
+	FrameTracer::Shared().Stamp(frame.traceId, FrameStage::Queued, FrameClock::FromTimePoint(queued));
+
+	std::unique_lock lock(m_mutex);
+	if (!m_running)
+		return false;
+
+	const size_t capacity = m_ring.size();
+	if (m_count == capacity)
+	{
+		switch (m_policy)
+		{
+		case FrameDropPolicy::DropNewest:
+		{
+			// Keep what is queued; remember what this frame changed
+			if (m_hasRejected)
+				MergeDirtyRects(m_rejected, frame.dirtyRectCount == 0 && !frame.isDuplicate, frame.dirtyRects, frame.dirtyRectCount);
+			else
+				StoreDirtyRects(m_rejected, frame);
+			m_hasRejected = true;
+			m_dropped.fetch_add(1, std::memory_order_relaxed);
+			return false;
+		}
+
+		case FrameDropPolicy::DropOldest:
+		{
+			Slot& oldest = m_ring[m_head];
+			oldest.frame = {};
+			m_head = (m_head + 1) % capacity;
+			--m_count;
+
+			// Its changes carry over to whichever frame now comes next
+			if (m_count > 0)
+				MergeDirtyRects(m_ring[m_head], oldest);
+			else if (m_hasRejected)
+				MergeDirtyRects(m_rejected, oldest);
+			else
+			{
+				std::swap(m_rejected.dirtyRects, oldest.dirtyRects);
+				m_rejected.fullFrame = oldest.fullFrame;
+				m_hasRejected = true;
+			}
+			m_dropped.fetch_add(1, std::memory_order_relaxed);
+			break;
+		}
+
+		case FrameDropPolicy::Block:
+			m_notFull.wait(lock, [this, capacity] { return m_count < capacity || !m_running; });
+			if (!m_running)
+				return false;
+			break;
+		}
+	}
+
+	Slot& slot = m_ring[(m_head + m_count) % capacity];
+	slot.frame = frame;
+	slot.arrival = arrival;
+	slot.queued = queued;
+	StoreDirtyRects(slot, frame);
+	if (m_hasRejected)
+	{
+		MergeDirtyRects(slot, m_rejected);
+		m_rejected.dirtyRects.clear();
+		m_hasRejected = false;
+	}
+	++m_count;
+
+	lock.unlock();
+	m_notEmpty.notify_one();
+	return true;
+}
+
+void CaptureWorker::WorkerThread()
+{
+	Slot current;
+	current.dirtyRects.reserve(kReservedDirtyRects);
+
+	while (true)
+	{
+		{
+			std::unique_lock lock(m_mutex);
+			m_notEmpty.wait(lock, [this] { return m_count > 0 || !m_running; });
+			if (!m_running)
+				break;
+
+			// Swapping keeps each slot's rect storage in circulation, no allocation
+			std::swap(current, m_ring[m_head]);
+			m_head = (m_head + 1) % m_ring.size();
+			--m_count;
+		}
+		m_notFull.notify_one();
+
+		current.frame.dirtyRects = current.fullFrame ? nullptr : current.dirtyRects.data();
+		current.frame.dirtyRectCount = current.fullFrame ? 0 : current.dirtyRects.size();
+
+		const auto callbackStart = Clock::now();
+		FrameTracer::Shared().Stamp(current.frame.traceId, FrameStage::Delivered, FrameClock::FromTimePoint(callbackStart));
+		{
+			std::lock_guard lock(m_callbackMutex);
+			if (m_callback)
+				m_callback(current.frame);
+		}
+		const auto callbackEnd = Clock::now();
+		m_delivered.fetch_add(1, std::memory_order_relaxed);
+
+		m_queueLatency.Record(ElapsedMicroseconds(current.queued, callbackStart));
+		m_callbackLatency.Record(ElapsedMicroseconds(callbackStart, callbackEnd));
+		m_totalLatency.Record(ElapsedMicroseconds(current.arrival, callbackEnd));
+
+		// Release the buffer now rather than when this slot comes around again
+		current.frame = {};
+	}
+}
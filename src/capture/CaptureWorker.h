@@ -0,0 +1,90 @@
+#pragma once
+
+#include "IGraphicsCapture.h"
+#include "LatencyHistogram.h"
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// Pipeline stage that decouples frame consumers from the capture thread.
+// Backends push every captured frame; the worker thread invokes the frame
+// callback. The queue between them is bounded and never allocates once
+// started; what happens when it is full is set by FrameDropPolicy.
+class CaptureWorker
+{
+public:
+	using Clock = std::chrono::steady_clock;
+
+	CaptureWorker() = default;
+	~CaptureWorker();
+
+	CaptureWorker(const CaptureWorker&) = delete;
+	CaptureWorker& operator=(const CaptureWorker&) = delete;
+
+	void Start(int queueDepth, FrameDropPolicy policy);
+	// Discards queued frames and releases a producer blocked in Push()
+	void Stop();
+
+	void SetCallback(const FrameCallback& callback);
+
+	// Called on the capture thread. `arrival` is when the backend first saw the
+	// frame, so grab and readback time count towards its latency. Returns false
+	// if this frame was dropped.
+	bool Push(const FrameData& frame, Clock::time_point arrival);
+
+	uint64_t GetDroppedCount() const { return m_dropped.load(std::memory_order_relaxed); }
+	uint64_t GetDeliveredCount() const { return m_delivered.load(std::memory_order_relaxed); }
+	int GetQueueDepth() const;
+
+	// Drop counts and per-stage latency percentiles since Start()
+	void FillStatistics(CaptureStatistics& statistics) const;
+
+private:
+	// Queued frames own a copy of their dirty rects; the producer's storage is
+	// reused as soon as Push() returns.
+	struct Slot
+	{
+		FrameData frame;
+		std::vector<FrameRect> dirtyRects;
+		bool fullFrame = true;
+		Clock::time_point arrival;
+		Clock::time_point queued;
+	};
+
+	static void StoreDirtyRects(Slot& slot, const FrameData& frame);
+	static void MergeDirtyRects(Slot& into, bool fullFrame, const FrameRect* rects, size_t count);
+	static void MergeDirtyRects(Slot& into, const Slot& from);
+
+	void WorkerThread();
+
+	mutable std::mutex m_mutex;
+	std::condition_variable m_notEmpty;
+	std::condition_variable m_notFull;
+	std::vector<Slot> m_ring;
+	size_t m_head = 0;
+	size_t m_count = 0;
+	FrameDropPolicy m_policy = FrameDropPolicy::DropOldest;
+	bool m_running = false;
+
+	// Changes that belong to frames rejected under DropNewest; folded into the
+	// next accepted frame so consumers relying on dirty rects miss nothing.
+	Slot m_rejected;
+	bool m_hasRejected = false;
+
+	std::mutex m_callbackMutex;
+	FrameCallback m_callback;
+
+	std::thread m_thread;
+	std::atomic<uint64_t> m_dropped = 0;
+	std::atomic<uint64_t> m_delivered = 0;
+
+	LatencyHistogram m_captureLatency;
+	LatencyHistogram m_queueLatency;
+	LatencyHistogram m_callbackLatency;
+	LatencyHistogram m_totalLatency;
+};
@@ -0,0 +1,191 @@
+#include "CursorTracker.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+
+CursorTracker::~CursorTracker()
+{
+	Stop();
+}
+
+void CursorTracker::Start(int rateHz, const CursorSampler& sampler, const CursorShapeReader& shapeReader, bool notify)
+{
+	Stop();
+
+	m_sampler = sampler;
+	m_shapeReader = shapeReader;
+	m_notify = notify;
+	m_shapes.clear();
+	m_shapeKey = 0;
+	m_shape.reset();
+	m_updates.store(0, std::memory_order_relaxed);
+	{
+		std::lock_guard lock(m_mutex);
+		m_stopping = false;
+		m_sourceState = {};
+	}
+	m_thread = std::thread(&CursorTracker::TrackerThread, this, std::clamp(rateHz, 1, 1000));
+}
+
+void CursorTracker::Stop()
+{
+	{
+		std::lock_guard lock(m_mutex);
+		m_stopping = true;
+	}
+	m_wake.notify_all();
+
+	if (m_thread.joinable())
+		m_thread.join();
+
+	std::lock_guard lock(m_mutex);
+	m_sourceState = {};
+}
+
+void CursorTracker::SetCallback(const CursorCallback& callback)
+{
+	std::lock_guard lock(m_callbackMutex);
+	m_callback = callback;
+}
+
+void CursorTracker::SetFrameGeometry(int sourceWidth, int sourceHeight, int frameWidth, int frameHeight)
+{
+	std::lock_guard lock(m_mutex);
+	m_sourceWidth = sourceWidth;
+	m_sourceHeight = sourceHeight;
+	m_frameWidth = frameWidth;
+	m_frameHeight = frameHeight;
+}
+
+CursorState CursorTracker::GetState() const
+{
+	std::lock_guard lock(m_mutex);
+	return MapToFrame(m_sourceState);
+}
+
+CursorState CursorTracker::GetSourceState() const
+{
+	std::lock_guard lock(m_mutex);
+	return m_sourceState;
+}
+
+CursorState CursorTracker::MapToFrame(const CursorState& source) const
+{
+	CursorState state = source;
+	if (m_sourceWidth > 0 && m_sourceHeight > 0 && m_frameWidth > 0 && m_frameHeight > 0 &&
+		(m_sourceWidth != m_frameWidth || m_sourceHeight != m_frameHeight))
+	{
+		const double scaleX = static_cast<double>(m_frameWidth) / m_sourceWidth;
+		const double scaleY = static_cast<double>(m_frameHeight) / m_sourceHeight;
+		state.x = static_cast<int>(std::floor(source.x * scaleX));
+		state.y = static_cast<int>(std::floor(source.y * scaleY));
+		state.scale = static_cast<float>(scaleX);
+	}
+	return state;
+}
+
+uint64_t CursorTracker::HashShape(const CursorShape& shape)
+{
+	// FNV-1a over whole pixels; cursors are a few thousand of them at most
+	uint64_t hash = 0xcbf29ce484222325ull;
+	auto mix = [&hash](uint64_t value) {
+		hash ^= value;
+		hash *= 0x100000001b3ull;
+	};
+	mix(static_cast<uint64_t>(shape.width) << 32 | static_cast<uint32_t>(shape.height));
+	mix(static_cast<uint64_t>(shape.hotspotX) << 32 | static_cast<uint32_t>(shape.hotspotY));
+	for (uint32_t pixel : shape.pixels)
+		mix(pixel);
+	return hash ? hash : 1;
+}
+
+std::shared_ptr<const CursorShape> CursorTracker::LookupShape(uint64_t shapeKey)
+{
+	if (m_shape && shapeKey == m_shapeKey)
+		return m_shape;
+
+	auto shape = std::make_shared<CursorShape>();
+	if (!m_shapeReader || !m_shapeReader(*shape) || shape->width <= 0 || shape->height <= 0 ||
+		shape->pixels.size() != static_cast<size_t>(shape->width) * shape->height)
+		return nullptr;
+	shape->hash = HashShape(*shape);
+
+	// Backends hand out new keys for old shapes (cursor handles are recreated,
+	// X serials only grow); the hash maps them back to the object consumers know
+	auto cached = std::find_if(m_shapes.begin(), m_shapes.end(),
+							   [&](const std::shared_ptr<const CursorShape>& entry) { return entry->hash == shape->hash; });
+	std::shared_ptr<const CursorShape> result;
+	if (cached != m_shapes.end())
+	{
+		result = *cached;
+		m_shapes.erase(cached);
+	}
+	else
+	{
+		result = std::move(shape);
+		if (m_shapes.size() >= kShapeCacheSize)
+			m_shapes.erase(m_shapes.begin());
+	}
+	m_shapes.push_back(result);
+
+	m_shapeKey = shapeKey;
+	m_shape = result;
+	return result;
+}
+
+void CursorTracker::TrackerThread(int rateHz)
+{
+	using Clock = std::chrono::steady_clock;
+	const auto period = std::chrono::nanoseconds(1'000'000'000LL / rateHz);
+	auto deadline = Clock::now();
+
+	while (true)
+	{
+		CursorSample sample;
+		const bool sampled = m_sampler && m_sampler(sample);
+		const uint64_t now = FrameClock::Now();
+
+		CursorState next;
+		next.timestampNs = now;
+		if (sampled && sample.visible)
+		{
+			next.shape = LookupShape(sample.shapeKey);
+			next.visible = next.shape != nullptr;
+			next.x = sample.x;
+			next.y = sample.y;
+		}
+
+		CursorState report;
+		bool changed = false;
+		{
+			std::unique_lock lock(m_mutex);
+			const CursorState& current = m_sourceState;
+			changed = next.visible != current.visible ||
+					  (next.visible && (next.x != current.x || next.y != current.y || next.shape != current.shape));
+			if (changed)
+			{
+				m_sourceState = next;
+				report = MapToFrame(next);
+			}
+
+			deadline += period;
+			const auto wakeAt = Clock::now();
+			if (wakeAt - deadline > period)
+				deadline = wakeAt; // Fell behind: resync rather than burst
+			if (m_wake.wait_until(lock, deadline, [this] { return m_stopping; }))
+				return;
+		}
+
+		if (changed)
+		{
+			m_updates.fetch_add(1, std::memory_order_release);
+			if (m_notify)
+			{
+				std::lock_guard lock(m_callbackMutex);
+				if (m_callback)
+					m_callback(report);
+			}
+		}
+	}
+}
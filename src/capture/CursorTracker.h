@@ -0,0 +1,95 @@
+#pragma once
+
+#include "IGraphicsCapture.h"
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// One reading of the backend's cursor, in source pixels
+struct CursorSample
+{
+	bool visible = false;
+	int x = 0; // Hotspot position relative to the captured area
+	int y = 0;
+	uint64_t shapeKey = 0; // Changes whenever the shape does (X cursor serial, HCURSOR)
+};
+
+// Backend hooks, both called on the tracker thread. The sampler runs at the
+// tracking rate and should be cheap; the shape reader only runs when the
+// sample's shapeKey is one the tracker has not seen.
+using CursorSampler = std::function<bool(CursorSample& outSample)>;
+using CursorShapeReader = std::function<bool(CursorShape& outShape)>;
+
+// Follows the cursor on a thread of its own, independent of frame capture,
+// so cursor motion reaches consumers at a steady rate without producing
+// video frames. Shapes are hashed and cached: a shape seen before is handed
+// out as the same shared object, so consumers can send or upload each one
+// once. Positions are reported in delivered-frame pixels.
+class CursorTracker
+{
+public:
+	// Distinct shapes kept before the least recently used is dropped
+	static constexpr size_t kShapeCacheSize = 32;
+
+	CursorTracker() = default;
+	~CursorTracker();
+
+	CursorTracker(const CursorTracker&) = delete;
+	CursorTracker& operator=(const CursorTracker&) = delete;
+
+	// `notify` sends changes to the cursor callback; without it the tracker
+	// only keeps GetState() current (e.g. for a backend drawing the cursor)
+	void Start(int rateHz, const CursorSampler& sampler, const CursorShapeReader& shapeReader, bool notify);
+	void Stop();
+	bool IsRunning() const { return m_thread.joinable(); }
+
+	void SetCallback(const CursorCallback& callback);
+
+	// Capture thread: frame size before and after scaling, to map positions
+	// from source to delivered-frame pixels
+	void SetFrameGeometry(int sourceWidth, int sourceHeight, int frameWidth, int frameHeight);
+
+	// Latest state in delivered-frame pixels, or in source pixels (scale 1)
+	CursorState GetState() const;
+	CursorState GetSourceState() const;
+
+	// Changes seen since Start(); cheap to poll for "did the cursor change"
+	uint64_t GetUpdateCount() const { return m_updates.load(std::memory_order_acquire); }
+
+	static uint64_t HashShape(const CursorShape& shape);
+
+private:
+	std::shared_ptr<const CursorShape> LookupShape(uint64_t shapeKey);
+	CursorState MapToFrame(const CursorState& source) const;
+	void TrackerThread(int rateHz);
+
+	CursorSampler m_sampler;
+	CursorShapeReader m_shapeReader;
+	bool m_notify = false;
+
+	mutable std::mutex m_mutex;
+	std::condition_variable m_wake;
+	bool m_stopping = false;
+	CursorState m_sourceState;
+	int m_sourceWidth = 0;
+	int m_sourceHeight = 0;
+	int m_frameWidth = 0;
+	int m_frameHeight = 0;
+	std::thread m_thread;
+	std::atomic<uint64_t> m_updates = 0;
+
+	std::mutex m_callbackMutex;
+	CursorCallback m_callback;
+
+	// Tracker thread only: shapes by hash (most recently used last) and the
+	// shape behind the current backend key
+	std::vector<std::shared_ptr<const CursorShape>> m_shapes;
+	uint64_t m_shapeKey = 0;
+	std::shared_ptr<const CursorShape> m_shape;
+};
@@ -0,0 +1,167 @@
+#include "FrameBufferPool.h"
+
+#include <bit>
+#include <new>
+
+FrameBufferHandle::FrameBufferHandle(const FrameBufferHandle& other) noexcept
+	: m_buffer(other.m_buffer)
+{
+	if (m_buffer)
+		m_buffer->refCount.fetch_add(1, std::memory_order_relaxed);
+}
+
+FrameBufferHandle::FrameBufferHandle(FrameBufferHandle&& other) noexcept
+	: m_buffer(other.m_buffer)
+{
+	other.m_buffer = nullptr;
+}
+
+FrameBufferHandle& FrameBufferHandle::operator=(const FrameBufferHandle& other) noexcept
+{
+	if (this != &other)
+	{
+		if (other.m_buffer)
+			other.m_buffer->refCount.fetch_add(1, std::memory_order_relaxed);
+		Reset();
+		m_buffer = other.m_buffer;
+	}
+	return *this;
+}
+
+FrameBufferHandle& FrameBufferHandle::operator=(FrameBufferHandle&& other) noexcept
+{
+	if (this != &other)
+	{
+		Reset();
+		m_buffer = other.m_buffer;
+		other.m_buffer = nullptr;
+	}
+	return *this;
+}
+
+void FrameBufferHandle::Reset() noexcept
+{
+	FrameBuffer* buffer = m_buffer;
+	m_buffer = nullptr;
+
+	if (buffer && buffer->refCount.fetch_sub(1, std::memory_order_acq_rel) == 1)
+	{
+		// Move the pool reference out first: if it is the last one, the pool is
+		// destroyed after Recycle returns, not while it is still running.
+		auto pool = std::move(buffer->pool);
+		pool->Recycle(buffer);
+	}
+}
+
+std::shared_ptr<FrameBufferPool> FrameBufferPool::Create()
+{
+	return std::shared_ptr<FrameBufferPool>(new FrameBufferPool());
+}
+
+FrameBufferPool::~FrameBufferPool()
+{
+	Trim();
+}
+
+int FrameBufferPool::GetBucket(size_t size)
+{
+	if (size <= kMinimumSize)
+		size = kMinimumSize;
+
+	// 2^k < size <= 2^(k+1); pick the smallest of 2^k * {1.25, 1.5, 1.75, 2} that fits
+	const int k = static_cast<int>(std::bit_width(size - 1)) - 1;
+	const size_t base = size_t(1) << k;
+	const size_t step = base / kStepsPerPowerOfTwo;
+	const size_t j = (size - base + step - 1) / step;
+	return k * kStepsPerPowerOfTwo + static_cast<int>(j);
+}
+
+size_t FrameBufferPool::GetBucketSize(int bucket)
+{
+	const int k = bucket / kStepsPerPowerOfTwo;
+	const size_t base = size_t(1) << k;
+	return base + (bucket % kStepsPerPowerOfTwo) * (base / kStepsPerPowerOfTwo);
+}
+
+FrameBufferHandle FrameBufferPool::Acquire(size_t size)
+{
+	const int bucket = GetBucket(size);
+	FrameBuffer* buffer = nullptr;
+
+	{
+		std::lock_guard lock(m_mutex);
+		buffer = m_freeLists[bucket];
+		if (buffer)
+		{
+			m_freeLists[bucket] = buffer->next;
+			m_stats.idleBytes -= buffer->capacity;
+		}
+		else
+		{
+			++m_stats.allocations;
+			m_stats.totalBytes += GetBucketSize(bucket);
+		}
+		++m_stats.acquisitions;
+		++m_stats.outstanding;
+	}
+
+	if (!buffer)
+	{
+		buffer = new FrameBuffer();
+		buffer->capacity = GetBucketSize(bucket);
+		buffer->bucket = bucket;
+		buffer->data = static_cast<uint8_t*>(::operator new(buffer->capacity, std::align_val_t(kAlignment)));
+	}
+
+	buffer->next = nullptr;
+	buffer->size = size;
+	buffer->refCount.store(1, std::memory_order_relaxed);
+	buffer->pool = shared_from_this();
+	return FrameBufferHandle(buffer);
+}
+
+void FrameBufferPool::Recycle(FrameBuffer* buffer)
+{
+	std::lock_guard lock(m_mutex);
+	buffer->next = m_freeLists[buffer->bucket];
+	m_freeLists[buffer->bucket] = buffer;
+	m_stats.idleBytes += buffer->capacity;
+	--m_stats.outstanding;
+}
+
+void FrameBufferPool::Free(FrameBuffer* buffer)
+{
+	::operator delete(buffer->data, std::align_val_t(kAlignment));
+	delete buffer;
+}
+
+void FrameBufferPool::Trim()
+{
+	FrameBuffer* idle[kBucketCount];
+	{
+		std::lock_guard lock(m_mutex);
+		for (int i = 0; i < kBucketCount; ++i)
+		{
+			idle[i] = m_freeLists[i];
+			m_freeLists[i] = nullptr;
+		}
+		m_stats.totalBytes -= m_stats.idleBytes;
+		m_stats.idleBytes = 0;
+	}
+
+	for (FrameBuffer* head : idle)
+	{
+		while (head)
+		{
+			FrameBuffer* next = head->next;
+			Free(head);
+			head = next;
+		}
+	}
+}
+
+FrameBufferPoolStats FrameBufferPool::GetStats() const
+{
+	std::lock_guard lock(m_mutex);
+	return m_stats;
+}
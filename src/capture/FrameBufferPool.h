@@ -0,0 +1,101 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+
+class FrameBufferPool;
+
+// Pixel storage handed out by FrameBufferPool. Never used directly; the
+// FrameBufferHandle below manages its reference count.
+struct FrameBuffer
+{
+	uint8_t* data = nullptr;
+	size_t capacity = 0;
+	size_t size = 0;
+	int bucket = 0;
+	std::atomic<uint32_t> refCount = 0;
+	FrameBuffer* next = nullptr;				// Free-list link while idle
+	std::shared_ptr<FrameBufferPool> pool;		// Keeps the pool alive while checked out
+};
+
+// Ref-counted reference to a pooled buffer. Copying a handle shares the pixels
+// (no memcpy); when the last handle goes away the buffer returns to its pool.
+class FrameBufferHandle
+{
+public:
+	FrameBufferHandle() = default;
+	FrameBufferHandle(const FrameBufferHandle& other) noexcept;
+	FrameBufferHandle(FrameBufferHandle&& other) noexcept;
+	FrameBufferHandle& operator=(const FrameBufferHandle& other) noexcept;
+	FrameBufferHandle& operator=(FrameBufferHandle&& other) noexcept;
+	~FrameBufferHandle() { Reset(); }
+
+	void Reset() noexcept;
+
+	uint8_t* Data() const { return m_buffer ? m_buffer->data : nullptr; }
+	size_t Size() const { return m_buffer ? m_buffer->size : 0; }
+	size_t Capacity() const { return m_buffer ? m_buffer->capacity : 0; }
+
+	// True when this is the only reference, i.e. the pixels may be modified in place
+	bool IsUnique() const { return m_buffer && m_buffer->refCount.load(std::memory_order_acquire) == 1; }
+	uint32_t UseCount() const { return m_buffer ? m_buffer->refCount.load(std::memory_order_relaxed) : 0; }
+
+	explicit operator bool() const { return m_buffer != nullptr; }
+
+private:
+	friend class FrameBufferPool;
+	explicit FrameBufferHandle(FrameBuffer* buffer) noexcept : m_buffer(buffer) {}
+
+	FrameBuffer* m_buffer = nullptr;
+};
+
+struct FrameBufferPoolStats
+{
+	uint64_t allocations = 0;	// Buffers ever allocated from the system
+	uint64_t acquisitions = 0;	// Acquire() calls served
+	uint64_t outstanding = 0;	// Buffers currently checked out
+	uint64_t idleBytes = 0;		// Memory parked in free lists
+	uint64_t totalBytes = 0;	// All memory owned by the pool
+};
+
+// Size-bucketed recycling allocator for frame pixels. Sizes are rounded up to
+// one of four steps per power of two (at most 25% slack), so a stream of
+// frames of the same resolution reuses the same few buffers and steady-state
+// capture never touches the system allocator.
+class FrameBufferPool : public std::enable_shared_from_this<FrameBufferPool>
+{
+public:
+	static constexpr size_t kAlignment = 64;
+
+	static std::shared_ptr<FrameBufferPool> Create();
+	~FrameBufferPool();
+
+	// Contents of the returned buffer are unspecified
+	FrameBufferHandle Acquire(size_t size);
+
+	// Releases idle buffers back to the system
+	void Trim();
+
+	FrameBufferPoolStats GetStats() const;
+
+private:
+	FrameBufferPool() = default;
+	friend class FrameBufferHandle;
+
+	static constexpr int kStepsPerPowerOfTwo = 4;
+	static constexpr int kBucketCount = 64 * kStepsPerPowerOfTwo;
+	static constexpr size_t kMinimumSize = 4096;
+
+	static int GetBucket(size_t size);
+	static size_t GetBucketSize(int bucket);
+
+	void Recycle(FrameBuffer* buffer);
+	static void Free(FrameBuffer* buffer);
+
+	mutable std::mutex m_mutex;
+	FrameBuffer* m_freeLists[kBucketCount] = {};
+	FrameBufferPoolStats m_stats;
+};
@@ -0,0 +1,132 @@
+#include "FrameBufferRing.h"
+
+#include <algorithm>
+#include <cstring>
+
+uint8_t* FrameBufferRing::Begin(int stride, int height, bool preserveContents)
+{
+	if (stride != m_stride || height != m_height)
+	{
+		m_slots.clear();
+		m_stride = stride;
+		m_height = height;
+	}
+
+	// The newest frame's own buffer when nobody took it, else the most
+	// recently used one that was given back, which is likely the least stale
+	const size_t size = static_cast<size_t>(stride) * height;
+	const bool hasCurrent = !m_slots.empty();
+	size_t target = m_slots.size();
+	if (hasCurrent && m_slots[m_current].buffer.IsUnique())
+		target = m_current;
+	for (size_t i = 0; i < m_slots.size() && target != m_current; ++i)
+	{
+		if (m_slots[i].buffer.IsUnique() && (target == m_slots.size() || m_slots[i].lastUsed > m_slots[target].lastUsed))
+			target = i;
+	}
+
+	if (target == m_slots.size())
+	{
+		if (m_slots.size() == kMaxSlots)
+		{
+			// Every buffer is still out: drop the oldest, its holders keep it alive
+			target = std::min_element(m_slots.begin(), m_slots.end(), [](const Slot& a, const Slot& b) {
+				return a.lastUsed < b.lastUsed;
+			}) - m_slots.begin();
+			m_slots[target] = Slot();
+		}
+		else
+		{
+			m_slots.emplace_back();
+		}
+		m_slots[target].buffer = m_pool->Acquire(size);
+	}
+
+	Slot& slot = m_slots[target];
+	if (preserveContents && hasCurrent && target != m_current)
+	{
+		const uint8_t* source = m_slots[m_current].buffer.Data();
+		uint8_t* destination = slot.buffer.Data();
+		if (slot.wholeStale)
+		{
+			std::memcpy(destination, source, size);
+			m_copiedBytes += size;
+		}
+		else
+		{
+			std::sort(slot.staleRows.begin(), slot.staleRows.end());
+			int copiedTo = 0; // Overlapping bands are copied once
+			for (auto [top, bottom] : slot.staleRows)
+			{
+				top = std::max(top, copiedTo);
+				if (top >= bottom)
+					continue;
+				const size_t offset = static_cast<size_t>(top) * stride;
+				const size_t bytes = static_cast<size_t>(bottom - top) * stride;
+				std::memcpy(destination + offset, source + offset, bytes);
+				m_copiedBytes += bytes;
+				copiedTo = bottom;
+			}
+		}
+	}
+	slot.staleRows.clear();
+	slot.wholeStale = false;
+	slot.lastUsed = ++m_frameCount;
+	m_current = target;
+
+	if (!preserveContents)
+		MarkChanged(0, height);
+	return slot.buffer.Data();
+}
+
+void FrameBufferRing::MarkChanged(int top, int bottom)
+{
+	top = std::max(top, 0);
+	bottom = std::min(bottom, m_height);
+	if (top >= bottom)
+		return;
+
+	for (size_t i = 0; i < m_slots.size(); ++i)
+	{
+		if (i != m_current)
+			MarkStale(m_slots[i], top, bottom);
+	}
+}
+
+void FrameBufferRing::MarkStale(Slot& slot, int top, int bottom)
+{
+	if (slot.wholeStale)
+		return;
+	if (top == 0 && bottom == m_height)
+	{
+		slot.wholeStale = true;
+		slot.staleRows.clear();
+		return;
+	}
+
+	slot.staleRows.emplace_back(top, bottom);
+	if (slot.staleRows.size() > kMaxBands)
+	{
+		int first = m_height;
+		int last = 0;
+		for (const auto& [bandTop, bandBottom] : slot.staleRows)
+		{
+			first = std::min(first, bandTop);
+			last = std::max(last, bandBottom);
+		}
+		slot.staleRows.assign(1, { first, last });
+	}
+}
+
+const FrameBufferHandle& FrameBufferRing::Current() const
+{
+	static const FrameBufferHandle empty;
+	return m_slots.empty() ? empty : m_slots[m_current].buffer;
+}
+
+void FrameBufferRing::Reset()
+{
+	m_slots.clear();
+	m_stride = 0;
+	m_height = 0;
+}
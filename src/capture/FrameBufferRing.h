@@ -0,0 +1,60 @@
+#pragma once
+
+#include "FrameBufferPool.h"
+
+#include <cstdint>
+#include <memory>
+#include <utility>
+#include <vector>
+
+// Pooled buffers taken in turn by a producer that redraws only part of each
+// frame. Publishing a frame shares its buffer with the mailbox and the
+// worker queue, so the buffer behind the previous frame is never free to be
+// patched in place. The ring keeps the last few buffers instead and the rows
+// each one is behind the newest frame by; once every consumer has let go of
+// one, it is brought up to date by copying just those rows.
+// Not thread-safe: owned by the thread that draws the frames.
+class FrameBufferRing
+{
+public:
+	explicit FrameBufferRing(std::shared_ptr<FrameBufferPool> pool) : m_pool(std::move(pool)) {}
+
+	// Starts a frame of `height` rows of `stride` bytes and returns its pixels:
+	// those of the frame before with `preserveContents` (unspecified for the
+	// first one), otherwise unspecified, in which case the caller must draw
+	// every row. A new size forgets the buffers of the old one.
+	uint8_t* Begin(int stride, int height, bool preserveContents);
+
+	// Rows [top, bottom) where the frame begun differs from the one before
+	void MarkChanged(int top, int bottom);
+
+	// The buffer of the newest frame; empty before the first Begin()
+	const FrameBufferHandle& Current() const;
+
+	void Reset();
+
+	// Bytes copied to bring buffers up to date, for benchmarks
+	uint64_t GetCopiedBytes() const { return m_copiedBytes; }
+
+private:
+	static constexpr size_t kMaxSlots = 6;	// Mailbox slots and worker queue, plus a spare
+	static constexpr size_t kMaxBands = 32; // More stale bands collapse into one
+
+	struct Slot
+	{
+		FrameBufferHandle buffer;
+		std::vector<std::pair<int, int>> staleRows; // Bands behind the newest frame
+		bool wholeStale = true;
+		uint64_t lastUsed = 0;
+	};
+
+	void MarkStale(Slot& slot, int top, int bottom);
+
+	std::shared_ptr<FrameBufferPool> m_pool;
+	std::vector<Slot> m_slots;
+	size_t m_current = 0; // Index into m_slots; meaningless while it is empty
+	int m_stride = 0;
+	int m_height = 0;
+	uint64_t m_frameCount = 0;
+	uint64_t m_copiedBytes = 0;
+};
@@ -0,0 +1,29 @@
+#include "FrameChangeDetector.h"
+#include "../video/ThreadPool.h"
+
+void FrameChangeDetector::Configure(const CaptureConfig& config)
+{
+	m_enabled = config.detectChanges;
+	m_differ.Reset();
+	m_duplicates.store(0, std::memory_order_relaxed);
+}
+
+void FrameChangeDetector::Process(FrameData& frame)
+{
+	if (!m_enabled || !frame.data || frame.width <= 0 || frame.height <= 0)
+		return;
+
+	const bool changed = m_differ.Update(static_cast<const uint8_t*>(frame.data), frame.stride, frame.width, frame.height,
+										 frame.dirtyRects, frame.dirtyRectCount, m_dirtyRects, &ThreadPool::Shared());
+	if (!changed)
+	{
+		frame.isDuplicate = true;
+		frame.dirtyRects = nullptr;
+		frame.dirtyRectCount = 0;
+		m_duplicates.fetch_add(1, std::memory_order_relaxed);
+		return;
+	}
+
+	frame.dirtyRects = m_dirtyRects.data();
+	frame.dirtyRectCount = m_dirtyRects.size();
+}
@@ -0,0 +1,32 @@
+#pragma once
+
+#include "IGraphicsCapture.h"
+#include "../video/FrameDiffer.h"
+
+#include <atomic>
+#include <cstdint>
+#include <vector>
+
+// Capture pipeline stage that compares each frame with the one before in
+// 64x64 tiles. Runs on the capture thread ahead of CaptureScaler, at source
+// resolution. Damage reported by the backend narrows the search; tiles it
+// does not touch are trusted to be unchanged.
+class FrameChangeDetector
+{
+public:
+	// Starts over: the next frame is reported as fully changed
+	void Configure(const CaptureConfig& config);
+
+	// Replaces the frame's dirty rects with the tiles that really changed
+	// (valid until the next call) and sets isDuplicate when none did.
+	// Does nothing when detectChanges is off.
+	void Process(FrameData& frame);
+
+	uint64_t GetDuplicateCount() const { return m_duplicates.load(std::memory_order_relaxed); }
+
+private:
+	bool m_enabled = true;
+	FrameDiffer m_differ;
+	std::vector<FrameRect> m_dirtyRects;
+	std::atomic<uint64_t> m_duplicates = 0;
+};
@@ -0,0 +1,210 @@
+#include "FrameCompositor.h"
+#include "../video/ThreadPool.h"
+
+#include <algorithm>
+#include <cstring>
+
+namespace
+{
+	// Rows per parallel task; bands never share a canvas row
+	constexpr int kBandRows = 32;
+
+	FrameRect Intersect(const FrameRect& a, const FrameRect& b)
+	{
+		const int left = std::max(a.x, b.x);
+		const int top = std::max(a.y, b.y);
+		const int right = std::min(a.x + a.width, b.x + b.width);
+		const int bottom = std::min(a.y + a.height, b.y + b.height);
+		if (right <= left || bottom <= top)
+			return {};
+		return { left, top, right - left, bottom - top };
+	}
+
+	bool IsEmpty(const FrameRect& rect)
+	{
+		return rect.width <= 0 || rect.height <= 0;
+	}
+
+	bool Contains(const FrameRect& outer, const FrameRect& inner)
+	{
+		return inner.x >= outer.x && inner.y >= outer.y && inner.x + inner.width <= outer.x + outer.width &&
+			   inner.y + inner.height <= outer.y + outer.height;
+	}
+}
+
+void FrameCompositor::Configure(int canvasWidth, int canvasHeight, const std::vector<FrameRect>& layerRects,
+								uint32_t background)
+{
+	m_canvasWidth = std::max(canvasWidth, 0);
+	m_canvasHeight = std::max(canvasHeight, 0);
+	m_canvasStride = m_canvasWidth * 4;
+	m_background = background;
+
+	m_layers.clear();
+	m_layers.resize(layerRects.size());
+	for (size_t i = 0; i < layerRects.size(); ++i)
+		m_layers[i].rect = layerRects[i];
+
+	m_canvases.Reset();
+	m_damage.clear();
+	m_fullRedraw = true;
+}
+
+void FrameCompositor::SetLayerFrame(size_t index, const FrameData& frame)
+{
+	if (index >= m_layers.size() || !frame.data || frame.width <= 0 || frame.height <= 0)
+		return;
+
+	Layer& layer = m_layers[index];
+	const bool sameSize = layer.frame.data && layer.frame.width == frame.width && layer.frame.height == frame.height;
+	if (frame.isDuplicate && sameSize)
+		return;
+
+	layer.frame = FrameData();
+	layer.frame.width = frame.width;
+	layer.frame.height = frame.height;
+	layer.frame.stride = frame.stride;
+	layer.frame.size = frame.size;
+	layer.frame.timestampNs = frame.timestampNs;
+	layer.frame.presentationTimeNs = frame.presentationTimeNs;
+	layer.frame.traceId = frame.traceId;
+	if (frame.buffer)
+	{
+		layer.frame.buffer = frame.buffer;
+		layer.frame.data = frame.data;
+	}
+	else
+	{
+		layer.frame.buffer = m_bufferPool->Acquire(frame.size);
+		std::memcpy(layer.frame.buffer.Data(), frame.data, frame.size);
+		layer.frame.data = layer.frame.buffer.Data();
+	}
+
+	// A resized frame may uncover background, so its whole rectangle is redrawn
+	if (!sameSize || frame.dirtyRectCount == 0)
+	{
+		AddDamage(layer.rect);
+		return;
+	}
+
+	for (size_t i = 0; i < frame.dirtyRectCount; ++i)
+	{
+		const FrameRect& rect = frame.dirtyRects[i];
+		AddDamage(Intersect({ layer.rect.x + rect.x, layer.rect.y + rect.y, rect.width, rect.height }, layer.rect));
+	}
+}
+
+void FrameCompositor::AddDamage(const FrameRect& rect)
+{
+	const FrameRect clipped = Intersect(rect, { 0, 0, m_canvasWidth, m_canvasHeight });
+	if (!IsEmpty(clipped))
+		m_damage.push_back(clipped);
+}
+
+bool FrameCompositor::CanPassThrough() const
+{
+	if (m_layers.size() != 1)
+		return false;
+
+	const Layer& layer = m_layers[0];
+	return layer.frame.data && layer.rect.x == 0 && layer.rect.y == 0 && layer.frame.width == m_canvasWidth &&
+		   layer.frame.height == m_canvasHeight;
+}
+
+bool FrameCompositor::Compose(FrameData& outFrame)
+{
+	if (!HasChanges() || m_canvasWidth == 0 || m_canvasHeight == 0)
+		return false;
+
+	// Nothing to draw into the canvas when one frame is the canvas
+	if (CanPassThrough())
+	{
+		const bool fullFrame = m_fullRedraw;
+		m_dirtyRects.swap(m_damage);
+		m_damage.clear();
+		m_fullRedraw = false;
+		m_canvases.Reset(); // Drawn from scratch if the layer stops covering it
+
+		outFrame = m_layers[0].frame;
+		outFrame.dirtyRects = fullFrame ? nullptr : m_dirtyRects.data();
+		outFrame.dirtyRectCount = fullFrame ? 0 : m_dirtyRects.size();
+		return true;
+	}
+
+	// Whoever holds the last few canvases, the ring hands out one of them
+	// that nobody does, caught up on the rows redrawn since it was drawn
+	const size_t canvasSize = static_cast<size_t>(m_canvasStride) * m_canvasHeight;
+	const FrameRect canvasRect = { 0, 0, m_canvasWidth, m_canvasHeight };
+	if (!m_canvases.Current())
+		m_fullRedraw = true;
+	if (m_fullRedraw)
+		m_damage.assign(1, canvasRect);
+
+	uint8_t* canvas = m_canvases.Begin(m_canvasStride, m_canvasHeight, !m_fullRedraw);
+	for (const FrameRect& damage : m_damage)
+		m_canvases.MarkChanged(damage.y, damage.y + damage.height);
+
+	const int bandCount = (m_canvasHeight + kBandRows - 1) / kBandRows;
+	ThreadPool::Shared().ParallelFor(bandCount, [&](int band) {
+		const FrameRect bandRect = Intersect(canvasRect, { 0, band * kBandRows, m_canvasWidth, kBandRows });
+		for (const FrameRect& damage : m_damage)
+		{
+			const FrameRect region = Intersect(damage, bandRect);
+			if (!IsEmpty(region))
+				DrawRegion(canvas, region);
+		}
+	});
+
+	const bool fullFrame = m_fullRedraw;
+	m_dirtyRects.swap(m_damage);
+	m_damage.clear();
+	m_fullRedraw = false;
+
+	outFrame = FrameData();
+	outFrame.data = canvas;
+	outFrame.size = canvasSize;
+	outFrame.width = m_canvasWidth;
+	outFrame.height = m_canvasHeight;
+	outFrame.stride = m_canvasStride;
+	outFrame.buffer = m_canvases.Current();
+	outFrame.dirtyRects = fullFrame ? nullptr : m_dirtyRects.data();
+	outFrame.dirtyRectCount = fullFrame ? 0 : m_dirtyRects.size();
+	return true;
+}
+
+void FrameCompositor::DrawRegion(uint8_t* canvas, const FrameRect& region) const
+{
+	// Layers are opaque: start from the topmost one that hides everything below
+	size_t first = 0;
+	bool covered = false;
+	for (size_t i = m_layers.size(); i-- > 0;)
+	{
+		const Layer& layer = m_layers[i];
+		const FrameRect visible = Intersect(layer.rect, { layer.rect.x, layer.rect.y, layer.frame.width, layer.frame.height });
+		if (layer.frame.data && Contains(visible, region))
+		{
+			first = i;
+			covered = true;
+			break;
+		}
+	}
+
+	const MutableBgraView canvasView(canvas, m_canvasWidth, m_canvasHeight, m_canvasStride);
+	if (!covered)
+		FillImage(canvasView.Crop(region.x, region.y, region.width, region.height), m_background);
+
+	for (size_t i = first; i < m_layers.size(); ++i)
+	{
+		const Layer& layer = m_layers[i];
+		if (!layer.frame.data)
+			continue;
+
+		const FrameRect visible = Intersect(layer.rect, { layer.rect.x, layer.rect.y, layer.frame.width, layer.frame.height });
+		const FrameRect draw = Intersect(visible, region);
+		if (IsEmpty(draw))
+			continue;
+
+		CopyImage(layer.frame.GetView().Crop(draw.x - layer.rect.x, draw.y - layer.rect.y, draw.width, draw.height),
+				  canvasView.Crop(draw.x, draw.y, draw.width, draw.height));
+	}
+}
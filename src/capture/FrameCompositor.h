@@ -0,0 +1,62 @@
+#pragma once
+
+#include "FrameBufferRing.h"
+#include "IGraphicsCapture.h"
+
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+// Lays the frames of several sources out on one BGRA canvas. Layers are
+// opaque rectangles drawn back to front over a solid background; a layer's
+// frame is copied 1:1 into its rectangle (sources are scaled to size before
+// they get here). Only the canvas regions covered by the dirty rects of new
+// layer frames are redrawn, in row bands spread over the shared ThreadPool.
+// Not thread-safe: one thread feeds layer frames and composes.
+class FrameCompositor
+{
+public:
+	// Starts a new canvas and forgets all layer frames; the next Compose()
+	// redraws everything. `layerRects` are in canvas pixels, back to front.
+	void Configure(int canvasWidth, int canvasHeight, const std::vector<FrameRect>& layerRects,
+				   uint32_t background = 0xFF000000);
+
+	// Takes a reference to the pixels of `frame` for layer `index` (a copy
+	// only for frames without a pooled buffer) and records its dirty rects as
+	// canvas damage. Duplicate frames of an unchanged size are ignored.
+	void SetLayerFrame(size_t index, const FrameData& frame);
+
+	bool HasChanges() const { return m_fullRedraw || !m_damage.empty(); }
+
+	// Redraws the damaged regions and returns the canvas in `outFrame`, with
+	// the redrawn regions as its dirty rects (valid until the next call).
+	// False when nothing changed since the last call. A single layer that
+	// covers the whole canvas is passed through without a copy.
+	bool Compose(FrameData& outFrame);
+
+	int GetCanvasWidth() const { return m_canvasWidth; }
+	int GetCanvasHeight() const { return m_canvasHeight; }
+
+private:
+	struct Layer
+	{
+		FrameRect rect;
+		FrameData frame; // Owns its pixels through frame.buffer; no dirty rects
+	};
+
+	void AddDamage(const FrameRect& rect);
+	void DrawRegion(uint8_t* canvas, const FrameRect& region) const;
+	bool CanPassThrough() const;
+
+	int m_canvasWidth = 0;
+	int m_canvasHeight = 0;
+	int m_canvasStride = 0;
+	uint32_t m_background = 0xFF000000;
+	std::vector<Layer> m_layers;
+
+	std::shared_ptr<FrameBufferPool> m_bufferPool = FrameBufferPool::Create();
+	FrameBufferRing m_canvases{ m_bufferPool };
+	std::vector<FrameRect> m_damage; // Canvas regions to redraw, clipped to the canvas
+	bool m_fullRedraw = true;
+	std::vector<FrameRect> m_dirtyRects; // Handed out with the last composed frame
+};
@@ -0,0 +1,38 @@
+#include "FrameMailbox.h"
+
+void FrameMailbox::Publish(const FrameData& frame)
+{
+	FrameData& slot = m_slots[m_back];
+	slot = frame;
+
+	// Dirty rects and the duplicate flag describe the change relative to the
+	// previous *delivered* frame, and rects point into producer-owned
+	// storage; neither holds for a reader that may skip frames.
+	slot.dirtyRects = nullptr;
+	slot.dirtyRectCount = 0;
+	slot.isDuplicate = false;
+
+	uint8_t previous = m_middle.exchange(static_cast<uint8_t>(m_back | kFreshBit), std::memory_order_acq_rel);
+	m_back = previous & kIndexMask;
+
+	if (previous & kFreshBit)
+		m_overwritten.fetch_add(1, std::memory_order_relaxed);
+	m_published.fetch_add(1, std::memory_order_relaxed);
+}
+
+bool FrameMailbox::Acquire(FrameData& outFrame)
+{
+	if (m_middle.load(std::memory_order_relaxed) & kFreshBit)
+	{
+		uint8_t previous = m_middle.exchange(m_front, std::memory_order_acq_rel);
+		m_front = previous & kIndexMask;
+		m_consumed.fetch_add(1, std::memory_order_relaxed);
+	}
+
+	const FrameData& slot = m_slots[m_front];
+	if (!slot.data)
+		return false;
+
+	outFrame = slot;
+	return true;
+}
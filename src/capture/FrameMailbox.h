@@ -0,0 +1,44 @@
+#pragma once
+
+#include "IGraphicsCapture.h"
+
+#include <atomic>
+#include <cstdint>
+
+// Wait-free "latest frame" mailbox between one producer (the capture thread)
+// and one consumer (render or encode thread), built as a triple buffer. The
+// producer always has a private slot to fill and the consumer always has a
+// private slot to read, so neither ever waits for the other and the consumer
+// can never observe a half-written frame. Frames share pixels through their
+// FrameBufferHandle, so publishing and reading never copy pixel data.
+class FrameMailbox
+{
+public:
+	// Producer side. Replaces any frame that has not been picked up yet.
+	void Publish(const FrameData& frame);
+
+	// Consumer side. Returns the newest published frame (the same one again if
+	// nothing new arrived since the last call); false until the first publish.
+	bool Acquire(FrameData& outFrame);
+
+	uint64_t GetPublishedCount() const { return m_published.load(std::memory_order_relaxed); }
+	uint64_t GetConsumedCount() const { return m_consumed.load(std::memory_order_relaxed); }
+	// Frames replaced by a newer one before the consumer ever saw them
+	uint64_t GetOverwrittenCount() const { return m_overwritten.load(std::memory_order_relaxed); }
+
+private:
+	static constexpr uint8_t kIndexMask = 0x3;
+	static constexpr uint8_t kFreshBit = 0x4;
+
+	FrameData m_slots[3];
+
+	// Slot ownership: back = producer, front = consumer, middle = hand-off.
+	// The fresh bit marks a middle slot that holds an unread frame.
+	uint8_t m_back = 0;
+	uint8_t m_front = 1;
+	std::atomic<uint8_t> m_middle = 2;
+
+	std::atomic<uint64_t> m_published = 0;
+	std::atomic<uint64_t> m_consumed = 0;
+	std::atomic<uint64_t> m_overwritten = 0;
+};
@@ -0,0 +1,120 @@
+#include "FramePacer.h"
+
+#include <cmath>
+#include <thread>
+
+namespace
+{
+	// OS sleeps overshoot by up to a scheduler tick; sleep until shortly before
+	// the deadline and yield through the rest for sub-millisecond accuracy.
+#ifdef PLATFORM_WINDOWS
+	constexpr auto kSpinWindow = std::chrono::microseconds(2000);
+#else
+	constexpr auto kSpinWindow = std::chrono::microseconds(200);
+#endif
+
+	// Smoothing for the reported rate and jitter (~16 frame window)
+	constexpr double kSmoothing = 1.0 / 16.0;
+}
+
+void FramePacer::SetTargetFps(int fps)
+{
+	m_targetFps.store(fps, std::memory_order_relaxed);
+}
+
+FramePacer::Clock::duration FramePacer::GetPeriod() const
+{
+	int fps = m_targetFps.load(std::memory_order_relaxed);
+	if (fps <= 0)
+		return Clock::duration::zero();
+	return std::chrono::duration_cast<Clock::duration>(std::chrono::nanoseconds(1'000'000'000LL / fps));
+}
+
+void FramePacer::Reset()
+{
+	m_started = false;
+	m_lastFrame = {};
+	m_averageIntervalNs = 0.0;
+	m_averageDeviationNs = 0.0;
+	m_achievedFps.store(0.0, std::memory_order_relaxed);
+	m_jitterMs.store(0.0, std::memory_order_relaxed);
+}
+
+bool FramePacer::ShouldAccept(Clock::time_point arrival)
+{
+	const auto period = GetPeriod();
+	if (period == Clock::duration::zero() || !m_started)
+	{
+		m_started = true;
+		m_deadline = arrival + period;
+		RecordFrame(arrival);
+		return true;
+	}
+
+	// Allow arrivals a little early: source intervals are quantized to the
+	// display refresh and would otherwise alias against the deadline grid.
+	if (arrival + period / 8 < m_deadline)
+	{
+		m_decimated.fetch_add(1, std::memory_order_relaxed);
+		return false;
+	}
+
+	m_deadline += period;
+	if (m_deadline <= arrival)
+		m_deadline = arrival + period; // More than a period behind: resync rather than burst
+
+	RecordFrame(arrival);
+	return true;
+}
+
+FramePacer::Clock::time_point FramePacer::WaitForNextFrame()
+{
+	const auto period = GetPeriod();
+
+	if (!m_started)
+	{
+		m_started = true;
+		m_deadline = Clock::now();
+	}
+	else
+	{
+		m_deadline += period;
+	}
+
+	auto now = Clock::now();
+	if (now > m_deadline + period)
+	{
+		m_deadline = now; // Fell behind: resync rather than burst
+	}
+	else
+	{
+		if (m_deadline - now > kSpinWindow)
+			std::this_thread::sleep_until(m_deadline - kSpinWindow);
+		while (Clock::now() < m_deadline)
+			std::this_thread::yield();
+	}
+
+	return m_deadline;
+}
+
+void FramePacer::RecordFrame(Clock::time_point time)
+{
+	if (m_lastFrame != Clock::time_point{})
+	{
+		const double intervalNs = static_cast<double>(std::chrono::duration_cast<std::chrono::nanoseconds>(time - m_lastFrame).count());
+		const double periodNs = static_cast<double>(std::chrono::duration_cast<std::chrono::nanoseconds>(GetPeriod()).count());
+
+		if (m_averageIntervalNs == 0.0)
+			m_averageIntervalNs = intervalNs;
+		m_averageIntervalNs += (intervalNs - m_averageIntervalNs) * kSmoothing;
+
+		// Unpaced: measure regularity against the observed rate instead
+		const double expectedNs = periodNs > 0.0 ? periodNs : m_averageIntervalNs;
+		m_averageDeviationNs += (std::abs(intervalNs - expectedNs) - m_averageDeviationNs) * kSmoothing;
+
+		if (m_averageIntervalNs > 0.0)
+			m_achievedFps.store(1e9 / m_averageIntervalNs, std::memory_order_relaxed);
+		m_jitterMs.store(m_averageDeviationNs / 1e6, std::memory_order_relaxed);
+	}
+	m_lastFrame = time;
+}
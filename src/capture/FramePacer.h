@@ -0,0 +1,52 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+
+// Enforces CaptureConfig::targetFps with deadline scheduling on the steady
+// clock. Deadlines sit on a fixed grid (deadline += period), so rounding never
+// accumulates into drift. Two modes match the two kinds of backends:
+//  - ShouldAccept(): push sources (WinRT FrameArrived) decimate on arrival,
+//    before any readback or copy is spent on a frame that would be dropped.
+//  - WaitForNextFrame(): timer-driven sources sleep until the next deadline,
+//    then report frames they actually delivered with MarkDelivered().
+class FramePacer
+{
+public:
+	using Clock = std::chrono::steady_clock;
+
+	// Values <= 0 disable pacing (every frame is accepted). Safe to call while running.
+	void SetTargetFps(int fps);
+	int GetTargetFps() const { return m_targetFps.load(std::memory_order_relaxed); }
+
+	// Starts a new schedule; the next frame is accepted immediately
+	void Reset();
+
+	bool ShouldAccept(Clock::time_point arrival);
+	// Returns immediately when pacing is disabled
+	Clock::time_point WaitForNextFrame();
+	void MarkDelivered(Clock::time_point time) { RecordFrame(time); }
+
+	double GetAchievedFps() const { return m_achievedFps.load(std::memory_order_relaxed); }
+	// Mean absolute deviation of accepted inter-frame intervals from the target period
+	double GetJitterMs() const { return m_jitterMs.load(std::memory_order_relaxed); }
+	uint64_t GetDecimatedCount() const { return m_decimated.load(std::memory_order_relaxed); }
+
+private:
+	void RecordFrame(Clock::time_point time);
+	Clock::duration GetPeriod() const;
+
+	std::atomic<int> m_targetFps = 30;
+
+	// Producer-thread state
+	Clock::time_point m_deadline{};
+	Clock::time_point m_lastFrame{};
+	bool m_started = false;
+	double m_averageIntervalNs = 0.0;
+	double m_averageDeviationNs = 0.0;
+
+	std::atomic<double> m_achievedFps = 0.0;
+	std::atomic<double> m_jitterMs = 0.0;
+	std::atomic<uint64_t> m_decimated = 0;
+};
@@ -0,0 +1,100 @@
+#include "FrameTracer.h"
+
+#include <algorithm>
+
+namespace
+{
+	constexpr size_t kStageCount = static_cast<size_t>(FrameStage::Count);
+
+	constexpr const char* kStageNames[kStageCount] = {
+		"Presented", "Arrived", "Copied", "Processed", "Queued", "Delivered", "Converted", "Uploaded", "Encoded", "Sent"
+	};
+}
+
+double FrameLatencyBreakdown::GetStageMs(FrameStage stage) const
+{
+	const size_t index = static_cast<size_t>(stage);
+	if (stampNs[index] == 0)
+		return 0.0;
+
+	for (size_t previous = index; previous-- > 0;)
+	{
+		if (stampNs[previous] != 0)
+		{
+			// Stages on different threads can land out of order by a hair
+			const uint64_t elapsed = stampNs[index] > stampNs[previous] ? stampNs[index] - stampNs[previous] : 0;
+			return static_cast<double>(elapsed) / 1e6;
+		}
+	}
+	return 0.0;
+}
+
+double FrameLatencyBreakdown::GetTotalMs() const
+{
+	uint64_t first = 0, last = 0;
+	for (uint64_t stamp : stampNs)
+	{
+		if (stamp == 0)
+			continue;
+		first = first == 0 ? stamp : std::min(first, stamp);
+		last = std::max(last, stamp);
+	}
+	return static_cast<double>(last - first) / 1e6;
+}
+
+const char* FrameLatencyBreakdown::GetStageName(FrameStage stage)
+{
+	const size_t index = static_cast<size_t>(stage);
+	return index < kStageCount ? kStageNames[index] : "Unknown";
+}
+
+uint64_t FrameTracer::Begin(uint64_t presentedNs, uint64_t arrivedNs)
+{
+	const uint64_t id = m_nextId.fetch_add(1, std::memory_order_relaxed);
+	Slot& slot = m_slots[id % kCapacity];
+
+	// Invalidate first so readers and late stamps of the previous occupant
+	// back off while the slot is reset
+	slot.traceId.store(0, std::memory_order_relaxed);
+	std::atomic_thread_fence(std::memory_order_release);
+	for (auto& stamp : slot.stampNs)
+		stamp.store(0, std::memory_order_relaxed);
+	slot.stampNs[static_cast<size_t>(FrameStage::Presented)].store(presentedNs ? presentedNs : arrivedNs, std::memory_order_relaxed);
+	slot.stampNs[static_cast<size_t>(FrameStage::Arrived)].store(arrivedNs, std::memory_order_relaxed);
+	slot.traceId.store(id, std::memory_order_release);
+	return id;
+}
+
+void FrameTracer::Stamp(uint64_t traceId, FrameStage stage, uint64_t timeNs)
+{
+	if (traceId == 0 || stage >= FrameStage::Count)
+		return;
+
+	Slot& slot = m_slots[traceId % kCapacity];
+	if (slot.traceId.load(std::memory_order_acquire) == traceId)
+		slot.stampNs[static_cast<size_t>(stage)].store(timeNs, std::memory_order_relaxed);
+}
+
+bool FrameTracer::GetBreakdown(uint64_t traceId, FrameLatencyBreakdown& outBreakdown) const
+{
+	if (traceId == 0)
+		return false;
+
+	const Slot& slot = m_slots[traceId % kCapacity];
+	if (slot.traceId.load(std::memory_order_acquire) != traceId)
+		return false;
+
+	outBreakdown.traceId = traceId;
+	for (size_t i = 0; i < kStageCount; ++i)
+		outBreakdown.stampNs[i] = slot.stampNs[i].load(std::memory_order_relaxed);
+
+	// Seqlock-style recheck: the slot may have been reused while copying
+	std::atomic_thread_fence(std::memory_order_acquire);
+	return slot.traceId.load(std::memory_order_relaxed) == traceId;
+}
+
+FrameTracer& FrameTracer::Shared()
+{
+	static FrameTracer tracer;
+	return tracer;
+}
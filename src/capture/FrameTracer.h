@@ -0,0 +1,93 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+
+// Timestamp domain of FrameData and FrameTracer: steady_clock in nanoseconds.
+// Monotonic and unaffected by wall-clock changes, so differences between any
+// two stamps are valid latencies.
+struct FrameClock
+{
+	using Clock = std::chrono::steady_clock;
+
+	static uint64_t Now() { return FromTimePoint(Clock::now()); }
+
+	static uint64_t FromTimePoint(Clock::time_point time)
+	{
+		return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(time.time_since_epoch()).count());
+	}
+};
+
+// Points in a frame's life, in pipeline order. The capture backends and
+// CaptureWorker stamp Presented through Delivered; consumers stamp the rest
+// with the frame's traceId as they get to them.
+enum class FrameStage : uint8_t
+{
+	Presented, // Capture system's presentation time (or Arrived if it has none)
+	Arrived,   // Backend received the frame
+	Copied,	   // Pixels read back / copied into a pooled buffer
+	Processed, // Change detection and scaling done
+	Queued,	   // Handed to the CaptureWorker queue
+	Delivered, // Frame callback invoked
+	Converted, // Color converted (e.g. to I420)
+	Uploaded,  // Uploaded to a GPU texture
+	Encoded,
+	Sent,
+	Count
+};
+
+// Stage timestamps of one frame, as returned by FrameTracer::GetBreakdown()
+struct FrameLatencyBreakdown
+{
+	uint64_t traceId = 0;
+	std::array<uint64_t, static_cast<size_t>(FrameStage::Count)> stampNs = {}; // 0 = stage not reached
+
+	bool HasStage(FrameStage stage) const { return stampNs[static_cast<size_t>(stage)] != 0; }
+
+	// Time from the closest earlier stage that was reached to `stage`; 0 if
+	// `stage` was not reached
+	double GetStageMs(FrameStage stage) const;
+
+	// From the first stamped stage to the last one
+	double GetTotalMs() const;
+
+	static const char* GetStageName(FrameStage stage);
+};
+
+// Per-frame latency tracing across threads. Backends open a trace for every
+// frame with Begin() and carry the id in FrameData::traceId; any stage can
+// then Stamp() it without locking. The last kCapacity traces are kept in a
+// ring, so a breakdown is available for any recent frame.
+class FrameTracer
+{
+public:
+	static constexpr size_t kCapacity = 1024;
+
+	// Starts a trace and returns its id (never 0). `presentedNs` may be 0
+	// when the capture system has no presentation time.
+	uint64_t Begin(uint64_t presentedNs, uint64_t arrivedNs);
+
+	// Records `stage` at `timeNs`. Ignored for id 0 and for traces that have
+	// already left the ring.
+	void Stamp(uint64_t traceId, FrameStage stage, uint64_t timeNs = FrameClock::Now());
+
+	// False if the trace is unknown or was evicted
+	bool GetBreakdown(uint64_t traceId, FrameLatencyBreakdown& outBreakdown) const;
+
+	// Process-wide tracer, so stages outside the capture backend (encoders,
+	// transports) can stamp frames without a reference to it
+	static FrameTracer& Shared();
+
+private:
+	struct Slot
+	{
+		std::atomic<uint64_t> traceId = 0; // 0 while the slot is being reset
+		std::array<std::atomic<uint64_t>, static_cast<size_t>(FrameStage::Count)> stampNs = {};
+	};
+
+	std::atomic<uint64_t> m_nextId = 1;
+	Slot m_slots[kCapacity];
+};
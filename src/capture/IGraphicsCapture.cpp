@@ -1,4 +1,8 @@
 #include "IGraphicsCapture.h"
+#include "synthetic/SyntheticGraphicsCapture.h"
+
+#include <cstdlib>
+#include <string_view>
 
 #ifdef PLATFORM_WINDOWS
 #include "windows/WindowsGraphicsCapture.h"
@@ -12,8 +16,17 @@
 #include "linux/LinuxGraphicsCapture.h"
 #endif
 
-std::unique_ptr<IGraphicsCapture> IGraphicsCapture::Create()
+std::unique_ptr<IGraphicsCapture> IGraphicsCapture::Create(CaptureBackend backend)
 {
+    if (backend == CaptureBackend::Auto)
+    {
+        const char* requested = std::getenv("CAPTURE_BACKEND");
+        backend = (requested && std::string_view(requested) == "synthetic") ? CaptureBackend::Synthetic : CaptureBackend::Platform;
+    }
+
+    if (backend == CaptureBackend::Synthetic)
+        return std::make_unique<SyntheticGraphicsCapture>();
+
 #ifdef PLATFORM_WINDOWS
     return std::make_unique<WindowsGraphicsCapture>();
 #elif PLATFORM_MACOS
@@ -1,11 +1,16 @@
 #pragma once
 
+#include <algorithm>
 #include <memory>
 #include <vector>
 #include <string>
 #include <string_view>
 #include <functional>
 
+#include "FrameBufferPool.h"
+#include "FrameTracer.h"
+#include "../video/ImageView.h"
+
 struct Monitor
 {
 	std::string id;
@@ -37,28 +42,145 @@ struct CaptureSource
 	int height;
 };
 
+struct FrameRect
+{
+	int x = 0;
+	int y = 0;
+	int width = 0;
+	int height = 0;
+
+	bool operator==(const FrameRect&) const = default;
+};
+
+// Size and filter frames are scaled with before delivery (see CaptureScaler)
 enum class CaptureQuality
 {
-	Low,
-	Medium,
-	High
+	Low,	// Fit within 1280x720; box average for 2x/4x, bilinear otherwise
+	Medium, // Fit within 1920x1080; bilinear
+	High	// Native resolution; Lanczos when outputWidth/outputHeight ask for scaling
+};
+
+// What the capture worker does when its queue is full
+enum class FrameDropPolicy
+{
+	DropOldest, // Discard the oldest queued frame (lowest latency)
+	DropNewest, // Discard the incoming frame (keeps queued frames intact)
+	Block		// Stall the capture thread until there is room (lossless)
+};
+
+// How the mouse cursor reaches consumers
+enum class CursorMode
+{
+	Hidden,	  // Not captured
+	Embedded, // Drawn into the frame pixels; every move is a new frame
+	Metadata  // Left out of the pixels and reported as FrameData::cursor and
+			  // through the cursor callback, at cursorRateHz
 };
 
 struct CaptureConfig
 {
 	CaptureQuality quality = CaptureQuality::Medium;
-	int targetFps = 30;
-	bool includeCursor = true;
+	int targetFps = 30; // <= 0 delivers every frame the source produces
+	CursorMode cursorMode = CursorMode::Embedded;
+	int cursorRateHz = 120; // Cursor sampling with CursorMode::Metadata, independent of targetFps
 	bool includeBorders = true;
+
+	// Fit delivered frames within this size, keeping the aspect ratio; 0 for
+	// both leaves the size to `quality`. Frames are never upscaled.
+	int outputWidth = 0;
+	int outputHeight = 0;
+
+	// Capture only this rectangle of the source, in source pixels; empty (the
+	// default) for all of it. Backends read back just this part where the
+	// platform allows, and every later stage sees a frame of this size.
+	FrameRect region;
+
+	// Compare each frame with the previous one in tiles to narrow its dirty
+	// rects and flag unchanged frames as duplicates (see FrameChangeDetector)
+	bool detectChanges = true;
+
+	// Frames buffered between the capture thread and the frame callback
+	int queueDepth = 2;
+	FrameDropPolicy dropPolicy = FrameDropPolicy::DropOldest;
+
+	bool operator==(const CaptureConfig&) const = default;
+};
+
+// True when `next` is `current` with at most a different targetFps: the one
+// change a running capture takes (rate control lowers the frame rate when the
+// network cannot carry it)
+inline bool IsFrameRateChangeOnly(const CaptureConfig& current, CaptureConfig next)
+{
+	next.targetFps = current.targetFps;
+	return next == current;
+}
+
+// The part of a width x height source that `region` selects: the whole
+// source for an empty region, otherwise the region clipped to the source
+// (empty if they do not overlap)
+inline FrameRect ClipCaptureRegion(const FrameRect& region, int width, int height)
+{
+	if (region.width <= 0 || region.height <= 0)
+		return { 0, 0, width, height };
+
+	const int left = std::clamp(region.x, 0, width);
+	const int top = std::clamp(region.y, 0, height);
+	const int right = std::clamp(region.x + region.width, left, width);
+	const int bottom = std::clamp(region.y + region.height, top, height);
+	return { left, top, right - left, bottom - top };
+}
+
+// Percentiles of one pipeline stage since capture started
+struct LatencyPercentiles
+{
+	uint64_t samples = 0;
+	double p50Ms = 0.0;
+	double p95Ms = 0.0;
+	double p99Ms = 0.0;
+	double maxMs = 0.0;
 };
 
 struct CaptureStatistics
 {
 	uint64_t framesCapture = 0;
-	uint64_t framesDropped = 0;
-	double averageFps = 0.0;
-	double cpuUsage = 0.0;
-	uint64_t memoryUsage = 0;
+	uint64_t framesDropped = 0;		// Lost to a full worker queue
+	uint64_t framesOverwritten = 0; // Replaced in the latest-frame mailbox before being pulled
+	uint64_t framesDecimated = 0;	// Skipped on arrival to hold targetFps
+	uint64_t framesDuplicate = 0;	// Identical to the frame before (FrameData::isDuplicate)
+	double averageFps = 0.0;		// Achieved delivery rate
+	double frameJitterMs = 0.0;		// Mean deviation of frame intervals from 1/targetFps
+	double cpuUsage = 0.0;			// Whole process, percent of one core
+	uint64_t memoryUsage = 0;		// Whole process resident set, bytes
+
+	// Arrival is when the backend first sees a frame (before readback)
+	LatencyPercentiles captureLatency;	// Arrival -> queued for delivery (grab, readback, copy)
+	LatencyPercentiles queueLatency;	// Queued -> frame callback invoked
+	LatencyPercentiles callbackLatency; // Time spent in the frame callback (texture upload)
+	LatencyPercentiles totalLatency;	// Arrival -> frame callback returned
+};
+
+// Cursor image, shared by every report while the shape stays the same
+struct CursorShape
+{
+	uint64_t hash = 0; // Of the pixels, size and hotspot; equal hashes mean equal shapes
+	int width = 0;
+	int height = 0;
+	int hotspotX = 0; // The pointer position within the image
+	int hotspotY = 0;
+	std::vector<uint32_t> pixels; // Premultiplied BGRA, width * height
+};
+
+// Where the cursor is on the delivered frames (CursorMode::Metadata)
+struct CursorState
+{
+	bool visible = false; // Shown and over the captured area
+	int x = 0;			  // Hotspot position in frame pixels
+	int y = 0;
+	// Frame pixels per source pixel. Shapes come at source resolution, so
+	// draw them scaled by this to match a scaled-down frame.
+	float scale = 1.0f;
+	std::shared_ptr<const CursorShape> shape;
+	uint64_t timestampNs = 0; // FrameClock time of the sample
 };
 
 struct FrameData
@@ -68,11 +190,54 @@ struct FrameData
 	int width = 0;
 	int height = 0;
 	int stride = 0;
-	uint64_t timestamp = 0;
+
+	// FrameClock nanoseconds (steady_clock) when the backend received the
+	// frame, and when the capture system says it was presented (the same as
+	// timestampNs for sources without a presentation time)
+	uint64_t timestampNs = 0;
+	uint64_t presentationTimeNs = 0;
+
+	// Per-frame trace in FrameTracer::Shared(); later stages stamp it and
+	// GetBreakdown() returns where the frame's latency went. 0 = untraced.
+	uint64_t traceId = 0;
+
+	// Regions that changed since the previous frame, valid for the duration of
+	// the callback. No rects means the whole frame should be treated as changed.
+	const FrameRect* dirtyRects = nullptr;
+	size_t dirtyRectCount = 0;
+
+	// Pixels are identical to the previous delivered frame and there are no
+	// dirty rects. Consumers that keep the last frame (a preview texture, an
+	// encoder reference) can skip all work for it.
+	bool isDuplicate = false;
+
+	// Latest cursor sample when the frame was captured, with
+	// CursorMode::Metadata; not visible in the other modes
+	CursorState cursor;
+
+	// Owner of `data` when the backend delivers pooled frames. Keep a copy of
+	// the handle (or of the whole FrameData) to use the pixels after the
+	// callback returns; no memcpy is involved.
+	FrameBufferHandle buffer;
+
+	// The pixels as a typed view (frames are always BGRA8)
+	BgraView GetView() const { return { data, width, height, stride }; }
 };
 
+// Invoked on the capture worker thread, never on the thread that captured the frame
 using FrameCallback = std::function<void(const FrameData& frame)>;
 
+// Invoked on the cursor tracker thread whenever the cursor moves, changes shape
+// or shows/hides (CursorMode::Metadata only)
+using CursorCallback = std::function<void(const CursorState& cursor)>;
+
+enum class CaptureBackend
+{
+	Auto,	  // Platform backend unless CAPTURE_BACKEND=synthetic is set
+	Platform, // Native OS capture API
+	Synthetic // Generated frames, no display or GPU required
+};
+
 class IGraphicsCapture
 {
 public:
@@ -89,15 +254,33 @@ public:
 	virtual std::vector<Window> GetWindows() const = 0;
 	virtual std::vector<CaptureSource> GetAvailableSources() const = 0;
 
+	// Before StartCapture() any change is taken. While capturing, only
+	// targetFps may change (see IsFrameRateChangeOnly()); it applies from the
+	// next frame, and other changes return false.
 	virtual bool SetCaptureConfig(const CaptureConfig& config) = 0;
 	virtual CaptureConfig GetCaptureConfig() const = 0;
+	// Changes targetFps alone, from any thread, without the get-modify-set
+	// of SetCaptureConfig() that would undo a concurrent change to the other
+	// settings. Returns false when the capture could not take it (not
+	// initialized).
+	virtual bool SetTargetFps(int fps) = 0;
 
 	virtual bool StartCapture(const std::string& sourceId) = 0;
 	virtual void StopCapture() = 0;
 	virtual bool IsCapturing() const = 0;
 
 	virtual bool SetFrameCallback(const FrameCallback& callback) = 0;
+	// Cursor reports that need no video frame: with CursorMode::Metadata a
+	// mouse move over a static screen is just a callback with a new position
+	virtual bool SetCursorCallback(const CursorCallback& callback) = 0;
+	// Pull-mode access to the newest complete frame, wait-free and safe to call
+	// from one consumer thread while capture runs. Returns false until the
+	// first frame arrives.
 	virtual bool GetLatestFrame(FrameData& outFrame) const = 0;
+	// Saves the next frame of the running capture at source resolution (before
+	// CaptureQuality scaling) as .png, .qoi or .bmp. Returns once the request
+	// is queued; encoding and writing happen on a background thread and the
+	// result is logged. `sourceId` must be the captured source or empty.
 	virtual bool SaveScreenshot(const std::string& sourceId, const std::string& filePath) const = 0;
 
 	virtual CaptureStatistics GetStatistics() const = 0;
@@ -105,6 +288,6 @@ public:
 
 	virtual std::string_view GetPlatformName() const noexcept = 0;
 
-	static std::unique_ptr<IGraphicsCapture> Create();
+	static std::unique_ptr<IGraphicsCapture> Create(CaptureBackend backend = CaptureBackend::Auto);
 	static std::string_view GetCurrentPlatform() noexcept;
 };
\ No newline at end of file
@@ -0,0 +1,83 @@
+#include "LatencyHistogram.h"
+#include "IGraphicsCapture.h"
+
+#include <algorithm>
+#include <bit>
+#include <cmath>
+
+size_t LatencyHistogram::BucketIndex(uint64_t value)
+{
+	// Values below 32 have their own bucket each
+	if (value < kSubBucketCount)
+		return static_cast<size_t>(value);
+
+	// Keep the top five significant bits: the leading one selects the power
+	// of two, the next four select one of 16 linear steps within it
+	const int exponent = std::min(static_cast<int>(std::bit_width(value)) - 1, kMaxExponent);
+	const int shift = exponent - (kSubBucketBits - 1);
+	const uint64_t subBucket = std::min(value >> shift, kSubBucketCount - 1) - kSubBucketHalf;
+	return static_cast<size_t>(kSubBucketCount + (exponent - kSubBucketBits) * kSubBucketHalf + subBucket);
+}
+
+uint64_t LatencyHistogram::BucketUpperBound(size_t index)
+{
+	if (index < kSubBucketCount)
+		return index;
+
+	const size_t offset = index - kSubBucketCount;
+	const int exponent = static_cast<int>(offset / kSubBucketHalf) + kSubBucketBits;
+	const int shift = exponent - (kSubBucketBits - 1);
+	const uint64_t subBucket = offset % kSubBucketHalf + kSubBucketHalf;
+	return ((subBucket + 1) << shift) - 1;
+}
+
+void LatencyHistogram::Record(uint64_t microseconds)
+{
+	m_buckets[BucketIndex(microseconds)].fetch_add(1, std::memory_order_relaxed);
+	m_count.fetch_add(1, std::memory_order_relaxed);
+
+	uint64_t max = m_max.load(std::memory_order_relaxed);
+	while (microseconds > max && !m_max.compare_exchange_weak(max, microseconds, std::memory_order_relaxed))
+	{
+	}
+}
+
+void LatencyHistogram::Reset()
+{
+	for (auto& bucket : m_buckets)
+		bucket.store(0, std::memory_order_relaxed);
+	m_count.store(0, std::memory_order_relaxed);
+	m_max.store(0, std::memory_order_relaxed);
+}
+
+uint64_t LatencyHistogram::GetPercentile(double percentile) const
+{
+	// Count from the buckets themselves: m_count may already include samples
+	// whose bucket increment is not visible yet
+	uint64_t total = 0;
+	for (const auto& bucket : m_buckets)
+		total += bucket.load(std::memory_order_relaxed);
+	if (total == 0)
+		return 0;
+
+	const uint64_t rank = std::max<uint64_t>(1, static_cast<uint64_t>(std::ceil(total * std::clamp(percentile, 0.0, 100.0) / 100.0)));
+	uint64_t seen = 0;
+	for (size_t i = 0; i < kBucketCount; ++i)
+	{
+		seen += m_buckets[i].load(std::memory_order_relaxed);
+		if (seen >= rank)
+			return std::min(BucketUpperBound(i), GetMax());
+	}
+	return GetMax();
+}
+
+LatencyPercentiles LatencyHistogram::Summarize() const
+{
+	LatencyPercentiles summary;
+	summary.samples = GetCount();
+	summary.p50Ms = GetPercentile(50.0) / 1000.0;
+	summary.p95Ms = GetPercentile(95.0) / 1000.0;
+	summary.p99Ms = GetPercentile(99.0) / 1000.0;
+	summary.maxMs = GetMax() / 1000.0;
+	return summary;
+}
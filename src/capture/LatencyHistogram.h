@@ -0,0 +1,41 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+
+struct LatencyPercentiles;
+
+// Fixed-size HDR-style histogram of durations in microseconds. Buckets are
+// log-linear: every power of two is split into 16 sub-buckets, so any
+// recorded value is reported within ~6% while the whole range from 1us to
+// hours fits in a few hundred counters. Record() is a handful of relaxed
+// atomic increments, safe from any number of threads and never blocking;
+// readers take a consistent-enough snapshot without stopping writers.
+class LatencyHistogram
+{
+public:
+	void Record(uint64_t microseconds);
+	// Not synchronized with concurrent Record(); call while producers are idle
+	void Reset();
+
+	uint64_t GetCount() const { return m_count.load(std::memory_order_relaxed); }
+	// Value at or below which `percentile` (0-100) of the samples fall
+	uint64_t GetPercentile(double percentile) const;
+	uint64_t GetMax() const { return m_max.load(std::memory_order_relaxed); }
+
+	LatencyPercentiles Summarize() const;
+
+private:
+	static constexpr int kSubBucketBits = 5;
+	static constexpr uint64_t kSubBucketCount = 1ull << kSubBucketBits;
+	static constexpr uint64_t kSubBucketHalf = kSubBucketCount / 2;
+	static constexpr int kMaxExponent = 40; // ~12 days in microseconds
+	static constexpr size_t kBucketCount = kSubBucketCount + (kMaxExponent - kSubBucketBits + 1) * kSubBucketHalf;
+
+	static size_t BucketIndex(uint64_t value);
+	static uint64_t BucketUpperBound(size_t index);
+
+	std::atomic<uint64_t> m_buckets[kBucketCount] = {};
+	std::atomic<uint64_t> m_count = 0;
+	std::atomic<uint64_t> m_max = 0;
+};
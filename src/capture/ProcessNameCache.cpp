@@ -0,0 +1,45 @@
+#include "ProcessNameCache.h"
+
+#include <utility>
+
+ProcessNameCache::ProcessNameCache(Lookup lookup)
+	: m_lookup(std::move(lookup))
+{
+}
+
+std::string ProcessNameCache::Get(int pid)
+{
+	if (pid <= 0)
+		return {};
+
+	{
+		std::lock_guard lock(m_mutex);
+		auto it = m_entries.find(pid);
+		if (it != m_entries.end())
+		{
+			it->second.generation = m_generation;
+			return it->second.name;
+		}
+	}
+
+	// Look up outside the lock; a racing thread at worst repeats the lookup
+	std::string name = m_lookup(pid);
+
+	std::lock_guard lock(m_mutex);
+	++m_lookups;
+	m_entries[pid] = { name, m_generation };
+	return name;
+}
+
+void ProcessNameCache::Prune()
+{
+	std::lock_guard lock(m_mutex);
+	std::erase_if(m_entries, [this](const auto& entry) { return entry.second.generation != m_generation; });
+	++m_generation;
+}
+
+uint64_t ProcessNameCache::GetLookupCount() const
+{
+	std::lock_guard lock(m_mutex);
+	return m_lookups;
+}
@@ -0,0 +1,41 @@
+#pragma once
+
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+
+// Process names by PID for window enumeration, so each process is looked up
+// once (OpenProcess + QueryFullProcessImageName, or a /proc read) instead of
+// once per window per pass. Entries not used during an enumeration pass are
+// dropped by Prune(), which keeps a PID that gets reused after its process
+// exits from inheriting the old name. Safe to use from several threads.
+class ProcessNameCache
+{
+public:
+	using Lookup = std::function<std::string(int pid)>;
+
+	explicit ProcessNameCache(Lookup lookup);
+
+	std::string Get(int pid);
+
+	// Call after each enumeration pass
+	void Prune();
+
+	// OS lookups performed so far (cache misses)
+	uint64_t GetLookupCount() const;
+
+private:
+	struct Entry
+	{
+		std::string name;
+		uint64_t generation = 0;
+	};
+
+	Lookup m_lookup;
+	mutable std::mutex m_mutex;
+	std::unordered_map<int, Entry> m_entries;
+	uint64_t m_generation = 0;
+	uint64_t m_lookups = 0;
+};
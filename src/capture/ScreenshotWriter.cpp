@@ -0,0 +1,168 @@
+#include "ScreenshotWriter.h"
+#include "../platform/Logger.h"
+#include "../video/ThreadPool.h"
+
+#include <chrono>
+#include <cstring>
+#include <format>
+#include <utility>
+
+ScreenshotWriter::ScreenshotWriter(bool retainLatest)
+	: m_retainLatest(retainLatest)
+{
+}
+
+ScreenshotWriter::~ScreenshotWriter()
+{
+	{
+		std::lock_guard lock(m_mutex);
+		m_stopping = true;
+	}
+	m_wake.notify_all();
+
+	if (m_thread.joinable())
+		m_thread.join();
+}
+
+bool ScreenshotWriter::Request(const std::string& filePath)
+{
+	Job job;
+	job.path = filePath;
+	if (!ImageWriter::FormatFromPath(filePath, job.format))
+	{
+		Logger::Error(std::format("Unsupported screenshot format: {} (use .png, .qoi or .bmp)", filePath));
+		return false;
+	}
+
+	std::lock_guard lock(m_mutex);
+	if (m_requests.size() + m_jobs.size() + m_writing >= kMaxPending)
+	{
+		Logger::Warning(std::format("Too many screenshots pending, skipping {}", filePath));
+		return false;
+	}
+
+	if (m_latest.data)
+	{
+		job.frame = m_latest;
+		m_jobs.push_back(std::move(job));
+		StartWorkerLocked();
+		m_wake.notify_one();
+		return true;
+	}
+
+	m_requests.push_back(std::move(job));
+	m_hasRequests.store(true, std::memory_order_release);
+	return true;
+}
+
+void ScreenshotWriter::Offer(const FrameData& frame)
+{
+	if (!frame.data || (!m_retainLatest && !HasRequests()))
+		return;
+
+	const FrameData kept = Keep(frame);
+
+	std::lock_guard lock(m_mutex);
+	if (m_retainLatest)
+		m_latest = kept;
+	if (m_requests.empty())
+		return;
+
+	for (auto& request : m_requests)
+	{
+		request.frame = kept;
+		m_jobs.push_back(std::move(request));
+	}
+	m_requests.clear();
+	m_hasRequests.store(false, std::memory_order_release);
+	StartWorkerLocked();
+	m_wake.notify_one();
+}
+
+void ScreenshotWriter::CancelRequests()
+{
+	std::lock_guard lock(m_mutex);
+	if (!m_requests.empty())
+		Logger::Warning(std::format("Capture stopped before {} screenshot(s) could be taken", m_requests.size()));
+	m_requests.clear();
+	m_hasRequests.store(false, std::memory_order_release);
+	m_latest = {};
+}
+
+FrameData ScreenshotWriter::Keep(const FrameData& frame)
+{
+	FrameData kept;
+	kept.width = frame.width;
+	kept.height = frame.height;
+	kept.stride = frame.stride;
+	kept.size = frame.size;
+	kept.timestampNs = frame.timestampNs;
+	kept.presentationTimeNs = frame.presentationTimeNs;
+	kept.traceId = frame.traceId;
+
+	// Pooled pixels are shared: backends never modify a buffer someone else
+	// still references, so the frame stays intact until it is written
+	if (frame.buffer)
+	{
+		kept.buffer = frame.buffer;
+		kept.data = frame.data;
+		return kept;
+	}
+
+	kept.buffer = m_bufferPool->Acquire(frame.size);
+	std::memcpy(kept.buffer.Data(), frame.data, frame.size);
+	kept.data = kept.buffer.Data();
+	return kept;
+}
+
+void ScreenshotWriter::StartWorkerLocked()
+{
+	// Started on first use; most sessions never take a screenshot
+	if (!m_thread.joinable())
+		m_thread = std::thread(&ScreenshotWriter::WorkerThread, this);
+}
+
+void ScreenshotWriter::WorkerThread()
+{
+	// A pool of its own, half the hardware threads including this one: on the
+	// shared pool the capture stages' batches would queue behind PNG strips
+	const int workers = static_cast<int>(std::thread::hardware_concurrency() / 2) - 1;
+	const auto pool = workers > 0 ? std::make_unique<ThreadPool>(workers) : nullptr;
+
+	std::unique_lock lock(m_mutex);
+	while (true)
+	{
+		m_wake.wait(lock, [this] { return m_stopping || !m_jobs.empty(); });
+		if (m_jobs.empty())
+			return; // Stopping with nothing left to write
+
+		Job job = std::move(m_jobs.front());
+		m_jobs.pop_front();
+		++m_writing;
+		lock.unlock();
+
+		std::vector<uint8_t> encoded;
+		const auto start = std::chrono::steady_clock::now();
+		ImageWriter::Encode(job.format, static_cast<const uint8_t*>(job.frame.data), job.frame.stride, job.frame.width,
+							job.frame.height, encoded, pool.get());
+		const auto encodedAt = std::chrono::steady_clock::now();
+		job.frame = {}; // Return the buffer before the (possibly slow) file write
+
+		if (ImageWriter::WriteFile(job.path, encoded))
+		{
+			m_written.fetch_add(1, std::memory_order_relaxed);
+			const auto end = std::chrono::steady_clock::now();
+			Logger::Info(std::format("Saved screenshot {} ({} KB, encode {:.1f} ms, write {:.1f} ms)", job.path,
+									 encoded.size() / 1024,
+									 std::chrono::duration<double, std::milli>(encodedAt - start).count(),
+									 std::chrono::duration<double, std::milli>(end - encodedAt).count()));
+		}
+		else
+		{
+			Logger::Error(std::format("Failed to write screenshot {}", job.path));
+		}
+
+		lock.lock();
+		--m_writing;
+	}
+}
@@ -0,0 +1,81 @@
+#pragma once
+
+#include "IGraphicsCapture.h"
+#include "../video/ImageWriter.h"
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+// Writes screenshots on a background thread so that saving one never stalls
+// capture. Request() only records the file path; the capture thread then
+// passes each source-resolution frame to Offer(), which takes a reference to
+// the pixels (a copy only for frames without a pooled buffer) and returns.
+// Encoding spreads over a ThreadPool of its own; the format comes from the
+// file extension (see ImageWriter).
+class ScreenshotWriter
+{
+public:
+	// Screenshots waiting for a frame or being written, at most
+	static constexpr size_t kMaxPending = 4;
+
+	// `retainLatest` keeps a reference to the last offered frame so requests
+	// are served right away, for backends that deliver nothing while the
+	// screen is static. Only for backends that never patch a frame buffer in
+	// place once it has been offered.
+	explicit ScreenshotWriter(bool retainLatest = false);
+	// Finishes the screenshots already handed a frame
+	~ScreenshotWriter();
+
+	ScreenshotWriter(const ScreenshotWriter&) = delete;
+	ScreenshotWriter& operator=(const ScreenshotWriter&) = delete;
+
+	// Queues a screenshot of the next offered frame. False if the extension is
+	// not a supported format or kMaxPending screenshots are already pending.
+	bool Request(const std::string& filePath);
+
+	// Capture thread: cheap check before building a frame just for Offer()
+	bool HasRequests() const { return m_hasRequests.load(std::memory_order_acquire); }
+
+	// Capture thread: serves all waiting requests with `frame`
+	void Offer(const FrameData& frame);
+
+	// Drops requests still waiting for a frame and the retained frame, e.g.
+	// when capture stops. Screenshots already being written are unaffected.
+	void CancelRequests();
+
+	uint64_t GetWrittenCount() const { return m_written.load(std::memory_order_relaxed); }
+
+private:
+	struct Job
+	{
+		std::string path;
+		ImageFormat format = ImageFormat::Png;
+		FrameData frame; // Owns its pixels through frame.buffer
+	};
+
+	FrameData Keep(const FrameData& frame);
+	void StartWorkerLocked();
+	void WorkerThread();
+
+	const bool m_retainLatest;
+	std::shared_ptr<FrameBufferPool> m_bufferPool = FrameBufferPool::Create();
+
+	std::mutex m_mutex;
+	std::condition_variable m_wake;
+	std::vector<Job> m_requests; // Waiting for a frame
+	std::deque<Job> m_jobs;		 // Ready to encode
+	size_t m_writing = 0;		 // Jobs taken by the worker, not yet written
+	FrameData m_latest;			 // With retainLatest
+	bool m_stopping = false;
+	std::thread m_thread;
+
+	std::atomic<bool> m_hasRequests = false;
+	std::atomic<uint64_t> m_written = 0;
+};
@@ -0,0 +1,154 @@
+#include "SourceRegistry.h"
+
+#include <string_view>
+#include <unordered_map>
+#include <utility>
+
+namespace
+{
+	bool SameSource(const Monitor& a, const Monitor& b)
+	{
+		return a.name == b.name && a.x == b.x && a.y == b.y && a.width == b.width && a.height == b.height &&
+			   a.isPrimary == b.isPrimary && a.dpiScale == b.dpiScale;
+	}
+
+	bool SameSource(const Window& a, const Window& b)
+	{
+		return a.title == b.title && a.processName == b.processName && a.processId == b.processId && a.x == b.x &&
+			   a.y == b.y && a.width == b.width && a.height == b.height && a.isVisible == b.isVisible &&
+			   a.isMinimized == b.isMinimized;
+	}
+
+	template <typename Source>
+	void DiffSources(const std::vector<Source>& previous, const std::vector<Source>& current, SourceChanges& changes)
+	{
+		std::unordered_map<std::string_view, const Source*> remaining;
+		remaining.reserve(previous.size());
+		for (const auto& source : previous)
+			remaining.emplace(source.id, &source);
+
+		for (const auto& source : current)
+		{
+			auto it = remaining.find(source.id);
+			if (it == remaining.end())
+			{
+				changes.added.push_back(source.id);
+				continue;
+			}
+			if (!SameSource(*it->second, source))
+				changes.changed.push_back(source.id);
+			remaining.erase(it);
+		}
+
+		// Keep the previous order for what disappeared
+		for (const auto& source : previous)
+		{
+			if (remaining.contains(source.id))
+				changes.removed.push_back(source.id);
+		}
+	}
+}
+
+SourceRegistry::SourceRegistry(IGraphicsCapture& capture, std::chrono::milliseconds interval)
+	: m_capture(capture), m_interval(interval), m_snapshot(std::make_shared<SourceSnapshot>())
+{
+}
+
+SourceRegistry::~SourceRegistry()
+{
+	Stop();
+}
+
+void SourceRegistry::Start()
+{
+	if (m_thread.joinable())
+		return;
+
+	Update();
+
+	std::lock_guard lock(m_mutex);
+	m_running = true;
+	m_thread = std::thread(&SourceRegistry::WorkerThread, this);
+}
+
+void SourceRegistry::Stop()
+{
+	{
+		std::lock_guard lock(m_mutex);
+		m_running = false;
+	}
+	m_wake.notify_all();
+
+	if (m_thread.joinable())
+		m_thread.join();
+}
+
+void SourceRegistry::Refresh()
+{
+	{
+		std::lock_guard lock(m_mutex);
+		m_refreshRequested = true;
+	}
+	m_wake.notify_all();
+}
+
+std::shared_ptr<const SourceSnapshot> SourceRegistry::GetSnapshot() const
+{
+	std::lock_guard lock(m_snapshotMutex);
+	return m_snapshot;
+}
+
+void SourceRegistry::SetChangeCallback(const SourceChangeCallback& callback)
+{
+	std::lock_guard lock(m_callbackMutex);
+	m_callback = callback;
+}
+
+SourceChanges SourceRegistry::Diff(const SourceSnapshot& previous, const SourceSnapshot& current)
+{
+	SourceChanges changes;
+	DiffSources(previous.monitors, current.monitors, changes);
+	DiffSources(previous.windows, current.windows, changes);
+	return changes;
+}
+
+void SourceRegistry::Update()
+{
+	auto next = std::make_shared<SourceSnapshot>();
+	next->monitors = m_capture.GetMonitors();
+	next->windows = m_capture.GetWindows();
+
+	// Only this thread publishes, so the snapshot cannot change underneath
+	const std::shared_ptr<const SourceSnapshot> previous = GetSnapshot();
+	SourceChanges changes = Diff(*previous, *next);
+	if (changes.added.empty() && changes.removed.empty() && changes.changed.empty() && previous->version > 0)
+		return;
+
+	next->version = previous->version + 1;
+	std::shared_ptr<const SourceSnapshot> published = std::move(next);
+	{
+		std::lock_guard lock(m_snapshotMutex);
+		m_snapshot = published;
+	}
+
+	std::lock_guard lock(m_callbackMutex);
+	if (m_callback)
+		m_callback(published, changes);
+}
+
+void SourceRegistry::WorkerThread()
+{
+	std::unique_lock lock(m_mutex);
+	while (true)
+	{
+		m_wake.wait_for(lock, m_interval, [this] { return !m_running || m_refreshRequested; });
+		if (!m_running)
+			return;
+		m_refreshRequested = false;
+
+		// Enumeration can take a while (hundreds of windows); do not hold up Refresh() or Stop()
+		lock.unlock();
+		Update();
+		lock.lock();
+	}
+}
@@ -0,0 +1,86 @@
+#pragma once
+
+#include "IGraphicsCapture.h"
+
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+// Immutable view of the capturable sources at one point in time. Shared
+// between threads by shared_ptr; never modified after publication.
+struct SourceSnapshot
+{
+	uint64_t version = 0; // Increments with every published change
+	std::vector<Monitor> monitors;
+	std::vector<Window> windows;
+};
+
+// Source ids that differ between two consecutive snapshots
+struct SourceChanges
+{
+	std::vector<std::string> added;
+	std::vector<std::string> removed;
+	std::vector<std::string> changed; // Title, geometry or state
+};
+
+// Invoked on the registry thread after a new snapshot is published
+using SourceChangeCallback = std::function<void(const std::shared_ptr<const SourceSnapshot>& snapshot, const SourceChanges& changes)>;
+
+// Keeps the monitor and window lists of a capture backend up to date on a
+// background thread, so the UI can read them every frame for the cost of a
+// shared_ptr copy. Each pass enumerates through the backend, compares the
+// result with the current snapshot and publishes a new one only when
+// something changed.
+class SourceRegistry
+{
+public:
+	static constexpr std::chrono::milliseconds kDefaultInterval{ 1000 };
+
+	// `capture` must outlive the registry, or at least Stop()
+	explicit SourceRegistry(IGraphicsCapture& capture, std::chrono::milliseconds interval = kDefaultInterval);
+	~SourceRegistry();
+
+	SourceRegistry(const SourceRegistry&) = delete;
+	SourceRegistry& operator=(const SourceRegistry&) = delete;
+
+	// The first pass runs before Start() returns, so a snapshot is available
+	// right away
+	void Start();
+	void Stop();
+
+	// Enumerate now instead of at the next interval, e.g. after a display change
+	void Refresh();
+
+	// Never null; empty until the first pass
+	std::shared_ptr<const SourceSnapshot> GetSnapshot() const;
+
+	void SetChangeCallback(const SourceChangeCallback& callback);
+
+	// Compares two snapshots by source id
+	static SourceChanges Diff(const SourceSnapshot& previous, const SourceSnapshot& current);
+
+private:
+	void Update();
+	void WorkerThread();
+
+	IGraphicsCapture& m_capture;
+	std::chrono::milliseconds m_interval;
+
+	mutable std::mutex m_snapshotMutex;
+	std::shared_ptr<const SourceSnapshot> m_snapshot;
+
+	std::mutex m_callbackMutex;
+	SourceChangeCallback m_callback;
+
+	std::mutex m_mutex;
+	std::condition_variable m_wake;
+	bool m_running = false;
+	bool m_refreshRequested = false;
+	std::thread m_thread;
+};
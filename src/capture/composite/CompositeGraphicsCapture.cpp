@@ -0,0 +1,732 @@
+#include "CompositeGraphicsCapture.h"
+#include "../CaptureScaler.h"
+#include "../../platform/Logger.h"
+#include "../../platform/ProcessMetrics.h"
+
+#include <algorithm>
+#include <climits>
+#include <cmath>
+#include <cstring>
+#include <format>
+#include <utility>
+
+namespace
+{
+	FrameClock::Clock::time_point ToTimePoint(uint64_t ns)
+	{
+		return FrameClock::Clock::time_point(
+			std::chrono::duration_cast<FrameClock::Clock::duration>(std::chrono::nanoseconds(ns)));
+	}
+
+	bool Overlaps(const Monitor& a, const Monitor& b)
+	{
+		return a.x < b.x + b.width && b.x < a.x + a.width && a.y < b.y + b.height && b.y < a.y + a.height;
+	}
+}
+
+CompositeGraphicsCapture::CompositeGraphicsCapture(CaptureBackend backend)
+	: m_backend(backend)
+	, m_enumerator(IGraphicsCapture::Create(backend))
+{
+}
+
+CompositeGraphicsCapture::~CompositeGraphicsCapture()
+{
+	Shutdown();
+}
+
+bool CompositeGraphicsCapture::Initialize()
+{
+	if (m_initialized)
+		return true;
+
+	if (!m_enumerator || !m_enumerator->Initialize())
+		return false;
+
+	m_initialized = true;
+	return true;
+}
+
+bool CompositeGraphicsCapture::SetD3DDevice(void* d3dDevice)
+{
+	// Handed to every session as it starts
+	m_d3dDevice = d3dDevice;
+	return m_enumerator && m_enumerator->SetD3DDevice(d3dDevice);
+}
+
+void CompositeGraphicsCapture::Shutdown()
+{
+	StopCapture();
+	if (m_enumerator)
+		m_enumerator->Shutdown();
+	m_initialized = false;
+}
+
+bool CompositeGraphicsCapture::IsSupported() const
+{
+	return m_enumerator && m_enumerator->IsSupported();
+}
+
+std::vector<Monitor> CompositeGraphicsCapture::GetMonitors() const
+{
+	return m_initialized ? m_enumerator->GetMonitors() : std::vector<Monitor>();
+}
+
+std::vector<Window> CompositeGraphicsCapture::GetWindows() const
+{
+	return m_initialized ? m_enumerator->GetWindows() : std::vector<Window>();
+}
+
+std::vector<CaptureSource> CompositeGraphicsCapture::GetAvailableSources() const
+{
+	if (!m_initialized)
+		return {};
+
+	std::vector<CaptureSource> sources = m_enumerator->GetAvailableSources();
+
+	const std::vector<Monitor> monitors = m_enumerator->GetMonitors();
+	if (monitors.size() > 1)
+	{
+		int right = INT_MIN, bottom = INT_MIN, left = INT_MAX, top = INT_MAX;
+		for (const CompositeLayer& layer : ArrangeMonitors(monitors).layers)
+		{
+			const auto it = std::find_if(monitors.begin(), monitors.end(),
+										 [&](const Monitor& monitor) { return monitor.id == layer.sourceId; });
+			left = std::min(left, layer.x);
+			top = std::min(top, layer.y);
+			right = std::max(right, layer.x + it->width);
+			bottom = std::max(bottom, layer.y + it->height);
+		}
+
+		CaptureSource all;
+		all.id = kAllMonitorsSourceId;
+		all.name = std::format("All Monitors ({})", monitors.size());
+		all.isMonitor = true;
+		all.width = right - left;
+		all.height = bottom - top;
+		sources.push_back(all);
+	}
+
+	return sources;
+}
+
+bool CompositeGraphicsCapture::SetCaptureConfig(const CaptureConfig& config)
+{
+	std::lock_guard lock(m_mutex);
+	if (m_isCapturing)
+	{
+		if (!IsFrameRateChangeOnly(m_config, config))
+			return false;
+		// The sessions pace themselves too; they take the same live change
+		m_config.targetFps = config.targetFps;
+		m_pacer.SetTargetFps(config.targetFps);
+		for (const auto& layer : m_layers)
+			layer->capture->SetTargetFps(config.targetFps);
+		return true;
+	}
+
+	m_config = config;
+	return true;
+}
+
+CaptureConfig CompositeGraphicsCapture::GetCaptureConfig() const
+{
+	std::lock_guard lock(m_mutex);
+	return m_config;
+}
+
+bool CompositeGraphicsCapture::SetTargetFps(int fps)
+{
+	std::lock_guard lock(m_mutex);
+	if (!m_initialized)
+		return false;
+
+	m_config.targetFps = fps;
+	m_pacer.SetTargetFps(fps);
+	// The sessions pace themselves too
+	bool applied = true;
+	for (const auto& layer : m_layers)
+		applied &= layer->capture->SetTargetFps(fps);
+	return applied;
+}
+
+CompositeLayout CompositeGraphicsCapture::ArrangeMonitors(const std::vector<Monitor>& monitors, float scale)
+{
+	bool overlapping = false;
+	for (size_t i = 0; i < monitors.size() && !overlapping; ++i)
+	{
+		for (size_t j = i + 1; j < monitors.size() && !overlapping; ++j)
+			overlapping = Overlaps(monitors[i], monitors[j]);
+	}
+
+	CompositeLayout layout;
+	int nextX = 0;
+	for (const Monitor& monitor : monitors)
+	{
+		CompositeLayer layer;
+		layer.sourceId = monitor.id;
+		layer.x = static_cast<int>(std::lround((overlapping ? nextX : monitor.x) * scale));
+		layer.y = static_cast<int>(std::lround((overlapping ? 0 : monitor.y) * scale));
+		layer.scale = scale;
+		layout.layers.push_back(layer);
+		nextX += monitor.width;
+	}
+	return layout;
+}
+
+bool CompositeGraphicsCapture::StartCapture(const std::string& sourceId)
+{
+	if (!m_initialized)
+		return false;
+
+	CompositeLayout layout;
+	if (sourceId == kAllMonitorsSourceId)
+	{
+		const std::vector<Monitor> monitors = m_enumerator->GetMonitors();
+		layout = ArrangeMonitors(monitors);
+		if (m_config.region.width > 0 && m_config.region.height > 0)
+		{
+			// The region is in arrangement pixels, counted from its top-left
+			// corner; each monitor keeps the part of it that overlaps
+			int left = INT_MAX, top = INT_MAX;
+			for (const CompositeLayer& layer : layout.layers)
+			{
+				left = std::min(left, layer.x);
+				top = std::min(top, layer.y);
+			}
+
+			const FrameRect& region = m_config.region;
+			std::vector<CompositeLayer> layers;
+			for (size_t i = 0; i < layout.layers.size(); ++i)
+			{
+				CompositeLayer layer = layout.layers[i];
+				const FrameRect crop = ClipCaptureRegion(
+					{ region.x - (layer.x - left), region.y - (layer.y - top), region.width, region.height },
+					monitors[i].width, monitors[i].height);
+				if (crop.width <= 0 || crop.height <= 0)
+					continue;
+				layer.x += crop.x;
+				layer.y += crop.y;
+				layer.region = crop;
+				layers.push_back(layer);
+			}
+			if (layers.empty())
+			{
+				Logger::Error("Capture region is outside every monitor");
+				return false;
+			}
+			layout.layers = std::move(layers);
+		}
+	}
+	else
+	{
+		CompositeLayer layer;
+		layer.sourceId = sourceId;
+		layer.region = m_config.region;
+		layout.layers.push_back(layer);
+	}
+
+	if (!StartCapture(layout))
+		return false;
+
+	std::lock_guard lock(m_mutex);
+	m_sourceId = sourceId;
+	return true;
+}
+
+bool CompositeGraphicsCapture::StartCapture(const CompositeLayout& layout)
+{
+	if (!m_initialized)
+		return false;
+
+	if (layout.layers.empty())
+	{
+		Logger::Error("Composite layout has no layers");
+		return false;
+	}
+
+	// Layout pixels: each source (or its region) at its native size times its scale
+	const std::vector<CaptureSource> sources = m_enumerator->GetAvailableSources();
+	std::vector<FrameRect> regions;
+	std::vector<FrameRect> nativeSizes;
+	std::vector<FrameRect> rects;
+	for (const CompositeLayer& layer : layout.layers)
+	{
+		const auto it = std::find_if(sources.begin(), sources.end(),
+									 [&](const CaptureSource& source) { return source.id == layer.sourceId; });
+		if (it == sources.end() || it->width <= 0 || it->height <= 0)
+		{
+			Logger::Error(std::format("Unknown composite source: {}", layer.sourceId));
+			return false;
+		}
+		if (!(layer.scale > 0.0f))
+		{
+			Logger::Error(std::format("Invalid scale {} for composite source {}", layer.scale, layer.sourceId));
+			return false;
+		}
+
+		const FrameRect region = ClipCaptureRegion(layer.region, it->width, it->height);
+		if (region.width <= 0 || region.height <= 0)
+		{
+			Logger::Error(std::format("Region is outside composite source {}", layer.sourceId));
+			return false;
+		}
+
+		const float scale = std::min(layer.scale, 1.0f);
+		regions.push_back(region);
+		nativeSizes.push_back({ 0, 0, region.width, region.height });
+		rects.push_back({ layer.x, layer.y, std::max(1, static_cast<int>(std::lround(region.width * scale))),
+						  std::max(1, static_cast<int>(std::lround(region.height * scale))) });
+	}
+
+	const bool autoCanvas = layout.canvasWidth <= 0 || layout.canvasHeight <= 0;
+	int canvasWidth = layout.canvasWidth;
+	int canvasHeight = layout.canvasHeight;
+	if (autoCanvas)
+	{
+		int left = INT_MAX, top = INT_MAX, right = INT_MIN, bottom = INT_MIN;
+		for (const FrameRect& rect : rects)
+		{
+			left = std::min(left, rect.x);
+			top = std::min(top, rect.y);
+			right = std::max(right, rect.x + rect.width);
+			bottom = std::max(bottom, rect.y + rect.height);
+		}
+		for (FrameRect& rect : rects)
+		{
+			rect.x -= left;
+			rect.y -= top;
+		}
+		canvasWidth = right - left;
+		canvasHeight = bottom - top;
+	}
+
+	// The canvas obeys CaptureConfig like any captured frame. Instead of
+	// scaling it afterwards, every source is scaled once, straight to the
+	// size it ends up at.
+	int outputWidth, outputHeight;
+	CaptureScaler::GetOutputSize(m_config, canvasWidth, canvasHeight, outputWidth, outputHeight);
+	const double fit = std::min(static_cast<double>(outputWidth) / canvasWidth, static_cast<double>(outputHeight) / canvasHeight);
+	if (fit < 1.0)
+	{
+		canvasWidth = outputWidth;
+		canvasHeight = outputHeight;
+	}
+	for (size_t i = 0; i < rects.size(); ++i)
+	{
+		FrameRect& rect = rects[i];
+		if (fit < 1.0)
+		{
+			rect.x = static_cast<int>(std::floor(rect.x * fit));
+			rect.y = static_cast<int>(std::floor(rect.y * fit));
+			rect.width = std::max(1, static_cast<int>(std::lround(rect.width * fit)));
+			rect.height = std::max(1, static_cast<int>(std::lround(rect.height * fit)));
+		}
+
+		// Exactly the size the session will deliver (the scaler keeps the
+		// aspect ratio and rounds to even sizes)
+		FrameScaler::FitWithin(nativeSizes[i].width, nativeSizes[i].height, rect.width, rect.height, rect.width, rect.height);
+	}
+	if (autoCanvas)
+	{
+		canvasWidth = canvasHeight = 0;
+		for (const FrameRect& rect : rects)
+		{
+			canvasWidth = std::max(canvasWidth, rect.x + rect.width);
+			canvasHeight = std::max(canvasHeight, rect.y + rect.height);
+		}
+		// Even sizes for 4:2:0 downstream; a single source keeps its own size
+		// so its frames pass through
+		if (rects.size() > 1)
+		{
+			canvasWidth = (canvasWidth + 1) & ~1;
+			canvasHeight = (canvasHeight + 1) & ~1;
+		}
+	}
+
+	// Sessions with the same source and size carry over from the current
+	// layout; the rest are started here. Nothing changes if one fails.
+	std::vector<Layer*> reused(rects.size(), nullptr);
+	std::vector<std::unique_ptr<Layer>> started;
+	for (size_t i = 0; i < rects.size(); ++i)
+	{
+		for (const auto& current : m_layers)
+		{
+			const bool taken = std::find(reused.begin(), reused.end(), current.get()) != reused.end();
+			const FrameRect& region = current->region;
+			if (!taken && current->sourceId == layout.layers[i].sourceId && current->rect.width == rects[i].width &&
+				current->rect.height == rects[i].height && region.x == regions[i].x && region.y == regions[i].y &&
+				region.width == regions[i].width && region.height == regions[i].height)
+			{
+				reused[i] = current.get();
+				break;
+			}
+		}
+		if (reused[i])
+			continue;
+
+		auto layer = std::make_unique<Layer>();
+		layer->sourceId = layout.layers[i].sourceId;
+		layer->region = regions[i];
+		layer->rect = rects[i];
+		if (!StartLayer(*layer))
+		{
+			for (auto& layer : started)
+				layer->capture->StopCapture();
+			return false;
+		}
+		started.push_back(std::move(layer));
+	}
+
+	std::vector<std::unique_ptr<Layer>> retired;
+	{
+		std::lock_guard lock(m_mutex);
+		std::vector<std::unique_ptr<Layer>> layers;
+		size_t next = 0;
+		for (size_t i = 0; i < rects.size(); ++i)
+		{
+			if (reused[i])
+			{
+				auto it = std::find_if(m_layers.begin(), m_layers.end(),
+									   [&](const std::unique_ptr<Layer>& layer) { return layer.get() == reused[i]; });
+				layers.push_back(std::move(*it));
+				layers.back()->rect = rects[i];
+			}
+			else
+			{
+				// Started with the frame rate of a moment ago; it may have
+				// changed since, and from here on SetTargetFps() reaches it
+				layers.push_back(std::move(started[next++]));
+				layers.back()->capture->SetTargetFps(m_config.targetFps);
+			}
+		}
+		for (auto& layer : m_layers)
+		{
+			if (layer)
+				retired.push_back(std::move(layer));
+		}
+
+		m_layers = std::move(layers);
+		m_canvasWidth = canvasWidth;
+		m_canvasHeight = canvasHeight;
+		m_background = layout.background;
+		m_sourceId.clear();
+		++m_layoutVersion;
+		m_hasPending = true; // Redraw the carried-over layers at their new place
+	}
+	m_wake.notify_one();
+
+	// Outside the lock: their workers may be waiting for it in OnLayerFrame()
+	for (auto& layer : retired)
+		layer->capture->StopCapture();
+	retired.clear();
+
+	if (!m_isCapturing)
+	{
+		{
+			std::lock_guard lock(m_mutex);
+			m_pacer.SetTargetFps(m_config.targetFps);
+		}
+		m_pacer.Reset();
+		m_worker.Start(m_config.queueDepth, m_config.dropPolicy);
+		m_stopRequested = false;
+		m_isCapturing = true;
+		m_thread = std::thread(&CompositeGraphicsCapture::CompositorThread, this);
+	}
+
+	Logger::Info(std::format("Composite capture: {} source(s) on a {}x{} canvas", rects.size(), canvasWidth, canvasHeight));
+	return true;
+}
+
+bool CompositeGraphicsCapture::StartLayer(Layer& layer)
+{
+	layer.capture = IGraphicsCapture::Create(m_backend);
+	if (!layer.capture || !layer.capture->Initialize())
+	{
+		Logger::Error(std::format("Failed to initialize a capture session for {}", layer.sourceId));
+		return false;
+	}
+	if (m_d3dDevice)
+		layer.capture->SetD3DDevice(m_d3dDevice);
+
+	// The session delivers its part of the source already at its canvas size
+	CaptureConfig config = GetCaptureConfig(); // targetFps may be changing on another thread
+	config.outputWidth = layer.rect.width;
+	config.outputHeight = layer.rect.height;
+	config.region = layer.region;
+	layer.capture->SetCaptureConfig(config);
+
+	Layer* target = &layer;
+	layer.capture->SetFrameCallback([this, target](const FrameData& frame) { OnLayerFrame(target, frame); });
+	if (config.cursorMode == CursorMode::Metadata)
+		layer.capture->SetCursorCallback([this, target](const CursorState& cursor) { OnLayerCursor(target, cursor); });
+
+	if (!layer.capture->StartCapture(layer.sourceId))
+	{
+		Logger::Error(std::format("Failed to start capturing {}", layer.sourceId));
+		return false;
+	}
+	return true;
+}
+
+void CompositeGraphicsCapture::StopCapture()
+{
+	{
+		std::lock_guard lock(m_mutex);
+		m_stopRequested = true;
+	}
+	m_wake.notify_one();
+	if (m_thread.joinable())
+		m_thread.join();
+
+	std::vector<std::unique_ptr<Layer>> layers;
+	{
+		std::lock_guard lock(m_mutex);
+		layers.swap(m_layers);
+		m_hasPending = false;
+		m_cursor = {};
+		++m_layoutVersion;
+	}
+	for (auto& layer : layers)
+		layer->capture->StopCapture();
+
+	m_worker.Stop();
+	m_screenshots.CancelRequests();
+	m_isCapturing = false;
+}
+
+bool CompositeGraphicsCapture::SetFrameCallback(const FrameCallback& callback)
+{
+	m_worker.SetCallback(callback);
+	return true;
+}
+
+bool CompositeGraphicsCapture::SetCursorCallback(const CursorCallback& callback)
+{
+	std::lock_guard lock(m_cursorCallbackMutex);
+	m_cursorCallback = callback;
+	return true;
+}
+
+bool CompositeGraphicsCapture::GetLatestFrame(FrameData& outFrame) const
+{
+	return m_mailbox.Acquire(outFrame);
+}
+
+bool CompositeGraphicsCapture::SaveScreenshot(const std::string& sourceId, const std::string& filePath) const
+{
+	if (!m_isCapturing)
+	{
+		Logger::Error("Screenshots need a running capture");
+		return false;
+	}
+
+	std::lock_guard lock(m_mutex);
+	for (const auto& layer : m_layers)
+	{
+		if (layer->sourceId == sourceId)
+			return layer->capture->SaveScreenshot(sourceId, filePath);
+	}
+	if (!sourceId.empty() && sourceId != m_sourceId)
+	{
+		Logger::Error(std::format("{} is not part of the composite capture", sourceId));
+		return false;
+	}
+	return m_screenshots.Request(filePath);
+}
+
+CaptureStatistics CompositeGraphicsCapture::GetStatistics() const
+{
+	CaptureStatistics statistics;
+	statistics.framesCapture = m_framesCaptured;
+	m_worker.FillStatistics(statistics);
+	statistics.averageFps = m_pacer.GetAchievedFps();
+	statistics.frameJitterMs = m_pacer.GetJitterMs();
+	statistics.framesOverwritten = m_mailbox.GetOverwrittenCount();
+
+	// Decimation and duplicate detection happen in the sessions
+	{
+		std::lock_guard lock(m_mutex);
+		for (const auto& layer : m_layers)
+		{
+			const CaptureStatistics session = layer->capture->GetStatistics();
+			statistics.framesDecimated += session.framesDecimated;
+			statistics.framesDuplicate += session.framesDuplicate;
+		}
+	}
+
+	const ProcessUsage usage = ProcessMetrics::Sample();
+	statistics.cpuUsage = usage.cpuPercent;
+	statistics.memoryUsage = usage.residentBytes;
+	return statistics;
+}
+
+bool CompositeGraphicsCapture::IsCursorVisible() const
+{
+	std::lock_guard lock(m_mutex);
+	for (const auto& layer : m_layers)
+	{
+		if (layer->capture->IsCursorVisible())
+			return true;
+	}
+	return m_layers.empty() && m_enumerator && m_enumerator->IsCursorVisible();
+}
+
+std::string_view CompositeGraphicsCapture::GetPlatformName() const noexcept
+{
+	return m_enumerator ? m_enumerator->GetPlatformName() : "Composite Capture";
+}
+
+void CompositeGraphicsCapture::OnLayerFrame(Layer* layer, const FrameData& frame)
+{
+	// Nothing to redraw; the compositor still has the previous frame
+	if (!frame.data || frame.isDuplicate)
+		return;
+
+	FrameData kept = frame;
+	kept.dirtyRects = nullptr;
+	kept.dirtyRectCount = 0;
+	if (!kept.buffer)
+	{
+		// Pixels are only valid during the callback
+		kept.buffer = m_bufferPool->Acquire(frame.size);
+		std::memcpy(kept.buffer.Data(), frame.data, frame.size);
+		kept.data = kept.buffer.Data();
+	}
+
+	{
+		std::lock_guard lock(m_mutex);
+		layer->latest = std::move(kept);
+		if (frame.dirtyRectCount == 0)
+		{
+			layer->pendingFull = true;
+			layer->pendingRects.clear();
+		}
+		else if (!layer->pendingFull)
+		{
+			layer->pendingRects.insert(layer->pendingRects.end(), frame.dirtyRects, frame.dirtyRects + frame.dirtyRectCount);
+		}
+		layer->pending = true;
+		m_hasPending = true;
+	}
+	m_wake.notify_one();
+}
+
+void CompositeGraphicsCapture::OnLayerCursor(Layer* layer, const CursorState& cursor)
+{
+	CursorState combined;
+	{
+		std::lock_guard lock(m_mutex);
+		layer->cursor = cursor;
+
+		// Layers are back to front, so the last one showing the cursor is on top
+		for (auto it = m_layers.rbegin(); it != m_layers.rend(); ++it)
+		{
+			const Layer& candidate = **it;
+			if (!candidate.cursor.visible)
+				continue;
+			combined = candidate.cursor;
+			combined.x += candidate.rect.x;
+			combined.y += candidate.rect.y;
+			break;
+		}
+		if (!combined.visible)
+			combined.timestampNs = cursor.timestampNs;
+
+		const bool changed = combined.visible != m_cursor.visible ||
+							 (combined.visible && (combined.x != m_cursor.x || combined.y != m_cursor.y ||
+												   combined.shape != m_cursor.shape || combined.scale != m_cursor.scale));
+		m_cursor = combined;
+		if (!changed)
+			return;
+	}
+
+	std::lock_guard lock(m_cursorCallbackMutex);
+	if (m_cursorCallback)
+		m_cursorCallback(combined);
+}
+
+void CompositeGraphicsCapture::CompositorThread()
+{
+	uint64_t layoutVersion = 0;
+	std::vector<FrameRect> layerRects;
+
+	while (true)
+	{
+		size_t layerCount = 0;
+		{
+			std::unique_lock lock(m_mutex);
+			m_wake.wait(lock, [this] { return m_stopRequested || m_hasPending; });
+			if (m_stopRequested)
+				return;
+			layerCount = m_layers.size();
+		}
+
+		// Sessions are paced individually, but together they would exceed
+		// targetFps: hold it here and fold changes arriving meanwhile into
+		// this composite. A lone session needs no second schedule.
+		if (layerCount > 1 && m_pacer.GetTargetFps() > 0)
+			m_pacer.WaitForNextFrame();
+
+		uint64_t arrivedNs = 0;
+		uint64_t presentedNs = 0;
+		CursorState cursor;
+		{
+			std::lock_guard lock(m_mutex);
+			cursor = m_cursor;
+			if (layoutVersion != m_layoutVersion)
+			{
+				layoutVersion = m_layoutVersion;
+				layerRects.clear();
+				for (const auto& layer : m_layers)
+				{
+					layerRects.push_back(layer->rect);
+					layer->pending = layer->latest.data != nullptr;
+					layer->pendingFull = true;
+					layer->pendingRects.clear();
+				}
+				m_compositor.Configure(m_canvasWidth, m_canvasHeight, layerRects, m_background);
+			}
+
+			for (size_t i = 0; i < m_layers.size(); ++i)
+			{
+				Layer& layer = *m_layers[i];
+				if (!layer.pending)
+					continue;
+
+				FrameData frame = layer.latest;
+				frame.dirtyRects = layer.pendingFull ? nullptr : layer.pendingRects.data();
+				frame.dirtyRectCount = layer.pendingFull ? 0 : layer.pendingRects.size();
+				m_compositor.SetLayerFrame(i, frame);
+
+				// The composite is as old as the oldest change in it
+				arrivedNs = arrivedNs ? std::min(arrivedNs, frame.timestampNs) : frame.timestampNs;
+				presentedNs = presentedNs ? std::min(presentedNs, frame.presentationTimeNs) : frame.presentationTimeNs;
+
+				layer.pending = false;
+				layer.pendingFull = false;
+				layer.pendingRects.clear();
+			}
+			m_hasPending = false;
+		}
+
+		FrameData frameData;
+		if (!m_compositor.Compose(frameData))
+			continue;
+
+		if (!arrivedNs)
+			arrivedNs = FrameClock::Now();
+		frameData.timestampNs = arrivedNs;
+		frameData.presentationTimeNs = presentedNs ? presentedNs : arrivedNs;
+		frameData.traceId = FrameTracer::Shared().Begin(presentedNs, arrivedNs);
+		frameData.isDuplicate = false;
+		frameData.cursor = cursor;
+		FrameTracer::Shared().Stamp(frameData.traceId, FrameStage::Processed);
+
+		m_screenshots.Offer(frameData);
+		m_mailbox.Publish(frameData);
+		m_worker.Push(frameData, ToTimePoint(arrivedNs));
+		m_pacer.MarkDelivered(FramePacer::Clock::now());
+		++m_framesCaptured;
+	}
+}
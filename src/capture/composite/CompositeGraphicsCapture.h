@@ -0,0 +1,164 @@
+#pragma once
+
+#include "../IGraphicsCapture.h"
+#include "../CaptureWorker.h"
+#include "../FrameCompositor.h"
+#include "../FrameMailbox.h"
+#include "../FramePacer.h"
+#include "../ScreenshotWriter.h"
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+// One source placed on the composite canvas
+struct CompositeLayer
+{
+	std::string sourceId;
+	int x = 0; // Top-left corner in layout pixels
+	int y = 0;
+	float scale = 1.0f; // Of the source's native size; sources are never upscaled, so (0, 1]
+	FrameRect region;	// Part of the source to show, in source pixels; empty for all of it
+};
+
+struct CompositeLayout
+{
+	// 0 sizes the canvas to the bounding box of the layers
+	int canvasWidth = 0;
+	int canvasHeight = 0;
+	uint32_t background = 0xFF000000; // BGRA, where no layer covers the canvas
+	std::vector<CompositeLayer> layers; // Back to front
+};
+
+// Captures several sources at once and delivers them as one stream, e.g. two
+// monitors side by side. Every layer runs its own backend session (of the
+// backend chosen at construction) that scales the source straight to the
+// size it takes on the canvas; a compositor thread then redraws only the
+// canvas regions those sessions report as changed (see FrameCompositor) and
+// feeds the result through the usual pacer, mailbox and worker. With a single
+// full-canvas layer the frames pass through without a copy, so plain
+// StartCapture(sourceId) costs no more than the backend alone.
+//
+// Unlike the backends, StartCapture() may be called while capturing: the
+// layout changes in place and sessions whose source and size stay the same
+// keep running.
+class CompositeGraphicsCapture : public IGraphicsCapture
+{
+public:
+	// Captures every monitor, laid out like the desktop (see ArrangeMonitors)
+	static constexpr const char* kAllMonitorsSourceId = "composite:monitors";
+
+	explicit CompositeGraphicsCapture(CaptureBackend backend = CaptureBackend::Auto);
+	~CompositeGraphicsCapture() override;
+
+	bool Initialize() override;
+	bool SetD3DDevice(void* d3dDevice) override;
+	void Shutdown() override;
+
+	bool IsSupported() const override;
+	bool IsInitialized() const override { return m_initialized; }
+
+	// Enumeration goes to a session of the underlying backend
+	std::vector<Monitor> GetMonitors() const override;
+	std::vector<Window> GetWindows() const override;
+	// Also lists kAllMonitorsSourceId when there is more than one monitor
+	std::vector<CaptureSource> GetAvailableSources() const override;
+
+	// CaptureQuality / outputWidth / outputHeight apply to the whole canvas;
+	// the layers are scaled down together with it
+	bool SetCaptureConfig(const CaptureConfig& config) override;
+	CaptureConfig GetCaptureConfig() const override;
+	bool SetTargetFps(int fps) override;
+
+	// A single source filling the canvas, or kAllMonitorsSourceId.
+	// CaptureConfig::region selects part of the source, or of the monitor
+	// arrangement in desktop pixels; monitors outside it are not captured.
+	bool StartCapture(const std::string& sourceId) override;
+	bool StartCapture(const CompositeLayout& layout);
+	void StopCapture() override;
+	bool IsCapturing() const override { return m_isCapturing; }
+
+	bool SetFrameCallback(const FrameCallback& callback) override;
+	// Reports the cursor of the topmost layer it is over, in canvas pixels
+	bool SetCursorCallback(const CursorCallback& callback) override;
+	bool GetLatestFrame(FrameData& outFrame) const override;
+	// A layer's source id saves that source at its native resolution; an
+	// empty id (or the one capture was started with) saves the canvas
+	bool SaveScreenshot(const std::string& sourceId, const std::string& filePath) const override;
+
+	CaptureStatistics GetStatistics() const override;
+	bool IsCursorVisible() const override;
+
+	std::string_view GetPlatformName() const noexcept override;
+
+	// Monitors at their desktop positions, or side by side in a row when those
+	// overlap (e.g. mirrored displays)
+	static CompositeLayout ArrangeMonitors(const std::vector<Monitor>& monitors, float scale = 1.0f);
+
+private:
+	// One capture session and where its frames go on the canvas
+	struct Layer
+	{
+		std::string sourceId;
+		FrameRect region; // Source pixels, clipped to the source
+		FrameRect rect;	  // Canvas pixels
+		std::unique_ptr<IGraphicsCapture> capture;
+
+		// Written by the session's worker thread, guarded by m_mutex
+		FrameData latest; // Owns its pixels through latest.buffer
+		std::vector<FrameRect> pendingRects;
+		bool pending = false;
+		bool pendingFull = false;
+
+		// Written by the session's cursor tracker (CursorMode::Metadata), in
+		// layer pixels; guarded by m_mutex
+		CursorState cursor;
+	};
+
+	bool StartLayer(Layer& layer);
+	void OnLayerFrame(Layer* layer, const FrameData& frame);
+	void OnLayerCursor(Layer* layer, const CursorState& cursor);
+	void CompositorThread();
+
+private:
+	const CaptureBackend m_backend;
+	bool m_initialized = false;
+	std::atomic<bool> m_isCapturing = false;
+	CaptureConfig m_config;
+	void* m_d3dDevice = nullptr;
+
+	// Enumeration only; never captures
+	std::unique_ptr<IGraphicsCapture> m_enumerator;
+
+	// Layout, shared with the session callbacks and the compositor thread
+	mutable std::mutex m_mutex;
+	std::condition_variable m_wake;
+	std::vector<std::unique_ptr<Layer>> m_layers;
+	int m_canvasWidth = 0;
+	int m_canvasHeight = 0;
+	uint32_t m_background = 0xFF000000;
+	uint64_t m_layoutVersion = 0;
+	bool m_hasPending = false;
+	bool m_stopRequested = false;
+	std::string m_sourceId;
+	CursorState m_cursor; // Canvas pixels, combined from the layers
+
+	std::mutex m_cursorCallbackMutex;
+	CursorCallback m_cursorCallback;
+
+	FramePacer m_pacer;
+	FrameCompositor m_compositor; // Compositor thread only
+	CaptureWorker m_worker;
+	mutable FrameMailbox m_mailbox;
+	mutable ScreenshotWriter m_screenshots;
+
+	std::thread m_thread;
+	std::atomic<uint64_t> m_framesCaptured = 0;
+
+	std::shared_ptr<FrameBufferPool> m_bufferPool = FrameBufferPool::Create(); // Sessions without pooled frames
+};
@@ -0,0 +1,977 @@
+#include "LinuxGraphicsCapture.h"
+#include "../../platform/Logger.h"
+#include "../../platform/ProcessMetrics.h"
+#include "../../video/AlphaBlend.h"
+
+#include <algorithm>
+#include <charconv>
+#include <chrono>
+#include <cstring>
+#include <format>
+#include <fstream>
+
+#include <poll.h>
+#include <sys/ipc.h>
+#include <sys/shm.h>
+
+// Rename Xlib's Window typedef so it does not clash with ::Window
+#define Window XWindow
+#include <X11/Xlib.h>
+#include <X11/Xatom.h>
+#include <X11/Xutil.h>
+#include <X11/extensions/XShm.h>
+#include <X11/extensions/Xdamage.h>
+#include <X11/extensions/Xfixes.h>
+#include <X11/extensions/Xrandr.h>
+#undef Window
+#undef CursorShape // An XQueryBestSize class in X.h; we only need ::CursorShape
+
+namespace
+{
+    constexpr const char* kMonitorPrefix = "monitor:";
+    constexpr const char* kWindowPrefix = "window:";
+
+    // Upper bound on an unpaced wait so stop requests are still noticed
+    constexpr int kUnpacedPollMs = 100;
+
+    // Damage older than this is not trusted as a presentation time (the
+    // server clock is probably not ours, e.g. a remote display)
+    constexpr int64_t kMaxDamageAgeMs = 1000;
+
+    // Xorg timestamps are its CLOCK_MONOTONIC in milliseconds, truncated to
+    // 32 bits. Maps one into FrameClock nanoseconds (steady_clock is also
+    // CLOCK_MONOTONIC), or 0 when it does not fit just before `nowNs`.
+    uint64_t ServerTimeToFrameClock(unsigned long serverMs, uint64_t nowNs)
+    {
+        constexpr int64_t kWrap = int64_t{ 1 } << 32;
+        const int64_t nowMs = static_cast<int64_t>(nowNs / 1'000'000);
+        int64_t ms = (nowMs & ~(kWrap - 1)) | static_cast<int64_t>(serverMs & (kWrap - 1));
+        if (ms > nowMs)
+            ms -= kWrap;
+        if (ms < 0 || nowMs - ms > kMaxDamageAgeMs)
+            return 0;
+        return static_cast<uint64_t>(ms) * 1'000'000;
+    }
+
+    // Cursor rectangle on the captured area, clipped to it; empty if hidden
+    FrameRect GetCursorRect(const CursorState& cursor, int width, int height)
+    {
+        if (!cursor.visible || !cursor.shape)
+            return {};
+        const int x0 = std::max(cursor.x - cursor.shape->hotspotX, 0);
+        const int y0 = std::max(cursor.y - cursor.shape->hotspotY, 0);
+        const int x1 = std::min(cursor.x - cursor.shape->hotspotX + cursor.shape->width, width);
+        const int y1 = std::min(cursor.y - cursor.shape->hotspotY + cursor.shape->height, height);
+        if (x1 <= x0 || y1 <= y0)
+            return {};
+        return { x0, y0, x1 - x0, y1 - y0 };
+    }
+
+    int IgnoreXError(Display* display, XErrorEvent* error)
+    {
+        // The default handler exits the process; a window vanishing or resizing
+        // mid-grab is expected and handled by the caller via the return status.
+        char text[128] = {};
+        XGetErrorText(display, error->error_code, text, sizeof(text));
+        Logger::Warning(std::format("X11 error: {} (request {}.{})", text,
+                                    static_cast<int>(error->request_code), static_cast<int>(error->minor_code)));
+        return 0;
+    }
+
+    // Reads a format-32 property; Xlib hands those back as an array of long
+    std::vector<unsigned long> GetCardinalProperty(Display* display, XWindow window, Atom property, Atom type)
+    {
+        std::vector<unsigned long> values;
+
+        Atom actualType = None;
+        int actualFormat = 0;
+        unsigned long count = 0, remaining = 0;
+        unsigned char* data = nullptr;
+        if (XGetWindowProperty(display, window, property, 0, 4096, False, type, &actualType, &actualFormat,
+                               &count, &remaining, &data) == Success && data)
+        {
+            if (actualType == type && actualFormat == 32)
+            {
+                auto* longs = reinterpret_cast<unsigned long*>(data);
+                values.assign(longs, longs + count);
+            }
+            XFree(data);
+        }
+
+        return values;
+    }
+
+    std::string GetWindowTitle(Display* display, XWindow window, Atom netWmName, Atom utf8String)
+    {
+        std::string title;
+
+        Atom actualType = None;
+        int actualFormat = 0;
+        unsigned long count = 0, remaining = 0;
+        unsigned char* data = nullptr;
+        if (XGetWindowProperty(display, window, netWmName, 0, 1024, False, utf8String, &actualType, &actualFormat,
+                               &count, &remaining, &data) == Success && data)
+        {
+            title.assign(reinterpret_cast<char*>(data), count);
+            XFree(data);
+        }
+
+        if (title.empty())
+        {
+            char* name = nullptr;
+            if (XFetchName(display, window, &name) && name)
+            {
+                title = name;
+                XFree(name);
+            }
+        }
+
+        return title;
+    }
+
+    std::string GetProcessName(int pid)
+    {
+        if (pid <= 0)
+            return {};
+
+        std::ifstream comm(std::format("/proc/{}/comm", pid));
+        std::string name;
+        std::getline(comm, name);
+        return name;
+    }
+
+    // Shared-memory XImage that is created once per capture and reused for every grab
+    struct ShmImage
+    {
+        Display* display = nullptr;
+        XShmSegmentInfo info = {};
+        XImage* image = nullptr;
+
+        bool Create(Display* dpy, Visual* visual, int depth, int width, int height)
+        {
+            display = dpy;
+            image = XShmCreateImage(display, visual, depth, ZPixmap, nullptr, &info, width, height);
+            if (!image)
+                return false;
+
+            if (image->bits_per_pixel != 32)
+            {
+                Logger::Error(std::format("Unsupported X11 pixel format: {} bpp", image->bits_per_pixel));
+                XDestroyImage(image);
+                image = nullptr;
+                return false;
+            }
+
+            info.shmid = shmget(IPC_PRIVATE, static_cast<size_t>(image->bytes_per_line) * height, IPC_CREAT | 0600);
+            if (info.shmid < 0)
+            {
+                XDestroyImage(image);
+                image = nullptr;
+                return false;
+            }
+
+            info.shmaddr = image->data = static_cast<char*>(shmat(info.shmid, nullptr, 0));
+            info.readOnly = False;
+            bool attached = info.shmaddr != reinterpret_cast<char*>(-1) && XShmAttach(display, &info);
+            XSync(display, False);
+
+            // Mark for removal now; the kernel frees it once both sides detach,
+            // so a crash can never leak the segment.
+            shmctl(info.shmid, IPC_RMID, nullptr);
+
+            if (!attached)
+            {
+                if (info.shmaddr != reinterpret_cast<char*>(-1))
+                    shmdt(info.shmaddr);
+                image->data = nullptr;
+                XDestroyImage(image);
+                image = nullptr;
+                return false;
+            }
+
+            return true;
+        }
+
+        void Destroy()
+        {
+            if (!image)
+                return;
+
+            XShmDetach(display, &info);
+            XSync(display, False);
+            XDestroyImage(image); // Frees only the XImage struct for shm images
+            shmdt(info.shmaddr);
+            image = nullptr;
+            info = {};
+        }
+
+        ~ShmImage() { Destroy(); }
+    };
+}
+
+LinuxGraphicsCapture::LinuxGraphicsCapture()
+    : m_processNames(GetProcessName)
+{
+}
+
+LinuxGraphicsCapture::~LinuxGraphicsCapture()
+{
+    Shutdown();
+}
+
+bool LinuxGraphicsCapture::Initialize()
+{
+    XInitThreads();
+    XSetErrorHandler(IgnoreXError);
+
+    m_display = XOpenDisplay(nullptr);
+    if (!m_display)
+    {
+        Logger::Error("Failed to open X11 display (is DISPLAY set?)");
+        return false;
+    }
+
+    if (!IsSupported())
+    {
+        Logger::Error("X server lacks MIT-SHM, XDamage or XFixes");
+        XCloseDisplay(m_display);
+        m_display = nullptr;
+        return false;
+    }
+
+    Logger::Info(std::format("X11 capture initialized on display {}", DisplayString(m_display)));
+    m_initialized = true;
+    return true;
+}
+
+bool LinuxGraphicsCapture::SetD3DDevice(void* d3dDevice)
+{
+    // Grabs land in system memory, no device is needed
+    (void)d3dDevice;
+    return true;
+}
+
+void LinuxGraphicsCapture::Shutdown()
+{
+    StopCapture();
+
+    if (m_display)
+    {
+        XCloseDisplay(m_display);
+        m_display = nullptr;
+    }
+    m_initialized = false;
+}
+
+bool LinuxGraphicsCapture::IsSupported() const
+{
+    if (!m_display)
+        return false;
+
+    int eventBase = 0, errorBase = 0;
+    return XShmQueryExtension(m_display) &&
+           XDamageQueryExtension(m_display, &eventBase, &errorBase) &&
+           XFixesQueryExtension(m_display, &eventBase, &errorBase);
+}
+
+std::vector<Monitor> LinuxGraphicsCapture::GetMonitors() const
+{
+    std::vector<Monitor> monitors;
+
+    if (!m_initialized)
+        return monitors;
+
+    XWindow root = DefaultRootWindow(m_display);
+    int count = 0;
+    XRRMonitorInfo* infos = XRRGetMonitors(m_display, root, True, &count);
+
+    for (int i = 0; i < count; ++i)
+    {
+        Monitor monitor;
+        char* name = XGetAtomName(m_display, infos[i].name);
+        monitor.name = name ? name : std::format("Monitor {}", i);
+        if (name)
+            XFree(name);
+
+        monitor.id = kMonitorPrefix + monitor.name;
+        monitor.x = infos[i].x;
+        monitor.y = infos[i].y;
+        monitor.width = infos[i].width;
+        monitor.height = infos[i].height;
+        monitor.isPrimary = infos[i].primary != 0;
+        monitor.dpiScale = infos[i].mwidth > 0 ? (infos[i].width * 25.4f / infos[i].mwidth) / 96.0f : 1.0f;
+        monitors.push_back(monitor);
+    }
+
+    if (infos)
+        XRRFreeMonitors(infos);
+
+    // No RandR monitors (e.g. bare Xvfb): expose the whole screen
+    if (monitors.empty())
+    {
+        Screen* screen = DefaultScreenOfDisplay(m_display);
+
+        Monitor monitor;
+        monitor.id = std::string(kMonitorPrefix) + "screen";
+        monitor.name = "Screen";
+        monitor.x = 0;
+        monitor.y = 0;
+        monitor.width = WidthOfScreen(screen);
+        monitor.height = HeightOfScreen(screen);
+        monitor.isPrimary = true;
+        monitor.dpiScale = 1.0f;
+        monitors.push_back(monitor);
+    }
+
+    return monitors;
+}
+
+std::vector<Window> LinuxGraphicsCapture::GetWindows() const
+{
+    std::vector<Window> windows;
+
+    if (!m_initialized)
+        return windows;
+
+    XWindow root = DefaultRootWindow(m_display);
+    Atom clientList = XInternAtom(m_display, "_NET_CLIENT_LIST", False);
+    Atom netWmName = XInternAtom(m_display, "_NET_WM_NAME", False);
+    Atom netWmPid = XInternAtom(m_display, "_NET_WM_PID", False);
+    Atom netWmState = XInternAtom(m_display, "_NET_WM_STATE", False);
+    Atom stateHidden = XInternAtom(m_display, "_NET_WM_STATE_HIDDEN", False);
+    Atom utf8String = XInternAtom(m_display, "UTF8_STRING", False);
+
+    std::vector<unsigned long> handles = GetCardinalProperty(m_display, root, clientList, XA_WINDOW);
+
+    // Without a window manager there is no client list; fall back to top-level children
+    if (handles.empty())
+    {
+        XWindow rootReturn = 0, parent = 0;
+        XWindow* children = nullptr;
+        unsigned int count = 0;
+        if (XQueryTree(m_display, root, &rootReturn, &parent, &children, &count) && children)
+        {
+            handles.assign(children, children + count);
+            XFree(children);
+        }
+    }
+
+    for (unsigned long handle : handles)
+    {
+        XWindowAttributes attributes;
+        if (!XGetWindowAttributes(m_display, handle, &attributes) || attributes.c_class != InputOutput)
+            continue;
+
+        std::string title = GetWindowTitle(m_display, handle, netWmName, utf8String);
+        if (title.empty())
+            continue;
+
+        Window window;
+        window.id = kWindowPrefix + std::to_string(handle);
+        window.title = title;
+
+        auto pids = GetCardinalProperty(m_display, handle, netWmPid, XA_CARDINAL);
+        window.processId = pids.empty() ? 0 : static_cast<int>(pids.front());
+        window.processName = m_processNames.Get(window.processId);
+
+        XWindow child = 0;
+        XTranslateCoordinates(m_display, handle, root, 0, 0, &window.x, &window.y, &child);
+        window.width = attributes.width;
+        window.height = attributes.height;
+
+        auto states = GetCardinalProperty(m_display, handle, netWmState, XA_ATOM);
+        window.isMinimized = std::find(states.begin(), states.end(), stateHidden) != states.end();
+        window.isVisible = attributes.map_state == IsViewable;
+
+        windows.push_back(window);
+    }
+
+    m_processNames.Prune();
+    return windows;
+}
+
+std::vector<CaptureSource> LinuxGraphicsCapture::GetAvailableSources() const
+{
+    std::vector<CaptureSource> sources;
+
+    // Add monitors as sources
+    for (const auto& monitor : GetMonitors())
+    {
+        CaptureSource source;
+        source.id = monitor.id;
+        source.name = monitor.name + (monitor.isPrimary ? " (Primary)" : "");
+        source.isMonitor = true;
+        source.width = monitor.width;
+        source.height = monitor.height;
+        sources.push_back(source);
+    }
+
+    // Add windows as sources
+    for (const auto& window : GetWindows())
+    {
+        if (window.isVisible && !window.isMinimized && window.width > 100 && window.height > 100)
+        {
+            CaptureSource source;
+            source.id = window.id;
+            source.name = window.title + " - " + window.processName;
+            source.isMonitor = false;
+            source.width = window.width;
+            source.height = window.height;
+            sources.push_back(source);
+        }
+    }
+
+    return sources;
+}
+
+bool LinuxGraphicsCapture::ResolveTarget(const std::string& sourceId, CaptureTarget& target) const
+{
+    if (sourceId.starts_with(kMonitorPrefix))
+    {
+        for (const auto& monitor : GetMonitors())
+        {
+            if (monitor.id == sourceId)
+            {
+                // Monitors are rectangles of the root window
+                target.drawable = DefaultRootWindow(m_display);
+                target.sourceX = monitor.x;
+                target.sourceY = monitor.y;
+                target.sourceWidth = monitor.width;
+                target.sourceHeight = monitor.height;
+                return true;
+            }
+        }
+        return false;
+    }
+
+    if (sourceId.starts_with(kWindowPrefix))
+    {
+        const char* first = sourceId.data() + std::strlen(kWindowPrefix);
+        const char* last = sourceId.data() + sourceId.size();
+        XWindow handle = 0;
+        auto [end, ec] = std::from_chars(first, last, handle);
+        if (ec != std::errc() || end != last)
+        {
+            Logger::Error(std::format("Malformed window source id: {}", sourceId));
+            return false;
+        }
+
+        XWindowAttributes attributes;
+        if (!XGetWindowAttributes(m_display, handle, &attributes) || attributes.map_state != IsViewable)
+            return false;
+
+        target.drawable = handle;
+        target.sourceX = 0;
+        target.sourceY = 0;
+        target.sourceWidth = attributes.width;
+        target.sourceHeight = attributes.height;
+        return true;
+    }
+
+    return false;
+}
+
+bool LinuxGraphicsCapture::ApplyCaptureRegion(CaptureTarget& target) const
+{
+    // Only the region is grabbed, so a small region costs a small readback
+    const FrameRect region = ClipCaptureRegion(m_config.region, target.sourceWidth, target.sourceHeight);
+    target.x = target.sourceX + region.x;
+    target.y = target.sourceY + region.y;
+    target.width = region.width;
+    target.height = region.height;
+    return region.width > 0 && region.height > 0;
+}
+
+bool LinuxGraphicsCapture::StartCapture(const std::string& sourceId)
+{
+    if (!m_initialized || m_isCapturing)
+        return false;
+
+    CaptureTarget target;
+    if (!ResolveTarget(sourceId, target))
+    {
+        Logger::Error(std::format("Unknown or unmapped capture source: {}", sourceId));
+        return false;
+    }
+    if (!ApplyCaptureRegion(target))
+    {
+        Logger::Error(std::format("Capture region is outside the {}x{} source", target.sourceWidth, target.sourceHeight));
+        return false;
+    }
+
+    Logger::Info(std::format("Starting X11 capture for {}: {}x{}", sourceId, target.width, target.height));
+
+    m_sourceId = sourceId;
+    {
+        std::lock_guard lock(m_configMutex);
+        m_pacer.SetTargetFps(m_config.targetFps);
+    }
+    m_changeDetector.Configure(m_config);
+    m_scaler.Configure(m_config);
+    m_worker.Start(m_config.queueDepth, m_config.dropPolicy);
+    m_stopRequested = false;
+    m_isCapturing = true;
+    if (m_config.cursorMode != CursorMode::Hidden && !StartCursorTracker(target))
+        Logger::Warning("Cursor tracking unavailable, capturing without the cursor");
+    m_thread = std::thread(&LinuxGraphicsCapture::CaptureThread, this, target);
+    return true;
+}
+
+bool LinuxGraphicsCapture::StartCursorTracker(const CaptureTarget& target)
+{
+    m_cursorDisplay = XOpenDisplay(nullptr);
+    if (!m_cursorDisplay)
+        return false;
+
+    int fixesEvent = 0, fixesError = 0;
+    if (!XFixesQueryExtension(m_cursorDisplay, &fixesEvent, &fixesError))
+    {
+        XCloseDisplay(m_cursorDisplay);
+        m_cursorDisplay = nullptr;
+        return false;
+    }
+    // Shape changes arrive as events, so a sample is one XQueryPointer round
+    // trip and the image is only fetched when the serial moves on
+    XFixesSelectCursorInput(m_cursorDisplay, DefaultRootWindow(m_cursorDisplay), XFixesDisplayCursorNotifyMask);
+
+    m_cursorAreaWidth = target.width;
+    m_cursorAreaHeight = target.height;
+
+    Display* display = m_cursorDisplay;
+    const XWindow drawable = target.drawable;
+    const int originX = target.x;
+    const int originY = target.y;
+    auto serial = std::make_shared<unsigned long>(0);
+    auto sampler = [this, display, drawable, originX, originY, fixesEvent, serial](CursorSample& sample) {
+        while (XPending(display))
+        {
+            XEvent event;
+            XNextEvent(display, &event);
+            if (event.type == fixesEvent + XFixesCursorNotify)
+                *serial = reinterpret_cast<XFixesCursorNotifyEvent*>(&event)->cursor_serial;
+        }
+
+        XWindow root = 0, child = 0;
+        int rootX = 0, rootY = 0, windowX = 0, windowY = 0;
+        unsigned int mask = 0;
+        if (!XQueryPointer(display, drawable, &root, &child, &rootX, &rootY, &windowX, &windowY, &mask))
+            return false; // Pointer is on another screen
+
+        sample.x = windowX - originX;
+        sample.y = windowY - originY;
+        sample.visible = sample.x >= 0 && sample.y >= 0 && sample.x < m_cursorAreaWidth && sample.y < m_cursorAreaHeight;
+        sample.shapeKey = *serial;
+        return true;
+    };
+    auto shapeReader = [display](CursorShape& shape) {
+        XFixesCursorImage* image = XFixesGetCursorImage(display);
+        if (!image)
+            return false;
+        // Already premultiplied ARGB, one pixel per unsigned long
+        shape.width = image->width;
+        shape.height = image->height;
+        shape.hotspotX = image->xhot;
+        shape.hotspotY = image->yhot;
+        shape.pixels.resize(static_cast<size_t>(image->width) * image->height);
+        for (size_t i = 0; i < shape.pixels.size(); ++i)
+            shape.pixels[i] = static_cast<uint32_t>(image->pixels[i]);
+        XFree(image);
+        return true;
+    };
+
+    int frameWidth, frameHeight;
+    CaptureScaler::GetOutputSize(m_config, target.width, target.height, frameWidth, frameHeight);
+    m_cursorTracker.SetFrameGeometry(target.width, target.height, frameWidth, frameHeight);
+    m_cursorTracker.Start(m_config.cursorRateHz, sampler, shapeReader, m_config.cursorMode == CursorMode::Metadata);
+    return true;
+}
+
+void LinuxGraphicsCapture::StopCursorTracker()
+{
+    m_cursorTracker.Stop();
+    if (m_cursorDisplay)
+    {
+        XCloseDisplay(m_cursorDisplay);
+        m_cursorDisplay = nullptr;
+    }
+}
+
+void LinuxGraphicsCapture::CaptureThread(CaptureTarget target)
+{
+    // Xlib connections are not meant to be shared between busy threads
+    Display* display = XOpenDisplay(nullptr);
+    if (!display)
+    {
+        Logger::Error("Capture thread failed to open X11 display");
+        m_isCapturing = false;
+        return;
+    }
+
+    const bool isWindow = target.drawable != DefaultRootWindow(display);
+
+    XWindowAttributes attributes;
+    XGetWindowAttributes(display, target.drawable, &attributes);
+    const bool opaqueAlpha = attributes.depth == 24; // X leaves the padding byte undefined
+
+    ShmImage shm;
+    if (!shm.Create(display, attributes.visual, attributes.depth, target.width, target.height))
+    {
+        Logger::Error("Failed to create MIT-SHM image");
+        XCloseDisplay(display);
+        m_isCapturing = false;
+        return;
+    }
+
+    int damageEvent = 0, damageError = 0;
+    XDamageQueryExtension(display, &damageEvent, &damageError);
+    Damage damage = XDamageCreate(display, target.drawable, XDamageReportNonEmpty);
+    XserverRegion region = XFixesCreateRegion(display, nullptr, 0);
+    if (isWindow)
+        XSelectInput(display, target.drawable, StructureNotifyMask);
+
+    std::vector<FrameRect> dirtyRects;
+    std::vector<std::pair<int, int>> bands; // [top, bottom) row ranges
+    FrameBufferRing frames(m_bufferPool);
+
+    // Embedded cursor: X grabs never contain it, so it is blended into the
+    // shared image after each grab. Where it was drawn is re-grabbed when it
+    // moves, which restores the pixels underneath.
+    const bool drawCursor = m_config.cursorMode == CursorMode::Embedded && m_cursorTracker.IsRunning();
+    const int unpacedPollMs = drawCursor ? std::clamp(1000 / std::max(m_config.cursorRateHz, 1), 1, kUnpacedPollMs) : kUnpacedPollMs;
+    CursorState drawnCursor;
+    FrameRect drawnCursorRect;
+
+    bool fullGrab = true;
+
+    m_pacer.Reset();
+    while (!m_stopRequested)
+    {
+        // Damage accumulates server-side between wakeups, so sleeping here
+        // naturally coalesces many small updates into one grab.
+        m_pacer.WaitForNextFrame();
+
+        // A pending screenshot needs a frame even if nothing changed
+        if (m_screenshots.HasRequests())
+            fullGrab = true;
+
+        // Unpaced: block until the server has something for us instead of spinning
+        if (m_pacer.GetTargetFps() <= 0 && !fullGrab && !XPending(display))
+        {
+            pollfd fd = { ConnectionNumber(display), POLLIN, 0 };
+            poll(&fd, 1, unpacedPollMs);
+        }
+        const auto arrival = std::chrono::steady_clock::now();
+
+        bool damaged = fullGrab;
+        bool destroyed = false;
+        unsigned long firstDamageTime = 0; // Server time of the earliest change in this batch
+        while (XPending(display))
+        {
+            XEvent event;
+            XNextEvent(display, &event);
+            if (event.type == damageEvent + XDamageNotify)
+            {
+                damaged = true;
+                if (!firstDamageTime)
+                    firstDamageTime = reinterpret_cast<XDamageNotifyEvent*>(&event)->timestamp;
+            }
+            else if (event.type == ConfigureNotify &&
+                     (event.xconfigure.width != target.sourceWidth || event.xconfigure.height != target.sourceHeight))
+            {
+                target.sourceWidth = event.xconfigure.width;
+                target.sourceHeight = event.xconfigure.height;
+                const int oldWidth = target.width;
+                const int oldHeight = target.height;
+                if (!ApplyCaptureRegion(target))
+                {
+                    Logger::Warning("Window no longer overlaps the capture region");
+                    destroyed = true;
+                }
+                else if (target.width != oldWidth || target.height != oldHeight)
+                {
+                    shm.Destroy();
+                    if (!shm.Create(display, attributes.visual, attributes.depth, target.width, target.height))
+                        destroyed = true;
+                    fullGrab = damaged = true;
+                }
+            }
+            else if (event.type == DestroyNotify)
+            {
+                destroyed = true;
+            }
+        }
+
+        if (destroyed)
+        {
+            Logger::Warning("Capture target went away, stopping capture");
+            break;
+        }
+
+        CursorState cursor;
+        FrameRect cursorRect;
+        bool cursorMoved = false;
+        if (drawCursor)
+        {
+            cursor = m_cursorTracker.GetSourceState();
+            cursorRect = GetCursorRect(cursor, target.width, target.height);
+            cursorMoved = cursor.visible != drawnCursor.visible || cursor.shape != drawnCursor.shape ||
+                          cursor.x != drawnCursor.x || cursor.y != drawnCursor.y;
+            damaged |= cursorMoved;
+        }
+
+        if (!damaged)
+            continue;
+
+        dirtyRects.clear();
+        if (fullGrab)
+        {
+            XDamageSubtract(display, damage, None, None);
+            dirtyRects.push_back({ 0, 0, target.width, target.height });
+        }
+        else
+        {
+            XDamageSubtract(display, damage, None, region);
+            int count = 0;
+            XRectangle* rects = XFixesFetchRegion(display, region, &count);
+            for (int i = 0; i < count; ++i)
+            {
+                // Clip to the captured area and make capture-relative
+                int x0 = std::max<int>(rects[i].x, target.x) - target.x;
+                int y0 = std::max<int>(rects[i].y, target.y) - target.y;
+                int x1 = std::min<int>(rects[i].x + rects[i].width, target.x + target.width) - target.x;
+                int y1 = std::min<int>(rects[i].y + rects[i].height, target.y + target.height) - target.y;
+                if (x1 > x0 && y1 > y0)
+                    dirtyRects.push_back({ x0, y0, x1 - x0, y1 - y0 });
+            }
+            if (rects)
+                XFree(rects);
+
+            if (cursorMoved)
+            {
+                for (const FrameRect& rect : { drawnCursorRect, cursorRect })
+                {
+                    if (rect.width > 0)
+                        dirtyRects.push_back(rect);
+                }
+            }
+        }
+
+        if (dirtyRects.empty())
+            continue;
+
+        // Full-width row bands keep every grab contiguous inside the shared
+        // segment, so XShmGetImage writes straight into place.
+        bands.clear();
+        for (const auto& rect : dirtyRects)
+            bands.emplace_back(rect.y, rect.y + rect.height);
+        std::sort(bands.begin(), bands.end());
+        size_t merged = 0;
+        for (size_t i = 1; i < bands.size(); ++i)
+        {
+            if (bands[i].first <= bands[merged].second)
+                bands[merged].second = std::max(bands[merged].second, bands[i].second);
+            else
+                bands[++merged] = bands[i];
+        }
+        bands.resize(merged + 1);
+
+        XImage* image = shm.image;
+        bool grabbed = true;
+        for (const auto& [top, bottom] : bands)
+        {
+            XImage band = *image;
+            band.height = bottom - top;
+            band.data = image->data + static_cast<size_t>(top) * image->bytes_per_line;
+            if (!XShmGetImage(display, target.drawable, &band, target.x, target.y + top, AllPlanes))
+            {
+                grabbed = false;
+                break;
+            }
+
+            if (opaqueAlpha)
+            {
+                for (int row = top; row < bottom; ++row)
+                {
+                    auto* pixels = reinterpret_cast<uint32_t*>(image->data + static_cast<size_t>(row) * image->bytes_per_line);
+                    for (int x = 0; x < target.width; ++x)
+                        pixels[x] |= 0xFF000000u;
+                }
+            }
+
+            // Only freshly grabbed rows get the cursor; rows left alone still
+            // have it from before, and blending twice would darken its edges
+            if (cursorRect.width > 0 && top < cursorRect.y + cursorRect.height && bottom > cursorRect.y)
+            {
+                AlphaBlend::BlendOver(reinterpret_cast<uint8_t*>(band.data), image->bytes_per_line, target.width,
+                                      bottom - top, cursor.shape->pixels.data(), cursor.shape->width,
+                                      cursor.shape->height, cursor.x - cursor.shape->hotspotX,
+                                      cursor.y - cursor.shape->hotspotY - top);
+            }
+        }
+
+        if (!grabbed)
+        {
+            // Typically a window partially off-screen; retry everything next time
+            fullGrab = true;
+            continue;
+        }
+        fullGrab = false;
+        drawnCursor = cursor;
+        drawnCursorRect = cursorRect;
+
+        // The shared segment is overwritten by the next grab, so frames are
+        // published from pooled buffers, each patched with just the bands
+        // damaged since it last held a frame.
+        const size_t frameSize = static_cast<size_t>(image->bytes_per_line) * target.height;
+        const bool wholeFrame = bands.size() == 1 && bands[0].first == 0 && bands[0].second == target.height;
+        uint8_t* pixels = frames.Begin(image->bytes_per_line, target.height, !wholeFrame);
+        for (const auto& [top, bottom] : bands)
+        {
+            size_t offset = static_cast<size_t>(top) * image->bytes_per_line;
+            std::memcpy(pixels + offset, image->data + offset, static_cast<size_t>(bottom - top) * image->bytes_per_line);
+            frames.MarkChanged(top, bottom);
+        }
+
+        const uint64_t arrivalNs = FrameClock::FromTimePoint(arrival);
+        const uint64_t presentedNs = firstDamageTime ? ServerTimeToFrameClock(firstDamageTime, arrivalNs) : 0;
+
+        FrameData frameData;
+        frameData.data = pixels;
+        frameData.width = target.width;
+        frameData.height = target.height;
+        frameData.stride = image->bytes_per_line;
+        frameData.size = frameSize;
+        frameData.timestampNs = arrivalNs;
+        frameData.presentationTimeNs = presentedNs ? presentedNs : arrivalNs;
+        frameData.traceId = FrameTracer::Shared().Begin(presentedNs, arrivalNs);
+        frameData.dirtyRects = dirtyRects.data();
+        frameData.dirtyRectCount = dirtyRects.size();
+        frameData.buffer = frames.Current();
+        FrameTracer::Shared().Stamp(frameData.traceId, FrameStage::Copied);
+        m_screenshots.Offer(frameData);
+        m_changeDetector.Process(frameData);
+        m_scaler.Process(frameData);
+        FrameTracer::Shared().Stamp(frameData.traceId, FrameStage::Processed);
+        m_cursorAreaWidth = target.width; // The window may have been resized
+        m_cursorAreaHeight = target.height;
+        if (m_config.cursorMode == CursorMode::Metadata)
+        {
+            m_cursorTracker.SetFrameGeometry(target.width, target.height, frameData.width, frameData.height);
+            frameData.cursor = m_cursorTracker.GetState();
+        }
+
+        m_mailbox.Publish(frameData);
+        m_worker.Push(frameData, arrival);
+        m_pacer.MarkDelivered(std::chrono::steady_clock::now());
+        ++m_framesCaptured;
+    }
+
+    frames.Reset();
+    XFixesDestroyRegion(display, region);
+    XDamageDestroy(display, damage);
+    shm.Destroy();
+    XCloseDisplay(display);
+    m_isCapturing = false;
+}
+
+void LinuxGraphicsCapture::StopCapture()
+{
+    m_stopRequested = true;
+    if (m_thread.joinable())
+    {
+        m_thread.join();
+        Logger::Info("Capture stopped");
+    }
+
+    StopCursorTracker();
+    m_worker.Stop();
+    m_screenshots.CancelRequests();
+    m_isCapturing = false;
+}
+
+bool LinuxGraphicsCapture::SetCaptureConfig(const CaptureConfig& config)
+{
+    std::lock_guard lock(m_configMutex);
+    if (m_isCapturing)
+    {
+        if (!IsFrameRateChangeOnly(m_config, config))
+            return false;
+        m_config.targetFps = config.targetFps;
+        m_pacer.SetTargetFps(config.targetFps);
+        return true;
+    }
+
+    m_config = config;
+    return true;
+}
+
+CaptureConfig LinuxGraphicsCapture::GetCaptureConfig() const
+{
+    std::lock_guard lock(m_configMutex);
+    return m_config;
+}
+
+bool LinuxGraphicsCapture::SetTargetFps(int fps)
+{
+    std::lock_guard lock(m_configMutex);
+    if (!m_initialized)
+        return false;
+
+    m_config.targetFps = fps;
+    m_pacer.SetTargetFps(fps);
+    return true;
+}
+
+bool LinuxGraphicsCapture::SetFrameCallback(const FrameCallback& callback)
+{
+    m_worker.SetCallback(callback);
+    return true;
+}
+
+bool LinuxGraphicsCapture::SetCursorCallback(const CursorCallback& callback)
+{
+    m_cursorTracker.SetCallback(callback);
+    return true;
+}
+
+bool LinuxGraphicsCapture::GetLatestFrame(FrameData& outFrame) const
+{
+    return m_mailbox.Acquire(outFrame);
+}
+
+bool LinuxGraphicsCapture::SaveScreenshot(const std::string& sourceId, const std::string& filePath) const
+{
+    if (!m_isCapturing)
+    {
+        Logger::Error("Screenshots need a running capture");
+        return false;
+    }
+    if (!sourceId.empty() && sourceId != m_sourceId)
+    {
+        Logger::Error(std::format("Screenshots are only available for the captured source ({})", m_sourceId));
+        return false;
+    }
+    return m_screenshots.Request(filePath);
+}
+
+CaptureStatistics LinuxGraphicsCapture::GetStatistics() const
+{
+    CaptureStatistics statistics;
+    statistics.framesCapture = m_framesCaptured;
+    m_worker.FillStatistics(statistics);
+    statistics.framesOverwritten = m_mailbox.GetOverwrittenCount();
+    statistics.framesDuplicate = m_changeDetector.GetDuplicateCount();
+    statistics.averageFps = m_pacer.GetAchievedFps();
+    statistics.frameJitterMs = m_pacer.GetJitterMs();
+
+    const ProcessUsage usage = ProcessMetrics::Sample();
+    statistics.cpuUsage = usage.cpuPercent;
+    statistics.memoryUsage = usage.residentBytes;
+    return statistics;
+}
+
+bool LinuxGraphicsCapture::IsCursorVisible() const
+{
+    // X has no visibility query; this is whether the cursor is captured at all
+    return m_config.cursorMode != CursorMode::Hidden;
+}
@@ -0,0 +1,114 @@
+#pragma once
+
+#include "../IGraphicsCapture.h"
+#include "../CaptureScaler.h"
+#include "../CaptureWorker.h"
+#include "../CursorTracker.h"
+#include "../FrameBufferRing.h"
+#include "../FrameChangeDetector.h"
+#include "../FrameMailbox.h"
+#include "../FramePacer.h"
+#include "../ProcessNameCache.h"
+#include "../ScreenshotWriter.h"
+
+#include <atomic>
+#include <cstdint>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// Xlib's `Window` typedef collides with our Window struct, so X11 types stay
+// out of this header and are only used in the translation unit.
+struct _XDisplay;
+
+class LinuxGraphicsCapture : public IGraphicsCapture
+{
+public:
+    LinuxGraphicsCapture();
+    ~LinuxGraphicsCapture() override;
+
+    bool Initialize() override;
+    bool SetD3DDevice(void* d3dDevice) override;
+    void Shutdown() override;
+
+    bool IsSupported() const override;
+    bool IsInitialized() const override { return m_initialized; }
+
+    std::vector<Monitor> GetMonitors() const override;
+    std::vector<Window> GetWindows() const override;
+    std::vector<CaptureSource> GetAvailableSources() const override;
+
+    bool SetCaptureConfig(const CaptureConfig& config) override;
+    CaptureConfig GetCaptureConfig() const override;
+    bool SetTargetFps(int fps) override;
+
+    bool StartCapture(const std::string& sourceId) override;
+    void StopCapture() override;
+    bool IsCapturing() const override { return m_isCapturing; }
+
+    bool SetFrameCallback(const FrameCallback& callback) override;
+    bool SetCursorCallback(const CursorCallback& callback) override;
+    bool GetLatestFrame(FrameData& outFrame) const override;
+    bool SaveScreenshot(const std::string& sourceId, const std::string& filePath) const override;
+
+    CaptureStatistics GetStatistics() const override;
+    bool IsCursorVisible() const override;
+
+    std::string_view GetPlatformName() const noexcept override { return "X11 MIT-SHM + XDamage"; }
+
+private:
+    // What the capture thread grabs: a drawable and the rectangle inside it
+    struct CaptureTarget
+    {
+        unsigned long drawable = 0;
+        int x = 0;
+        int y = 0;
+        int width = 0;
+        int height = 0;
+
+        // The whole source within the drawable; x/y/width/height are the part
+        // of it that CaptureConfig::region selects
+        int sourceX = 0;
+        int sourceY = 0;
+        int sourceWidth = 0;
+        int sourceHeight = 0;
+    };
+
+    bool ResolveTarget(const std::string& sourceId, CaptureTarget& target) const;
+    bool ApplyCaptureRegion(CaptureTarget& target) const;
+    bool StartCursorTracker(const CaptureTarget& target);
+    void StopCursorTracker();
+    void CaptureThread(CaptureTarget target);
+
+private:
+    bool m_initialized = false;
+    std::atomic<bool> m_isCapturing = false;
+    std::atomic<bool> m_stopRequested = false;
+    CaptureConfig m_config;
+    mutable std::mutex m_configMutex; // targetFps may change from another thread while capturing
+
+    // Enumeration connection, used from the UI and SourceRegistry threads
+    // (Xlib serializes calls after XInitThreads). The capture thread opens its own.
+    _XDisplay* m_display = nullptr;
+    mutable ProcessNameCache m_processNames;
+
+    FramePacer m_pacer;
+    FrameChangeDetector m_changeDetector;
+    CaptureScaler m_scaler;
+    CaptureWorker m_worker;
+    mutable FrameMailbox m_mailbox;
+    mutable ScreenshotWriter m_screenshots;
+    std::string m_sourceId;
+
+    // The tracker samples the pointer over a connection of its own. It runs
+    // in Metadata mode, and in Embedded mode so the capture thread can draw
+    // the cursor X leaves out of every grab.
+    CursorTracker m_cursorTracker;
+    _XDisplay* m_cursorDisplay = nullptr;
+    std::atomic<int> m_cursorAreaWidth = 0; // Captured area, for the tracker's visibility test
+    std::atomic<int> m_cursorAreaHeight = 0;
+
+    std::shared_ptr<FrameBufferPool> m_bufferPool = FrameBufferPool::Create();
+    std::thread m_thread;
+    std::atomic<uint64_t> m_framesCaptured = 0;
+};
@@ -0,0 +1,680 @@
+#include "SyntheticGraphicsCapture.h"
+#include "../../platform/Logger.h"
+#include "../../platform/ProcessMetrics.h"
+#include "../../video/AlphaBlend.h"
+
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <format>
+
+namespace
+{
+	constexpr int kLineHeight = 16;
+	constexpr int kGlyphWidth = 8;
+	constexpr int kCursorWidth = 16;
+	constexpr int kCursorHeight = 24;
+
+	struct ContentInfo
+	{
+		SyntheticContent content;
+		const char* id;
+		const char* name;
+	};
+
+	constexpr std::array<ContentInfo, 4> kContents = { {
+		{ SyntheticContent::StaticDesktop, "synthetic:static", "Synthetic Static Desktop" },
+		{ SyntheticContent::ScrollingText, "synthetic:text", "Synthetic Scrolling Text" },
+		{ SyntheticContent::FullMotionVideo, "synthetic:video", "Synthetic Full-Motion Video" },
+		{ SyntheticContent::CursorOnly, "synthetic:cursor", "Synthetic Cursor Movement" },
+	} };
+
+	// Small integer hash (lowbias32) so generated content only depends on its inputs
+	uint32_t Hash(uint32_t x)
+	{
+		x ^= x >> 16;
+		x *= 0x7feb352dU;
+		x ^= x >> 15;
+		x *= 0x846ca68bU;
+		x ^= x >> 16;
+		return x;
+	}
+
+	uint32_t Hash(uint32_t a, uint32_t b, uint32_t c = 0)
+	{
+		return Hash(a ^ Hash(b ^ Hash(c)));
+	}
+
+	constexpr uint32_t MakeBGRA(uint8_t r, uint8_t g, uint8_t b)
+	{
+		// Little-endian uint32 0xAARRGGBB is laid out as B, G, R, A in memory
+		return 0xFF000000u | (uint32_t(r) << 16) | (uint32_t(g) << 8) | uint32_t(b);
+	}
+
+	// Classic arrow, black outline and white fill, premultiplied with a
+	// transparent background; the hotspot is the top-left corner
+	const std::vector<uint32_t>& GetCursorImage()
+	{
+		static const std::vector<uint32_t> image = [] {
+			std::vector<uint32_t> pixels(static_cast<size_t>(kCursorWidth) * kCursorHeight, 0);
+			for (int row = 0; row < kCursorHeight; ++row)
+			{
+				int span = std::min(row * 2 / 3 + 1, kCursorWidth);
+				if (row >= kCursorHeight - 6)
+					span = std::max(kCursorHeight - row - 1, 0);
+				for (int col = 0; col < span; ++col)
+				{
+					bool edge = col == 0 || col == span - 1 || row == kCursorHeight - 7;
+					pixels[static_cast<size_t>(row) * kCursorWidth + col] = edge ? MakeBGRA(0, 0, 0) : MakeBGRA(255, 255, 255);
+				}
+			}
+			return pixels;
+		}();
+		return image;
+	}
+
+	void FillRect(uint8_t* frame, int stride, int frameWidth, int frameHeight, int x, int y, int w, int h, uint32_t color)
+	{
+		int x0 = std::clamp(x, 0, frameWidth);
+		int y0 = std::clamp(y, 0, frameHeight);
+		int x1 = std::clamp(x + w, 0, frameWidth);
+		int y1 = std::clamp(y + h, 0, frameHeight);
+
+		for (int row = y0; row < y1; ++row)
+		{
+			auto* dst = reinterpret_cast<uint32_t*>(frame + static_cast<size_t>(row) * stride);
+			std::fill(dst + x0, dst + x1, color);
+		}
+	}
+}
+
+SyntheticGraphicsCapture::SyntheticGraphicsCapture()
+	: SyntheticGraphicsCapture(ConfigFromEnvironment())
+{
+}
+
+SyntheticGraphicsCapture::SyntheticGraphicsCapture(const SyntheticCaptureConfig& config)
+{
+	SetSyntheticConfig(config);
+}
+
+SyntheticGraphicsCapture::~SyntheticGraphicsCapture()
+{
+	Shutdown();
+}
+
+bool SyntheticGraphicsCapture::Initialize()
+{
+	Logger::Info(std::format("Synthetic capture initialized: {}x{} @ {} fps",
+							 m_syntheticConfig.width, m_syntheticConfig.height, m_syntheticConfig.fps));
+	m_initialized = true;
+	return true;
+}
+
+bool SyntheticGraphicsCapture::SetD3DDevice(void* d3dDevice)
+{
+	// Frames are generated on the CPU, no device is needed
+	(void)d3dDevice;
+	return true;
+}
+
+void SyntheticGraphicsCapture::Shutdown()
+{
+	StopCapture();
+	m_frames.Reset();
+	m_initialized = false;
+}
+
+std::vector<Monitor> SyntheticGraphicsCapture::GetMonitors() const
+{
+	std::vector<Monitor> monitors;
+
+	if (!m_initialized)
+		return monitors;
+
+	for (const auto& info : kContents)
+	{
+		Monitor monitor;
+		monitor.id = info.id;
+		monitor.name = info.name;
+		monitor.x = 0;
+		monitor.y = 0;
+		monitor.width = m_syntheticConfig.width;
+		monitor.height = m_syntheticConfig.height;
+		monitor.isPrimary = info.content == SyntheticContent::StaticDesktop;
+		monitor.dpiScale = 1.0f;
+		monitors.push_back(monitor);
+	}
+
+	return monitors;
+}
+
+std::vector<Window> SyntheticGraphicsCapture::GetWindows() const
+{
+	return {};
+}
+
+std::vector<CaptureSource> SyntheticGraphicsCapture::GetAvailableSources() const
+{
+	std::vector<CaptureSource> sources;
+
+	for (const auto& monitor : GetMonitors())
+	{
+		CaptureSource source;
+		source.id = monitor.id;
+		source.name = monitor.name + (monitor.isPrimary ? " (Primary)" : "");
+		source.isMonitor = true;
+		source.width = monitor.width;
+		source.height = monitor.height;
+		sources.push_back(source);
+	}
+
+	return sources;
+}
+
+bool SyntheticGraphicsCapture::SetCaptureConfig(const CaptureConfig& config)
+{
+	std::lock_guard lock(m_configMutex);
+	if (m_isCapturing)
+	{
+		if (!IsFrameRateChangeOnly(m_config, config))
+			return false;
+		m_config.targetFps = config.targetFps;
+		m_pacer.SetTargetFps(config.targetFps);
+		return true;
+	}
+
+	m_config = config;
+	return true;
+}
+
+CaptureConfig SyntheticGraphicsCapture::GetCaptureConfig() const
+{
+	std::lock_guard lock(m_configMutex);
+	return m_config;
+}
+
+bool SyntheticGraphicsCapture::SetTargetFps(int fps)
+{
+	std::lock_guard lock(m_configMutex);
+	if (!m_initialized)
+		return false;
+
+	m_config.targetFps = fps;
+	m_pacer.SetTargetFps(fps);
+	return true;
+}
+
+bool SyntheticGraphicsCapture::SetSyntheticConfig(const SyntheticCaptureConfig& config)
+{
+	if (m_isCapturing)
+		return false;
+
+	m_syntheticConfig = config;
+	m_syntheticConfig.width = std::clamp(config.width, kCursorWidth, kMaxWidth);
+	m_syntheticConfig.height = std::clamp(config.height, kCursorHeight, kMaxHeight);
+	m_syntheticConfig.fps = std::clamp(config.fps, 1, 1000);
+	m_syntheticConfig.scrollSpeed = std::clamp(config.scrollSpeed, 1, m_syntheticConfig.height);
+	return true;
+}
+
+SyntheticCaptureConfig SyntheticGraphicsCapture::ConfigFromEnvironment()
+{
+	SyntheticCaptureConfig config;
+
+	const char* mode = std::getenv("SYNTHETIC_CAPTURE_MODE");
+	if (mode)
+	{
+		int width = 0, height = 0, fps = 0;
+		int parsed = std::sscanf(mode, "%dx%d@%d", &width, &height, &fps);
+		if (parsed >= 2)
+		{
+			config.width = width;
+			config.height = height;
+		}
+		if (parsed == 3)
+			config.fps = fps;
+		if (parsed < 2)
+			Logger::Warning(std::format("Ignoring malformed SYNTHETIC_CAPTURE_MODE '{}'", mode));
+	}
+
+	return config;
+}
+
+std::string SyntheticGraphicsCapture::GetSourceId(SyntheticContent content)
+{
+	for (const auto& info : kContents)
+	{
+		if (info.content == content)
+			return info.id;
+	}
+	return {};
+}
+
+bool SyntheticGraphicsCapture::StartCapture(const std::string& sourceId)
+{
+	if (!m_initialized || m_isCapturing)
+		return false;
+
+	auto it = std::find_if(kContents.begin(), kContents.end(),
+						   [&](const ContentInfo& info) { return sourceId == info.id; });
+	if (it == kContents.end())
+	{
+		Logger::Error(std::format("Unknown synthetic source: {}", sourceId));
+		return false;
+	}
+
+	m_region = ClipCaptureRegion(m_config.region, m_syntheticConfig.width, m_syntheticConfig.height);
+	if (m_region.width <= 0 || m_region.height <= 0)
+	{
+		Logger::Error(std::format("Capture region is outside the {}x{} source", m_syntheticConfig.width, m_syntheticConfig.height));
+		return false;
+	}
+
+	m_sourceId = sourceId;
+	m_stride = m_syntheticConfig.width * 4;
+	m_frameSize = static_cast<size_t>(m_stride) * m_syntheticConfig.height;
+	m_frames.Reset();
+	// Derived from the size and seed, which may have changed since last time
+	m_background.clear();
+	m_palette.clear();
+	m_columnPhase.clear();
+
+	{
+		std::lock_guard lock(m_configMutex);
+		m_pacer.SetTargetFps(m_config.targetFps);
+	}
+	m_pacer.Reset();
+	m_changeDetector.Configure(m_config);
+	m_scaler.Configure(m_config);
+	m_worker.Start(m_config.queueDepth, m_config.dropPolicy);
+	m_stopRequested = false;
+	m_isCapturing = true;
+	if (m_config.cursorMode == CursorMode::Metadata)
+		StartCursorTracker(it->content);
+	m_thread = std::thread(&SyntheticGraphicsCapture::CaptureThread, this, it->content);
+
+	Logger::Info(std::format("Synthetic capture started: {} ({}x{} @ {} fps)", it->name,
+							 m_syntheticConfig.width, m_syntheticConfig.height, m_syntheticConfig.fps));
+	return true;
+}
+
+void SyntheticGraphicsCapture::StopCapture()
+{
+	m_stopRequested = true;
+	if (m_thread.joinable())
+		m_thread.join();
+
+	m_cursorTracker.Stop();
+	m_worker.Stop();
+	m_screenshots.CancelRequests();
+	m_isCapturing = false;
+}
+
+void SyntheticGraphicsCapture::StartCursorTracker(SyntheticContent content)
+{
+	// The simulated pointer keeps moving in real time, whatever targetFps
+	// lets through; only CursorOnly content has one
+	const auto start = std::chrono::steady_clock::now();
+	const double fps = m_syntheticConfig.fps;
+	const FrameRect region = m_region;
+	auto sampler = [this, content, start, fps, region](CursorSample& sample) {
+		sample.visible = false;
+		if (content == SyntheticContent::CursorOnly)
+		{
+			const std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+			GetCursorPosition(elapsed.count() * fps, sample.x, sample.y);
+			sample.x -= region.x;
+			sample.y -= region.y;
+			sample.visible = sample.x >= 0 && sample.y >= 0 && sample.x < region.width && sample.y < region.height;
+		}
+		sample.shapeKey = 1;
+		return true;
+	};
+	auto shapeReader = [](CursorShape& shape) {
+		shape.width = kCursorWidth;
+		shape.height = kCursorHeight;
+		shape.pixels = GetCursorImage();
+		return true;
+	};
+	int frameWidth, frameHeight;
+	CaptureScaler::GetOutputSize(m_config, m_region.width, m_region.height, frameWidth, frameHeight);
+	m_cursorTracker.SetFrameGeometry(m_region.width, m_region.height, frameWidth, frameHeight);
+	m_cursorTracker.Start(m_config.cursorRateHz, sampler, shapeReader, true);
+}
+
+bool SyntheticGraphicsCapture::SetFrameCallback(const FrameCallback& callback)
+{
+	m_worker.SetCallback(callback);
+	return true;
+}
+
+bool SyntheticGraphicsCapture::SetCursorCallback(const CursorCallback& callback)
+{
+	m_cursorTracker.SetCallback(callback);
+	return true;
+}
+
+bool SyntheticGraphicsCapture::GetLatestFrame(FrameData& outFrame) const
+{
+	return m_mailbox.Acquire(outFrame);
+}
+
+bool SyntheticGraphicsCapture::SaveScreenshot(const std::string& sourceId, const std::string& filePath) const
+{
+	if (!m_isCapturing)
+	{
+		Logger::Error("Screenshots need a running capture");
+		return false;
+	}
+	if (!sourceId.empty() && sourceId != m_sourceId)
+	{
+		Logger::Error(std::format("Screenshots are only available for the captured source ({})", m_sourceId));
+		return false;
+	}
+	return m_screenshots.Request(filePath);
+}
+
+CaptureStatistics SyntheticGraphicsCapture::GetStatistics() const
+{
+	CaptureStatistics statistics;
+	statistics.framesCapture = m_framesCaptured;
+	m_worker.FillStatistics(statistics);
+	statistics.framesDecimated = m_pacer.GetDecimatedCount();
+	statistics.averageFps = m_pacer.GetAchievedFps();
+	statistics.frameJitterMs = m_pacer.GetJitterMs();
+
+	const ProcessUsage usage = ProcessMetrics::Sample();
+	statistics.cpuUsage = usage.cpuPercent;
+	statistics.memoryUsage = usage.residentBytes;
+	statistics.framesOverwritten = m_mailbox.GetOverwrittenCount();
+	statistics.framesDuplicate = m_changeDetector.GetDuplicateCount();
+	return statistics;
+}
+
+bool SyntheticGraphicsCapture::IsCursorVisible() const
+{
+	return m_config.cursorMode != CursorMode::Hidden;
+}
+
+void SyntheticGraphicsCapture::CaptureThread(SyntheticContent content)
+{
+	using Clock = std::chrono::steady_clock;
+
+	// The generator ticks at the simulated display rate; targetFps then
+	// decimates ticks before anything is rendered, like arrivals from a real
+	// capture API.
+	const auto period = std::chrono::nanoseconds(1'000'000'000LL / m_syntheticConfig.fps);
+	auto deadline = Clock::now();
+
+	// Content is a pure function of the delivered frame index, never of
+	// wall-clock time, so pacing and slow consumers change the delivered rate
+	// but not the pixels.
+	uint64_t frameIndex = 0;
+	while (!m_stopRequested)
+	{
+		// The tick is the simulated display's presentation time
+		if (m_pacer.ShouldAccept(Clock::now()))
+			ProduceFrame(content, frameIndex++, deadline);
+
+		// Deadline scheduling; if we fell more than a period behind, resync
+		// instead of bursting to catch up.
+		deadline += period;
+		auto now = Clock::now();
+		if (now - deadline > period)
+			deadline = now;
+		std::this_thread::sleep_until(deadline);
+	}
+}
+
+void SyntheticGraphicsCapture::ProduceFrame(SyntheticContent content, uint64_t frameIndex,
+											 std::chrono::steady_clock::time_point presented)
+{
+	const auto arrival = CaptureWorker::Clock::now();
+	const uint64_t arrivalNs = FrameClock::FromTimePoint(arrival);
+	const uint64_t presentedNs = FrameClock::FromTimePoint(presented);
+	const uint64_t traceId = FrameTracer::Shared().Begin(presentedNs, arrivalNs);
+	const bool firstFrame = frameIndex == 0;
+	switch (content)
+	{
+	case SyntheticContent::StaticDesktop:
+		// Never modified after the first frame, so it can be shared freely
+		if (firstFrame)
+			RenderDesktop(PrepareFrame(false));
+		break;
+	case SyntheticContent::ScrollingText:
+		RenderScrollingText(frameIndex, firstFrame);
+		break;
+	case SyntheticContent::FullMotionVideo:
+		RenderVideo(frameIndex);
+		break;
+	case SyntheticContent::CursorOnly:
+		if (m_config.cursorMode == CursorMode::Embedded)
+			RenderCursor(frameIndex, firstFrame);
+		else if (firstFrame)
+			RenderDesktop(PrepareFrame(false)); // Static like StaticDesktop; the cursor travels separately
+		break;
+	}
+
+	// The generator draws the whole simulated display; a capture region is
+	// delivered as a view into it
+	const BgraView view = BgraView(m_frames.Current().Data(), m_syntheticConfig.width, m_syntheticConfig.height, m_stride)
+							  .Crop(m_region.x, m_region.y, m_region.width, m_region.height);
+
+	FrameData frameData;
+	frameData.data = const_cast<uint8_t*>(view.data);
+	frameData.size = view.SizeBytes();
+	frameData.width = view.width;
+	frameData.height = view.height;
+	frameData.stride = view.stride;
+	frameData.timestampNs = arrivalNs;
+	frameData.presentationTimeNs = presentedNs;
+	frameData.traceId = traceId;
+	frameData.buffer = m_frames.Current();
+	FrameTracer::Shared().Stamp(traceId, FrameStage::Copied);
+	m_screenshots.Offer(frameData);
+	m_changeDetector.Process(frameData);
+	m_scaler.Process(frameData);
+	FrameTracer::Shared().Stamp(traceId, FrameStage::Processed);
+	if (m_cursorTracker.IsRunning())
+	{
+		m_cursorTracker.SetFrameGeometry(m_region.width, m_region.height, frameData.width, frameData.height);
+		frameData.cursor = m_cursorTracker.GetState();
+	}
+
+	m_mailbox.Publish(frameData);
+	m_worker.Push(frameData, arrival);
+	++m_framesCaptured;
+}
+
+uint8_t* SyntheticGraphicsCapture::PrepareFrame(bool preserveContents)
+{
+	// Consumers may still hold the last few frames; the ring hands out one
+	// they let go of, with the rows that changed since carried over
+	return m_frames.Begin(m_stride, m_syntheticConfig.height, preserveContents);
+}
+
+void SyntheticGraphicsCapture::RenderDesktop(uint8_t* dst)
+{
+	const int width = m_syntheticConfig.width;
+	const int height = m_syntheticConfig.height;
+	const uint32_t seed = m_syntheticConfig.seed;
+
+	// Vertical gradient wallpaper
+	for (int y = 0; y < height; ++y)
+	{
+		uint8_t shade = static_cast<uint8_t>(40 + (y * 80) / height);
+		auto* row = reinterpret_cast<uint32_t*>(dst + static_cast<size_t>(y) * m_stride);
+		std::fill(row, row + width, MakeBGRA(shade / 3, shade / 2, shade));
+	}
+
+	// Taskbar
+	int taskbarHeight = std::max(height / 27, 8);
+	FillRect(dst, m_stride, width, height, 0, height - taskbarHeight, width, taskbarHeight, MakeBGRA(32, 32, 36));
+
+	// A handful of overlapping "application windows"
+	for (uint32_t i = 0; i < 6; ++i)
+	{
+		uint32_t h = Hash(seed, i, 0x57494e44);
+		int w = width / 5 + static_cast<int>(h % static_cast<uint32_t>(width / 3));
+		int ht = height / 5 + static_cast<int>((h >> 8) % static_cast<uint32_t>(height / 3));
+		int x = static_cast<int>(Hash(h) % static_cast<uint32_t>(std::max(width - w, 1)));
+		int y = static_cast<int>(Hash(h, 1) % static_cast<uint32_t>(std::max(height - ht - taskbarHeight, 1)));
+		int titleHeight = std::max(ht / 16, 4);
+
+		uint8_t body = static_cast<uint8_t>(200 + (h >> 24) % 48);
+		FillRect(dst, m_stride, width, height, x, y, w, ht, MakeBGRA(body, body, body));
+		FillRect(dst, m_stride, width, height, x, y, w, titleHeight, MakeBGRA(40, 70 + (h >> 16) % 100, 140));
+	}
+}
+
+void SyntheticGraphicsCapture::RenderTextRow(uint64_t absoluteRow, uint32_t* dst) const
+{
+	static constexpr std::array<uint32_t, 5> kInk = {
+		MakeBGRA(212, 212, 212), MakeBGRA(86, 156, 214), MakeBGRA(206, 145, 120),
+		MakeBGRA(106, 153, 85), MakeBGRA(197, 134, 192),
+	};
+	const uint32_t background = MakeBGRA(30, 30, 30);
+	const int width = m_syntheticConfig.width;
+	const uint32_t seed = m_syntheticConfig.seed;
+
+	const uint32_t line = static_cast<uint32_t>(absoluteRow / kLineHeight);
+	const int glyphRow = static_cast<int>(absoluteRow % kLineHeight);
+
+	std::fill(dst, dst + width, background);
+
+	// Blank line spacing above and below the glyph body
+	if (glyphRow < 2 || glyphRow >= kLineHeight - 2)
+		return;
+
+	const uint32_t lineHash = Hash(seed, line);
+	const int columns = width / kGlyphWidth;
+	const int indent = static_cast<int>(lineHash % 8) * 2;
+	const int length = std::min(columns, indent + static_cast<int>((lineHash >> 8) % 100));
+	const uint32_t ink = kInk[(lineHash >> 20) % kInk.size()];
+
+	for (int column = indent; column < length; ++column)
+	{
+		uint32_t glyph = Hash(lineHash, static_cast<uint32_t>(column));
+		if (glyph % 7 == 0)
+			continue; // Space
+
+		uint32_t bits = Hash(glyph % 96, static_cast<uint32_t>(glyphRow)) & 0x7E;
+		uint32_t* cell = dst + column * kGlyphWidth;
+		for (int bit = 0; bit < kGlyphWidth; ++bit)
+		{
+			if (bits & (0x80u >> bit))
+				cell[bit] = ink;
+		}
+	}
+}
+
+void SyntheticGraphicsCapture::RenderScrollingText(uint64_t frameIndex, bool firstFrame)
+{
+	const int height = m_syntheticConfig.height;
+	const int speed = m_syntheticConfig.scrollSpeed;
+	const uint64_t topRow = frameIndex * static_cast<uint64_t>(speed);
+
+	// Every row moves, so nothing is worth carrying over: the rows still in
+	// view are shifted up straight from the previous frame
+	const uint8_t* previous = m_frames.Current().Data();
+	uint8_t* frame = PrepareFrame(false);
+
+	int firstDirtyRow = 0;
+	if (!firstFrame && previous && speed < height)
+	{
+		// Only the rows scrolled into view are rendered
+		const size_t shifted = static_cast<size_t>(height - speed) * m_stride;
+		if (previous == frame)
+			std::memmove(frame, frame + static_cast<size_t>(speed) * m_stride, shifted);
+		else
+			std::memcpy(frame, previous + static_cast<size_t>(speed) * m_stride, shifted);
+		firstDirtyRow = height - speed;
+	}
+
+	for (int y = firstDirtyRow; y < height; ++y)
+	{
+		auto* row = reinterpret_cast<uint32_t*>(frame + static_cast<size_t>(y) * m_stride);
+		RenderTextRow(topRow + static_cast<uint64_t>(y), row);
+	}
+}
+
+void SyntheticGraphicsCapture::RenderVideo(uint64_t frameIndex)
+{
+	const int width = m_syntheticConfig.width;
+	const int height = m_syntheticConfig.height;
+
+	if (m_palette.empty())
+	{
+		m_palette.resize(256);
+		const double offset = static_cast<double>(m_syntheticConfig.seed % 256) / 256.0;
+		for (int i = 0; i < 256; ++i)
+		{
+			double t = (i / 256.0 + offset) * 6.283185307179586;
+			m_palette[i] = MakeBGRA(static_cast<uint8_t>(127.5 + 127.5 * std::sin(t)),
+									static_cast<uint8_t>(127.5 + 127.5 * std::sin(t + 2.094)),
+									static_cast<uint8_t>(127.5 + 127.5 * std::sin(t + 4.188)));
+		}
+	}
+	m_columnPhase.resize(width);
+
+	// Separable plasma: one table lookup per pixel, yet every pixel changes
+	// every frame so nothing downstream can take a shortcut.
+	const double t = static_cast<double>(frameIndex);
+	for (int x = 0; x < width; ++x)
+		m_columnPhase[x] = static_cast<int>(64.0 * std::sin(x * 0.013 + t * 0.11) + 32.0 * std::sin(x * 0.041 - t * 0.07));
+
+	uint8_t* frame = PrepareFrame(false);
+	const int frameShift = static_cast<int>(frameIndex * 3);
+	for (int y = 0; y < height; ++y)
+	{
+		int rowPhase = static_cast<int>(64.0 * std::sin(y * 0.017 - t * 0.09)) + frameShift;
+		auto* row = reinterpret_cast<uint32_t*>(frame + static_cast<size_t>(y) * m_stride);
+		for (int x = 0; x < width; ++x)
+			row[x] = m_palette[(m_columnPhase[x] + rowPhase) & 0xFF];
+	}
+}
+
+void SyntheticGraphicsCapture::GetCursorPosition(double tick, int& x, int& y) const
+{
+	const double t = tick * 0.02;
+	const double rangeX = m_syntheticConfig.width - kCursorWidth;
+	const double rangeY = m_syntheticConfig.height - kCursorHeight;
+	x = static_cast<int>(rangeX * (0.5 + 0.5 * std::sin(t * 3.0)));
+	y = static_cast<int>(rangeY * (0.5 + 0.5 * std::sin(t * 2.0 + 0.5)));
+}
+
+void SyntheticGraphicsCapture::RenderCursor(uint64_t frameIndex, bool firstFrame)
+{
+	uint8_t* frame = PrepareFrame(!firstFrame);
+
+	if (firstFrame)
+	{
+		m_background.resize(m_frameSize);
+		RenderDesktop(m_background.data());
+		std::memcpy(frame, m_background.data(), m_frameSize);
+	}
+	else
+	{
+		// Restore the pixels under the previous cursor position
+		for (int row = 0; row < kCursorHeight; ++row)
+		{
+			size_t offset = static_cast<size_t>(m_lastCursorY + row) * m_stride + static_cast<size_t>(m_lastCursorX) * 4;
+			std::memcpy(frame + offset, m_background.data() + offset, kCursorWidth * 4);
+		}
+		m_frames.MarkChanged(m_lastCursorY, m_lastCursorY + kCursorHeight);
+	}
+
+	int cursorX = 0, cursorY = 0;
+	GetCursorPosition(static_cast<double>(frameIndex), cursorX, cursorY);
+	m_frames.MarkChanged(cursorY, cursorY + kCursorHeight);
+	AlphaBlend::BlendOver(frame, m_stride, m_syntheticConfig.width, m_syntheticConfig.height, GetCursorImage().data(),
+						  kCursorWidth, kCursorHeight, cursorX, cursorY);
+
+	m_lastCursorX = cursorX;
+	m_lastCursorY = cursorY;
+}
@@ -0,0 +1,137 @@
+#pragma once
+
+#include "../IGraphicsCapture.h"
+#include "../CaptureScaler.h"
+#include "../CaptureWorker.h"
+#include "../CursorTracker.h"
+#include "../FrameBufferRing.h"
+#include "../FrameChangeDetector.h"
+#include "../FrameMailbox.h"
+#include "../FramePacer.h"
+#include "../ScreenshotWriter.h"
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// Content models produced by the synthetic backend. Each one stresses the
+// downstream pipeline differently (nothing changes, partial change, every
+// pixel changes, tiny localized change).
+enum class SyntheticContent
+{
+	StaticDesktop,
+	ScrollingText,
+	FullMotionVideo,
+	CursorOnly
+};
+
+struct SyntheticCaptureConfig
+{
+	int width = 1920;
+	int height = 1080;
+	int fps = 60; // Simulated display refresh; CaptureConfig::targetFps decimates from this
+	int scrollSpeed = 4; // Pixels per frame for ScrollingText
+	uint32_t seed = 1;
+};
+
+// Deterministic, display-less capture backend. Frames are generated on an
+// internal thread and delivered through the regular FrameCallback contract
+// (BGRA8, pointer valid only for the duration of the callback). Given the same
+// config and seed, frame N always has identical contents.
+class SyntheticGraphicsCapture : public IGraphicsCapture
+{
+public:
+	static constexpr int kMaxWidth = 7680;
+	static constexpr int kMaxHeight = 4320;
+
+	SyntheticGraphicsCapture();
+	explicit SyntheticGraphicsCapture(const SyntheticCaptureConfig& config);
+	~SyntheticGraphicsCapture() override;
+
+	bool Initialize() override;
+	bool SetD3DDevice(void* d3dDevice) override;
+	void Shutdown() override;
+
+	bool IsSupported() const override { return true; }
+	bool IsInitialized() const override { return m_initialized; }
+
+	std::vector<Monitor> GetMonitors() const override;
+	std::vector<Window> GetWindows() const override;
+	std::vector<CaptureSource> GetAvailableSources() const override;
+
+	bool SetCaptureConfig(const CaptureConfig& config) override;
+	CaptureConfig GetCaptureConfig() const override;
+	bool SetTargetFps(int fps) override;
+
+	bool StartCapture(const std::string& sourceId) override;
+	void StopCapture() override;
+	bool IsCapturing() const override { return m_isCapturing; }
+
+	bool SetFrameCallback(const FrameCallback& callback) override;
+	bool SetCursorCallback(const CursorCallback& callback) override;
+	bool GetLatestFrame(FrameData& outFrame) const override;
+	bool SaveScreenshot(const std::string& sourceId, const std::string& filePath) const override;
+
+	CaptureStatistics GetStatistics() const override;
+	bool IsCursorVisible() const override;
+
+	std::string_view GetPlatformName() const noexcept override { return "Synthetic Capture"; }
+
+	// Must be called while not capturing. Resolution is clamped to 8K.
+	bool SetSyntheticConfig(const SyntheticCaptureConfig& config);
+	SyntheticCaptureConfig GetSyntheticConfig() const { return m_syntheticConfig; }
+
+	// Parses SYNTHETIC_CAPTURE_MODE="<width>x<height>@<fps>" if set
+	static SyntheticCaptureConfig ConfigFromEnvironment();
+	static std::string GetSourceId(SyntheticContent content);
+
+private:
+	void CaptureThread(SyntheticContent content);
+	void ProduceFrame(SyntheticContent content, uint64_t frameIndex, std::chrono::steady_clock::time_point presented);
+	void StartCursorTracker(SyntheticContent content);
+
+	uint8_t* PrepareFrame(bool preserveContents);
+	void RenderDesktop(uint8_t* dst);
+	void RenderTextRow(uint64_t absoluteRow, uint32_t* dst) const;
+	void RenderScrollingText(uint64_t frameIndex, bool firstFrame);
+	void RenderVideo(uint64_t frameIndex);
+	void RenderCursor(uint64_t frameIndex, bool firstFrame);
+	// Pointer position at a generator tick; fractional ticks for the tracker
+	void GetCursorPosition(double tick, int& x, int& y) const;
+
+private:
+	bool m_initialized = false;
+	std::atomic<bool> m_isCapturing = false;
+	std::atomic<bool> m_stopRequested = false;
+	CaptureConfig m_config;
+	mutable std::mutex m_configMutex; // targetFps may change from another thread while capturing
+	SyntheticCaptureConfig m_syntheticConfig;
+
+	FramePacer m_pacer;
+	FrameChangeDetector m_changeDetector;
+	CaptureScaler m_scaler;
+	CaptureWorker m_worker;
+	mutable FrameMailbox m_mailbox;
+	mutable ScreenshotWriter m_screenshots;
+	CursorTracker m_cursorTracker;
+	std::string m_sourceId;
+	FrameRect m_region; // CaptureConfig::region, clipped to the generated surface
+
+	std::thread m_thread;
+	std::atomic<uint64_t> m_framesCaptured = 0;
+
+	std::shared_ptr<FrameBufferPool> m_bufferPool = FrameBufferPool::Create();
+
+	// Generator state, only touched by the capture thread
+	FrameBufferRing m_frames{ m_bufferPool };
+	size_t m_frameSize = 0;
+	std::vector<uint8_t> m_background;
+	std::vector<uint32_t> m_palette;
+	std::vector<int> m_columnPhase;
+	int m_stride = 0;
+	int m_lastCursorX = 0;
+	int m_lastCursorY = 0;
+};
@@ -0,0 +1,219 @@
+#include "../CaptureWorker.h"
+#include "testing/Test.h"
+
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace
+{
+	using namespace std::chrono_literals;
+
+	// Frame callback that records what it sees and can be held inside the
+	// first delivery, so the test fills the queue while the worker is busy
+	struct Consumer
+	{
+		struct Delivery
+		{
+			uint64_t timestampNs;
+			std::vector<FrameRect> dirtyRects;
+			bool isDuplicate;
+		};
+
+		std::mutex mutex;
+		std::condition_variable changed;
+		std::vector<Delivery> deliveries;
+		bool holding = true;
+		bool held = false;
+
+		void operator()(const FrameData& frame)
+		{
+			std::unique_lock lock(mutex);
+			deliveries.push_back({ frame.timestampNs,
+								   { frame.dirtyRects, frame.dirtyRects + frame.dirtyRectCount },
+								   frame.isDuplicate });
+			held = holding;
+			changed.notify_all();
+			changed.wait(lock, [this] { return !holding; });
+			held = false;
+		}
+
+		bool WaitUntilHeld()
+		{
+			std::unique_lock lock(mutex);
+			return changed.wait_for(lock, 5s, [this] { return held; });
+		}
+
+		void Release()
+		{
+			std::lock_guard lock(mutex);
+			holding = false;
+			changed.notify_all();
+		}
+
+		bool WaitForDeliveries(size_t count)
+		{
+			std::unique_lock lock(mutex);
+			return changed.wait_for(lock, 5s, [&] { return deliveries.size() >= count; });
+		}
+	};
+
+	FrameData MakeFrame(uint64_t timestampNs, const FrameRect* rect)
+	{
+		static uint8_t pixels[4];
+		FrameData frame;
+		frame.data = pixels;
+		frame.size = sizeof(pixels);
+		frame.width = 1;
+		frame.height = 1;
+		frame.stride = 4;
+		frame.timestampNs = timestampNs;
+		frame.dirtyRects = rect;
+		frame.dirtyRectCount = rect ? 1 : 0;
+		return frame;
+	}
+
+	const FrameRect kRects[] = { { 0, 0, 1, 1 }, { 1, 0, 1, 1 }, { 2, 0, 1, 1 }, { 3, 0, 1, 1 }, { 4, 0, 1, 1 } };
+
+	// Starts a worker with a two-frame queue and parks frame 1 in the callback
+	bool StartHeld(CaptureWorker& worker, Consumer& consumer, FrameDropPolicy policy)
+	{
+		worker.SetCallback([&consumer](const FrameData& frame) { consumer(frame); });
+		worker.Start(2, policy);
+		worker.Push(MakeFrame(1, &kRects[0]), CaptureWorker::Clock::now());
+		return consumer.WaitUntilHeld();
+	}
+
+	bool Contains(const std::vector<FrameRect>& rects, const FrameRect& rect)
+	{
+		for (const FrameRect& candidate : rects)
+		{
+			if (candidate == rect)
+				return true;
+		}
+		return false;
+	}
+}
+
+TEST(CaptureWorker_DropOldestKeepsTheNewestFrames)
+{
+	CaptureWorker worker;
+	Consumer consumer;
+	REQUIRE(StartHeld(worker, consumer, FrameDropPolicy::DropOldest));
+
+	const auto now = CaptureWorker::Clock::now();
+	CHECK(worker.Push(MakeFrame(2, &kRects[1]), now));
+	CHECK(worker.Push(MakeFrame(3, &kRects[2]), now));
+	CHECK(worker.Push(MakeFrame(4, &kRects[3]), now)); // Pushes frame 2 out
+	CHECK(worker.GetDroppedCount() == 1);
+
+	consumer.Release();
+	REQUIRE(consumer.WaitForDeliveries(3));
+	worker.Stop();
+
+	REQUIRE(consumer.deliveries.size() == 3);
+	CHECK(consumer.deliveries[1].timestampNs == 3);
+	CHECK(consumer.deliveries[2].timestampNs == 4);
+	// What the dropped frame changed arrives with the frame after it
+	CHECK(Contains(consumer.deliveries[1].dirtyRects, kRects[1]));
+	CHECK(Contains(consumer.deliveries[1].dirtyRects, kRects[2]));
+}
+
+TEST(CaptureWorker_DropNewestKeepsTheQueuedFrames)
+{
+	CaptureWorker worker;
+	Consumer consumer;
+	REQUIRE(StartHeld(worker, consumer, FrameDropPolicy::DropNewest));
+
+	const auto now = CaptureWorker::Clock::now();
+	CHECK(worker.Push(MakeFrame(2, &kRects[1]), now));
+	CHECK(worker.Push(MakeFrame(3, &kRects[2]), now));
+	CHECK(!worker.Push(MakeFrame(4, &kRects[3]), now));
+	CHECK(worker.GetDroppedCount() == 1);
+
+	consumer.Release();
+	REQUIRE(consumer.WaitForDeliveries(3));
+	CHECK(worker.Push(MakeFrame(5, &kRects[4]), now));
+	REQUIRE(consumer.WaitForDeliveries(4));
+	worker.Stop();
+
+	CHECK(consumer.deliveries[1].timestampNs == 2);
+	CHECK(consumer.deliveries[2].timestampNs == 3);
+	CHECK(consumer.deliveries[3].timestampNs == 5);
+	// The rejected frame's changes are folded into the next accepted one
+	CHECK(Contains(consumer.deliveries[3].dirtyRects, kRects[3]));
+	CHECK(Contains(consumer.deliveries[3].dirtyRects, kRects[4]));
+}
+
+TEST(CaptureWorker_DroppedFullFrameMakesTheNextOneFull)
+{
+	CaptureWorker worker;
+	Consumer consumer;
+	REQUIRE(StartHeld(worker, consumer, FrameDropPolicy::DropOldest));
+
+	const auto now = CaptureWorker::Clock::now();
+	worker.Push(MakeFrame(2, nullptr), now); // No rects: everything changed
+	worker.Push(MakeFrame(3, &kRects[2]), now);
+	worker.Push(MakeFrame(4, &kRects[3]), now);
+
+	consumer.Release();
+	REQUIRE(consumer.WaitForDeliveries(3));
+	worker.Stop();
+	CHECK(consumer.deliveries[1].timestampNs == 3);
+	CHECK(consumer.deliveries[1].dirtyRects.empty());
+}
+
+TEST(CaptureWorker_BlockStallsTheProducerAndLosesNothing)
+{
+	CaptureWorker worker;
+	Consumer consumer;
+	REQUIRE(StartHeld(worker, consumer, FrameDropPolicy::Block));
+
+	const auto now = CaptureWorker::Clock::now();
+	CHECK(worker.Push(MakeFrame(2, &kRects[1]), now));
+	CHECK(worker.Push(MakeFrame(3, &kRects[2]), now));
+
+	std::mutex mutex;
+	bool pushed = false;
+	std::thread producer([&] {
+		worker.Push(MakeFrame(4, &kRects[3]), now);
+		std::lock_guard lock(mutex);
+		pushed = true;
+	});
+	std::this_thread::sleep_for(50ms);
+	{
+		std::lock_guard lock(mutex);
+		CHECK(!pushed);
+	}
+
+	consumer.Release();
+	producer.join();
+	REQUIRE(consumer.WaitForDeliveries(4));
+	worker.Stop();
+	CHECK(worker.GetDroppedCount() == 0);
+	for (size_t i = 0; i < consumer.deliveries.size(); ++i)
+		CHECK(consumer.deliveries[i].timestampNs == i + 1);
+}
+
+TEST(CaptureWorker_StopReleasesABlockedProducer)
+{
+	CaptureWorker worker;
+	Consumer consumer;
+	REQUIRE(StartHeld(worker, consumer, FrameDropPolicy::Block));
+
+	const auto now = CaptureWorker::Clock::now();
+	worker.Push(MakeFrame(2, nullptr), now);
+	worker.Push(MakeFrame(3, nullptr), now);
+	bool accepted = true;
+	std::thread producer([&] { accepted = worker.Push(MakeFrame(4, nullptr), now); });
+	std::this_thread::sleep_for(20ms);
+
+	// Stop() joins the worker, which is still inside the held callback
+	std::thread stopper([&] { worker.Stop(); });
+	producer.join();
+	consumer.Release();
+	stopper.join();
+	CHECK(!accepted);
+}
@@ -0,0 +1,94 @@
+#include "../FrameBufferRing.h"
+#include "testing/Test.h"
+
+#include <cstring>
+#include <deque>
+#include <random>
+#include <vector>
+
+namespace
+{
+	constexpr int kStride = 16;
+	constexpr int kHeight = 64;
+	constexpr size_t kSize = static_cast<size_t>(kStride) * kHeight;
+
+	// A published frame a consumer holds, and what it must keep showing
+	struct Held
+	{
+		FrameBufferHandle buffer;
+		std::vector<uint8_t> expected;
+	};
+}
+
+TEST(FrameBufferRing_PreservesContentsWhileConsumersHoldFrames)
+{
+	FrameBufferRing ring(FrameBufferPool::Create());
+	std::vector<uint8_t> reference(kSize, 0);
+	std::deque<Held> held;
+	std::mt19937 random(7);
+
+	uint8_t* pixels = ring.Begin(kStride, kHeight, false);
+	std::memset(pixels, 0, kSize);
+	for (int frame = 1; frame < 500; ++frame)
+	{
+		// Consumers keep zero to six frames, like the mailbox and a worker queue
+		const size_t keep = random() % 7;
+		held.push_back({ ring.Current(), reference });
+		while (held.size() > keep)
+		{
+			CHECK(std::memcmp(held.front().buffer.Data(), held.front().expected.data(), kSize) == 0);
+			held.pop_front();
+		}
+
+		pixels = ring.Begin(kStride, kHeight, true);
+		REQUIRE(std::memcmp(pixels, reference.data(), kSize) == 0);
+
+		const int bands = static_cast<int>(random() % 3);
+		for (int band = 0; band < bands; ++band)
+		{
+			const int top = static_cast<int>(random() % kHeight);
+			const int bottom = top + 1 + static_cast<int>(random() % (kHeight - top));
+			for (int row = top; row < bottom; ++row)
+			{
+				std::memset(pixels + static_cast<size_t>(row) * kStride, frame, kStride);
+				std::memset(reference.data() + static_cast<size_t>(row) * kStride, frame, kStride);
+			}
+			ring.MarkChanged(top, bottom);
+		}
+	}
+	for (const Held& frame : held)
+		CHECK(std::memcmp(frame.buffer.Data(), frame.expected.data(), kSize) == 0);
+}
+
+TEST(FrameBufferRing_CopiesOnlyStaleRows)
+{
+	FrameBufferRing ring(FrameBufferPool::Create());
+	std::memset(ring.Begin(kStride, kHeight, false), 0, kSize);
+
+	// A consumer holds frame 0, so frame 1 goes to a fresh buffer: one full copy
+	FrameBufferHandle consumer = ring.Current();
+	ring.Begin(kStride, kHeight, true);
+	ring.MarkChanged(0, 4);
+	CHECK(ring.GetCopiedBytes() == kSize);
+
+	// Frame 0's buffer comes back and is only four rows behind
+	consumer = ring.Current();
+	ring.Begin(kStride, kHeight, true);
+	CHECK(ring.GetCopiedBytes() == kSize + 4 * kStride);
+}
+
+TEST(FrameBufferRing_ReusesTheCurrentBufferWhenNobodyTookIt)
+{
+	FrameBufferRing ring(FrameBufferPool::Create());
+	uint8_t* first = ring.Begin(kStride, kHeight, false);
+	CHECK(ring.Begin(kStride, kHeight, true) == first);
+	CHECK(ring.GetCopiedBytes() == 0);
+}
+
+TEST(FrameBufferRing_NewSizeStartsOver)
+{
+	FrameBufferRing ring(FrameBufferPool::Create());
+	ring.Begin(kStride, kHeight, false);
+	ring.Begin(kStride * 2, kHeight, false);
+	CHECK(ring.Current().Size() == kSize * 2);
+}
@@ -0,0 +1,76 @@
+#include "../FrameMailbox.h"
+#include "testing/Test.h"
+
+namespace
+{
+	FrameData MakeFrame(uint64_t timestampNs)
+	{
+		static uint8_t pixels[4];
+		FrameData frame;
+		frame.data = pixels;
+		frame.size = sizeof(pixels);
+		frame.width = 1;
+		frame.height = 1;
+		frame.stride = 4;
+		frame.timestampNs = timestampNs;
+		return frame;
+	}
+}
+
+TEST(FrameMailbox_NothingBeforeFirstPublish)
+{
+	FrameMailbox mailbox;
+	FrameData frame;
+	CHECK(!mailbox.Acquire(frame));
+}
+
+TEST(FrameMailbox_AcquireReturnsNewestAndRepeatsIt)
+{
+	FrameMailbox mailbox;
+	mailbox.Publish(MakeFrame(1));
+	FrameData frame;
+	REQUIRE(mailbox.Acquire(frame));
+	CHECK(frame.timestampNs == 1);
+
+	// Nothing new: the same frame again, not counted as consumed twice
+	REQUIRE(mailbox.Acquire(frame));
+	CHECK(frame.timestampNs == 1);
+	CHECK(mailbox.GetConsumedCount() == 1);
+
+	mailbox.Publish(MakeFrame(2));
+	REQUIRE(mailbox.Acquire(frame));
+	CHECK(frame.timestampNs == 2);
+	CHECK(mailbox.GetOverwrittenCount() == 0);
+}
+
+TEST(FrameMailbox_UnreadFramesAreOverwritten)
+{
+	FrameMailbox mailbox;
+	for (uint64_t i = 1; i <= 5; ++i)
+		mailbox.Publish(MakeFrame(i));
+
+	FrameData frame;
+	REQUIRE(mailbox.Acquire(frame));
+	CHECK(frame.timestampNs == 5);
+	CHECK(mailbox.GetPublishedCount() == 5);
+	CHECK(mailbox.GetOverwrittenCount() == 4);
+	CHECK(mailbox.GetConsumedCount() == 1);
+}
+
+TEST(FrameMailbox_DropsDirtyRectsAndDuplicateFlag)
+{
+	// A reader may skip frames, so per-frame change information is meaningless
+	const FrameRect rect = { 1, 2, 3, 4 };
+	FrameData published = MakeFrame(1);
+	published.dirtyRects = &rect;
+	published.dirtyRectCount = 1;
+	published.isDuplicate = true;
+
+	FrameMailbox mailbox;
+	mailbox.Publish(published);
+	FrameData frame;
+	REQUIRE(mailbox.Acquire(frame));
+	CHECK(frame.dirtyRects == nullptr);
+	CHECK(frame.dirtyRectCount == 0);
+	CHECK(!frame.isDuplicate);
+}
@@ -0,0 +1,73 @@
+#include "../FramePacer.h"
+#include "testing/Test.h"
+
+#include <cmath>
+
+namespace
+{
+	using Clock = FramePacer::Clock;
+
+	// Offers `count` arrivals at `sourceHz` and returns how many were accepted
+	int Offer(FramePacer& pacer, double sourceHz, int count)
+	{
+		const Clock::time_point start = Clock::now();
+		int accepted = 0;
+		for (int i = 0; i < count; ++i)
+		{
+			const auto arrival = start + std::chrono::nanoseconds(static_cast<int64_t>(i * 1e9 / sourceHz));
+			accepted += pacer.ShouldAccept(arrival) ? 1 : 0;
+		}
+		return accepted;
+	}
+}
+
+TEST(FramePacer_HalvesA60HzSourceAt30Fps)
+{
+	FramePacer pacer;
+	pacer.SetTargetFps(30);
+	CHECK(Offer(pacer, 60.0, 120) == 60);
+	CHECK(pacer.GetDecimatedCount() == 60);
+	CHECK(std::abs(pacer.GetAchievedFps() - 30.0) < 0.5);
+}
+
+TEST(FramePacer_ToleratesSourcesSlightlySlowerThanTheGrid)
+{
+	// 59.94 Hz against a 60 Hz deadline grid must not drop every other frame
+	FramePacer pacer;
+	pacer.SetTargetFps(60);
+	CHECK(Offer(pacer, 59.94, 600) == 600);
+}
+
+TEST(FramePacer_DecimatesUnevenRatios)
+{
+	FramePacer pacer;
+	pacer.SetTargetFps(60);
+	const int accepted = Offer(pacer, 144.0, 144);
+	CHECK(accepted >= 59 && accepted <= 61);
+	CHECK(pacer.GetDecimatedCount() == static_cast<uint64_t>(144 - accepted));
+}
+
+TEST(FramePacer_AcceptsEverythingWhenUnpaced)
+{
+	FramePacer pacer;
+	pacer.SetTargetFps(0);
+	CHECK(Offer(pacer, 240.0, 240) == 240);
+	CHECK(pacer.GetDecimatedCount() == 0);
+}
+
+TEST(FramePacer_NewRateTakesEffectWhileRunning)
+{
+	FramePacer pacer;
+	pacer.SetTargetFps(60);
+	const Clock::time_point start = Clock::now();
+	int accepted = 0;
+	for (int i = 0; i < 240; ++i)
+	{
+		if (i == 120)
+			pacer.SetTargetFps(15);
+		const auto arrival = start + std::chrono::nanoseconds(static_cast<int64_t>(i * 1e9 / 120.0));
+		accepted += pacer.ShouldAccept(arrival) ? 1 : 0;
+	}
+	// A second at 60 fps, then a second at 15
+	CHECK(accepted >= 74 && accepted <= 76);
+}
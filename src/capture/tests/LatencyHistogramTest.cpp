@@ -0,0 +1,73 @@
+#include "../IGraphicsCapture.h"
+#include "../LatencyHistogram.h"
+#include "testing/Test.h"
+
+#include <cmath>
+
+namespace
+{
+	// Buckets keep five significant bits, so a percentile may read up to
+	// 1/16 above the exact value and never below it
+	bool WithinBucket(uint64_t reported, uint64_t exact)
+	{
+		return reported >= exact && reported <= exact + exact / 16 + 1;
+	}
+}
+
+TEST(LatencyHistogram_EmptyReadsZero)
+{
+	LatencyHistogram histogram;
+	CHECK(histogram.GetCount() == 0);
+	CHECK(histogram.GetPercentile(50.0) == 0);
+	CHECK(histogram.GetMax() == 0);
+}
+
+TEST(LatencyHistogram_SmallValuesAreExact)
+{
+	LatencyHistogram histogram;
+	for (uint64_t value = 0; value < 32; ++value)
+		histogram.Record(value);
+	CHECK(histogram.GetPercentile(50.0) == 15);
+	CHECK(histogram.GetPercentile(100.0) == 31);
+}
+
+TEST(LatencyHistogram_PercentilesOfAUniformRange)
+{
+	LatencyHistogram histogram;
+	for (uint64_t value = 1; value <= 10000; ++value)
+		histogram.Record(value);
+
+	CHECK(histogram.GetCount() == 10000);
+	CHECK(WithinBucket(histogram.GetPercentile(50.0), 5000));
+	CHECK(WithinBucket(histogram.GetPercentile(95.0), 9500));
+	CHECK(WithinBucket(histogram.GetPercentile(99.0), 9900));
+	CHECK(histogram.GetPercentile(100.0) == 10000); // Capped at the exact maximum
+	CHECK(histogram.GetMax() == 10000);
+}
+
+TEST(LatencyHistogram_TailIsNotHiddenByTheBulk)
+{
+	LatencyHistogram histogram;
+	for (int i = 0; i < 990; ++i)
+		histogram.Record(1000);
+	for (int i = 0; i < 10; ++i)
+		histogram.Record(250000);
+
+	CHECK(WithinBucket(histogram.GetPercentile(50.0), 1000));
+	CHECK(WithinBucket(histogram.GetPercentile(99.0), 1000));
+	CHECK(histogram.GetPercentile(99.5) == 250000);
+
+	const LatencyPercentiles summary = histogram.Summarize();
+	CHECK(summary.samples == 1000);
+	CHECK(std::abs(summary.maxMs - 250.0) < 1e-9);
+}
+
+TEST(LatencyHistogram_ResetForgetsEverything)
+{
+	LatencyHistogram histogram;
+	histogram.Record(12345);
+	histogram.Reset();
+	CHECK(histogram.GetCount() == 0);
+	CHECK(histogram.GetMax() == 0);
+	CHECK(histogram.GetPercentile(99.0) == 0);
+}
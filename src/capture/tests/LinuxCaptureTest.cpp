@@ -0,0 +1,174 @@
+#include "../IGraphicsCapture.h"
+#include "testing/Test.h"
+
+#include <chrono>
+#include <condition_variable>
+#include <cstring>
+#include <format>
+#include <mutex>
+#include <vector>
+
+// Rename Xlib's Window typedef so it does not clash with ::Window
+#define Window XWindow
+#include <X11/Xlib.h>
+#undef Window
+#undef CursorShape
+
+// Drives the X11 backend against a real server: run under xvfb-run (see
+// CMakeLists.txt). A window is drawn into with Xlib and the delivered frames
+// must show the drawing, with dirty rects around it.
+
+namespace
+{
+	constexpr int kWidth = 320;
+	constexpr int kHeight = 240;
+	constexpr FrameRect kDrawn = { 40, 30, 64, 48 };
+
+	// Copies of delivered frames, taken on the capture worker thread
+	class FrameSink
+	{
+	public:
+		struct Frame
+		{
+			int width = 0;
+			int height = 0;
+			std::vector<uint32_t> pixels; // BGRA, tightly packed
+			std::vector<FrameRect> dirtyRects;
+			bool isDuplicate = false;
+		};
+
+		void OnFrame(const FrameData& frame)
+		{
+			Frame copy;
+			copy.width = frame.width;
+			copy.height = frame.height;
+			copy.pixels.resize(static_cast<size_t>(frame.width) * frame.height);
+			const BgraView view = frame.GetView();
+			for (int y = 0; y < frame.height; ++y)
+				std::memcpy(&copy.pixels[static_cast<size_t>(y) * frame.width], view.RowData(y), view.RowBytes());
+			copy.dirtyRects.assign(frame.dirtyRects, frame.dirtyRects + frame.dirtyRectCount);
+			copy.isDuplicate = frame.isDuplicate;
+
+			std::lock_guard lock(m_mutex);
+			m_frames.push_back(std::move(copy));
+			m_arrived.notify_all();
+		}
+
+		// The first frame after those already taken that `accept` likes
+		template <typename Predicate>
+		bool WaitFor(Predicate accept, Frame& out)
+		{
+			std::unique_lock lock(m_mutex);
+			const auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(5);
+			while (true)
+			{
+				for (; m_next < m_frames.size(); ++m_next)
+				{
+					if (accept(m_frames[m_next]))
+					{
+						out = m_frames[m_next++];
+						return true;
+					}
+				}
+				if (m_arrived.wait_until(lock, deadline) == std::cv_status::timeout)
+					return false;
+			}
+		}
+
+	private:
+		std::mutex m_mutex;
+		std::condition_variable m_arrived;
+		std::vector<Frame> m_frames;
+		size_t m_next = 0;
+	};
+
+	// A frame pixel without its alpha, 0xRRGGBB like an X11 TrueColor pixel
+	uint32_t Pixel(const FrameSink::Frame& frame, int x, int y)
+	{
+		return frame.pixels[static_cast<size_t>(y) * frame.width + x] & 0x00FFFFFF;
+	}
+
+	bool Inside(const FrameRect& rect, int x, int y)
+	{
+		return x >= rect.x && y >= rect.y && x < rect.x + rect.width && y < rect.y + rect.height;
+	}
+
+	bool Covered(const std::vector<FrameRect>& rects, int x, int y)
+	{
+		for (const FrameRect& rect : rects)
+		{
+			if (Inside(rect, x, y))
+				return true;
+		}
+		return false;
+	}
+}
+
+TEST(LinuxCapture_DeliversWindowContentsAndDirtyRects)
+{
+	Display* display = XOpenDisplay(nullptr);
+	REQUIRE(display);
+	const int screen = DefaultScreen(display);
+	const XWindow window = XCreateSimpleWindow(display, RootWindow(display, screen), 0, 0, kWidth, kHeight, 0, 0,
+											  BlackPixel(display, screen));
+	XSelectInput(display, window, StructureNotifyMask);
+	XMapWindow(display, window);
+	for (XEvent event; XNextEvent(display, &event), event.type != MapNotify;)
+	{
+	}
+	GC gc = XCreateGC(display, window, 0, nullptr);
+	XSetForeground(display, gc, BlackPixel(display, screen));
+	XFillRectangle(display, window, gc, 0, 0, kWidth, kHeight);
+	XSync(display, False);
+
+	auto capture = IGraphicsCapture::Create(CaptureBackend::Platform);
+	REQUIRE(capture && capture->Initialize());
+	CaptureConfig config;
+	config.quality = CaptureQuality::High;
+	config.targetFps = 0;
+	config.cursorMode = CursorMode::Hidden;
+	REQUIRE(capture->SetCaptureConfig(config));
+	FrameSink sink;
+	capture->SetFrameCallback([&sink](const FrameData& frame) { sink.OnFrame(frame); });
+	REQUIRE(capture->StartCapture(std::format("window:{}", window)));
+
+	FrameSink::Frame frame;
+	const bool gotFirst = sink.WaitFor([](const FrameSink::Frame&) { return true; }, frame);
+	CHECK(gotFirst);
+	if (gotFirst)
+	{
+		CHECK(frame.width == kWidth && frame.height == kHeight);
+		CHECK(Pixel(frame, 0, 0) == 0 && Pixel(frame, kWidth - 1, kHeight - 1) == 0);
+	}
+
+	// Red on a TrueColor visual (Xvfb's 24-bit default)
+	XSetForeground(display, gc, 0xFF0000);
+	XFillRectangle(display, window, gc, kDrawn.x, kDrawn.y, kDrawn.width, kDrawn.height);
+	XSync(display, False);
+
+	const bool gotDrawing = sink.WaitFor(
+		[](const FrameSink::Frame& f) { return !f.isDuplicate && Pixel(f, kDrawn.x, kDrawn.y) == 0xFF0000; }, frame);
+	CHECK(gotDrawing);
+	if (gotDrawing)
+	{
+		bool contentsMatch = true;
+		for (int y = 0; y < kHeight; ++y)
+		{
+			for (int x = 0; x < kWidth; ++x)
+				contentsMatch &= Pixel(frame, x, y) == (Inside(kDrawn, x, y) ? 0xFF0000u : 0u);
+		}
+		CHECK(contentsMatch);
+
+		// The rects cover the drawing and stay near it
+		REQUIRE(!frame.dirtyRects.empty());
+		CHECK(Covered(frame.dirtyRects, kDrawn.x, kDrawn.y));
+		CHECK(Covered(frame.dirtyRects, kDrawn.x + kDrawn.width - 1, kDrawn.y + kDrawn.height - 1));
+		CHECK(!Covered(frame.dirtyRects, kWidth - 1, kHeight - 1));
+	}
+
+	capture->StopCapture();
+	capture->Shutdown();
+	XFreeGC(display, gc);
+	XDestroyWindow(display, window);
+	XCloseDisplay(display);
+}
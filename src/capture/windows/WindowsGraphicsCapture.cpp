@@ -1,7 +1,10 @@
 #include "WindowsGraphicsCapture.h"
+#include "../../platform/ProcessMetrics.h"
+#include <algorithm>
 #include <iostream>
 #include <vector>
 #include <shellscalingapi.h>
+#include <dwmapi.h>
 #include <psapi.h>
 #include <winrt/base.h>
 #include <winrt/Windows.Graphics.Capture.h>
@@ -22,7 +25,138 @@ using GraphicsCaptureSession = winrt::Windows::Graphics::Capture::GraphicsCaptur
 using Direct3D11CaptureFramePool = winrt::Windows::Graphics::Capture::Direct3D11CaptureFramePool;
 using IDirect3DDevice = winrt::Windows::Graphics::DirectX::Direct3D11::IDirect3DDevice;
 
+namespace
+{
+    // Executable file name of a process, e.g. "notepad.exe"
+    std::string GetProcessName(int pid)
+    {
+        std::string name;
+        HANDLE hProcess = OpenProcess(PROCESS_QUERY_LIMITED_INFORMATION, FALSE, static_cast<DWORD>(pid));
+        if (hProcess)
+        {
+            char processName[MAX_PATH];
+            DWORD size = sizeof(processName);
+            if (QueryFullProcessImageNameA(hProcess, 0, processName, &size))
+            {
+                // Extract just the filename
+                std::string fullPath(processName, size);
+                size_t lastSlash = fullPath.find_last_of("\\/");
+                name = (lastSlash != std::string::npos) ? fullPath.substr(lastSlash + 1) : fullPath;
+            }
+            CloseHandle(hProcess);
+        }
+        return name;
+    }
+
+    // Screen rectangle of the captured window (without the invisible resize
+    // borders) or monitor
+    bool GetTargetRect(HWND hwnd, HMONITOR monitor, RECT& rect)
+    {
+        if (hwnd)
+            return SUCCEEDED(DwmGetWindowAttribute(hwnd, DWMWA_EXTENDED_FRAME_BOUNDS, &rect, sizeof(rect)));
+
+        MONITORINFO info = {};
+        info.cbSize = sizeof(info);
+        if (!GetMonitorInfo(monitor, &info))
+            return false;
+        rect = info.rcMonitor;
+        return true;
+    }
+
+    // Reads a bitmap as 32-bit top-down BGRA rows
+    bool ReadBitmap(HDC dc, HBITMAP bitmap, int width, int height, std::vector<uint32_t>& pixels)
+    {
+        BITMAPINFO info = {};
+        info.bmiHeader.biSize = sizeof(info.bmiHeader);
+        info.bmiHeader.biWidth = width;
+        info.bmiHeader.biHeight = -height;
+        info.bmiHeader.biPlanes = 1;
+        info.bmiHeader.biBitCount = 32;
+        info.bmiHeader.biCompression = BI_RGB;
+        pixels.resize(static_cast<size_t>(width) * height);
+        return GetDIBits(dc, bitmap, 0, height, pixels.data(), &info, DIB_RGB_COLORS) == height;
+    }
+
+    // Converts the current cursor to a premultiplied BGRA shape. Color cursors
+    // carry straight alpha, or none at all with the AND mask as transparency;
+    // monochrome ones are an AND mask stacked on an XOR mask.
+    bool ReadCursorShape(CursorShape& shape)
+    {
+        CURSORINFO cursorInfo = {};
+        cursorInfo.cbSize = sizeof(cursorInfo);
+        if (!GetCursorInfo(&cursorInfo) || !cursorInfo.hCursor)
+            return false;
+
+        ICONINFO iconInfo = {};
+        if (!GetIconInfo(cursorInfo.hCursor, &iconInfo))
+            return false;
+
+        BITMAP mask = {};
+        GetObject(iconInfo.hbmMask, sizeof(mask), &mask);
+        const int width = mask.bmWidth;
+        const int height = iconInfo.hbmColor ? mask.bmHeight : mask.bmHeight / 2;
+
+        HDC dc = GetDC(nullptr);
+        std::vector<uint32_t> maskPixels;
+        bool ok = width > 0 && height > 0 && ReadBitmap(dc, iconInfo.hbmMask, width, mask.bmHeight, maskPixels);
+        if (ok && iconInfo.hbmColor)
+            ok = ReadBitmap(dc, iconInfo.hbmColor, width, height, shape.pixels);
+        ReleaseDC(nullptr, dc);
+
+        if (iconInfo.hbmColor)
+            DeleteObject(iconInfo.hbmColor);
+        DeleteObject(iconInfo.hbmMask);
+        if (!ok)
+            return false;
+
+        shape.width = width;
+        shape.height = height;
+        shape.hotspotX = static_cast<int>(iconInfo.xHotspot);
+        shape.hotspotY = static_cast<int>(iconInfo.yHotspot);
+
+        if (iconInfo.hbmColor)
+        {
+            const bool hasAlpha = std::any_of(shape.pixels.begin(), shape.pixels.end(),
+                                              [](uint32_t pixel) { return (pixel >> 24) != 0; });
+            for (size_t i = 0; i < shape.pixels.size(); ++i)
+            {
+                uint32_t pixel = shape.pixels[i];
+                if (!hasAlpha)
+                {
+                    shape.pixels[i] = (maskPixels[i] & 0xFFFFFF) ? 0 : (pixel | 0xFF000000u);
+                    continue;
+                }
+                const uint32_t alpha = pixel >> 24;
+                const uint32_t b = (pixel & 0xFF) * alpha / 255;
+                const uint32_t g = ((pixel >> 8) & 0xFF) * alpha / 255;
+                const uint32_t r = ((pixel >> 16) & 0xFF) * alpha / 255;
+                shape.pixels[i] = (alpha << 24) | (r << 16) | (g << 8) | b;
+            }
+            return true;
+        }
+
+        // Monochrome: AND 1 / XOR 0 is transparent, AND 0 paints the XOR
+        // color. Inverting pixels (both 1) cannot be expressed as an overlay
+        // and become black, which keeps the I-beam visible on light content.
+        shape.pixels.resize(static_cast<size_t>(width) * height);
+        const size_t planeSize = shape.pixels.size();
+        for (size_t i = 0; i < planeSize; ++i)
+        {
+            const bool andBit = (maskPixels[i] & 0xFFFFFF) != 0;
+            const bool xorBit = (maskPixels[planeSize + i] & 0xFFFFFF) != 0;
+            if (andBit && !xorBit)
+                shape.pixels[i] = 0;
+            else if (!andBit && xorBit)
+                shape.pixels[i] = 0xFFFFFFFFu;
+            else
+                shape.pixels[i] = 0xFF000000u;
+        }
+        return true;
+    }
+}
+
 WindowsGraphicsCapture::WindowsGraphicsCapture()
+    : m_processNames(GetProcessName)
 {
 }
 
@@ -169,9 +303,15 @@ std::vector<Window> WindowsGraphicsCapture::GetWindows() const
     if (!m_initialized)
         return windows;
 
+    struct EnumContext
+    {
+        std::vector<Window>* windows;
+        ProcessNameCache* processNames;
+    } context = { &windows, &m_processNames };
+
     EnumWindows([](HWND hwnd, LPARAM lParam) -> BOOL
     {
-        auto* windows = reinterpret_cast<std::vector<Window>*>(lParam);
+        auto* context = reinterpret_cast<EnumContext*>(lParam);
         
         if (IsWindowVisible(hwnd) && GetWindowTextLength(hwnd) > 0)
         {
@@ -187,22 +327,7 @@ std::vector<Window> WindowsGraphicsCapture::GetWindows() const
             DWORD processId;
             GetWindowThreadProcessId(hwnd, &processId);
             window.processId = processId;
-            
-            HANDLE hProcess = OpenProcess(PROCESS_QUERY_INFORMATION, FALSE, processId);
-            if (hProcess)
-            {
-                char processName[MAX_PATH];
-                DWORD size = sizeof(processName);
-                if (QueryFullProcessImageNameA(hProcess, 0, processName, &size))
-                {
-                    // Extract just the filename
-                    std::string fullPath(processName);
-                    size_t lastSlash = fullPath.find_last_of("\\/");
-                    window.processName = (lastSlash != std::string::npos) ? 
-                        fullPath.substr(lastSlash + 1) : fullPath;
-                }
-                CloseHandle(hProcess);
-            }
+            window.processName = context->processNames->Get(static_cast<int>(processId));
             
             // Get window position and size
             RECT rect;
@@ -217,12 +342,13 @@ std::vector<Window> WindowsGraphicsCapture::GetWindows() const
             window.isVisible = IsWindowVisible(hwnd);
             window.isMinimized = IsIconic(hwnd);
             
-            windows->push_back(window);
+            context->windows->push_back(window);
         }
         
         return TRUE;
-    }, reinterpret_cast<LPARAM>(&windows));
-    
+    }, reinterpret_cast<LPARAM>(&context));
+
+    m_processNames.Prune();
     return windows;
 }
 
@@ -320,6 +446,13 @@ bool WindowsGraphicsCapture::StartCapture(const std::string& sourceId)
             }
         }
         
+        const FrameRect captureRegion = ClipCaptureRegion(m_config.region, width, height);
+        if (captureRegion.width <= 0 || captureRegion.height <= 0)
+        {
+            std::cout << "Capture region is outside the " << width << "x" << height << " source" << std::endl;
+            return false;
+        }
+
         // Create real capture session
         if (!m_device)
         {
@@ -342,7 +475,34 @@ bool WindowsGraphicsCapture::StartCapture(const std::string& sourceId)
         
         // Create capture session
         m_session = m_framePool.CreateCaptureSession(m_captureItem);
+        try
+        {
+            // Only Embedded lets WGC draw the cursor into the frames
+            m_session.IsCursorCaptureEnabled(m_config.cursorMode == CursorMode::Embedded);
+        }
+        catch (...)
+        {
+            std::cout << "Cursor capture setting not supported on this Windows version" << std::endl;
+        }
         
+        // Frames are handed to the worker so slow consumers never stall FrameArrived
+        m_worker.Start(m_config.queueDepth, m_config.dropPolicy);
+        {
+            std::lock_guard lock(m_configMutex);
+            m_pacer.SetTargetFps(m_config.targetFps);
+        }
+        m_pacer.Reset();
+        m_changeDetector.Configure(m_config);
+        m_scaler.Configure(m_config);
+        m_sourceId = sourceId;
+        if (m_config.cursorMode == CursorMode::Metadata)
+        {
+            int frameWidth, frameHeight;
+            CaptureScaler::GetOutputSize(m_config, captureRegion.width, captureRegion.height, frameWidth, frameHeight);
+            m_cursorTracker.SetFrameGeometry(captureRegion.width, captureRegion.height, frameWidth, frameHeight);
+            StartCursorTracker(IsWindow(hwnd) ? hwnd : nullptr, IsWindow(hwnd) ? nullptr : reinterpret_cast<HMONITOR>(handleValue));
+        }
+
         // Start capturing!
         m_session.StartCapture();
         
@@ -358,6 +518,28 @@ bool WindowsGraphicsCapture::StartCapture(const std::string& sourceId)
     }
 }
 
+void WindowsGraphicsCapture::StartCursorTracker(HWND hwnd, HMONITOR monitor)
+{
+    auto sampler = [hwnd, monitor, captureRegion = m_config.region](CursorSample& sample) {
+        CURSORINFO cursorInfo = {};
+        cursorInfo.cbSize = sizeof(cursorInfo);
+        RECT rect = {};
+        if (!GetCursorInfo(&cursorInfo) || !GetTargetRect(hwnd, monitor, rect))
+            return false;
+
+        // ptScreenPos is the hotspot, in physical pixels for a DPI-aware process
+        const FrameRect region = ClipCaptureRegion(captureRegion, rect.right - rect.left, rect.bottom - rect.top);
+        sample.x = cursorInfo.ptScreenPos.x - rect.left - region.x;
+        sample.y = cursorInfo.ptScreenPos.y - rect.top - region.y;
+        sample.visible = (cursorInfo.flags & CURSOR_SHOWING) && cursorInfo.hCursor && sample.x >= 0 && sample.y >= 0 &&
+                         sample.x < region.width && sample.y < region.height;
+        sample.shapeKey = reinterpret_cast<uint64_t>(cursorInfo.hCursor);
+        return true;
+    };
+
+    m_cursorTracker.Start(m_config.cursorRateHz, sampler, ReadCursorShape, true);
+}
+
 void WindowsGraphicsCapture::OnFrameArrived()
 {
     if (!m_framePool)
@@ -370,10 +552,26 @@ void WindowsGraphicsCapture::OnFrameArrived()
         if (!frame)
             return;
 
-        // Extract pixel data from the captured frame
+        // Frames arrive at the display refresh; decimate before paying for readback
+        const auto arrival = FramePacer::Clock::now();
+        if (!m_pacer.ShouldAccept(arrival))
+            return;
+
+        // SystemRelativeTime is QPC in 100 ns ticks, the same clock steady_clock
+        // reads on Windows, so it is directly comparable with FrameClock stamps
+        const uint64_t arrivalNs = FrameClock::FromTimePoint(arrival);
+        uint64_t presentedNs = static_cast<uint64_t>(frame.SystemRelativeTime().count()) * 100;
+        if (presentedNs > arrivalNs)
+            presentedNs = 0;
+
+        // Extract pixel data from the captured frame; only the capture region
+        // is copied to the staging texture and read back
         auto size = frame.ContentSize();
+        FrameRect region = ClipCaptureRegion(m_config.region, size.Width, size.Height);
+        if (region.width <= 0 || region.height <= 0)
+            return;
         
-        if (m_frameCallback)
+        // Read back even without a callback so pull-mode consumers (GetLatestFrame) see frames
         {
             try
             {
@@ -395,6 +593,14 @@ void WindowsGraphicsCapture::OnFrameArrived()
                         D3D11_TEXTURE2D_DESC desc;
                         nativeSurface->GetDesc(&desc);
                         
+                        // ContentSize runs ahead of the pool's surfaces while a window grows
+                        region.width = std::min(region.width, static_cast<int>(desc.Width) - region.x);
+                        region.height = std::min(region.height, static_cast<int>(desc.Height) - region.y);
+                        if (region.width <= 0 || region.height <= 0)
+                            return;
+
+                        desc.Width = region.width;
+                        desc.Height = region.height;
                         desc.Usage = D3D11_USAGE_STAGING;
                         desc.BindFlags = 0;
                         desc.CPUAccessFlags = D3D11_CPU_ACCESS_READ;
@@ -408,8 +614,14 @@ void WindowsGraphicsCapture::OnFrameArrived()
                         
                         if (SUCCEEDED(hr))
                         {
-                            // Copy the captured frame to staging texture
-                            context->CopyResource(stagingTexture.get(), nativeSurface.get());
+                            // Copy the captured region to staging texture
+                            D3D11_BOX box = {};
+                            box.left = region.x;
+                            box.top = region.y;
+                            box.right = region.x + region.width;
+                            box.bottom = region.y + region.height;
+                            box.back = 1;
+                            context->CopySubresourceRegion(stagingTexture.get(), 0, 0, 0, 0, nativeSurface.get(), 0, &box);
                             
                             // Map the staging texture to read pixels
                             D3D11_MAPPED_SUBRESOURCE mapped;
@@ -417,19 +629,39 @@ void WindowsGraphicsCapture::OnFrameArrived()
                             
                             if (SUCCEEDED(hr))
                             {
+                                // Copy out once into a pooled buffer so the staging texture can be
+                                // unmapped right away and consumers may keep the frame afterwards
+                                size_t frameSize = static_cast<size_t>(mapped.RowPitch) * region.height;
+                                FrameBufferHandle buffer = m_bufferPool->Acquire(frameSize);
+                                memcpy(buffer.Data(), mapped.pData, frameSize);
+                                context->Unmap(stagingTexture.get(), 0);
+
                                 // Create FrameData with actual pixel data
                                 FrameData frameData;
-                                frameData.width = size.Width;
-                                frameData.height = size.Height;
+                                frameData.width = region.width;
+                                frameData.height = region.height;
                                 frameData.stride = mapped.RowPitch;
-                                frameData.data = mapped.pData;
-                                frameData.size = mapped.RowPitch * size.Height;
-                                frameData.timestamp = GetTickCount64();
+                                frameData.data = buffer.Data();
+                                frameData.size = frameSize;
+                                frameData.timestampNs = arrivalNs;
+                                frameData.presentationTimeNs = presentedNs ? presentedNs : arrivalNs;
+                                frameData.traceId = FrameTracer::Shared().Begin(presentedNs, arrivalNs);
+                                frameData.buffer = std::move(buffer);
+                                FrameTracer::Shared().Stamp(frameData.traceId, FrameStage::Copied);
                                 
                                 // Send the real screen pixels!
-                                m_frameCallback(frameData);
-                                
-                                context->Unmap(stagingTexture.get(), 0);
+                                m_screenshots.Offer(frameData);
+                                m_changeDetector.Process(frameData);
+                                m_scaler.Process(frameData);
+                                FrameTracer::Shared().Stamp(frameData.traceId, FrameStage::Processed);
+                                if (m_cursorTracker.IsRunning())
+                                {
+                                    m_cursorTracker.SetFrameGeometry(region.width, region.height, frameData.width, frameData.height);
+                                    frameData.cursor = m_cursorTracker.GetState();
+                                }
+                                m_mailbox.Publish(frameData);
+                                m_worker.Push(frameData, arrival);
+                                ++m_framesCaptured;
                                 
                                 // std::cout << "Extracted real pixels: " << frameData.width << "x" << frameData.height 
                                 //          << " stride:" << frameData.stride << " size:" << frameData.size << std::endl;
@@ -444,17 +676,23 @@ void WindowsGraphicsCapture::OnFrameArrived()
                 
                 // Fallback: send placeholder frame
                 FrameData frameData;
-                frameData.width = size.Width;
-                frameData.height = size.Height;
-                frameData.stride = size.Width * 4; // BGRA format
-                frameData.size = frameData.stride * size.Height;
-                frameData.timestamp = GetTickCount64();
+                frameData.width = region.width;
+                frameData.height = region.height;
+                frameData.stride = region.width * 4; // BGRA format
+                frameData.size = frameData.stride * region.height;
+                frameData.timestampNs = arrivalNs;
+                frameData.presentationTimeNs = arrivalNs;
                 
-                static std::vector<uint8_t> fallbackData;
-                fallbackData.resize(frameData.size, 64); // Dark gray fallback
-                frameData.data = fallbackData.data();
+                frameData.buffer = m_bufferPool->Acquire(frameData.size);
+                memset(frameData.buffer.Data(), 64, frameData.size); // Dark gray fallback
+                frameData.data = frameData.buffer.Data();
                 
-                m_frameCallback(frameData);
+                m_changeDetector.Process(frameData);
+                m_scaler.Process(frameData);
+                
+                m_mailbox.Publish(frameData);
+                m_worker.Push(frameData, arrival);
+                ++m_framesCaptured;
             }
         }
     }
@@ -478,6 +716,9 @@ void WindowsGraphicsCapture::StopCapture()
         m_framePool = nullptr;
     }
     
+    m_cursorTracker.Stop();
+    m_worker.Stop();
+    m_screenshots.CancelRequests();
     m_captureItem = nullptr;
     m_isCapturing = false;
     std::cout << "Capture stopped" << std::endl;
@@ -485,44 +726,91 @@ void WindowsGraphicsCapture::StopCapture()
 
 bool WindowsGraphicsCapture::SetCaptureConfig(const CaptureConfig& config)
 {
+    std::lock_guard lock(m_configMutex);
     if (m_isCapturing)
-        return false;
-        
+    {
+        if (!IsFrameRateChangeOnly(m_config, config))
+            return false;
+        m_config.targetFps = config.targetFps;
+        m_pacer.SetTargetFps(config.targetFps);
+        return true;
+    }
+
     m_config = config;
     return true;
 }
 
 CaptureConfig WindowsGraphicsCapture::GetCaptureConfig() const
 {
+    std::lock_guard lock(m_configMutex);
     return m_config;
 }
 
+bool WindowsGraphicsCapture::SetTargetFps(int fps)
+{
+    std::lock_guard lock(m_configMutex);
+    if (!m_initialized)
+        return false;
+
+    m_config.targetFps = fps;
+    m_pacer.SetTargetFps(fps);
+    return true;
+}
+
 bool WindowsGraphicsCapture::SetFrameCallback(const FrameCallback& callback)
 {
-    m_frameCallback = callback;
+    m_worker.SetCallback(callback);
+    return true;
+}
+
+bool WindowsGraphicsCapture::SetCursorCallback(const CursorCallback& callback)
+{
+    m_cursorTracker.SetCallback(callback);
     return true;
 }
 
 bool WindowsGraphicsCapture::GetLatestFrame(FrameData& outFrame) const
 {
-    // Placeholder - would return the most recent captured frame
-    outFrame = {};
-    return false;
+    return m_mailbox.Acquire(outFrame);
 }
 
 bool WindowsGraphicsCapture::SaveScreenshot(const std::string& sourceId, const std::string& filePath) const
 {
-    // Placeholder - would capture a single frame and save to file
-    return false;
+    if (!m_isCapturing)
+    {
+        std::cout << "Screenshots need a running capture" << std::endl;
+        return false;
+    }
+    if (!sourceId.empty() && sourceId != m_sourceId)
+    {
+        std::cout << "Screenshots are only available for the captured source (" << m_sourceId << ")" << std::endl;
+        return false;
+    }
+    return m_screenshots.Request(filePath);
 }
 
 CaptureStatistics WindowsGraphicsCapture::GetStatistics() const
 {
-    return m_statistics;
+    CaptureStatistics statistics;
+    statistics.framesCapture = m_framesCaptured;
+    m_worker.FillStatistics(statistics);
+    statistics.framesOverwritten = m_mailbox.GetOverwrittenCount();
+    statistics.framesDuplicate = m_changeDetector.GetDuplicateCount();
+    statistics.framesDecimated = m_pacer.GetDecimatedCount();
+    statistics.averageFps = m_pacer.GetAchievedFps();
+    statistics.frameJitterMs = m_pacer.GetJitterMs();
+
+    const ProcessUsage usage = ProcessMetrics::Sample();
+    statistics.cpuUsage = usage.cpuPercent;
+    statistics.memoryUsage = usage.residentBytes;
+    return statistics;
 }
 
 bool WindowsGraphicsCapture::IsCursorVisible() const
 {
+    if (m_config.cursorMode == CursorMode::Hidden)
+        return false;
+
     CURSORINFO ci = {};
     ci.cbSize = sizeof(CURSORINFO);
     if (GetCursorInfo(&ci))
@@ -1,6 +1,17 @@
 #pragma once
 
 #include "../IGraphicsCapture.h"
+#include "../CaptureScaler.h"
+#include "../CaptureWorker.h"
+#include "../CursorTracker.h"
+#include "../FrameChangeDetector.h"
+#include "../FrameMailbox.h"
+#include "../FramePacer.h"
+#include "../ProcessNameCache.h"
+#include "../ScreenshotWriter.h"
+
+#include <atomic>
+#include <mutex>
 #include <windows.h>
 #include <winrt/base.h>
 #include <winrt/Windows.Graphics.Capture.h>
@@ -26,12 +37,14 @@ public:
 
     bool SetCaptureConfig(const CaptureConfig& config) override;
     CaptureConfig GetCaptureConfig() const override;
+    bool SetTargetFps(int fps) override;
 
     bool StartCapture(const std::string& sourceId) override;
     void StopCapture() override;
     bool IsCapturing() const override { return m_isCapturing; }
 
     bool SetFrameCallback(const FrameCallback& callback) override;
+    bool SetCursorCallback(const CursorCallback& callback) override;
     bool GetLatestFrame(FrameData& outFrame) const override;
     bool SaveScreenshot(const std::string& sourceId, const std::string& filePath) const override;
 
@@ -42,10 +55,22 @@ public:
 
 private:
     bool m_initialized = false;
-    bool m_isCapturing = false;
+    std::atomic<bool> m_isCapturing = false;
     CaptureConfig m_config;
-    FrameCallback m_frameCallback;
-    CaptureStatistics m_statistics;
+    mutable std::mutex m_configMutex; // targetFps may change from another thread while capturing
+    FramePacer m_pacer;
+    FrameChangeDetector m_changeDetector;
+    CaptureScaler m_scaler;
+    CaptureWorker m_worker;
+    std::atomic<uint64_t> m_framesCaptured = 0;
+    std::shared_ptr<FrameBufferPool> m_bufferPool = FrameBufferPool::Create();
+    mutable FrameMailbox m_mailbox;
+    mutable ProcessNameCache m_processNames;
+    // Retains the latest frame: WGC delivers nothing while the screen is static
+    mutable ScreenshotWriter m_screenshots{ true };
+    std::string m_sourceId;
+    // CursorMode::Metadata only; WGC draws the cursor itself when embedded
+    CursorTracker m_cursorTracker;
     
     winrt::Windows::Graphics::Capture::GraphicsCaptureSession m_session{ nullptr };
     winrt::Windows::Graphics::Capture::GraphicsCaptureItem m_captureItem{ nullptr };
@@ -53,4 +78,5 @@ private:
     winrt::Windows::Graphics::DirectX::Direct3D11::IDirect3DDevice m_device{ nullptr };
 
     void OnFrameArrived();
+    void StartCursorTracker(HWND hwnd, HMONITOR monitor);
 };
\ No newline at end of file
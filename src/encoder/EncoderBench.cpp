@@ -0,0 +1,520 @@
+// Encoder throughput and latency at 1080p and 4K on synthetic desktop
+// content (text scrolling past a moving window), the kind of frames a
+// screen share produces.
+//
+//   encoder_bench [--codec h264|vp8|tile|all] [--frames N] [--threads N] [--nv12]
+//
+// Encode fps is pictures per second of encoder time alone; latency is the
+// time of each Encode() call. Colour conversion is timed separately. The
+// lossless tile codec takes BGRA directly and also reports its compression
+// ratio and throughput, after checking that every frame decodes exactly.
+// It then encodes the synthetic capture backend's StaticDesktop and
+// ScrollingText sources, with the dirty rects capture gives it, for the
+// bitrate of the mostly still screens it is meant for.
+// Each codec also runs as three-layer simulcast, paced at 30 fps, which
+// reports per-layer rates and how many frames every layer was too busy for.
+
+#include "IVideoEncoder.h"
+#include "SimulcastEncoder.h"
+#include "tile/TileCodec.h"
+#include "../capture/FrameBufferPool.h"
+#include "../capture/synthetic/SyntheticGraphicsCapture.h"
+#include "../video/ColorConversion.h"
+#include "../video/ThreadPool.h"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace
+{
+	struct Options
+	{
+		std::vector<VideoCodec> codecs = { VideoCodec::H264, VideoCodec::VP8 };
+		bool tile = true;
+		int frames = 300;
+		int threads = 0;
+		bool nv12 = false;
+	};
+
+	struct Resolution
+	{
+		const char* name;
+		int width;
+		int height;
+		int bitrateKbps;
+	};
+
+	constexpr Resolution kResolutions[] = {
+		{ "1080p", 1920, 1080, 2500 },
+		{ "4K", 3840, 2160, 8000 },
+	};
+
+	using Clock = std::chrono::steady_clock;
+
+	double ToMs(Clock::duration duration)
+	{
+		return std::chrono::duration<double, std::milli>(duration).count();
+	}
+
+	double Percentile(std::vector<double> values, double fraction)
+	{
+		if (values.empty())
+			return 0.0;
+		const size_t index = std::min(values.size() - 1, static_cast<size_t>(fraction * values.size()));
+		std::nth_element(values.begin(), values.begin() + index, values.end());
+		return values[index];
+	}
+
+	// Lines of "text" on a light background, twice the frame height so that
+	// a scrolling frame is a moving window into it
+	std::vector<uint8_t> RenderPage(int width, int height)
+	{
+		std::vector<uint8_t> page(static_cast<size_t>(width) * height * 4, 0xF0);
+		uint32_t seed = 12345;
+		for (int line = 8; line + 14 < height; line += 22)
+		{
+			int x = 24;
+			while (x < width - 24)
+			{
+				seed = seed * 1664525u + 1013904223u;
+				const int wordWidth = 12 + static_cast<int>(seed >> 27) * 6;
+				for (int y = line; y < line + 14; ++y)
+				{
+					uint8_t* row = page.data() + (static_cast<size_t>(y) * width + x) * 4;
+					for (int i = 0; i < std::min(wordWidth, width - 24 - x); ++i)
+					{
+						// Glyph-like speckle: dark strokes with gaps
+						const bool ink = ((i * 7 + y * 3 + static_cast<int>(seed)) % 5) < 3;
+						row[i * 4 + 0] = row[i * 4 + 1] = row[i * 4 + 2] = ink ? 0x20 : 0xF0;
+					}
+				}
+				x += wordWidth + 8;
+			}
+		}
+		return page;
+	}
+
+	void DrawWindow(uint8_t* pixels, int stride, int width, int height, int frame)
+	{
+		const int windowWidth = width / 4;
+		const int windowHeight = height / 4;
+		const int x = (frame * 7) % (width - windowWidth);
+		const int y = height / 2 + (frame * 3) % (height / 2 - windowHeight);
+		for (int row = 0; row < windowHeight; ++row)
+		{
+			uint8_t* out = pixels + static_cast<size_t>(y + row) * stride + static_cast<size_t>(x) * 4;
+			for (int i = 0; i < windowWidth; ++i)
+			{
+				out[i * 4 + 0] = static_cast<uint8_t>(0x80 + row);
+				out[i * 4 + 1] = static_cast<uint8_t>(0x40 + i);
+				out[i * 4 + 2] = 0x30;
+			}
+		}
+	}
+
+	// Scroll a few lines per frame and move the window
+	void RenderFrame(const std::vector<uint8_t>& page, uint8_t* frame, int width, int height, int index)
+	{
+		const int offset = (index * 6) % height;
+		const BgraView visible = BgraView(page.data(), width, height * 2).Crop(0, offset, width, height);
+		CopyImage(visible, MutableBgraView(frame, width, height));
+		DrawWindow(frame, width * 4, width, height, index);
+	}
+
+	bool RunBench(VideoCodec codec, const Resolution& resolution, const Options& options)
+	{
+		std::unique_ptr<IVideoEncoder> encoder = IVideoEncoder::Create(codec);
+		if (!encoder)
+		{
+			std::printf("%-5s %-5s  not built (library not found)\n", IVideoEncoder::GetCodecName(codec).data(),
+						resolution.name);
+			return false;
+		}
+
+		VideoEncoderConfig config;
+		config.codec = codec;
+		config.width = resolution.width;
+		config.height = resolution.height;
+		config.bitrateKbps = resolution.bitrateKbps;
+		config.fps = 30;
+		config.threads = options.threads;
+		if (!encoder->Initialize(config))
+			return false;
+		config = encoder->GetConfig();
+
+		const int width = resolution.width;
+		const int height = resolution.height;
+		const std::vector<uint8_t> page = RenderPage(width, height * 2);
+		std::vector<uint8_t> frame(static_cast<size_t>(width) * height * 4);
+		const YuvFormat format = options.nv12 ? YuvFormat::NV12 : YuvFormat::I420;
+		std::vector<uint8_t> yuv(ColorConverter::GetBufferSize(format, width, height));
+		const ColorConverter converter;
+
+		std::vector<double> encodeMs;
+		encodeMs.reserve(options.frames);
+		double convertMs = 0.0;
+		size_t bytes = 0;
+		int keyframes = 0;
+		int dropped = 0;
+		EncodedFrame encoded;
+		for (int i = 0; i < options.frames; ++i)
+		{
+			RenderFrame(page, frame.data(), width, height, i);
+
+			const auto convertStart = Clock::now();
+			converter.Convert(frame.data(), width * 4, width, height, format,
+							  ColorConverter::GetPlanes(format, yuv.data(), width, height));
+			convertMs += ToMs(Clock::now() - convertStart);
+
+			const uint64_t timestampNs = static_cast<uint64_t>(i) * 1'000'000'000ull / config.fps;
+			const auto encodeStart = Clock::now();
+			const bool ok =
+				options.nv12
+					? encoder->Encode(PlanarImageView<YuvFormat::NV12>::FromBuffer(yuv.data(), width, height),
+									  timestampNs, encoded)
+					: encoder->Encode(PlanarImageView<YuvFormat::I420>::FromBuffer(yuv.data(), width, height),
+									  timestampNs, encoded);
+			encodeMs.push_back(ToMs(Clock::now() - encodeStart));
+			if (!ok)
+			{
+				std::printf("%-5s %-5s  encode failed at frame %d\n", IVideoEncoder::GetCodecName(codec).data(),
+							resolution.name, i);
+				return false;
+			}
+
+			bytes += encoded.data.size();
+			keyframes += encoded.isKeyframe ? 1 : 0;
+			dropped += encoded.data.empty() ? 1 : 0;
+		}
+
+		double totalMs = 0.0;
+		for (double ms : encodeMs)
+			totalMs += ms;
+		const double seconds = static_cast<double>(options.frames) / config.fps;
+		std::printf("%-5s %-5s  %2d thread(s)  %7.1f fps  latency p50 %6.2f  p95 %6.2f  p99 %6.2f  max %6.2f ms  "
+					"%6.0f kbps (target %d)  %d key, %d dropped  convert %.2f ms\n",
+					IVideoEncoder::GetCodecName(codec).data(), resolution.name, config.threads,
+					options.frames / (totalMs / 1000.0), Percentile(encodeMs, 0.50), Percentile(encodeMs, 0.95),
+					Percentile(encodeMs, 0.99), *std::max_element(encodeMs.begin(), encodeMs.end()),
+					bytes * 8.0 / 1000.0 / seconds, config.bitrateKbps, keyframes, dropped,
+					convertMs / options.frames);
+		return true;
+	}
+
+	// The resolution as the top of three simulcast layers, fed in real time
+	// at 30 fps from pooled buffers as a capture backend would. The top
+	// layer's bitrate is halved halfway through; each layer's rate is
+	// reported for both halves. Every layer must end up with the same
+	// pictures, as Encode() hands a frame to all layers or to none.
+	bool RunSimulcastBench(VideoCodec codec, const Resolution& resolution, const Options& options, bool& inStep)
+	{
+		const std::string_view codecName = IVideoEncoder::GetCodecName(codec);
+		if (!IVideoEncoder::IsCodecAvailable(codec))
+		{
+			std::printf("%-5s %-5s  simulcast not built (library not found)\n", codecName.data(), resolution.name);
+			return false;
+		}
+
+		SimulcastConfig config;
+		config.codec = codec;
+		config.layers = { { 1, resolution.bitrateKbps },
+						  { 2, resolution.bitrateKbps * 8 / 25 },
+						  { 4, resolution.bitrateKbps / 10 } };
+		config.threadsPerLayer = options.threads;
+
+		const int width = resolution.width;
+		const int height = resolution.height;
+		SimulcastEncoder simulcast;
+		if (!simulcast.Start(config, width, height, nullptr))
+			return false;
+
+		const std::vector<uint8_t> page = RenderPage(width, height * 2);
+		const std::shared_ptr<FrameBufferPool> pool = FrameBufferPool::Create();
+		const auto frameInterval = std::chrono::nanoseconds(1'000'000'000 / config.fps);
+		const int layerCount = simulcast.GetLayerCount();
+		std::vector<SimulcastLayerStatistics> firstHalf(layerCount);
+		int accepted = 0;
+		const auto start = Clock::now();
+		for (int i = 0; i < options.frames; ++i)
+		{
+			if (i == options.frames / 2)
+			{
+				for (int layer = 0; layer < layerCount; ++layer)
+					firstHalf[layer] = simulcast.GetLayerStatistics(layer);
+				simulcast.SetLayerBitrate(0, config.layers[0].bitrateKbps / 2);
+			}
+
+			std::this_thread::sleep_until(start + i * frameInterval);
+			FrameData frame;
+			frame.buffer = pool->Acquire(static_cast<size_t>(width) * height * 4);
+			frame.data = frame.buffer.Data();
+			frame.size = frame.buffer.Size();
+			frame.width = width;
+			frame.height = height;
+			frame.stride = width * 4;
+			frame.timestampNs = static_cast<uint64_t>(std::chrono::nanoseconds(i * frameInterval).count());
+			RenderFrame(page, frame.buffer.Data(), width, height, i);
+			accepted += simulcast.Encode(frame) ? 1 : 0;
+		}
+
+		// Let the layers finish the last frame before reading their totals
+		const auto finished = [&]
+		{
+			for (int layer = 0; layer < layerCount; ++layer)
+			{
+				const SimulcastLayerStatistics statistics = simulcast.GetLayerStatistics(layer);
+				if (statistics.framesEncoded + statistics.framesDropped < static_cast<uint64_t>(accepted))
+					return false;
+			}
+			return true;
+		};
+		const auto deadline = Clock::now() + std::chrono::seconds(5);
+		while (Clock::now() < deadline && !finished())
+			std::this_thread::sleep_for(std::chrono::milliseconds(1));
+
+		bool aligned = true;
+		const double halfSeconds = options.frames / 2.0 / config.fps;
+		for (int layer = 0; layer < layerCount; ++layer)
+		{
+			const SimulcastLayerStatistics statistics = simulcast.GetLayerStatistics(layer);
+			aligned &= statistics.framesEncoded + statistics.framesDropped == static_cast<uint64_t>(accepted);
+			std::printf("%-5s %-5s  simulcast layer %d %4dx%-4d  %7.1f ms  %6.0f kbps (target %d), then %6.0f kbps "
+						"(target %d)  %llu key, %llu dropped\n",
+						codecName.data(), resolution.name, layer, statistics.width, statistics.height,
+						statistics.averageEncodeMs, firstHalf[layer].bytes * 8.0 / 1000.0 / halfSeconds,
+						config.layers[layer].bitrateKbps,
+						(statistics.bytes - firstHalf[layer].bytes) * 8.0 / 1000.0 / halfSeconds,
+						statistics.bitrateKbps, static_cast<unsigned long long>(statistics.keyframes),
+						static_cast<unsigned long long>(statistics.framesDropped));
+		}
+		simulcast.Stop();
+
+		std::printf("%-5s %-5s  simulcast %d/%d frames to every layer, %llu skipped with a layer busy%s\n",
+					codecName.data(), resolution.name, accepted, options.frames,
+					static_cast<unsigned long long>(options.frames - accepted),
+					aligned ? "" : ", LAYERS OUT OF STEP");
+		inStep &= aligned;
+		return true;
+	}
+
+	// Decoded tile frames are opaque, so only colour has to survive
+	bool SameColors(BgraView a, BgraView b)
+	{
+		for (int y = 0; y < a.height; ++y)
+		{
+			for (int x = 0; x < a.width; ++x)
+			{
+				if ((a.Row(y)[x] ^ b.Row(y)[x]) & 0x00FFFFFF)
+					return false;
+			}
+		}
+		return true;
+	}
+
+	bool RunTileBench(const Resolution& resolution, const Options& options)
+	{
+		const int width = resolution.width;
+		const int height = resolution.height;
+		const std::vector<uint8_t> page = RenderPage(width, height * 2);
+		std::vector<uint8_t> frame(static_cast<size_t>(width) * height * 4);
+		std::unique_ptr<ThreadPool> ownPool;
+		if (options.threads > 0)
+			ownPool = std::make_unique<ThreadPool>(options.threads - 1);
+		ThreadPool& pool = ownPool ? *ownPool : ThreadPool::Shared();
+
+		TileEncoder encoder;
+		TileDecoder decoder;
+		std::vector<uint8_t> encoded;
+		std::vector<double> encodeMs;
+		encodeMs.reserve(options.frames);
+		double decodeMs = 0.0;
+		for (int i = 0; i < options.frames; ++i)
+		{
+			RenderFrame(page, frame.data(), width, height, i);
+			const BgraView view(frame.data(), width, height);
+
+			const auto encodeStart = Clock::now();
+			encoder.Encode(view, nullptr, 0, encoded, &pool);
+			encodeMs.push_back(ToMs(Clock::now() - encodeStart));
+
+			const auto decodeStart = Clock::now();
+			const bool ok = decoder.Decode(encoded.data(), encoded.size(), &pool);
+			decodeMs += ToMs(Clock::now() - decodeStart);
+
+			if (!ok || !SameColors(decoder.GetFrame(), view))
+			{
+				std::printf("tile  %-5s  frame %d does not decode to its source\n", resolution.name, i);
+				return false;
+			}
+		}
+
+		const TileCodecStatistics stats = encoder.GetStatistics();
+		double totalMs = 0.0;
+		for (double ms : encodeMs)
+			totalMs += ms;
+		const double seconds = static_cast<double>(options.frames) / 30.0;
+		std::printf("tile  %-5s  %2d thread(s)  %7.1f fps  latency p50 %6.2f  p95 %6.2f  p99 %6.2f  max %6.2f ms  "
+					"%6.0f kbps at 30 fps  ratio %.1f:1  %.0f MB/s  decode %.2f ms\n",
+					resolution.name, pool.GetConcurrency(), options.frames / (totalMs / 1000.0),
+					Percentile(encodeMs, 0.50), Percentile(encodeMs, 0.95), Percentile(encodeMs, 0.99),
+					*std::max_element(encodeMs.begin(), encodeMs.end()), stats.outputBytes * 8.0 / 1000.0 / seconds,
+					stats.GetCompressionRatio(), stats.GetThroughputMBps(), decodeMs / options.frames);
+		std::printf("      tiles: %llu unchanged, %llu copied, %llu solid, %llu palette, %llu run-length, %llu raw\n",
+					static_cast<unsigned long long>(stats.tilesUnchanged),
+					static_cast<unsigned long long>(stats.tilesCopied), static_cast<unsigned long long>(stats.tilesSolid),
+					static_cast<unsigned long long>(stats.tilesPalette),
+					static_cast<unsigned long long>(stats.tilesRunLength), static_cast<unsigned long long>(stats.tilesRaw));
+		return true;
+	}
+
+	// Frames come from the synthetic backend unpaced, with a blocking queue
+	// so none is dropped: content depends only on the frame index, so the
+	// run matches what a 30 fps capture of the same source would deliver
+	bool RunTileContentBench(const Resolution& resolution, SyntheticContent content, const char* name,
+							 const Options& options)
+	{
+		SyntheticCaptureConfig syntheticConfig;
+		syntheticConfig.width = resolution.width;
+		syntheticConfig.height = resolution.height;
+		syntheticConfig.fps = 1000;
+		SyntheticGraphicsCapture capture(syntheticConfig);
+		if (!capture.Initialize())
+			return false;
+
+		CaptureConfig config = capture.GetCaptureConfig();
+		config.targetFps = 0;
+		config.outputWidth = resolution.width;
+		config.outputHeight = resolution.height;
+		config.cursorMode = CursorMode::Hidden;
+		config.dropPolicy = FrameDropPolicy::Block;
+		capture.SetCaptureConfig(config);
+
+		std::unique_ptr<ThreadPool> ownPool;
+		if (options.threads > 0)
+			ownPool = std::make_unique<ThreadPool>(options.threads - 1);
+		ThreadPool& pool = ownPool ? *ownPool : ThreadPool::Shared();
+
+		TileEncoder encoder;
+		TileDecoder decoder;
+		std::vector<uint8_t> encoded;
+		std::vector<double> encodeMs;
+		encodeMs.reserve(options.frames);
+		std::atomic<int> framesDone = 0;
+		std::atomic<bool> failed = false;
+		capture.SetFrameCallback([&](const FrameData& frame) {
+			if (framesDone >= options.frames || failed)
+				return;
+
+			// A duplicate has no rects, which would mean "anything changed";
+			// one empty rect says nothing did, and the frame is still sent
+			const FrameRect nothing = {};
+			const BgraView view = frame.GetView();
+			const auto encodeStart = Clock::now();
+			if (frame.isDuplicate)
+				encoder.Encode(view, &nothing, 1, encoded, &pool);
+			else
+				encoder.Encode(view, frame.dirtyRects, frame.dirtyRectCount, encoded, &pool);
+			encodeMs.push_back(ToMs(Clock::now() - encodeStart));
+			if (!decoder.Decode(encoded.data(), encoded.size(), &pool) || !SameColors(decoder.GetFrame(), view))
+			{
+				std::printf("tile  %-5s  %s frame %d does not decode to its source\n", resolution.name, name,
+							framesDone.load());
+				failed = true;
+			}
+			++framesDone;
+		});
+
+		if (!capture.StartCapture(SyntheticGraphicsCapture::GetSourceId(content)))
+			return false;
+		while (framesDone < options.frames && !failed)
+			std::this_thread::sleep_for(std::chrono::milliseconds(10));
+		capture.StopCapture();
+		capture.Shutdown();
+		if (failed)
+			return false;
+
+		const TileCodecStatistics stats = encoder.GetStatistics();
+		const double seconds = static_cast<double>(options.frames) / 30.0;
+		std::printf("tile  %-5s  %-14s  %6.0f kbps at 30 fps  latency p50 %6.2f  p95 %6.2f  max %6.2f ms  "
+					"tiles: %llu unchanged, %llu copied, %llu sent\n",
+					resolution.name, name, stats.outputBytes * 8.0 / 1000.0 / seconds, Percentile(encodeMs, 0.50),
+					Percentile(encodeMs, 0.95), *std::max_element(encodeMs.begin(), encodeMs.end()),
+					static_cast<unsigned long long>(stats.tilesUnchanged),
+					static_cast<unsigned long long>(stats.tilesCopied),
+					static_cast<unsigned long long>(stats.tilesSolid + stats.tilesPalette + stats.tilesRunLength +
+													stats.tilesRaw));
+		return true;
+	}
+}
+
+int main(int argc, char** argv)
+{
+	Options options;
+	for (int i = 1; i < argc; ++i)
+	{
+		const std::string arg = argv[i];
+		const bool hasValue = i + 1 < argc;
+		if (arg == "--codec" && hasValue)
+		{
+			const std::string codec = argv[++i];
+			options.tile = codec == "tile" || codec == "all";
+			if (codec == "h264")
+				options.codecs = { VideoCodec::H264 };
+			else if (codec == "vp8")
+				options.codecs = { VideoCodec::VP8 };
+			else if (codec == "tile")
+				options.codecs.clear();
+			else if (codec != "all")
+			{
+				std::fprintf(stderr, "Unknown codec: %s\n", codec.c_str());
+				return 1;
+			}
+		}
+		else if (arg == "--frames" && hasValue)
+		{
+			options.frames = std::max(std::atoi(argv[++i]), 1);
+		}
+		else if (arg == "--threads" && hasValue)
+		{
+			options.threads = std::max(std::atoi(argv[++i]), 0);
+		}
+		else if (arg == "--nv12")
+		{
+			options.nv12 = true;
+		}
+		else
+		{
+			std::fprintf(stderr, "Usage: %s [--codec h264|vp8|tile|all] [--frames N] [--threads N] [--nv12]\n",
+						 argv[0]);
+			return 1;
+		}
+	}
+
+	bool anyRan = false;
+	bool inStep = true;
+	for (VideoCodec codec : options.codecs)
+	{
+		for (const Resolution& resolution : kResolutions)
+			anyRan |= RunBench(codec, resolution, options);
+		for (const Resolution& resolution : kResolutions)
+			anyRan |= RunSimulcastBench(codec, resolution, options, inStep);
+	}
+	if (options.tile)
+	{
+		for (const Resolution& resolution : kResolutions)
+			anyRan |= RunTileBench(resolution, options);
+		for (const Resolution& resolution : kResolutions)
+		{
+			anyRan |= RunTileContentBench(resolution, SyntheticContent::StaticDesktop, "static desktop", options);
+			anyRan |= RunTileContentBench(resolution, SyntheticContent::ScrollingText, "scrolling text", options);
+		}
+	}
+	return anyRan && inStep ? 0 : 1;
+}
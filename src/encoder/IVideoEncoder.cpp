@@ -0,0 +1,73 @@
+#include "IVideoEncoder.h"
+
+#include <algorithm>
+#include <thread>
+
+#ifdef VIDEO_ENCODER_OPENH264
+#include "openh264/OpenH264Encoder.h"
+#endif
+
+#ifdef VIDEO_ENCODER_VPX
+#include "vpx/VpxEncoder.h"
+#endif
+
+std::unique_ptr<IVideoEncoder> IVideoEncoder::Create(VideoCodec codec)
+{
+	switch (codec)
+	{
+	case VideoCodec::H264:
+#ifdef VIDEO_ENCODER_OPENH264
+		return std::make_unique<OpenH264Encoder>();
+#else
+		return nullptr;
+#endif
+	case VideoCodec::VP8:
+#ifdef VIDEO_ENCODER_VPX
+		return std::make_unique<VpxEncoder>();
+#else
+		return nullptr;
+#endif
+	}
+	return nullptr;
+}
+
+bool IVideoEncoder::IsCodecAvailable(VideoCodec codec)
+{
+	switch (codec)
+	{
+	case VideoCodec::H264:
+#ifdef VIDEO_ENCODER_OPENH264
+		return true;
+#else
+		return false;
+#endif
+	case VideoCodec::VP8:
+#ifdef VIDEO_ENCODER_VPX
+		return true;
+#else
+		return false;
+#endif
+	}
+	return false;
+}
+
+std::string_view IVideoEncoder::GetCodecName(VideoCodec codec) noexcept
+{
+	switch (codec)
+	{
+	case VideoCodec::H264:
+		return "H.264";
+	case VideoCodec::VP8:
+		return "VP8";
+	}
+	return "Unknown";
+}
+
+int IVideoEncoder::GetDefaultThreadCount(int width, int height)
+{
+	// About one thread per half megapixel: 2 at 720p, 4 at 1080p, 8 at 4K.
+	// More slices than that cost compression for little extra speed.
+	const int byArea = static_cast<int>((static_cast<int64_t>(width) * height + (1 << 18)) >> 19);
+	const int cores = static_cast<int>(std::max(std::thread::hardware_concurrency(), 1u));
+	return std::clamp(byArea, 1, std::min(cores, 8));
+}
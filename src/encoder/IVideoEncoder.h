@@ -0,0 +1,77 @@
+#pragma once
+
+#include "../video/ImageView.h"
+
+#include <cstdint>
+#include <memory>
+#include <string_view>
+#include <vector>
+
+enum class VideoCodec
+{
+	H264, // Constrained Baseline through OpenH264; what every WebRTC peer decodes
+	VP8	  // libvpx, the other mandatory WebRTC codec
+};
+
+struct VideoEncoderConfig
+{
+	VideoCodec codec = VideoCodec::H264;
+	int width = 0; // Of the pictures passed to Encode(); fixed for the session
+	int height = 0;
+	int bitrateKbps = 2500; // Target average rate
+	int fps = 30;			// Expected picture rate, for rate control
+	int keyframeInterval = 0; // Pictures between keyframes; 0 for keyframes only on request
+	// Encoder threads. Pictures are split into that many slices (H.264) or
+	// token partitions and row bands (VP8); 0 picks by resolution and cores.
+	int threads = 0;
+	// Tune for desktop content: sharp text, large static areas, abrupt changes
+	bool screenContent = true;
+};
+
+// One encoded picture (an access unit): Annex B NAL units for H.264, a raw
+// VP8 frame for VP8. Reuse the object across Encode() calls so `data`
+// keeps its capacity.
+struct EncodedFrame
+{
+	std::vector<uint8_t> data; // Empty when rate control dropped the picture
+	uint64_t timestampNs = 0;  // As passed to Encode()
+	int width = 0;
+	int height = 0;
+	bool isKeyframe = false;
+	int qp = -1; // Average quantizer when the codec reports one
+};
+
+// Software video encoder. Encode() and everything else except the rate and
+// keyframe requests belong to one thread (the encode thread); SetRates() and
+// RequestKeyframe() may be called from any thread and take effect with the
+// next picture, so a network thread can steer a running encoder.
+class IVideoEncoder
+{
+public:
+	using I420View = PlanarImageView<YuvFormat::I420>;
+	using Nv12View = PlanarImageView<YuvFormat::NV12>;
+
+	virtual ~IVideoEncoder() = default;
+
+	virtual bool Initialize(const VideoEncoderConfig& config) = 0;
+	virtual void Shutdown() = 0;
+	virtual bool IsInitialized() const = 0;
+
+	// Pictures must match the configured size. Returns false on an encoder
+	// error; a picture dropped by rate control returns true with empty data.
+	virtual bool Encode(const I420View& picture, uint64_t timestampNs, EncodedFrame& outFrame) = 0;
+	virtual bool Encode(const Nv12View& picture, uint64_t timestampNs, EncodedFrame& outFrame) = 0;
+
+	virtual void SetRates(int bitrateKbps, int fps) = 0;
+	virtual void RequestKeyframe() = 0;
+
+	virtual VideoEncoderConfig GetConfig() const = 0;
+	virtual std::string_view GetName() const noexcept = 0;
+
+	// nullptr when the codec's library was not found at build time
+	static std::unique_ptr<IVideoEncoder> Create(VideoCodec codec);
+	static bool IsCodecAvailable(VideoCodec codec);
+	static std::string_view GetCodecName(VideoCodec codec) noexcept;
+	// Encoder threads for `config.threads == 0`
+	static int GetDefaultThreadCount(int width, int height);
+};
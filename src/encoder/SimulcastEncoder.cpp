@@ -0,0 +1,278 @@
+#include "SimulcastEncoder.h"
+#include "../platform/Logger.h"
+
+#include <algorithm>
+#include <chrono>
+#include <format>
+
+SimulcastEncoder::SimulcastEncoder() = default;
+
+SimulcastEncoder::~SimulcastEncoder()
+{
+	Stop();
+}
+
+bool SimulcastEncoder::Start(const SimulcastConfig& config, int width, int height, const Callback& callback)
+{
+	Stop();
+
+	if (config.layers.empty() || static_cast<int>(config.layers.size()) > kMaxLayers || width <= 0 || height <= 0)
+	{
+		Logger::Error(std::format("Invalid simulcast setup: {} layer(s) for {}x{}", config.layers.size(), width, height));
+		return false;
+	}
+
+	m_config = config;
+	m_width = width;
+	m_height = height;
+	m_callback = callback;
+
+	std::vector<std::unique_ptr<Layer>> layers;
+	for (size_t i = 0; i < config.layers.size(); ++i)
+	{
+		const SimulcastLayerConfig& layerConfig = config.layers[i];
+		auto layer = std::make_unique<Layer>();
+		layer->index = static_cast<int>(i);
+
+		// Encoders want even sizes; FitWithin() rounds down to them
+		const int divisor = std::max(layerConfig.scaleDivisor, 1);
+		FrameScaler::FitWithin(width, height, width / divisor, height / divisor, layer->width, layer->height);
+		if (layer->width < 16 || layer->height < 16)
+		{
+			Logger::Error(std::format("Simulcast layer {} would be {}x{}, too small to encode", i, layer->width,
+									  layer->height));
+			return false;
+		}
+		if (layer->width != width || layer->height != height)
+		{
+			layer->scaler.Configure(width, height, layer->width, layer->height, config.filter);
+			layer->scaled.resize(static_cast<size_t>(layer->width) * layer->height * 4);
+		}
+		layer->yuv.resize(ColorConverter::GetBufferSize(YuvFormat::I420, layer->width, layer->height));
+		layer->output.data.reserve(layer->yuv.size());
+
+		VideoEncoderConfig encoderConfig;
+		encoderConfig.codec = config.codec;
+		encoderConfig.width = layer->width;
+		encoderConfig.height = layer->height;
+		encoderConfig.bitrateKbps = layerConfig.bitrateKbps;
+		encoderConfig.fps = config.fps;
+		encoderConfig.keyframeInterval = config.keyframeInterval;
+		encoderConfig.threads = config.threadsPerLayer;
+		layer->encoder = IVideoEncoder::Create(config.codec);
+		if (!layer->encoder || !layer->encoder->Initialize(encoderConfig))
+		{
+			Logger::Error(std::format("Failed to create the {} encoder for simulcast layer {} ({}x{})",
+									  IVideoEncoder::GetCodecName(config.codec), i, layer->width, layer->height));
+			return false;
+		}
+		layer->bitrateKbps = layerConfig.bitrateKbps;
+		layers.push_back(std::move(layer));
+	}
+
+	std::lock_guard layersLock(m_layersMutex);
+	m_layers = std::move(layers);
+	{
+		std::lock_guard lock(m_mutex);
+		m_running = true;
+		m_busyLayers = 0;
+		m_generation = 0;
+	}
+	m_skipped = 0;
+	for (auto& layer : m_layers)
+		layer->thread = std::thread(&SimulcastEncoder::LayerThread, this, std::ref(*layer));
+
+	std::string summary;
+	for (const auto& layer : m_layers)
+		summary += std::format("{}{}x{} @ {} kbps", summary.empty() ? "" : ", ", layer->width, layer->height,
+							   layer->bitrateKbps.load());
+	Logger::Info(std::format("Simulcast {}: {}", IVideoEncoder::GetCodecName(config.codec), summary));
+	return true;
+}
+
+void SimulcastEncoder::Stop()
+{
+	{
+		std::lock_guard lock(m_mutex);
+		m_running = false;
+	}
+	m_wake.notify_all();
+
+	std::vector<std::unique_ptr<Layer>> layers;
+	{
+		std::lock_guard lock(m_layersMutex);
+		layers.swap(m_layers);
+	}
+	for (auto& layer : layers)
+	{
+		if (layer->thread.joinable())
+			layer->thread.join();
+		layer->encoder->Shutdown();
+	}
+
+	std::lock_guard lock(m_mutex);
+	m_frame = {};
+	m_busyLayers = 0;
+}
+
+bool SimulcastEncoder::Encode(const FrameData& frame)
+{
+	if (frame.width != m_width || frame.height != m_height || !frame.data)
+		return false;
+	if (frame.isDuplicate)
+		return false; // Every layer already holds these pixels
+
+	{
+		std::lock_guard lock(m_mutex);
+		if (!m_running)
+			return false;
+		if (m_busyLayers > 0)
+		{
+			m_skipped.fetch_add(1, std::memory_order_relaxed);
+			return false;
+		}
+
+		m_frame = frame;
+		m_frame.dirtyRects = nullptr; // Only valid during the caller's callback
+		m_frame.dirtyRectCount = 0;
+		if (!frame.buffer)
+		{
+			// No pooled buffer to hold on to; the layers are idle, so the
+			// copy can be reused
+			const BgraView source = frame.GetView();
+			m_copy.resize(static_cast<size_t>(source.width) * source.height * 4);
+			CopyImage(source, MutableBgraView(m_copy.data(), source.width, source.height));
+			m_frame.data = m_copy.data();
+			m_frame.stride = source.width * 4;
+		}
+
+		++m_generation;
+		m_busyLayers = static_cast<int>(m_layers.size());
+	}
+	m_wake.notify_all();
+	return true;
+}
+
+bool SimulcastEncoder::IsRunning() const
+{
+	std::lock_guard lock(m_layersMutex);
+	return !m_layers.empty();
+}
+
+int SimulcastEncoder::GetLayerCount() const
+{
+	std::lock_guard lock(m_layersMutex);
+	return static_cast<int>(m_layers.size());
+}
+
+void SimulcastEncoder::SetLayerBitrate(int layer, int bitrateKbps)
+{
+	std::lock_guard lock(m_layersMutex);
+	if (layer < 0 || layer >= static_cast<int>(m_layers.size()))
+		return;
+	bitrateKbps = std::max(bitrateKbps, 1);
+	m_layers[layer]->bitrateKbps = bitrateKbps;
+	m_layers[layer]->encoder->SetRates(bitrateKbps, m_config.fps);
+}
+
+void SimulcastEncoder::SetLayerActive(int layer, bool active)
+{
+	std::lock_guard lock(m_layersMutex);
+	if (layer < 0 || layer >= static_cast<int>(m_layers.size()))
+		return;
+	// Its encoder has not seen the frames in between
+	if (active && !m_layers[layer]->active.exchange(true))
+		m_layers[layer]->encoder->RequestKeyframe();
+	else if (!active)
+		m_layers[layer]->active = false;
+}
+
+void SimulcastEncoder::RequestKeyframe(int layer)
+{
+	std::lock_guard lock(m_layersMutex);
+	for (const auto& entry : m_layers)
+	{
+		if (layer < 0 || entry->index == layer)
+			entry->encoder->RequestKeyframe();
+	}
+}
+
+SimulcastLayerStatistics SimulcastEncoder::GetLayerStatistics(int layer) const
+{
+	SimulcastLayerStatistics statistics;
+	std::lock_guard lock(m_layersMutex);
+	if (layer < 0 || layer >= static_cast<int>(m_layers.size()))
+		return statistics;
+
+	const Layer& entry = *m_layers[layer];
+	statistics.width = entry.width;
+	statistics.height = entry.height;
+	statistics.bitrateKbps = entry.bitrateKbps;
+	statistics.active = entry.active;
+	statistics.framesEncoded = entry.framesEncoded;
+	statistics.framesDropped = entry.framesDropped;
+	statistics.keyframes = entry.keyframes;
+	statistics.bytes = entry.bytes;
+	const uint64_t pictures = statistics.framesEncoded + statistics.framesDropped;
+	statistics.averageEncodeMs = pictures ? entry.encodeTimeUs / 1000.0 / pictures : 0.0;
+	return statistics;
+}
+
+void SimulcastEncoder::LayerThread(Layer& layer)
+{
+	uint64_t seen = 0;
+	while (true)
+	{
+		{
+			std::unique_lock lock(m_mutex);
+			m_wake.wait(lock, [this, seen] { return m_generation != seen || !m_running; });
+			if (!m_running)
+				break;
+			seen = m_generation;
+		}
+
+		// m_frame stays put until every layer has reported back below
+		if (layer.active)
+			EncodeLayer(layer, m_frame);
+
+		std::lock_guard lock(m_mutex);
+		if (--m_busyLayers == 0)
+			m_frame = {}; // Hand the buffer back to its pool now
+	}
+}
+
+void SimulcastEncoder::EncodeLayer(Layer& layer, const FrameData& frame)
+{
+	const auto start = std::chrono::steady_clock::now();
+
+	BgraView source = frame.GetView();
+	if (layer.scaler.IsConfigured())
+	{
+		const MutableBgraView scaled(layer.scaled.data(), layer.width, layer.height);
+		layer.scaler.Scale(source, scaled);
+		source = scaled;
+	}
+	const auto picture = MutablePlanarImageView<YuvFormat::I420>::FromBuffer(layer.yuv.data(), layer.width, layer.height);
+	m_converter.Convert(source, picture);
+
+	if (!layer.encoder->Encode(IVideoEncoder::I420View(picture), frame.timestampNs, layer.output))
+	{
+		Logger::Warning(std::format("Simulcast layer {} failed to encode a picture", layer.index));
+		return;
+	}
+
+	const auto elapsed = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - start);
+	layer.encodeTimeUs.fetch_add(static_cast<uint64_t>(elapsed.count()), std::memory_order_relaxed);
+	if (layer.output.data.empty())
+		layer.framesDropped.fetch_add(1, std::memory_order_relaxed);
+	else
+	{
+		layer.framesEncoded.fetch_add(1, std::memory_order_relaxed);
+		layer.bytes.fetch_add(layer.output.data.size(), std::memory_order_relaxed);
+		if (layer.output.isKeyframe)
+			layer.keyframes.fetch_add(1, std::memory_order_relaxed);
+	}
+
+	if (m_callback)
+		m_callback(layer.index, layer.output);
+}
@@ -0,0 +1,149 @@
+#pragma once
+
+#include "IVideoEncoder.h"
+#include "../capture/IGraphicsCapture.h"
+#include "../video/ColorConversion.h"
+#include "../video/FrameScaler.h"
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+struct SimulcastLayerConfig
+{
+	int scaleDivisor = 1; // 1 = source size, 2 = half, 4 = quarter, ...
+	int bitrateKbps = 2500;
+};
+
+struct SimulcastConfig
+{
+	VideoCodec codec = VideoCodec::H264;
+	// Highest resolution first, as a forwarder lists them
+	std::vector<SimulcastLayerConfig> layers = { { 1, 2500 }, { 2, 800 }, { 4, 250 } };
+	int fps = 30;
+	int keyframeInterval = 0; // As in VideoEncoderConfig; the same for every layer
+	int threadsPerLayer = 0;  // 0 picks by layer size
+	ScaleFilter filter = ScaleFilter::Box; // Falls back to Bilinear for divisors other than 2 and 4
+};
+
+struct SimulcastLayerStatistics
+{
+	int width = 0;
+	int height = 0;
+	int bitrateKbps = 0;
+	bool active = false;
+	uint64_t framesEncoded = 0;
+	uint64_t framesDropped = 0; // By the encoder's rate control
+	uint64_t keyframes = 0;
+	uint64_t bytes = 0;
+	double averageEncodeMs = 0.0; // Scale, convert and encode
+};
+
+// Encodes one captured stream as several independent layers of decreasing
+// resolution, each on its own thread with its own encoder and bitrate.
+//
+// Every layer encodes the same pictures with the same timestamps, so a
+// forwarder can switch a viewer from one layer to another at any keyframe
+// without a gap or a jump in time. To keep that true, a frame is either
+// handed to all layers or to none: Encode() drops the frame when any layer
+// is still busy with the previous one, rather than letting the slow layer
+// fall behind. Layers read the captured pixels in place (the FrameData keeps
+// its pooled buffer alive; frames without one are copied once) and scale
+// and convert into buffers allocated at Start(), so steady-state encoding
+// makes no copies of the source and no allocations.
+//
+// Start(), Stop() and Encode() belong to one thread (the capture thread).
+// The per-layer controls and statistics may be called from any thread,
+// including a layer's callback, at any time; outside a running session they
+// do nothing.
+class SimulcastEncoder
+{
+public:
+	// Called on the layer's thread, once per encoded picture; `frame.data` is
+	// empty when the encoder's rate control dropped the picture
+	using Callback = std::function<void(int layer, const EncodedFrame& frame)>;
+
+	static constexpr int kMaxLayers = 4;
+
+	SimulcastEncoder();
+	~SimulcastEncoder();
+
+	SimulcastEncoder(const SimulcastEncoder&) = delete;
+	SimulcastEncoder& operator=(const SimulcastEncoder&) = delete;
+
+	// Creates one encoder per layer for sources of `width` x `height`
+	bool Start(const SimulcastConfig& config, int width, int height, const Callback& callback);
+	void Stop();
+	bool IsRunning() const;
+
+	// Called on the capture thread; never blocks. The frame must have the size
+	// given to Start(). Returns false if the frame was not encoded (layers
+	// still busy, or a duplicate of the previous frame).
+	bool Encode(const FrameData& frame);
+
+	// Any thread; take effect with the next picture
+	void SetLayerBitrate(int layer, int bitrateKbps);
+	// Pauses a layer nobody is receiving. A resumed layer starts with a keyframe.
+	void SetLayerActive(int layer, bool active);
+	// -1 for every layer, which keeps their keyframes aligned
+	void RequestKeyframe(int layer = -1);
+
+	int GetLayerCount() const;
+	SimulcastLayerStatistics GetLayerStatistics(int layer) const;
+	// Frames Encode() turned away because a layer was still busy
+	uint64_t GetSkippedCount() const { return m_skipped.load(std::memory_order_relaxed); }
+
+private:
+	struct Layer
+	{
+		int index = 0;
+		int width = 0;
+		int height = 0;
+		std::unique_ptr<IVideoEncoder> encoder;
+		FrameScaler scaler; // Unconfigured for a layer at source size
+		std::vector<uint8_t> scaled;
+		std::vector<uint8_t> yuv;
+		EncodedFrame output;
+		std::thread thread;
+
+		std::atomic<bool> active = true;
+		std::atomic<int> bitrateKbps = 0;
+		std::atomic<uint64_t> framesEncoded = 0;
+		std::atomic<uint64_t> framesDropped = 0;
+		std::atomic<uint64_t> keyframes = 0;
+		std::atomic<uint64_t> bytes = 0;
+		std::atomic<uint64_t> encodeTimeUs = 0;
+	};
+
+	void LayerThread(Layer& layer);
+	void EncodeLayer(Layer& layer, const FrameData& frame);
+
+	SimulcastConfig m_config;
+	int m_width = 0;
+	int m_height = 0;
+	Callback m_callback;
+	ColorConverter m_converter;
+
+	// Start() and Stop() replace the layers while the per-layer controls run
+	// on other threads. Never held while waiting for a layer thread, so
+	// callbacks may use the controls. Encode() reads the layer count under
+	// m_mutex instead: the layers are published before m_running is set and
+	// taken away after it is cleared.
+	mutable std::mutex m_layersMutex;
+	std::vector<std::unique_ptr<Layer>> m_layers;
+
+	std::mutex m_mutex;
+	std::condition_variable m_wake;
+	FrameData m_frame;			// Shared by all layers until they are done with it
+	std::vector<uint8_t> m_copy; // Pixels of frames that come without a pooled buffer
+	uint64_t m_generation = 0; // Bumped per frame handed out
+	int m_busyLayers = 0;
+	bool m_running = false;
+
+	std::atomic<uint64_t> m_skipped = 0;
+};
@@ -0,0 +1,226 @@
+#include "OpenH264Encoder.h"
+#include "../../platform/Logger.h"
+
+#include <wels/codec_api.h>
+
+#include <algorithm>
+#include <format>
+
+OpenH264Encoder::~OpenH264Encoder()
+{
+	Shutdown();
+}
+
+bool OpenH264Encoder::Initialize(const VideoEncoderConfig& config)
+{
+	Shutdown();
+
+	if (config.width <= 0 || config.height <= 0 || (config.width & 1) || (config.height & 1))
+	{
+		Logger::Error(std::format("OpenH264 needs an even picture size, got {}x{}", config.width, config.height));
+		return false;
+	}
+
+	if (WelsCreateSVCEncoder(&m_encoder) != 0 || !m_encoder)
+	{
+		Logger::Error("Failed to create the OpenH264 encoder");
+		m_encoder = nullptr;
+		return false;
+	}
+
+	m_config = config;
+	m_config.fps = std::max(config.fps, 1);
+	m_config.bitrateKbps = std::max(config.bitrateKbps, 1);
+	if (m_config.threads <= 0)
+		m_config.threads = GetDefaultThreadCount(config.width, config.height);
+
+	SEncParamExt params;
+	m_encoder->GetDefaultParams(&params);
+	params.iUsageType = m_config.screenContent ? SCREEN_CONTENT_REAL_TIME : CAMERA_VIDEO_REAL_TIME;
+	params.iPicWidth = m_config.width;
+	params.iPicHeight = m_config.height;
+	params.iTargetBitrate = m_config.bitrateKbps * 1000;
+	params.iMaxBitrate = UNSPECIFIED_BIT_RATE;
+	params.iRCMode = RC_BITRATE_MODE;
+	params.fMaxFrameRate = static_cast<float>(m_config.fps);
+	params.bEnableFrameSkip = true; // Drop pictures rather than overshoot the rate
+	params.uiIntraPeriod = static_cast<unsigned int>(std::max(m_config.keyframeInterval, 0));
+	params.eSpsPpsIdStrategy = CONSTANT_ID;
+	params.bPrefixNalAddingCtrl = false;
+	params.bEnableDenoise = false;
+	params.bEnableBackgroundDetection = true;
+	params.bEnableAdaptiveQuant = true;
+	params.bEnableLongTermReference = false;
+	params.iEntropyCodingModeFlag = 0; // CAVLC: Constrained Baseline
+	params.iComplexityMode = LOW_COMPLEXITY;
+	params.iTemporalLayerNum = 1;
+	params.iSpatialLayerNum = 1;
+	params.iMultipleThreadIdc = static_cast<unsigned short>(m_config.threads);
+
+	SSpatialLayerConfig& layer = params.sSpatialLayers[0];
+	layer.iVideoWidth = m_config.width;
+	layer.iVideoHeight = m_config.height;
+	layer.fFrameRate = params.fMaxFrameRate;
+	layer.iSpatialBitrate = params.iTargetBitrate;
+	layer.iMaxSpatialBitrate = params.iMaxBitrate;
+	layer.uiProfileIdc = PRO_BASELINE;
+	// One slice per thread: slices are what OpenH264 encodes in parallel
+	layer.sSliceArgument.uiSliceMode = m_config.threads > 1 ? SM_FIXEDSLCNUM_SLICE : SM_SINGLE_SLICE;
+	layer.sSliceArgument.uiSliceNum = static_cast<unsigned int>(m_config.threads);
+
+	if (m_encoder->InitializeExt(&params) != cmResultSuccess)
+	{
+		Logger::Error(std::format("Failed to initialize OpenH264 for {}x{}", m_config.width, m_config.height));
+		WelsDestroySVCEncoder(m_encoder);
+		m_encoder = nullptr;
+		return false;
+	}
+
+	int videoFormat = videoFormatI420;
+	m_encoder->SetOption(ENCODER_OPTION_DATAFORMAT, &videoFormat);
+
+	{
+		std::lock_guard lock(m_pendingMutex);
+		m_ratesPending = false;
+	}
+	m_keyframeRequested = false;
+
+	Logger::Info(std::format("OpenH264 encoder: {}x{} @ {} fps, {} kbps, {} thread(s)", m_config.width,
+							 m_config.height, m_config.fps, m_config.bitrateKbps, m_config.threads));
+	return true;
+}
+
+void OpenH264Encoder::Shutdown()
+{
+	if (!m_encoder)
+		return;
+
+	m_encoder->Uninitialize();
+	WelsDestroySVCEncoder(m_encoder);
+	m_encoder = nullptr;
+}
+
+bool OpenH264Encoder::Encode(const I420View& picture, uint64_t timestampNs, EncodedFrame& outFrame)
+{
+	outFrame.data.clear();
+	outFrame.timestampNs = timestampNs;
+	outFrame.width = picture.Width();
+	outFrame.height = picture.Height();
+	outFrame.isKeyframe = false;
+	outFrame.qp = -1;
+
+	if (!m_encoder || picture.Width() != m_config.width || picture.Height() != m_config.height)
+		return false;
+
+	ApplyPendingRates();
+	if (m_keyframeRequested.exchange(false))
+		m_encoder->ForceIntraFrame(true);
+
+	SSourcePicture source = {};
+	source.iColorFormat = videoFormatI420;
+	source.iPicWidth = picture.Width();
+	source.iPicHeight = picture.Height();
+	source.iStride[0] = picture.y.stride;
+	source.iStride[1] = picture.u.stride;
+	source.iStride[2] = picture.v.stride;
+	source.pData[0] = const_cast<unsigned char*>(picture.y.data);
+	source.pData[1] = const_cast<unsigned char*>(picture.u.data);
+	source.pData[2] = const_cast<unsigned char*>(picture.v.data);
+	source.uiTimeStamp = static_cast<long long>(timestampNs / 1'000'000);
+
+	SFrameBSInfo info = {};
+	if (m_encoder->EncodeFrame(&source, &info) != cmResultSuccess)
+	{
+		Logger::Error("OpenH264 failed to encode a picture");
+		return false;
+	}
+	if (info.eFrameType == videoFrameTypeSkip || info.eFrameType == videoFrameTypeInvalid)
+		return true;
+
+	// Layers hold NAL units with start codes back to back; the access unit
+	// is all of them in order
+	size_t size = 0;
+	for (int i = 0; i < info.iLayerNum; ++i)
+	{
+		const SLayerBSInfo& layer = info.sLayerInfo[i];
+		for (int nal = 0; nal < layer.iNalCount; ++nal)
+			size += static_cast<size_t>(layer.pNalLengthInByte[nal]);
+	}
+	outFrame.data.reserve(size);
+	for (int i = 0; i < info.iLayerNum; ++i)
+	{
+		const SLayerBSInfo& layer = info.sLayerInfo[i];
+		size_t layerSize = 0;
+		for (int nal = 0; nal < layer.iNalCount; ++nal)
+			layerSize += static_cast<size_t>(layer.pNalLengthInByte[nal]);
+		outFrame.data.insert(outFrame.data.end(), layer.pBsBuf, layer.pBsBuf + layerSize);
+	}
+	outFrame.isKeyframe = info.eFrameType == videoFrameTypeIDR || info.eFrameType == videoFrameTypeI;
+	return true;
+}
+
+bool OpenH264Encoder::Encode(const Nv12View& picture, uint64_t timestampNs, EncodedFrame& outFrame)
+{
+	const int chromaWidth = picture.u.width;
+	const int chromaHeight = picture.u.height;
+	const size_t planeSize = static_cast<size_t>(chromaWidth) * chromaHeight;
+	m_chroma.resize(planeSize * 2);
+
+	I420View planar;
+	planar.y = picture.y;
+	const MutableImageView<PixelFormat::Gray8> u(m_chroma.data(), chromaWidth, chromaHeight);
+	const MutableImageView<PixelFormat::Gray8> v(m_chroma.data() + planeSize, chromaWidth, chromaHeight);
+	SplitChroma(picture.u, u, v);
+	planar.u = u;
+	planar.v = v;
+	return Encode(planar, timestampNs, outFrame);
+}
+
+void OpenH264Encoder::SetRates(int bitrateKbps, int fps)
+{
+	std::lock_guard lock(m_pendingMutex);
+	m_pendingBitrateKbps = std::max(bitrateKbps, 1);
+	m_pendingFps = std::max(fps, 1);
+	m_ratesPending = true;
+}
+
+void OpenH264Encoder::RequestKeyframe()
+{
+	m_keyframeRequested = true;
+}
+
+VideoEncoderConfig OpenH264Encoder::GetConfig() const
+{
+	std::lock_guard lock(m_pendingMutex);
+	return m_config;
+}
+
+void OpenH264Encoder::ApplyPendingRates()
+{
+	int bitrateKbps, fps;
+	{
+		std::lock_guard lock(m_pendingMutex);
+		if (!m_ratesPending)
+			return;
+		m_ratesPending = false;
+		bitrateKbps = m_pendingBitrateKbps;
+		fps = m_pendingFps;
+	}
+
+	if (bitrateKbps != m_config.bitrateKbps)
+	{
+		SBitrateInfo bitrate = {};
+		bitrate.iLayer = SPATIAL_LAYER_ALL;
+		bitrate.iBitrate = bitrateKbps * 1000;
+		m_encoder->SetOption(ENCODER_OPTION_BITRATE, &bitrate);
+	}
+	if (fps != m_config.fps)
+	{
+		float frameRate = static_cast<float>(fps);
+		m_encoder->SetOption(ENCODER_OPTION_FRAME_RATE, &frameRate);
+	}
+
+	std::lock_guard lock(m_pendingMutex);
+	m_config.bitrateKbps = bitrateKbps;
+	m_config.fps = fps;
+}
@@ -0,0 +1,48 @@
+#pragma once
+
+#include "../IVideoEncoder.h"
+
+#include <atomic>
+#include <mutex>
+#include <vector>
+
+class ISVCEncoder;
+
+// H.264 Constrained Baseline through Cisco's OpenH264, the encoder WebRTC
+// stacks ship for software H.264. Threading is slice based: each picture is
+// cut into `threads` fixed slices that OpenH264 encodes in parallel, so
+// latency drops with the thread count and no pictures are buffered.
+class OpenH264Encoder : public IVideoEncoder
+{
+public:
+	OpenH264Encoder() = default;
+	~OpenH264Encoder() override;
+
+	bool Initialize(const VideoEncoderConfig& config) override;
+	void Shutdown() override;
+	bool IsInitialized() const override { return m_encoder != nullptr; }
+
+	bool Encode(const I420View& picture, uint64_t timestampNs, EncodedFrame& outFrame) override;
+	// OpenH264 only reads planar input; the chroma plane is split first
+	bool Encode(const Nv12View& picture, uint64_t timestampNs, EncodedFrame& outFrame) override;
+
+	void SetRates(int bitrateKbps, int fps) override;
+	void RequestKeyframe() override;
+
+	VideoEncoderConfig GetConfig() const override;
+	std::string_view GetName() const noexcept override { return "OpenH264"; }
+
+private:
+	void ApplyPendingRates();
+
+	ISVCEncoder* m_encoder = nullptr;
+	VideoEncoderConfig m_config;
+	std::vector<uint8_t> m_chroma; // I420 chroma planes for NV12 input
+
+	// Requests from other threads, applied before the next picture
+	mutable std::mutex m_pendingMutex;
+	int m_pendingBitrateKbps = 0;
+	int m_pendingFps = 0;
+	bool m_ratesPending = false;
+	std::atomic<bool> m_keyframeRequested = false;
+};
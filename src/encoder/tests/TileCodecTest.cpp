@@ -0,0 +1,179 @@
+#include "../tile/TileCodec.h"
+#include "capture/IGraphicsCapture.h"
+#include "testing/Test.h"
+#include "video/ThreadPool.h"
+
+#include <cstring>
+#include <random>
+#include <vector>
+
+namespace
+{
+	constexpr int kWidth = 200; // Partial tiles on the right and bottom edges
+	constexpr int kHeight = 150;
+
+	// A text-like screen: flat background, lines of two-colour glyphs and a
+	// noisy picture, so every tile mode gets used
+	std::vector<uint32_t> MakeScreen(uint32_t seed)
+	{
+		std::mt19937 random(seed);
+		std::vector<uint32_t> screen(static_cast<size_t>(kWidth) * kHeight, 0x00F0F0F0);
+		for (int y = 0; y < kHeight; ++y)
+		{
+			for (int x = 0; x < kWidth; ++x)
+			{
+				uint32_t& pixel = screen[static_cast<size_t>(y) * kWidth + x];
+				if (x >= 140 && y >= 90)
+					pixel = random();
+				else if (y % 12 < 8 && random() % 3 == 0)
+					pixel = 0x00202020;
+			}
+		}
+		return screen;
+	}
+
+	// The decoder's frame equals `screen` with alpha dropped
+	bool Matches(const TileDecoder& decoder, const std::vector<uint32_t>& screen)
+	{
+		const BgraView frame = decoder.GetFrame();
+		if (frame.width != kWidth || frame.height != kHeight)
+			return false;
+		for (int y = 0; y < kHeight; ++y)
+		{
+			const uint32_t* row = reinterpret_cast<const uint32_t*>(frame.RowData(y));
+			for (int x = 0; x < kWidth; ++x)
+			{
+				if (row[x] != (screen[static_cast<size_t>(y) * kWidth + x] | 0xFF000000u))
+					return false;
+			}
+		}
+		return true;
+	}
+
+	BgraView View(const std::vector<uint32_t>& screen)
+	{
+		return { screen.data(), kWidth, kHeight };
+	}
+}
+
+TEST(TileCodec_RoundTripsKeyframeAndDeltas)
+{
+	TileEncoder encoder;
+	TileDecoder decoder;
+	std::vector<uint8_t> encoded;
+
+	std::vector<uint32_t> screen = MakeScreen(1);
+	REQUIRE(encoder.Encode(View(screen), nullptr, 0, encoded));
+	REQUIRE(decoder.Decode(encoded.data(), encoded.size()));
+	CHECK(Matches(decoder, screen));
+	const size_t keyframeSize = encoded.size();
+
+	// A small edit, reported through a dirty rect
+	for (int y = 70; y < 80; ++y)
+		for (int x = 10; x < 50; ++x)
+			screen[static_cast<size_t>(y) * kWidth + x] = 0x00FF0000;
+	const FrameRect rect = { 10, 70, 40, 10 };
+	REQUIRE(encoder.Encode(View(screen), &rect, 1, encoded));
+	REQUIRE(decoder.Decode(encoded.data(), encoded.size()));
+	CHECK(Matches(decoder, screen));
+
+	// Nothing changed: the frame carries no tiles and decodes to the same image
+	REQUIRE(encoder.Encode(View(screen), nullptr, 0, encoded));
+	CHECK(encoded.size() < keyframeSize / 20);
+	REQUIRE(decoder.Decode(encoded.data(), encoded.size()));
+	CHECK(Matches(decoder, screen));
+
+	const TileCodecStatistics statistics = encoder.GetStatistics();
+	CHECK(statistics.frames == 3);
+	CHECK(statistics.keyframes == 1);
+	CHECK(statistics.tilesSolid + statistics.tilesPalette + statistics.tilesRunLength + statistics.tilesRaw > 0);
+}
+
+TEST(TileCodec_SendsScrolledTilesAsCopies)
+{
+	TileEncoder encoder;
+	TileDecoder decoder;
+	ThreadPool pool(2);
+	std::vector<uint8_t> encoded;
+
+	std::vector<uint32_t> screen = MakeScreen(2);
+	REQUIRE(encoder.Encode(View(screen), nullptr, 0, encoded, &pool));
+	REQUIRE(decoder.Decode(encoded.data(), encoded.size(), &pool));
+
+	// Scroll everything up by 12 rows and draw a new line at the bottom
+	std::memmove(screen.data(), screen.data() + 12 * kWidth, (kHeight - 12) * kWidth * sizeof(uint32_t));
+	std::fill(screen.end() - 12 * kWidth, screen.end(), 0x000000FFu);
+	REQUIRE(encoder.Encode(View(screen), nullptr, 0, encoded, &pool));
+	REQUIRE(decoder.Decode(encoded.data(), encoded.size(), &pool));
+	CHECK(Matches(decoder, screen));
+	CHECK(encoder.GetStatistics().tilesCopied > 0);
+}
+
+TEST(TileCodec_TakesOddStridesAndNewSizes)
+{
+	TileEncoder encoder;
+	TileDecoder decoder;
+	std::vector<uint8_t> encoded;
+
+	// Padded rows whose padding must not reach the output
+	const std::vector<uint32_t> screen = MakeScreen(3);
+	const int stride = kWidth * 4 + 64;
+	std::vector<uint8_t> padded(static_cast<size_t>(stride) * kHeight, 0xAB);
+	for (int y = 0; y < kHeight; ++y)
+		std::memcpy(&padded[static_cast<size_t>(y) * stride], &screen[static_cast<size_t>(y) * kWidth], kWidth * 4);
+	REQUIRE(encoder.Encode(BgraView(padded.data(), kWidth, kHeight, stride), nullptr, 0, encoded));
+	REQUIRE(decoder.Decode(encoded.data(), encoded.size()));
+	CHECK(Matches(decoder, screen));
+
+	// A new size restarts with a keyframe
+	std::vector<uint32_t> small(64 * 32, 0x00123456);
+	REQUIRE(encoder.Encode(BgraView(small.data(), 64, 32), nullptr, 0, encoded));
+	REQUIRE(decoder.Decode(encoded.data(), encoded.size()));
+	CHECK(decoder.GetFrame().width == 64 && decoder.GetFrame().height == 32);
+	CHECK(encoder.GetStatistics().keyframes == 2);
+}
+
+TEST(TileCodec_KeyframeRequestRecoversALateDecoder)
+{
+	TileEncoder encoder;
+	std::vector<uint8_t> encoded;
+
+	std::vector<uint32_t> screen = MakeScreen(4);
+	REQUIRE(encoder.Encode(View(screen), nullptr, 0, encoded));
+	screen[0] = 0x00010203;
+	REQUIRE(encoder.Encode(View(screen), nullptr, 0, encoded));
+
+	// A decoder that missed the keyframe rejects the delta
+	TileDecoder late;
+	CHECK(!late.Decode(encoded.data(), encoded.size()));
+	CHECK(!late.HasFrame());
+
+	encoder.RequestKeyframe();
+	REQUIRE(encoder.Encode(View(screen), nullptr, 0, encoded));
+	REQUIRE(late.Decode(encoded.data(), encoded.size()));
+	CHECK(Matches(late, screen));
+	CHECK(encoder.GetStatistics().keyframes == 2);
+}
+
+TEST(TileCodec_RejectsCorruptFrames)
+{
+	TileEncoder encoder;
+	std::vector<uint8_t> encoded;
+	const std::vector<uint32_t> screen = MakeScreen(5);
+	REQUIRE(encoder.Encode(View(screen), nullptr, 0, encoded));
+
+	TileDecoder decoder;
+	CHECK(!decoder.Decode(encoded.data(), 3));
+	CHECK(!decoder.Decode(encoded.data(), encoded.size() / 2));
+
+	// Any single flipped byte is either rejected or decodes within bounds
+	for (size_t i = 0; i < encoded.size(); i += 7)
+	{
+		std::vector<uint8_t> corrupt = encoded;
+		corrupt[i] ^= 0x5A;
+		TileDecoder fresh;
+		fresh.Decode(corrupt.data(), corrupt.size());
+	}
+	CHECK(decoder.Decode(encoded.data(), encoded.size()));
+	CHECK(Matches(decoder, screen));
+}
@@ -0,0 +1,94 @@
+#include "../IVideoEncoder.h"
+#include "testing/Test.h"
+
+#include <vector>
+
+// The OpenH264 and libvpx backends, for whichever of them the build found
+// (CMakeLists.txt registers these tests only when at least one was)
+
+namespace
+{
+	constexpr int kWidth = 320;
+	constexpr int kHeight = 240;
+
+	// A gradient that moves with `frame`, so deltas have something to code
+	template <YuvFormat Format>
+	void FillPicture(std::vector<uint8_t>& buffer, int frame)
+	{
+		using View = MutablePlanarImageView<Format>;
+		buffer.resize(View::GetBufferSize(kWidth, kHeight));
+		const View view = View::FromBuffer(buffer.data(), kWidth, kHeight);
+		for (int y = 0; y < kHeight; ++y)
+		{
+			for (int x = 0; x < kWidth; ++x)
+				view.y.RowData(y)[x] = static_cast<uint8_t>(x + y + frame * 4);
+		}
+		const size_t lumaSize = static_cast<size_t>(kWidth) * kHeight;
+		std::fill(buffer.begin() + lumaSize, buffer.end(), static_cast<uint8_t>(128 + frame));
+	}
+
+	// What a keyframe starts with: an Annex B start code for H.264, the VP8
+	// keyframe start code after the 3-byte frame tag for VP8
+	bool LooksLikeKeyframe(VideoCodec codec, const std::vector<uint8_t>& data)
+	{
+		if (codec == VideoCodec::H264)
+			return data.size() > 4 && data[0] == 0 && data[1] == 0 && (data[2] == 1 || (data[2] == 0 && data[3] == 1));
+		return data.size() > 6 && (data[0] & 1) == 0 && data[3] == 0x9D && data[4] == 0x01 && data[5] == 0x2A;
+	}
+
+	template <YuvFormat Format>
+	void CheckEncoder(VideoCodec codec)
+	{
+		auto encoder = IVideoEncoder::Create(codec);
+		if (!encoder)
+			return; // Library not found at build time
+		VideoEncoderConfig config;
+		config.codec = codec;
+		config.width = kWidth;
+		config.height = kHeight;
+		config.bitrateKbps = 500;
+		config.threads = 2;
+		REQUIRE(encoder->Initialize(config));
+
+		std::vector<uint8_t> buffer;
+		EncodedFrame frame;
+		for (int i = 0; i < 10; ++i)
+		{
+			FillPicture<Format>(buffer, i);
+			const uint64_t timestampNs = i * 33'333'333ull;
+			REQUIRE(encoder->Encode(PlanarImageView<Format>::FromBuffer(buffer.data(), kWidth, kHeight), timestampNs,
+									frame));
+			CHECK(frame.timestampNs == timestampNs);
+			if (i == 0)
+				CHECK(frame.isKeyframe && LooksLikeKeyframe(codec, frame.data));
+			else if (!frame.data.empty())
+				CHECK(!frame.isKeyframe);
+		}
+
+		// Both requests take effect with the next picture
+		encoder->RequestKeyframe();
+		encoder->SetRates(300, 15);
+		FillPicture<Format>(buffer, 10);
+		REQUIRE(encoder->Encode(PlanarImageView<Format>::FromBuffer(buffer.data(), kWidth, kHeight), 0, frame));
+		CHECK(frame.isKeyframe && LooksLikeKeyframe(codec, frame.data));
+		CHECK(frame.width == kWidth && frame.height == kHeight);
+		const VideoEncoderConfig applied = encoder->GetConfig();
+		CHECK(applied.bitrateKbps == 300 && applied.fps == 15);
+
+		encoder->Shutdown();
+		CHECK(!encoder->IsInitialized());
+	}
+}
+
+TEST(VideoEncoder_EncodesI420)
+{
+	CHECK(IVideoEncoder::IsCodecAvailable(VideoCodec::H264) || IVideoEncoder::IsCodecAvailable(VideoCodec::VP8));
+	CheckEncoder<YuvFormat::I420>(VideoCodec::H264);
+	CheckEncoder<YuvFormat::I420>(VideoCodec::VP8);
+}
+
+TEST(VideoEncoder_EncodesNv12)
+{
+	CheckEncoder<YuvFormat::NV12>(VideoCodec::H264);
+	CheckEncoder<YuvFormat::NV12>(VideoCodec::VP8);
+}
@@ -0,0 +1,853 @@
+#include "TileCodec.h"
+#include "../../capture/IGraphicsCapture.h"
+#include "../../video/Lz4.h"
+#include "../../video/ThreadPool.h"
+
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <cstring>
+
+namespace
+{
+	constexpr uint8_t kMagic[2] = { 'T', 'C' };
+	constexpr uint8_t kVersion = 1;
+	constexpr uint8_t kFlagKeyframe = 1;
+
+	enum TileMode : uint8_t
+	{
+		Solid,
+		Copy,
+		Palette,
+		RunLength,
+		Raw,
+		ModeCount
+	};
+	constexpr uint8_t kModeCompressed = 0x80; // Payload block is LZ4 compressed
+
+	constexpr int kTileSize = TileEncoder::kTileSize;
+	constexpr int kMaxPaletteColors = 256;
+	constexpr size_t kMinCompressSize = 32; // Smaller blocks never shrink
+	constexpr int kMaxScrollOffsets = 4;
+	constexpr int kMaxMatchesPerRow = 4;	// Repeated rows (blank lines) vote for too many offsets
+
+	constexpr uint32_t kColorMask = 0x00FFFFFF;
+
+	void WriteVarint(uint64_t value, std::vector<uint8_t>& out)
+	{
+		while (value >= 0x80)
+		{
+			out.push_back(static_cast<uint8_t>(value | 0x80));
+			value >>= 7;
+		}
+		out.push_back(static_cast<uint8_t>(value));
+	}
+
+	void WriteSignedVarint(int64_t value, std::vector<uint8_t>& out)
+	{
+		WriteVarint((static_cast<uint64_t>(value) << 1) ^ static_cast<uint64_t>(value >> 63), out);
+	}
+
+	void WriteColor(uint32_t color, std::vector<uint8_t>& out)
+	{
+		out.push_back(static_cast<uint8_t>(color));
+		out.push_back(static_cast<uint8_t>(color >> 8));
+		out.push_back(static_cast<uint8_t>(color >> 16));
+	}
+
+	// Bounds-checked reads over one frame
+	struct Reader
+	{
+		const uint8_t* data;
+		const uint8_t* end;
+
+		bool Byte(uint8_t& value)
+		{
+			if (data >= end)
+				return false;
+			value = *data++;
+			return true;
+		}
+
+		bool Varint(uint64_t& value)
+		{
+			value = 0;
+			for (int shift = 0; shift < 64; shift += 7)
+			{
+				uint8_t byte;
+				if (!Byte(byte))
+					return false;
+				value |= static_cast<uint64_t>(byte & 0x7F) << shift;
+				if (!(byte & 0x80))
+					return true;
+			}
+			return false;
+		}
+
+		bool SignedVarint(int64_t& value)
+		{
+			uint64_t raw;
+			if (!Varint(raw))
+				return false;
+			value = static_cast<int64_t>(raw >> 1) ^ -static_cast<int64_t>(raw & 1);
+			return true;
+		}
+
+		bool Color(uint32_t& color)
+		{
+			if (end - data < 3)
+				return false;
+			color = 0xFF000000u | data[0] | static_cast<uint32_t>(data[1]) << 8 | static_cast<uint32_t>(data[2]) << 16;
+			data += 3;
+			return true;
+		}
+
+		bool Skip(size_t size)
+		{
+			if (static_cast<size_t>(end - data) < size)
+				return false;
+			data += size;
+			return true;
+		}
+	};
+
+	uint64_t HashRow(const uint32_t* pixels, int count)
+	{
+		// Two pixels per step; a row segment is at most kTileSize pixels
+		uint64_t hash = 0x9E3779B97F4A7C15ull ^ static_cast<uint64_t>(count);
+		int x = 0;
+		for (; x + 1 < count; x += 2)
+		{
+			uint64_t pair;
+			std::memcpy(&pair, pixels + x, sizeof(pair));
+			hash = (hash ^ pair) * 0xFF51AFD7ED558CCDull;
+			hash ^= hash >> 32;
+		}
+		if (x < count)
+		{
+			hash = (hash ^ pixels[x]) * 0xFF51AFD7ED558CCDull;
+			hash ^= hash >> 32;
+		}
+		return hash;
+	}
+
+	// Packed palette index rows, each starting on a byte boundary
+	int PaletteBits(int colors)
+	{
+		return colors <= 2 ? 1 : colors <= 4 ? 2 : colors <= 16 ? 4 : 8;
+	}
+
+	size_t PaletteRowBytes(int width, int bits)
+	{
+		return (static_cast<size_t>(width) * bits + 7) / 8;
+	}
+
+	// Appends a payload block: raw size, then LZ4 data when that is smaller
+	// (setting kModeCompressed in `mode`), else the bytes themselves
+	void WriteBlock(const std::vector<uint8_t>& payload, uint8_t& mode, std::vector<uint8_t>& out)
+	{
+		WriteVarint(payload.size(), out);
+		if (payload.size() >= kMinCompressSize)
+		{
+			thread_local std::vector<uint8_t> compressed;
+			compressed.clear();
+			Lz4::Compress(payload.data(), payload.size(), compressed);
+			if (compressed.size() + 3 < payload.size())
+			{
+				mode |= kModeCompressed;
+				WriteVarint(compressed.size(), out);
+				out.insert(out.end(), compressed.begin(), compressed.end());
+				return;
+			}
+		}
+		out.insert(out.end(), payload.begin(), payload.end());
+	}
+
+	// Reads a payload block written by WriteBlock() into `scratch` (or points
+	// into the frame when it is stored uncompressed)
+	bool ReadBlock(Reader& reader, bool compressed, size_t expectedSize, std::vector<uint8_t>& scratch,
+				   const uint8_t*& outData)
+	{
+		uint64_t size;
+		if (!reader.Varint(size) || size != expectedSize)
+			return false;
+		if (!compressed)
+		{
+			outData = reader.data;
+			return reader.Skip(size);
+		}
+
+		uint64_t compressedSize;
+		if (!reader.Varint(compressedSize) || compressedSize > static_cast<uint64_t>(reader.end - reader.data))
+			return false;
+		scratch.resize(size);
+		if (!Lz4::Decompress(reader.data, compressedSize, scratch.data(), size))
+			return false;
+		reader.data += compressedSize;
+		outData = scratch.data();
+		return true;
+	}
+
+	struct TileGeometry
+	{
+		int x, y, width, height;
+	};
+
+	TileGeometry GetTile(int tile, int tilesX, int frameWidth, int frameHeight)
+	{
+		const int x = (tile % tilesX) * kTileSize;
+		const int y = (tile / tilesX) * kTileSize;
+		return { x, y, std::min(kTileSize, frameWidth - x), std::min(kTileSize, frameHeight - y) };
+	}
+}
+
+void TileEncoder::Reset()
+{
+	m_width = m_height = 0;
+	m_reference.clear();
+	m_referenceHashes.clear();
+	m_keyframeRequested = true;
+}
+
+TileCodecStatistics TileEncoder::GetStatistics() const
+{
+	std::lock_guard lock(m_statisticsMutex);
+	return m_statistics;
+}
+
+bool TileEncoder::Encode(BgraView frame, const FrameRect* dirtyRects, size_t dirtyRectCount, std::vector<uint8_t>& out,
+						 ThreadPool* pool)
+{
+	out.clear();
+	if (frame.IsEmpty())
+		return false;
+
+	const auto start = std::chrono::steady_clock::now();
+
+	bool keyframe = m_keyframeRequested.exchange(false);
+	if (frame.width != m_width || frame.height != m_height)
+	{
+		m_width = frame.width;
+		m_height = frame.height;
+		m_tilesX = (m_width + kTileSize - 1) / kTileSize;
+		m_tilesY = (m_height + kTileSize - 1) / kTileSize;
+		m_reference.assign(static_cast<size_t>(m_width) * m_height, 0);
+		m_referenceHashes.assign(static_cast<size_t>(m_height) * m_tilesX, 0);
+		m_hashes.assign(m_referenceHashes.size(), 0);
+		keyframe = true;
+	}
+
+	const int tileCount = m_tilesX * m_tilesY;
+	m_candidates.assign(tileCount, keyframe || !dirtyRects || dirtyRectCount == 0 ? 1 : 0);
+	if (!keyframe)
+	{
+		for (size_t i = 0; i < dirtyRectCount; ++i)
+		{
+			const FrameRect& rect = dirtyRects[i];
+			const int left = std::max(rect.x, 0) / kTileSize;
+			const int top = std::max(rect.y, 0) / kTileSize;
+			const int right = std::min((std::min(rect.x + rect.width, m_width) + kTileSize - 1) / kTileSize, m_tilesX);
+			const int bottom = std::min((std::min(rect.y + rect.height, m_height) + kTileSize - 1) / kTileSize, m_tilesY);
+			for (int ty = top; ty < bottom; ++ty)
+				std::fill_n(m_candidates.begin() + static_cast<size_t>(ty) * m_tilesX + left, std::max(right - left, 0), 1);
+		}
+	}
+
+	FindChangedTiles(frame, keyframe, pool);
+	m_scrollOffsets.clear();
+	if (!keyframe)
+		FindScrollCandidates();
+
+	const int changedCount = static_cast<int>(m_changedTiles.size());
+	if (m_tileRecords.size() < m_changedTiles.size())
+		m_tileRecords.resize(m_changedTiles.size());
+	m_tileModes.assign(m_changedTiles.size(), 0);
+	auto encodeTile = [&](int index) { EncodeTile(frame, static_cast<size_t>(index)); };
+	if (pool && changedCount > 1)
+		pool->ParallelFor(changedCount, encodeTile);
+	else
+	{
+		for (int i = 0; i < changedCount; ++i)
+			encodeTile(i);
+	}
+
+	out.insert(out.end(), std::begin(kMagic), std::end(kMagic));
+	out.push_back(kVersion);
+	out.push_back(keyframe ? kFlagKeyframe : 0);
+	WriteVarint(static_cast<uint64_t>(m_width), out);
+	WriteVarint(static_cast<uint64_t>(m_height), out);
+	WriteVarint(m_changedTiles.size(), out);
+	size_t recordBytes = 0;
+	for (int i = 0; i < changedCount; ++i)
+		recordBytes += m_tileRecords[i].size();
+	out.reserve(out.size() + recordBytes);
+	int previous = -1;
+	for (int i = 0; i < changedCount; ++i)
+	{
+		WriteVarint(static_cast<uint64_t>(m_changedTiles[i] - previous - 1), out);
+		out.insert(out.end(), m_tileRecords[i].begin(), m_tileRecords[i].end());
+		previous = m_changedTiles[i];
+	}
+
+	UpdateReference(frame, pool);
+
+	const auto elapsed = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start);
+	std::lock_guard lock(m_statisticsMutex);
+	++m_statistics.frames;
+	m_statistics.keyframes += keyframe ? 1 : 0;
+	m_statistics.tilesUnchanged += static_cast<uint64_t>(tileCount - changedCount);
+	for (uint8_t mode : m_tileModes)
+	{
+		switch (mode & ~kModeCompressed)
+		{
+		case Solid: ++m_statistics.tilesSolid; break;
+		case Copy: ++m_statistics.tilesCopied; break;
+		case Palette: ++m_statistics.tilesPalette; break;
+		case RunLength: ++m_statistics.tilesRunLength; break;
+		default: ++m_statistics.tilesRaw; break;
+		}
+	}
+	m_statistics.inputBytes += static_cast<uint64_t>(m_width) * m_height * 4;
+	m_statistics.outputBytes += out.size();
+	m_statistics.encodeTimeNs += static_cast<uint64_t>(elapsed.count());
+	return true;
+}
+
+void TileEncoder::FindChangedTiles(BgraView frame, bool keyframe, ThreadPool* pool)
+{
+	m_changed.assign(m_candidates.size(), 0);
+
+	// Hash the rows of every candidate tile; a tile whose hashes all match
+	// the reference is compared in full before it counts as unchanged
+	auto scanTileRow = [&](int tileY) {
+		for (int tileX = 0; tileX < m_tilesX; ++tileX)
+		{
+			const int tile = tileY * m_tilesX + tileX;
+			if (!m_candidates[tile])
+				continue;
+
+			const TileGeometry geometry = GetTile(tile, m_tilesX, m_width, m_height);
+			bool same = !keyframe;
+			for (int y = geometry.y; y < geometry.y + geometry.height; ++y)
+			{
+				const size_t hashIndex = static_cast<size_t>(y) * m_tilesX + tileX;
+				m_hashes[hashIndex] = HashRow(frame.Row(y) + geometry.x, geometry.width);
+				same = same && m_hashes[hashIndex] == m_referenceHashes[hashIndex];
+			}
+			for (int y = geometry.y; same && y < geometry.y + geometry.height; ++y)
+			{
+				same = std::memcmp(frame.Row(y) + geometry.x, m_reference.data() + static_cast<size_t>(y) * m_width + geometry.x,
+								   static_cast<size_t>(geometry.width) * 4) == 0;
+			}
+			m_changed[tile] = same ? 0 : 1;
+		}
+	};
+	if (pool)
+		pool->ParallelFor(m_tilesY, scanTileRow);
+	else
+	{
+		for (int tileY = 0; tileY < m_tilesY; ++tileY)
+			scanTileRow(tileY);
+	}
+
+	m_changedTiles.clear();
+	for (int tile = 0; tile < static_cast<int>(m_changed.size()); ++tile)
+	{
+		if (m_changed[tile])
+			m_changedTiles.push_back(tile);
+	}
+}
+
+void TileEncoder::FindScrollCandidates()
+{
+	// Scrolled content shows up as rows of a changed tile that the same tile
+	// column held at another height in the previous frame. A couple of
+	// distinctive rows per tile vote for that vertical offset; the offsets
+	// with the most votes are then tried on every changed tile.
+	std::vector<std::pair<int, int>> votes; // (dy, count)
+	auto vote = [&votes](int dy) {
+		auto it = std::find_if(votes.begin(), votes.end(), [dy](const auto& entry) { return entry.first == dy; });
+		if (it != votes.end())
+			++it->second;
+		else
+			votes.push_back({ dy, 1 });
+	};
+
+	for (int tile : m_changedTiles)
+	{
+		const int tileX = tile % m_tilesX;
+		const TileGeometry geometry = GetTile(tile, m_tilesX, m_width, m_height);
+		int sampled = 0;
+		for (int y = geometry.y + 1; y + 1 < geometry.y + geometry.height && sampled < 2; y += 7)
+		{
+			// A row unlike its neighbours: not background, not the middle of a run
+			const uint64_t hash = m_hashes[static_cast<size_t>(y) * m_tilesX + tileX];
+			if (hash == m_hashes[static_cast<size_t>(y - 1) * m_tilesX + tileX] ||
+				hash == m_hashes[static_cast<size_t>(y + 1) * m_tilesX + tileX])
+				continue;
+			++sampled;
+
+			// Offsets that already have votes are checked first, which keeps
+			// a full-screen scroll from scanning the column for every tile
+			bool matched = false;
+			for (const auto& [dy, count] : votes)
+			{
+				const int source = y + dy;
+				if (source >= 0 && source < m_height && m_referenceHashes[static_cast<size_t>(source) * m_tilesX + tileX] == hash)
+				{
+					vote(dy);
+					matched = true;
+					break;
+				}
+			}
+			if (matched)
+				continue;
+
+			int matches = 0;
+			for (int source = 0; source < m_height && matches < kMaxMatchesPerRow; ++source)
+			{
+				if (source != y && m_referenceHashes[static_cast<size_t>(source) * m_tilesX + tileX] == hash)
+				{
+					vote(source - y);
+					++matches;
+				}
+			}
+		}
+	}
+
+	std::sort(votes.begin(), votes.end(), [](const auto& a, const auto& b) { return a.second > b.second; });
+	for (size_t i = 0; i < votes.size() && static_cast<int>(i) < kMaxScrollOffsets; ++i)
+		m_scrollOffsets.push_back(votes[i].first);
+}
+
+void TileEncoder::EncodeTile(BgraView frame, size_t changedIndex)
+{
+	const int tile = m_changedTiles[changedIndex];
+	const int tileX = tile % m_tilesX;
+	const TileGeometry geometry = GetTile(tile, m_tilesX, m_width, m_height);
+	std::vector<uint8_t>& record = m_tileRecords[changedIndex];
+	record.clear();
+
+	// Copy: the whole tile sits at a scroll offset in the previous frame
+	for (int dy : m_scrollOffsets)
+	{
+		const int sourceY = geometry.y + dy;
+		if (sourceY < 0 || sourceY + geometry.height > m_height)
+			continue;
+
+		bool match = true;
+		for (int y = 0; match && y < geometry.height; ++y)
+		{
+			match = m_hashes[static_cast<size_t>(geometry.y + y) * m_tilesX + tileX] ==
+					m_referenceHashes[static_cast<size_t>(sourceY + y) * m_tilesX + tileX];
+		}
+		for (int y = 0; match && y < geometry.height; ++y)
+		{
+			match = std::memcmp(frame.Row(geometry.y + y) + geometry.x,
+								m_reference.data() + static_cast<size_t>(sourceY + y) * m_width + geometry.x,
+								static_cast<size_t>(geometry.width) * 4) == 0;
+		}
+		if (match)
+		{
+			record.push_back(Copy);
+			WriteSignedVarint(0, record);
+			WriteSignedVarint(dy, record);
+			m_tileModes[changedIndex] = Copy;
+			return;
+		}
+	}
+
+	// One pass for the palette (up to 256 colours) and the run count
+	std::array<uint32_t, 1024> slots; // Open addressing: colour | 0xFF000000, 0 = empty
+	std::array<uint8_t, 1024> slotIndex;
+	slots.fill(0);
+	std::array<uint32_t, kMaxPaletteColors> palette;
+	int colors = 0;
+	size_t runs = 0;
+	uint32_t previous = 0;
+	for (int y = 0; y < geometry.height; ++y)
+	{
+		const uint32_t* row = frame.Row(geometry.y + y) + geometry.x;
+		for (int x = 0; x < geometry.width; ++x)
+		{
+			const uint32_t color = row[x] | ~kColorMask;
+			if (color != previous || (x == 0 && y == 0))
+			{
+				++runs;
+				previous = color;
+				if (colors <= kMaxPaletteColors)
+				{
+					uint32_t slot = (color * 0x9E3779B1u) >> 22;
+					while (slots[slot] && slots[slot] != color)
+						slot = (slot + 1) & 1023;
+					if (!slots[slot])
+					{
+						if (colors < kMaxPaletteColors)
+						{
+							slots[slot] = color;
+							slotIndex[slot] = static_cast<uint8_t>(colors);
+							palette[colors] = color;
+						}
+						++colors; // 257 marks "too many"
+					}
+				}
+			}
+		}
+	}
+
+	if (colors == 1)
+	{
+		record.push_back(Solid);
+		WriteColor(palette[0], record);
+		m_tileModes[changedIndex] = Solid;
+		return;
+	}
+
+	// Pick the smallest before LZ4; it usually stays the smallest after
+	const size_t pixels = static_cast<size_t>(geometry.width) * geometry.height;
+	const size_t rawSize = pixels * 3;
+	const size_t runLengthSize = runs * 5;
+	const bool paletted = colors <= kMaxPaletteColors;
+	const int bits = paletted ? PaletteBits(colors) : 8;
+	const size_t paletteSize = paletted ? 1 + colors * 3 + PaletteRowBytes(geometry.width, bits) * geometry.height : SIZE_MAX;
+
+	thread_local std::vector<uint8_t> payload;
+	payload.clear();
+	uint8_t mode;
+	if (paletteSize <= runLengthSize && paletteSize <= rawSize)
+	{
+		mode = Palette;
+		const size_t rowBytes = PaletteRowBytes(geometry.width, bits);
+		payload.resize(rowBytes * geometry.height, 0);
+		for (int y = 0; y < geometry.height; ++y)
+		{
+			const uint32_t* row = frame.Row(geometry.y + y) + geometry.x;
+			uint8_t* out = payload.data() + rowBytes * y;
+			for (int x = 0; x < geometry.width; ++x)
+			{
+				const uint32_t color = row[x] | ~kColorMask;
+				uint32_t slot = (color * 0x9E3779B1u) >> 22;
+				while (slots[slot] != color)
+					slot = (slot + 1) & 1023;
+				const int bitOffset = x * bits;
+				out[bitOffset >> 3] |= static_cast<uint8_t>(slotIndex[slot] << (8 - bits - (bitOffset & 7)));
+			}
+		}
+		record.push_back(mode);
+		record.push_back(static_cast<uint8_t>(colors - 1));
+		for (int i = 0; i < colors; ++i)
+			WriteColor(palette[i], record);
+	}
+	else if (runLengthSize <= rawSize)
+	{
+		mode = RunLength;
+		uint32_t color = 0;
+		size_t length = 0;
+		for (int y = 0; y < geometry.height; ++y)
+		{
+			const uint32_t* row = frame.Row(geometry.y + y) + geometry.x;
+			for (int x = 0; x < geometry.width; ++x)
+			{
+				const uint32_t next = row[x] | ~kColorMask;
+				if (length && next == color)
+				{
+					++length;
+					continue;
+				}
+				if (length)
+				{
+					WriteVarint(length - 1, payload);
+					WriteColor(color, payload);
+				}
+				color = next;
+				length = 1;
+			}
+		}
+		WriteVarint(length - 1, payload);
+		WriteColor(color, payload);
+		record.push_back(mode);
+	}
+	else
+	{
+		mode = Raw;
+		payload.resize(rawSize);
+		uint8_t* out = payload.data();
+		for (int y = 0; y < geometry.height; ++y)
+		{
+			const uint32_t* row = frame.Row(geometry.y + y) + geometry.x;
+			for (int x = 0; x < geometry.width; ++x, out += 3)
+			{
+				out[0] = static_cast<uint8_t>(row[x]);
+				out[1] = static_cast<uint8_t>(row[x] >> 8);
+				out[2] = static_cast<uint8_t>(row[x] >> 16);
+			}
+		}
+		record.push_back(mode);
+	}
+
+	uint8_t finalMode = mode;
+	WriteBlock(payload, finalMode, record);
+	record[0] = finalMode;
+	m_tileModes[changedIndex] = finalMode;
+}
+
+void TileEncoder::UpdateReference(BgraView frame, ThreadPool* pool)
+{
+	auto update = [&](int index) {
+		const int tile = m_changedTiles[index];
+		const int tileX = tile % m_tilesX;
+		const TileGeometry geometry = GetTile(tile, m_tilesX, m_width, m_height);
+		for (int y = geometry.y; y < geometry.y + geometry.height; ++y)
+		{
+			std::memcpy(m_reference.data() + static_cast<size_t>(y) * m_width + geometry.x, frame.Row(y) + geometry.x,
+						static_cast<size_t>(geometry.width) * 4);
+			const size_t hashIndex = static_cast<size_t>(y) * m_tilesX + tileX;
+			m_referenceHashes[hashIndex] = m_hashes[hashIndex];
+		}
+	};
+	const int count = static_cast<int>(m_changedTiles.size());
+	if (pool && count > 1)
+		pool->ParallelFor(count, update);
+	else
+	{
+		for (int i = 0; i < count; ++i)
+			update(i);
+	}
+}
+
+void TileDecoder::Reset()
+{
+	m_width = m_height = m_tilesX = 0;
+	m_frame.clear();
+}
+
+bool TileDecoder::Decode(const uint8_t* data, size_t size, ThreadPool* pool)
+{
+	Reader reader = { data, data + size };
+	uint8_t magic0, magic1, version, flags;
+	if (!reader.Byte(magic0) || !reader.Byte(magic1) || !reader.Byte(version) || !reader.Byte(flags) ||
+		magic0 != kMagic[0] || magic1 != kMagic[1] || version != kVersion)
+		return false;
+
+	uint64_t width, height, recordCount;
+	if (!reader.Varint(width) || !reader.Varint(height) || !reader.Varint(recordCount) || width == 0 || height == 0 ||
+		width > 16384 || height > 16384)
+		return false;
+
+	const bool keyframe = (flags & kFlagKeyframe) != 0;
+	if (!keyframe && (static_cast<int>(width) != m_width || static_cast<int>(height) != m_height))
+		return false; // A delta frame needs the frame it was made against
+
+	const int tilesX = (static_cast<int>(width) + kTileSize - 1) / kTileSize;
+	const int tilesY = (static_cast<int>(height) + kTileSize - 1) / kTileSize;
+	const uint64_t tileCount = static_cast<uint64_t>(tilesX) * tilesY;
+	if (recordCount > tileCount)
+		return false;
+
+	// Parse every record first: Copy tiles read the previous frame, so their
+	// sources are taken before anything is overwritten
+	m_records.clear();
+	m_copySource.clear();
+	int64_t tile = -1;
+	for (uint64_t i = 0; i < recordCount; ++i)
+	{
+		uint64_t skip;
+		uint8_t mode;
+		if (!reader.Varint(skip) || !reader.Byte(mode))
+			return false;
+		tile += static_cast<int64_t>(skip) + 1;
+		if (tile >= static_cast<int64_t>(tileCount) || (mode & ~kModeCompressed) >= ModeCount)
+			return false;
+
+		Record record;
+		record.tile = static_cast<int>(tile);
+		record.mode = mode;
+		record.payload = reader.data;
+		const TileGeometry geometry = GetTile(record.tile, tilesX, static_cast<int>(width), static_cast<int>(height));
+
+		switch (mode & ~kModeCompressed)
+		{
+		case Solid:
+		{
+			uint32_t color;
+			if (!reader.Color(color))
+				return false;
+			break;
+		}
+		case Copy:
+		{
+			int64_t dx, dy;
+			if (!reader.SignedVarint(dx) || !reader.SignedVarint(dy) || keyframe)
+				return false;
+			const int64_t sourceX = geometry.x + dx;
+			const int64_t sourceY = geometry.y + dy;
+			if (sourceX < 0 || sourceY < 0 || sourceX + geometry.width > m_width || sourceY + geometry.height > m_height)
+				return false;
+			record.copyOffset = m_copySource.size();
+			for (int y = 0; y < geometry.height; ++y)
+			{
+				const uint32_t* row = m_frame.data() + static_cast<size_t>(sourceY + y) * m_width + sourceX;
+				m_copySource.insert(m_copySource.end(), row, row + geometry.width);
+			}
+			break;
+		}
+		case Palette:
+		{
+			uint8_t colors;
+			if (!reader.Byte(colors) || !reader.Skip((colors + 1) * 3))
+				return false;
+			[[fallthrough]];
+		}
+		default:
+		{
+			// Skip the block; its contents are checked when decoding
+			uint64_t blockSize;
+			if (!reader.Varint(blockSize))
+				return false;
+			if (mode & kModeCompressed)
+			{
+				uint64_t compressedSize;
+				if (!reader.Varint(compressedSize) || !reader.Skip(compressedSize))
+					return false;
+			}
+			else if (!reader.Skip(blockSize))
+				return false;
+			break;
+		}
+		}
+		record.payloadSize = static_cast<size_t>(reader.data - record.payload);
+		m_records.push_back(record);
+	}
+	if (reader.data != reader.end)
+		return false;
+
+	if (keyframe)
+	{
+		m_width = static_cast<int>(width);
+		m_height = static_cast<int>(height);
+		m_tilesX = tilesX;
+		m_frame.assign(static_cast<size_t>(m_width) * m_height, 0xFF000000u);
+	}
+
+	std::atomic<bool> ok = true;
+	auto decode = [&](int index) {
+		thread_local std::vector<uint8_t> scratch;
+		if (!DecodeTile(m_records[index], scratch))
+			ok = false;
+	};
+	const int count = static_cast<int>(m_records.size());
+	if (pool && count > 1)
+		pool->ParallelFor(count, decode);
+	else
+	{
+		for (int i = 0; i < count; ++i)
+			decode(i);
+	}
+	return ok;
+}
+
+bool TileDecoder::DecodeTile(const Record& record, std::vector<uint8_t>& scratch)
+{
+	const TileGeometry geometry = GetTile(record.tile, m_tilesX, m_width, m_height);
+	Reader reader = { record.payload, record.payload + record.payloadSize };
+	const bool compressed = (record.mode & kModeCompressed) != 0;
+	auto row = [&](int y) { return m_frame.data() + static_cast<size_t>(geometry.y + y) * m_width + geometry.x; };
+
+	switch (record.mode & ~kModeCompressed)
+	{
+	case Solid:
+	{
+		uint32_t color = 0;
+		reader.Color(color);
+		for (int y = 0; y < geometry.height; ++y)
+			std::fill_n(row(y), geometry.width, color);
+		return true;
+	}
+	case Copy:
+	{
+		for (int y = 0; y < geometry.height; ++y)
+		{
+			const uint32_t* source = m_copySource.data() + record.copyOffset + static_cast<size_t>(y) * geometry.width;
+			uint32_t* out = row(y);
+			for (int x = 0; x < geometry.width; ++x)
+				out[x] = source[x] | ~kColorMask;
+		}
+		return true;
+	}
+	case Palette:
+	{
+		uint8_t colorCount = 0;
+		reader.Byte(colorCount);
+		const int colors = colorCount + 1;
+		std::array<uint32_t, kMaxPaletteColors> palette;
+		for (int i = 0; i < colors; ++i)
+			reader.Color(palette[i]);
+		const int bits = PaletteBits(colors);
+		const size_t rowBytes = PaletteRowBytes(geometry.width, bits);
+		const uint8_t* indices;
+		if (!ReadBlock(reader, compressed, rowBytes * geometry.height, scratch, indices))
+			return false;
+		const int mask = (1 << bits) - 1;
+		for (int y = 0; y < geometry.height; ++y)
+		{
+			const uint8_t* in = indices + rowBytes * y;
+			uint32_t* out = row(y);
+			for (int x = 0; x < geometry.width; ++x)
+			{
+				const int bitOffset = x * bits;
+				const int index = (in[bitOffset >> 3] >> (8 - bits - (bitOffset & 7))) & mask;
+				if (index >= colors)
+					return false;
+				out[x] = palette[index];
+			}
+		}
+		return true;
+	}
+	case RunLength:
+	{
+		uint64_t blockSize;
+		Reader peek = reader;
+		if (!peek.Varint(blockSize) || blockSize > static_cast<uint64_t>(geometry.width) * geometry.height * 12)
+			return false;
+		const uint8_t* runs;
+		if (!ReadBlock(reader, compressed, blockSize, scratch, runs))
+			return false;
+		Reader in = { runs, runs + blockSize };
+		int x = 0, y = 0;
+		while (y < geometry.height)
+		{
+			uint64_t length;
+			uint32_t color;
+			if (!in.Varint(length) || !in.Color(color))
+				return false;
+			for (++length; length > 0; --length)
+			{
+				if (y >= geometry.height)
+					return false;
+				row(y)[x] = color;
+				if (++x == geometry.width)
+				{
+					x = 0;
+					++y;
+				}
+			}
+		}
+		return in.data == in.end;
+	}
+	case Raw:
+	{
+		const size_t pixels = static_cast<size_t>(geometry.width) * geometry.height;
+		const uint8_t* in;
+		if (!ReadBlock(reader, compressed, pixels * 3, scratch, in))
+			return false;
+		for (int y = 0; y < geometry.height; ++y)
+		{
+			uint32_t* out = row(y);
+			for (int x = 0; x < geometry.width; ++x, in += 3)
+				out[x] = 0xFF000000u | in[0] | static_cast<uint32_t>(in[1]) << 8 | static_cast<uint32_t>(in[2]) << 16;
+		}
+		return true;
+	}
+	}
+	return false;
+}
@@ -0,0 +1,128 @@
+#pragma once
+
+#include "../../video/ImageView.h"
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <vector>
+
+struct FrameRect;
+class ThreadPool;
+
+struct TileCodecStatistics
+{
+	uint64_t frames = 0;
+	uint64_t keyframes = 0;
+	uint64_t tilesUnchanged = 0; // Skipped: identical to the previous frame
+	uint64_t tilesCopied = 0;	 // Found elsewhere in the previous frame (scrolling)
+	uint64_t tilesSolid = 0;
+	uint64_t tilesPalette = 0;
+	uint64_t tilesRunLength = 0;
+	uint64_t tilesRaw = 0;
+	uint64_t inputBytes = 0; // Frame pixels offered, 4 bytes each
+	uint64_t outputBytes = 0;
+	uint64_t encodeTimeNs = 0;
+
+	double GetCompressionRatio() const { return outputBytes ? static_cast<double>(inputBytes) / outputBytes : 0.0; }
+	// Input megabytes per second of encode time
+	double GetThroughputMBps() const { return encodeTimeNs ? inputBytes * 1000.0 / encodeTimeNs : 0.0; }
+};
+
+// Lossless codec for screen content, for links with bandwidth to spare (a
+// LAN) where text must stay pixel-exact. Frames are cut into kTileSize
+// tiles and only tiles that differ from the previous frame are sent, each
+// in the cheapest of these modes:
+//
+//   Solid      one colour
+//   Copy       the same pixels elsewhere in the previous frame; finds
+//              scrolled text through per-row hashes of each tile column
+//   Palette    up to 256 colours, indices packed to 1/2/4/8 bits
+//   RunLength  runs of one colour
+//   Raw        the pixels
+//
+// Palette, RunLength and Raw payloads then go through LZ4 when that makes
+// them smaller. Tiles are analysed and encoded in parallel on a ThreadPool.
+// Colour is 24-bit: alpha is dropped and decoded frames are opaque.
+//
+// A frame is a small header followed by one record per sent tile; tiles
+// without a record keep their pixels, so decoding needs the previous frame
+// and starts at a keyframe.
+class TileEncoder
+{
+public:
+	static constexpr int kTileSize = 64;
+
+	// Replaces `out` with the encoded frame. Tiles outside `dirtyRects` are
+	// taken as unchanged; no rects means any tile may have changed. Changed
+	// tiles are confirmed against the previous frame, so loose rects only
+	// cost a compare. A new frame size starts with a keyframe.
+	bool Encode(BgraView frame, const FrameRect* dirtyRects, size_t dirtyRectCount, std::vector<uint8_t>& out,
+				ThreadPool* pool = nullptr);
+
+	// The next frame sends every tile without reference to earlier ones
+	// (e.g. for a receiver that joined late). Any thread.
+	void RequestKeyframe() { m_keyframeRequested = true; }
+	void Reset();
+
+	TileCodecStatistics GetStatistics() const;
+
+private:
+	void FindChangedTiles(BgraView frame, bool keyframe, ThreadPool* pool);
+	void FindScrollCandidates();
+	void EncodeTile(BgraView frame, size_t changedIndex);
+	void UpdateReference(BgraView frame, ThreadPool* pool);
+
+	int m_width = 0;
+	int m_height = 0;
+	int m_tilesX = 0;
+	int m_tilesY = 0;
+	std::vector<uint32_t> m_reference;		// Previous frame as the decoder has it, packed
+	std::vector<uint64_t> m_referenceHashes; // Per row of each tile column: [y * tilesX + tileX]
+	std::vector<uint64_t> m_hashes;			 // Same for the current frame (dirty tiles only)
+	std::vector<uint8_t> m_candidates;		 // Per tile: inside a dirty rect
+	std::vector<uint8_t> m_changed;			 // Per tile: differs from the reference
+	std::vector<int> m_changedTiles;		 // Indices of changed tiles, in order
+	std::vector<int> m_scrollOffsets;		 // Copy mode source offsets (dy) worth trying
+	std::vector<std::vector<uint8_t>> m_tileRecords; // Encoded record per changed tile
+	std::vector<uint8_t> m_tileModes;
+	std::atomic<bool> m_keyframeRequested = true;
+
+	mutable std::mutex m_statisticsMutex;
+	TileCodecStatistics m_statistics;
+};
+
+// Rebuilds frames from TileEncoder output. A frame with a bad header or
+// record table is rejected before any pixel is written; a corrupt tile
+// payload may leave the frame partly updated, so the receiver should ask
+// for a keyframe whenever Decode() fails.
+class TileDecoder
+{
+public:
+	// False for a corrupt frame, or a delta frame without a keyframe before it
+	bool Decode(const uint8_t* data, size_t size, ThreadPool* pool = nullptr);
+	void Reset();
+
+	bool HasFrame() const { return !m_frame.empty(); }
+	BgraView GetFrame() const { return { m_frame.data(), m_width, m_height }; }
+
+private:
+	struct Record
+	{
+		int tile = 0;
+		uint8_t mode = 0;
+		const uint8_t* payload = nullptr;
+		size_t payloadSize = 0;
+		size_t copyOffset = 0; // Into m_copySource, for Copy tiles
+	};
+
+	bool DecodeTile(const Record& record, std::vector<uint8_t>& scratch);
+
+	int m_width = 0;
+	int m_height = 0;
+	int m_tilesX = 0;
+	std::vector<uint32_t> m_frame;
+	std::vector<Record> m_records;
+	std::vector<uint32_t> m_copySource; // Copy tiles' source pixels, taken before any tile is written
+};
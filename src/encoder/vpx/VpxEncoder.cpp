@@ -0,0 +1,223 @@
+#include "VpxEncoder.h"
+#include "../../platform/Logger.h"
+
+#include <vpx/vp8cx.h>
+#include <vpx/vpx_encoder.h>
+
+#include <algorithm>
+#include <format>
+
+VpxEncoder::VpxEncoder()
+	: m_codec(std::make_unique<vpx_codec_ctx_t>()), m_codecConfig(std::make_unique<vpx_codec_enc_cfg_t>())
+{
+}
+
+VpxEncoder::~VpxEncoder()
+{
+	Shutdown();
+}
+
+bool VpxEncoder::Initialize(const VideoEncoderConfig& config)
+{
+	Shutdown();
+
+	if (config.width <= 0 || config.height <= 0)
+	{
+		Logger::Error(std::format("Invalid VP8 picture size {}x{}", config.width, config.height));
+		return false;
+	}
+
+	m_config = config;
+	m_config.fps = std::max(config.fps, 1);
+	m_config.bitrateKbps = std::max(config.bitrateKbps, 1);
+	if (m_config.threads <= 0)
+		m_config.threads = GetDefaultThreadCount(config.width, config.height);
+
+	vpx_codec_enc_cfg_t& cfg = *m_codecConfig;
+	if (vpx_codec_enc_config_default(vpx_codec_vp8_cx(), &cfg, 0) != VPX_CODEC_OK)
+	{
+		Logger::Error("Failed to get the default VP8 configuration");
+		return false;
+	}
+	cfg.g_w = static_cast<unsigned int>(m_config.width);
+	cfg.g_h = static_cast<unsigned int>(m_config.height);
+	cfg.g_timebase.num = 1;
+	cfg.g_timebase.den = 1'000'000; // Microsecond pts
+	cfg.g_threads = static_cast<unsigned int>(m_config.threads);
+	cfg.g_pass = VPX_RC_ONE_PASS;
+	cfg.g_lag_in_frames = 0; // No lookahead: every picture comes out of its own Encode()
+	cfg.g_error_resilient = VPX_ERROR_RESILIENT_DEFAULT;
+	cfg.rc_end_usage = VPX_CBR;
+	cfg.rc_target_bitrate = static_cast<unsigned int>(m_config.bitrateKbps);
+	cfg.rc_dropframe_thresh = 30; // Drop pictures rather than overshoot the rate
+	cfg.rc_resize_allowed = 0;
+	cfg.rc_min_quantizer = 2;
+	cfg.rc_max_quantizer = 56;
+	cfg.rc_undershoot_pct = 100;
+	cfg.rc_overshoot_pct = 15;
+	cfg.rc_buf_initial_sz = 500;
+	cfg.rc_buf_optimal_sz = 600;
+	cfg.rc_buf_sz = 1000;
+	cfg.kf_mode = m_config.keyframeInterval > 0 ? VPX_KF_AUTO : VPX_KF_DISABLED;
+	cfg.kf_min_dist = 0;
+	cfg.kf_max_dist = static_cast<unsigned int>(std::max(m_config.keyframeInterval, 0));
+
+	if (vpx_codec_enc_init(m_codec.get(), vpx_codec_vp8_cx(), &cfg, 0) != VPX_CODEC_OK)
+	{
+		Logger::Error(std::format("Failed to initialize VP8 for {}x{}: {}", m_config.width, m_config.height,
+								  vpx_codec_error_detail(m_codec.get()) ? vpx_codec_error_detail(m_codec.get())
+																		: vpx_codec_error(m_codec.get())));
+		return false;
+	}
+	m_initialized = true;
+
+	// Real-time speed; token partitions let the entropy coder (and decoders)
+	// use the threads too, up to 8
+	int partitions = 0;
+	while (partitions < 3 && (2 << partitions) <= m_config.threads)
+		++partitions;
+	vpx_codec_control(m_codec.get(), VP8E_SET_CPUUSED, -6);
+	vpx_codec_control(m_codec.get(), VP8E_SET_TOKEN_PARTITIONS, partitions);
+	vpx_codec_control(m_codec.get(), VP8E_SET_NOISE_SENSITIVITY, 0);
+	vpx_codec_control(m_codec.get(), VP8E_SET_STATIC_THRESHOLD, m_config.screenContent ? 100 : 1);
+	vpx_codec_control(m_codec.get(), VP8E_SET_SCREEN_CONTENT_MODE, m_config.screenContent ? 1 : 0);
+	// Cap keyframes at a few average frames so they do not stall the link
+	vpx_codec_control(m_codec.get(), VP8E_SET_MAX_INTRA_BITRATE_PCT, 300);
+
+	m_lastPts = -1;
+	{
+		std::lock_guard lock(m_pendingMutex);
+		m_ratesPending = false;
+	}
+	m_keyframeRequested = false;
+
+	Logger::Info(std::format("VP8 encoder: {}x{} @ {} fps, {} kbps, {} thread(s)", m_config.width, m_config.height,
+							 m_config.fps, m_config.bitrateKbps, m_config.threads));
+	return true;
+}
+
+void VpxEncoder::Shutdown()
+{
+	if (!m_initialized)
+		return;
+
+	vpx_codec_destroy(m_codec.get());
+	m_initialized = false;
+}
+
+bool VpxEncoder::Encode(const I420View& picture, uint64_t timestampNs, EncodedFrame& outFrame)
+{
+	outFrame.data.clear();
+	outFrame.timestampNs = timestampNs;
+	outFrame.width = picture.Width();
+	outFrame.height = picture.Height();
+	outFrame.isKeyframe = false;
+	outFrame.qp = -1;
+
+	if (!m_initialized || picture.Width() != m_config.width || picture.Height() != m_config.height)
+		return false;
+
+	ApplyPendingRates();
+	const vpx_enc_frame_flags_t flags = m_keyframeRequested.exchange(false) ? VPX_EFLAG_FORCE_KF : 0;
+
+	// Wrap the planes in place; vpx_img_wrap() only handles one contiguous buffer
+	vpx_image_t image;
+	vpx_img_wrap(&image, VPX_IMG_FMT_I420, picture.Width(), picture.Height(), 1,
+				 const_cast<unsigned char*>(picture.y.data));
+	image.planes[VPX_PLANE_Y] = const_cast<unsigned char*>(picture.y.data);
+	image.planes[VPX_PLANE_U] = const_cast<unsigned char*>(picture.u.data);
+	image.planes[VPX_PLANE_V] = const_cast<unsigned char*>(picture.v.data);
+	image.stride[VPX_PLANE_Y] = picture.y.stride;
+	image.stride[VPX_PLANE_U] = picture.u.stride;
+	image.stride[VPX_PLANE_V] = picture.v.stride;
+
+	const int64_t duration = 1'000'000 / m_config.fps;
+	const int64_t pts = std::max(static_cast<int64_t>(timestampNs / 1000), m_lastPts + 1);
+	m_lastPts = pts;
+
+	if (vpx_codec_encode(m_codec.get(), &image, pts, static_cast<unsigned long>(duration), flags, VPX_DL_REALTIME) !=
+		VPX_CODEC_OK)
+	{
+		Logger::Error(std::format("VP8 failed to encode a picture: {}", vpx_codec_error(m_codec.get())));
+		return false;
+	}
+
+	vpx_codec_iter_t iterator = nullptr;
+	while (const vpx_codec_cx_pkt_t* packet = vpx_codec_get_cx_data(m_codec.get(), &iterator))
+	{
+		if (packet->kind != VPX_CODEC_CX_FRAME_PKT)
+			continue;
+		const auto* data = static_cast<const uint8_t*>(packet->data.frame.buf);
+		outFrame.data.insert(outFrame.data.end(), data, data + packet->data.frame.sz);
+		outFrame.isKeyframe |= (packet->data.frame.flags & VPX_FRAME_IS_KEY) != 0;
+	}
+
+	if (!outFrame.data.empty())
+	{
+		int qp = -1;
+		if (vpx_codec_control(m_codec.get(), VP8E_GET_LAST_QUANTIZER_64, &qp) == VPX_CODEC_OK)
+			outFrame.qp = qp;
+	}
+	return true;
+}
+
+bool VpxEncoder::Encode(const Nv12View& picture, uint64_t timestampNs, EncodedFrame& outFrame)
+{
+	const int chromaWidth = picture.u.width;
+	const int chromaHeight = picture.u.height;
+	const size_t planeSize = static_cast<size_t>(chromaWidth) * chromaHeight;
+	m_chroma.resize(planeSize * 2);
+
+	I420View planar;
+	planar.y = picture.y;
+	const MutableImageView<PixelFormat::Gray8> u(m_chroma.data(), chromaWidth, chromaHeight);
+	const MutableImageView<PixelFormat::Gray8> v(m_chroma.data() + planeSize, chromaWidth, chromaHeight);
+	SplitChroma(picture.u, u, v);
+	planar.u = u;
+	planar.v = v;
+	return Encode(planar, timestampNs, outFrame);
+}
+
+void VpxEncoder::SetRates(int bitrateKbps, int fps)
+{
+	std::lock_guard lock(m_pendingMutex);
+	m_pendingBitrateKbps = std::max(bitrateKbps, 1);
+	m_pendingFps = std::max(fps, 1);
+	m_ratesPending = true;
+}
+
+void VpxEncoder::RequestKeyframe()
+{
+	m_keyframeRequested = true;
+}
+
+VideoEncoderConfig VpxEncoder::GetConfig() const
+{
+	std::lock_guard lock(m_pendingMutex);
+	return m_config;
+}
+
+void VpxEncoder::ApplyPendingRates()
+{
+	int bitrateKbps, fps;
+	{
+		std::lock_guard lock(m_pendingMutex);
+		if (!m_ratesPending)
+			return;
+		m_ratesPending = false;
+		bitrateKbps = m_pendingBitrateKbps;
+		fps = m_pendingFps;
+	}
+
+	// The frame rate only enters through each picture's duration
+	if (bitrateKbps != m_config.bitrateKbps)
+	{
+		m_codecConfig->rc_target_bitrate = static_cast<unsigned int>(bitrateKbps);
+		if (vpx_codec_enc_config_set(m_codec.get(), m_codecConfig.get()) != VPX_CODEC_OK)
+			Logger::Warning(std::format("VP8 rejected the new bitrate: {}", vpx_codec_error(m_codec.get())));
+	}
+
+	std::lock_guard lock(m_pendingMutex);
+	m_config.bitrateKbps = bitrateKbps;
+	m_config.fps = fps;
+}
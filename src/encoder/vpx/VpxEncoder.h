@@ -0,0 +1,53 @@
+#pragma once
+
+#include "../IVideoEncoder.h"
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+struct vpx_codec_ctx;
+struct vpx_codec_enc_cfg;
+
+// VP8 through libvpx in its real-time mode: no lookahead, CBR, one-pass.
+// Threading splits each picture into row bands and token partitions that
+// encode (and later decode) in parallel, so no pictures are buffered.
+class VpxEncoder : public IVideoEncoder
+{
+public:
+	VpxEncoder();
+	~VpxEncoder() override;
+
+	bool Initialize(const VideoEncoderConfig& config) override;
+	void Shutdown() override;
+	bool IsInitialized() const override { return m_initialized; }
+
+	bool Encode(const I420View& picture, uint64_t timestampNs, EncodedFrame& outFrame) override;
+	// Split into I420 first: not every libvpx release takes NV12 for VP8
+	bool Encode(const Nv12View& picture, uint64_t timestampNs, EncodedFrame& outFrame) override;
+
+	void SetRates(int bitrateKbps, int fps) override;
+	void RequestKeyframe() override;
+
+	VideoEncoderConfig GetConfig() const override;
+	std::string_view GetName() const noexcept override { return "libvpx"; }
+
+private:
+	void ApplyPendingRates();
+
+	std::unique_ptr<vpx_codec_ctx> m_codec;
+	std::unique_ptr<vpx_codec_enc_cfg> m_codecConfig;
+	bool m_initialized = false;
+	VideoEncoderConfig m_config;
+	int64_t m_lastPts = -1; // Microseconds; libvpx needs them strictly increasing
+	std::vector<uint8_t> m_chroma; // I420 chroma planes for NV12 input
+
+	// Requests from other threads, applied before the next picture
+	mutable std::mutex m_pendingMutex;
+	int m_pendingBitrateKbps = 0;
+	int m_pendingFps = 0;
+	bool m_ratesPending = false;
+	std::atomic<bool> m_keyframeRequested = false;
+};
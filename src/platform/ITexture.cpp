@@ -41,6 +41,22 @@ std::string_view ITexture::GetTextureFormatName(TextureFormat format) noexcept
 	}
 }
 
+PixelFormat ITexture::GetPixelFormat(TextureFormat format) noexcept
+{
+	switch (format)
+	{
+	case TextureFormat::RGBA8:
+		return PixelFormat::RGBA8;
+	case TextureFormat::RGB8:
+		return PixelFormat::RGB8;
+	case TextureFormat::R8:
+		return PixelFormat::Gray8;
+	case TextureFormat::BGRA8:
+	default:
+		return PixelFormat::BGRA8;
+	}
+}
+
 std::string_view ITexture::GetTextureUsageName(TextureUsage usage) noexcept
 {
 	switch (usage)
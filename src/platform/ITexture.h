@@ -3,6 +3,8 @@
 #include <memory>
 #include <string_view>
 
+#include "../video/ImageView.h"
+
 enum class TextureFormat
 {
 	BGRA8, // 32-bit BGRA (most common for screen capture)
@@ -49,5 +51,7 @@ public:
 
 	static std::unique_ptr<ITexture> Create();
 	static std::string_view GetTextureFormatName(TextureFormat format) noexcept;
+	// Layout of the texture's pixels in CPU memory, for typed ImageViews
+	static PixelFormat GetPixelFormat(TextureFormat format) noexcept;
 	static std::string_view GetTextureUsageName(TextureUsage usage) noexcept;
 };
\ No newline at end of file
@@ -0,0 +1,99 @@
+#include "ProcessMetrics.h"
+
+#include <chrono>
+#include <mutex>
+#include <thread>
+
+#ifdef PLATFORM_WINDOWS
+#include <windows.h>
+#include <psapi.h>
+#elif defined(PLATFORM_LINUX)
+#include <cstdio>
+#include <sys/resource.h>
+#include <unistd.h>
+#endif
+
+namespace
+{
+    constexpr auto kAveragingWindow = std::chrono::milliseconds(500);
+
+    // Total user + kernel CPU time consumed by this process
+    std::chrono::microseconds GetProcessCpuTime()
+    {
+#ifdef PLATFORM_WINDOWS
+        FILETIME creation, exit, kernel, user;
+        if (!GetProcessTimes(GetCurrentProcess(), &creation, &exit, &kernel, &user))
+            return {};
+        auto toTicks = [](const FILETIME& time) {
+            return (static_cast<uint64_t>(time.dwHighDateTime) << 32) | time.dwLowDateTime;
+        };
+        // FILETIME counts 100ns intervals
+        return std::chrono::microseconds((toTicks(kernel) + toTicks(user)) / 10);
+#elif defined(PLATFORM_LINUX)
+        rusage usage;
+        if (getrusage(RUSAGE_SELF, &usage) != 0)
+            return {};
+        auto toMicroseconds = [](const timeval& time) {
+            return static_cast<int64_t>(time.tv_sec) * 1'000'000 + time.tv_usec;
+        };
+        return std::chrono::microseconds(toMicroseconds(usage.ru_utime) + toMicroseconds(usage.ru_stime));
+#else
+        return {};
+#endif
+    }
+
+    uint64_t GetResidentBytes()
+    {
+#ifdef PLATFORM_WINDOWS
+        PROCESS_MEMORY_COUNTERS counters = {};
+        if (!GetProcessMemoryInfo(GetCurrentProcess(), &counters, sizeof(counters)))
+            return 0;
+        return counters.WorkingSetSize;
+#elif defined(PLATFORM_LINUX)
+        // getrusage only reports the peak; statm has the current size in pages
+        FILE* file = std::fopen("/proc/self/statm", "r");
+        if (!file)
+            return 0;
+        unsigned long long totalPages = 0, residentPages = 0;
+        const int fields = std::fscanf(file, "%llu %llu", &totalPages, &residentPages);
+        std::fclose(file);
+        if (fields != 2)
+            return 0;
+        return residentPages * static_cast<uint64_t>(sysconf(_SC_PAGESIZE));
+#else
+        return 0;
+#endif
+    }
+}
+
+ProcessUsage ProcessMetrics::Sample()
+{
+    using Clock = std::chrono::steady_clock;
+
+    static std::mutex mutex;
+    static Clock::time_point lastWall;
+    static std::chrono::microseconds lastCpu{};
+    static ProcessUsage usage;
+
+    std::lock_guard lock(mutex);
+
+    const auto now = Clock::now();
+    if (lastWall == Clock::time_point{})
+    {
+        lastWall = now;
+        lastCpu = GetProcessCpuTime();
+        usage.logicalCores = static_cast<int>(std::thread::hardware_concurrency());
+    }
+    else if (now - lastWall >= kAveragingWindow)
+    {
+        const auto cpu = GetProcessCpuTime();
+        const double wallUs = static_cast<double>(std::chrono::duration_cast<std::chrono::microseconds>(now - lastWall).count());
+        usage.cpuPercent = 100.0 * static_cast<double>((cpu - lastCpu).count()) / wallUs;
+        lastWall = now;
+        lastCpu = cpu;
+    }
+
+    // Cheap enough to read fresh every time
+    usage.residentBytes = GetResidentBytes();
+    return usage;
+}
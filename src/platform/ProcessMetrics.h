@@ -0,0 +1,20 @@
+#pragma once
+
+#include <cstdint>
+
+struct ProcessUsage
+{
+    double cpuPercent = 0.0;        // Process CPU time over the last window, percent of one core (can exceed 100)
+    uint64_t residentBytes = 0;     // Current resident set size
+    int logicalCores = 0;
+};
+
+// Samples this process's CPU time and resident memory. CPU usage is a rate,
+// so it is computed from the difference to the previous sample; samples
+// closer together than the averaging window return the cached value, which
+// keeps per-frame UI polling cheap and the reading stable.
+class ProcessMetrics
+{
+public:
+    static ProcessUsage Sample();
+};
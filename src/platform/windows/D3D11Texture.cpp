@@ -97,58 +97,35 @@ bool D3D11Texture::Update(const void *data, size_t dataSize, size_t rowPitch)
 		return false;
 	}
 
-	// Calculate row pitch if not provided
-	size_t bytesPerPixel = 4; // Default for BGRA8
-	switch (m_format)
-	{
-	case TextureFormat::BGRA8:
-	case TextureFormat::RGBA8:
-		bytesPerPixel = 4;
-		break;
-	case TextureFormat::RGB8:
-		bytesPerPixel = 3;
-		break;
-	case TextureFormat::R8:
-		bytesPerPixel = 1;
-		break;
-	}
-
-	if (rowPitch == 0)
-	{
-		rowPitch = m_width * bytesPerPixel;
-	}
-
-	// Validate data size
-	size_t expectedSize = rowPitch * m_height;
-	if (dataSize < expectedSize)
-	{
-		std::cout << std::format("Data size too small: got {}, expected {}\n", dataSize, expectedSize);
-		return false;
-	}
-
-	// Map texture and copy data
-	D3D11_MAPPED_SUBRESOURCE mapped;
-	HRESULT hr = m_context->Map(m_texture.Get(), 0, D3D11_MAP_WRITE_DISCARD, 0, &mapped);
-	if (FAILED(hr))
-	{
-		std::cout << std::format("Failed to map D3D11 texture: 0x{:x}\n", hr);
-		return false;
-	}
-
-	// Copy row by row to handle different row pitches
-	const uint8_t *srcData = static_cast<const uint8_t *>(data);
-	uint8_t *dstData = static_cast<uint8_t *>(mapped.pData);
-
-	for (int y = 0; y < m_height; ++y)
-	{
-		size_t bytesToCopy = (rowPitch < static_cast<size_t>(mapped.RowPitch)) ? rowPitch : static_cast<size_t>(mapped.RowPitch);
-		memcpy(dstData + y * mapped.RowPitch,
-			   srcData + y * rowPitch,
-			   bytesToCopy);
-	}
-
-	m_context->Unmap(m_texture.Get(), 0);
-	return true;
+	// One switch per upload; the copy below is compiled per pixel format
+	return DispatchPixelFormat(GetPixelFormat(m_format), [&](auto format) {
+		constexpr PixelFormat kFormat = decltype(format)::value;
+
+		// A row pitch of 0 means tightly packed rows
+		const ImageView<kFormat> source(data, m_width, m_height, static_cast<int>(rowPitch));
+
+		// Validate data size
+		if (dataSize < source.SizeBytes())
+		{
+			std::cout << std::format("Data size too small: got {}, expected {}\n", dataSize, source.SizeBytes());
+			return false;
+		}
+
+		// Map texture and copy data
+		D3D11_MAPPED_SUBRESOURCE mapped;
+		HRESULT hr = m_context->Map(m_texture.Get(), 0, D3D11_MAP_WRITE_DISCARD, 0, &mapped);
+		if (FAILED(hr))
+		{
+			std::cout << std::format("Failed to map D3D11 texture: 0x{:x}\n", hr);
+			return false;
+		}
+
+		// Row by row unless both pitches match
+		CopyImage(source, MutableImageView<kFormat>(mapped.pData, m_width, m_height, static_cast<int>(mapped.RowPitch)));
+
+		m_context->Unmap(m_texture.Get(), 0);
+		return true;
+	});
 }
 
 void D3D11Texture::Destroy()
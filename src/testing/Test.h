@@ -0,0 +1,51 @@
+#pragma once
+
+#include <cstdio>
+#include <string>
+#include <vector>
+
+// A minimal test registry, so the tree needs no test framework. TEST(name)
+// defines and registers a test; CHECK() reports a failed expression and
+// carries on, REQUIRE() also ends the test. Each module links its tests into
+// one executable whose main() (TestMain.cpp) runs the tests named with a
+// given prefix, which is how CMake registers every area with ctest (see
+// add_unit_tests() in CMakeLists.txt).
+namespace testing
+{
+	struct TestCase
+	{
+		const char* name;
+		void (*function)();
+	};
+
+	std::vector<TestCase>& Registry();
+	void ReportFailure(const char* file, int line, const std::string& expression);
+
+	struct Registrar
+	{
+		Registrar(const char* name, void (*function)()) { Registry().push_back({ name, function }); }
+	};
+
+	// Thrown by REQUIRE() and caught by the runner
+	struct RequireFailed
+	{
+	};
+}
+
+#define TEST(name)                                                           \
+	static void name();                                                      \
+	static const ::testing::Registrar name##Registrar(#name, &name);         \
+	static void name()
+
+#define CHECK(expression)                                                    \
+	((expression) ? static_cast<void>(0) : ::testing::ReportFailure(__FILE__, __LINE__, #expression))
+
+#define REQUIRE(expression)                                                  \
+	do                                                                       \
+	{                                                                        \
+		if (!(expression))                                                   \
+		{                                                                    \
+			::testing::ReportFailure(__FILE__, __LINE__, #expression);       \
+			throw ::testing::RequireFailed{};                                \
+		}                                                                    \
+	} while (false)
@@ -0,0 +1,65 @@
+#include "Test.h"
+
+#include <exception>
+#include <string_view>
+
+namespace
+{
+	int g_failures = 0;
+}
+
+namespace testing
+{
+	std::vector<TestCase>& Registry()
+	{
+		static std::vector<TestCase> registry;
+		return registry;
+	}
+
+	void ReportFailure(const char* file, int line, const std::string& expression)
+	{
+		std::printf("  %s:%d: CHECK(%s) failed\n", file, line, expression.c_str());
+		++g_failures;
+	}
+}
+
+// Runs every test whose name starts with argv[1], or all of them. Fails when
+// a check fails, a test throws, or the prefix matches nothing.
+int main(int argc, char** argv)
+{
+	const std::string_view prefix = argc > 1 ? argv[1] : "";
+	int ran = 0;
+	int failedTests = 0;
+	for (const testing::TestCase& test : testing::Registry())
+	{
+		if (!std::string_view(test.name).starts_with(prefix))
+			continue;
+
+		std::printf("[ RUN  ] %s\n", test.name);
+		const int failuresBefore = g_failures;
+		try
+		{
+			test.function();
+		}
+		catch (const testing::RequireFailed&)
+		{
+		}
+		catch (const std::exception& e)
+		{
+			std::printf("  threw: %s\n", e.what());
+			++g_failures;
+		}
+		const bool passed = g_failures == failuresBefore;
+		std::printf("[ %s ] %s\n", passed ? " OK " : "FAIL", test.name);
+		failedTests += passed ? 0 : 1;
+		++ran;
+	}
+
+	if (ran == 0)
+	{
+		std::printf("No test matches \"%.*s\"\n", static_cast<int>(prefix.size()), prefix.data());
+		return 1;
+	}
+	std::printf("%d of %d test(s) passed\n", ran - failedTests, ran);
+	return failedTests == 0 ? 0 : 1;
+}
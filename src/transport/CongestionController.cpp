@@ -0,0 +1,322 @@
+#include "CongestionController.h"
+
+#include <algorithm>
+#include <bit>
+#include <cmath>
+
+namespace
+{
+	constexpr auto kBurst = std::chrono::milliseconds(5);
+	constexpr int64_t kReferenceTimeUs = 64000;
+	constexpr int64_t kAckedWindowUs = 500000;
+	constexpr double kDecreaseFactor = 0.85;
+	constexpr double kIncreasePerSecond = 1.08;
+	constexpr double kMaxAheadOfAcked = 1.5;
+	constexpr double kLowLoss = 0.02;
+	constexpr double kHighLoss = 0.10;
+	constexpr size_t kMinLossPackets = 20; // Per loss-based update; fewer say little
+	constexpr double kAssumedFps = 30.0;   // For the additive increase: a packet of an average frame
+	constexpr double kPacketBits = 1200 * 8.0;
+
+	int SequenceDiff(uint16_t a, uint16_t b)
+	{
+		return static_cast<int16_t>(static_cast<uint16_t>(a - b));
+	}
+
+	double ToMs(std::chrono::steady_clock::duration duration)
+	{
+		return std::chrono::duration<double, std::milli>(duration).count();
+	}
+}
+
+CongestionController::CongestionController(const CongestionControlConfig& config)
+	: m_config(config)
+{
+	m_config.minBitrateKbps = std::max(m_config.minBitrateKbps, 10);
+	m_config.maxBitrateKbps = std::max(m_config.maxBitrateKbps, m_config.minBitrateKbps);
+	m_config.startBitrateKbps = std::clamp(m_config.startBitrateKbps, m_config.minBitrateKbps, m_config.maxBitrateKbps);
+	const size_t capacity = std::bit_ceil(std::clamp<size_t>(m_config.historySize, 64, 32768));
+	m_mask = static_cast<uint16_t>(capacity - 1);
+	m_sent.resize(capacity);
+	Reset();
+}
+
+void CongestionController::Reset()
+{
+	for (SentPacket& packet : m_sent)
+		packet.used = false;
+	m_hasReference = false;
+	m_hasFeedbackCount = false;
+	m_trendline.Reset();
+	m_currentGroup = {};
+	m_previousGroup = {};
+	m_arrivals.clear();
+	m_arrivalBytes = 0;
+	m_firstArrivalUs = -1;
+	m_ackedKbps = 0.0;
+	m_rateState = RateState::Increase;
+	m_delayBasedKbps = m_lossBasedKbps = m_config.startBitrateKbps;
+	m_lastRateUpdate = m_lastDecrease = m_lastLossUpdate = m_lastLossDecrease = {};
+	m_hasLinkCapacity = false;
+	m_lossReported = m_lossLost = 0;
+	m_lossRate = 0.0;
+	m_rttMs = 0.0;
+	m_statistics = {};
+	UpdateTarget();
+}
+
+void CongestionController::OnSendPackets(RtpPacket* packets, size_t count, Clock::time_point now)
+{
+	for (size_t i = 0; i < count; ++i)
+	{
+		if (!packets[i].SetTransportSequenceNumber(m_nextSequence))
+			continue;
+		SentPacket& sent = m_sent[m_nextSequence & m_mask];
+		sent.used = true;
+		sent.sequenceNumber = m_nextSequence;
+		sent.size = packets[i].size;
+		sent.sendTime = now;
+		++m_nextSequence;
+	}
+}
+
+void CongestionController::OnTransportFeedback(const RtcpTransportFeedback& feedback, Clock::time_point now)
+{
+	// The reference time wraps every 12 days or so; steps between feedback
+	// packets are small either way
+	if (!m_hasReference)
+	{
+		m_hasReference = true;
+		m_referenceUs = static_cast<int64_t>(feedback.referenceTime) * kReferenceTimeUs;
+	}
+	else
+	{
+		const int32_t step = static_cast<int32_t>((feedback.referenceTime - m_lastReferenceTime) << 8) >> 8;
+		m_referenceUs += static_cast<int64_t>(step) * kReferenceTimeUs;
+	}
+	m_lastReferenceTime = feedback.referenceTime;
+
+	++m_statistics.feedbackReceived;
+	if (m_hasFeedbackCount && feedback.feedbackCount != m_nextFeedbackCount)
+		m_statistics.feedbackLost += static_cast<uint8_t>(feedback.feedbackCount - m_nextFeedbackCount);
+	m_hasFeedbackCount = true;
+	m_nextFeedbackCount = static_cast<uint8_t>(feedback.feedbackCount + 1);
+
+	size_t reported = 0;
+	size_t lost = 0;
+	double minRttMs = -1.0;
+	for (size_t i = 0; i < feedback.arrivalOffsetsUs.size(); ++i)
+	{
+		const uint16_t sequence = static_cast<uint16_t>(feedback.baseSequenceNumber + i);
+		const SentPacket& sent = m_sent[sequence & m_mask];
+		// Sequence numbers ahead of what was sent are from before a restart
+		if (!sent.used || sent.sequenceNumber != sequence || SequenceDiff(sequence, m_nextSequence) >= 0)
+			continue;
+		++reported;
+		if (feedback.arrivalOffsetsUs[i] == RtcpTransportFeedback::kNotReceived)
+		{
+			++lost;
+			continue;
+		}
+		OnPacketArrived(sent, m_referenceUs + feedback.arrivalOffsetsUs[i]);
+		const double rttMs = ToMs(now - sent.sendTime);
+		minRttMs = minRttMs < 0.0 ? rttMs : std::min(minRttMs, rttMs);
+	}
+	if (reported == 0)
+		return;
+
+	// The newest packet's wait for the feedback interval inflates every
+	// sample a little; the smallest is the closest to the path's round trip
+	if (minRttMs >= 0.0)
+		m_rttMs = m_rttMs > 0.0 ? m_rttMs + (minRttMs - m_rttMs) / 8.0 : minRttMs;
+	m_statistics.packetsReported += reported;
+	m_statistics.packetsLost += lost;
+
+	UpdateDelayBased(m_trendline.GetState(), now);
+	UpdateLossBased(reported, lost, now);
+	UpdateTarget();
+}
+
+void CongestionController::OnPacketArrived(const SentPacket& packet, int64_t arrivalUs)
+{
+	UpdateAckedBitrate(arrivalUs, packet.size);
+
+	PacketGroup& group = m_currentGroup;
+	if (group.valid && packet.sendTime < group.firstSend)
+		return; // Reordered from an earlier group
+
+	if (group.valid && packet.sendTime - group.firstSend <= kBurst)
+	{
+		group.lastSend = std::max(group.lastSend, packet.sendTime);
+		group.lastArrivalUs = std::max(group.lastArrivalUs, arrivalUs);
+		return;
+	}
+
+	// A new group: the one just completed can be compared with the one before
+	if (group.valid && m_previousGroup.valid)
+	{
+		const double sendDeltaMs = ToMs(group.lastSend - m_previousGroup.lastSend);
+		const double arrivalDeltaMs = static_cast<double>(group.lastArrivalUs - m_previousGroup.lastArrivalUs) / 1000.0;
+		const BandwidthUsage previous = m_trendline.GetState();
+		const BandwidthUsage usage =
+			m_trendline.Update(sendDeltaMs, arrivalDeltaMs, static_cast<double>(group.lastArrivalUs) / 1000.0);
+		if (usage == BandwidthUsage::Overusing && previous != BandwidthUsage::Overusing)
+			++m_statistics.overuseEvents;
+	}
+	if (group.valid)
+		m_previousGroup = group;
+	group.valid = true;
+	group.firstSend = group.lastSend = packet.sendTime;
+	group.lastArrivalUs = arrivalUs;
+}
+
+void CongestionController::UpdateAckedBitrate(int64_t arrivalUs, uint32_t size)
+{
+	if (m_firstArrivalUs < 0)
+		m_firstArrivalUs = arrivalUs;
+	m_arrivals.emplace_back(arrivalUs, size);
+	m_arrivalBytes += size;
+
+	const int64_t newest = std::max(arrivalUs, m_arrivals.front().first);
+	while (!m_arrivals.empty() && m_arrivals.front().first <= newest - kAckedWindowUs)
+	{
+		m_arrivalBytes -= m_arrivals.front().second;
+		m_arrivals.pop_front();
+	}
+	if (newest - m_firstArrivalUs >= kAckedWindowUs)
+		m_ackedKbps = static_cast<double>(m_arrivalBytes) * 8.0 / (kAckedWindowUs / 1000.0);
+}
+
+void CongestionController::UpdateLinkCapacity(double ackedKbps)
+{
+	// Where the rate last overused, and how much that varies, normalized so
+	// the deviation scales with the rate
+	if (!m_hasLinkCapacity)
+	{
+		m_hasLinkCapacity = true;
+		m_linkCapacityKbps = ackedKbps;
+		return;
+	}
+	m_linkCapacityKbps = 0.95 * m_linkCapacityKbps + 0.05 * ackedKbps;
+	const double error = m_linkCapacityKbps - ackedKbps;
+	m_linkCapacityVariance = std::clamp(0.95 * m_linkCapacityVariance +
+											0.05 * error * error / std::max(m_linkCapacityKbps, 1.0),
+										0.4, 2.5);
+}
+
+void CongestionController::UpdateDelayBased(BandwidthUsage usage, Clock::time_point now)
+{
+	const double elapsedSeconds =
+		m_lastRateUpdate == Clock::time_point{} ? 0.0 : std::min(ToMs(now - m_lastRateUpdate) / 1000.0, 1.0);
+	m_lastRateUpdate = now;
+
+	switch (usage)
+	{
+	case BandwidthUsage::Overusing:
+		m_rateState = RateState::Decrease;
+		break;
+	case BandwidthUsage::Underusing:
+		m_rateState = RateState::Hold; // Let the queue drain before growing again
+		break;
+	case BandwidthUsage::Normal:
+		if (m_rateState == RateState::Hold)
+			m_rateState = RateState::Increase;
+		break;
+	}
+
+	const double capacityDeviation = std::sqrt(m_linkCapacityVariance * m_linkCapacityKbps);
+	if (m_rateState == RateState::Increase)
+	{
+		// Far above where it last overused: that no longer says anything
+		if (m_hasLinkCapacity && m_ackedKbps > m_linkCapacityKbps + 3.0 * capacityDeviation)
+			m_hasLinkCapacity = false;
+
+		if (m_hasLinkCapacity)
+		{
+			// About one packet per response time, so the queue probes gently
+			const double bitsPerFrame = m_delayBasedKbps * 1000.0 / kAssumedFps;
+			const double packetsPerFrame = std::ceil(bitsPerFrame / kPacketBits);
+			const double responseSeconds = (m_rttMs + 100.0) / 1000.0;
+			const double kbpsPerSecond = std::max(4.0, bitsPerFrame / packetsPerFrame / responseSeconds / 1000.0);
+			m_delayBasedKbps += kbpsPerSecond * elapsedSeconds;
+		}
+		else
+		{
+			m_delayBasedKbps *= std::pow(kIncreasePerSecond, elapsedSeconds);
+		}
+		if (m_ackedKbps > 0.0)
+			m_delayBasedKbps = std::min(m_delayBasedKbps, kMaxAheadOfAcked * m_ackedKbps + 10.0);
+	}
+	else if (m_rateState == RateState::Decrease)
+	{
+		// Overuse lasts until the queue has drained, which takes a round
+		// trip to show; cutting again sooner only compounds the first cut,
+		// unless the delivered rate has collapsed meanwhile
+		const auto reaction = std::chrono::duration<double, std::milli>(std::clamp(m_rttMs, 10.0, 200.0));
+		const double delivered = m_ackedKbps > 0.0 ? m_ackedKbps : m_delayBasedKbps;
+		if (now - m_lastDecrease >= reaction || delivered < m_delayBasedKbps / 2.0)
+		{
+			m_delayBasedKbps = std::min(m_delayBasedKbps, kDecreaseFactor * delivered);
+			if (m_ackedKbps > 0.0)
+				UpdateLinkCapacity(m_ackedKbps);
+			m_lastDecrease = now;
+		}
+		m_rateState = RateState::Hold;
+	}
+	m_delayBasedKbps = std::clamp(m_delayBasedKbps, static_cast<double>(m_config.minBitrateKbps),
+								  static_cast<double>(m_config.maxBitrateKbps));
+}
+
+void CongestionController::UpdateLossBased(size_t reported, size_t lost, Clock::time_point now)
+{
+	m_lossReported += reported;
+	m_lossLost += lost;
+	if (m_lossReported < kMinLossPackets)
+		return;
+
+	m_lossRate = static_cast<double>(m_lossLost) / static_cast<double>(m_lossReported);
+	m_lossReported = m_lossLost = 0;
+	const double elapsedSeconds =
+		m_lastLossUpdate == Clock::time_point{} ? 0.0 : std::min(ToMs(now - m_lastLossUpdate) / 1000.0, 1.0);
+	m_lastLossUpdate = now;
+
+	if (m_lossRate < kLowLoss)
+	{
+		m_lossBasedKbps *= std::pow(kIncreasePerSecond, elapsedSeconds);
+	}
+	else if (m_lossRate > kHighLoss)
+	{
+		// Once per round trip at most: the loss already counted may be what
+		// the previous decrease answered
+		const auto interval = std::chrono::duration<double, std::milli>(300.0 + m_rttMs);
+		if (now - m_lastLossDecrease >= interval)
+		{
+			m_lossBasedKbps *= 1.0 - 0.5 * m_lossRate;
+			m_lastLossDecrease = now;
+		}
+	}
+	m_lossBasedKbps = std::clamp(m_lossBasedKbps, static_cast<double>(m_config.minBitrateKbps),
+								 static_cast<double>(m_config.maxBitrateKbps));
+}
+
+void CongestionController::UpdateTarget()
+{
+	// The loss-based estimate only ever lowers the delay-based one
+	m_lossBasedKbps = std::min(m_lossBasedKbps, m_delayBasedKbps);
+	m_targetKbps = static_cast<int>(std::lround(m_lossBasedKbps));
+}
+
+CongestionStatistics CongestionController::GetStatistics() const
+{
+	CongestionStatistics statistics = m_statistics;
+	statistics.targetBitrateKbps = m_targetKbps;
+	statistics.delayBasedKbps = static_cast<int>(std::lround(m_delayBasedKbps));
+	statistics.lossBasedKbps = static_cast<int>(std::lround(m_lossBasedKbps));
+	statistics.ackedBitrateKbps = m_ackedKbps;
+	statistics.lossRate = m_lossRate;
+	statistics.rttMs = m_rttMs;
+	statistics.delayTrend = m_trendline.GetModifiedTrend();
+	statistics.delayThreshold = m_trendline.GetThreshold();
+	statistics.usage = m_trendline.GetState();
+	return statistics;
+}
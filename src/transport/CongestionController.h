@@ -0,0 +1,155 @@
+#pragma once
+
+#include "RtcpPacket.h"
+#include "RtpPacketizer.h"
+#include "TrendlineEstimator.h"
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <utility>
+#include <vector>
+
+struct CongestionControlConfig
+{
+	int startBitrateKbps = 1500; // Until feedback says otherwise
+	int minBitrateKbps = 150;	 // Never asks for less; below this a screen is unreadable anyway
+	int maxBitrateKbps = 20000;
+	size_t historySize = 8192; // Sent packets remembered for feedback; seconds of a 20 Mbit/s stream
+};
+
+struct CongestionStatistics
+{
+	int targetBitrateKbps = 0;
+	int delayBasedKbps = 0;
+	int lossBasedKbps = 0;
+	double ackedBitrateKbps = 0.0; // What the receiver got, over the last 500 ms
+	double lossRate = 0.0;		   // Of the last loss-based update
+	double rttMs = 0.0;
+	double delayTrend = 0.0; // Modified trend and the threshold it is compared with
+	double delayThreshold = 0.0;
+	BandwidthUsage usage = BandwidthUsage::Normal;
+	uint64_t feedbackReceived = 0;
+	uint64_t feedbackLost = 0; // Feedback packets that never came, going by their count
+	uint64_t packetsReported = 0;
+	uint64_t packetsLost = 0;
+	uint64_t overuseEvents = 0;
+};
+
+// Sender side of Google Congestion Control (draft-ietf-rmcat-gcc-02 with
+// send-side estimation, as WebRTC does it): estimates what the path can
+// carry from transport-wide feedback and keeps the stream under it, so the
+// bottleneck's queue stays short and so does the latency.
+//
+//   Delay-based  Packets are grouped by send time in 5 ms bursts and the
+//                TrendlineEstimator looks at how their one-way delay
+//                varies. Overuse cuts the rate to 85% of what was actually
+//                delivered; otherwise it grows 8% a second, or by about a
+//                packet per round trip once near the rate that last
+//                overused. It never runs ahead of 1.5x the delivered rate,
+//                so a static screen encoding far below the target does not
+//                lift it without evidence.
+//   Loss-based   Over 10% loss scales the rate by (1 - loss / 2); under 2%
+//                lets it grow 8% a second; in between it holds.
+//
+// The target is the lower of the two. The round trip comes out of the
+// feedback too, for RtpRetransmitter::SetRtt().
+//
+// Not thread-safe: call from the thread that sends the media, which also
+// handles RTCP in this pipeline.
+class CongestionController
+{
+public:
+	using Clock = std::chrono::steady_clock;
+
+	explicit CongestionController(const CongestionControlConfig& config = {});
+
+	// Numbers packets made with a transportSequenceId and remembers their
+	// send time and size. Call just before sending them, on every packet
+	// (media, RTX, FEC), and after FecEncoder::ProtectFrame() has been given
+	// the numbered media packets; packets without the extension are skipped.
+	void OnSendPackets(RtpPacket* packets, size_t count, Clock::time_point now);
+
+	void OnTransportFeedback(const RtcpTransportFeedback& feedback, Clock::time_point now);
+
+	int GetTargetBitrateKbps() const { return m_targetKbps; }
+	double GetRttMs() const { return m_rttMs; }
+	CongestionStatistics GetStatistics() const;
+	void Reset();
+
+private:
+	struct SentPacket
+	{
+		bool used = false;
+		uint16_t sequenceNumber = 0;
+		uint32_t size = 0;
+		Clock::time_point sendTime;
+	};
+
+	// Packets sent within kBurstMs of a group's first make up the group
+	struct PacketGroup
+	{
+		bool valid = false;
+		Clock::time_point firstSend;
+		Clock::time_point lastSend;
+		int64_t lastArrivalUs = 0;
+	};
+
+	enum class RateState
+	{
+		Hold,
+		Increase,
+		Decrease
+	};
+
+	void OnPacketArrived(const SentPacket& packet, int64_t arrivalUs);
+	void UpdateAckedBitrate(int64_t arrivalUs, uint32_t size);
+	void UpdateDelayBased(BandwidthUsage usage, Clock::time_point now);
+	void UpdateLossBased(size_t reported, size_t lost, Clock::time_point now);
+	void UpdateLinkCapacity(double ackedKbps);
+	void UpdateTarget();
+
+	CongestionControlConfig m_config;
+	std::vector<SentPacket> m_sent;
+	uint16_t m_mask = 0;
+	uint16_t m_nextSequence = 0;
+
+	// Receiver clock, unwrapped from the 24-bit reference times
+	bool m_hasReference = false;
+	uint32_t m_lastReferenceTime = 0;
+	int64_t m_referenceUs = 0;
+	bool m_hasFeedbackCount = false;
+	uint8_t m_nextFeedbackCount = 0;
+
+	TrendlineEstimator m_trendline;
+	PacketGroup m_currentGroup;
+	PacketGroup m_previousGroup;
+
+	// Delivered bytes by arrival, for the acked bitrate
+	std::deque<std::pair<int64_t, uint32_t>> m_arrivals;
+	uint64_t m_arrivalBytes = 0;
+	int64_t m_firstArrivalUs = -1;
+	double m_ackedKbps = 0.0; // 0 until a whole window has been seen
+
+	// Delay-based AIMD
+	RateState m_rateState = RateState::Increase;
+	double m_delayBasedKbps = 0.0;
+	Clock::time_point m_lastRateUpdate;
+	Clock::time_point m_lastDecrease;
+	bool m_hasLinkCapacity = false;
+	double m_linkCapacityKbps = 0.0;
+	double m_linkCapacityVariance = 0.4;
+
+	// Loss-based
+	double m_lossBasedKbps = 0.0;
+	size_t m_lossReported = 0;
+	size_t m_lossLost = 0;
+	double m_lossRate = 0.0;
+	Clock::time_point m_lastLossUpdate;
+	Clock::time_point m_lastLossDecrease;
+
+	double m_rttMs = 0.0;
+	int m_targetKbps = 0;
+	CongestionStatistics m_statistics;
+};
@@ -0,0 +1,289 @@
+#include "FecDecoder.h"
+#include "RtpDepacketizer.h"
+#include "../video/Xor.h"
+
+#include <algorithm>
+#include <bit>
+#include <cstring>
+
+namespace
+{
+	constexpr size_t kFecFixedHeaderSize = 10; // Up to the mask
+
+	// Signed distance from b to a, in the 16-bit sequence number space
+	int SequenceDiff(uint16_t a, uint16_t b)
+	{
+		return static_cast<int16_t>(static_cast<uint16_t>(a - b));
+	}
+
+	uint16_t Read16(const uint8_t* data)
+	{
+		return static_cast<uint16_t>(data[0] << 8 | data[1]);
+	}
+
+	uint32_t Read32(const uint8_t* data)
+	{
+		return static_cast<uint32_t>(Read16(data)) << 16 | Read16(data + 2);
+	}
+}
+
+FecDecoder::FecDecoder(size_t capacity)
+{
+	const size_t slots = std::bit_ceil(std::clamp<size_t>(capacity, 128, 32768));
+	m_mask = static_cast<uint16_t>(slots - 1);
+	m_slots.resize(slots);
+	m_storage.resize(slots * kMaxPacketSize);
+	m_pending.resize(kMaxPendingFec);
+	for (PendingFec& fec : m_pending)
+		fec.payload.resize(kMaxPacketSize);
+}
+
+void FecDecoder::Reset()
+{
+	for (MediaSlot& slot : m_slots)
+		slot.used = false;
+	for (PendingFec& fec : m_pending)
+		fec.used = false;
+	m_hasMedia = false;
+	m_statistics = {};
+}
+
+bool FecDecoder::IsPresent(uint16_t sequenceNumber) const
+{
+	const MediaSlot& slot = m_slots[sequenceNumber & m_mask];
+	return slot.used && slot.sequenceNumber == sequenceNumber;
+}
+
+uint8_t* FecDecoder::SlotData(uint16_t sequenceNumber)
+{
+	return m_storage.data() + static_cast<size_t>(sequenceNumber & m_mask) * kMaxPacketSize;
+}
+
+bool FecDecoder::Protects(const PendingFec& fec, uint16_t sequenceNumber) const
+{
+	const int offset = SequenceDiff(sequenceNumber, fec.sequenceBase);
+	return fec.used && offset >= 0 && offset < fec.maskBits && ((fec.mask[offset / 64] >> (offset % 64)) & 1);
+}
+
+void FecDecoder::Release(PendingFec& fec)
+{
+	fec.used = false;
+}
+
+void FecDecoder::StoreMedia(const uint8_t* data, size_t size)
+{
+	const uint16_t sequence = Read16(data + 2);
+	MediaSlot& slot = m_slots[sequence & m_mask];
+	slot.used = true;
+	slot.sequenceNumber = sequence;
+	slot.size = static_cast<uint16_t>(size);
+	std::memcpy(SlotData(sequence), data, size);
+
+	if (!m_hasMedia || SequenceDiff(sequence, m_highest) > 0)
+		m_highest = sequence;
+	m_hasMedia = true;
+}
+
+void FecDecoder::OnMediaPacket(const uint8_t* data, size_t size, std::vector<RtpSlice>& recovered)
+{
+	RtpHeader header;
+	if (size > kMaxPacketSize || !ParseRtpHeader(data, size, header) || IsPresent(header.sequenceNumber))
+		return;
+	m_mediaSsrc = header.ssrc;
+	StoreMedia(data, size);
+
+	// FEC packets whose media has left the ring can no longer be used
+	for (PendingFec& fec : m_pending)
+	{
+		if (fec.used && SequenceDiff(m_highest, fec.sequenceBase) > m_mask / 2)
+		{
+			++(fec.recovered ? m_statistics.fecPacketsRedundant : m_statistics.fecPacketsUnusable);
+			Release(fec);
+		}
+	}
+	// Most packets arrive with nothing pending on them
+	if (std::any_of(m_pending.begin(), m_pending.end(),
+					[&](const PendingFec& fec) { return Protects(fec, header.sequenceNumber); }))
+		TryRecover(recovered);
+}
+
+void FecDecoder::OnFecPacket(const uint8_t* data, size_t size, std::vector<RtpSlice>& recovered)
+{
+	RtpHeader header;
+	if (!ParseRtpHeader(data, size, header) || header.payloadSize < kFecFixedHeaderSize + 2 ||
+		(header.payload[0] & 0xC0) != 0)
+	{
+		++m_statistics.fecPacketsDiscarded;
+		return;
+	}
+	++m_statistics.fecPacketsReceived;
+
+	// Oldest pending packet makes room when all are in use
+	PendingFec* fec = nullptr;
+	for (PendingFec& candidate : m_pending)
+	{
+		if (!candidate.used)
+		{
+			fec = &candidate;
+			break;
+		}
+		if (!fec || SequenceDiff(candidate.sequenceBase, fec->sequenceBase) < 0)
+			fec = &candidate;
+	}
+	if (fec->used)
+	{
+		++(fec->recovered ? m_statistics.fecPacketsRedundant : m_statistics.fecPacketsUnusable);
+		Release(*fec);
+	}
+
+	const uint8_t* fecHeader = header.payload;
+	const size_t available = header.payloadSize;
+	fec->mask = {};
+	fec->maskBits = 0;
+	size_t offset = kFecFixedHeaderSize;
+	// 15 bits, then 31, then 64, until a K bit says the mask ends
+	const uint16_t first = Read16(fecHeader + offset);
+	offset += 2;
+	for (int i = 0; i < 15; ++i)
+		fec->mask[0] |= static_cast<uint64_t>((first >> (14 - i)) & 1) << i;
+	fec->maskBits = 15;
+	if (!(first & 0x8000))
+	{
+		if (available < offset + 4)
+		{
+			++m_statistics.fecPacketsDiscarded;
+			return;
+		}
+		const uint32_t second = Read32(fecHeader + offset);
+		offset += 4;
+		for (int i = 0; i < 31; ++i)
+			fec->mask[0] |= static_cast<uint64_t>((second >> (30 - i)) & 1) << (15 + i);
+		fec->maskBits = 46;
+		if (!(second & 0x80000000))
+		{
+			if (available < offset + 8)
+			{
+				++m_statistics.fecPacketsDiscarded;
+				return;
+			}
+			const uint64_t third = static_cast<uint64_t>(Read32(fecHeader + offset)) << 32 | Read32(fecHeader + offset + 4);
+			offset += 8;
+			for (int i = 0; i < 64; ++i)
+			{
+				const int bit = 46 + i;
+				fec->mask[bit / 64] |= ((third >> (63 - i)) & 1) << (bit % 64);
+			}
+			fec->maskBits = 110;
+		}
+	}
+	if (available - offset > kMaxPacketSize - kRtpHeaderSize)
+	{
+		++m_statistics.fecPacketsDiscarded;
+		return;
+	}
+
+	fec->used = true;
+	fec->recovered = false;
+	fec->byte0 = fecHeader[0];
+	fec->byte1 = fecHeader[1];
+	fec->lengthRecovery = Read16(fecHeader + 2);
+	fec->timestampRecovery = Read32(fecHeader + 4);
+	fec->sequenceBase = Read16(fecHeader + 8);
+	fec->payloadSize = static_cast<uint16_t>(available - offset);
+	std::memcpy(fec->payload.data(), fecHeader + offset, fec->payloadSize);
+
+	TryRecover(recovered);
+}
+
+void FecDecoder::TryRecover(std::vector<RtpSlice>& recovered)
+{
+	// Each recovery can complete another FEC packet, so go round until
+	// nothing changes. The pending list is short enough to scan whole.
+	bool progress = true;
+	while (progress)
+	{
+		progress = false;
+		for (PendingFec& fec : m_pending)
+		{
+			if (!fec.used)
+				continue;
+			int missingCount = 0;
+			uint16_t missing = 0;
+			for (int i = 0; i < fec.maskBits && missingCount < 2; ++i)
+			{
+				if (!((fec.mask[i / 64] >> (i % 64)) & 1))
+					continue;
+				const uint16_t sequence = static_cast<uint16_t>(fec.sequenceBase + i);
+				if (!IsPresent(sequence))
+				{
+					++missingCount;
+					missing = sequence;
+				}
+			}
+			if (missingCount == 0)
+			{
+				// Everything arrived (or was recovered); this one is spent
+				if (!fec.recovered)
+					++m_statistics.fecPacketsRedundant;
+				Release(fec);
+			}
+			else if (missingCount == 1 && m_hasMedia && Recover(fec, missing, recovered))
+			{
+				progress = true;
+			}
+		}
+	}
+}
+
+bool FecDecoder::Recover(PendingFec& fec, uint16_t missing, std::vector<RtpSlice>& recovered)
+{
+	uint8_t byte0 = fec.byte0;
+	uint8_t byte1 = fec.byte1;
+	uint16_t length = fec.lengthRecovery;
+	uint32_t timestamp = fec.timestampRecovery;
+
+	uint8_t* out = SlotData(missing);
+	std::memcpy(out + kRtpHeaderSize, fec.payload.data(), fec.payloadSize);
+	for (int i = 0; i < fec.maskBits; ++i)
+	{
+		const uint16_t sequence = static_cast<uint16_t>(fec.sequenceBase + i);
+		if (sequence == missing || !((fec.mask[i / 64] >> (i % 64)) & 1))
+			continue;
+		const uint8_t* media = SlotData(sequence);
+		const size_t mediaPayload = m_slots[sequence & m_mask].size - kRtpHeaderSize;
+		byte0 ^= media[0];
+		byte1 ^= media[1];
+		length ^= static_cast<uint16_t>(mediaPayload);
+		timestamp ^= Read32(media + 4);
+		XorInto(out + kRtpHeaderSize, media + kRtpHeaderSize, std::min<size_t>(mediaPayload, fec.payloadSize));
+	}
+	if (length > fec.payloadSize)
+	{
+		// Inconsistent with the packets it claims to protect
+		Release(fec);
+		++m_statistics.fecPacketsUnusable;
+		return false;
+	}
+
+	out[0] = static_cast<uint8_t>(0x80 | (byte0 & 0x3F));
+	out[1] = byte1;
+	out[2] = static_cast<uint8_t>(missing >> 8);
+	out[3] = static_cast<uint8_t>(missing);
+	out[4] = static_cast<uint8_t>(timestamp >> 24);
+	out[5] = static_cast<uint8_t>(timestamp >> 16);
+	out[6] = static_cast<uint8_t>(timestamp >> 8);
+	out[7] = static_cast<uint8_t>(timestamp);
+	out[8] = static_cast<uint8_t>(m_mediaSsrc >> 24);
+	out[9] = static_cast<uint8_t>(m_mediaSsrc >> 16);
+	out[10] = static_cast<uint8_t>(m_mediaSsrc >> 8);
+	out[11] = static_cast<uint8_t>(m_mediaSsrc);
+
+	MediaSlot& slot = m_slots[missing & m_mask];
+	slot.used = true;
+	slot.sequenceNumber = missing;
+	slot.size = static_cast<uint16_t>(kRtpHeaderSize + length);
+	recovered.push_back({ out, slot.size });
+	fec.recovered = true;
+	++m_statistics.packetsRecovered;
+	return true;
+}
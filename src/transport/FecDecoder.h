@@ -0,0 +1,86 @@
+#pragma once
+
+#include "RtpPacketizer.h"
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+struct FecDecoderStatistics
+{
+	uint64_t fecPacketsReceived = 0;
+	uint64_t packetsRecovered = 0;
+	uint64_t fecPacketsRedundant = 0; // Nothing they protect went missing
+	uint64_t fecPacketsUnusable = 0;  // Expired with two or more of their packets missing
+	uint64_t fecPacketsDiscarded = 0; // Malformed, or a format other than the flexible mask
+};
+
+// Receive side of FecEncoder: rebuilds lost media packets from FlexFEC
+// packets (RFC 8627, flexible mask). Keeps copies of recent media packets
+// in a ring like the jitter buffer's and the FEC packets that cannot be
+// used yet; whenever all but one of an FEC packet's media packets are
+// present, XORing them into it recovers the missing one, and each recovery
+// may in turn complete another FEC packet.
+//
+// Recovered packets are whole RTP packets of the media stream: insert them
+// into the jitter buffer like received ones, and report them to the
+// NackGenerator so they are not NACKed. Not thread-safe.
+class FecDecoder
+{
+public:
+	explicit FecDecoder(size_t capacity = 1024);
+
+	// A media packet as received, or restored from RTX. Appends the packets
+	// it made recoverable to `recovered`; they point into the decoder's
+	// storage and stay valid until the next call.
+	void OnMediaPacket(const uint8_t* data, size_t size, std::vector<RtpSlice>& recovered);
+	// An FEC packet, with its RTP header
+	void OnFecPacket(const uint8_t* data, size_t size, std::vector<RtpSlice>& recovered);
+	void Reset();
+
+	const FecDecoderStatistics& GetStatistics() const { return m_statistics; }
+
+	static constexpr size_t kMaxPacketSize = 1500;
+	static constexpr int kMaxPendingFec = 64;
+
+private:
+	struct MediaSlot
+	{
+		bool used = false;
+		uint16_t sequenceNumber = 0;
+		uint16_t size = 0;
+	};
+
+	struct PendingFec
+	{
+		bool used = false;
+		bool recovered = false; // Has repaired a packet
+		uint16_t sequenceBase = 0;
+		int maskBits = 0;
+		std::array<uint64_t, 2> mask = {}; // Bit i protects sequenceBase + i
+		uint8_t byte0 = 0;				   // P, X, CC recovery
+		uint8_t byte1 = 0;				   // Marker and payload type recovery
+		uint16_t lengthRecovery = 0;
+		uint32_t timestampRecovery = 0;
+		uint16_t payloadSize = 0;
+		std::vector<uint8_t> payload; // kMaxPacketSize, allocated once
+	};
+
+	bool IsPresent(uint16_t sequenceNumber) const;
+	uint8_t* SlotData(uint16_t sequenceNumber);
+	void StoreMedia(const uint8_t* data, size_t size);
+	bool Protects(const PendingFec& fec, uint16_t sequenceNumber) const;
+	void TryRecover(std::vector<RtpSlice>& recovered);
+	bool Recover(PendingFec& fec, uint16_t missing, std::vector<RtpSlice>& recovered);
+	void Release(PendingFec& fec);
+
+	std::vector<MediaSlot> m_slots;
+	std::vector<uint8_t> m_storage; // kMaxPacketSize bytes per slot
+	uint16_t m_mask = 0;
+	bool m_hasMedia = false;
+	uint32_t m_mediaSsrc = 0;
+	uint16_t m_highest = 0;
+	std::vector<PendingFec> m_pending;
+	FecDecoderStatistics m_statistics;
+};
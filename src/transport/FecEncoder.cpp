@@ -0,0 +1,188 @@
+#include "FecEncoder.h"
+#include "../video/Xor.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <random>
+
+namespace
+{
+	constexpr uint8_t kRtpVersion = 2;
+
+	void Write16(uint8_t* out, uint16_t value)
+	{
+		out[0] = static_cast<uint8_t>(value >> 8);
+		out[1] = static_cast<uint8_t>(value);
+	}
+
+	void Write32(uint8_t* out, uint32_t value)
+	{
+		Write16(out, static_cast<uint16_t>(value >> 16));
+		Write16(out + 2, static_cast<uint16_t>(value));
+	}
+
+	// The FlexFEC flexible mask: 15 bits, then 31 more, then 64 more, each
+	// group but the last led by a K bit saying whether it is the last
+	size_t WriteMask(uint64_t mask, int bits, uint8_t* out)
+	{
+		uint16_t first = 0;
+		for (int i = 0; i < std::min(bits, 15); ++i)
+			first |= static_cast<uint16_t>(((mask >> i) & 1) << (14 - i));
+		if (bits <= 15)
+		{
+			Write16(out, static_cast<uint16_t>(0x8000 | first));
+			return 2;
+		}
+		uint32_t second = 0x80000000;
+		for (int i = 15; i < bits; ++i)
+			second |= static_cast<uint32_t>((mask >> i) & 1) << (30 - (i - 15));
+		Write16(out, first);
+		Write32(out + 2, second);
+		return 6;
+	}
+}
+
+FecEncoder::FecEncoder(const FecConfig& config)
+	: m_config(config)
+{
+	std::random_device random;
+	if (!m_config.ssrc)
+		m_config.ssrc = random() | 1;
+	m_sequenceNumber = static_cast<uint16_t>(random());
+	m_config.maxOverhead = std::clamp(m_config.maxOverhead, 0.0, 1.0);
+	if (m_config.transportSequenceId > 14)
+		m_config.transportSequenceId = 0;
+}
+
+void FecEncoder::SetLossRate(double lossRate)
+{
+	lossRate = std::clamp(lossRate, 0.0, 1.0);
+	// Reports over short intervals are noisy: follow a rise quickly, a fall
+	// slowly, and neither in one step
+	m_lossRate += (lossRate - m_lossRate) / (lossRate > m_lossRate ? 2.0 : 8.0);
+}
+
+void FecEncoder::SetProtection(double delta, double keyframe)
+{
+	m_fixedDelta = delta;
+	m_fixedKeyframe = keyframe;
+}
+
+double FecEncoder::GetProtection(bool keyframe) const
+{
+	const double fixed = keyframe ? m_fixedKeyframe : m_fixedDelta;
+	const double protection =
+		fixed >= 0.0 ? fixed : m_lossRate * (keyframe ? m_config.keyframeFactor : m_config.deltaFactor);
+	return std::clamp(protection, 0.0, m_config.maxOverhead);
+}
+
+size_t FecEncoder::ProtectFrame(const RtpPacket* packets, size_t count, bool keyframe, std::vector<RtpPacket>& out)
+{
+	const double protection = GetProtection(keyframe);
+	if (count == 0 || protection <= 0.0)
+		return 0;
+
+	// Blocks of consecutive sequence numbers, and the FEC packets each needs
+	m_blocks.clear();
+	size_t fecTotal = 0;
+	uint32_t maxPayload = 0;
+	for (size_t i = 0; i < count;)
+	{
+		int size = 1;
+		while (i + size < count && size < kMaxBlockPackets &&
+			   packets[i + size].GetSequenceNumber() == static_cast<uint16_t>(packets[i].GetSequenceNumber() + size))
+			++size;
+		const int fecCount = std::clamp(static_cast<int>(std::ceil(size * protection - 1e-9)), 1, size);
+		m_blocks.push_back({ i, size, fecCount });
+		fecTotal += static_cast<size_t>(fecCount);
+		for (int n = 0; n < size; ++n)
+			maxPayload = std::max(maxPayload, packets[i + n].size - static_cast<uint32_t>(kRtpHeaderSize));
+		i += static_cast<size_t>(size);
+	}
+
+	// Sized before any FEC packet points into it
+	const size_t stride = maxPayload;
+	m_payloads.resize(fecTotal * stride);
+	std::memset(m_payloads.data(), 0, m_payloads.size());
+
+	size_t fecIndex = 0;
+	for (const Block& block : m_blocks)
+	{
+		for (int j = 0; j < block.fecCount; ++j, ++fecIndex)
+		{
+			uint8_t* payload = m_payloads.data() + fecIndex * stride;
+			uint8_t recoveredByte0 = 0;
+			uint8_t recoveredByte1 = 0;
+			uint16_t lengthRecovery = 0;
+			uint32_t timestampRecovery = 0;
+			uint32_t payloadSize = 0;
+			uint64_t mask = 0;
+			for (int n = j; n < block.size; n += block.fecCount)
+			{
+				const RtpPacket& media = packets[block.first + n];
+				recoveredByte0 ^= media.header[0];
+				recoveredByte1 ^= media.header[1];
+				lengthRecovery ^= static_cast<uint16_t>(media.size - kRtpHeaderSize);
+				timestampRecovery ^= media.GetTimestamp();
+				payloadSize = std::max(payloadSize, media.size - static_cast<uint32_t>(kRtpHeaderSize));
+				mask |= uint64_t(1) << n;
+
+				// Everything after the fixed RTP header, gathered from the slices
+				RtpSlice slices[RtpPacket::kMaxSlices];
+				const int sliceCount = media.GetSlices(slices);
+				size_t skip = kRtpHeaderSize;
+				uint8_t* target = payload;
+				for (int s = 0; s < sliceCount; ++s)
+				{
+					const size_t skipped = std::min(skip, slices[s].size);
+					skip -= skipped;
+					XorInto(target, slices[s].data + skipped, slices[s].size - skipped);
+					target += slices[s].size - skipped;
+				}
+			}
+
+			const RtpPacket& firstMedia = packets[block.first];
+			RtpPacket& fec = out.emplace_back();
+			uint8_t* header = fec.header.data();
+			header[0] = static_cast<uint8_t>(kRtpVersion << 6 | (m_config.transportSequenceId ? 0x10 : 0));
+			header[1] = m_config.payloadType & 0x7F;
+			Write16(header + 2, m_sequenceNumber++);
+			Write32(header + 4, firstMedia.GetTimestamp());
+			Write32(header + 8, m_config.ssrc);
+			size_t rtpHeaderSize = kRtpHeaderSize;
+			if (m_config.transportSequenceId)
+			{
+				WriteTransportSequenceExtension(m_config.transportSequenceId, header + kRtpHeaderSize);
+				rtpHeaderSize += kTransportSequenceExtensionSize;
+			}
+
+			uint8_t* fecHeader = header + rtpHeaderSize;
+			fecHeader[0] = recoveredByte0 & 0x3F; // R and F clear: flexible mask
+			fecHeader[1] = recoveredByte1;
+			Write16(fecHeader + 2, lengthRecovery);
+			Write32(fecHeader + 4, timestampRecovery);
+			Write16(fecHeader + 8, firstMedia.GetSequenceNumber());
+			const size_t fecHeaderSize = 10 + WriteMask(mask, block.size, fecHeader + 10);
+
+			fec.headerSize = static_cast<uint8_t>(rtpHeaderSize + fecHeaderSize);
+			fec.chunks[fec.chunkCount++] = { payload, payloadSize };
+			fec.size = static_cast<uint32_t>(fec.headerSize + payloadSize);
+			m_statistics.fecBytes += fec.size;
+		}
+	}
+
+	++m_statistics.framesProtected;
+	m_statistics.mediaPackets += count;
+	m_statistics.fecPackets += fecTotal;
+	return fecTotal;
+}
+
+FecStatistics FecEncoder::GetStatistics() const
+{
+	FecStatistics statistics = m_statistics;
+	statistics.lossRate = m_lossRate;
+	statistics.deltaProtection = GetProtection(false);
+	statistics.keyframeProtection = GetProtection(true);
+	return statistics;
+}
@@ -0,0 +1,89 @@
+#pragma once
+
+#include "RtpPacketizer.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+struct FecConfig
+{
+	uint8_t payloadType = 98;
+	uint32_t ssrc = 0;			  // 0 picks a random one
+	double maxOverhead = 0.5;	  // FEC packets per media packet, at most
+	double deltaFactor = 4.0;	 // Protection of delta frames, as a multiple of the loss rate
+	double keyframeFactor = 8.0; // Keyframes get more: losing one freezes the picture until the next
+	uint8_t transportSequenceId = 0; // As in RtpPacketizerConfig: FEC packets count towards congestion control too
+};
+
+struct FecStatistics
+{
+	uint64_t framesProtected = 0;
+	uint64_t mediaPackets = 0; // Of protected frames
+	uint64_t fecPackets = 0;
+	uint64_t fecBytes = 0;
+	double lossRate = 0.0; // As smoothed here
+	double deltaProtection = 0.0;
+	double keyframeProtection = 0.0;
+};
+
+// Sender side of XOR forward error correction in the FlexFEC format
+// (RFC 8627, flexible mask, one protected stream), on its own SSRC.
+//
+// Each frame's packets are split into blocks of up to 46 consecutive
+// packets, and each block gets ceil(packets * protection) FEC packets with
+// an interleaved mask: FEC packet j protects block packets j, j + n,
+// j + 2n, ... for n FEC packets. Each FEC packet repairs one loss among
+// its packets, so a block survives any burst of up to n consecutive
+// losses, which is how Wi-Fi tends to lose them. Protecting frame by frame
+// means a repair never waits for later frames.
+//
+// The protection level follows the loss rate the receiver reports:
+// deltaFactor or keyframeFactor times the loss rate, capped at maxOverhead.
+// The loss rate follows a rise quickly and a fall slowly, so protection is
+// still in place for the next burst rather than gone after a clean report. With no loss,
+// nothing is sent.
+//
+// FEC packets are up to 28 bytes larger than the largest media packet they
+// protect (their RTP and FEC headers), 36 with the transport-wide sequence
+// number; leave room for that under the MTU.
+class FecEncoder
+{
+public:
+	static constexpr int kMaxBlockPackets = 46;
+
+	explicit FecEncoder(const FecConfig& config = {});
+
+	// Fraction of media packets lost, 0 to 1, e.g. from RTCP receiver reports
+	void SetLossRate(double lossRate);
+	// Fixed protection levels (FEC packets per media packet) instead of the
+	// loss-based ones; negative values go back to following the loss rate
+	void SetProtection(double delta, double keyframe);
+	double GetProtection(bool keyframe) const;
+
+	// Appends the FEC packets protecting one frame's `packets` to `out` and
+	// returns how many. They reference buffers owned by the encoder: send
+	// them before the next call.
+	size_t ProtectFrame(const RtpPacket* packets, size_t count, bool keyframe, std::vector<RtpPacket>& out);
+
+	uint32_t GetSsrc() const { return m_config.ssrc; }
+	uint8_t GetPayloadType() const { return m_config.payloadType; }
+	FecStatistics GetStatistics() const;
+
+private:
+	struct Block
+	{
+		size_t first = 0;
+		int size = 0;
+		int fecCount = 0;
+	};
+
+	FecConfig m_config;
+	uint16_t m_sequenceNumber = 0;
+	double m_lossRate = 0.0;
+	double m_fixedDelta = -1.0;
+	double m_fixedKeyframe = -1.0;
+	std::vector<Block> m_blocks;
+	std::vector<uint8_t> m_payloads; // XOR of the protected payloads, one stride per FEC packet
+	FecStatistics m_statistics;
+};
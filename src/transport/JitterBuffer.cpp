@@ -0,0 +1,346 @@
+#include "JitterBuffer.h"
+#include "RtpPacketizer.h"
+
+#include <algorithm>
+#include <bit>
+#include <cmath>
+#include <cstring>
+#include <utility>
+
+namespace
+{
+	// Signed distance from b to a, in the 16-bit sequence number space
+	int SequenceDiff(uint16_t a, uint16_t b)
+	{
+		return static_cast<int16_t>(static_cast<uint16_t>(a - b));
+	}
+
+	double ToMs(std::chrono::steady_clock::duration duration)
+	{
+		return std::chrono::duration<double, std::milli>(duration).count();
+	}
+}
+
+JitterBuffer::JitterBuffer(VideoCodec codec, const JitterBufferConfig& config)
+	: m_depacketizer(codec)
+	, m_config(config)
+{
+	const size_t capacity = std::bit_ceil(static_cast<size_t>(std::clamp(config.capacity, 64, 32768)));
+	m_mask = static_cast<uint16_t>(capacity - 1);
+	m_slots.resize(capacity);
+	m_storage.resize(capacity * kMaxPacketSize);
+}
+
+void JitterBuffer::Reset()
+{
+	std::lock_guard lock(m_mutex);
+	for (Slot& slot : m_slots)
+		slot.used = false;
+	m_hasSsrc = false;
+	m_hasPackets = false;
+	m_released = false;
+	m_waitingForKeyframe = true;
+	m_keyframeRequested = false;
+	m_hasTransit = false;
+	m_jitter = 0.0;
+	m_statistics = {};
+	m_totalBufferDelayMs = 0.0;
+}
+
+const uint8_t* JitterBuffer::SlotData(uint16_t sequenceNumber) const
+{
+	return m_storage.data() + static_cast<size_t>(sequenceNumber & m_mask) * kMaxPacketSize;
+}
+
+bool JitterBuffer::IsPresent(uint16_t sequenceNumber) const
+{
+	const Slot& slot = m_slots[sequenceNumber & m_mask];
+	return slot.used && slot.sequenceNumber == sequenceNumber;
+}
+
+bool JitterBuffer::InsertPacket(const uint8_t* data, size_t size, Clock::time_point arrival)
+{
+	RtpHeader header;
+	RtpPayloadInfo info;
+	std::lock_guard lock(m_mutex);
+	if (size > kMaxPacketSize || !ParseRtpHeader(data, size, header) ||
+		!m_depacketizer.Inspect(header.payload, header.payloadSize, info) || (m_hasSsrc && header.ssrc != m_ssrc))
+	{
+		++m_statistics.packetsDiscarded;
+		return false;
+	}
+	m_hasSsrc = true;
+	m_ssrc = header.ssrc;
+	++m_statistics.packetsReceived;
+
+	const uint16_t sequence = header.sequenceNumber;
+	if (m_released && SequenceDiff(sequence, m_nextSequence) < 0)
+	{
+		++m_statistics.packetsLate;
+		return false;
+	}
+
+	if (!m_hasPackets)
+	{
+		m_oldest = m_highest = sequence;
+		m_hasPackets = true;
+		m_lastKeyframeRequest = arrival; // Give the stream a moment to bring its own keyframe
+	}
+	else if (SequenceDiff(sequence, m_highest) > 0)
+	{
+		m_highest = sequence;
+		// A jump past the ring's size: whatever is older cannot be completed
+		const int capacity = m_mask + 1;
+		if (SequenceDiff(m_highest, m_oldest) >= capacity)
+		{
+			const uint16_t oldest = static_cast<uint16_t>(m_highest - capacity + 1);
+			if (m_released && SequenceDiff(oldest, m_nextSequence) > 0)
+			{
+				m_nextSequence = oldest;
+				if (!m_waitingForKeyframe)
+				{
+					++m_statistics.framesIncomplete;
+					m_waitingForKeyframe = true;
+				}
+			}
+			m_oldest = oldest;
+		}
+	}
+	else if (!m_released && SequenceDiff(sequence, m_oldest) < 0)
+	{
+		if (SequenceDiff(m_highest, sequence) > m_mask)
+		{
+			++m_statistics.packetsLate;
+			return false;
+		}
+		m_oldest = sequence;
+	}
+
+	Slot& slot = SlotFor(sequence);
+	if (slot.used && slot.sequenceNumber == sequence)
+	{
+		++m_statistics.packetsDuplicate;
+		return false;
+	}
+
+	slot.used = true;
+	slot.marker = header.marker;
+	slot.frameStart = info.frameStart;
+	slot.keyframe = info.keyframe;
+	slot.sequenceNumber = sequence;
+	slot.timestamp = header.timestamp;
+	slot.payloadOffset = static_cast<uint16_t>(header.payload - data);
+	slot.payloadSize = static_cast<uint16_t>(header.payloadSize);
+	slot.arrival = arrival;
+	std::memcpy(m_storage.data() + static_cast<size_t>(sequence & m_mask) * kMaxPacketSize, data, size);
+
+	UpdateJitter(header.timestamp, arrival);
+	return true;
+}
+
+void JitterBuffer::UpdateJitter(uint32_t timestamp, Clock::time_point arrival)
+{
+	// RFC 3550 section 6.4.1, once per frame: the packets of a frame are sent
+	// in a burst, so their spread is send time rather than network jitter
+	if (m_hasTransit && static_cast<int32_t>(timestamp - m_lastTimestamp) <= 0)
+		return;
+
+	if (m_hasTransit)
+	{
+		const double arrivalDelta = ToMs(arrival - m_lastArrival) * (kRtpVideoClockRate / 1000.0);
+		const double difference = arrivalDelta - static_cast<int32_t>(timestamp - m_lastTimestamp);
+		m_jitter += (std::abs(difference) - m_jitter) / 16.0;
+	}
+	m_hasTransit = true;
+	m_lastTimestamp = timestamp;
+	m_lastArrival = arrival;
+}
+
+void JitterBuffer::SetRetransmissionDelay(double delayMs)
+{
+	std::lock_guard lock(m_mutex);
+	m_retransmissionDelayMs = std::max(delayMs, 0.0);
+}
+
+JitterBuffer::Clock::duration JitterBuffer::GetWait() const
+{
+	const double jitterMs = m_jitter / (kRtpVideoClockRate / 1000.0);
+	const double waitMs = std::clamp(m_config.jitterFactor * jitterMs + m_retransmissionDelayMs,
+									 static_cast<double>(m_config.minWaitMs),
+									 static_cast<double>(std::max(m_config.maxWaitMs, m_config.minWaitMs)));
+	return std::chrono::duration_cast<Clock::duration>(std::chrono::duration<double, std::milli>(waitMs));
+}
+
+JitterBuffer::FrameSpan JitterBuffer::FindFrame(uint16_t first) const
+{
+	FrameSpan span;
+	span.first = span.last = first;
+	span.firstArrival = span.gapRevealed = Clock::time_point::max();
+
+	bool started = false;
+	uint32_t timestamp = 0;
+	for (uint16_t sequence = first; SequenceDiff(sequence, m_highest) <= 0; ++sequence)
+	{
+		if (!IsPresent(sequence))
+		{
+			// Time the wait from the packet that revealed the gap. Without
+			// one, the missing packets may just not have been sent yet.
+			for (uint16_t later = sequence; SequenceDiff(later, m_highest) <= 0; ++later)
+			{
+				if (IsPresent(later))
+				{
+					span.gapRevealed = m_slots[later & m_mask].arrival;
+					break;
+				}
+			}
+			return span;
+		}
+
+		const Slot& slot = m_slots[sequence & m_mask];
+		if (!started)
+		{
+			timestamp = slot.timestamp;
+			started = true;
+		}
+		else if (slot.timestamp != timestamp)
+		{
+			// The next frame began with nothing missing, so this one is whole
+			// even though its last packet lacked the marker
+			span.complete = true;
+			return span;
+		}
+		span.firstArrival = std::min(span.firstArrival, slot.arrival);
+		span.last = sequence;
+		if (slot.marker)
+		{
+			span.complete = true;
+			return span;
+		}
+	}
+	return span;
+}
+
+bool JitterBuffer::FindKeyframe(FrameSpan& out) const
+{
+	const uint16_t from = m_released ? m_nextSequence : m_oldest;
+	for (uint16_t sequence = from; SequenceDiff(sequence, m_highest) <= 0; ++sequence)
+	{
+		const Slot& slot = m_slots[sequence & m_mask];
+		if (!IsPresent(sequence) || !slot.frameStart || !slot.keyframe)
+			continue;
+		const FrameSpan span = FindFrame(sequence);
+		if (span.complete)
+		{
+			out = span;
+			return true;
+		}
+		sequence = span.last; // Skip the rest of this frame
+	}
+	return false;
+}
+
+void JitterBuffer::DropThrough(uint16_t last)
+{
+	for (uint16_t sequence = m_oldest; SequenceDiff(sequence, last) <= 0; ++sequence)
+	{
+		if (IsPresent(sequence))
+			SlotFor(sequence).used = false;
+	}
+	if (SequenceDiff(last, m_oldest) >= 0)
+		m_oldest = static_cast<uint16_t>(last + 1);
+}
+
+void JitterBuffer::RequestKeyframe(Clock::time_point now)
+{
+	m_keyframeRequested = true;
+	m_lastKeyframeRequest = now;
+	++m_statistics.keyframeRequests;
+}
+
+bool JitterBuffer::TakeKeyframeRequest()
+{
+	std::lock_guard lock(m_mutex);
+	return std::exchange(m_keyframeRequested, false);
+}
+
+void JitterBuffer::Release(const FrameSpan& frame, ReassembledFrame& out, Clock::time_point now)
+{
+	out.data.clear();
+	out.rtpTimestamp = m_slots[frame.first & m_mask].timestamp;
+	out.firstSequenceNumber = frame.first;
+	out.lastSequenceNumber = frame.last;
+	out.firstArrival = frame.firstArrival;
+	out.isKeyframe = false;
+	for (uint16_t sequence = frame.first; SequenceDiff(sequence, frame.last) <= 0; ++sequence)
+	{
+		const Slot& slot = m_slots[sequence & m_mask];
+		out.isKeyframe |= slot.keyframe;
+		m_depacketizer.Append(SlotData(sequence) + slot.payloadOffset, slot.payloadSize, out.data);
+	}
+
+	DropThrough(frame.last);
+	m_nextSequence = static_cast<uint16_t>(frame.last + 1);
+	m_released = true;
+
+	const double delayMs = ToMs(now - frame.firstArrival);
+	++m_statistics.framesReleased;
+	m_totalBufferDelayMs += delayMs;
+	m_statistics.maxBufferDelayMs = std::max(m_statistics.maxBufferDelayMs, delayMs);
+}
+
+bool JitterBuffer::PopFrame(ReassembledFrame& out, Clock::time_point now)
+{
+	std::lock_guard lock(m_mutex);
+	if (!m_hasPackets)
+		return false;
+
+	if (m_released && !m_waitingForKeyframe)
+	{
+		if (SequenceDiff(m_highest, m_nextSequence) < 0)
+			return false; // Nothing new
+
+		const FrameSpan next = FindFrame(m_nextSequence);
+		if (next.complete)
+		{
+			Release(next, out, now);
+			return true;
+		}
+
+		// Missing packets. A complete keyframe further on makes them moot;
+		// otherwise wait for them until the wait runs out.
+		FrameSpan keyframe;
+		const bool keyframeReady = FindKeyframe(keyframe);
+		if (!keyframeReady && (next.gapRevealed == Clock::time_point::max() || now - next.gapRevealed < GetWait()))
+			return false;
+
+		++m_statistics.framesIncomplete;
+		m_waitingForKeyframe = true;
+		if (!keyframeReady)
+			RequestKeyframe(now);
+	}
+
+	FrameSpan keyframe;
+	if (FindKeyframe(keyframe))
+	{
+		DropThrough(static_cast<uint16_t>(keyframe.first - 1));
+		Release(keyframe, out, now);
+		m_waitingForKeyframe = false;
+		return true;
+	}
+
+	// Still no way in: ask again now and then, in case a request was lost
+	if (now - m_lastKeyframeRequest >= std::chrono::milliseconds(std::max(m_config.maxWaitMs, 100)))
+		RequestKeyframe(now);
+	return false;
+}
+
+JitterBufferStatistics JitterBuffer::GetStatistics() const
+{
+	std::lock_guard lock(m_mutex);
+	JitterBufferStatistics statistics = m_statistics;
+	statistics.jitterMs = m_jitter / (kRtpVideoClockRate / 1000.0);
+	statistics.targetWaitMs = ToMs(GetWait());
+	statistics.averageBufferDelayMs =
+		statistics.framesReleased ? m_totalBufferDelayMs / static_cast<double>(statistics.framesReleased) : 0.0;
+	return statistics;
+}
@@ -0,0 +1,147 @@
+#pragma once
+
+#include "RtpDepacketizer.h"
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <vector>
+
+struct JitterBufferConfig
+{
+	int capacity = 2048;	  // Packets, rounded up to a power of two; a 4K keyframe is several hundred
+	int minWaitMs = 10;		  // Shortest time an incomplete frame waits for missing packets
+	int maxWaitMs = 500;	  // Longest; past that the frame is abandoned whatever the jitter
+	double jitterFactor = 3.0; // Wait for this many jitter deviations before giving up on a packet
+};
+
+struct JitterBufferStatistics
+{
+	uint64_t packetsReceived = 0;
+	uint64_t packetsDuplicate = 0;
+	uint64_t packetsLate = 0;	  // Arrived after their frame was released or abandoned
+	uint64_t packetsDiscarded = 0; // Malformed, oversized, or from another stream
+	uint64_t framesReleased = 0;
+	uint64_t framesIncomplete = 0; // Abandoned with packets missing
+	uint64_t keyframeRequests = 0;
+	double jitterMs = 0.0;			 // RFC 3550 interarrival jitter, per frame
+	double targetWaitMs = 0.0;		 // Current wait for missing packets
+	double averageBufferDelayMs = 0.0; // First packet arrival to release
+	double maxBufferDelayMs = 0.0;
+};
+
+// One frame as the decoder wants it
+struct ReassembledFrame
+{
+	std::vector<uint8_t> data; // Annex B for H.264, a raw frame for VP8; keeps its capacity across frames
+	uint32_t rtpTimestamp = 0;
+	uint16_t firstSequenceNumber = 0;
+	uint16_t lastSequenceNumber = 0;
+	bool isKeyframe = false;
+	std::chrono::steady_clock::time_point firstArrival;
+};
+
+// Receive-side reordering and frame reassembly for one RTP video stream.
+//
+// Packets are copied into a ring of fixed-size slots indexed by sequence
+// number, allocated once, so inserting a packet never allocates. A frame is
+// released as soon as all its packets are present and everything before it
+// in decode order has been released: there is no fixed playout delay, which
+// is what keeps screen sharing interactive. When a frame is missing packets
+// the buffer waits for them (reordering, retransmissions) for a time that
+// follows the measured jitter, plus the retransmission delay when NACKs are
+// in use, between minWaitMs and maxWaitMs, counted from the arrival of the
+// packet that revealed the gap. After that the frame is abandoned, and
+// because later frames reference it, nothing more is released until the
+// next complete keyframe; a keyframe request is raised for the sender.
+//
+// InsertPacket() and PopFrame() may be called from different threads.
+class JitterBuffer
+{
+public:
+	using Clock = std::chrono::steady_clock;
+
+	JitterBuffer(VideoCodec codec, const JitterBufferConfig& config = {});
+
+	// Copies one received RTP packet in. False if it was dropped (duplicate,
+	// late, malformed); that is normal and needs no action.
+	bool InsertPacket(const uint8_t* data, size_t size, Clock::time_point arrival);
+
+	// The next frame in decode order if one can be released, abandoning
+	// frames whose wait has run out on the way
+	bool PopFrame(ReassembledFrame& out, Clock::time_point now);
+
+	// True once after frames were lost: the sender should send a keyframe
+	bool TakeKeyframeRequest();
+	// How long a NACKed packet takes to arrive (the RTT from NackGenerator);
+	// added to the wait for missing packets. 0, the default, without NACKs.
+	void SetRetransmissionDelay(double delayMs);
+	void Reset();
+
+	JitterBufferStatistics GetStatistics() const;
+
+	static constexpr size_t kMaxPacketSize = 1500;
+
+private:
+	struct Slot
+	{
+		bool used = false;
+		bool marker = false;
+		bool frameStart = false;
+		bool keyframe = false;
+		uint16_t sequenceNumber = 0;
+		uint32_t timestamp = 0;
+		uint16_t payloadOffset = 0;
+		uint16_t payloadSize = 0;
+		Clock::time_point arrival;
+	};
+
+	struct FrameSpan
+	{
+		uint16_t first = 0;
+		uint16_t last = 0;
+		bool complete = false;
+		Clock::time_point firstArrival;
+		Clock::time_point gapRevealed; // Arrival of the first packet after a missing one
+	};
+
+	Slot& SlotFor(uint16_t sequenceNumber) { return m_slots[sequenceNumber & m_mask]; }
+	const uint8_t* SlotData(uint16_t sequenceNumber) const;
+	bool IsPresent(uint16_t sequenceNumber) const;
+	FrameSpan FindFrame(uint16_t first) const;
+	bool FindKeyframe(FrameSpan& out) const;
+	void Release(const FrameSpan& frame, ReassembledFrame& out, Clock::time_point now);
+	void DropThrough(uint16_t last);
+	void RequestKeyframe(Clock::time_point now);
+	void UpdateJitter(uint32_t timestamp, Clock::time_point arrival);
+	Clock::duration GetWait() const;
+
+	RtpDepacketizer m_depacketizer;
+	JitterBufferConfig m_config;
+	uint16_t m_mask = 0;
+	std::vector<Slot> m_slots;
+	std::vector<uint8_t> m_storage; // kMaxPacketSize bytes per slot
+
+	mutable std::mutex m_mutex;
+	bool m_hasSsrc = false;
+	uint32_t m_ssrc = 0;
+	bool m_hasPackets = false;
+	uint16_t m_oldest = 0;  // Lowest sequence number that may still be in the ring
+	uint16_t m_highest = 0; // Highest received
+	bool m_released = false; // m_nextSequence is valid
+	uint16_t m_nextSequence = 0;
+	bool m_waitingForKeyframe = true;
+	bool m_keyframeRequested = false;
+	Clock::time_point m_lastKeyframeRequest;
+
+	// Interarrival jitter over frames (first packet of each timestamp)
+	bool m_hasTransit = false;
+	uint32_t m_lastTimestamp = 0;
+	Clock::time_point m_lastArrival;
+	double m_jitter = 0.0; // In RTP clock units
+	double m_retransmissionDelayMs = 0.0;
+
+	JitterBufferStatistics m_statistics;
+	double m_totalBufferDelayMs = 0.0;
+};
@@ -0,0 +1,128 @@
+#include "LinkSimulator.h"
+
+#include <algorithm>
+
+LinkSimulator::LinkSimulator(UdpSocket& socket, const LinkConfig& config)
+	: m_socket(socket)
+	, m_config(config)
+{
+	m_config.lossPercent = std::clamp(m_config.lossPercent, 0.0, 100.0);
+	m_config.meanBurstLength = std::max(m_config.meanBurstLength, 1.0);
+	m_thread = std::thread([this] { Run(); });
+}
+
+LinkSimulator::~LinkSimulator()
+{
+	{
+		std::lock_guard lock(m_mutex);
+		m_stop = true;
+	}
+	m_wake.notify_one();
+	m_thread.join();
+}
+
+bool LinkSimulator::Lose(uint8_t payloadType)
+{
+	auto state = std::find_if(m_loss.begin(), m_loss.end(),
+							  [&](const LossState& loss) { return loss.payloadType == payloadType; });
+	if (state == m_loss.end())
+	{
+		std::seed_seq seed{ m_config.seed, static_cast<uint32_t>(payloadType) };
+		state = m_loss.insert(m_loss.end(), { payloadType, std::mt19937(seed), false });
+	}
+
+	// Leave the bad state after meanBurstLength packets on average; enter it
+	// as often as that takes for the long-run loss rate to come out right
+	const double loss = m_config.lossPercent / 100.0;
+	const double leaveBad = 1.0 / m_config.meanBurstLength;
+	const double enterBad = loss >= 1.0 ? 1.0 : std::min(1.0, loss * leaveBad / (1.0 - loss));
+	std::uniform_real_distribution<double> uniform(0.0, 1.0);
+	state->bad = state->bad ? uniform(state->random) >= leaveBad : uniform(state->random) < enterBad;
+	return state->bad;
+}
+
+void LinkSimulator::SetBandwidth(int kbps)
+{
+	std::lock_guard lock(m_mutex);
+	m_config.bandwidthKbps = std::max(kbps, 0);
+}
+
+void LinkSimulator::Send(const RtpPacket* packets, size_t count)
+{
+	const Clock::time_point now = Clock::now();
+	const auto delay = std::chrono::milliseconds(m_config.delayMs);
+	{
+		std::lock_guard lock(m_mutex);
+		for (size_t i = 0; i < count; ++i)
+		{
+			++m_statistics.packetsSent;
+			if (Lose(packets[i].header[1] & 0x7F))
+			{
+				++m_statistics.packetsDropped;
+				continue;
+			}
+
+			Clock::time_point due = now + delay;
+			if (m_config.bandwidthKbps > 0)
+			{
+				const Clock::time_point start = std::max(now, m_linkFree);
+				const double waitMs = std::chrono::duration<double, std::milli>(start - now).count();
+				if (waitMs > m_config.queueMs)
+				{
+					++m_statistics.packetsDropped;
+					++m_statistics.packetsOverflowed;
+					continue;
+				}
+				m_statistics.queueDelayMs = waitMs;
+				m_statistics.maxQueueDelayMs = std::max(m_statistics.maxQueueDelayMs, waitMs);
+				m_linkFree = start + std::chrono::duration_cast<Clock::duration>(std::chrono::duration<double, std::milli>(
+										 packets[i].size * 8.0 / m_config.bandwidthKbps));
+				due = m_linkFree + delay;
+			}
+			std::vector<uint8_t> data;
+			if (!m_free.empty())
+			{
+				data = std::move(m_free.back());
+				m_free.pop_back();
+			}
+			data.resize(packets[i].size);
+			packets[i].CopyTo(data.data());
+			m_queue.push_back({ due, std::move(data) });
+		}
+	}
+	m_wake.notify_one();
+}
+
+void LinkSimulator::Run()
+{
+	std::unique_lock lock(m_mutex);
+	while (true)
+	{
+		if (m_queue.empty())
+		{
+			if (m_stop)
+				return;
+			m_wake.wait(lock);
+			continue;
+		}
+		const Clock::time_point due = m_queue.front().due;
+		if (Clock::now() < due && !m_stop)
+		{
+			m_wake.wait_until(lock, due);
+			continue;
+		}
+
+		std::vector<uint8_t> data = std::move(m_queue.front().data);
+		m_queue.pop_front();
+		lock.unlock();
+		m_socket.SendDatagram(data.data(), data.size());
+		lock.lock();
+		m_free.push_back(std::move(data));
+	}
+}
+
+LinkStatistics LinkSimulator::GetStatistics() const
+{
+	std::lock_guard lock(m_mutex);
+	return m_statistics;
+}
@@ -0,0 +1,99 @@
+#pragma once
+
+#include "UdpSocket.h"
+
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <mutex>
+#include <random>
+#include <thread>
+#include <vector>
+
+struct LinkConfig
+{
+	double lossPercent = 0.0;
+	double meanBurstLength = 1.0; // Consecutive packets lost together; 1 is independent loss
+	int delayMs = 0;			  // One way
+	uint32_t seed = 1;
+	int bandwidthKbps = 0; // Bottleneck rate; 0 for none
+	int queueMs = 300;	   // The bottleneck's buffer, as time to drain; packets that would wait longer are dropped
+};
+
+struct LinkStatistics
+{
+	uint64_t packetsSent = 0;
+	uint64_t packetsDropped = 0;  // By random loss or a full queue
+	uint64_t packetsOverflowed = 0; // Of those, by the full queue
+	double queueDelayMs = 0.0;	  // Wait of the packet sent last
+	double maxQueueDelayMs = 0.0;
+};
+
+// A lossy, delayed network path in front of a UdpSocket, for testing loss
+// recovery over loopback. Loss follows a two-state Gilbert-Elliott model
+// (every packet in the bad state is lost), which gives the configured loss
+// rate with bursts of the configured mean length. Each payload type (media,
+// RTX, FEC) has its own model seeded from `seed`, so the media packets lost
+// are the same from run to run whatever the timing of the repairs sent
+// alongside them. Packets that survive are
+// copied and sent by the simulator's own thread once the delay has passed,
+// so a delayed path also delays the repairs that cross it; the reverse
+// path (feedback) is not delayed, so the round trip is about delayMs.
+//
+// With a bandwidth, packets also go through a bottleneck: a drop-tail queue
+// drained at that rate, like the uplink of a home router. Sending faster
+// than it builds the queue, which is the delay a congestion controller
+// watches for; SetBandwidth() changes it mid-run, as a shared link would.
+//
+// The simulator's thread is the only one sending on the socket while it
+// exists.
+class LinkSimulator
+{
+public:
+	using Clock = std::chrono::steady_clock;
+
+	LinkSimulator(UdpSocket& socket, const LinkConfig& config);
+	~LinkSimulator();
+
+	LinkSimulator(const LinkSimulator&) = delete;
+	LinkSimulator& operator=(const LinkSimulator&) = delete;
+
+	// Like UdpSocket::Send(); packets dropped on the way still count as sent
+	void Send(const RtpPacket* packets, size_t count);
+
+	void SetBandwidth(int kbps);
+
+	LinkStatistics GetStatistics() const;
+
+private:
+	struct Queued
+	{
+		Clock::time_point due;
+		std::vector<uint8_t> data;
+	};
+
+	struct LossState
+	{
+		uint8_t payloadType = 0;
+		std::mt19937 random;
+		bool bad = false;
+	};
+
+	bool Lose(uint8_t payloadType);
+	void Run();
+
+	UdpSocket& m_socket;
+	LinkConfig m_config;
+	std::vector<LossState> m_loss; // One per payload type seen
+	Clock::time_point m_linkFree; // When the bottleneck has sent everything queued
+
+	mutable std::mutex m_mutex;
+	std::condition_variable m_wake;
+	std::deque<Queued> m_queue;
+	std::vector<std::vector<uint8_t>> m_free; // Buffers to reuse
+	bool m_stop = false;
+	LinkStatistics m_statistics;
+	std::thread m_thread;
+};
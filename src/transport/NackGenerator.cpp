@@ -0,0 +1,144 @@
+#include "NackGenerator.h"
+
+#include <algorithm>
+#include <utility>
+
+namespace
+{
+	// Signed distance from b to a, in the 16-bit sequence number space
+	int SequenceDiff(uint16_t a, uint16_t b)
+	{
+		return static_cast<int16_t>(static_cast<uint16_t>(a - b));
+	}
+
+	double ToMs(std::chrono::steady_clock::duration duration)
+	{
+		return std::chrono::duration<double, std::milli>(duration).count();
+	}
+}
+
+NackGenerator::NackGenerator(const NackConfig& config)
+	: m_config(config)
+	, m_rttMs(config.initialRttMs)
+{
+}
+
+void NackGenerator::Reset()
+{
+	m_started = false;
+	m_missing.clear();
+	m_keyframeRequested = false;
+	m_rttMs = m_config.initialRttMs;
+	m_hasRttSample = false;
+	m_statistics = {};
+}
+
+void NackGenerator::OnPacket(uint16_t sequenceNumber, bool retransmitted, Clock::time_point now)
+{
+	if (!m_started)
+	{
+		m_started = true;
+		m_highest = sequenceNumber;
+		return;
+	}
+
+	const int distance = SequenceDiff(sequenceNumber, m_highest);
+	if (distance > 0)
+	{
+		const size_t gap = static_cast<size_t>(distance - 1);
+		if (m_missing.size() + gap > m_config.maxMissing)
+		{
+			m_statistics.packetsGivenUp += m_missing.size() + gap;
+			m_missing.clear();
+			m_keyframeRequested = true;
+		}
+		else
+		{
+			for (uint16_t missing = static_cast<uint16_t>(m_highest + 1); missing != sequenceNumber; ++missing)
+				m_missing.push_back({ missing, now, {}, 0 });
+			m_statistics.packetsMissing += gap;
+		}
+		m_highest = sequenceNumber;
+		return;
+	}
+
+	// Late: reordered, or the answer to a NACK
+	auto it = std::lower_bound(m_missing.begin(), m_missing.end(), sequenceNumber,
+							   [](const Missing& m, uint16_t s) { return SequenceDiff(m.sequenceNumber, s) < 0; });
+	if (it == m_missing.end() || it->sequenceNumber != sequenceNumber)
+		return;
+
+	if (retransmitted && it->retries == 1)
+	{
+		// Only a packet NACKed once times the round trip unambiguously
+		const double sample = ToMs(now - it->lastSent);
+		m_rttMs = m_hasRttSample ? m_rttMs + (sample - m_rttMs) / 8.0 : sample;
+		m_hasRttSample = true;
+	}
+	if (it->retries > 0)
+		++m_statistics.packetsRecovered;
+	m_missing.erase(it);
+}
+
+double NackGenerator::GetRetryIntervalMs() const
+{
+	// A little past the RTT, so a retransmission that is on its way is not
+	// asked for again
+	return m_rttMs * 1.25 + 2.0;
+}
+
+double NackGenerator::GetRepairDelayMs() const
+{
+	return m_config.reorderWaitMs + GetRetryIntervalMs() + m_rttMs;
+}
+
+void NackGenerator::GetNackList(Clock::time_point now, std::vector<uint16_t>& out)
+{
+	out.clear();
+	const auto reorderWait = std::chrono::milliseconds(m_config.reorderWaitMs);
+	const auto maxAge = std::chrono::milliseconds(m_config.maxAgeMs);
+	const auto retryInterval = std::chrono::duration_cast<Clock::duration>(
+		std::chrono::duration<double, std::milli>(GetRetryIntervalMs()));
+
+	size_t kept = 0;
+	for (Missing& missing : m_missing)
+	{
+		// The last NACK gets its round trip before the packet is given up on
+		const bool exhausted = missing.retries >= m_config.maxRetries && now - missing.lastSent >= retryInterval;
+		if (exhausted || now - missing.detected > maxAge)
+		{
+			++m_statistics.packetsGivenUp;
+			continue;
+		}
+		const bool due = missing.retries == 0 ? now - missing.detected >= reorderWait
+											  : missing.retries < m_config.maxRetries && now - missing.lastSent >= retryInterval;
+		if (due)
+		{
+			out.push_back(missing.sequenceNumber);
+			missing.lastSent = now;
+			++missing.retries;
+		}
+		m_missing[kept++] = missing;
+	}
+	m_missing.resize(kept);
+	m_statistics.nacksSent += out.size();
+}
+
+void NackGenerator::ClearBefore(uint16_t sequenceNumber)
+{
+	auto it = std::lower_bound(m_missing.begin(), m_missing.end(), sequenceNumber,
+							   [](const Missing& m, uint16_t s) { return SequenceDiff(m.sequenceNumber, s) < 0; });
+	m_missing.erase(m_missing.begin(), it);
+}
+
+bool NackGenerator::TakeKeyframeRequest()
+{
+	return std::exchange(m_keyframeRequested, false);
+}
+
+NackStatistics NackGenerator::GetStatistics() const
+{
+	NackStatistics statistics = m_statistics;
+	statistics.rttMs = m_rttMs;
+	return statistics;
+}
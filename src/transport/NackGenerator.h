@@ -0,0 +1,88 @@
+#pragma once
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+struct NackConfig
+{
+	int reorderWaitMs = 5;	   // A gap this young may just be reordering
+	int initialRttMs = 100;	   // Until the first retransmission is timed
+	int maxRetries = 10;	   // NACKs per missing packet
+	int maxAgeMs = 500;		   // Give up on a packet after this; match JitterBufferConfig::maxWaitMs
+	size_t maxMissing = 1000;  // A larger gap is beyond repair: clear and ask for a keyframe
+};
+
+struct NackStatistics
+{
+	uint64_t packetsMissing = 0;   // Gaps detected
+	uint64_t packetsRecovered = 0; // Arrived after being NACKed
+	uint64_t packetsGivenUp = 0;
+	uint64_t nacksSent = 0;		   // Sequence numbers requested, counting repeats
+	double rttMs = 0.0;
+};
+
+// Receiver side of NACK-based loss recovery: watches the sequence numbers
+// of one media stream and decides which missing packets to NACK, and when.
+//
+// A gap is NACKed once it is older than reorderWaitMs, then again every
+// round trip until the packet arrives, maxRetries is reached, or maxAgeMs
+// passes and the jitter buffer will have given up on the frame anyway. The
+// round trip is measured here: a retransmission answering the first NACK
+// for a packet arrives one RTT after that NACK was sent, which needs no
+// RTCP sender reports. Feed GetRepairDelayMs() to
+// JitterBuffer::SetRetransmissionDelay() so incomplete frames wait long
+// enough for the repair.
+//
+// Not thread-safe: call from the receive thread.
+class NackGenerator
+{
+public:
+	using Clock = std::chrono::steady_clock;
+
+	explicit NackGenerator(const NackConfig& config = {});
+
+	// Every media packet received, retransmissions included (after
+	// RestoreRtxPacket())
+	void OnPacket(uint16_t sequenceNumber, bool retransmitted, Clock::time_point now);
+
+	// Replaces `out` with the sequence numbers to NACK now, ascending
+	void GetNackList(Clock::time_point now, std::vector<uint16_t>& out);
+
+	// Forgets missing packets before `sequenceNumber`, e.g. once the jitter
+	// buffer has skipped to a keyframe past them
+	void ClearBefore(uint16_t sequenceNumber);
+
+	// True once after a gap too large to repair
+	bool TakeKeyframeRequest();
+
+	double GetRttMs() const { return m_rttMs; }
+	// From detecting a gap to the second retransmission's arrival, so a
+	// repair survives losing one retransmission
+	double GetRepairDelayMs() const;
+	void SetRtt(double rttMs) { m_rttMs = rttMs; }
+	void Reset();
+
+	NackStatistics GetStatistics() const;
+
+private:
+	struct Missing
+	{
+		uint16_t sequenceNumber = 0;
+		Clock::time_point detected;
+		Clock::time_point lastSent;
+		int retries = 0;
+	};
+
+	double GetRetryIntervalMs() const;
+
+	NackConfig m_config;
+	bool m_started = false;
+	uint16_t m_highest = 0;
+	std::vector<Missing> m_missing; // Ascending in 16-bit order
+	bool m_keyframeRequested = false;
+	double m_rttMs = 0.0;
+	bool m_hasRttSample = false;
+	NackStatistics m_statistics;
+};
@@ -0,0 +1,380 @@
+#include "RtcpPacket.h"
+
+#include <algorithm>
+#include <cmath>
+#include <iterator>
+
+namespace
+{
+	constexpr uint8_t kRtcpVersion = 2;
+	constexpr uint8_t kPacketTypeSenderReport = 200;
+	constexpr uint8_t kPacketTypeReceiverReport = 201;
+	constexpr uint8_t kPacketTypeRtpFeedback = 205;		 // RTPFB
+	constexpr uint8_t kPacketTypePayloadFeedback = 206; // PSFB
+	constexpr uint8_t kFormatGenericNack = 1;
+	constexpr uint8_t kFormatTransportFeedback = 15;
+	constexpr uint8_t kFormatPli = 1;
+	constexpr size_t kFeedbackHeaderSize = 12; // Common header, sender SSRC, media SSRC
+	constexpr size_t kReportBlockSize = 24;
+	constexpr size_t kSenderInfoSize = 20;
+	constexpr size_t kTransportFeedbackFixedSize = 8; // Base sequence number, count, reference time, feedback count
+	constexpr int64_t kDeltaUs = 250;
+
+	// Packet status symbols
+	constexpr uint8_t kNotReceived = 0;
+	constexpr uint8_t kSmallDelta = 1; // Arrived 0 to 63.75 ms after the one before: one byte
+	constexpr uint8_t kLargeDelta = 2; // Any other delta, negative ones too: two bytes, signed
+
+	void Write16(uint8_t* out, uint16_t value)
+	{
+		out[0] = static_cast<uint8_t>(value >> 8);
+		out[1] = static_cast<uint8_t>(value);
+	}
+
+	void Write32(uint8_t* out, uint32_t value)
+	{
+		Write16(out, static_cast<uint16_t>(value >> 16));
+		Write16(out + 2, static_cast<uint16_t>(value));
+	}
+
+	uint16_t Read16(const uint8_t* data)
+	{
+		return static_cast<uint16_t>(data[0] << 8 | data[1]);
+	}
+
+	uint32_t Read32(const uint8_t* data)
+	{
+		return static_cast<uint32_t>(Read16(data)) << 16 | Read16(data + 2);
+	}
+
+	// Feedback header for a packet of `size` bytes, a multiple of four
+	uint8_t* AppendFeedbackHeader(uint8_t format, uint8_t packetType, uint32_t senderSsrc, uint32_t mediaSsrc,
+								  size_t size, std::vector<uint8_t>& out)
+	{
+		const size_t offset = out.size();
+		out.resize(offset + size);
+		uint8_t* packet = out.data() + offset;
+		packet[0] = static_cast<uint8_t>(kRtcpVersion << 6 | format);
+		packet[1] = packetType;
+		Write16(packet + 2, static_cast<uint16_t>(size / 4 - 1));
+		Write32(packet + 4, senderSsrc);
+		Write32(packet + 8, mediaSsrc);
+		return packet;
+	}
+
+	bool ParseTransportFeedback(const uint8_t* packet, size_t packetSize, RtcpTransportFeedback& out)
+	{
+		if (packet[0] & 0x20)
+		{
+			const size_t padding = packet[packetSize - 1];
+			if (padding == 0 || padding > packetSize - kFeedbackHeaderSize)
+				return false;
+			packetSize -= padding;
+		}
+		if (packetSize < kFeedbackHeaderSize + kTransportFeedbackFixedSize)
+			return false;
+
+		const uint8_t* fci = packet + kFeedbackHeaderSize;
+		const uint8_t* const end = packet + packetSize;
+		out.baseSequenceNumber = Read16(fci);
+		const size_t count = Read16(fci + 2);
+		out.referenceTime = Read32(fci + 4) >> 8;
+		out.feedbackCount = fci[7];
+		fci += kTransportFeedbackFixedSize;
+
+		std::vector<uint8_t> symbols;
+		symbols.reserve(count);
+		while (symbols.size() < count)
+		{
+			if (end - fci < 2)
+				return false;
+			const uint16_t chunk = Read16(fci);
+			fci += 2;
+			const size_t left = count - symbols.size();
+			if (!(chunk & 0x8000)) // Run length
+			{
+				const size_t run = std::min<size_t>(chunk & 0x1FFF, left);
+				symbols.insert(symbols.end(), run, static_cast<uint8_t>((chunk >> 13) & 3));
+			}
+			else if (!(chunk & 0x4000)) // 14 one-bit symbols
+			{
+				for (size_t n = 0; n < std::min<size_t>(14, left); ++n)
+					symbols.push_back(static_cast<uint8_t>((chunk >> (13 - n)) & 1));
+			}
+			else // 7 two-bit symbols
+			{
+				for (size_t n = 0; n < std::min<size_t>(7, left); ++n)
+					symbols.push_back(static_cast<uint8_t>((chunk >> (12 - 2 * n)) & 3));
+			}
+		}
+
+		out.arrivalOffsetsUs.resize(count);
+		int64_t arrival = 0;
+		for (size_t i = 0; i < count; ++i)
+		{
+			if (symbols[i] == kNotReceived)
+			{
+				out.arrivalOffsetsUs[i] = RtcpTransportFeedback::kNotReceived;
+				continue;
+			}
+			if (end - fci < symbols[i])
+				return false;
+			if (symbols[i] == kSmallDelta)
+				arrival += *fci++ * kDeltaUs;
+			else if (symbols[i] == kLargeDelta)
+			{
+				arrival += static_cast<int16_t>(Read16(fci)) * kDeltaUs;
+				fci += 2;
+			}
+			else
+				return false; // Reserved symbol
+			out.arrivalOffsetsUs[i] = arrival;
+		}
+		return true;
+	}
+}
+
+bool IsRtcpPacket(const uint8_t* data, size_t size)
+{
+	return size >= 8 && (data[0] >> 6) == kRtcpVersion && data[1] >= 192 && data[1] <= 223;
+}
+
+size_t BuildRtcpNack(uint32_t senderSsrc, uint32_t mediaSsrc, const uint16_t* sequenceNumbers, size_t count,
+					 size_t maxSize, std::vector<uint8_t>& out)
+{
+	if (count == 0 || maxSize < kFeedbackHeaderSize + 4)
+		return 0;
+
+	// Each FCI entry is a packet ID and a bitmask of the 16 that follow it
+	struct Fci
+	{
+		uint16_t packetId;
+		uint16_t bitmask;
+	};
+	const size_t maxEntries = (maxSize - kFeedbackHeaderSize) / 4;
+	Fci entries[256];
+	size_t entryCount = 0;
+	size_t covered = 0;
+	while (covered < count)
+	{
+		const uint16_t sequence = sequenceNumbers[covered];
+		if (entryCount > 0)
+		{
+			Fci& last = entries[entryCount - 1];
+			const uint16_t distance = static_cast<uint16_t>(sequence - last.packetId);
+			if (distance >= 1 && distance <= 16)
+			{
+				last.bitmask |= static_cast<uint16_t>(1u << (distance - 1));
+				++covered;
+				continue;
+			}
+		}
+		if (entryCount == maxEntries || entryCount == std::size(entries))
+			break;
+		entries[entryCount++] = { sequence, 0 };
+		++covered;
+	}
+
+	uint8_t* fci = AppendFeedbackHeader(kFormatGenericNack, kPacketTypeRtpFeedback, senderSsrc, mediaSsrc,
+										kFeedbackHeaderSize + entryCount * 4, out) +
+				   kFeedbackHeaderSize;
+	for (size_t i = 0; i < entryCount; ++i, fci += 4)
+	{
+		Write16(fci, entries[i].packetId);
+		Write16(fci + 2, entries[i].bitmask);
+	}
+	return covered;
+}
+
+void BuildRtcpPli(uint32_t senderSsrc, uint32_t mediaSsrc, std::vector<uint8_t>& out)
+{
+	AppendFeedbackHeader(kFormatPli, kPacketTypePayloadFeedback, senderSsrc, mediaSsrc, kFeedbackHeaderSize, out);
+}
+
+void BuildRtcpReceiverReport(uint32_t senderSsrc, uint32_t mediaSsrc, const RtcpReportBlock& block,
+							 std::vector<uint8_t>& out)
+{
+	const size_t size = 8 + kReportBlockSize;
+	const size_t offset = out.size();
+	out.resize(offset + size, 0);
+	uint8_t* packet = out.data() + offset;
+	packet[0] = static_cast<uint8_t>(kRtcpVersion << 6 | 1); // One report block
+	packet[1] = kPacketTypeReceiverReport;
+	Write16(packet + 2, static_cast<uint16_t>(size / 4 - 1));
+	Write32(packet + 4, senderSsrc);
+	uint8_t* report = packet + 8;
+	Write32(report, mediaSsrc);
+	Write32(report + 4, static_cast<uint32_t>(block.fractionLost) << 24 | (block.cumulativeLost & 0xFFFFFF));
+	Write32(report + 8, block.highestSequenceNumber);
+	Write32(report + 12, block.jitter);
+	// LSR and DLSR stay zero
+}
+
+bool BuildRtcpTransportFeedback(uint32_t senderSsrc, uint32_t mediaSsrc, const RtcpTransportFeedback& feedback,
+								std::vector<uint8_t>& out)
+{
+	const size_t count = feedback.arrivalOffsetsUs.size();
+	if (count == 0 || count > 0xFFFF)
+		return false;
+
+	// Deltas in 250 us steps, each from the previous arrival as encoded, so
+	// rounding never accumulates
+	std::vector<uint8_t> symbols(count);
+	std::vector<int32_t> deltas;
+	deltas.reserve(count);
+	int64_t previous = 0;
+	for (size_t i = 0; i < count; ++i)
+	{
+		const int64_t arrival = feedback.arrivalOffsetsUs[i];
+		if (arrival == RtcpTransportFeedback::kNotReceived)
+		{
+			symbols[i] = kNotReceived;
+			continue;
+		}
+		const int64_t delta = static_cast<int64_t>(std::llround(static_cast<double>(arrival - previous) / kDeltaUs));
+		if (delta < INT16_MIN || delta > INT16_MAX)
+			return false;
+		symbols[i] = delta >= 0 && delta <= 0xFF ? kSmallDelta : kLargeDelta;
+		deltas.push_back(static_cast<int32_t>(delta));
+		previous += delta * kDeltaUs;
+	}
+
+	// Status chunks: a run of one symbol, or a vector of 14 one-bit symbols
+	// (no large deltas) or 7 two-bit ones, whichever covers most
+	std::vector<uint16_t> chunks;
+	for (size_t i = 0; i < count;)
+	{
+		size_t run = 1;
+		while (i + run < count && run < 0x1FFF && symbols[i + run] == symbols[i])
+			++run;
+		const size_t vector14 = std::min<size_t>(14, count - i);
+		const bool oneBit = std::none_of(symbols.begin() + static_cast<ptrdiff_t>(i),
+										 symbols.begin() + static_cast<ptrdiff_t>(i + vector14),
+										 [](uint8_t symbol) { return symbol == kLargeDelta; });
+		if (run >= 14 || (run >= 7 && !oneBit))
+		{
+			chunks.push_back(static_cast<uint16_t>(symbols[i] << 13 | run));
+			i += run;
+		}
+		else if (oneBit)
+		{
+			uint16_t chunk = 0x8000;
+			for (size_t n = 0; n < vector14; ++n)
+				chunk |= static_cast<uint16_t>(symbols[i + n] << (13 - n));
+			chunks.push_back(chunk);
+			i += vector14;
+		}
+		else
+		{
+			const size_t vector7 = std::min<size_t>(7, count - i);
+			uint16_t chunk = 0xC000;
+			for (size_t n = 0; n < vector7; ++n)
+				chunk |= static_cast<uint16_t>(symbols[i + n] << (12 - 2 * n));
+			chunks.push_back(chunk);
+			i += vector7;
+		}
+	}
+
+	size_t deltaBytes = 0;
+	for (size_t i = 0; i < count; ++i)
+		deltaBytes += symbols[i]; // 1 or 2 bytes, as it happens
+	const size_t contentSize = kFeedbackHeaderSize + kTransportFeedbackFixedSize + chunks.size() * 2 + deltaBytes;
+	const size_t size = (contentSize + 3) & ~size_t(3);
+	uint8_t* packet = AppendFeedbackHeader(kFormatTransportFeedback, kPacketTypeRtpFeedback, senderSsrc, mediaSsrc,
+										   size, out);
+	uint8_t* fci = packet + kFeedbackHeaderSize;
+	Write16(fci, feedback.baseSequenceNumber);
+	Write16(fci + 2, static_cast<uint16_t>(count));
+	Write32(fci + 4, (feedback.referenceTime & 0xFFFFFF) << 8 | feedback.feedbackCount);
+	fci += kTransportFeedbackFixedSize;
+	for (uint16_t chunk : chunks)
+	{
+		Write16(fci, chunk);
+		fci += 2;
+	}
+	size_t next = 0;
+	for (size_t i = 0; i < count; ++i)
+	{
+		if (symbols[i] == kSmallDelta)
+			*fci++ = static_cast<uint8_t>(deltas[next++]);
+		else if (symbols[i] == kLargeDelta)
+		{
+			Write16(fci, static_cast<uint16_t>(static_cast<int16_t>(deltas[next++])));
+			fci += 2;
+		}
+	}
+	if (size != contentSize)
+	{
+		// Padding: zeros, the last byte counting them, and the P bit set
+		std::fill(fci, packet + size, uint8_t(0));
+		packet[size - 1] = static_cast<uint8_t>(size - contentSize);
+		packet[0] |= 0x20;
+	}
+	return true;
+}
+
+bool ParseRtcpFeedback(const uint8_t* data, size_t size, uint32_t mediaSsrc, RtcpFeedback& out)
+{
+	out.nacks.clear();
+	out.pictureLoss = false;
+	out.hasReport = false;
+	out.transportFeedback.clear();
+	size_t offset = 0;
+	while (offset < size)
+	{
+		if (size - offset < 4 || (data[offset] >> 6) != kRtcpVersion)
+			return false;
+		const uint8_t* packet = data + offset;
+		const size_t packetSize = (static_cast<size_t>(Read16(packet + 2)) + 1) * 4;
+		if (packetSize > size - offset)
+			return false;
+		offset += packetSize;
+
+		const uint8_t format = packet[0] & 0x1F;
+		const uint8_t packetType = packet[1];
+		if (packetType == kPacketTypeSenderReport || packetType == kPacketTypeReceiverReport)
+		{
+			// The format field is the report count here
+			size_t block = 8 + (packetType == kPacketTypeSenderReport ? kSenderInfoSize : 0);
+			for (int i = 0; i < format && block + kReportBlockSize <= packetSize; ++i, block += kReportBlockSize)
+			{
+				const uint8_t* report = packet + block;
+				if (Read32(report) != mediaSsrc)
+					continue;
+				out.hasReport = true;
+				out.report.fractionLost = report[4];
+				out.report.cumulativeLost = Read32(report + 4) & 0xFFFFFF;
+				out.report.highestSequenceNumber = Read32(report + 8);
+				out.report.jitter = Read32(report + 12);
+			}
+			continue;
+		}
+		if (packetSize < kFeedbackHeaderSize || Read32(packet + 8) != mediaSsrc)
+			continue;
+
+		if (packetType == kPacketTypeRtpFeedback && format == kFormatGenericNack)
+		{
+			for (size_t fci = kFeedbackHeaderSize; fci + 4 <= packetSize; fci += 4)
+			{
+				const uint16_t packetId = Read16(packet + fci);
+				const uint16_t bitmask = Read16(packet + fci + 2);
+				out.nacks.push_back(packetId);
+				for (int bit = 0; bit < 16; ++bit)
+				{
+					if (bitmask & (1u << bit))
+						out.nacks.push_back(static_cast<uint16_t>(packetId + bit + 1));
+				}
+			}
+		}
+		else if (packetType == kPacketTypeRtpFeedback && format == kFormatTransportFeedback)
+		{
+			if (!ParseTransportFeedback(packet, packetSize, out.transportFeedback.emplace_back()))
+				return false;
+		}
+		else if (packetType == kPacketTypePayloadFeedback && format == kFormatPli)
+		{
+			out.pictureLoss = true;
+		}
+	}
+	return true;
+}
@@ -0,0 +1,75 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <vector>
+
+// RTCP feedback messages for one video stream: generic NACK (RFC 4585
+// section 6.2.1) asks for lost packets to be resent, picture loss
+// indication (PLI, section 6.3.1) asks for a keyframe, and the receiver
+// report (RFC 3550 section 6.4.2) tells the sender how much is being lost. RTCP shares the RTP
+// socket (RFC 5761), so the receiver tells the two apart with IsRtcpPacket().
+// Transport-wide feedback tells the congestion controller when each packet
+// arrived.
+
+// RTCP packet types occupy 192-223 in the second byte, where RTP has its
+// marker bit and payload type
+bool IsRtcpPacket(const uint8_t* data, size_t size);
+
+// Appends one NACK packet covering as many of `sequenceNumbers` (ascending,
+// in 16-bit order) as fit in `maxSize` bytes; returns how many it covered.
+// Call again with the rest until all are covered.
+size_t BuildRtcpNack(uint32_t senderSsrc, uint32_t mediaSsrc, const uint16_t* sequenceNumbers, size_t count,
+					 size_t maxSize, std::vector<uint8_t>& out);
+void BuildRtcpPli(uint32_t senderSsrc, uint32_t mediaSsrc, std::vector<uint8_t>& out);
+
+// One report block of a receiver report
+struct RtcpReportBlock
+{
+	uint8_t fractionLost = 0;		 // Since the previous report, in 1/256ths
+	uint32_t cumulativeLost = 0;	 // 24 bits
+	uint32_t highestSequenceNumber = 0; // Extended with the wrap count
+	uint32_t jitter = 0;			 // Interarrival jitter in RTP clock units
+};
+
+// A receiver report with one block about `mediaSsrc`; no sender report
+// is sent, so the LSR and DLSR fields are zero
+void BuildRtcpReceiverReport(uint32_t senderSsrc, uint32_t mediaSsrc, const RtcpReportBlock& block,
+							 std::vector<uint8_t>& out);
+
+// Transport-wide congestion control feedback (RTPFB format 15, from
+// draft-holmer-rmcat-transport-wide-cc-extensions-01): whether and when
+// each packet of a run of transport-wide sequence numbers arrived. Times
+// travel in 250 us steps.
+struct RtcpTransportFeedback
+{
+	static constexpr int64_t kNotReceived = std::numeric_limits<int64_t>::min();
+
+	uint16_t baseSequenceNumber = 0;
+	uint32_t referenceTime = 0; // 24 bits, in 64 ms steps of the receiver's clock; wraps
+	uint8_t feedbackCount = 0;	// One more in each feedback packet, so lost ones show
+	// One entry per packet from baseSequenceNumber on: microseconds from
+	// referenceTime to its arrival, or kNotReceived
+	std::vector<int64_t> arrivalOffsetsUs;
+};
+
+// False if there are no packets, more than 65535, or two arrivals more
+// than 8 seconds apart
+bool BuildRtcpTransportFeedback(uint32_t senderSsrc, uint32_t mediaSsrc, const RtcpTransportFeedback& feedback,
+								std::vector<uint8_t>& out);
+
+// The feedback a compound RTCP packet carries about one media stream
+struct RtcpFeedback
+{
+	std::vector<uint16_t> nacks; // In the order requested
+	bool pictureLoss = false;
+	bool hasReport = false;
+	RtcpReportBlock report;
+	std::vector<RtcpTransportFeedback> transportFeedback;
+};
+
+// Walks a compound packet and collects the NACKs, PLIs, report blocks and
+// transport-wide feedback about `mediaSsrc`; other packet types are
+// skipped. False if malformed.
+bool ParseRtcpFeedback(const uint8_t* data, size_t size, uint32_t mediaSsrc, RtcpFeedback& out);
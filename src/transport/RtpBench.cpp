@@ -0,0 +1,791 @@
+// RTP send cost over loopback: packetizes a synthetic 4K H.264 or VP8
+// stream at 20 Mbit/s and sends it to a receiver on 127.0.0.1 with each
+// UdpSendMode, reporting system calls, send time per frame and what arrived.
+// The receiver reassembles frames through a JitterBuffer and checks each one
+// against what was sent.
+//
+//   rtp_bench [--codec h264|vp8] [--frames N] [--kbps N] [--mtu N]
+//             [--loss PERCENT] [--burst N] [--delay MS] [--bottleneck KBPS]
+//
+// Frames are sent back to back rather than paced, so the numbers are the
+// cost of sending, not a realistic arrival pattern. Packets the receiver
+// never saw are reported as lost: GSO sends each run as one burst, which
+// can overflow even a loopback receiver's buffer.
+//
+// With --loss the sender instead paces frames in real time through a
+// LinkSimulator that drops that share of the packets, in bursts of --burst
+// on average, and delays the rest by --delay. The stream is run with
+// keyframe requests alone, then NACK/RTX, FEC, and both; the time from
+// sending a frame to the receiver releasing it shows what each recovery
+// costs, and FEC follows the loss the receiver reports. The media packets
+// lost are the same every run, but whether a repair beats the jitter
+// buffer's wait depends on timing, so frame counts vary between runs,
+// most of all for NACK alone; compare several.
+//
+// With --bottleneck the link also has that bandwidth, halved for the middle
+// third of the run as if another flow had started, with a 300 ms drop-tail
+// queue. The stream (NACK and FEC on) is sent once at a fixed --kbps and
+// once under the CongestionController, whose estimate sets the frame size
+// and rate through a VideoRateAdapter; the second run prints the estimate
+// each second, then how long after the halving it first saw overuse.
+// Latency is what congestion costs. In that run a synthetic 4K
+// capture is the frame clock: the adapter changes its targetFps live, as it
+// would a real capture's, and a frame is sent for each one it delivers, so
+// the run checks that capture pacing follows the estimate. An encoder built
+// into the tree encodes those pictures and is steered too, but the wire
+// still carries the synthetic stream: a static desktop would not load the
+// link.
+
+#include "CongestionController.h"
+#include "FecDecoder.h"
+#include "FecEncoder.h"
+#include "JitterBuffer.h"
+#include "LinkSimulator.h"
+#include "NackGenerator.h"
+#include "RtcpPacket.h"
+#include "RtpPacketizer.h"
+#include "RtpReceiveStatistics.h"
+#include "RtpRetransmitter.h"
+#include "TransportFeedbackGenerator.h"
+#include "UdpSocket.h"
+#include "VideoRateAdapter.h"
+#include "../capture/synthetic/SyntheticGraphicsCapture.h"
+#include "../video/ColorConversion.h"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+namespace
+{
+	struct Options
+	{
+		VideoCodec codec = VideoCodec::H264;
+		int frames = 600;
+		int kbps = 20000;
+		int fps = 30;
+		size_t maxPacketSize = 1200;
+		double lossPercent = 0.0;
+		double burstLength = 1.0;
+		int delayMs = 0;
+		int bottleneckKbps = 0;
+	};
+
+	using Clock = std::chrono::steady_clock;
+
+	// Pseudo-random bytes that never form an Annex B start code
+	void FillPayload(uint8_t* data, size_t size, uint32_t& seed)
+	{
+		for (size_t i = 0; i < size; ++i)
+		{
+			seed = seed * 1664525u + 1013904223u;
+			data[i] = static_cast<uint8_t>(1 + (seed >> 24) % 255);
+		}
+	}
+
+	// An access unit shaped like the real encoders' output: for H.264 one
+	// slice per encoder thread, with SPS and PPS ahead of keyframes
+	void MakeFrame(const Options& options, int index, uint32_t& seed, EncodedFrame& frame, bool forceKeyframe = false)
+	{
+		const bool keyframe = forceKeyframe || index % (options.fps * 4) == 0;
+		// Keyframes take 200 ms of the stream whatever the frame rate, like
+		// an encoder's at a given quality
+		const size_t averageBytes = static_cast<size_t>(options.kbps) * 1000 / 8 / options.fps;
+		const size_t bytes = keyframe ? static_cast<size_t>(options.kbps) * 1000 / 8 / 5 : averageBytes * 9 / 10;
+
+		frame.data.clear();
+		frame.timestampNs = static_cast<uint64_t>(index) * 1'000'000'000ull / options.fps;
+		frame.isKeyframe = keyframe;
+		if (options.codec == VideoCodec::VP8)
+		{
+			frame.data.resize(bytes);
+			FillPayload(frame.data.data(), bytes, seed);
+			frame.data[0] = keyframe ? 0x10 : 0x11; // Frame tag: P bit clear on keyframes
+			return;
+		}
+
+		auto addNal = [&](uint8_t header, size_t size) {
+			const uint8_t startCode[] = { 0, 0, 0, 1, header };
+			const size_t offset = frame.data.size();
+			frame.data.resize(offset + sizeof(startCode) + size);
+			std::memcpy(frame.data.data() + offset, startCode, sizeof(startCode));
+			FillPayload(frame.data.data() + offset + sizeof(startCode), size, seed);
+		};
+		if (keyframe)
+		{
+			addNal(0x67, 14); // SPS
+			addNal(0x68, 4);  // PPS
+		}
+		constexpr int kSlices = 8;
+		for (int slice = 0; slice < kSlices; ++slice)
+			addNal(keyframe ? 0x65 : 0x41, bytes / kSlices);
+	}
+
+	const char* GetModeName(UdpSendMode mode)
+	{
+		switch (mode)
+		{
+		case UdpSendMode::Single: return "single";
+		case UdpSendMode::Batched: return "batched";
+		case UdpSendMode::Segmented: return "gso";
+		}
+		return "?";
+	}
+
+	bool RunBench(UdpSendMode mode, const Options& options)
+	{
+		UdpSocket receiver;
+		UdpSocket sender;
+		if (!receiver.Open("127.0.0.1", 0) || !sender.Open("127.0.0.1", 0) ||
+			!sender.Connect("127.0.0.1", receiver.GetLocalPort()) ||
+			!receiver.Connect("127.0.0.1", sender.GetLocalPort()))
+			return false;
+		sender.SetSendMode(mode);
+		if (sender.GetSendMode() != mode)
+		{
+			std::printf("%-8s not supported on this system\n", GetModeName(mode));
+			return false;
+		}
+
+		// Frames are regenerated from the same seed on the receiving side
+		std::atomic<bool> done = false;
+		uint64_t received = 0;
+		uint64_t outOfOrder = 0;
+		int framesMatched = 0;
+		JitterBuffer jitterBuffer(options.codec);
+		std::thread receiveThread([&] {
+			std::vector<uint8_t> buffer(65536);
+			int lastSequence = -1;
+			ReassembledFrame reassembled;
+			EncodedFrame expected;
+			uint32_t expectedSeed = 1;
+			int expectedIndex = 0;
+			while (true)
+			{
+				const int size = receiver.Receive(buffer.data(), buffer.size(), 100);
+				if (size <= 0)
+				{
+					if (done)
+						break;
+					continue;
+				}
+				const int sequence = buffer[2] << 8 | buffer[3];
+				if (lastSequence >= 0 && sequence != ((lastSequence + 1) & 0xFFFF))
+					++outOfOrder;
+				lastSequence = sequence;
+				++received;
+
+				jitterBuffer.InsertPacket(buffer.data(), static_cast<size_t>(size), Clock::now());
+				while (jitterBuffer.PopFrame(reassembled, Clock::now()))
+				{
+					MakeFrame(options, expectedIndex++, expectedSeed, expected);
+					framesMatched += reassembled.data == expected.data ? 1 : 0;
+				}
+			}
+		});
+
+		RtpPacketizerConfig config;
+		config.maxPacketSize = options.maxPacketSize;
+		RtpPacketizer packetizer(options.codec, config);
+		EncodedFrame frame;
+		std::vector<RtpPacket> packets;
+		uint32_t seed = 1;
+		std::vector<double> sendUs;
+		sendUs.reserve(options.frames);
+		double packetizeUs = 0.0;
+		uint64_t packetCount = 0;
+		for (int i = 0; i < options.frames; ++i)
+		{
+			MakeFrame(options, i, seed, frame);
+			const auto start = Clock::now();
+			packetizer.Packetize(frame, packets);
+			const auto packetized = Clock::now();
+			sender.Send(packets.data(), packets.size());
+			const auto sent = Clock::now();
+			packetizeUs += std::chrono::duration<double, std::micro>(packetized - start).count();
+			sendUs.push_back(std::chrono::duration<double, std::micro>(sent - packetized).count());
+			packetCount += packets.size();
+		}
+
+		done = true;
+		receiveThread.join();
+
+		const UdpSocketStatistics& stats = sender.GetStatistics();
+		const JitterBufferStatistics jitterStats = jitterBuffer.GetStatistics();
+		const uint64_t lost = stats.packetsSent > received ? stats.packetsSent - received : 0;
+		double totalUs = 0.0;
+		for (double us : sendUs)
+			totalUs += us;
+		std::sort(sendUs.begin(), sendUs.end());
+		std::printf("%-8s %6.1f packets/frame  %6.2f calls/frame  send %7.1f us/frame (p99 %7.1f)  %5.2f us/packet  "
+					"packetize %5.2f us/frame  received %llu/%llu, %llu lost (%.1f%%), %llu out of order  "
+					"frames %d/%d intact, %llu incomplete, buffer delay %.2f ms\n",
+					GetModeName(mode), static_cast<double>(packetCount) / options.frames,
+					static_cast<double>(stats.sendCalls) / options.frames, totalUs / options.frames,
+					sendUs[std::min(sendUs.size() - 1, sendUs.size() * 99 / 100)], totalUs / packetCount,
+					packetizeUs / options.frames, static_cast<unsigned long long>(received),
+					static_cast<unsigned long long>(stats.packetsSent), static_cast<unsigned long long>(lost),
+					stats.packetsSent ? 100.0 * static_cast<double>(lost) / static_cast<double>(stats.packetsSent) : 0.0,
+					static_cast<unsigned long long>(outOfOrder), framesMatched, options.frames,
+					static_cast<unsigned long long>(jitterStats.framesIncomplete), jitterStats.averageBufferDelayMs);
+		return true;
+	}
+
+	struct SentFrame
+	{
+		std::shared_ptr<const EncodedFrame> frame;
+		Clock::time_point sendTime;
+	};
+
+	// How the loss bench repairs losses, and whether the rate follows the
+	// congestion controller; keyframe requests are always on
+	struct Recovery
+	{
+		const char* name;
+		bool nack;
+		bool fec;
+		bool congestionControl = false;
+	};
+
+	const char* GetUsageName(BandwidthUsage usage)
+	{
+		switch (usage)
+		{
+		case BandwidthUsage::Normal: return "normal";
+		case BandwidthUsage::Underusing: return "underusing";
+		case BandwidthUsage::Overusing: return "overusing";
+		}
+		return "?";
+	}
+
+	// Starts a static synthetic desktop delivering `fps` frames a second,
+	// counted in `framesCaptured`; `encoder`, when not null, encodes each one
+	std::unique_ptr<SyntheticGraphicsCapture> StartPacingCapture(int width, int height, int fps, IVideoEncoder* encoder,
+																   std::atomic<int>& framesCaptured)
+	{
+		SyntheticCaptureConfig syntheticConfig;
+		syntheticConfig.width = width;
+		syntheticConfig.height = height;
+		auto capture = std::make_unique<SyntheticGraphicsCapture>(syntheticConfig);
+		CaptureConfig config;
+		config.quality = CaptureQuality::High;
+		config.targetFps = fps;
+		config.cursorMode = CursorMode::Hidden;
+		config.detectChanges = false;
+		if (!capture->Initialize() || !capture->SetCaptureConfig(config))
+			return nullptr;
+
+		// Called on the capture's worker thread only
+		struct EncodeState
+		{
+			ColorConverter converter;
+			std::vector<uint8_t> yuv;
+			EncodedFrame encoded;
+		};
+		auto state = std::make_shared<EncodeState>();
+		capture->SetFrameCallback([encoder, state, &framesCaptured](const FrameData& frame) {
+			if (encoder)
+			{
+				state->yuv.resize(ColorConverter::GetBufferSize(YuvFormat::I420, frame.width, frame.height));
+				state->converter.Convert(frame, YuvFormat::I420,
+										 ColorConverter::GetPlanes(YuvFormat::I420, state->yuv.data(), frame.width,
+																   frame.height));
+				encoder->Encode(IVideoEncoder::I420View::FromBuffer(state->yuv.data(), frame.width, frame.height),
+								frame.timestampNs, state->encoded);
+			}
+			++framesCaptured;
+		});
+		if (!capture->StartCapture(SyntheticGraphicsCapture::GetSourceId(SyntheticContent::StaticDesktop)))
+			return nullptr;
+		return capture;
+	}
+
+	bool RunLossBench(const Recovery& recovery, const Options& options)
+	{
+		UdpSocket receiver;
+		UdpSocket sender;
+		if (!receiver.Open("127.0.0.1", 0) || !sender.Open("127.0.0.1", 0) ||
+			!sender.Connect("127.0.0.1", receiver.GetLocalPort()) ||
+			!receiver.Connect("127.0.0.1", sender.GetLocalPort()))
+			return false;
+
+		constexpr uint8_t kTransportSequenceId = 5;
+		RtpPacketizerConfig config;
+		config.maxPacketSize = options.maxPacketSize;
+		config.transportSequenceId = recovery.congestionControl ? kTransportSequenceId : 0;
+		RtpPacketizer packetizer(options.codec, config);
+		RtpRetransmitter retransmitter;
+		FecConfig fecConfig;
+		fecConfig.transportSequenceId = config.transportSequenceId;
+		FecEncoder fecEncoder(fecConfig);
+		const uint32_t mediaSsrc = packetizer.GetSsrc();
+		const uint8_t mediaPayloadType = packetizer.GetPayloadType();
+		const uint8_t rtxPayloadType = retransmitter.GetPayloadType();
+		const uint8_t fecPayloadType = fecEncoder.GetPayloadType();
+		constexpr uint32_t kReceiverSsrc = 1;
+		constexpr auto kReportInterval = std::chrono::milliseconds(200);
+		constexpr auto kFeedbackInterval = std::chrono::milliseconds(50);
+
+		// What was sent, by RTP timestamp, for the receiver to check against
+		std::mutex sentMutex;
+		std::unordered_map<uint32_t, SentFrame> sent;
+
+		std::atomic<bool> done = false;
+		int framesReleased = 0;
+		int framesMatched = 0;
+		std::vector<double> latencyMs;
+		JitterBufferStatistics jitterStats;
+		NackStatistics nackStats;
+		FecDecoderStatistics fecStats;
+		std::thread receiveThread([&] {
+			JitterBuffer jitterBuffer(options.codec);
+			NackGenerator nackGenerator;
+			FecDecoder fecDecoder;
+			RtpReceiveStatistics receiveStatistics;
+			TransportFeedbackGenerator feedbackGenerator;
+			std::vector<uint8_t> buffer(65536);
+			uint8_t restored[JitterBuffer::kMaxPacketSize];
+			ReassembledFrame reassembled;
+			std::vector<RtpSlice> recovered;
+			std::vector<uint16_t> nackList;
+			std::vector<uint8_t> rtcp;
+			auto nextReport = Clock::now() + kReportInterval;
+			auto nextFeedback = Clock::now() + kFeedbackInterval;
+
+			auto insertRecovered = [&](Clock::time_point now) {
+				for (const RtpSlice& packet : recovered)
+				{
+					nackGenerator.OnPacket(static_cast<uint16_t>(packet.data[2] << 8 | packet.data[3]), false, now);
+					jitterBuffer.InsertPacket(packet.data, packet.size, now);
+				}
+				recovered.clear();
+			};
+			auto insertMedia = [&](const uint8_t* data, size_t size, uint16_t sequence, bool retransmitted,
+								   Clock::time_point now) {
+				nackGenerator.OnPacket(sequence, retransmitted, now);
+				jitterBuffer.InsertPacket(data, size, now);
+				fecDecoder.OnMediaPacket(data, size, recovered);
+				insertRecovered(now);
+			};
+
+			while (!done)
+			{
+				const int size = receiver.Receive(buffer.data(), buffer.size(), 2);
+				const auto now = Clock::now();
+				RtpHeader header;
+				if (size > 0 && ParseRtpHeader(buffer.data(), static_cast<size_t>(size), header))
+				{
+					// Everything on the wire counts, before any restoring
+					uint16_t transportSequence = 0;
+					if (recovery.congestionControl &&
+						ReadTransportSequenceNumber(header, kTransportSequenceId, transportSequence))
+						feedbackGenerator.OnPacket(transportSequence, now);
+
+					if (header.payloadType == fecPayloadType)
+					{
+						fecDecoder.OnFecPacket(buffer.data(), static_cast<size_t>(size), recovered);
+						insertRecovered(now);
+					}
+					else if (header.payloadType == rtxPayloadType)
+					{
+						const size_t restoredSize =
+							RestoreRtxPacket(header, mediaPayloadType, mediaSsrc, restored, sizeof(restored));
+						if (restoredSize && ParseRtpHeader(restored, restoredSize, header))
+							insertMedia(restored, restoredSize, header.sequenceNumber, true, now);
+					}
+					else
+					{
+						receiveStatistics.OnPacket(header.sequenceNumber);
+						insertMedia(buffer.data(), static_cast<size_t>(size), header.sequenceNumber, false, now);
+					}
+				}
+
+				while (jitterBuffer.PopFrame(reassembled, now))
+				{
+					if (reassembled.isKeyframe)
+						nackGenerator.ClearBefore(reassembled.firstSequenceNumber);
+					std::lock_guard lock(sentMutex);
+					auto it = sent.find(reassembled.rtpTimestamp);
+					if (it == sent.end())
+						continue;
+					++framesReleased;
+					framesMatched += reassembled.data == it->second.frame->data ? 1 : 0;
+					latencyMs.push_back(std::chrono::duration<double, std::milli>(now - it->second.sendTime).count());
+					sent.erase(it);
+				}
+
+				rtcp.clear();
+				if (recovery.nack)
+				{
+					jitterBuffer.SetRetransmissionDelay(nackGenerator.GetRepairDelayMs());
+					nackGenerator.GetNackList(now, nackList);
+					for (size_t covered = 0; covered < nackList.size();)
+						covered += BuildRtcpNack(kReceiverSsrc, mediaSsrc, nackList.data() + covered,
+												 nackList.size() - covered, options.maxPacketSize, rtcp);
+				}
+				// Both are drained so a request from either reaches the sender
+				const bool jitterBufferWantsKeyframe = jitterBuffer.TakeKeyframeRequest();
+				if (nackGenerator.TakeKeyframeRequest() || jitterBufferWantsKeyframe)
+					BuildRtcpPli(kReceiverSsrc, mediaSsrc, rtcp);
+				if (now >= nextReport)
+				{
+					RtcpReportBlock report;
+					const double jitter = jitterBuffer.GetStatistics().jitterMs * (kRtpVideoClockRate / 1000.0);
+					receiveStatistics.MakeReport(static_cast<uint32_t>(jitter), report);
+					BuildRtcpReceiverReport(kReceiverSsrc, mediaSsrc, report, rtcp);
+					nextReport = now + kReportInterval;
+				}
+				if (recovery.congestionControl && now >= nextFeedback)
+				{
+					feedbackGenerator.BuildFeedback(kReceiverSsrc, mediaSsrc, rtcp);
+					nextFeedback = now + kFeedbackInterval;
+				}
+				if (!rtcp.empty())
+					receiver.SendDatagram(rtcp.data(), rtcp.size());
+			}
+			jitterStats = jitterBuffer.GetStatistics();
+			nackStats = nackGenerator.GetStatistics();
+			fecStats = fecDecoder.GetStatistics();
+		});
+
+		LinkConfig linkConfig;
+		linkConfig.lossPercent = options.lossPercent;
+		linkConfig.meanBurstLength = options.burstLength;
+		linkConfig.delayMs = options.delayMs;
+		linkConfig.bandwidthKbps = options.bottleneckKbps;
+		CongestionControlConfig ccConfig;
+		ccConfig.startBitrateKbps = std::min(options.kbps, 1500);
+		ccConfig.maxBitrateKbps = options.kbps;
+		CongestionController congestionController(ccConfig);
+		VideoRateConfig rateConfig;
+		rateConfig.width = 3840; // The synthetic stream stands for a 4K screen
+		rateConfig.height = 2160;
+		rateConfig.maxFps = options.fps;
+
+		// Under congestion control the capture sets the frame rate; see the top
+		std::unique_ptr<IVideoEncoder> encoder;
+		std::unique_ptr<SyntheticGraphicsCapture> capture;
+		std::atomic<int> framesCaptured = 0;
+		if (recovery.congestionControl)
+		{
+			encoder = IVideoEncoder::Create(options.codec);
+			VideoEncoderConfig encoderConfig;
+			encoderConfig.codec = options.codec;
+			encoderConfig.width = rateConfig.width;
+			encoderConfig.height = rateConfig.height;
+			encoderConfig.bitrateKbps = ccConfig.startBitrateKbps;
+			encoderConfig.fps = options.fps;
+			if (encoder && !encoder->Initialize(encoderConfig))
+				encoder.reset();
+			capture = StartPacingCapture(rateConfig.width, rateConfig.height, options.fps, encoder.get(), framesCaptured);
+			if (!capture)
+			{
+				std::printf("%-8s synthetic capture failed to start\n", recovery.name);
+				done = true;
+				receiveThread.join();
+				return false;
+			}
+		}
+		VideoRateAdapter rateAdapter(encoder.get(), capture.get(), rateConfig);
+		VideoRates rates = { options.kbps, options.fps };
+		int fpsChanges = 0;
+		int fpsMismatches = 0; // Seconds the capture's targetFps was not the adapter's
+		double reactionMs = -1.0; // From halving the link to the first overuse after it
+		int reactionTargetKbps = 0;
+		auto updateRates = [&](double protection) {
+			const int fps = rates.fps;
+			rates = rateAdapter.Update(congestionController.GetTargetBitrateKbps(), protection);
+			fpsChanges += rates.fps != fps ? 1 : 0;
+		};
+		if (recovery.congestionControl)
+			updateRates(0.0);
+		std::vector<RtpPacket> packets;
+		std::vector<RtpPacket> repairs;
+		std::vector<uint8_t> buffer(2048);
+		RtcpFeedback feedback;
+		bool forceKeyframe = false;
+		uint64_t mediaBytes = 0;
+		int keyframesRequested = 0;
+		int framesSent = 0;
+		LinkStatistics linkStats;
+		{
+			LinkSimulator link(sender, linkConfig);
+
+			// Answers feedback until `deadline`
+			auto serviceFeedback = [&](Clock::time_point deadline) {
+				for (auto now = Clock::now(); now < deadline; now = Clock::now())
+				{
+					const int timeoutMs =
+						static_cast<int>(std::chrono::ceil<std::chrono::milliseconds>(deadline - now).count());
+					const int size = sender.Receive(buffer.data(), buffer.size(), timeoutMs);
+					if (size <= 0 || !IsRtcpPacket(buffer.data(), static_cast<size_t>(size)) ||
+						!ParseRtcpFeedback(buffer.data(), static_cast<size_t>(size), mediaSsrc, feedback))
+						continue;
+					forceKeyframe |= feedback.pictureLoss;
+					if (feedback.hasReport)
+						fecEncoder.SetLossRate(feedback.report.fractionLost / 256.0);
+					for (const RtcpTransportFeedback& transport : feedback.transportFeedback)
+						congestionController.OnTransportFeedback(transport, Clock::now());
+					if (recovery.congestionControl && !feedback.transportFeedback.empty())
+					{
+						retransmitter.SetRtt(congestionController.GetRttMs());
+						updateRates(fecEncoder.GetProtection(false));
+					}
+					if (!feedback.nacks.empty())
+					{
+						repairs.clear();
+						retransmitter.OnNack(feedback.nacks.data(), feedback.nacks.size(), Clock::now(), repairs);
+						congestionController.OnSendPackets(repairs.data(), repairs.size(), Clock::now());
+						link.Send(repairs.data(), repairs.size());
+					}
+				}
+			};
+
+			// Under congestion control the frame rate may drop, so run for as
+			// long as --frames take at full rate instead
+			const auto start = Clock::now();
+			const auto duration = std::chrono::nanoseconds(1'000'000'000ll * options.frames / options.fps);
+			int bottleneckKbps = options.bottleneckKbps;
+			Clock::time_point halvedAt;
+			uint64_t overuseEventsAtHalving = 0;
+			auto nextPrint = start + std::chrono::seconds(1);
+			int framesCapturedAtPrint = framesCaptured;
+			auto deadline = start;
+			uint32_t seed = 1;
+			for (int i = 0; capture ? Clock::now() - start < duration : i < options.frames; ++i)
+			{
+				if (capture)
+				{
+					while (framesCaptured <= i && Clock::now() - start < duration)
+						serviceFeedback(Clock::now() + std::chrono::milliseconds(1));
+					if (framesCaptured <= i)
+						break;
+				}
+				else
+				{
+					serviceFeedback(deadline);
+					deadline += std::chrono::nanoseconds(1'000'000'000 / rates.fps);
+				}
+
+				if (options.bottleneckKbps > 0)
+				{
+					// Another flow takes half the link for the middle third
+					const auto elapsed = Clock::now() - start;
+					const int bandwidth =
+						elapsed >= duration / 3 && elapsed < duration * 2 / 3 ? options.bottleneckKbps / 2
+																			   : options.bottleneckKbps;
+					if (bandwidth != bottleneckKbps)
+					{
+						link.SetBandwidth(bottleneckKbps = bandwidth);
+						if (bandwidth < options.bottleneckKbps)
+						{
+							halvedAt = Clock::now();
+							overuseEventsAtHalving = congestionController.GetStatistics().overuseEvents;
+						}
+					}
+				}
+				if (recovery.congestionControl && halvedAt != Clock::time_point{} && reactionMs < 0.0 &&
+					congestionController.GetStatistics().overuseEvents > overuseEventsAtHalving)
+				{
+					reactionMs = std::chrono::duration<double, std::milli>(Clock::now() - halvedAt).count();
+					reactionTargetKbps = congestionController.GetTargetBitrateKbps();
+				}
+				if (capture && Clock::now() >= nextPrint)
+				{
+					const CongestionStatistics cc = congestionController.GetStatistics();
+					const LinkStatistics linkNow = link.GetStatistics();
+					const int captureFps = capture->GetCaptureConfig().targetFps;
+					fpsMismatches += captureFps != rates.fps ? 1 : 0;
+					std::printf("  %4.1f s  link %5d kbps  target %5d (delay %5d, loss %5d)  acked %7.1f  encoder %5d kbps "
+								"at %2d fps  capture %2d fps (%2d delivered)  queue %5.1f ms  rtt %5.1f ms  %s\n",
+								std::chrono::duration<double>(Clock::now() - start).count(), bottleneckKbps,
+								cc.targetBitrateKbps, cc.delayBasedKbps, cc.lossBasedKbps, cc.ackedBitrateKbps,
+								rates.bitrateKbps, rates.fps, captureFps, framesCaptured - framesCapturedAtPrint,
+								linkNow.queueDelayMs, cc.rttMs, GetUsageName(cc.usage));
+					framesCapturedAtPrint = framesCaptured;
+					nextPrint += std::chrono::seconds(1);
+				}
+
+				auto frame = std::make_shared<EncodedFrame>();
+				keyframesRequested += forceKeyframe ? 1 : 0;
+				Options frameOptions = options;
+				frameOptions.kbps = rates.bitrateKbps;
+				frameOptions.fps = rates.fps;
+				MakeFrame(frameOptions, i, seed, *frame, std::exchange(forceKeyframe, false));
+				frame->timestampNs = static_cast<uint64_t>(std::chrono::nanoseconds(Clock::now() - start).count());
+				packetizer.Packetize(*frame, packets);
+				const auto now = Clock::now();
+				{
+					std::lock_guard lock(sentMutex);
+					sent[packets.front().GetTimestamp()] = { frame, now };
+				}
+				++framesSent;
+				congestionController.OnSendPackets(packets.data(), packets.size(), now);
+				link.Send(packets.data(), packets.size());
+				for (const RtpPacket& packet : packets)
+					mediaBytes += packet.size;
+				retransmitter.OnPacketsSent(frame, packets.data(), packets.size(), now);
+				if (recovery.fec)
+				{
+					repairs.clear();
+					fecEncoder.ProtectFrame(packets.data(), packets.size(), frame->isKeyframe, repairs);
+					congestionController.OnSendPackets(repairs.data(), repairs.size(), now);
+					link.Send(repairs.data(), repairs.size());
+				}
+			}
+			if (capture)
+				capture->StopCapture();
+			// Let the last frames be repaired
+			serviceFeedback(Clock::now() + std::chrono::milliseconds(500 + options.delayMs));
+			linkStats = link.GetStatistics();
+		}
+		done = true;
+		receiveThread.join();
+
+		const RtxStatistics& rtxStats = retransmitter.GetStatistics();
+		const FecStatistics fecSent = fecEncoder.GetStatistics();
+		std::sort(latencyMs.begin(), latencyMs.end());
+		double totalMs = 0.0;
+		for (double ms : latencyMs)
+			totalMs += ms;
+		const auto percentile = [&](int p) {
+			return latencyMs.empty() ? 0.0 : latencyMs[std::min(latencyMs.size() - 1, latencyMs.size() * p / 100)];
+		};
+		std::printf("%-8s frames %d/%d released (%d intact), %llu abandoned, %d keyframes requested  "
+					"packets lost %llu, repaired by rtx %llu (%llu sent), by fec %llu (%.1f%% overhead)  "
+					"latency avg %.1f ms, p95 %.1f, max %.1f\n",
+					recovery.name, framesReleased, framesSent, framesMatched,
+					static_cast<unsigned long long>(jitterStats.framesIncomplete), keyframesRequested,
+					static_cast<unsigned long long>(linkStats.packetsDropped),
+					static_cast<unsigned long long>(nackStats.packetsRecovered),
+					static_cast<unsigned long long>(rtxStats.packetsRetransmitted),
+					static_cast<unsigned long long>(fecStats.packetsRecovered),
+					mediaBytes ? 100.0 * static_cast<double>(fecSent.fecBytes) / static_cast<double>(mediaBytes) : 0.0,
+					latencyMs.empty() ? 0.0 : totalMs / latencyMs.size(), percentile(95),
+					latencyMs.empty() ? 0.0 : latencyMs.back());
+		if (options.bottleneckKbps > 0)
+			std::printf("%-8s bottleneck queue max %.1f ms, %llu packets overflowed\n", "",
+						linkStats.maxQueueDelayMs, static_cast<unsigned long long>(linkStats.packetsOverflowed));
+		if (recovery.congestionControl && options.bottleneckKbps > 0)
+		{
+			if (reactionMs >= 0.0)
+				std::printf("%-8s overuse detected %.0f ms after the link halved, target cut to %d kbps\n", "",
+							reactionMs, reactionTargetKbps);
+			else
+				std::printf("%-8s overuse never detected after the link halved\n", "");
+		}
+		if (capture)
+		{
+			if (fpsMismatches)
+				std::printf("%-8s capture frame rate changed %d times, off the adapter's for %d s\n", "", fpsChanges,
+							fpsMismatches);
+			else
+				std::printf("%-8s capture frame rate changed %d times, always the adapter's\n", "", fpsChanges);
+			if (encoder)
+			{
+				const VideoEncoderConfig encoderConfig = encoder->GetConfig();
+				std::printf("%-8s %s encoder ended at %d kbps, %d fps (adapter %d kbps, %d fps)\n", "",
+							encoder->GetName().data(), encoderConfig.bitrateKbps, encoderConfig.fps, rates.bitrateKbps,
+							rates.fps);
+			}
+		}
+		return fpsMismatches == 0;
+	}
+}
+
+int main(int argc, char** argv)
+{
+	Options options;
+	for (int i = 1; i < argc; ++i)
+	{
+		const std::string arg = argv[i];
+		const bool hasValue = i + 1 < argc;
+		if (arg == "--codec" && hasValue)
+		{
+			const std::string codec = argv[++i];
+			if (codec == "h264")
+				options.codec = VideoCodec::H264;
+			else if (codec == "vp8")
+				options.codec = VideoCodec::VP8;
+			else
+			{
+				std::fprintf(stderr, "Unknown codec: %s\n", codec.c_str());
+				return 1;
+			}
+		}
+		else if (arg == "--frames" && hasValue)
+		{
+			options.frames = std::max(std::atoi(argv[++i]), 1);
+		}
+		else if (arg == "--kbps" && hasValue)
+		{
+			options.kbps = std::max(std::atoi(argv[++i]), 100);
+		}
+		else if (arg == "--mtu" && hasValue)
+		{
+			options.maxPacketSize = static_cast<size_t>(std::clamp(std::atoi(argv[++i]), 200, 9000));
+		}
+		else if (arg == "--loss" && hasValue)
+		{
+			options.lossPercent = std::clamp(std::atof(argv[++i]), 0.0, 50.0);
+		}
+		else if (arg == "--burst" && hasValue)
+		{
+			options.burstLength = std::max(std::atof(argv[++i]), 1.0);
+		}
+		else if (arg == "--delay" && hasValue)
+		{
+			options.delayMs = std::clamp(std::atoi(argv[++i]), 0, 1000);
+		}
+		else if (arg == "--bottleneck" && hasValue)
+		{
+			options.bottleneckKbps = std::max(std::atoi(argv[++i]), 100);
+		}
+		else
+		{
+			std::fprintf(stderr, "Usage: %s [--codec h264|vp8] [--frames N] [--kbps N] [--mtu N] [--loss PERCENT] [--burst N] "
+						 "[--delay MS] [--bottleneck KBPS]\n",
+						 argv[0]);
+			return 1;
+		}
+	}
+
+	std::printf("%s, %d kbps, %d frames, %zu-byte packets\n", IVideoEncoder::GetCodecName(options.codec).data(),
+				options.kbps, options.frames, options.maxPacketSize);
+	bool anyRan = false;
+	if (options.bottleneckKbps > 0)
+	{
+		std::printf("%d kbps bottleneck (%d kbps for the middle third), %.1f%% packet loss, %d ms delay\n",
+					options.bottleneckKbps, options.bottleneckKbps / 2, options.lossPercent, options.delayMs);
+		// Fails if the capture's frame rate did not follow the estimate
+		const Recovery recoveries[] = { { "fixed", true, true, false }, { "gcc", true, true, true } };
+		bool allPassed = true;
+		for (const Recovery& recovery : recoveries)
+			allPassed &= RunLossBench(recovery, options);
+		return allPassed ? 0 : 1;
+	}
+	if (options.lossPercent > 0.0)
+	{
+		std::printf("%.1f%% packet loss in bursts of %.1f, %d ms delay, paced at %d fps\n", options.lossPercent,
+					options.burstLength, options.delayMs, options.fps);
+		const Recovery recoveries[] = {
+			{ "pli only", false, false }, { "nack", true, false }, { "fec", false, true }, { "nack+fec", true, true }
+		};
+		for (const Recovery& recovery : recoveries)
+			anyRan |= RunLossBench(recovery, options);
+		return anyRan ? 0 : 1;
+	}
+	for (UdpSendMode mode : { UdpSendMode::Single, UdpSendMode::Batched, UdpSendMode::Segmented })
+		anyRan |= RunBench(mode, options);
+	return anyRan ? 0 : 1;
+}
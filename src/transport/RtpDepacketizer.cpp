@@ -0,0 +1,247 @@
+#include "RtpDepacketizer.h"
+
+#include <cstring>
+
+namespace
+{
+	constexpr uint8_t kNalTypeIdr = 5;
+	constexpr uint8_t kNalTypeSps = 7;
+	constexpr uint8_t kNalTypeAud = 9;
+	constexpr uint8_t kNalTypeStapA = 24;
+	constexpr uint8_t kNalTypeFuA = 28;
+	constexpr uint8_t kStartCode[] = { 0, 0, 0, 1 };
+
+	// Bytes of the RFC 7741 payload descriptor, or 0 if it is truncated
+	size_t Vp8DescriptorSize(const uint8_t* payload, size_t size)
+	{
+		size_t offset = 1;
+		if (size < 1)
+			return 0;
+		if (payload[0] & 0x80) // X: extension byte follows
+		{
+			if (size < 2)
+				return 0;
+			const uint8_t extension = payload[1];
+			offset = 2;
+			if (extension & 0x80) // I: PictureID, 7 or 15 bits
+			{
+				if (size <= offset)
+					return 0;
+				offset += (payload[offset] & 0x80) ? 2 : 1;
+			}
+			if (extension & 0x40) // L: TL0PICIDX
+				++offset;
+			if (extension & 0x30) // T or K: TID/KEYIDX byte
+				++offset;
+		}
+		return offset <= size ? offset : 0;
+	}
+
+	void AppendNal(uint8_t header, const uint8_t* body, size_t size, std::vector<uint8_t>& frame)
+	{
+		frame.insert(frame.end(), std::begin(kStartCode), std::end(kStartCode));
+		frame.push_back(header);
+		frame.insert(frame.end(), body, body + size);
+	}
+}
+
+bool ParseRtpHeader(const uint8_t* data, size_t size, RtpHeader& out)
+{
+	constexpr size_t kFixedSize = 12;
+	if (size < kFixedSize || (data[0] >> 6) != 2)
+		return false;
+
+	const size_t csrcCount = data[0] & 0x0F;
+	size_t offset = kFixedSize + csrcCount * 4;
+	out.extension = nullptr;
+	out.extensionSize = 0;
+	if (data[0] & 0x10) // Header extension: profile, length in words, words
+	{
+		if (size < offset + 4)
+			return false;
+		const size_t extensionSize = 4 + (static_cast<size_t>(data[offset + 2]) << 8 | data[offset + 3]) * 4;
+		if (extensionSize > size - offset)
+			return false;
+		out.extension = data + offset;
+		out.extensionSize = extensionSize;
+		offset += extensionSize;
+	}
+	if (offset > size)
+		return false;
+	size_t end = size;
+	if (data[0] & 0x20) // Padding: the last byte counts the padding bytes
+	{
+		const size_t padding = data[size - 1];
+		if (padding == 0 || padding > size - offset)
+			return false;
+		end -= padding;
+	}
+
+	out.payloadType = data[1] & 0x7F;
+	out.marker = (data[1] & 0x80) != 0;
+	out.sequenceNumber = static_cast<uint16_t>(data[2] << 8 | data[3]);
+	out.timestamp = static_cast<uint32_t>(data[4]) << 24 | static_cast<uint32_t>(data[5]) << 16 |
+					static_cast<uint32_t>(data[6]) << 8 | data[7];
+	out.ssrc = static_cast<uint32_t>(data[8]) << 24 | static_cast<uint32_t>(data[9]) << 16 |
+			   static_cast<uint32_t>(data[10]) << 8 | data[11];
+	out.payload = data + offset;
+	out.payloadSize = end - offset;
+	return true;
+}
+
+bool ReadTransportSequenceNumber(const RtpHeader& header, uint8_t extensionId, uint16_t& out)
+{
+	constexpr uint16_t kOneByteProfile = 0xBEDE;
+	if (!header.extension || header.extensionSize < 4 ||
+		static_cast<uint16_t>(header.extension[0] << 8 | header.extension[1]) != kOneByteProfile)
+		return false;
+
+	// Elements: ID and length - 1 in one byte, then the data; zero bytes pad
+	for (size_t offset = 4; offset < header.extensionSize;)
+	{
+		if (header.extension[offset] == 0)
+		{
+			++offset;
+			continue;
+		}
+		const uint8_t id = header.extension[offset] >> 4;
+		const size_t length = (header.extension[offset] & 0x0F) + 1u;
+		if (id == 15 || offset + 1 + length > header.extensionSize)
+			return false; // 15 ends the elements
+		if (id == extensionId && length == 2)
+		{
+			out = static_cast<uint16_t>(header.extension[offset + 1] << 8 | header.extension[offset + 2]);
+			return true;
+		}
+		offset += 1 + length;
+	}
+	return false;
+}
+
+size_t RestoreRtxPacket(const RtpHeader& rtx, uint8_t mediaPayloadType, uint32_t mediaSsrc, uint8_t* out,
+						size_t capacity)
+{
+	constexpr size_t kFixedSize = 12;
+	constexpr size_t kOsnSize = 2;
+	const size_t headerSize = kFixedSize + rtx.extensionSize;
+	if (rtx.payloadSize <= kOsnSize || capacity < headerSize + rtx.payloadSize - kOsnSize)
+		return 0;
+
+	const uint16_t sequenceNumber = static_cast<uint16_t>(rtx.payload[0] << 8 | rtx.payload[1]);
+	out[0] = static_cast<uint8_t>(2 << 6 | (rtx.extension ? 0x10 : 0)); // No padding or CSRCs: they belonged to the RTX packet
+	out[1] = static_cast<uint8_t>((rtx.marker ? 0x80 : 0) | (mediaPayloadType & 0x7F));
+	out[2] = static_cast<uint8_t>(sequenceNumber >> 8);
+	out[3] = static_cast<uint8_t>(sequenceNumber);
+	out[4] = static_cast<uint8_t>(rtx.timestamp >> 24);
+	out[5] = static_cast<uint8_t>(rtx.timestamp >> 16);
+	out[6] = static_cast<uint8_t>(rtx.timestamp >> 8);
+	out[7] = static_cast<uint8_t>(rtx.timestamp);
+	out[8] = static_cast<uint8_t>(mediaSsrc >> 24);
+	out[9] = static_cast<uint8_t>(mediaSsrc >> 16);
+	out[10] = static_cast<uint8_t>(mediaSsrc >> 8);
+	out[11] = static_cast<uint8_t>(mediaSsrc);
+	if (rtx.extension)
+		std::memcpy(out + kFixedSize, rtx.extension, rtx.extensionSize);
+	std::memcpy(out + headerSize, rtx.payload + kOsnSize, rtx.payloadSize - kOsnSize);
+	return headerSize + rtx.payloadSize - kOsnSize;
+}
+
+bool RtpDepacketizer::Inspect(const uint8_t* payload, size_t size, RtpPayloadInfo& out) const
+{
+	out = {};
+	if (size == 0)
+		return false;
+
+	if (m_codec == VideoCodec::VP8)
+	{
+		const size_t descriptor = Vp8DescriptorSize(payload, size);
+		if (!descriptor || descriptor >= size)
+			return false;
+		// S with partition index 0 starts a frame; its first byte is the
+		// frame tag, whose P bit is clear on keyframes
+		out.frameStart = (payload[0] & 0x10) && (payload[0] & 0x07) == 0;
+		out.keyframe = out.frameStart && (payload[descriptor] & 0x01) == 0;
+		return true;
+	}
+
+	auto inspectNal = [&out](uint8_t header, bool first) {
+		const uint8_t type = header & 0x1F;
+		if (type == kNalTypeSps || type == kNalTypeIdr)
+			out.keyframe = true;
+		// Parameter sets and access unit delimiters only ever lead an access unit
+		if (first && (type == kNalTypeSps || type == kNalTypeAud))
+			out.frameStart = true;
+	};
+
+	const uint8_t type = payload[0] & 0x1F;
+	if (type == kNalTypeStapA)
+	{
+		bool first = true;
+		for (size_t offset = 1; offset + 2 < size;)
+		{
+			const size_t length = static_cast<size_t>(payload[offset]) << 8 | payload[offset + 1];
+			offset += 2;
+			if (length == 0 || offset + length > size)
+				return false;
+			inspectNal(payload[offset], first);
+			first = false;
+			offset += length;
+		}
+		return true;
+	}
+	if (type == kNalTypeFuA)
+	{
+		if (size < 2)
+			return false;
+		inspectNal(payload[1], (payload[1] & 0x80) != 0);
+		return true;
+	}
+	if (type == 0 || type > kNalTypeStapA)
+		return false; // Interleaved-mode and reserved types are not produced by RtpPacketizer
+	inspectNal(payload[0], true);
+	return true;
+}
+
+bool RtpDepacketizer::Append(const uint8_t* payload, size_t size, std::vector<uint8_t>& frame) const
+{
+	if (size == 0)
+		return false;
+
+	if (m_codec == VideoCodec::VP8)
+	{
+		const size_t descriptor = Vp8DescriptorSize(payload, size);
+		if (!descriptor)
+			return false;
+		frame.insert(frame.end(), payload + descriptor, payload + size);
+		return true;
+	}
+
+	const uint8_t type = payload[0] & 0x1F;
+	if (type == kNalTypeStapA)
+	{
+		for (size_t offset = 1; offset + 2 < size;)
+		{
+			const size_t length = static_cast<size_t>(payload[offset]) << 8 | payload[offset + 1];
+			offset += 2;
+			if (length == 0 || offset + length > size)
+				return false;
+			AppendNal(payload[offset], payload + offset + 1, length - 1, frame);
+			offset += length;
+		}
+		return true;
+	}
+	if (type == kNalTypeFuA)
+	{
+		if (size < 2)
+			return false;
+		if (payload[1] & 0x80) // Start: rebuild the NAL header from the FU indicator and header
+			AppendNal(static_cast<uint8_t>((payload[0] & 0xE0) | (payload[1] & 0x1F)), payload + 2, size - 2, frame);
+		else
+			frame.insert(frame.end(), payload + 2, payload + size);
+		return true;
+	}
+	if (type == 0 || type > kNalTypeStapA)
+		return false;
+	AppendNal(payload[0], payload + 1, size - 1, frame);
+	return true;
+}
@@ -0,0 +1,66 @@
+#pragma once
+
+#include "../encoder/IVideoEncoder.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// Fixed RTP header fields and where the payload starts, after CSRCs,
+// header extensions and padding
+struct RtpHeader
+{
+	uint8_t payloadType = 0;
+	bool marker = false;
+	uint16_t sequenceNumber = 0;
+	uint32_t timestamp = 0;
+	uint32_t ssrc = 0;
+	const uint8_t* extension = nullptr; // Header extension block from its profile on, or null
+	size_t extensionSize = 0;
+	const uint8_t* payload = nullptr;
+	size_t payloadSize = 0;
+};
+
+// False for anything that is not a well-formed RTP version 2 packet
+bool ParseRtpHeader(const uint8_t* data, size_t size, RtpHeader& out);
+
+// The transport-wide sequence number in an RFC 8285 one-byte header
+// extension element with ID `extensionId`; false if there is none
+bool ReadTransportSequenceNumber(const RtpHeader& header, uint8_t extensionId, uint16_t& out);
+
+// Turns an RFC 4588 retransmission back into the packet it repeats: the
+// original sequence number comes out of the payload, the media payload type
+// and SSRC go back in. The header extension is kept, so the packet is laid
+// out like the original for FecDecoder; its transport-wide sequence number
+// is the retransmission's. Writes the packet to `out` and returns its size,
+// or 0 if `rtx` is too short or `capacity` too small.
+size_t RestoreRtxPacket(const RtpHeader& rtx, uint8_t mediaPayloadType, uint32_t mediaSsrc, uint8_t* out,
+						size_t capacity);
+
+// What one packet's payload says about the frame it belongs to
+struct RtpPayloadInfo
+{
+	bool frameStart = false; // Definitely the first packet of a frame; false when the codec cannot tell
+	bool keyframe = false;	 // Part of a keyframe (for H.264: carries SPS or IDR data)
+};
+
+// The receive-side inverse of RtpPacketizer: turns RTP payloads back into
+// the encoder's bitstream (Annex B for H.264, raw frames for VP8).
+// Stateless, so one instance can serve any number of streams.
+class RtpDepacketizer
+{
+public:
+	explicit RtpDepacketizer(VideoCodec codec) : m_codec(codec) {}
+
+	// False for a payload this depacketizer cannot parse
+	bool Inspect(const uint8_t* payload, size_t size, RtpPayloadInfo& out) const;
+
+	// Appends the bitstream bytes of one payload to `frame`. Payloads of a
+	// frame must be appended in sequence order. False for a malformed payload.
+	bool Append(const uint8_t* payload, size_t size, std::vector<uint8_t>& frame) const;
+
+	VideoCodec GetCodec() const { return m_codec; }
+
+private:
+	VideoCodec m_codec;
+};
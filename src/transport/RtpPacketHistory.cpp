@@ -0,0 +1,35 @@
+#include "RtpPacketHistory.h"
+
+#include <algorithm>
+#include <bit>
+
+RtpPacketHistory::RtpPacketHistory(size_t capacity)
+{
+	m_entries.resize(std::bit_ceil(std::clamp<size_t>(capacity, 16, 32768)));
+	m_mask = m_entries.size() - 1;
+}
+
+void RtpPacketHistory::Put(const std::shared_ptr<const EncodedFrame>& frame, const RtpPacket& packet,
+						   Clock::time_point sendTime)
+{
+	Entry& entry = m_entries[packet.GetSequenceNumber() & m_mask];
+	entry.packet = packet;
+	entry.frame = frame;
+	entry.sendTime = sendTime;
+	entry.lastResendTime = {};
+	entry.resendCount = 0;
+}
+
+RtpPacketHistory::Entry* RtpPacketHistory::Get(uint16_t sequenceNumber)
+{
+	Entry& entry = m_entries[sequenceNumber & m_mask];
+	if (!entry.frame || entry.packet.GetSequenceNumber() != sequenceNumber)
+		return nullptr;
+	return &entry;
+}
+
+void RtpPacketHistory::Clear()
+{
+	for (Entry& entry : m_entries)
+		entry.frame.reset();
+}
@@ -0,0 +1,48 @@
+#pragma once
+
+#include "RtpPacketizer.h"
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+// Recently sent RTP packets, kept for retransmission. A fixed ring of
+// entries indexed by sequence number, so storing and finding a packet is
+// one array access and nothing is allocated after construction; a packet
+// stays until the sequence number `capacity` later overwrites it.
+//
+// Entries keep the packet as the packetizer made it, still pointing into
+// the encoded frame, and share ownership of that frame: the payload is
+// never copied, and a frame is freed once the last of its packets has left
+// the ring.
+class RtpPacketHistory
+{
+public:
+	using Clock = std::chrono::steady_clock;
+
+	struct Entry
+	{
+		RtpPacket packet;
+		std::shared_ptr<const EncodedFrame> frame; // Owns what packet.chunks point to
+		Clock::time_point sendTime;
+		Clock::time_point lastResendTime;
+		int resendCount = 0;
+	};
+
+	// `capacity` is rounded up to a power of two
+	explicit RtpPacketHistory(size_t capacity = 2048);
+
+	// `packet` must have been made from `frame`
+	void Put(const std::shared_ptr<const EncodedFrame>& frame, const RtpPacket& packet, Clock::time_point sendTime);
+	// nullptr if the packet was never stored or has been overwritten
+	Entry* Get(uint16_t sequenceNumber);
+	void Clear();
+
+	size_t GetCapacity() const { return m_entries.size(); }
+
+private:
+	std::vector<Entry> m_entries;
+	size_t m_mask = 0;
+};
@@ -0,0 +1,270 @@
+#include "RtpPacketizer.h"
+
+#include <algorithm>
+#include <cstring>
+#include <random>
+
+namespace
+{
+	constexpr uint8_t kRtpVersion = 2;
+	constexpr uint8_t kNalTypeStapA = 24;
+	constexpr uint8_t kNalTypeFuA = 28;
+	constexpr size_t kStapAHeaderSize = 1;
+	constexpr size_t kFuAHeaderSize = 2;
+	constexpr size_t kVp8DescriptorSize = 4; // X, I, then a 15-bit PictureID
+	constexpr uint16_t kOneByteExtensionProfile = 0xBEDE;
+
+	// Splits an Annex B stream into NAL units (without start codes). memchr
+	// finds the 0x01 of each start code far faster than a byte loop.
+	void FindNalUnits(const uint8_t* data, size_t size, std::vector<RtpSlice>& out)
+	{
+		out.clear();
+		const uint8_t* const end = data + size;
+		const uint8_t* start = nullptr;
+		const uint8_t* position = data + std::min<size_t>(size, 2);
+		while (position < end)
+		{
+			const auto* one = static_cast<const uint8_t*>(std::memchr(position, 1, static_cast<size_t>(end - position)));
+			if (!one)
+				break;
+			position = one + 1;
+			if (one[-1] != 0 || one[-2] != 0)
+				continue;
+
+			if (start)
+			{
+				// The zero of a 4-byte start code belongs to the start code
+				const uint8_t* nalEnd = one - 2;
+				while (nalEnd > start && nalEnd[-1] == 0)
+					--nalEnd;
+				if (nalEnd > start)
+					out.push_back({ start, static_cast<size_t>(nalEnd - start) });
+			}
+			start = position;
+		}
+		if (start && start < end)
+			out.push_back({ start, static_cast<size_t>(end - start) });
+	}
+}
+
+int RtpPacket::GetSlices(RtpSlice* out) const
+{
+	int count = 0;
+	out[count++] = { header.data(), headerSize };
+	for (int i = 0; i < chunkCount; ++i)
+	{
+		const Chunk& chunk = chunks[i];
+		if (chunk.prefixSize)
+			out[count++] = { header.data() + chunk.prefixOffset, chunk.prefixSize };
+		out[count++] = { chunk.data, chunk.size };
+	}
+	return count;
+}
+
+void RtpPacket::CopyTo(uint8_t* out) const
+{
+	RtpSlice slices[kMaxSlices];
+	const int count = GetSlices(slices);
+	for (int i = 0; i < count; ++i)
+	{
+		std::memcpy(out, slices[i].data, slices[i].size);
+		out += slices[i].size;
+	}
+}
+
+uint32_t RtpPacket::GetTimestamp() const
+{
+	return static_cast<uint32_t>(header[4]) << 24 | static_cast<uint32_t>(header[5]) << 16 |
+		   static_cast<uint32_t>(header[6]) << 8 | header[7];
+}
+
+size_t RtpPacket::GetRtpHeaderSize() const
+{
+	if (!(header[0] & 0x10))
+		return kRtpHeaderSize;
+	return kRtpHeaderSize + 4 + (static_cast<size_t>(header[kRtpHeaderSize + 2]) << 8 | header[kRtpHeaderSize + 3]) * 4;
+}
+
+bool RtpPacket::SetTransportSequenceNumber(uint16_t sequenceNumber)
+{
+	// Packets from RtpPacketizer, RtpRetransmitter and FecEncoder carry the
+	// element first in their extension block
+	if (!(header[0] & 0x10) || GetRtpHeaderSize() != kRtpHeaderSize + kTransportSequenceExtensionSize)
+		return false;
+	header[kRtpHeaderSize + 5] = static_cast<uint8_t>(sequenceNumber >> 8);
+	header[kRtpHeaderSize + 6] = static_cast<uint8_t>(sequenceNumber);
+	return true;
+}
+
+void WriteTransportSequenceExtension(uint8_t id, uint8_t* out)
+{
+	out[0] = static_cast<uint8_t>(kOneByteExtensionProfile >> 8);
+	out[1] = static_cast<uint8_t>(kOneByteExtensionProfile);
+	out[2] = 0;
+	out[3] = 1; // Length in 32-bit words
+	out[4] = static_cast<uint8_t>(id << 4 | 1); // ID, then the element's length - 1
+	out[5] = out[6] = 0; // The sequence number, filled in at send time
+	out[7] = 0; // Padding
+}
+
+RtpPacketizer::RtpPacketizer(VideoCodec codec, const RtpPacketizerConfig& config)
+	: m_codec(codec)
+	, m_config(config)
+{
+	std::random_device random;
+	if (!m_config.ssrc)
+		m_config.ssrc = random() | 1;
+	m_sequenceNumber = static_cast<uint16_t>(random());
+	m_timestampOffset = random();
+	m_pictureId = static_cast<uint16_t>(random() & 0x7FFF);
+	if (m_config.transportSequenceId > 14)
+		m_config.transportSequenceId = 0; // 15 is reserved, and the one-byte form ends at 14
+	if (m_config.transportSequenceId)
+		m_headerSize += kTransportSequenceExtensionSize;
+	m_config.maxPacketSize = std::max<size_t>(m_config.maxPacketSize, m_headerSize + 64);
+}
+
+uint32_t RtpPacketizer::ToRtpTimestamp(uint64_t timestampNs) const
+{
+	// Microseconds times 9/100: with the ratio reduced the product only
+	// overflows after tens of thousands of years of uptime, where
+	// microseconds times 90000 would after six and a half
+	static_assert(kRtpVideoClockRate % 10'000 == 0);
+	return m_timestampOffset +
+		   static_cast<uint32_t>(timestampNs / 1000 * (kRtpVideoClockRate / 10'000) / 100);
+}
+
+bool RtpPacketizer::Packetize(const EncodedFrame& frame, std::vector<RtpPacket>& out)
+{
+	out.clear();
+	if (frame.data.empty())
+		return false;
+
+	const uint32_t timestamp = ToRtpTimestamp(frame.timestampNs);
+	if (m_codec == VideoCodec::H264)
+		PacketizeH264(frame, timestamp, out);
+	else
+		PacketizeVp8(frame, timestamp, out);
+	if (out.empty())
+		return false;
+
+	out.back().header[1] |= 0x80; // Marker: last packet of the access unit
+	return true;
+}
+
+RtpPacket& RtpPacketizer::AddPacket(std::vector<RtpPacket>& out, uint32_t timestamp)
+{
+	RtpPacket& packet = out.emplace_back();
+	uint8_t* header = packet.header.data();
+	header[0] = static_cast<uint8_t>(kRtpVersion << 6 | (m_config.transportSequenceId ? 0x10 : 0));
+	header[1] = m_config.payloadType & 0x7F;
+	header[2] = static_cast<uint8_t>(m_sequenceNumber >> 8);
+	header[3] = static_cast<uint8_t>(m_sequenceNumber);
+	header[4] = static_cast<uint8_t>(timestamp >> 24);
+	header[5] = static_cast<uint8_t>(timestamp >> 16);
+	header[6] = static_cast<uint8_t>(timestamp >> 8);
+	header[7] = static_cast<uint8_t>(timestamp);
+	header[8] = static_cast<uint8_t>(m_config.ssrc >> 24);
+	header[9] = static_cast<uint8_t>(m_config.ssrc >> 16);
+	header[10] = static_cast<uint8_t>(m_config.ssrc >> 8);
+	header[11] = static_cast<uint8_t>(m_config.ssrc);
+	if (m_config.transportSequenceId)
+		WriteTransportSequenceExtension(m_config.transportSequenceId, header + kRtpHeaderSize);
+	packet.headerSize = static_cast<uint8_t>(m_headerSize);
+	packet.size = static_cast<uint32_t>(m_headerSize);
+	++m_sequenceNumber;
+	return packet;
+}
+
+void RtpPacketizer::PacketizeH264(const EncodedFrame& frame, uint32_t timestamp, std::vector<RtpPacket>& out)
+{
+	FindNalUnits(frame.data.data(), frame.data.size(), m_nalUnits);
+	const size_t maxPayload = m_config.maxPacketSize - m_headerSize;
+
+	size_t i = 0;
+	while (i < m_nalUnits.size())
+	{
+		const RtpSlice nal = m_nalUnits[i];
+
+		// STAP-A for a run of small NAL units that fit in one packet together
+		size_t aggregated = 0;
+		size_t aggregateSize = kStapAHeaderSize;
+		while (i + aggregated < m_nalUnits.size() && aggregated < RtpPacket::kMaxChunks &&
+			   aggregateSize + 2 + m_nalUnits[i + aggregated].size <= maxPayload)
+		{
+			aggregateSize += 2 + m_nalUnits[i + aggregated].size;
+			++aggregated;
+		}
+		if (aggregated >= 2)
+		{
+			RtpPacket& packet = AddPacket(out, timestamp);
+			uint8_t forbidden = 0;
+			uint8_t priority = 0;
+			auto prefixOffset = static_cast<uint8_t>(m_headerSize + kStapAHeaderSize);
+			for (size_t n = 0; n < aggregated; ++n)
+			{
+				const RtpSlice& unit = m_nalUnits[i + n];
+				forbidden |= unit.data[0] & 0x80;
+				priority = std::max<uint8_t>(priority, unit.data[0] & 0x60);
+				packet.header[prefixOffset] = static_cast<uint8_t>(unit.size >> 8);
+				packet.header[prefixOffset + 1] = static_cast<uint8_t>(unit.size);
+				packet.chunks[packet.chunkCount++] = { unit.data, static_cast<uint32_t>(unit.size), prefixOffset, 2 };
+				prefixOffset += 2;
+			}
+			packet.header[m_headerSize] = forbidden | priority | kNalTypeStapA;
+			packet.headerSize = static_cast<uint8_t>(m_headerSize + kStapAHeaderSize);
+			packet.size = static_cast<uint32_t>(m_headerSize + aggregateSize);
+			i += aggregated;
+			continue;
+		}
+
+		if (nal.size <= maxPayload)
+		{
+			RtpPacket& packet = AddPacket(out, timestamp);
+			packet.chunks[packet.chunkCount++] = { nal.data, static_cast<uint32_t>(nal.size) };
+			packet.size += static_cast<uint32_t>(nal.size);
+			++i;
+			continue;
+		}
+
+		// FU-A: the NAL header travels in the FU indicator and header, the
+		// rest is cut into fragments that fill the packets
+		const uint8_t nalHeader = nal.data[0];
+		const size_t fragmentSize = maxPayload - kFuAHeaderSize;
+		for (size_t offset = 1; offset < nal.size; offset += fragmentSize)
+		{
+			const size_t size = std::min(fragmentSize, nal.size - offset);
+			RtpPacket& packet = AddPacket(out, timestamp);
+			const bool first = offset == 1;
+			const bool last = offset + size == nal.size;
+			packet.header[m_headerSize] = (nalHeader & 0xE0) | kNalTypeFuA;
+			packet.header[m_headerSize + 1] =
+				static_cast<uint8_t>((first ? 0x80 : 0) | (last ? 0x40 : 0) | (nalHeader & 0x1F));
+			packet.headerSize = static_cast<uint8_t>(m_headerSize + kFuAHeaderSize);
+			packet.chunks[packet.chunkCount++] = { nal.data + offset, static_cast<uint32_t>(size) };
+			packet.size = static_cast<uint32_t>(m_headerSize + kFuAHeaderSize + size);
+		}
+		++i;
+	}
+}
+
+void RtpPacketizer::PacketizeVp8(const EncodedFrame& frame, uint32_t timestamp, std::vector<RtpPacket>& out)
+{
+	const size_t fragmentSize = m_config.maxPacketSize - m_headerSize - kVp8DescriptorSize;
+	const uint8_t* data = frame.data.data();
+	const size_t size = frame.data.size();
+	for (size_t offset = 0; offset < size; offset += fragmentSize)
+	{
+		const size_t length = std::min(fragmentSize, size - offset);
+		RtpPacket& packet = AddPacket(out, timestamp);
+		uint8_t* descriptor = packet.header.data() + m_headerSize;
+		descriptor[0] = 0x80 | (offset == 0 ? 0x10 : 0); // X, and S on the first packet (partition 0)
+		descriptor[1] = 0x80;							 // I: PictureID present
+		descriptor[2] = static_cast<uint8_t>(0x80 | m_pictureId >> 8); // M: 15-bit PictureID
+		descriptor[3] = static_cast<uint8_t>(m_pictureId);
+		packet.headerSize = static_cast<uint8_t>(m_headerSize + kVp8DescriptorSize);
+		packet.chunks[packet.chunkCount++] = { data + offset, static_cast<uint32_t>(length) };
+		packet.size = static_cast<uint32_t>(m_headerSize + kVp8DescriptorSize + length);
+	}
+	m_pictureId = (m_pictureId + 1) & 0x7FFF;
+}
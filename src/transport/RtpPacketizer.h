@@ -0,0 +1,125 @@
+#pragma once
+
+#include "../encoder/IVideoEncoder.h"
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+constexpr size_t kRtpHeaderSize = 12; // Fixed header, no CSRCs or extensions
+constexpr uint32_t kRtpVideoClockRate = 90000;
+// The RFC 8285 header extension block carrying a transport-wide sequence
+// number: the 0xBEDE profile and length, then one element of two bytes and
+// a byte of padding
+constexpr size_t kTransportSequenceExtensionSize = 8;
+
+// Writes that block, with the sequence number zero, to `out` (right after
+// the fixed header; the X bit is the caller's)
+void WriteTransportSequenceExtension(uint8_t id, uint8_t* out);
+
+// One contiguous piece of a datagram
+struct RtpSlice
+{
+	const uint8_t* data = nullptr;
+	size_t size = 0;
+};
+
+// One RTP packet as a list of slices: the headers, which the packet holds
+// itself, and the payload, which stays in the encoder's output buffer. The
+// slices are gathered by the socket when the datagram is sent, so payload
+// bytes are never copied on the way out. A packet is only valid while the
+// EncodedFrame it was made from is unchanged.
+struct RtpPacket
+{
+	static constexpr size_t kMaxHeaderSize = 40;
+	static constexpr int kMaxChunks = 4;
+	static constexpr int kMaxSlices = 1 + kMaxChunks * 2;
+
+	// Payload bytes, each optionally preceded by a few bytes of `header`
+	// (the NAL unit sizes of an H.264 aggregation packet)
+	struct Chunk
+	{
+		const uint8_t* data = nullptr;
+		uint32_t size = 0;
+		uint8_t prefixOffset = 0;
+		uint8_t prefixSize = 0;
+	};
+
+	std::array<uint8_t, kMaxHeaderSize> header; // RTP header, then the payload header
+	uint8_t headerSize = 0;						 // Bytes of `header` that lead the packet
+	std::array<Chunk, kMaxChunks> chunks;
+	uint8_t chunkCount = 0;
+	uint32_t size = 0; // Of the whole datagram
+
+	// Fills `out` (kMaxSlices entries) with the datagram's pieces in order
+	int GetSlices(RtpSlice* out) const;
+	// Copies the datagram into `out`, which must hold `size` bytes
+	void CopyTo(uint8_t* out) const;
+
+	uint16_t GetSequenceNumber() const { return static_cast<uint16_t>(header[2] << 8 | header[3]); }
+	uint32_t GetTimestamp() const;
+	bool GetMarker() const { return (header[1] & 0x80) != 0; }
+	// The fixed header plus the header extension, where the payload (or the
+	// RTX original sequence number) begins
+	size_t GetRtpHeaderSize() const;
+	// Fills in the transport-wide sequence number of a packet made with a
+	// transportSequenceId; false for a packet without the extension
+	bool SetTransportSequenceNumber(uint16_t sequenceNumber);
+};
+
+struct RtpPacketizerConfig
+{
+	uint8_t payloadType = 96;
+	uint32_t ssrc = 0;			 // 0 picks a random one
+	size_t maxPacketSize = 1200; // Whole RTP packet; leaves room for IP/UDP and tunnels under a 1500 MTU
+	// RFC 8285 one-byte extension ID (1-14) for the transport-wide sequence
+	// number congestion control needs; 0 leaves the extension out. Each
+	// packet then reserves the extension, and the sender numbers it with
+	// SetTransportSequenceNumber() just before it goes out.
+	uint8_t transportSequenceId = 0;
+};
+
+// Splits encoded access units into RTP packets:
+//
+//   H.264  RFC 6184 non-interleaved mode. NAL units that fit go out as
+//          single NAL unit packets, consecutive small ones (SPS, PPS, SEI)
+//          aggregated into STAP-A; larger ones are split into FU-A fragments.
+//   VP8    RFC 7741 with a 15-bit PictureID, split into as many packets as
+//          the frame needs.
+//
+// Fragments fill packets to maxPacketSize, so all packets of one NAL unit or
+// VP8 frame have the same size except the last; the socket can then hand
+// them to the kernel as one segmented (GSO) send. The last packet of an
+// access unit carries the marker bit. Sequence numbers and timestamps start
+// at random values, as RFC 3550 asks. The transport-wide sequence number
+// extension, when configured, counts towards maxPacketSize.
+class RtpPacketizer
+{
+public:
+	RtpPacketizer(VideoCodec codec, const RtpPacketizerConfig& config);
+
+	// Replaces `out` with the packets of `frame`; they reference
+	// `frame.data`. Returns false for an empty frame or one with no NAL units.
+	bool Packetize(const EncodedFrame& frame, std::vector<RtpPacket>& out);
+
+	VideoCodec GetCodec() const { return m_codec; }
+	uint32_t GetSsrc() const { return m_config.ssrc; }
+	uint8_t GetPayloadType() const { return m_config.payloadType; }
+	// Sequence number the next packet will get
+	uint16_t GetSequenceNumber() const { return m_sequenceNumber; }
+	uint32_t ToRtpTimestamp(uint64_t timestampNs) const;
+
+private:
+	RtpPacket& AddPacket(std::vector<RtpPacket>& out, uint32_t timestamp);
+	void PacketizeH264(const EncodedFrame& frame, uint32_t timestamp, std::vector<RtpPacket>& out);
+	void PacketizeVp8(const EncodedFrame& frame, uint32_t timestamp, std::vector<RtpPacket>& out);
+
+	VideoCodec m_codec;
+	RtpPacketizerConfig m_config;
+	size_t m_headerSize = kRtpHeaderSize; // With the header extension
+	uint16_t m_sequenceNumber = 0;
+	uint32_t m_timestampOffset = 0;
+	uint16_t m_pictureId = 0; // VP8, 15 bits
+	std::vector<RtpSlice> m_nalUnits;
+};
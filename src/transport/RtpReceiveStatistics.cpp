@@ -0,0 +1,56 @@
+#include "RtpReceiveStatistics.h"
+
+#include <algorithm>
+
+void RtpReceiveStatistics::Reset()
+{
+	*this = {};
+}
+
+void RtpReceiveStatistics::OnPacket(uint16_t sequenceNumber)
+{
+	if (!m_started)
+	{
+		m_started = true;
+		m_baseSequence = m_maxSequence = sequenceNumber;
+		m_received = 1;
+		return;
+	}
+
+	const uint16_t delta = static_cast<uint16_t>(sequenceNumber - m_maxSequence);
+	if (delta > 0 && delta < 0x8000)
+	{
+		if (sequenceNumber < m_maxSequence)
+			m_cycles += 0x10000;
+		m_maxSequence = sequenceNumber;
+	}
+	++m_received; // Duplicates count, as in RFC 3550; they are rare without retransmission
+}
+
+void RtpReceiveStatistics::MakeReport(uint32_t jitter, RtcpReportBlock& out)
+{
+	const uint32_t extendedMax = m_cycles + m_maxSequence;
+	const uint64_t expected = m_started ? static_cast<uint64_t>(extendedMax - m_baseSequence) + 1 : 0;
+	const int64_t lost = static_cast<int64_t>(expected) - static_cast<int64_t>(m_received);
+
+	const uint64_t expectedInterval = expected - m_expectedPrior;
+	const int64_t lostInterval =
+		static_cast<int64_t>(expectedInterval) - static_cast<int64_t>(m_received - m_receivedPrior);
+	m_expectedPrior = expected;
+	m_receivedPrior = m_received;
+
+	out.fractionLost = expectedInterval && lostInterval > 0
+						   ? static_cast<uint8_t>(std::min<int64_t>((lostInterval << 8) / expectedInterval, 255))
+						   : 0;
+	out.cumulativeLost = static_cast<uint32_t>(std::clamp<int64_t>(lost, 0, 0x7FFFFF));
+	out.highestSequenceNumber = extendedMax;
+	out.jitter = jitter;
+}
+
+double RtpReceiveStatistics::GetLossRate() const
+{
+	if (!m_started)
+		return 0.0;
+	const uint64_t expected = static_cast<uint64_t>(m_cycles + m_maxSequence - m_baseSequence) + 1;
+	return expected > m_received ? static_cast<double>(expected - m_received) / static_cast<double>(expected) : 0.0;
+}
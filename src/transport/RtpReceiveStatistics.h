@@ -0,0 +1,33 @@
+#pragma once
+
+#include "RtcpPacket.h"
+
+#include <cstdint>
+
+// Loss accounting for one received RTP stream, as RFC 3550 appendix A.3
+// counts it, for the report blocks of RTCP receiver reports. Only packets
+// as they first arrive count: retransmitted and FEC-recovered packets are
+// repairs, and counting them would hide the loss the sender needs to know
+// about to choose its protection.
+class RtpReceiveStatistics
+{
+public:
+	void OnPacket(uint16_t sequenceNumber);
+
+	// Fills a report block; the fraction lost covers the time since the
+	// previous call. `jitter` is in RTP clock units.
+	void MakeReport(uint32_t jitter, RtcpReportBlock& out);
+
+	// Lost over everything received so far, 0 to 1
+	double GetLossRate() const;
+	void Reset();
+
+private:
+	bool m_started = false;
+	uint16_t m_baseSequence = 0;
+	uint16_t m_maxSequence = 0;
+	uint32_t m_cycles = 0; // Wraps of the sequence number, shifted left 16
+	uint64_t m_received = 0;
+	uint64_t m_expectedPrior = 0;
+	uint64_t m_receivedPrior = 0;
+};
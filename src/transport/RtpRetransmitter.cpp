@@ -0,0 +1,124 @@
+#include "RtpRetransmitter.h"
+
+#include <algorithm>
+#include <cstring>
+#include <random>
+
+namespace
+{
+	constexpr size_t kOsnSize = 2; // Original sequence number, ahead of the payload
+	constexpr double kBurstSeconds = 0.1;
+}
+
+RtpRetransmitter::RtpRetransmitter(const RtxConfig& config)
+	: m_config(config)
+	, m_history(config.historySize)
+{
+	std::random_device random;
+	if (!m_config.ssrc)
+		m_config.ssrc = random() | 1;
+	m_sequenceNumber = static_cast<uint16_t>(random());
+	m_config.maxBitrateKbps = std::max(m_config.maxBitrateKbps, 1);
+	m_budget = m_config.maxBitrateKbps * 125.0 * kBurstSeconds;
+}
+
+void RtpRetransmitter::SetMaxBitrate(int kbps)
+{
+	m_config.maxBitrateKbps = std::max(kbps, 1);
+}
+
+void RtpRetransmitter::Reset()
+{
+	m_history.Clear();
+	m_statistics = {};
+}
+
+void RtpRetransmitter::OnPacketsSent(const std::shared_ptr<const EncodedFrame>& frame, const RtpPacket* packets,
+									 size_t count, Clock::time_point now)
+{
+	for (size_t i = 0; i < count; ++i)
+		m_history.Put(frame, packets[i], now);
+}
+
+bool RtpRetransmitter::MakeRtxPacket(const RtpPacket& original, RtpPacket& out)
+{
+	// Everything in `header` past the RTP header and its extension (payload
+	// header, STAP-A sizes) moves up to make room for the original sequence
+	// number. The extension stays, so the transport-wide sequence number can
+	// be set anew.
+	const size_t rtpHeaderSize = original.GetRtpHeaderSize();
+	size_t used = original.headerSize;
+	for (int i = 0; i < original.chunkCount; ++i)
+		used = std::max<size_t>(used, original.chunks[i].prefixOffset + original.chunks[i].prefixSize);
+	if (used + kOsnSize > RtpPacket::kMaxHeaderSize)
+		return false;
+
+	out = original;
+	std::memmove(out.header.data() + rtpHeaderSize + kOsnSize, original.header.data() + rtpHeaderSize,
+				 used - rtpHeaderSize);
+	for (int i = 0; i < out.chunkCount; ++i)
+	{
+		if (out.chunks[i].prefixSize)
+			out.chunks[i].prefixOffset += kOsnSize;
+	}
+
+	uint8_t* header = out.header.data();
+	header[1] = static_cast<uint8_t>((original.header[1] & 0x80) | (m_config.payloadType & 0x7F));
+	header[2] = static_cast<uint8_t>(m_sequenceNumber >> 8);
+	header[3] = static_cast<uint8_t>(m_sequenceNumber);
+	header[8] = static_cast<uint8_t>(m_config.ssrc >> 24);
+	header[9] = static_cast<uint8_t>(m_config.ssrc >> 16);
+	header[10] = static_cast<uint8_t>(m_config.ssrc >> 8);
+	header[11] = static_cast<uint8_t>(m_config.ssrc);
+	header[rtpHeaderSize] = original.header[2];
+	header[rtpHeaderSize + 1] = original.header[3];
+	out.headerSize = static_cast<uint8_t>(original.headerSize + kOsnSize);
+	out.size = original.size + static_cast<uint32_t>(kOsnSize);
+	++m_sequenceNumber;
+	return true;
+}
+
+size_t RtpRetransmitter::OnNack(const uint16_t* sequenceNumbers, size_t count, Clock::time_point now,
+								std::vector<RtpPacket>& out)
+{
+	const double elapsed = std::chrono::duration<double>(now - m_lastRefill).count();
+	const double bytesPerSecond = m_config.maxBitrateKbps * 125.0;
+	m_budget = std::min(m_budget + bytesPerSecond * std::max(elapsed, 0.0), bytesPerSecond * kBurstSeconds);
+	m_lastRefill = now;
+
+	const auto maxAge = std::chrono::milliseconds(m_config.maxAgeMs);
+	const auto resendInterval = std::chrono::duration_cast<Clock::duration>(
+		std::chrono::duration<double, std::milli>(std::max<double>(m_config.minResendIntervalMs, m_rttMs)));
+
+	size_t added = 0;
+	for (size_t i = 0; i < count; ++i)
+	{
+		++m_statistics.packetsRequested;
+		RtpPacketHistory::Entry* entry = m_history.Get(sequenceNumbers[i]);
+		if (!entry || now - entry->sendTime > maxAge)
+		{
+			++m_statistics.notInHistory;
+			continue;
+		}
+		if ((entry->resendCount > 0 && now - entry->lastResendTime < resendInterval) ||
+			m_budget < entry->packet.size)
+		{
+			++m_statistics.suppressed;
+			continue;
+		}
+
+		RtpPacket& packet = out.emplace_back();
+		if (!MakeRtxPacket(entry->packet, packet))
+		{
+			out.pop_back();
+			continue;
+		}
+		m_budget -= packet.size;
+		entry->lastResendTime = now;
+		++entry->resendCount;
+		++m_statistics.packetsRetransmitted;
+		m_statistics.bytesRetransmitted += packet.size;
+		++added;
+	}
+	return added;
+}
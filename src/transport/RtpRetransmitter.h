@@ -0,0 +1,79 @@
+#pragma once
+
+#include "RtpPacketHistory.h"
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+struct RtxConfig
+{
+	uint8_t payloadType = 97;		 // Associated with the media payload type in signaling (apt=96)
+	uint32_t ssrc = 0;				 // 0 picks a random one
+	size_t historySize = 2048;		 // Packets; about a second of a 4K stream at 20 Mbit/s
+	int maxAgeMs = 1000;			 // Older packets are too late to help and are not resent
+	int maxBitrateKbps = 5000;		 // Retransmission budget, on top of the media
+	int minResendIntervalMs = 0;	 // Floor under the per-packet resend interval, which is the RTT from SetRtt()
+};
+
+struct RtxStatistics
+{
+	uint64_t packetsRequested = 0;
+	uint64_t packetsRetransmitted = 0;
+	uint64_t bytesRetransmitted = 0;
+	uint64_t notInHistory = 0; // Too old, or never sent
+	uint64_t suppressed = 0;	 // Resent too recently, or over the budget
+};
+
+// Sender side of NACK-based loss recovery. Keeps every sent packet in an
+// RtpPacketHistory and answers NACKs with RFC 4588 retransmissions: a
+// packet on its own SSRC and sequence numbers whose payload is the original
+// sequence number followed by the original payload, so the receiver's loss
+// statistics for the media stream stay truthful.
+//
+// Retransmissions reference the payload in the history like the originals
+// do, and are sent with UdpSocket::Send() the same way. A token bucket caps
+// them at maxBitrateKbps so a burst of NACKs cannot crowd out the media,
+// and a packet is not resent twice within one round trip (the first copy
+// may still be in flight).
+//
+// Not thread-safe: call from the thread that sends the media.
+class RtpRetransmitter
+{
+public:
+	using Clock = std::chrono::steady_clock;
+
+	explicit RtpRetransmitter(const RtxConfig& config = {});
+
+	// Remembers packets just sent; `frame` is what they were made from
+	void OnPacketsSent(const std::shared_ptr<const EncodedFrame>& frame, const RtpPacket* packets, size_t count,
+					   Clock::time_point now);
+
+	// Appends to `out` the RTX packets answering a NACK and returns how many.
+	// They reference the history: send them before the next OnPacketsSent().
+	size_t OnNack(const uint16_t* sequenceNumbers, size_t count, Clock::time_point now, std::vector<RtpPacket>& out);
+
+	void SetRtt(double rttMs) { m_rttMs = rttMs; }
+	void SetMaxBitrate(int kbps);
+	void Reset();
+
+	uint32_t GetSsrc() const { return m_config.ssrc; }
+	uint8_t GetPayloadType() const { return m_config.payloadType; }
+	const RtxStatistics& GetStatistics() const { return m_statistics; }
+
+private:
+	bool MakeRtxPacket(const RtpPacket& original, RtpPacket& out);
+
+	RtxConfig m_config;
+	RtpPacketHistory m_history;
+	uint16_t m_sequenceNumber = 0;
+	double m_rttMs = 0.0;
+
+	// Token bucket in bytes, refilled at maxBitrateKbps up to 100 ms worth
+	double m_budget = 0.0;
+	Clock::time_point m_lastRefill;
+
+	RtxStatistics m_statistics;
+};
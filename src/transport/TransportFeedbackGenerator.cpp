@@ -0,0 +1,115 @@
+#include "TransportFeedbackGenerator.h"
+
+#include <algorithm>
+#include <bit>
+
+namespace
+{
+	constexpr int64_t kReferenceTimeUs = 64000;
+
+	int SequenceDiff(uint16_t a, uint16_t b)
+	{
+		return static_cast<int16_t>(static_cast<uint16_t>(a - b));
+	}
+}
+
+TransportFeedbackGenerator::TransportFeedbackGenerator(size_t capacity)
+{
+	capacity = std::bit_ceil(std::clamp<size_t>(capacity, 64, 32768));
+	m_mask = static_cast<uint16_t>(capacity - 1);
+	m_slots.resize(capacity);
+	m_feedback.arrivalOffsetsUs.reserve(kMaxPacketsPerFeedback);
+}
+
+void TransportFeedbackGenerator::Reset()
+{
+	for (Slot& slot : m_slots)
+		slot.used = false;
+	m_started = false;
+	m_hasNew = false;
+}
+
+bool TransportFeedbackGenerator::IsPresent(uint16_t sequenceNumber) const
+{
+	const Slot& slot = m_slots[sequenceNumber & m_mask];
+	return slot.used && slot.sequenceNumber == sequenceNumber;
+}
+
+void TransportFeedbackGenerator::OnPacket(uint16_t transportSequenceNumber, Clock::time_point arrival)
+{
+	if (!m_started)
+	{
+		m_started = true;
+		m_epoch = arrival;
+		m_nextToReport = m_highest = transportSequenceNumber;
+	}
+	else if (SequenceDiff(transportSequenceNumber, m_nextToReport) < 0)
+	{
+		return; // Already reported as lost
+	}
+	else if (SequenceDiff(transportSequenceNumber, m_highest) > 0)
+	{
+		m_highest = transportSequenceNumber;
+	}
+
+	Slot& slot = m_slots[transportSequenceNumber & m_mask];
+	slot.used = true;
+	slot.sequenceNumber = transportSequenceNumber;
+	slot.arrivalUs = std::chrono::duration_cast<std::chrono::microseconds>(arrival - m_epoch).count();
+	m_hasNew = true;
+}
+
+bool TransportFeedbackGenerator::BuildFeedback(uint32_t senderSsrc, uint32_t mediaSsrc, std::vector<uint8_t>& out)
+{
+	if (!m_hasNew)
+		return false;
+	m_hasNew = false;
+
+	// Older than the ring: those slots have been reused
+	const int capacity = m_mask + 1;
+	if (SequenceDiff(m_highest, m_nextToReport) >= capacity)
+		m_nextToReport = static_cast<uint16_t>(m_highest - capacity + 1);
+
+	bool built = false;
+	while (SequenceDiff(m_nextToReport, m_highest) <= 0)
+	{
+		const size_t count = std::min<size_t>(static_cast<size_t>(SequenceDiff(m_highest, m_nextToReport)) + 1,
+											  kMaxPacketsPerFeedback);
+		// The reference time is the first arrival's, rounded down to its
+		// 64 ms step, so the first delta is small and positive
+		int64_t referenceUs = -1;
+		for (size_t i = 0; i < count && referenceUs < 0; ++i)
+		{
+			const uint16_t sequence = static_cast<uint16_t>(m_nextToReport + i);
+			if (IsPresent(sequence))
+				referenceUs = m_slots[sequence & m_mask].arrivalUs / kReferenceTimeUs * kReferenceTimeUs;
+		}
+
+		if (referenceUs >= 0)
+		{
+			m_feedback.baseSequenceNumber = m_nextToReport;
+			m_feedback.referenceTime = static_cast<uint32_t>(referenceUs / kReferenceTimeUs) & 0xFFFFFF;
+			m_feedback.feedbackCount = m_feedbackCount;
+			m_feedback.arrivalOffsetsUs.clear();
+			for (size_t i = 0; i < count; ++i)
+			{
+				const uint16_t sequence = static_cast<uint16_t>(m_nextToReport + i);
+				m_feedback.arrivalOffsetsUs.push_back(IsPresent(sequence)
+														  ? m_slots[sequence & m_mask].arrivalUs - referenceUs
+														  : RtcpTransportFeedback::kNotReceived);
+			}
+			// Fails only for arrivals more than 8 s apart, which a feedback
+			// interval never spans; those packets then go unreported
+			if (BuildRtcpTransportFeedback(senderSsrc, mediaSsrc, m_feedback, out))
+			{
+				++m_feedbackCount;
+				built = true;
+			}
+		}
+
+		for (size_t i = 0; i < count; ++i)
+			m_slots[(m_nextToReport + i) & m_mask].used = false;
+		m_nextToReport = static_cast<uint16_t>(m_nextToReport + count);
+	}
+	return built;
+}
@@ -0,0 +1,60 @@
+#pragma once
+
+#include "RtcpPacket.h"
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// Receiver side of transport-wide congestion control: records when each
+// packet with a transport-wide sequence number arrived and reports it back
+// in RTCP transport feedback, for the sender's CongestionController.
+//
+// Every packet that carries the number counts (media, RTX, FEC) as it comes
+// off the socket; repaired packets were never on the wire and do not.
+// Arrivals go into a ring indexed by sequence number like the jitter
+// buffer's, so recording one never allocates. Each feedback covers the
+// packets since the previous one; a gap is reported as lost, and a packet
+// arriving after its feedback went out is not reported again. Send
+// feedback every 50 to 100 ms: the controller reacts to each one, so the
+// interval bounds how fast it sees a queue building.
+//
+// Not thread-safe: call from the receive thread.
+class TransportFeedbackGenerator
+{
+public:
+	using Clock = std::chrono::steady_clock;
+
+	explicit TransportFeedbackGenerator(size_t capacity = 4096);
+
+	void OnPacket(uint16_t transportSequenceNumber, Clock::time_point arrival);
+
+	// Appends feedback about the packets since the previous call to `out`,
+	// in as many RTCP packets as needed; false when there is nothing new
+	bool BuildFeedback(uint32_t senderSsrc, uint32_t mediaSsrc, std::vector<uint8_t>& out);
+	void Reset();
+
+	// Sequence numbers per feedback packet, which keeps one under 1200 bytes
+	static constexpr size_t kMaxPacketsPerFeedback = 400;
+
+private:
+	struct Slot
+	{
+		bool used = false;
+		uint16_t sequenceNumber = 0;
+		int64_t arrivalUs = 0; // Since m_epoch
+	};
+
+	bool IsPresent(uint16_t sequenceNumber) const;
+
+	std::vector<Slot> m_slots;
+	uint16_t m_mask = 0;
+	bool m_started = false;
+	Clock::time_point m_epoch;
+	uint16_t m_nextToReport = 0;
+	uint16_t m_highest = 0;
+	bool m_hasNew = false;
+	uint8_t m_feedbackCount = 0;
+	RtcpTransportFeedback m_feedback;
+};
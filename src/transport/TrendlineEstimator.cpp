@@ -0,0 +1,125 @@
+#include "TrendlineEstimator.h"
+
+#include <algorithm>
+#include <cmath>
+
+namespace
+{
+	constexpr size_t kWindowSize = 20;
+	// Groups older than this leave the window early, so a sender bursting one
+	// group per frame at 10 fps fits in a second rather than two; the fit
+	// still wants at least kMinWindowSize groups spanning most of it
+	constexpr double kWindowMs = 1000.0;
+	constexpr size_t kMinWindowSize = 6;
+	constexpr double kSmoothing = 0.9;
+	constexpr double kThresholdGain = 4.0;
+	constexpr int kMaxDeltaCount = 60; // The trend's weight grows with the samples behind it, up to this
+	constexpr double kOverusingTimeMs = 10.0;
+	constexpr double kThresholdUp = 0.0087;	  // Per ms, when the trend is above the threshold
+	constexpr double kThresholdDown = 0.039;  // Per ms, when below
+	constexpr double kMaxThresholdJumpMs = 15.0; // Spikes beyond threshold + this do not move it
+	constexpr double kMinThreshold = 6.0;
+	constexpr double kMaxThreshold = 600.0;
+
+	// Least-squares slope of y over x; 0 when x does not vary
+	double LinearFitSlope(const std::deque<std::pair<double, double>>& points)
+	{
+		double sumX = 0.0;
+		double sumY = 0.0;
+		for (const auto& [x, y] : points)
+		{
+			sumX += x;
+			sumY += y;
+		}
+		const double meanX = sumX / static_cast<double>(points.size());
+		const double meanY = sumY / static_cast<double>(points.size());
+		double numerator = 0.0;
+		double denominator = 0.0;
+		for (const auto& [x, y] : points)
+		{
+			numerator += (x - meanX) * (y - meanY);
+			denominator += (x - meanX) * (x - meanX);
+		}
+		return denominator > 0.0 ? numerator / denominator : 0.0;
+	}
+}
+
+void TrendlineEstimator::Reset()
+{
+	*this = {};
+}
+
+BandwidthUsage TrendlineEstimator::Update(double sendDeltaMs, double arrivalDeltaMs, double arrivalTimeMs)
+{
+	m_deltaCount = std::min(m_deltaCount + 1, 1000);
+	if (m_firstArrivalMs < 0.0)
+		m_firstArrivalMs = arrivalTimeMs;
+
+	m_accumulatedDelayMs += arrivalDeltaMs - sendDeltaMs;
+	m_smoothedDelayMs = kSmoothing * m_smoothedDelayMs + (1.0 - kSmoothing) * m_accumulatedDelayMs;
+	m_window.emplace_back(arrivalTimeMs - m_firstArrivalMs, m_smoothedDelayMs);
+	const double newestMs = m_window.back().first;
+	while (m_window.size() > kWindowSize ||
+		   (m_window.size() > kMinWindowSize && m_window.front().first < newestMs - kWindowMs))
+		m_window.pop_front();
+	const bool windowFull = m_window.size() == kWindowSize || newestMs - m_window.front().first >= kWindowMs * 0.8;
+	if (windowFull)
+		m_trend = LinearFitSlope(m_window);
+
+	Detect(m_trend, sendDeltaMs, arrivalTimeMs);
+	return m_state;
+}
+
+void TrendlineEstimator::Detect(double trend, double sendDeltaMs, double nowMs)
+{
+	if (m_deltaCount < 2)
+	{
+		m_state = BandwidthUsage::Normal;
+		return;
+	}
+
+	m_modifiedTrend = std::min(m_deltaCount, kMaxDeltaCount) * trend * kThresholdGain;
+	if (m_modifiedTrend > m_threshold)
+	{
+		// Half a group's worth at the start, since it began somewhere in it
+		m_overuseTimeMs = m_overuseTimeMs < 0.0 ? sendDeltaMs / 2.0 : m_overuseTimeMs + sendDeltaMs;
+		++m_overuseCount;
+		if (m_overuseTimeMs > kOverusingTimeMs && m_overuseCount > 1 && trend >= m_previousTrend)
+		{
+			m_overuseTimeMs = 0.0;
+			m_overuseCount = 0;
+			m_state = BandwidthUsage::Overusing;
+		}
+	}
+	else if (m_modifiedTrend < -m_threshold)
+	{
+		m_overuseTimeMs = -1.0;
+		m_overuseCount = 0;
+		m_state = BandwidthUsage::Underusing;
+	}
+	else
+	{
+		m_overuseTimeMs = -1.0;
+		m_overuseCount = 0;
+		m_state = BandwidthUsage::Normal;
+	}
+	m_previousTrend = trend;
+	UpdateThreshold(m_modifiedTrend, nowMs);
+}
+
+void TrendlineEstimator::UpdateThreshold(double modifiedTrend, double nowMs)
+{
+	if (m_lastThresholdUpdateMs < 0.0)
+		m_lastThresholdUpdateMs = nowMs;
+
+	const double magnitude = std::abs(modifiedTrend);
+	if (magnitude > m_threshold + kMaxThresholdJumpMs)
+	{
+		m_lastThresholdUpdateMs = nowMs;
+		return;
+	}
+	const double gain = magnitude < m_threshold ? kThresholdDown : kThresholdUp;
+	const double elapsedMs = std::min(nowMs - m_lastThresholdUpdateMs, 100.0);
+	m_threshold = std::clamp(m_threshold + gain * (magnitude - m_threshold) * elapsedMs, kMinThreshold, kMaxThreshold);
+	m_lastThresholdUpdateMs = nowMs;
+}
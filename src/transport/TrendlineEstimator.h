@@ -0,0 +1,60 @@
+#pragma once
+
+#include <cstddef>
+#include <deque>
+#include <utility>
+
+// What the delay gradient says about the path
+enum class BandwidthUsage
+{
+	Normal,
+	Underusing, // A queue is draining
+	Overusing	// A queue is building: sending faster than the bottleneck
+};
+
+// The delay-based half of Google Congestion Control
+// (draft-ietf-rmcat-gcc-02, as WebRTC implements it today): a least-squares
+// trend over the last 20 one-way delay variations between packet groups,
+// or the last second of them when the groups are sparse, smoothed, compared
+// with an adaptive threshold.
+//
+// A group arriving later after the one before than it was sent after it
+// has waited in a queue. The accumulated variation is the queue's growth;
+// its slope over time is positive while the queue builds, whatever the
+// clock offset between the two ends. The threshold follows the trend,
+// slowly up and faster down, so competing TCP flows that keep a standing
+// queue do not starve the stream, and overuse is declared only once the
+// trend has been over it for 10 ms and is still rising.
+class TrendlineEstimator
+{
+public:
+	// One group's send time after the previous group's, its arrival after
+	// the previous group's arrival, and its arrival on the receiver's clock,
+	// all in milliseconds
+	BandwidthUsage Update(double sendDeltaMs, double arrivalDeltaMs, double arrivalTimeMs);
+
+	BandwidthUsage GetState() const { return m_state; }
+	// The trend scaled as it is compared with the threshold
+	double GetModifiedTrend() const { return m_modifiedTrend; }
+	double GetThreshold() const { return m_threshold; }
+	void Reset();
+
+private:
+	void Detect(double trend, double sendDeltaMs, double nowMs);
+	void UpdateThreshold(double modifiedTrend, double nowMs);
+
+	int m_deltaCount = 0;
+	double m_firstArrivalMs = -1.0;
+	double m_accumulatedDelayMs = 0.0;
+	double m_smoothedDelayMs = 0.0;
+	std::deque<std::pair<double, double>> m_window; // Arrival time, smoothed delay
+	double m_trend = 0.0;
+
+	double m_modifiedTrend = 0.0;
+	double m_threshold = 12.5;
+	double m_lastThresholdUpdateMs = -1.0;
+	double m_overuseTimeMs = -1.0;
+	int m_overuseCount = 0;
+	double m_previousTrend = 0.0;
+	BandwidthUsage m_state = BandwidthUsage::Normal;
+};
@@ -0,0 +1,420 @@
+#include "UdpSocket.h"
+#include "../platform/Logger.h"
+
+#include <algorithm>
+#include <format>
+
+#ifdef PLATFORM_WINDOWS
+#include <winsock2.h>
+#include <ws2tcpip.h>
+#include <mutex>
+#else
+#include <arpa/inet.h>
+#include <cerrno>
+#include <cstring>
+#include <netinet/in.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <unistd.h>
+#endif
+
+#ifdef PLATFORM_LINUX
+#include <netinet/udp.h>
+#ifndef UDP_SEGMENT
+#define UDP_SEGMENT 103 // linux/udp.h; older libc headers lack it
+#endif
+#endif
+
+namespace
+{
+	constexpr int kSocketBufferSize = 4 * 1024 * 1024; // Absorbs a 4K keyframe burst
+	constexpr size_t kMaxBatchMessages = 64;
+	constexpr size_t kMaxSegments = 64;			  // UDP_MAX_SEGMENTS
+	constexpr size_t kMaxSegmentedBytes = 65000; // Below the 65507-byte UDP payload limit
+
+#ifdef PLATFORM_WINDOWS
+	using NativeSocket = SOCKET;
+	const NativeSocket kInvalidSocket = INVALID_SOCKET;
+
+	bool InitializeWinsock()
+	{
+		static std::once_flag once;
+		static bool initialized = false;
+		std::call_once(once, [] {
+			WSADATA data;
+			initialized = WSAStartup(MAKEWORD(2, 2), &data) == 0;
+		});
+		return initialized;
+	}
+
+	int LastError() { return WSAGetLastError(); }
+	void CloseNative(NativeSocket socket) { closesocket(socket); }
+#else
+	using NativeSocket = int;
+	const NativeSocket kInvalidSocket = -1;
+
+	int LastError() { return errno; }
+	void CloseNative(NativeSocket socket) { close(socket); }
+#endif
+
+	bool ParseAddress(const std::string& address, uint16_t port, sockaddr_in& out)
+	{
+		out = {};
+		out.sin_family = AF_INET;
+		out.sin_port = htons(port);
+		return inet_pton(AF_INET, address.c_str(), &out.sin_addr) == 1;
+	}
+}
+
+#ifdef PLATFORM_LINUX
+struct UdpSocket::Batch
+{
+	struct Message
+	{
+		size_t firstVector = 0;
+		size_t vectorCount = 0;
+		size_t packetCount = 0;
+		uint16_t segmentSize = 0; // 0 = a single packet, no GSO
+	};
+
+	std::vector<Message> plan;
+	std::vector<iovec> vectors;
+	std::vector<mmsghdr> messages;
+	std::vector<uint8_t> control; // One CMSG_SPACE(uint16_t) block per message
+};
+#else
+struct UdpSocket::Batch
+{
+};
+#endif
+
+UdpSocket::UdpSocket() = default;
+
+UdpSocket::~UdpSocket()
+{
+	Close();
+}
+
+bool UdpSocket::Open(const std::string& localAddress, uint16_t localPort)
+{
+	Close();
+
+#ifdef PLATFORM_WINDOWS
+	if (!InitializeWinsock())
+	{
+		Logger::Error("Failed to initialize Winsock");
+		return false;
+	}
+#endif
+
+	sockaddr_in local;
+	if (!ParseAddress(localAddress, localPort, local))
+	{
+		Logger::Error(std::format("Invalid local address {}", localAddress));
+		return false;
+	}
+
+	const NativeSocket socket = ::socket(AF_INET, SOCK_DGRAM, IPPROTO_UDP);
+	if (socket == kInvalidSocket)
+	{
+		Logger::Error(std::format("Failed to create a UDP socket (error {})", LastError()));
+		return false;
+	}
+
+	// Best effort: the system may cap these
+	const int bufferSize = kSocketBufferSize;
+	setsockopt(socket, SOL_SOCKET, SO_SNDBUF, reinterpret_cast<const char*>(&bufferSize), sizeof(bufferSize));
+	setsockopt(socket, SOL_SOCKET, SO_RCVBUF, reinterpret_cast<const char*>(&bufferSize), sizeof(bufferSize));
+
+	if (bind(socket, reinterpret_cast<const sockaddr*>(&local), sizeof(local)) != 0)
+	{
+		Logger::Error(std::format("Failed to bind UDP socket to {}:{} (error {})", localAddress, localPort, LastError()));
+		CloseNative(socket);
+		return false;
+	}
+
+	m_socket = static_cast<intptr_t>(socket);
+	m_statistics = {};
+	m_batch = std::make_unique<Batch>();
+	SetSendMode(UdpSendMode::Batched);
+	return true;
+}
+
+bool UdpSocket::Connect(const std::string& address, uint16_t port)
+{
+	sockaddr_in remote;
+	if (!IsOpen() || !ParseAddress(address, port, remote))
+	{
+		Logger::Error(std::format("Invalid remote address {}:{}", address, port));
+		return false;
+	}
+	if (connect(static_cast<NativeSocket>(m_socket), reinterpret_cast<const sockaddr*>(&remote), sizeof(remote)) != 0)
+	{
+		Logger::Error(std::format("Failed to connect UDP socket to {}:{} (error {})", address, port, LastError()));
+		return false;
+	}
+	return true;
+}
+
+void UdpSocket::Close()
+{
+	if (!IsOpen())
+		return;
+	CloseNative(static_cast<NativeSocket>(m_socket));
+	m_socket = -1;
+	m_batch.reset();
+}
+
+bool UdpSocket::IsOpen() const
+{
+	return m_socket != -1;
+}
+
+uint16_t UdpSocket::GetLocalPort() const
+{
+	sockaddr_in local = {};
+	socklen_t size = sizeof(local);
+	if (!IsOpen() || getsockname(static_cast<NativeSocket>(m_socket), reinterpret_cast<sockaddr*>(&local), &size) != 0)
+		return 0;
+	return ntohs(local.sin_port);
+}
+
+bool UdpSocket::IsSegmentationSupported()
+{
+#ifdef PLATFORM_LINUX
+	// Linux 4.18+; probe once on a scratch socket
+	static const bool supported = [] {
+		const int socket = ::socket(AF_INET, SOCK_DGRAM, IPPROTO_UDP);
+		if (socket < 0)
+			return false;
+		const int segmentSize = 1200;
+		const bool ok = setsockopt(socket, SOL_UDP, UDP_SEGMENT, &segmentSize, sizeof(segmentSize)) == 0;
+		close(socket);
+		return ok;
+	}();
+	return supported;
+#else
+	return false;
+#endif
+}
+
+void UdpSocket::SetSendMode(UdpSendMode mode)
+{
+#ifdef PLATFORM_LINUX
+	if (mode == UdpSendMode::Segmented && !IsSegmentationSupported())
+		mode = UdpSendMode::Batched;
+#else
+	mode = UdpSendMode::Single;
+#endif
+	m_sendMode = mode;
+}
+
+size_t UdpSocket::Send(const RtpPacket* packets, size_t count)
+{
+	if (!IsOpen() || count == 0)
+		return 0;
+	if (m_sendMode == UdpSendMode::Single)
+		return SendSingle(packets, count);
+	return SendBatched(packets, count, m_sendMode == UdpSendMode::Segmented);
+}
+
+size_t UdpSocket::SendSingle(const RtpPacket* packets, size_t count)
+{
+	const NativeSocket socket = static_cast<NativeSocket>(m_socket);
+	size_t sent = 0;
+	for (size_t i = 0; i < count; ++i)
+	{
+		RtpSlice slices[RtpPacket::kMaxSlices];
+		const int sliceCount = packets[i].GetSlices(slices);
+
+#ifdef PLATFORM_WINDOWS
+		WSABUF buffers[RtpPacket::kMaxSlices];
+		for (int s = 0; s < sliceCount; ++s)
+			buffers[s] = { static_cast<ULONG>(slices[s].size), reinterpret_cast<CHAR*>(const_cast<uint8_t*>(slices[s].data)) };
+		DWORD bytes = 0;
+		const bool ok = WSASend(socket, buffers, static_cast<DWORD>(sliceCount), &bytes, 0, nullptr, nullptr) == 0;
+#else
+		iovec vectors[RtpPacket::kMaxSlices];
+		for (int s = 0; s < sliceCount; ++s)
+			vectors[s] = { const_cast<uint8_t*>(slices[s].data), slices[s].size };
+		msghdr message = {};
+		message.msg_iov = vectors;
+		message.msg_iovlen = static_cast<decltype(message.msg_iovlen)>(sliceCount);
+		ssize_t result;
+		do
+			result = sendmsg(socket, &message, 0);
+		while (result < 0 && errno == EINTR);
+		const bool ok = result >= 0;
+#endif
+		++m_statistics.sendCalls;
+		if (!ok)
+		{
+			++m_statistics.packetsDropped;
+			continue;
+		}
+		++sent;
+		++m_statistics.packetsSent;
+		m_statistics.bytesSent += packets[i].size;
+	}
+	return sent;
+}
+
+size_t UdpSocket::SendBatched(const RtpPacket* packets, size_t count, bool segmented)
+{
+#ifdef PLATFORM_LINUX
+	Batch& batch = *m_batch;
+	constexpr size_t kControlSize = CMSG_SPACE(sizeof(uint16_t));
+	size_t sent = 0;
+	size_t index = 0;
+	while (index < count)
+	{
+		// Plan one batch of messages. With GSO a message holds a run of
+		// packets of the first one's size, the last of which may be shorter.
+		batch.plan.clear();
+		batch.vectors.clear();
+		const size_t batchStart = index;
+		while (index < count && batch.plan.size() < kMaxBatchMessages)
+		{
+			Batch::Message message;
+			message.firstVector = batch.vectors.size();
+			const size_t segmentSize = packets[index].size;
+			size_t bytes = 0;
+			do
+			{
+				const RtpPacket& packet = packets[index + message.packetCount];
+				RtpSlice slices[RtpPacket::kMaxSlices];
+				const int sliceCount = packet.GetSlices(slices);
+				for (int s = 0; s < sliceCount; ++s)
+					batch.vectors.push_back({ const_cast<uint8_t*>(slices[s].data), slices[s].size });
+				bytes += packet.size;
+				++message.packetCount;
+				if (packet.size < segmentSize)
+					break;
+			} while (segmented && index + message.packetCount < count && message.packetCount < kMaxSegments &&
+					 packets[index + message.packetCount].size <= segmentSize &&
+					 bytes + packets[index + message.packetCount].size <= kMaxSegmentedBytes);
+
+			message.vectorCount = batch.vectors.size() - message.firstVector;
+			message.segmentSize = message.packetCount > 1 ? static_cast<uint16_t>(segmentSize) : 0;
+			index += message.packetCount;
+			batch.plan.push_back(message);
+		}
+
+		// The vectors are final now, so pointers into them stay valid
+		const size_t messageCount = batch.plan.size();
+		batch.messages.assign(messageCount, mmsghdr{});
+		batch.control.assign(messageCount * kControlSize, 0);
+		for (size_t m = 0; m < messageCount; ++m)
+		{
+			const Batch::Message& plan = batch.plan[m];
+			msghdr& header = batch.messages[m].msg_hdr;
+			header.msg_iov = batch.vectors.data() + plan.firstVector;
+			header.msg_iovlen = plan.vectorCount;
+			if (plan.segmentSize)
+			{
+				header.msg_control = batch.control.data() + m * kControlSize;
+				header.msg_controllen = kControlSize;
+				cmsghdr* control = CMSG_FIRSTHDR(&header);
+				control->cmsg_level = SOL_UDP;
+				control->cmsg_type = UDP_SEGMENT;
+				control->cmsg_len = CMSG_LEN(sizeof(uint16_t));
+				std::memcpy(CMSG_DATA(control), &plan.segmentSize, sizeof(uint16_t));
+			}
+		}
+
+		int result;
+		do
+			result = sendmmsg(static_cast<int>(m_socket), batch.messages.data(), static_cast<unsigned int>(messageCount), 0);
+		while (result < 0 && errno == EINTR);
+		++m_statistics.sendCalls;
+
+		if (result < 0 && segmented && (errno == EIO || errno == EINVAL || errno == EOPNOTSUPP))
+		{
+			// No GSO on this path after all (e.g. no checksum offload)
+			Logger::Warning(std::format("UDP segmentation offload failed ({}), sending packets separately",
+										std::strerror(errno)));
+			segmented = false;
+			m_sendMode = UdpSendMode::Batched;
+			index = batchStart;
+			continue;
+		}
+
+		// Count what went out; on an error, drop the first message and go on
+		// with the rest so one bad send does not stall the stream
+		const size_t delivered = result < 0 ? 0 : static_cast<size_t>(result);
+		size_t packetsDelivered = 0;
+		for (size_t m = 0; m < delivered; ++m)
+		{
+			packetsDelivered += batch.plan[m].packetCount;
+			m_statistics.segmentedSends += batch.plan[m].segmentSize ? 1 : 0;
+		}
+		for (size_t p = batchStart; p < batchStart + packetsDelivered; ++p)
+			m_statistics.bytesSent += packets[p].size;
+		m_statistics.packetsSent += packetsDelivered;
+		sent += packetsDelivered;
+		index = batchStart + packetsDelivered;
+		if (result < 0)
+		{
+			m_statistics.packetsDropped += batch.plan[0].packetCount;
+			index += batch.plan[0].packetCount;
+		}
+	}
+	return sent;
+#else
+	(void)segmented;
+	return SendSingle(packets, count);
+#endif
+}
+
+bool UdpSocket::SendDatagram(const uint8_t* data, size_t size)
+{
+	if (!IsOpen())
+		return false;
+	++m_statistics.sendCalls;
+#ifdef PLATFORM_WINDOWS
+	const bool ok = send(static_cast<NativeSocket>(m_socket), reinterpret_cast<const char*>(data), static_cast<int>(size), 0) >= 0;
+#else
+	ssize_t result;
+	do
+		result = send(static_cast<NativeSocket>(m_socket), data, size, 0);
+	while (result < 0 && errno == EINTR);
+	const bool ok = result >= 0;
+#endif
+	if (!ok)
+	{
+		++m_statistics.packetsDropped;
+		return false;
+	}
+	++m_statistics.packetsSent;
+	m_statistics.bytesSent += size;
+	return true;
+}
+
+int UdpSocket::Receive(uint8_t* buffer, size_t capacity, int timeoutMs)
+{
+	if (!IsOpen())
+		return -1;
+
+	const NativeSocket socket = static_cast<NativeSocket>(m_socket);
+#ifdef PLATFORM_WINDOWS
+	WSAPOLLFD descriptor = { socket, POLLRDNORM, 0 };
+	const int ready = WSAPoll(&descriptor, 1, timeoutMs);
+	if (ready <= 0)
+		return ready;
+	const int result = recv(socket, reinterpret_cast<char*>(buffer), static_cast<int>(capacity), 0);
+#else
+	pollfd descriptor = { socket, POLLIN, 0 };
+	int ready;
+	do
+		ready = poll(&descriptor, 1, timeoutMs);
+	while (ready < 0 && errno == EINTR);
+	if (ready <= 0)
+		return ready;
+	const int result = static_cast<int>(recv(socket, buffer, capacity, 0));
+#endif
+	if (result < 0)
+		return -1;
+	++m_statistics.packetsReceived;
+	m_statistics.bytesReceived += static_cast<uint64_t>(result);
+	return result;
+}
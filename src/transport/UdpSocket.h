@@ -0,0 +1,87 @@
+#pragma once
+
+#include "RtpPacketizer.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+enum class UdpSendMode
+{
+	Single,	 // One system call per packet
+	Batched, // Many packets per system call (sendmmsg)
+	Segmented // Batched, and runs of equal-size packets go down the stack as one
+			  // buffer the kernel or NIC splits (UDP GSO)
+};
+
+struct UdpSocketStatistics
+{
+	uint64_t packetsSent = 0;
+	uint64_t bytesSent = 0;
+	uint64_t sendCalls = 0;	 // System calls made to send
+	uint64_t segmentedSends = 0; // Messages sent as GSO super-packets
+	uint64_t packetsDropped = 0; // Failed to send
+	uint64_t packetsReceived = 0;
+	uint64_t bytesReceived = 0;
+};
+
+// Connected IPv4 UDP socket for RTP. Send() gathers each packet from its
+// slices (sendmsg/WSASendTo with a buffer list), so payloads go from the
+// encoder's buffer to the kernel without an intermediate copy.
+//
+// On Linux packets are sent in batches through sendmmsg. Runs of equal-size
+// packets (the fragments of one large NAL unit or VP8 frame) can also go
+// out as a single UDP GSO message when the kernel supports UDP_SEGMENT, so
+// a 4K stream at 20 Mbit/s costs tens of system calls per second rather
+// than thousands; but each such message leaves as one burst of up to 64
+// packets, which overflows receive buffers and router queues, so Segmented
+// is opt-in. Elsewhere each packet is one system call. If the kernel
+// rejects GSO at send time the socket falls back to Batched.
+class UdpSocket
+{
+public:
+	UdpSocket();
+	~UdpSocket();
+
+	UdpSocket(const UdpSocket&) = delete;
+	UdpSocket& operator=(const UdpSocket&) = delete;
+
+	// Binds to `localAddress`:`localPort` (port 0 picks one)
+	bool Open(const std::string& localAddress = "0.0.0.0", uint16_t localPort = 0);
+	// Sets the destination of Send() and the only source Receive() accepts
+	bool Connect(const std::string& address, uint16_t port);
+	void Close();
+	bool IsOpen() const;
+	uint16_t GetLocalPort() const;
+
+	// Capped to what the platform supports; defaults to Batched
+	void SetSendMode(UdpSendMode mode);
+	UdpSendMode GetSendMode() const { return m_sendMode; }
+	static bool IsSegmentationSupported();
+
+	// Blocks until the packets are handed to the kernel; returns how many
+	// were. Packets that failed are counted as dropped, not retried.
+	size_t Send(const RtpPacket* packets, size_t count);
+	// Sends one datagram already laid out in memory (RTCP, retransmissions)
+	bool SendDatagram(const uint8_t* data, size_t size);
+
+	// One datagram into `buffer`; its size, 0 on timeout, -1 on error
+	int Receive(uint8_t* buffer, size_t capacity, int timeoutMs);
+
+	const UdpSocketStatistics& GetStatistics() const { return m_statistics; }
+
+private:
+	size_t SendSingle(const RtpPacket* packets, size_t count);
+	size_t SendBatched(const RtpPacket* packets, size_t count, bool segmented);
+
+	intptr_t m_socket = -1;
+	UdpSendMode m_sendMode = UdpSendMode::Single;
+	UdpSocketStatistics m_statistics;
+
+	// sendmmsg buffers, reused across Send() calls; defined in the .cpp so
+	// this header does not pull in the platform socket headers
+	struct Batch;
+	std::unique_ptr<Batch> m_batch;
+};
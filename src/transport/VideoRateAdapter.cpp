@@ -0,0 +1,64 @@
+#include "VideoRateAdapter.h"
+
+#include <algorithm>
+#include <cmath>
+
+namespace
+{
+	constexpr double kFpsDivisors[] = { 1.0, 1.5, 2.0, 3.0, 4.0, 6.0 };
+	constexpr double kUpswitchMargin = 1.2;
+	constexpr double kMinBitrateChange = 0.05;
+}
+
+VideoRateAdapter::VideoRateAdapter(IVideoEncoder* encoder, IGraphicsCapture* capture, const VideoRateConfig& config)
+	: m_encoder(encoder)
+	, m_capture(capture)
+	, m_config(config)
+{
+	m_config.maxFps = std::max(m_config.maxFps, 1);
+	m_config.minFps = std::clamp(m_config.minFps, 1, m_config.maxFps);
+	m_config.width = std::max(m_config.width, 1);
+	m_config.height = std::max(m_config.height, 1);
+	m_rates.fps = m_config.maxFps;
+	m_captureFps = m_config.maxFps;
+}
+
+int VideoRateAdapter::ChooseFps(double mediaKbps) const
+{
+	const double pixels = static_cast<double>(m_config.width) * m_config.height;
+	const double affordableFps = mediaKbps * 1000.0 / (pixels * std::max(m_config.minBitsPerPixel, 1e-6));
+	for (double divisor : kFpsDivisors)
+	{
+		const int fps = std::max(static_cast<int>(std::lround(m_config.maxFps / divisor)), m_config.minFps);
+		const double needed = fps > m_rates.fps ? fps * kUpswitchMargin : fps;
+		if (needed <= affordableFps)
+			return fps;
+	}
+	return m_config.minFps;
+}
+
+VideoRates VideoRateAdapter::Update(int targetKbps, double protection)
+{
+	const double mediaKbps =
+		std::max(targetKbps, 1) * (1.0 - std::clamp(m_config.headroom, 0.0, 0.5)) / (1.0 + std::max(protection, 0.0));
+	VideoRates rates;
+	rates.bitrateKbps = std::max(static_cast<int>(std::lround(mediaKbps)), 1);
+	rates.fps = ChooseFps(mediaKbps);
+
+	const bool fpsChanged = rates.fps != m_rates.fps;
+	const bool bitrateChanged =
+		std::abs(rates.bitrateKbps - m_rates.bitrateKbps) > kMinBitrateChange * std::max(m_rates.bitrateKbps, 1);
+	if (fpsChanged || bitrateChanged)
+	{
+		m_rates = rates;
+		if (m_encoder)
+			m_encoder->SetRates(rates.bitrateKbps, rates.fps);
+	}
+
+	// A capture that refused the frame rate (shut down, or being
+	// replaced underneath us) is not pacing at it; ask again on every
+	// update until it takes it
+	if (m_capture && m_captureFps != m_rates.fps && m_capture->SetTargetFps(m_rates.fps))
+		m_captureFps = m_rates.fps;
+	return m_rates;
+}
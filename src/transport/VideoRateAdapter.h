@@ -0,0 +1,55 @@
+#pragma once
+
+#include "../capture/IGraphicsCapture.h"
+#include "../encoder/IVideoEncoder.h"
+
+struct VideoRateConfig
+{
+	int width = 1920; // Of the encoded pictures
+	int height = 1080;
+	int maxFps = 30;
+	int minFps = 5;
+	// Per pixel and frame. Below this, text smears; fewer, sharper frames
+	// read better on a screen share, so the frame rate gives way first.
+	double minBitsPerPixel = 0.02;
+	double headroom = 0.05; // Of the target, for packet headers and retransmissions
+};
+
+struct VideoRates
+{
+	int bitrateKbps = 0; // For the encoder, without protection or headroom
+	int fps = 0;
+};
+
+// Steers a running encoder and capture by the congestion controller's
+// target. What FEC and headers take comes off first; the rest goes to the
+// encoder. The frame rate steps down from maxFps (to 2/3, 1/2, 1/3, 1/4
+// and 1/6 of it) while the bits per frame would fall under
+// minBitsPerPixel, and back up only with 20% to spare, so a target hovering
+// near a step does not toggle it. The frame rate goes to the encoder's rate
+// control and to the capture's pacing, so frames the encoder cannot afford
+// are never captured or converted.
+//
+// Encoder rates are changed only when they move by 5% or the frame rate
+// changes: every change costs the encoder a rate control adjustment.
+class VideoRateAdapter
+{
+public:
+	// Either may be null; the rates are then only computed
+	VideoRateAdapter(IVideoEncoder* encoder, IGraphicsCapture* capture, const VideoRateConfig& config = {});
+
+	// `protection` is FEC packets per media packet (FecEncoder::GetProtection()).
+	// Returns the rates now in effect.
+	VideoRates Update(int targetKbps, double protection);
+
+	VideoRates GetRates() const { return m_rates; }
+
+private:
+	int ChooseFps(double mediaKbps) const;
+
+	IVideoEncoder* m_encoder;
+	IGraphicsCapture* m_capture;
+	VideoRateConfig m_config;
+	VideoRates m_rates;
+	int m_captureFps = 0; // Last frame rate the capture took
+};
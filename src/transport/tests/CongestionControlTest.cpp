@@ -0,0 +1,148 @@
+#include "../CongestionController.h"
+#include "../RtpDepacketizer.h"
+#include "../TransportFeedbackGenerator.h"
+#include "../TrendlineEstimator.h"
+#include "RtpTestFrames.h"
+#include "testing/Test.h"
+
+#include <algorithm>
+#include <vector>
+
+namespace
+{
+	constexpr uint8_t kTransportSequenceId = 1;
+
+	struct Link
+	{
+		double capacityKbps = 0.0; // 0 for unlimited
+		double delayMs = 20.0;
+		int lossEvery = 0; // Drop every Nth packet; 0 for none
+	};
+
+	// Sends one 1200-byte packet every 5 ms (1.9 Mbit/s) for `durationMs`
+	// through `link`, with feedback every 50 ms, and returns the controller's
+	// statistics at the end
+	CongestionStatistics Run(const Link& link, double durationMs, CongestionControlConfig config = {})
+	{
+		CongestionController controller(config);
+		TransportFeedbackGenerator receiver;
+		RtpPacketizerConfig packetizerConfig;
+		packetizerConfig.transportSequenceId = kTransportSequenceId;
+		RtpPacketizer packetizer(VideoCodec::VP8, packetizerConfig);
+		const EncodedFrame frame = MakeVp8Frame(1180, false, 1);
+
+		struct InFlight
+		{
+			std::vector<uint8_t> datagram;
+			double arrivalMs;
+		};
+		std::vector<InFlight> inFlight;
+		std::vector<RtpPacket> packets;
+		double linkFreeMs = 0.0;
+		int sent = 0;
+		for (double nowMs = 0.0; nowMs < durationMs; nowMs += 5.0)
+		{
+			packetizer.Packetize(frame, packets);
+			controller.OnSendPackets(packets.data(), packets.size(), TestTime(nowMs));
+			for (const RtpPacket& packet : packets)
+			{
+				if (link.lossEvery && ++sent % link.lossEvery == 0)
+					continue;
+				// Queue behind the packets before it at the bottleneck
+				double departMs = nowMs;
+				if (link.capacityKbps > 0.0)
+				{
+					departMs = std::max(nowMs, linkFreeMs) + packet.size * 8.0 / link.capacityKbps;
+					linkFreeMs = departMs;
+				}
+				inFlight.push_back({ ToDatagram(packet), departMs + link.delayMs });
+			}
+
+			// Deliver what has arrived by now
+			auto arrived = std::stable_partition(inFlight.begin(), inFlight.end(),
+												 [&](const InFlight& p) { return p.arrivalMs <= nowMs; });
+			for (auto it = inFlight.begin(); it != arrived; ++it)
+			{
+				RtpHeader header;
+				uint16_t number = 0;
+				if (ParseRtpHeader(it->datagram.data(), it->datagram.size(), header) &&
+					ReadTransportSequenceNumber(header, kTransportSequenceId, number))
+					receiver.OnPacket(number, TestTime(it->arrivalMs));
+			}
+			inFlight.erase(inFlight.begin(), arrived);
+
+			// Feedback reaches the sender after the return trip
+			if (static_cast<int>(nowMs) % 50 == 0)
+			{
+				std::vector<uint8_t> compound;
+				RtcpFeedback feedback;
+				if (receiver.BuildFeedback(1, 2, compound) &&
+					ParseRtcpFeedback(compound.data(), compound.size(), 2, feedback))
+				{
+					for (const RtcpTransportFeedback& report : feedback.transportFeedback)
+						controller.OnTransportFeedback(report, TestTime(nowMs + link.delayMs));
+				}
+			}
+		}
+		return controller.GetStatistics();
+	}
+}
+
+TEST(TrendlineEstimator_SteadyDelayIsNormal)
+{
+	TrendlineEstimator estimator;
+	for (int i = 0; i < 200; ++i)
+		CHECK(estimator.Update(5.0, 5.0, i * 5.0) == BandwidthUsage::Normal);
+}
+
+TEST(TrendlineEstimator_GrowingDelayIsOveruse)
+{
+	// Each group arrives 2 ms later than it was sent after the one before
+	TrendlineEstimator estimator;
+	int firstOveruse = -1;
+	for (int i = 0; i < 200 && firstOveruse < 0; ++i)
+	{
+		if (estimator.Update(5.0, 7.0, i * 7.0) == BandwidthUsage::Overusing)
+			firstOveruse = i;
+	}
+	CHECK(firstOveruse > 0);
+	CHECK(firstOveruse < 40);
+	CHECK(estimator.GetModifiedTrend() > estimator.GetThreshold());
+
+	// A draining queue reads as underuse
+	for (int i = 0; i < 30; ++i)
+		estimator.Update(5.0, 3.0, 1000.0 + i * 3.0);
+	CHECK(estimator.GetState() == BandwidthUsage::Underusing);
+}
+
+TEST(CongestionController_GrowsOnAClearPath)
+{
+	const CongestionStatistics statistics = Run({}, 5000.0);
+	CHECK(statistics.targetBitrateKbps > 1500);
+	CHECK(statistics.overuseEvents == 0);
+	CHECK(statistics.packetsLost == 0);
+	CHECK(statistics.rttMs > 35.0 && statistics.rttMs < 100.0);
+	CHECK(statistics.ackedBitrateKbps > 1700.0);
+}
+
+TEST(CongestionController_BacksOffAtABottleneck)
+{
+	// The 1.9 Mbit/s stream meets a 1 Mbit/s link: the queue builds
+	Link link;
+	link.capacityKbps = 1000.0;
+	const CongestionStatistics statistics = Run(link, 3000.0);
+	CHECK(statistics.overuseEvents > 0);
+	CHECK(statistics.delayBasedKbps < 1000);
+	CHECK(statistics.targetBitrateKbps < 1000);
+}
+
+TEST(CongestionController_BacksOffUnderLoss)
+{
+	// One packet in four lost, well over the 10% that triggers a decrease
+	Link link;
+	link.lossEvery = 4;
+	const CongestionStatistics statistics = Run(link, 3000.0);
+	CHECK(statistics.lossRate > 0.2);
+	CHECK(statistics.lossBasedKbps < 1500);
+	CHECK(statistics.targetBitrateKbps < 1500);
+}
@@ -0,0 +1,109 @@
+#include "../FecDecoder.h"
+#include "../FecEncoder.h"
+#include "RtpTestFrames.h"
+#include "testing/Test.h"
+
+#include <vector>
+
+namespace
+{
+	struct ProtectedFrame
+	{
+		std::vector<std::vector<uint8_t>> media;
+		std::vector<std::vector<uint8_t>> fec;
+	};
+
+	// One keyframe of `size` bytes with FEC at `protection` FEC packets per
+	// media packet. Packets vary in size, as the last of a frame does.
+	ProtectedFrame Protect(size_t size, double protection)
+	{
+		RtpPacketizer packetizer(VideoCodec::VP8, {});
+		std::vector<RtpPacket> packets;
+		const EncodedFrame frame = MakeVp8Frame(size, true, static_cast<uint32_t>(size));
+		packetizer.Packetize(frame, packets);
+
+		FecEncoder encoder;
+		encoder.SetProtection(protection, protection);
+		std::vector<RtpPacket> fec;
+		encoder.ProtectFrame(packets.data(), packets.size(), true, fec);
+		return { ToDatagrams(packets), ToDatagrams(fec) };
+	}
+}
+
+TEST(Fec_RecoversOneLostPacket)
+{
+	const ProtectedFrame frame = Protect(6000, 0.2);
+	REQUIRE(frame.media.size() == 6);
+	REQUIRE(frame.fec.size() == 2);
+
+	// The last packet is shorter and carries the marker; both come back too
+	for (const size_t lost : { size_t(0), size_t(3), size_t(5) })
+	{
+		FecDecoder decoder;
+		std::vector<RtpSlice> recovered;
+		for (size_t i = 0; i < frame.media.size(); ++i)
+		{
+			if (i != lost)
+				decoder.OnMediaPacket(frame.media[i].data(), frame.media[i].size(), recovered);
+		}
+		CHECK(recovered.empty());
+		for (const auto& fec : frame.fec)
+			decoder.OnFecPacket(fec.data(), fec.size(), recovered);
+		REQUIRE(recovered.size() == 1);
+		CHECK(std::vector<uint8_t>(recovered[0].data, recovered[0].data + recovered[0].size) == frame.media[lost]);
+		CHECK(decoder.GetStatistics().packetsRecovered == 1);
+	}
+}
+
+TEST(Fec_InterleavingRepairsABurst)
+{
+	// Two FEC packets protect alternate packets, so two consecutive losses
+	// are one per FEC packet
+	const ProtectedFrame frame = Protect(6000, 0.2);
+	FecDecoder decoder;
+	std::vector<RtpSlice> recovered;
+	for (const auto& fec : frame.fec)
+		decoder.OnFecPacket(fec.data(), fec.size(), recovered);
+	for (size_t i = 0; i < frame.media.size(); ++i)
+	{
+		if (i != 2 && i != 3)
+			decoder.OnMediaPacket(frame.media[i].data(), frame.media[i].size(), recovered);
+	}
+	REQUIRE(recovered.size() == 2);
+	std::vector<std::vector<uint8_t>> packets;
+	for (const RtpSlice& slice : recovered)
+		packets.emplace_back(slice.data, slice.data + slice.size);
+	CHECK((packets[0] == frame.media[2] && packets[1] == frame.media[3]) ||
+		  (packets[0] == frame.media[3] && packets[1] == frame.media[2]));
+}
+
+TEST(Fec_CannotRepairTwoLossesUnderOnePacket)
+{
+	const ProtectedFrame frame = Protect(3000, 0.2);
+	REQUIRE(frame.fec.size() == 1);
+	FecDecoder decoder;
+	std::vector<RtpSlice> recovered;
+	decoder.OnMediaPacket(frame.media[0].data(), frame.media[0].size(), recovered);
+	decoder.OnFecPacket(frame.fec[0].data(), frame.fec[0].size(), recovered);
+	CHECK(recovered.empty());
+	CHECK(decoder.GetStatistics().packetsRecovered == 0);
+}
+
+TEST(Fec_ProtectionFollowsTheLossRate)
+{
+	FecEncoder encoder;
+	CHECK(encoder.GetProtection(false) == 0.0);
+	encoder.SetLossRate(0.05);
+	CHECK(encoder.GetProtection(false) > 0.0);
+	CHECK(encoder.GetProtection(true) > encoder.GetProtection(false));
+	encoder.SetLossRate(0.5);
+	CHECK(encoder.GetProtection(true) <= 0.5);
+
+	// No loss, no FEC
+	FecEncoder idle;
+	RtpPacketizer packetizer(VideoCodec::VP8, {});
+	const EncodedFrame frame = MakeVp8Frame(5000, false, 1);
+	std::vector<RtpPacket> packets, fec;
+	packetizer.Packetize(frame, packets);
+	CHECK(idle.ProtectFrame(packets.data(), packets.size(), false, fec) == 0);
+}
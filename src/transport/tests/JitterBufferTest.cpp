@@ -0,0 +1,139 @@
+#include "../JitterBuffer.h"
+#include "RtpTestFrames.h"
+#include "testing/Test.h"
+
+#include <algorithm>
+#include <random>
+#include <vector>
+
+namespace
+{
+	struct TestStream
+	{
+		std::vector<EncodedFrame> frames;
+		std::vector<std::vector<std::vector<uint8_t>>> datagrams; // Per frame
+	};
+
+	// `keyframes[i]` says whether frame i is a keyframe; frames are 3 packets
+	// each, 33 ms apart
+	TestStream MakeStream(std::initializer_list<bool> keyframes)
+	{
+		RtpPacketizer packetizer(VideoCodec::VP8, {});
+		TestStream stream;
+		std::vector<RtpPacket> packets;
+		uint64_t timestampNs = 0;
+		for (const bool keyframe : keyframes)
+		{
+			stream.frames.push_back(
+				MakeVp8Frame(3000, keyframe, static_cast<uint32_t>(stream.frames.size() + 1), timestampNs));
+			packetizer.Packetize(stream.frames.back(), packets);
+			stream.datagrams.push_back(ToDatagrams(packets));
+			timestampNs += 33'000'000;
+		}
+		return stream;
+	}
+
+	bool Insert(JitterBuffer& buffer, const std::vector<uint8_t>& datagram, double ms)
+	{
+		return buffer.InsertPacket(datagram.data(), datagram.size(), TestTime(ms));
+	}
+}
+
+TEST(JitterBuffer_ReordersPackets)
+{
+	const TestStream stream = MakeStream({ true, false, false, false });
+	std::vector<std::vector<uint8_t>> all;
+	for (const auto& frame : stream.datagrams)
+		all.insert(all.end(), frame.begin(), frame.end());
+	std::shuffle(all.begin(), all.end(), std::mt19937(7));
+
+	JitterBuffer buffer(VideoCodec::VP8);
+	for (const auto& datagram : all)
+		CHECK(Insert(buffer, datagram, 0.0));
+
+	ReassembledFrame frame;
+	for (const EncodedFrame& sent : stream.frames)
+	{
+		REQUIRE(buffer.PopFrame(frame, TestTime(1.0)));
+		CHECK(frame.data == sent.data);
+		CHECK(frame.isKeyframe == sent.isKeyframe);
+	}
+	CHECK(!buffer.PopFrame(frame, TestTime(1.0)));
+	CHECK(!buffer.TakeKeyframeRequest());
+	CHECK(buffer.GetStatistics().framesReleased == stream.frames.size());
+}
+
+TEST(JitterBuffer_DropsDuplicatesAndLatePackets)
+{
+	const TestStream stream = MakeStream({ true, false });
+	JitterBuffer buffer(VideoCodec::VP8);
+	for (const auto& datagram : stream.datagrams[0])
+		CHECK(Insert(buffer, datagram, 0.0));
+	CHECK(!Insert(buffer, stream.datagrams[0][1], 1.0));
+
+	ReassembledFrame frame;
+	REQUIRE(buffer.PopFrame(frame, TestTime(2.0)));
+	CHECK(!Insert(buffer, stream.datagrams[0][2], 3.0)); // Its frame is gone
+
+	const JitterBufferStatistics statistics = buffer.GetStatistics();
+	CHECK(statistics.packetsDuplicate == 1);
+	CHECK(statistics.packetsLate == 1);
+}
+
+TEST(JitterBuffer_WaitsForMissingPacketsThenSkipsToAKeyframe)
+{
+	JitterBufferConfig config;
+	config.minWaitMs = 20;
+	config.maxWaitMs = 20;
+	const TestStream stream = MakeStream({ true, false, false, true });
+	JitterBuffer buffer(VideoCodec::VP8, config);
+	ReassembledFrame frame;
+
+	for (const auto& datagram : stream.datagrams[0])
+		Insert(buffer, datagram, 0.0);
+	REQUIRE(buffer.PopFrame(frame, TestTime(0.0)));
+
+	// Frame 1 loses its middle packet; frame 2 depends on it
+	Insert(buffer, stream.datagrams[1][0], 33.0);
+	Insert(buffer, stream.datagrams[1][2], 33.0);
+	for (const auto& datagram : stream.datagrams[2])
+		Insert(buffer, datagram, 66.0);
+	CHECK(!buffer.PopFrame(frame, TestTime(40.0)));
+
+	// A late packet within the wait completes the frame
+	JitterBuffer repaired(VideoCodec::VP8, config);
+	for (const auto& datagram : stream.datagrams[0])
+		Insert(repaired, datagram, 0.0);
+	Insert(repaired, stream.datagrams[1][0], 33.0);
+	Insert(repaired, stream.datagrams[1][2], 33.0);
+	Insert(repaired, stream.datagrams[1][1], 45.0);
+	REQUIRE(repaired.PopFrame(frame, TestTime(46.0)));
+	REQUIRE(repaired.PopFrame(frame, TestTime(46.0)));
+	CHECK(frame.data == stream.frames[1].data);
+
+	// Past the wait the frame is abandoned, and so is frame 2 that needs it
+	CHECK(!buffer.PopFrame(frame, TestTime(60.0)));
+	CHECK(buffer.TakeKeyframeRequest());
+	CHECK(!buffer.TakeKeyframeRequest());
+
+	for (const auto& datagram : stream.datagrams[3])
+		Insert(buffer, datagram, 99.0);
+	REQUIRE(buffer.PopFrame(frame, TestTime(99.0)));
+	CHECK(frame.isKeyframe && frame.data == stream.frames[3].data);
+	CHECK(buffer.GetStatistics().framesIncomplete >= 1);
+}
+
+TEST(JitterBuffer_StartsAtAKeyframe)
+{
+	const TestStream stream = MakeStream({ false, true });
+	JitterBuffer buffer(VideoCodec::VP8);
+	ReassembledFrame frame;
+	for (const auto& datagram : stream.datagrams[0])
+		Insert(buffer, datagram, 0.0);
+	CHECK(!buffer.PopFrame(frame, TestTime(1.0)));
+
+	for (const auto& datagram : stream.datagrams[1])
+		Insert(buffer, datagram, 33.0);
+	REQUIRE(buffer.PopFrame(frame, TestTime(34.0)));
+	CHECK(frame.data == stream.frames[1].data);
+}
@@ -0,0 +1,125 @@
+#include "../NackGenerator.h"
+#include "../RtpDepacketizer.h"
+#include "../RtpRetransmitter.h"
+#include "RtpTestFrames.h"
+#include "testing/Test.h"
+
+#include <memory>
+#include <vector>
+
+TEST(NackGenerator_NacksGapsAfterTheReorderWait)
+{
+	NackGenerator nack;
+	std::vector<uint16_t> list;
+	nack.OnPacket(65534, false, TestTime(0.0));
+	nack.OnPacket(2, false, TestTime(0.0)); // 65535, 0 and 1 missing, across the wrap
+
+	nack.GetNackList(TestTime(2.0), list);
+	CHECK(list.empty());
+
+	// Reordered, not lost
+	nack.OnPacket(65535, false, TestTime(3.0));
+	nack.GetNackList(TestTime(5.0), list);
+	CHECK((list == std::vector<uint16_t>{ 0, 1 }));
+
+	// Not again within a round trip
+	nack.GetNackList(TestTime(10.0), list);
+	CHECK(list.empty());
+
+	// The retransmission of 0 times the round trip at 40 ms
+	nack.OnPacket(0, true, TestTime(45.0));
+	CHECK(nack.GetRttMs() == 40.0);
+	nack.GetNackList(TestTime(5.0 + 40.0 * 1.25 + 2.0), list);
+	CHECK((list == std::vector<uint16_t>{ 1 }));
+
+	const NackStatistics statistics = nack.GetStatistics();
+	CHECK(statistics.packetsMissing == 3);
+	CHECK(statistics.packetsRecovered == 1);
+	CHECK(statistics.nacksSent == 3);
+}
+
+TEST(NackGenerator_GivesUpAndAsksForAKeyframe)
+{
+	NackConfig config;
+	config.maxAgeMs = 100;
+	config.maxMissing = 50;
+	NackGenerator nack(config);
+	std::vector<uint16_t> list;
+
+	nack.OnPacket(10, false, TestTime(0.0));
+	nack.OnPacket(12, false, TestTime(0.0));
+	nack.GetNackList(TestTime(101.0), list);
+	CHECK(list.empty());
+	CHECK(nack.GetStatistics().packetsGivenUp == 1);
+
+	nack.OnPacket(100, false, TestTime(110.0));
+	CHECK(nack.TakeKeyframeRequest());
+	CHECK(!nack.TakeKeyframeRequest());
+}
+
+TEST(RtpRetransmitter_AnswersNacksWithRtx)
+{
+	RtpPacketizerConfig mediaConfig;
+	mediaConfig.ssrc = 0xAAAA;
+	RtpPacketizer packetizer(VideoCodec::VP8, mediaConfig);
+	auto frame = std::make_shared<EncodedFrame>(MakeVp8Frame(5000, true, 9));
+	std::vector<RtpPacket> packets;
+	REQUIRE(packetizer.Packetize(*frame, packets));
+
+	RtxConfig config;
+	config.ssrc = 0xBBBB;
+	RtpRetransmitter retransmitter(config);
+	retransmitter.SetRtt(50.0);
+	retransmitter.OnPacketsSent(frame, packets.data(), packets.size(), TestTime(0.0));
+
+	const uint16_t requested[] = { packets[1].GetSequenceNumber(), packets[3].GetSequenceNumber(),
+								   static_cast<uint16_t>(packets[0].GetSequenceNumber() - 1) };
+	std::vector<RtpPacket> rtx;
+	CHECK(retransmitter.OnNack(requested, 3, TestTime(10.0), rtx) == 2);
+	REQUIRE(rtx.size() == 2);
+
+	// Each restores to exactly the packet it repeats
+	for (size_t i = 0; i < 2; ++i)
+	{
+		const std::vector<uint8_t> datagram = ToDatagram(rtx[i]);
+		RtpHeader header;
+		REQUIRE(ParseRtpHeader(datagram.data(), datagram.size(), header));
+		CHECK(header.ssrc == 0xBBBB && header.payloadType == config.payloadType);
+
+		uint8_t restored[1500];
+		const size_t size = RestoreRtxPacket(header, mediaConfig.payloadType, mediaConfig.ssrc, restored, sizeof(restored));
+		CHECK(std::vector<uint8_t>(restored, restored + size) == ToDatagram(packets[i * 2 + 1]));
+	}
+
+	// Asked again within the round trip: the first copy may still be on its way
+	rtx.clear();
+	CHECK(retransmitter.OnNack(requested, 2, TestTime(20.0), rtx) == 0);
+	CHECK(retransmitter.OnNack(requested, 2, TestTime(70.0), rtx) == 2);
+
+	const RtxStatistics& statistics = retransmitter.GetStatistics();
+	CHECK(statistics.packetsRetransmitted == 4);
+	CHECK(statistics.notInHistory == 1);
+	CHECK(statistics.suppressed == 2);
+}
+
+TEST(RtpRetransmitter_KeepsToItsBitrateBudget)
+{
+	RtpPacketizer packetizer(VideoCodec::VP8, {});
+	auto frame = std::make_shared<EncodedFrame>(MakeVp8Frame(100000, true, 10));
+	std::vector<RtpPacket> packets;
+	REQUIRE(packetizer.Packetize(*frame, packets));
+
+	// 1 Mbit/s buckets 100 ms worth: 12500 bytes, about ten packets
+	RtxConfig config;
+	config.maxBitrateKbps = 1000;
+	RtpRetransmitter retransmitter(config);
+	retransmitter.OnPacketsSent(frame, packets.data(), packets.size(), TestTime(0.0));
+
+	std::vector<uint16_t> requested;
+	for (const RtpPacket& packet : packets)
+		requested.push_back(packet.GetSequenceNumber());
+	std::vector<RtpPacket> rtx;
+	const size_t sent = retransmitter.OnNack(requested.data(), requested.size(), TestTime(200.0), rtx);
+	CHECK(sent >= 8 && sent <= 12);
+	CHECK(retransmitter.GetStatistics().suppressed == requested.size() - sent);
+}
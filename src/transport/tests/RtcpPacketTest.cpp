@@ -0,0 +1,100 @@
+#include "../RtcpPacket.h"
+#include "testing/Test.h"
+
+#include <vector>
+
+namespace
+{
+	constexpr uint32_t kSender = 0x11111111;
+	constexpr uint32_t kMedia = 0x22222222;
+}
+
+TEST(RtcpPacket_NackRoundTrip)
+{
+	// Sequence numbers across the wrap, spread over several 17-packet masks
+	std::vector<uint16_t> sequenceNumbers;
+	for (uint16_t sequence = 65500; sequence != 100; sequence += 3)
+		sequenceNumbers.push_back(sequence);
+
+	std::vector<uint8_t> compound;
+	size_t covered = 0;
+	while (covered < sequenceNumbers.size())
+	{
+		const size_t count = BuildRtcpNack(kSender, kMedia, sequenceNumbers.data() + covered,
+										   sequenceNumbers.size() - covered, 64, compound);
+		REQUIRE(count > 0);
+		covered += count;
+	}
+	CHECK(IsRtcpPacket(compound.data(), compound.size()));
+
+	RtcpFeedback feedback;
+	REQUIRE(ParseRtcpFeedback(compound.data(), compound.size(), kMedia, feedback));
+	CHECK(feedback.nacks == sequenceNumbers);
+	CHECK(!feedback.pictureLoss && !feedback.hasReport);
+
+	// Feedback about another stream is not ours
+	RtcpFeedback other;
+	REQUIRE(ParseRtcpFeedback(compound.data(), compound.size(), kMedia + 1, other));
+	CHECK(other.nacks.empty());
+}
+
+TEST(RtcpPacket_PliAndReceiverReport)
+{
+	std::vector<uint8_t> compound;
+	RtcpReportBlock block;
+	block.fractionLost = 26;
+	block.cumulativeLost = 0x123456;
+	block.highestSequenceNumber = 0x00030010;
+	block.jitter = 900;
+	BuildRtcpReceiverReport(kSender, kMedia, block, compound);
+	BuildRtcpPli(kSender, kMedia, compound);
+
+	RtcpFeedback feedback;
+	REQUIRE(ParseRtcpFeedback(compound.data(), compound.size(), kMedia, feedback));
+	CHECK(feedback.pictureLoss);
+	REQUIRE(feedback.hasReport);
+	CHECK(feedback.report.fractionLost == 26);
+	CHECK(feedback.report.cumulativeLost == 0x123456);
+	CHECK(feedback.report.highestSequenceNumber == 0x00030010);
+	CHECK(feedback.report.jitter == 900);
+}
+
+TEST(RtcpPacket_TransportFeedbackRoundTrip)
+{
+	RtcpTransportFeedback sent;
+	sent.baseSequenceNumber = 65530;
+	sent.referenceTime = 0xFFFFFF;
+	sent.feedbackCount = 7;
+	// Small and large steps, a step back (reordering) and losses; times are
+	// multiples of the 250 us resolution so they come back exactly
+	for (const int64_t offset : { 0, 250, 500, -1, 1000, 750, 80000, -1, -1, 3000000 })
+		sent.arrivalOffsetsUs.push_back(offset < 0 ? RtcpTransportFeedback::kNotReceived : offset);
+
+	std::vector<uint8_t> compound;
+	REQUIRE(BuildRtcpTransportFeedback(kSender, kMedia, sent, compound));
+	RtcpFeedback feedback;
+	REQUIRE(ParseRtcpFeedback(compound.data(), compound.size(), kMedia, feedback));
+	REQUIRE(feedback.transportFeedback.size() == 1);
+	const RtcpTransportFeedback& received = feedback.transportFeedback[0];
+	CHECK(received.baseSequenceNumber == sent.baseSequenceNumber);
+	CHECK(received.referenceTime == sent.referenceTime);
+	CHECK(received.feedbackCount == sent.feedbackCount);
+	CHECK(received.arrivalOffsetsUs == sent.arrivalOffsetsUs);
+
+	RtcpTransportFeedback empty;
+	CHECK(!BuildRtcpTransportFeedback(kSender, kMedia, empty, compound));
+}
+
+TEST(RtcpPacket_RejectsMalformedPackets)
+{
+	std::vector<uint8_t> compound;
+	BuildRtcpPli(kSender, kMedia, compound);
+	RtcpFeedback feedback;
+	CHECK(!ParseRtcpFeedback(compound.data(), compound.size() - 1, kMedia, feedback));
+
+	compound[3] = 10; // Length past the end
+	CHECK(!ParseRtcpFeedback(compound.data(), compound.size(), kMedia, feedback));
+
+	const uint8_t rtp[12] = { 0x80, 96 };
+	CHECK(!IsRtcpPacket(rtp, sizeof(rtp)));
+}
@@ -0,0 +1,125 @@
+#include "../RtpDepacketizer.h"
+#include "../RtpPacketizer.h"
+#include "RtpTestFrames.h"
+#include "testing/Test.h"
+
+#include <random>
+#include <vector>
+
+namespace
+{
+	// Packetizes `frame`, checks the packets are well formed and one frame,
+	// and returns what the depacketizer rebuilds from them
+	std::vector<uint8_t> RoundTrip(VideoCodec codec, const EncodedFrame& frame, const RtpPacketizerConfig& config,
+								   size_t* packetCount = nullptr)
+	{
+		RtpPacketizer packetizer(codec, config);
+		RtpDepacketizer depacketizer(codec);
+		std::vector<RtpPacket> packets;
+		std::vector<uint8_t> rebuilt;
+		if (!packetizer.Packetize(frame, packets))
+			return rebuilt;
+		if (packetCount)
+			*packetCount = packets.size();
+
+		for (size_t i = 0; i < packets.size(); ++i)
+		{
+			const std::vector<uint8_t> datagram = ToDatagram(packets[i]);
+			RtpHeader header;
+			CHECK(ParseRtpHeader(datagram.data(), datagram.size(), header));
+			CHECK(datagram.size() <= config.maxPacketSize);
+			CHECK(header.payloadType == config.payloadType);
+			CHECK(header.ssrc == packetizer.GetSsrc());
+			CHECK(header.sequenceNumber == static_cast<uint16_t>(packets[0].GetSequenceNumber() + i));
+			CHECK(header.timestamp == packets[0].GetTimestamp());
+			CHECK(header.marker == (i + 1 == packets.size()));
+
+			RtpPayloadInfo info;
+			CHECK(depacketizer.Inspect(header.payload, header.payloadSize, info));
+			if (i == 0)
+				CHECK(info.frameStart && info.keyframe == frame.isKeyframe);
+			CHECK(depacketizer.Append(header.payload, header.payloadSize, rebuilt));
+		}
+		return rebuilt;
+	}
+
+	void AppendNalUnit(std::vector<uint8_t>& stream, uint8_t header, size_t size, std::mt19937& random)
+	{
+		for (const int byte : { 0, 0, 0, 1, static_cast<int>(header) }) // Start code and NAL unit header
+			stream.push_back(static_cast<uint8_t>(byte));
+		for (size_t i = 1; i < size; ++i)
+			stream.push_back(static_cast<uint8_t>(1 + random() % 255)); // No start code emulation
+	}
+}
+
+TEST(RtpPacketizer_Vp8RoundTrip)
+{
+	RtpPacketizerConfig config;
+	config.ssrc = 0x1234;
+	for (const size_t size : { size_t(1), size_t(500), size_t(1188), size_t(25000) })
+	{
+		const EncodedFrame frame = MakeVp8Frame(size, size != 500, static_cast<uint32_t>(size));
+		size_t packets = 0;
+		CHECK(RoundTrip(VideoCodec::VP8, frame, config, &packets) == frame.data);
+		CHECK(packets == (size + 1183) / 1184); // 12 bytes of RTP header, 4 of VP8 descriptor
+	}
+}
+
+TEST(RtpPacketizer_H264RoundTrip)
+{
+	// SPS, PPS and SEI aggregate into one STAP-A; the IDR slice is split
+	// into FU-A fragments; a small trailing slice goes out on its own
+	std::mt19937 random(3);
+	EncodedFrame frame;
+	frame.isKeyframe = true;
+	AppendNalUnit(frame.data, 0x67, 20, random);
+	AppendNalUnit(frame.data, 0x68, 5, random);
+	AppendNalUnit(frame.data, 0x06, 30, random);
+	AppendNalUnit(frame.data, 0x65, 10000, random);
+	AppendNalUnit(frame.data, 0x65, 700, random);
+
+	RtpPacketizerConfig config;
+	config.transportSequenceId = 3;
+	size_t packets = 0;
+	CHECK(RoundTrip(VideoCodec::H264, frame, config, &packets) == frame.data);
+	CHECK(packets == 1 + 9 + 1);
+
+	EncodedFrame empty;
+	RtpPacketizer packetizer(VideoCodec::H264, config);
+	std::vector<RtpPacket> out;
+	CHECK(!packetizer.Packetize(empty, out));
+}
+
+TEST(RtpPacketizer_TransportSequenceNumbers)
+{
+	RtpPacketizerConfig config;
+	config.transportSequenceId = 5;
+	RtpPacketizer packetizer(VideoCodec::VP8, config);
+	std::vector<RtpPacket> packets;
+	REQUIRE(packetizer.Packetize(MakeVp8Frame(3000, true, 1), packets));
+
+	for (size_t i = 0; i < packets.size(); ++i)
+	{
+		CHECK(packets[i].SetTransportSequenceNumber(static_cast<uint16_t>(65534 + i)));
+		const std::vector<uint8_t> datagram = ToDatagram(packets[i]);
+		RtpHeader header;
+		uint16_t number = 0;
+		REQUIRE(ParseRtpHeader(datagram.data(), datagram.size(), header));
+		CHECK(ReadTransportSequenceNumber(header, 5, number) && number == static_cast<uint16_t>(65534 + i));
+		CHECK(!ReadTransportSequenceNumber(header, 6, number));
+		CHECK(datagram.size() <= config.maxPacketSize);
+	}
+}
+
+TEST(RtpPacketizer_RejectsMalformedPackets)
+{
+	RtpPacketizer packetizer(VideoCodec::VP8, {});
+	std::vector<RtpPacket> packets;
+	REQUIRE(packetizer.Packetize(MakeVp8Frame(100, true, 2), packets));
+	std::vector<uint8_t> datagram = ToDatagram(packets[0]);
+
+	RtpHeader header;
+	CHECK(!ParseRtpHeader(datagram.data(), kRtpHeaderSize - 1, header));
+	datagram[0] = 0x40; // Version 1
+	CHECK(!ParseRtpHeader(datagram.data(), datagram.size(), header));
+}
@@ -0,0 +1,48 @@
+#pragma once
+
+#include "../RtpPacketizer.h"
+
+#include <chrono>
+#include <cstdint>
+#include <random>
+#include <vector>
+
+// Encoded frames and datagrams for the transport tests
+
+// A VP8 frame of `size` bytes: the frame tag's P bit (bit 0 of the first
+// byte) is what marks a keyframe; the rest is noise
+inline EncodedFrame MakeVp8Frame(size_t size, bool keyframe, uint32_t seed, uint64_t timestampNs = 0)
+{
+	std::mt19937 random(seed);
+	EncodedFrame frame;
+	frame.data.resize(size);
+	for (auto& byte : frame.data)
+		byte = static_cast<uint8_t>(random());
+	frame.data[0] = static_cast<uint8_t>((frame.data[0] & ~1u) | (keyframe ? 0 : 1));
+	frame.isKeyframe = keyframe;
+	frame.timestampNs = timestampNs;
+	return frame;
+}
+
+// The bytes the socket would send for `packet`
+inline std::vector<uint8_t> ToDatagram(const RtpPacket& packet)
+{
+	std::vector<uint8_t> datagram(packet.size);
+	packet.CopyTo(datagram.data());
+	return datagram;
+}
+
+inline std::vector<std::vector<uint8_t>> ToDatagrams(const std::vector<RtpPacket>& packets)
+{
+	std::vector<std::vector<uint8_t>> datagrams;
+	for (const RtpPacket& packet : packets)
+		datagrams.push_back(ToDatagram(packet));
+	return datagrams;
+}
+
+// A fixed point on the steady clock plus `ms`, so tests control time
+inline std::chrono::steady_clock::time_point TestTime(double ms)
+{
+	return std::chrono::steady_clock::time_point{} + std::chrono::hours(1) +
+		   std::chrono::duration_cast<std::chrono::steady_clock::duration>(std::chrono::duration<double, std::milli>(ms));
+}
@@ -0,0 +1,82 @@
+#include "AlphaBlend.h"
+
+#include <algorithm>
+
+namespace
+{
+	void ScalarBlendRow(uint32_t* dst, const uint32_t* src, int count)
+	{
+		for (int i = 0; i < count; ++i)
+			dst[i] = BlendPixelOver(dst[i], src[i]);
+	}
+
+	const BlendKernels* SelectKernels()
+	{
+		const BlendKernels* kernels = nullptr;
+		switch (CpuFeatures::GetSimdLevel())
+		{
+		case SimdLevel::AVX512: // Rows are a few dozen pixels; AVX2 is as fast
+		case SimdLevel::AVX2:
+			kernels = GetAVX2BlendKernels();
+			break;
+		case SimdLevel::SSE2:
+			kernels = GetSSE2BlendKernels();
+			break;
+		case SimdLevel::NEON:
+			kernels = GetNEONBlendKernels();
+			break;
+		case SimdLevel::Scalar:
+			break;
+		}
+		return kernels ? kernels : GetScalarBlendKernels();
+	}
+
+	const BlendKernels* GetKernels()
+	{
+		static const BlendKernels* kernels = SelectKernels();
+		return kernels;
+	}
+}
+
+const BlendKernels* GetScalarBlendKernels()
+{
+	static const BlendKernels kernels = { SimdLevel::Scalar, ScalarBlendRow };
+	return &kernels;
+}
+
+#ifndef VIDEO_ARCH_X86
+const BlendKernels* GetSSE2BlendKernels() { return nullptr; }
+const BlendKernels* GetAVX2BlendKernels() { return nullptr; }
+#endif
+#ifndef VIDEO_ARCH_ARM64
+const BlendKernels* GetNEONBlendKernels() { return nullptr; }
+#endif
+
+bool AlphaBlend::BlendOver(MutableBgraView frame, BgraView image, int x, int y)
+{
+	if (frame.IsEmpty() || image.IsEmpty())
+		return false;
+
+	// The overlap, as a view into each
+	const MutableBgraView dst = frame.Crop(x, y, image.width, image.height);
+	if (dst.IsEmpty())
+		return false;
+	const BgraView src = image.Crop(std::max(-x, 0), std::max(-y, 0), dst.width, dst.height);
+
+	const BlendKernels* kernels = GetKernels();
+	for (int row = 0; row < dst.height; ++row)
+		kernels->blendRow(dst.Row(row), src.Row(row), dst.width);
+	return true;
+}
+
+bool AlphaBlend::BlendOver(uint8_t* frame, int frameStride, int frameWidth, int frameHeight, const uint32_t* image,
+						   int imageWidth, int imageHeight, int x, int y)
+{
+	return BlendOver(MutableBgraView(frame, frameWidth, frameHeight, frameStride),
+					 BgraView(image, imageWidth, imageHeight), x, y);
+}
+
+SimdLevel AlphaBlend::GetSimdLevel()
+{
+	return GetKernels()->level;
+}
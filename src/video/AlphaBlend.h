@@ -0,0 +1,21 @@
+#pragma once
+
+#include "BlendKernels.h"
+#include "ImageView.h"
+
+#include <cstdint>
+
+// Draws small premultiplied BGRA images (cursor shapes, overlays) over a BGRA
+// frame. Rows are blended with the best BlendKernels for this CPU; the image
+// is clipped to the frame, so it may hang over any edge.
+class AlphaBlend
+{
+public:
+	// Blends the `imageWidth` x `imageHeight` image with its top-left corner at
+	// (x, y) of the frame. Returns false when nothing of it is on the frame.
+	static bool BlendOver(MutableBgraView frame, BgraView image, int x, int y);
+	static bool BlendOver(uint8_t* frame, int frameStride, int frameWidth, int frameHeight, const uint32_t* image,
+						  int imageWidth, int imageHeight, int x, int y);
+
+	static SimdLevel GetSimdLevel();
+};
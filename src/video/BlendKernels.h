@@ -0,0 +1,41 @@
+#pragma once
+
+#include "CpuFeatures.h"
+
+#include <cstdint>
+
+// Premultiplied-alpha "over" for one instruction set:
+// dst = src + dst * (255 - src.a) / 255 per channel, rounded exactly, so
+// every level produces the same bytes as BlendPixelOver().
+struct BlendKernels
+{
+	SimdLevel level;
+
+	// Blends `count` BGRA pixels of `src` over `dst` in place
+	void (*blendRow)(uint32_t* dst, const uint32_t* src, int count);
+};
+
+// Rounded x / 255 for x in [0, 255 * 255]
+inline uint32_t Div255(uint32_t x)
+{
+	x += 128;
+	return (x + (x >> 8)) >> 8;
+}
+
+// Scalar reference for the kernels
+inline uint32_t BlendPixelOver(uint32_t dst, uint32_t src)
+{
+	const uint32_t inverse = 255 - (src >> 24);
+	uint32_t result = 0;
+	for (int shift = 0; shift < 32; shift += 8)
+	{
+		const uint32_t channel = ((src >> shift) & 0xFF) + Div255(((dst >> shift) & 0xFF) * inverse);
+		result |= (channel > 255 ? 255 : channel) << shift;
+	}
+	return result;
+}
+
+const BlendKernels* GetScalarBlendKernels();
+const BlendKernels* GetSSE2BlendKernels();
+const BlendKernels* GetAVX2BlendKernels();
+const BlendKernels* GetNEONBlendKernels();
@@ -0,0 +1,39 @@
+#include "BlendKernels.h"
+
+#include <immintrin.h>
+
+namespace
+{
+	// Four pixels as 16-bit lanes: src + div255(dst * (255 - alpha))
+	inline __m256i BlendHalf(__m256i dst, __m256i src)
+	{
+		const __m256i alpha = _mm256_shufflehi_epi16(_mm256_shufflelo_epi16(src, 0xFF), 0xFF);
+		const __m256i inverse = _mm256_sub_epi16(_mm256_set1_epi16(255), alpha);
+		__m256i product = _mm256_add_epi16(_mm256_mullo_epi16(dst, inverse), _mm256_set1_epi16(128));
+		product = _mm256_srli_epi16(_mm256_add_epi16(product, _mm256_srli_epi16(product, 8)), 8);
+		return _mm256_add_epi16(src, product);
+	}
+
+	void BlendRow(uint32_t* dst, const uint32_t* src, int count)
+	{
+		const __m256i zero = _mm256_setzero_si256();
+		int i = 0;
+		// Unpack and pack both work within 128-bit lanes, so pixel order is kept
+		for (; i + 8 <= count; i += 8)
+		{
+			const __m256i d = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(dst + i));
+			const __m256i s = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(src + i));
+			const __m256i low = BlendHalf(_mm256_unpacklo_epi8(d, zero), _mm256_unpacklo_epi8(s, zero));
+			const __m256i high = BlendHalf(_mm256_unpackhi_epi8(d, zero), _mm256_unpackhi_epi8(s, zero));
+			_mm256_storeu_si256(reinterpret_cast<__m256i*>(dst + i), _mm256_packus_epi16(low, high));
+		}
+		for (; i < count; ++i)
+			dst[i] = BlendPixelOver(dst[i], src[i]);
+	}
+}
+
+const BlendKernels* GetAVX2BlendKernels()
+{
+	static const BlendKernels kernels = { SimdLevel::AVX2, BlendRow };
+	return &kernels;
+}
@@ -0,0 +1,34 @@
+#include "BlendKernels.h"
+
+#include <arm_neon.h>
+
+namespace
+{
+	// vld4 splits the channels, so alpha comes for free as its own register
+	void BlendRow(uint32_t* dst, const uint32_t* src, int count)
+	{
+		int i = 0;
+		for (; i + 8 <= count; i += 8)
+		{
+			uint8x8x4_t d = vld4_u8(reinterpret_cast<const uint8_t*>(dst + i));
+			const uint8x8x4_t s = vld4_u8(reinterpret_cast<const uint8_t*>(src + i));
+			const uint8x8_t inverse = vmvn_u8(s.val[3]);
+			for (int c = 0; c < 4; ++c)
+			{
+				// div255 rounded: (x + 128 + ((x + 128) >> 8)) >> 8
+				const uint16x8_t product = vaddq_u16(vmull_u8(d.val[c], inverse), vdupq_n_u16(128));
+				const uint8x8_t scaled = vshrn_n_u16(vaddq_u16(product, vshrq_n_u16(product, 8)), 8);
+				d.val[c] = vqadd_u8(s.val[c], scaled);
+			}
+			vst4_u8(reinterpret_cast<uint8_t*>(dst + i), d);
+		}
+		for (; i < count; ++i)
+			dst[i] = BlendPixelOver(dst[i], src[i]);
+	}
+}
+
+const BlendKernels* GetNEONBlendKernels()
+{
+	static const BlendKernels kernels = { SimdLevel::NEON, BlendRow };
+	return &kernels;
+}
@@ -0,0 +1,38 @@
+#include "BlendKernels.h"
+
+#include <emmintrin.h>
+
+namespace
+{
+	// Two pixels as 16-bit lanes: src + div255(dst * (255 - alpha))
+	inline __m128i BlendHalf(__m128i dst, __m128i src)
+	{
+		const __m128i alpha = _mm_shufflehi_epi16(_mm_shufflelo_epi16(src, 0xFF), 0xFF);
+		const __m128i inverse = _mm_sub_epi16(_mm_set1_epi16(255), alpha);
+		__m128i product = _mm_add_epi16(_mm_mullo_epi16(dst, inverse), _mm_set1_epi16(128));
+		product = _mm_srli_epi16(_mm_add_epi16(product, _mm_srli_epi16(product, 8)), 8);
+		return _mm_add_epi16(src, product);
+	}
+
+	void BlendRow(uint32_t* dst, const uint32_t* src, int count)
+	{
+		const __m128i zero = _mm_setzero_si128();
+		int i = 0;
+		for (; i + 4 <= count; i += 4)
+		{
+			const __m128i d = _mm_loadu_si128(reinterpret_cast<const __m128i*>(dst + i));
+			const __m128i s = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i));
+			const __m128i low = BlendHalf(_mm_unpacklo_epi8(d, zero), _mm_unpacklo_epi8(s, zero));
+			const __m128i high = BlendHalf(_mm_unpackhi_epi8(d, zero), _mm_unpackhi_epi8(s, zero));
+			_mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i), _mm_packus_epi16(low, high));
+		}
+		for (; i < count; ++i)
+			dst[i] = BlendPixelOver(dst[i], src[i]);
+	}
+}
+
+const BlendKernels* GetSSE2BlendKernels()
+{
+	static const BlendKernels kernels = { SimdLevel::SSE2, BlendRow };
+	return &kernels;
+}
@@ -0,0 +1,276 @@
+#include "ColorConversion.h"
+#include "../capture/IGraphicsCapture.h"
+
+#include <algorithm>
+#include <cmath>
+
+namespace
+{
+	constexpr double kFixedPointScale = 16384.0; // Q14
+
+	int16_t ToFixed(double value)
+	{
+		return static_cast<int16_t>(std::lround(value * kFixedPointScale));
+	}
+
+	// Offset and rounding folded into one term, see PlaneCoefficients
+	int16_t OffsetTerm(int offset)
+	{
+		return static_cast<int16_t>(offset * 64 + 32);
+	}
+
+	ColorCoefficients ComputeCoefficients(ColorMatrix matrix, ColorRange range)
+	{
+		const double kr = matrix == ColorMatrix::BT601 ? 0.299 : 0.2126;
+		const double kb = matrix == ColorMatrix::BT601 ? 0.114 : 0.0722;
+		const bool limited = range == ColorRange::Limited;
+		const double yScale = limited ? 219.0 / 255.0 : 1.0;
+		const double cScale = limited ? 224.0 / 255.0 : 1.0;
+
+		// Green takes whatever keeps each row summing exactly to its scale, so
+		// white maps to 235/255 and every grey to chroma 128 with no drift
+		ColorCoefficients c;
+		c.y.r = ToFixed(kr * yScale);
+		c.y.b = ToFixed(kb * yScale);
+		c.y.g = static_cast<int16_t>(ToFixed(yScale) - c.y.r - c.y.b);
+		c.y.k = OffsetTerm(limited ? 16 : 0);
+
+		c.u.b = ToFixed(0.5 * cScale);
+		c.u.r = ToFixed(-kr / (2.0 * (1.0 - kb)) * cScale);
+		c.u.g = static_cast<int16_t>(-c.u.b - c.u.r);
+		c.u.k = OffsetTerm(128);
+
+		c.v.r = ToFixed(0.5 * cScale);
+		c.v.b = ToFixed(-kb / (2.0 * (1.0 - kr)) * cScale);
+		c.v.g = static_cast<int16_t>(-c.v.r - c.v.b);
+		c.v.k = OffsetTerm(128);
+		return c;
+	}
+
+	uint8_t ClampToByte(int value)
+	{
+		return static_cast<uint8_t>(std::clamp(value, 0, 255));
+	}
+
+	uint8_t PixelSample(const uint8_t* p, const PlaneCoefficients& c)
+	{
+		return ClampToByte((c.b * p[0] + c.g * p[1] + c.r * p[2] + c.k * 256) >> 14);
+	}
+
+	uint8_t SumSample(int b, int g, int r, const PlaneCoefficients& c)
+	{
+		return ClampToByte((c.b * b + c.g * g + c.r * r + c.k * 1024) >> 16);
+	}
+
+	void ScalarRowToPlane(const uint8_t* bgra, uint8_t* dst, int width, const PlaneCoefficients& coefficients)
+	{
+		for (int x = 0; x < width; ++x)
+			dst[x] = PixelSample(bgra + x * 4, coefficients);
+	}
+
+	// Calls emit(index, B4, G4, R4) for every 2x2 block; an odd last column
+	// repeats the edge pixel, as encoders expect for odd-sized frames
+	template <typename Emit>
+	void ForEachChromaBlock(const uint8_t* row0, const uint8_t* row1, int width, Emit&& emit)
+	{
+		for (int x = 0; x < width; x += 2)
+		{
+			const uint8_t* a = row0 + x * 4;
+			const uint8_t* b = row1 + x * 4;
+			const int next = x + 1 < width ? 4 : 0;
+			emit(x / 2,
+				 a[0] + a[next + 0] + b[0] + b[next + 0],
+				 a[1] + a[next + 1] + b[1] + b[next + 1],
+				 a[2] + a[next + 2] + b[2] + b[next + 2]);
+		}
+	}
+
+	void ScalarRowPairToChroma(const uint8_t* row0, const uint8_t* row1, uint8_t* u, uint8_t* v, int width,
+							   const ColorCoefficients& coefficients)
+	{
+		ForEachChromaBlock(row0, row1, width, [&](int i, int b, int g, int r) {
+			u[i] = SumSample(b, g, r, coefficients.u);
+			v[i] = SumSample(b, g, r, coefficients.v);
+		});
+	}
+
+	void ScalarRowPairToChromaInterleaved(const uint8_t* row0, const uint8_t* row1, uint8_t* uv, int width,
+										  const ColorCoefficients& coefficients)
+	{
+		ForEachChromaBlock(row0, row1, width, [&](int i, int b, int g, int r) {
+			uv[i * 2 + 0] = SumSample(b, g, r, coefficients.u);
+			uv[i * 2 + 1] = SumSample(b, g, r, coefficients.v);
+		});
+	}
+
+	const ColorKernels* SelectKernels()
+	{
+		const ColorKernels* kernels = nullptr;
+		switch (CpuFeatures::GetSimdLevel())
+		{
+		case SimdLevel::AVX512:
+			kernels = GetAVX512ColorKernels();
+			break;
+		case SimdLevel::AVX2:
+			kernels = GetAVX2ColorKernels();
+			break;
+		case SimdLevel::SSE2:
+			kernels = GetSSE2ColorKernels();
+			break;
+		case SimdLevel::NEON:
+			kernels = GetNEONColorKernels();
+			break;
+		case SimdLevel::Scalar:
+			break;
+		}
+		return kernels ? kernels : GetScalarColorKernels();
+	}
+
+	int ChromaSize(int size)
+	{
+		return (size + 1) / 2;
+	}
+}
+
+const ColorKernels* GetScalarColorKernels()
+{
+	static const ColorKernels kernels = {
+		SimdLevel::Scalar, 1, ScalarRowToPlane, ScalarRowPairToChroma, ScalarRowPairToChromaInterleaved
+	};
+	return &kernels;
+}
+
+#ifndef VIDEO_ARCH_X86
+const ColorKernels* GetSSE2ColorKernels() { return nullptr; }
+const ColorKernels* GetAVX2ColorKernels() { return nullptr; }
+const ColorKernels* GetAVX512ColorKernels() { return nullptr; }
+#endif
+#ifndef VIDEO_ARCH_ARM64
+const ColorKernels* GetNEONColorKernels() { return nullptr; }
+#endif
+
+ColorConverter::ColorConverter(ColorMatrix matrix, ColorRange range)
+	: m_matrix(matrix)
+	, m_range(range)
+	, m_coefficients(ComputeCoefficients(matrix, range))
+	, m_kernels(SelectKernels())
+{
+}
+
+bool ColorConverter::Convert(const uint8_t* bgra, int stride, int width, int height, YuvFormat format, const YuvPlanes& planes) const
+{
+	return ConvertRows(bgra, stride, width, height, 0, height, format, planes);
+}
+
+bool ColorConverter::Convert(const FrameData& frame, YuvFormat format, const YuvPlanes& planes) const
+{
+	const int stride = frame.stride > 0 ? frame.stride : frame.width * 4;
+	return Convert(static_cast<const uint8_t*>(frame.data), stride, frame.width, frame.height, format, planes);
+}
+
+bool ColorConverter::ConvertRows(const uint8_t* bgra, int stride, int width, int height, int firstRow, int lastRow,
+								 YuvFormat format, const YuvPlanes& planes) const
+{
+	const bool subsampled = format != YuvFormat::I444;
+	const int chromaWidth = subsampled ? ChromaSize(width) : width;
+
+	if (!bgra || width <= 0 || height <= 0 || stride < width * 4)
+		return false;
+	if (firstRow < 0 || lastRow > height || firstRow >= lastRow)
+		return false;
+	if (subsampled && (firstRow % 2 != 0 || (lastRow % 2 != 0 && lastRow != height)))
+		return false;
+	if (!planes.y || planes.yStride < width || !planes.u)
+		return false;
+	if (format == YuvFormat::NV12 ? planes.uStride < chromaWidth * 2
+								  : (!planes.v || planes.uStride < chromaWidth || planes.vStride < chromaWidth))
+		return false;
+
+	// Rows are split into a SIMD body and a scalar tail of fewer than
+	// pixelsPerIteration pixels, so no kernel ever reads past the row end
+	const ColorKernels& simd = *m_kernels;
+	const ColorKernels& scalar = *GetScalarColorKernels();
+	const int body = width - width % simd.pixelsPerIteration;
+	const int tail = width - body;
+
+	auto toPlane = [&](const uint8_t* row, uint8_t* dst, const PlaneCoefficients& coefficients) {
+		if (body > 0)
+			simd.rowToPlane(row, dst, body, coefficients);
+		if (tail > 0)
+			scalar.rowToPlane(row + body * 4, dst + body, tail, coefficients);
+	};
+
+	for (int y = firstRow; y < lastRow; ++y)
+	{
+		const uint8_t* row = bgra + static_cast<size_t>(y) * stride;
+		toPlane(row, planes.y + static_cast<size_t>(y) * planes.yStride, m_coefficients.y);
+
+		if (!subsampled)
+		{
+			toPlane(row, planes.u + static_cast<size_t>(y) * planes.uStride, m_coefficients.u);
+			toPlane(row, planes.v + static_cast<size_t>(y) * planes.vStride, m_coefficients.v);
+			continue;
+		}
+		if (y % 2 != 0)
+			continue;
+
+		// An odd last row pairs with itself
+		const uint8_t* nextRow = y + 1 < height ? row + stride : row;
+		const int chromaRow = y / 2;
+		if (format == YuvFormat::NV12)
+		{
+			uint8_t* uv = planes.u + static_cast<size_t>(chromaRow) * planes.uStride;
+			if (body > 0)
+				simd.rowPairToChromaInterleaved(row, nextRow, uv, body, m_coefficients);
+			if (tail > 0)
+				scalar.rowPairToChromaInterleaved(row + body * 4, nextRow + body * 4, uv + body, tail, m_coefficients);
+		}
+		else
+		{
+			uint8_t* u = planes.u + static_cast<size_t>(chromaRow) * planes.uStride;
+			uint8_t* v = planes.v + static_cast<size_t>(chromaRow) * planes.vStride;
+			if (body > 0)
+				simd.rowPairToChroma(row, nextRow, u, v, body, m_coefficients);
+			if (tail > 0)
+				scalar.rowPairToChroma(row + body * 4, nextRow + body * 4, u + body / 2, v + body / 2, tail, m_coefficients);
+		}
+	}
+	return true;
+}
+
+size_t ColorConverter::GetBufferSize(YuvFormat format, int width, int height)
+{
+	const size_t lumaSize = static_cast<size_t>(width) * height;
+	if (format == YuvFormat::I444)
+		return lumaSize * 3;
+	return lumaSize + static_cast<size_t>(ChromaSize(width)) * ChromaSize(height) * 2;
+}
+
+YuvPlanes ColorConverter::GetPlanes(YuvFormat format, uint8_t* buffer, int width, int height)
+{
+	YuvPlanes planes;
+	planes.y = buffer;
+	planes.yStride = width;
+
+	const size_t lumaSize = static_cast<size_t>(width) * height;
+	switch (format)
+	{
+	case YuvFormat::I420:
+		planes.u = buffer + lumaSize;
+		planes.uStride = ChromaSize(width);
+		planes.v = planes.u + static_cast<size_t>(planes.uStride) * ChromaSize(height);
+		planes.vStride = planes.uStride;
+		break;
+	case YuvFormat::NV12:
+		planes.u = buffer + lumaSize;
+		planes.uStride = ChromaSize(width) * 2;
+		break;
+	case YuvFormat::I444:
+		planes.u = buffer + lumaSize;
+		planes.uStride = width;
+		planes.v = planes.u + lumaSize;
+		planes.vStride = width;
+		break;
+	}
+	return planes;
+}
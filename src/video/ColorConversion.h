@@ -0,0 +1,79 @@
+#pragma once
+
+#include "CpuFeatures.h"
+#include "ColorKernels.h"
+#include "ImageView.h"
+
+#include <cstddef>
+#include <cstdint>
+
+struct FrameData;
+
+enum class ColorMatrix
+{
+	BT601, // SD content, and what most software decoders assume without signalling
+	BT709  // HD content
+};
+
+enum class ColorRange
+{
+	Limited, // Y 16-235, chroma 16-240 ("TV" range)
+	Full	 // 0-255 ("PC" range)
+};
+
+// Destination planes. For NV12 `u` is the interleaved UV plane and `v` is
+// unused. Chroma planes of the 4:2:0 formats are ceil(width/2) x ceil(height/2).
+struct YuvPlanes
+{
+	uint8_t* y = nullptr;
+	int yStride = 0;
+	uint8_t* u = nullptr;
+	int uStride = 0;
+	uint8_t* v = nullptr;
+	int vStride = 0;
+};
+
+// Converts B8G8R8A8 frames (as delivered in FrameData) to YUV. Each row is
+// handled by the widest kernel the CPU supports, selected once at runtime;
+// all kernels use the same fixed-point arithmetic and produce bit-identical
+// output. Conversion is stateless apart from the coefficients, so one
+// converter can be shared by threads working on different row ranges.
+class ColorConverter
+{
+public:
+	explicit ColorConverter(ColorMatrix matrix = ColorMatrix::BT709, ColorRange range = ColorRange::Limited);
+
+	// `stride` is in bytes and may be larger than width * 4. Alpha is ignored.
+	bool Convert(const uint8_t* bgra, int stride, int width, int height, YuvFormat format, const YuvPlanes& planes) const;
+	bool Convert(const FrameData& frame, YuvFormat format, const YuvPlanes& planes) const;
+
+	// Same, with the destination format carried by the view type
+	template <YuvFormat Format>
+	bool Convert(BgraView source, const MutablePlanarImageView<Format>& destination) const
+	{
+		if (destination.Width() != source.width || destination.Height() != source.height)
+			return false;
+		const YuvPlanes planes = { destination.y.data, destination.y.stride, destination.u.data,
+								   destination.u.stride, destination.v.data, destination.v.stride };
+		return Convert(source.data, source.stride, source.width, source.height, Format, planes);
+	}
+
+	// Converts rows [firstRow, lastRow) only, for splitting a frame across
+	// threads. For 4:2:0 formats both bounds must be even (or lastRow == height).
+	bool ConvertRows(const uint8_t* bgra, int stride, int width, int height, int firstRow, int lastRow,
+					 YuvFormat format, const YuvPlanes& planes) const;
+
+	ColorMatrix GetMatrix() const { return m_matrix; }
+	ColorRange GetRange() const { return m_range; }
+	SimdLevel GetSimdLevel() const { return m_kernels->level; }
+
+	// Tightly packed layout of one image of `format` in a single allocation
+	static size_t GetBufferSize(YuvFormat format, int width, int height);
+	static YuvPlanes GetPlanes(YuvFormat format, uint8_t* buffer, int width, int height);
+
+private:
+	ColorMatrix m_matrix;
+	ColorRange m_range;
+	ColorCoefficients m_coefficients;
+	const ColorKernels* m_kernels;
+};
@@ -0,0 +1,45 @@
+#pragma once
+
+#include "CpuFeatures.h"
+
+#include <cstdint>
+
+// Fixed-point coefficients for one output plane. A sample is
+//   (b*B + g*G + r*R + k*256) >> 14              from one pixel
+//   (b*B4 + g*G4 + r*R4 + k*1024) >> 16          from 2x2 channel sums (4:2:0)
+// clamped to 0-255. `k` folds the plane offset (16 or 128) and the rounding
+// term into one int16, which lets the x86 kernels evaluate everything with
+// two multiply-add instructions by pairing it with a constant channel.
+struct PlaneCoefficients
+{
+	int16_t b, g, r, k;
+};
+
+struct ColorCoefficients
+{
+	PlaneCoefficients y, u, v;
+};
+
+// Row kernels for one instruction set. SIMD kernels only process widths that
+// are a multiple of `pixelsPerIteration`; the caller finishes each row with
+// the scalar kernels.
+struct ColorKernels
+{
+	SimdLevel level;
+	int pixelsPerIteration;
+
+	// One full-resolution plane (Y, or U/V for 4:4:4)
+	void (*rowToPlane)(const uint8_t* bgra, uint8_t* dst, int width, const PlaneCoefficients& coefficients);
+	// Subsampled chroma from two source rows; `width` is in source pixels
+	void (*rowPairToChroma)(const uint8_t* row0, const uint8_t* row1, uint8_t* u, uint8_t* v, int width,
+							const ColorCoefficients& coefficients);
+	void (*rowPairToChromaInterleaved)(const uint8_t* row0, const uint8_t* row1, uint8_t* uv, int width,
+									   const ColorCoefficients& coefficients);
+};
+
+// Kernel tables; those for instruction sets not built for this architecture are null
+const ColorKernels* GetScalarColorKernels();
+const ColorKernels* GetSSE2ColorKernels();
+const ColorKernels* GetAVX2ColorKernels();
+const ColorKernels* GetAVX512ColorKernels();
+const ColorKernels* GetNEONColorKernels();
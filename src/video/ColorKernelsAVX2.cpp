@@ -0,0 +1,138 @@
+#include "ColorKernels.h"
+
+#include <immintrin.h>
+
+// AVX2 kernels, 32 pixels per iteration. Same arithmetic as the SSE2 kernels;
+// the packs/packus instructions work within 128-bit lanes, so every pack is
+// followed by a 64-bit permute that restores pixel order.
+
+namespace
+{
+	struct Channels
+	{
+		__m256i b, g, r; // 16 x int16
+	};
+
+	inline __m256i FixLaneOrder(__m256i packed)
+	{
+		return _mm256_permute4x64_epi64(packed, _MM_SHUFFLE(3, 1, 2, 0));
+	}
+
+	inline Channels Load16(const uint8_t* bgra)
+	{
+		const __m256i mask = _mm256_set1_epi32(0xFF);
+		const __m256i p0 = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(bgra));
+		const __m256i p1 = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(bgra + 32));
+
+		auto channel = [&](int shift) {
+			const __m256i c0 = _mm256_and_si256(_mm256_srli_epi32(p0, shift), mask);
+			const __m256i c1 = _mm256_and_si256(_mm256_srli_epi32(p1, shift), mask);
+			return FixLaneOrder(_mm256_packs_epi32(c0, c1));
+		};
+
+		Channels c;
+		c.b = channel(0);
+		c.g = channel(8);
+		c.r = channel(16);
+		return c;
+	}
+
+	inline __m256i PairCoefficients(int16_t first, int16_t second)
+	{
+		return _mm256_set1_epi32(static_cast<int32_t>((static_cast<uint32_t>(static_cast<uint16_t>(second)) << 16) | static_cast<uint16_t>(first)));
+	}
+
+	struct PlaneVectors
+	{
+		__m256i bg, rk;
+
+		explicit PlaneVectors(const PlaneCoefficients& c)
+			: bg(PairCoefficients(c.b, c.g))
+			, rk(PairCoefficients(c.r, c.k))
+		{
+		}
+	};
+
+	// unpack and packs mirror each other within lanes, so order is preserved
+	template <int Shift>
+	inline __m256i Apply(const Channels& c, const PlaneVectors& v, __m256i constant)
+	{
+		const __m256i lo = _mm256_add_epi32(_mm256_madd_epi16(_mm256_unpacklo_epi16(c.b, c.g), v.bg),
+											_mm256_madd_epi16(_mm256_unpacklo_epi16(c.r, constant), v.rk));
+		const __m256i hi = _mm256_add_epi32(_mm256_madd_epi16(_mm256_unpackhi_epi16(c.b, c.g), v.bg),
+											_mm256_madd_epi16(_mm256_unpackhi_epi16(c.r, constant), v.rk));
+		return _mm256_packs_epi32(_mm256_srai_epi32(lo, Shift), _mm256_srai_epi32(hi, Shift));
+	}
+
+	inline __m256i PairSums(__m256i row0, __m256i row1)
+	{
+		return _mm256_madd_epi16(_mm256_add_epi16(row0, row1), _mm256_set1_epi16(1));
+	}
+
+	// 2x2 channel sums for 32 source columns -> 16 x int16 per channel
+	inline Channels LoadBlockSums(const uint8_t* row0, const uint8_t* row1)
+	{
+		const Channels a0 = Load16(row0), b0 = Load16(row1);
+		const Channels a1 = Load16(row0 + 64), b1 = Load16(row1 + 64);
+
+		Channels sums;
+		sums.b = FixLaneOrder(_mm256_packs_epi32(PairSums(a0.b, b0.b), PairSums(a1.b, b1.b)));
+		sums.g = FixLaneOrder(_mm256_packs_epi32(PairSums(a0.g, b0.g), PairSums(a1.g, b1.g)));
+		sums.r = FixLaneOrder(_mm256_packs_epi32(PairSums(a0.r, b0.r), PairSums(a1.r, b1.r)));
+		return sums;
+	}
+
+	// 16 U and 16 V samples: U in the low half, V in the high half
+	inline __m256i ChromaSamples(const uint8_t* row0, const uint8_t* row1, const PlaneVectors& u, const PlaneVectors& v)
+	{
+		const __m256i constant = _mm256_set1_epi16(1024);
+		const Channels sums = LoadBlockSums(row0, row1);
+		return FixLaneOrder(_mm256_packus_epi16(Apply<16>(sums, u, constant), Apply<16>(sums, v, constant)));
+	}
+
+	void RowToPlane(const uint8_t* bgra, uint8_t* dst, int width, const PlaneCoefficients& coefficients)
+	{
+		const PlaneVectors v(coefficients);
+		const __m256i constant = _mm256_set1_epi16(256);
+		for (int x = 0; x < width; x += 32)
+		{
+			const __m256i lo = Apply<14>(Load16(bgra + x * 4), v, constant);
+			const __m256i hi = Apply<14>(Load16(bgra + x * 4 + 64), v, constant);
+			_mm256_storeu_si256(reinterpret_cast<__m256i*>(dst + x), FixLaneOrder(_mm256_packus_epi16(lo, hi)));
+		}
+	}
+
+	void RowPairToChroma(const uint8_t* row0, const uint8_t* row1, uint8_t* u, uint8_t* v, int width,
+						 const ColorCoefficients& coefficients)
+	{
+		const PlaneVectors uvec(coefficients.u), vvec(coefficients.v);
+		for (int x = 0; x < width; x += 32)
+		{
+			const __m256i samples = ChromaSamples(row0 + x * 4, row1 + x * 4, uvec, vvec);
+			_mm_storeu_si128(reinterpret_cast<__m128i*>(u + x / 2), _mm256_castsi256_si128(samples));
+			_mm_storeu_si128(reinterpret_cast<__m128i*>(v + x / 2), _mm256_extracti128_si256(samples, 1));
+		}
+	}
+
+	void RowPairToChromaInterleaved(const uint8_t* row0, const uint8_t* row1, uint8_t* uv, int width,
+									const ColorCoefficients& coefficients)
+	{
+		const PlaneVectors uvec(coefficients.u), vvec(coefficients.v);
+		for (int x = 0; x < width; x += 32)
+		{
+			const __m256i samples = ChromaSamples(row0 + x * 4, row1 + x * 4, uvec, vvec);
+			// Widen U to the low and V to the high byte of each 16-bit UV pair
+			const __m256i u = _mm256_cvtepu8_epi16(_mm256_castsi256_si128(samples));
+			const __m256i v = _mm256_slli_epi16(_mm256_cvtepu8_epi16(_mm256_extracti128_si256(samples, 1)), 8);
+			_mm256_storeu_si256(reinterpret_cast<__m256i*>(uv + x), _mm256_or_si256(u, v));
+		}
+	}
+}
+
+const ColorKernels* GetAVX2ColorKernels()
+{
+	static const ColorKernels kernels = {
+		SimdLevel::AVX2, 32, RowToPlane, RowPairToChroma, RowPairToChromaInterleaved
+	};
+	return &kernels;
+}
@@ -0,0 +1,136 @@
+#include "ColorKernels.h"
+
+#include <immintrin.h>
+
+// AVX-512 (F + BW) kernels, 64 pixels per iteration. Packs work within each
+// of the four 128-bit lanes, so every pack is followed by a 64-bit permute
+// that restores pixel order.
+
+namespace
+{
+	struct Channels
+	{
+		__m512i b, g, r; // 32 x int16
+	};
+
+	inline __m512i FixLaneOrder(__m512i packed)
+	{
+		return _mm512_permutexvar_epi64(_mm512_setr_epi64(0, 2, 4, 6, 1, 3, 5, 7), packed);
+	}
+
+	inline Channels Load32(const uint8_t* bgra)
+	{
+		const __m512i mask = _mm512_set1_epi32(0xFF);
+		const __m512i p0 = _mm512_loadu_si512(bgra);
+		const __m512i p1 = _mm512_loadu_si512(bgra + 64);
+
+		auto channel = [&](unsigned shift) {
+			const __m512i c0 = _mm512_and_si512(_mm512_srli_epi32(p0, shift), mask);
+			const __m512i c1 = _mm512_and_si512(_mm512_srli_epi32(p1, shift), mask);
+			return FixLaneOrder(_mm512_packs_epi32(c0, c1));
+		};
+
+		Channels c;
+		c.b = channel(0);
+		c.g = channel(8);
+		c.r = channel(16);
+		return c;
+	}
+
+	inline __m512i PairCoefficients(int16_t first, int16_t second)
+	{
+		return _mm512_set1_epi32(static_cast<int32_t>((static_cast<uint32_t>(static_cast<uint16_t>(second)) << 16) | static_cast<uint16_t>(first)));
+	}
+
+	struct PlaneVectors
+	{
+		__m512i bg, rk;
+
+		explicit PlaneVectors(const PlaneCoefficients& c)
+			: bg(PairCoefficients(c.b, c.g))
+			, rk(PairCoefficients(c.r, c.k))
+		{
+		}
+	};
+
+	template <unsigned Shift>
+	inline __m512i Apply(const Channels& c, const PlaneVectors& v, __m512i constant)
+	{
+		const __m512i lo = _mm512_add_epi32(_mm512_madd_epi16(_mm512_unpacklo_epi16(c.b, c.g), v.bg),
+											_mm512_madd_epi16(_mm512_unpacklo_epi16(c.r, constant), v.rk));
+		const __m512i hi = _mm512_add_epi32(_mm512_madd_epi16(_mm512_unpackhi_epi16(c.b, c.g), v.bg),
+											_mm512_madd_epi16(_mm512_unpackhi_epi16(c.r, constant), v.rk));
+		return _mm512_packs_epi32(_mm512_srai_epi32(lo, Shift), _mm512_srai_epi32(hi, Shift));
+	}
+
+	inline __m512i PairSums(__m512i row0, __m512i row1)
+	{
+		return _mm512_madd_epi16(_mm512_add_epi16(row0, row1), _mm512_set1_epi16(1));
+	}
+
+	// 2x2 channel sums for 64 source columns -> 32 x int16 per channel
+	inline Channels LoadBlockSums(const uint8_t* row0, const uint8_t* row1)
+	{
+		const Channels a0 = Load32(row0), b0 = Load32(row1);
+		const Channels a1 = Load32(row0 + 128), b1 = Load32(row1 + 128);
+
+		Channels sums;
+		sums.b = FixLaneOrder(_mm512_packs_epi32(PairSums(a0.b, b0.b), PairSums(a1.b, b1.b)));
+		sums.g = FixLaneOrder(_mm512_packs_epi32(PairSums(a0.g, b0.g), PairSums(a1.g, b1.g)));
+		sums.r = FixLaneOrder(_mm512_packs_epi32(PairSums(a0.r, b0.r), PairSums(a1.r, b1.r)));
+		return sums;
+	}
+
+	// 32 U and 32 V samples: U in the low half, V in the high half
+	inline __m512i ChromaSamples(const uint8_t* row0, const uint8_t* row1, const PlaneVectors& u, const PlaneVectors& v)
+	{
+		const __m512i constant = _mm512_set1_epi16(1024);
+		const Channels sums = LoadBlockSums(row0, row1);
+		return FixLaneOrder(_mm512_packus_epi16(Apply<16>(sums, u, constant), Apply<16>(sums, v, constant)));
+	}
+
+	void RowToPlane(const uint8_t* bgra, uint8_t* dst, int width, const PlaneCoefficients& coefficients)
+	{
+		const PlaneVectors v(coefficients);
+		const __m512i constant = _mm512_set1_epi16(256);
+		for (int x = 0; x < width; x += 64)
+		{
+			const __m512i lo = Apply<14>(Load32(bgra + x * 4), v, constant);
+			const __m512i hi = Apply<14>(Load32(bgra + x * 4 + 128), v, constant);
+			_mm512_storeu_si512(dst + x, FixLaneOrder(_mm512_packus_epi16(lo, hi)));
+		}
+	}
+
+	void RowPairToChroma(const uint8_t* row0, const uint8_t* row1, uint8_t* u, uint8_t* v, int width,
+						 const ColorCoefficients& coefficients)
+	{
+		const PlaneVectors uvec(coefficients.u), vvec(coefficients.v);
+		for (int x = 0; x < width; x += 64)
+		{
+			const __m512i samples = ChromaSamples(row0 + x * 4, row1 + x * 4, uvec, vvec);
+			_mm256_storeu_si256(reinterpret_cast<__m256i*>(u + x / 2), _mm512_castsi512_si256(samples));
+			_mm256_storeu_si256(reinterpret_cast<__m256i*>(v + x / 2), _mm512_extracti64x4_epi64(samples, 1));
+		}
+	}
+
+	void RowPairToChromaInterleaved(const uint8_t* row0, const uint8_t* row1, uint8_t* uv, int width,
+									const ColorCoefficients& coefficients)
+	{
+		const PlaneVectors uvec(coefficients.u), vvec(coefficients.v);
+		for (int x = 0; x < width; x += 64)
+		{
+			const __m512i samples = ChromaSamples(row0 + x * 4, row1 + x * 4, uvec, vvec);
+			const __m512i u = _mm512_cvtepu8_epi16(_mm512_castsi512_si256(samples));
+			const __m512i v = _mm512_slli_epi16(_mm512_cvtepu8_epi16(_mm512_extracti64x4_epi64(samples, 1)), 8);
+			_mm512_storeu_si512(uv + x, _mm512_or_si512(u, v));
+		}
+	}
+}
+
+const ColorKernels* GetAVX512ColorKernels()
+{
+	static const ColorKernels kernels = {
+		SimdLevel::AVX512, 64, RowToPlane, RowPairToChroma, RowPairToChromaInterleaved
+	};
+	return &kernels;
+}
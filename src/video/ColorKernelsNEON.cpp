@@ -0,0 +1,101 @@
+#include "ColorKernels.h"
+
+#include <arm_neon.h>
+
+// NEON kernels, 16 pixels per iteration. vld4 de-interleaves BGRA for free;
+// samples are accumulated in 32 bits from the same fixed-point coefficients
+// as the other kernels, with the offset term added as a constant bias.
+
+namespace
+{
+	// 4 samples from int16 channels; Bias is k * 256 (pixels) or k * 1024 (sums)
+	template <int Shift>
+	inline int16x4_t Apply4(int16x4_t b, int16x4_t g, int16x4_t r, const PlaneCoefficients& c, int32x4_t bias)
+	{
+		int32x4_t sum = vmlal_n_s16(bias, b, c.b);
+		sum = vmlal_n_s16(sum, g, c.g);
+		sum = vmlal_n_s16(sum, r, c.r);
+		return vshrn_n_s32(sum, Shift);
+	}
+
+	template <int Shift>
+	inline uint8x8_t Apply8(int16x8_t b, int16x8_t g, int16x8_t r, const PlaneCoefficients& c, int32x4_t bias)
+	{
+		const int16x4_t lo = Apply4<Shift>(vget_low_s16(b), vget_low_s16(g), vget_low_s16(r), c, bias);
+		const int16x4_t hi = Apply4<Shift>(vget_high_s16(b), vget_high_s16(g), vget_high_s16(r), c, bias);
+		return vqmovun_s16(vcombine_s16(lo, hi));
+	}
+
+	inline int16x8_t Widen(uint8x8_t value)
+	{
+		return vreinterpretq_s16_u16(vmovl_u8(value));
+	}
+
+	void RowToPlane(const uint8_t* bgra, uint8_t* dst, int width, const PlaneCoefficients& coefficients)
+	{
+		const int32x4_t bias = vdupq_n_s32(coefficients.k * 256);
+		for (int x = 0; x < width; x += 16)
+		{
+			const uint8x16x4_t pixels = vld4q_u8(bgra + x * 4);
+			const uint8x8_t lo = Apply8<14>(Widen(vget_low_u8(pixels.val[0])), Widen(vget_low_u8(pixels.val[1])),
+											Widen(vget_low_u8(pixels.val[2])), coefficients, bias);
+			const uint8x8_t hi = Apply8<14>(Widen(vget_high_u8(pixels.val[0])), Widen(vget_high_u8(pixels.val[1])),
+											Widen(vget_high_u8(pixels.val[2])), coefficients, bias);
+			vst1q_u8(dst + x, vcombine_u8(lo, hi));
+		}
+	}
+
+	// 2x2 channel sums for 16 source columns: 8 x int16 per channel
+	struct BlockSums
+	{
+		int16x8_t b, g, r;
+	};
+
+	inline BlockSums LoadBlockSums(const uint8_t* row0, const uint8_t* row1)
+	{
+		const uint8x16x4_t a = vld4q_u8(row0);
+		const uint8x16x4_t b = vld4q_u8(row1);
+
+		BlockSums sums;
+		sums.b = vreinterpretq_s16_u16(vpadalq_u8(vpaddlq_u8(a.val[0]), b.val[0]));
+		sums.g = vreinterpretq_s16_u16(vpadalq_u8(vpaddlq_u8(a.val[1]), b.val[1]));
+		sums.r = vreinterpretq_s16_u16(vpadalq_u8(vpaddlq_u8(a.val[2]), b.val[2]));
+		return sums;
+	}
+
+	void RowPairToChroma(const uint8_t* row0, const uint8_t* row1, uint8_t* u, uint8_t* v, int width,
+						 const ColorCoefficients& coefficients)
+	{
+		const int32x4_t uBias = vdupq_n_s32(coefficients.u.k * 1024);
+		const int32x4_t vBias = vdupq_n_s32(coefficients.v.k * 1024);
+		for (int x = 0; x < width; x += 16)
+		{
+			const BlockSums sums = LoadBlockSums(row0 + x * 4, row1 + x * 4);
+			vst1_u8(u + x / 2, Apply8<16>(sums.b, sums.g, sums.r, coefficients.u, uBias));
+			vst1_u8(v + x / 2, Apply8<16>(sums.b, sums.g, sums.r, coefficients.v, vBias));
+		}
+	}
+
+	void RowPairToChromaInterleaved(const uint8_t* row0, const uint8_t* row1, uint8_t* uv, int width,
+									const ColorCoefficients& coefficients)
+	{
+		const int32x4_t uBias = vdupq_n_s32(coefficients.u.k * 1024);
+		const int32x4_t vBias = vdupq_n_s32(coefficients.v.k * 1024);
+		for (int x = 0; x < width; x += 16)
+		{
+			const BlockSums sums = LoadBlockSums(row0 + x * 4, row1 + x * 4);
+			uint8x8x2_t samples;
+			samples.val[0] = Apply8<16>(sums.b, sums.g, sums.r, coefficients.u, uBias);
+			samples.val[1] = Apply8<16>(sums.b, sums.g, sums.r, coefficients.v, vBias);
+			vst2_u8(uv + x, samples);
+		}
+	}
+}
+
+const ColorKernels* GetNEONColorKernels()
+{
+	static const ColorKernels kernels = {
+		SimdLevel::NEON, 16, RowToPlane, RowPairToChroma, RowPairToChromaInterleaved
+	};
+	return &kernels;
+}
@@ -0,0 +1,123 @@
+#include "ColorKernels.h"
+
+#include <emmintrin.h>
+
+// SSE2 kernels, 16 pixels per iteration. Channels are split into 16-bit lanes
+// with shifts and masks; each output sample is then two pmaddwd: (B,G) x
+// (b,g) and (R,K) x (r,k), where K is a constant lane carrying the offset.
+
+namespace
+{
+	struct Channels
+	{
+		__m128i b, g, r; // 8 x int16
+	};
+
+	// 8 BGRA pixels -> three vectors of 8 x int16
+	inline Channels Load8(const uint8_t* bgra)
+	{
+		const __m128i mask = _mm_set1_epi32(0xFF);
+		const __m128i p0 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(bgra));
+		const __m128i p1 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(bgra + 16));
+
+		Channels c;
+		c.b = _mm_packs_epi32(_mm_and_si128(p0, mask), _mm_and_si128(p1, mask));
+		c.g = _mm_packs_epi32(_mm_and_si128(_mm_srli_epi32(p0, 8), mask), _mm_and_si128(_mm_srli_epi32(p1, 8), mask));
+		c.r = _mm_packs_epi32(_mm_and_si128(_mm_srli_epi32(p0, 16), mask), _mm_and_si128(_mm_srli_epi32(p1, 16), mask));
+		return c;
+	}
+
+	inline __m128i PairCoefficients(int16_t first, int16_t second)
+	{
+		return _mm_set1_epi32(static_cast<int32_t>((static_cast<uint32_t>(static_cast<uint16_t>(second)) << 16) | static_cast<uint16_t>(first)));
+	}
+
+	struct PlaneVectors
+	{
+		__m128i bg, rk;
+
+		explicit PlaneVectors(const PlaneCoefficients& c)
+			: bg(PairCoefficients(c.b, c.g))
+			, rk(PairCoefficients(c.r, c.k))
+		{
+		}
+	};
+
+	// 8 samples as int16; `constant` is 256 for single pixels and 1024 for 2x2 sums
+	template <int Shift>
+	inline __m128i Apply(const Channels& c, const PlaneVectors& v, __m128i constant)
+	{
+		const __m128i lo = _mm_add_epi32(_mm_madd_epi16(_mm_unpacklo_epi16(c.b, c.g), v.bg),
+										 _mm_madd_epi16(_mm_unpacklo_epi16(c.r, constant), v.rk));
+		const __m128i hi = _mm_add_epi32(_mm_madd_epi16(_mm_unpackhi_epi16(c.b, c.g), v.bg),
+										 _mm_madd_epi16(_mm_unpackhi_epi16(c.r, constant), v.rk));
+		return _mm_packs_epi32(_mm_srai_epi32(lo, Shift), _mm_srai_epi32(hi, Shift));
+	}
+
+	// Sums of horizontally adjacent pairs of 2x8 pixels: 4 x int32 per channel
+	inline __m128i PairSums(__m128i row0, __m128i row1)
+	{
+		return _mm_madd_epi16(_mm_add_epi16(row0, row1), _mm_set1_epi16(1));
+	}
+
+	// 2x2 channel sums for 16 source columns -> 8 x int16 per channel
+	inline Channels LoadBlockSums(const uint8_t* row0, const uint8_t* row1)
+	{
+		const Channels a0 = Load8(row0), b0 = Load8(row1);
+		const Channels a1 = Load8(row0 + 32), b1 = Load8(row1 + 32);
+
+		Channels sums;
+		sums.b = _mm_packs_epi32(PairSums(a0.b, b0.b), PairSums(a1.b, b1.b));
+		sums.g = _mm_packs_epi32(PairSums(a0.g, b0.g), PairSums(a1.g, b1.g));
+		sums.r = _mm_packs_epi32(PairSums(a0.r, b0.r), PairSums(a1.r, b1.r));
+		return sums;
+	}
+
+	void RowToPlane(const uint8_t* bgra, uint8_t* dst, int width, const PlaneCoefficients& coefficients)
+	{
+		const PlaneVectors v(coefficients);
+		const __m128i constant = _mm_set1_epi16(256);
+		for (int x = 0; x < width; x += 16)
+		{
+			const __m128i lo = Apply<14>(Load8(bgra + x * 4), v, constant);
+			const __m128i hi = Apply<14>(Load8(bgra + x * 4 + 32), v, constant);
+			_mm_storeu_si128(reinterpret_cast<__m128i*>(dst + x), _mm_packus_epi16(lo, hi));
+		}
+	}
+
+	void RowPairToChroma(const uint8_t* row0, const uint8_t* row1, uint8_t* u, uint8_t* v, int width,
+						 const ColorCoefficients& coefficients)
+	{
+		const PlaneVectors uv(coefficients.u), vv(coefficients.v);
+		const __m128i constant = _mm_set1_epi16(1024);
+		for (int x = 0; x < width; x += 16)
+		{
+			const Channels sums = LoadBlockSums(row0 + x * 4, row1 + x * 4);
+			const __m128i packed = _mm_packus_epi16(Apply<16>(sums, uv, constant), Apply<16>(sums, vv, constant));
+			_mm_storel_epi64(reinterpret_cast<__m128i*>(u + x / 2), packed);
+			_mm_storel_epi64(reinterpret_cast<__m128i*>(v + x / 2), _mm_srli_si128(packed, 8));
+		}
+	}
+
+	void RowPairToChromaInterleaved(const uint8_t* row0, const uint8_t* row1, uint8_t* uv, int width,
+									const ColorCoefficients& coefficients)
+	{
+		const PlaneVectors uvec(coefficients.u), vvec(coefficients.v);
+		const __m128i constant = _mm_set1_epi16(1024);
+		for (int x = 0; x < width; x += 16)
+		{
+			const Channels sums = LoadBlockSums(row0 + x * 4, row1 + x * 4);
+			const __m128i u = _mm_packus_epi16(Apply<16>(sums, uvec, constant), _mm_setzero_si128());
+			const __m128i v = _mm_packus_epi16(Apply<16>(sums, vvec, constant), _mm_setzero_si128());
+			_mm_storeu_si128(reinterpret_cast<__m128i*>(uv + x), _mm_unpacklo_epi8(u, v));
+		}
+	}
+}
+
+const ColorKernels* GetSSE2ColorKernels()
+{
+	static const ColorKernels kernels = {
+		SimdLevel::SSE2, 16, RowToPlane, RowPairToChroma, RowPairToChromaInterleaved
+	};
+	return &kernels;
+}
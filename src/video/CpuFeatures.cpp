@@ -0,0 +1,133 @@
+#include "CpuFeatures.h"
+
+#include <cstdint>
+#include <cstdlib>
+#include <string>
+
+#ifdef VIDEO_ARCH_X86
+#if defined(_MSC_VER)
+#include <intrin.h>
+#else
+#include <cpuid.h>
+#endif
+#endif
+
+namespace
+{
+#ifdef VIDEO_ARCH_X86
+	struct CpuidResult
+	{
+		uint32_t eax, ebx, ecx, edx;
+	};
+
+	CpuidResult Cpuid(uint32_t leaf, uint32_t subleaf)
+	{
+		CpuidResult result = {};
+#if defined(_MSC_VER)
+		int registers[4];
+		__cpuidex(registers, static_cast<int>(leaf), static_cast<int>(subleaf));
+		result = { static_cast<uint32_t>(registers[0]), static_cast<uint32_t>(registers[1]),
+				   static_cast<uint32_t>(registers[2]), static_cast<uint32_t>(registers[3]) };
+#else
+		__cpuid_count(leaf, subleaf, result.eax, result.ebx, result.ecx, result.edx);
+#endif
+		return result;
+	}
+
+	// Register state the OS saves on context switch (XCR0)
+	uint64_t GetEnabledXState()
+	{
+#if defined(_MSC_VER)
+		return _xgetbv(0);
+#else
+		uint32_t eax, edx;
+		__asm__ volatile("xgetbv" : "=a"(eax), "=d"(edx) : "c"(0));
+		return (static_cast<uint64_t>(edx) << 32) | eax;
+#endif
+	}
+
+	SimdLevel DetectSimdLevel()
+	{
+		const uint32_t maxLeaf = Cpuid(0, 0).eax;
+		const CpuidResult leaf1 = Cpuid(1, 0);
+		if (!(leaf1.edx & (1u << 26)))
+			return SimdLevel::Scalar;
+
+		// AVX state is only usable if the OS enabled it through XSAVE
+		const bool osxsave = leaf1.ecx & (1u << 27);
+		if (maxLeaf < 7 || !osxsave)
+			return SimdLevel::SSE2;
+
+		const uint64_t xstate = GetEnabledXState();
+		const bool ymmEnabled = (xstate & 0x6) == 0x6;
+		const bool zmmEnabled = (xstate & 0xE6) == 0xE6;
+
+		const CpuidResult leaf7 = Cpuid(7, 0);
+		const bool avx2 = leaf7.ebx & (1u << 5);
+		const bool avx512f = leaf7.ebx & (1u << 16);
+		const bool avx512bw = leaf7.ebx & (1u << 30);
+
+		if (zmmEnabled && avx512f && avx512bw)
+			return SimdLevel::AVX512;
+		if (ymmEnabled && avx2)
+			return SimdLevel::AVX2;
+		return SimdLevel::SSE2;
+	}
+#elif defined(VIDEO_ARCH_ARM64)
+	// Advanced SIMD is mandatory on AArch64
+	SimdLevel DetectSimdLevel() { return SimdLevel::NEON; }
+#else
+	SimdLevel DetectSimdLevel() { return SimdLevel::Scalar; }
+#endif
+
+	SimdLevel ApplyOverride(SimdLevel detected)
+	{
+		const char* value = std::getenv("VIDEO_SIMD");
+		if (!value)
+			return detected;
+
+		const std::string name = value;
+		for (SimdLevel level : { SimdLevel::Scalar, SimdLevel::SSE2, SimdLevel::AVX2, SimdLevel::AVX512, SimdLevel::NEON })
+		{
+			if (name == CpuFeatures::GetName(level))
+			{
+				if (level == SimdLevel::Scalar)
+					return level;
+				// Only tiers of the same family, at or below what was detected
+				const bool sameFamily = (level == SimdLevel::NEON) == (detected == SimdLevel::NEON);
+				if (sameFamily && level <= detected)
+					return level;
+			}
+		}
+		return detected;
+	}
+}
+
+SimdLevel CpuFeatures::GetSimdLevel()
+{
+	static const SimdLevel level = ApplyOverride(DetectSimdLevel());
+	return level;
+}
+
+bool CpuFeatures::Supports(SimdLevel level)
+{
+	const SimdLevel best = GetSimdLevel();
+	if (level == SimdLevel::Scalar)
+		return true;
+	if (level == SimdLevel::NEON || best == SimdLevel::NEON)
+		return level == best;
+	return level <= best;
+}
+
+std::string_view CpuFeatures::GetName(SimdLevel level) noexcept
+{
+	switch (level)
+	{
+	case SimdLevel::Scalar: return "scalar";
+	case SimdLevel::SSE2: return "sse2";
+	case SimdLevel::AVX2: return "avx2";
+	case SimdLevel::AVX512: return "avx512";
+	case SimdLevel::NEON: return "neon";
+	}
+	return "unknown";
+}
@@ -0,0 +1,34 @@
+#pragma once
+
+#include <string_view>
+
+// Architecture families with SIMD kernels. The build adds the matching
+// kernel sources (see video/CMakeLists.txt), so code outside the kernels
+// uses these to know which tables exist.
+#if defined(__x86_64__) || defined(_M_X64) || defined(__i386__) || defined(_M_IX86)
+#define VIDEO_ARCH_X86 1
+#elif defined(__aarch64__) || defined(_M_ARM64)
+#define VIDEO_ARCH_ARM64 1
+#endif
+
+// Instruction set tiers with hand-written kernels, in order of preference
+enum class SimdLevel
+{
+	Scalar,
+	SSE2,
+	AVX2,
+	AVX512, // AVX-512 F + BW
+	NEON
+};
+
+class CpuFeatures
+{
+public:
+	// Best level this CPU and OS support, detected once. VIDEO_SIMD=<name>
+	// (scalar, sse2, avx2, avx512, neon) caps it for benchmarking and for
+	// bisecting kernel bugs; it can lower the level but never raise it.
+	static SimdLevel GetSimdLevel();
+	static bool Supports(SimdLevel level);
+
+	static std::string_view GetName(SimdLevel level) noexcept;
+};
@@ -0,0 +1,653 @@
+#include "Deflate.h"
+
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <cstring>
+
+namespace
+{
+	constexpr int kWindowSize = 32768;
+	constexpr int kMinMatch = 4; // Hashed on 4 bytes; 3-byte matches rarely pay off
+	constexpr int kMaxMatch = 258;
+	constexpr int kHashBits = 15;
+	constexpr int kMaxChain = 8;		 // Candidates tried per position
+	constexpr int kMaxInsertLength = 32; // Longer matches skip hashing their interior
+	constexpr size_t kBlockTokens = 1 << 16;
+	constexpr int kMaxCodeBits = 15;
+	constexpr int kMaxCodeLengthBits = 7;
+	constexpr int kLitLenSymbols = 286;
+	constexpr int kDistanceSymbols = 30;
+	constexpr int kCodeLengthSymbols = 19;
+	constexpr int kEndOfBlock = 256;
+	constexpr uint32_t kAdlerBase = 65521;
+
+	constexpr uint16_t kLengthBase[29] = { 3, 4, 5, 6, 7, 8, 9, 10, 11, 13, 15, 17, 19, 23, 27,
+										   31, 35, 43, 51, 59, 67, 83, 99, 115, 131, 163, 195, 227, 258 };
+	constexpr uint8_t kLengthExtra[29] = { 0, 0, 0, 0, 0, 0, 0, 0, 1, 1, 1, 1, 2, 2, 2, 2, 3, 3, 3, 3, 4, 4, 4, 4, 5, 5, 5, 5, 0 };
+	constexpr uint16_t kDistanceBase[30] = { 1, 2, 3, 4, 5, 7, 9, 13, 17, 25, 33, 49, 65, 97, 129,
+											 193, 257, 385, 513, 769, 1025, 1537, 2049, 3073, 4097, 6145, 8193, 12289, 16385, 24577 };
+	constexpr uint8_t kDistanceExtra[30] = { 0, 0, 0, 0, 1, 1, 2, 2, 3, 3, 4, 4, 5, 5, 6, 6, 7, 7, 8, 8, 9, 9, 10, 10, 11, 11, 12, 12, 13, 13 };
+	constexpr uint8_t kCodeLengthOrder[kCodeLengthSymbols] = { 16, 17, 18, 0, 8, 7, 9, 6, 10, 5, 11, 4, 12, 3, 13, 2, 14, 1, 15 };
+
+	// Symbol index (0-28) for match lengths 3-258
+	constexpr auto kLengthCode = [] {
+		std::array<uint8_t, kMaxMatch + 1> table{};
+		for (int code = 0; code < 29; ++code)
+		{
+			const int count = code == 28 ? 1 : 1 << kLengthExtra[code];
+			for (int i = 0; i < count && kLengthBase[code] + i <= kMaxMatch; ++i)
+				table[kLengthBase[code] + i] = static_cast<uint8_t>(code);
+		}
+		return table;
+	}();
+
+	// Distance symbol for distance d: [d - 1] below 256, else [256 + ((d - 1) >> 7)]
+	constexpr auto kDistanceCode = [] {
+		std::array<uint8_t, 512> table{};
+		for (int code = 0; code < 30; ++code)
+		{
+			for (int d = kDistanceBase[code]; d < kDistanceBase[code] + (1 << kDistanceExtra[code]); ++d)
+			{
+				if (d <= 256)
+					table[d - 1] = static_cast<uint8_t>(code);
+				else
+					table[256 + ((d - 1) >> 7)] = static_cast<uint8_t>(code);
+			}
+		}
+		return table;
+	}();
+
+	int DistanceCode(int distance)
+	{
+		return distance <= 256 ? kDistanceCode[distance - 1] : kDistanceCode[256 + ((distance - 1) >> 7)];
+	}
+
+	constexpr auto kCrcTable = [] {
+		std::array<std::array<uint32_t, 256>, 4> tables{};
+		for (uint32_t i = 0; i < 256; ++i)
+		{
+			uint32_t crc = i;
+			for (int k = 0; k < 8; ++k)
+				crc = (crc >> 1) ^ (0xEDB88320u & (0u - (crc & 1)));
+			tables[0][i] = crc;
+		}
+		for (uint32_t i = 0; i < 256; ++i)
+		{
+			for (int t = 1; t < 4; ++t)
+				tables[t][i] = (tables[t - 1][i] >> 8) ^ tables[0][tables[t - 1][i] & 0xFF];
+		}
+		return tables;
+	}();
+
+	// Tokens pack a literal as its byte value, a match as distance << 9 | length
+	uint32_t MakeMatch(int length, int distance)
+	{
+		return static_cast<uint32_t>(distance) << 9 | static_cast<uint32_t>(length);
+	}
+
+	class BitWriter
+	{
+	public:
+		explicit BitWriter(std::vector<uint8_t>& out) : m_out(out) {}
+
+		void Put(uint32_t bits, int count)
+		{
+			m_bits |= static_cast<uint64_t>(bits) << m_count;
+			m_count += count;
+			if (m_count >= 32)
+			{
+				const uint32_t word = static_cast<uint32_t>(m_bits);
+				const uint8_t bytes[4] = { static_cast<uint8_t>(word), static_cast<uint8_t>(word >> 8),
+										   static_cast<uint8_t>(word >> 16), static_cast<uint8_t>(word >> 24) };
+				m_out.insert(m_out.end(), bytes, bytes + 4);
+				m_bits >>= 32;
+				m_count -= 32;
+			}
+		}
+
+		// Pads to a byte boundary and writes out everything pending
+		void Align()
+		{
+			while (m_count > 0)
+			{
+				m_out.push_back(static_cast<uint8_t>(m_bits));
+				m_bits >>= 8;
+				m_count = std::max(m_count - 8, 0);
+			}
+			m_bits = 0;
+		}
+
+		std::vector<uint8_t>& Bytes() { return m_out; }
+
+	private:
+		std::vector<uint8_t>& m_out;
+		uint64_t m_bits = 0;
+		int m_count = 0;
+	};
+
+	// Moffat-Katajainen in-place minimum-redundancy code lengths. `a` holds
+	// frequencies sorted ascending and receives the code lengths.
+	void MinimumRedundancy(uint32_t* a, int n)
+	{
+		if (n == 1)
+		{
+			a[0] = 1;
+			return;
+		}
+
+		a[0] += a[1];
+		int root = 0, leaf = 2, next;
+		for (next = 1; next < n - 1; ++next)
+		{
+			if (leaf >= n || a[root] < a[leaf])
+			{
+				a[next] = a[root];
+				a[root++] = next;
+			}
+			else
+			{
+				a[next] = a[leaf++];
+			}
+
+			if (leaf >= n || (root < next && a[root] < a[leaf]))
+			{
+				a[next] += a[root];
+				a[root++] = next;
+			}
+			else
+			{
+				a[next] += a[leaf++];
+			}
+		}
+
+		a[n - 2] = 0;
+		for (next = n - 3; next >= 0; --next)
+			a[next] = a[a[next]] + 1;
+
+		int available = 1, used = 0, depth = 0;
+		root = n - 2;
+		next = n - 1;
+		while (available > 0)
+		{
+			while (root >= 0 && static_cast<int>(a[root]) == depth)
+			{
+				++used;
+				--root;
+			}
+			while (available > used)
+			{
+				a[next--] = depth;
+				--available;
+			}
+			available = 2 * used;
+			++depth;
+			used = 0;
+		}
+	}
+
+	// Length-limited Huffman code lengths. At least two symbols always get a
+	// code, so every code is complete (some inflaters reject incomplete ones).
+	void BuildLengths(const uint32_t* frequencies, int count, int maxBits, uint8_t* lengths)
+	{
+		struct Item
+		{
+			uint32_t frequency;
+			uint16_t symbol;
+		};
+		Item items[kLitLenSymbols];
+		int used = 0;
+		for (int i = 0; i < count; ++i)
+		{
+			if (frequencies[i])
+				items[used++] = { frequencies[i], static_cast<uint16_t>(i) };
+		}
+		for (int i = 0; used < 2; ++i)
+		{
+			if (!frequencies[i])
+				items[used++] = { 1, static_cast<uint16_t>(i) };
+		}
+
+		std::sort(items, items + used, [](const Item& a, const Item& b) { return a.frequency < b.frequency; });
+		uint32_t depths[kLitLenSymbols];
+		for (int i = 0; i < used; ++i)
+			depths[i] = items[i].frequency;
+		MinimumRedundancy(depths, used);
+
+		// Move codes deeper than maxBits up, then borrow from shorter codes
+		// until the Kraft sum is exactly one again
+		int perLength[33] = {};
+		for (int i = 0; i < used; ++i)
+			++perLength[std::min<uint32_t>(depths[i], 32)];
+		for (int bits = maxBits + 1; bits <= 32; ++bits)
+		{
+			perLength[maxBits] += perLength[bits];
+			perLength[bits] = 0;
+		}
+		uint32_t total = 0;
+		for (int bits = maxBits; bits > 0; --bits)
+			total += static_cast<uint32_t>(perLength[bits]) << (maxBits - bits);
+		while (total != 1u << maxBits)
+		{
+			--perLength[maxBits];
+			for (int bits = maxBits - 1; bits > 0; --bits)
+			{
+				if (perLength[bits])
+				{
+					--perLength[bits];
+					perLength[bits + 1] += 2;
+					break;
+				}
+			}
+			--total;
+		}
+
+		std::fill(lengths, lengths + count, 0);
+		int item = 0;
+		for (int bits = maxBits; bits > 0; --bits)
+		{
+			for (int k = perLength[bits]; k > 0; --k)
+				lengths[items[item++].symbol] = static_cast<uint8_t>(bits);
+		}
+	}
+
+	// Canonical codes, bit-reversed because DEFLATE writes them LSB first
+	void BuildCodes(const uint8_t* lengths, int count, uint16_t* codes)
+	{
+		int perLength[kMaxCodeBits + 1] = {};
+		for (int i = 0; i < count; ++i)
+			++perLength[lengths[i]];
+		perLength[0] = 0;
+
+		uint32_t next[kMaxCodeBits + 2] = {};
+		uint32_t code = 0;
+		for (int bits = 1; bits <= kMaxCodeBits; ++bits)
+		{
+			code = (code + perLength[bits - 1]) << 1;
+			next[bits] = code;
+		}
+
+		for (int i = 0; i < count; ++i)
+		{
+			const int bits = lengths[i];
+			if (!bits)
+				continue;
+			uint32_t value = next[bits]++;
+			uint32_t reversed = 0;
+			for (int b = 0; b < bits; ++b, value >>= 1)
+				reversed = (reversed << 1) | (value & 1);
+			codes[i] = static_cast<uint16_t>(reversed);
+		}
+	}
+
+	struct BlockCodes
+	{
+		uint8_t litLenLengths[kLitLenSymbols];
+		uint16_t litLenCodes[kLitLenSymbols];
+		uint8_t distanceLengths[kDistanceSymbols];
+		uint16_t distanceCodes[kDistanceSymbols];
+
+		// Run-length coded code lengths for the block header
+		uint8_t headerSymbols[kLitLenSymbols + kDistanceSymbols];
+		uint8_t headerExtra[kLitLenSymbols + kDistanceSymbols];
+		int headerCount = 0;
+		uint8_t codeLengthLengths[kCodeLengthSymbols];
+		uint16_t codeLengthCodes[kCodeLengthSymbols];
+		int litLenCount = 0;
+		int distanceCount = 0;
+		int codeLengthCount = 0;
+	};
+
+	// Header symbols for the concatenated code lengths, using 16 (repeat
+	// previous), 17 and 18 (runs of zeros)
+	void EncodeLengths(const uint8_t* lengths, int count, BlockCodes& block)
+	{
+		for (int i = 0; i < count;)
+		{
+			const uint8_t value = lengths[i];
+			int run = 1;
+			while (i + run < count && lengths[i + run] == value)
+				++run;
+
+			if (value == 0 && run >= 3)
+			{
+				const int n = std::min(run, 138);
+				block.headerSymbols[block.headerCount] = n >= 11 ? 18 : 17;
+				block.headerExtra[block.headerCount++] = static_cast<uint8_t>(n >= 11 ? n - 11 : n - 3);
+				i += n;
+			}
+			else if (value != 0 && run >= 4)
+			{
+				block.headerSymbols[block.headerCount] = value;
+				block.headerExtra[block.headerCount++] = 0;
+				const int n = std::min(run - 1, 6);
+				block.headerSymbols[block.headerCount] = 16;
+				block.headerExtra[block.headerCount++] = static_cast<uint8_t>(n - 3);
+				i += n + 1;
+			}
+			else
+			{
+				block.headerSymbols[block.headerCount] = value;
+				block.headerExtra[block.headerCount++] = 0;
+				++i;
+			}
+		}
+	}
+
+	constexpr int HeaderExtraBits(int symbol)
+	{
+		return symbol == 16 ? 2 : symbol == 17 ? 3 : symbol == 18 ? 7 : 0;
+	}
+
+	// Builds codes for the tokens and returns the size of a dynamic block in bits
+	uint64_t PlanBlock(const uint32_t* tokens, size_t tokenCount, BlockCodes& block)
+	{
+		uint32_t litLen[kLitLenSymbols] = {};
+		uint32_t distance[kDistanceSymbols] = {};
+		for (size_t i = 0; i < tokenCount; ++i)
+		{
+			const uint32_t token = tokens[i];
+			if (token < 256)
+			{
+				++litLen[token];
+				continue;
+			}
+			++litLen[257 + kLengthCode[token & 511]];
+			++distance[DistanceCode(static_cast<int>(token >> 9))];
+		}
+		litLen[kEndOfBlock] = 1;
+
+		BuildLengths(litLen, kLitLenSymbols, kMaxCodeBits, block.litLenLengths);
+		BuildLengths(distance, kDistanceSymbols, kMaxCodeBits, block.distanceLengths);
+		BuildCodes(block.litLenLengths, kLitLenSymbols, block.litLenCodes);
+		BuildCodes(block.distanceLengths, kDistanceSymbols, block.distanceCodes);
+
+		block.litLenCount = kLitLenSymbols;
+		while (block.litLenCount > 257 && block.litLenLengths[block.litLenCount - 1] == 0)
+			--block.litLenCount;
+		block.distanceCount = kDistanceSymbols;
+		while (block.distanceCount > 1 && block.distanceLengths[block.distanceCount - 1] == 0)
+			--block.distanceCount;
+
+		// Literal/length and distance lengths form one sequence for the header
+		uint8_t all[kLitLenSymbols + kDistanceSymbols];
+		std::memcpy(all, block.litLenLengths, block.litLenCount);
+		std::memcpy(all + block.litLenCount, block.distanceLengths, block.distanceCount);
+		block.headerCount = 0;
+		EncodeLengths(all, block.litLenCount + block.distanceCount, block);
+
+		uint32_t codeLength[kCodeLengthSymbols] = {};
+		for (int i = 0; i < block.headerCount; ++i)
+			++codeLength[block.headerSymbols[i]];
+		BuildLengths(codeLength, kCodeLengthSymbols, kMaxCodeLengthBits, block.codeLengthLengths);
+		BuildCodes(block.codeLengthLengths, kCodeLengthSymbols, block.codeLengthCodes);
+		block.codeLengthCount = kCodeLengthSymbols;
+		while (block.codeLengthCount > 4 && block.codeLengthLengths[kCodeLengthOrder[block.codeLengthCount - 1]] == 0)
+			--block.codeLengthCount;
+
+		uint64_t bits = 3 + 5 + 5 + 4 + 3 * static_cast<uint64_t>(block.codeLengthCount);
+		for (int i = 0; i < kCodeLengthSymbols; ++i)
+			bits += static_cast<uint64_t>(codeLength[i]) * (block.codeLengthLengths[i] + HeaderExtraBits(i));
+		for (int i = 0; i < kLitLenSymbols; ++i)
+			bits += static_cast<uint64_t>(litLen[i]) * (block.litLenLengths[i] + (i > 256 ? kLengthExtra[i - 257] : 0));
+		for (int i = 0; i < kDistanceSymbols; ++i)
+			bits += static_cast<uint64_t>(distance[i]) * (block.distanceLengths[i] + kDistanceExtra[i]);
+		return bits;
+	}
+
+	void WriteDynamicBlock(BitWriter& writer, const uint32_t* tokens, size_t tokenCount, const BlockCodes& block, bool last)
+	{
+		writer.Put(last ? 1 : 0, 1);
+		writer.Put(2, 2);
+		writer.Put(block.litLenCount - 257, 5);
+		writer.Put(block.distanceCount - 1, 5);
+		writer.Put(block.codeLengthCount - 4, 4);
+		for (int i = 0; i < block.codeLengthCount; ++i)
+			writer.Put(block.codeLengthLengths[kCodeLengthOrder[i]], 3);
+		for (int i = 0; i < block.headerCount; ++i)
+		{
+			const int symbol = block.headerSymbols[i];
+			writer.Put(block.codeLengthCodes[symbol], block.codeLengthLengths[symbol]);
+			if (HeaderExtraBits(symbol))
+				writer.Put(block.headerExtra[i], HeaderExtraBits(symbol));
+		}
+
+		for (size_t i = 0; i < tokenCount; ++i)
+		{
+			const uint32_t token = tokens[i];
+			if (token < 256)
+			{
+				writer.Put(block.litLenCodes[token], block.litLenLengths[token]);
+				continue;
+			}
+
+			const int length = static_cast<int>(token & 511);
+			const int distance = static_cast<int>(token >> 9);
+			const int lengthCode = kLengthCode[length];
+			writer.Put(block.litLenCodes[257 + lengthCode], block.litLenLengths[257 + lengthCode]);
+			if (kLengthExtra[lengthCode])
+				writer.Put(length - kLengthBase[lengthCode], kLengthExtra[lengthCode]);
+
+			const int distanceCode = DistanceCode(distance);
+			writer.Put(block.distanceCodes[distanceCode], block.distanceLengths[distanceCode]);
+			if (kDistanceExtra[distanceCode])
+				writer.Put(distance - kDistanceBase[distanceCode], kDistanceExtra[distanceCode]);
+		}
+		writer.Put(block.litLenCodes[kEndOfBlock], block.litLenLengths[kEndOfBlock]);
+	}
+
+	void WriteStoredBlocks(BitWriter& writer, const uint8_t* data, size_t size, bool last)
+	{
+		do
+		{
+			const size_t chunk = std::min<size_t>(size, 65535);
+			size -= chunk;
+			writer.Put(last && size == 0 ? 1 : 0, 1);
+			writer.Put(0, 2);
+			writer.Align();
+			const uint16_t length = static_cast<uint16_t>(chunk);
+			const uint8_t header[4] = { static_cast<uint8_t>(length), static_cast<uint8_t>(length >> 8),
+										static_cast<uint8_t>(~length), static_cast<uint8_t>(~length >> 8) };
+			auto& bytes = writer.Bytes();
+			bytes.insert(bytes.end(), header, header + 4);
+			bytes.insert(bytes.end(), data, data + chunk);
+			data += chunk;
+		} while (size > 0);
+	}
+
+	void WriteBlock(BitWriter& writer, const uint32_t* tokens, size_t tokenCount, const uint8_t* data, size_t size, bool last)
+	{
+		BlockCodes block;
+		const uint64_t dynamicBits = PlanBlock(tokens, tokenCount, block);
+		const uint64_t storedBits = (size / 65535 + 1) * (3 + 7 + 32) + size * 8;
+		if (storedBits < dynamicBits)
+			WriteStoredBlocks(writer, data, size, last);
+		else
+			WriteDynamicBlock(writer, tokens, tokenCount, block, last);
+	}
+
+	uint32_t Load32(const uint8_t* p)
+	{
+		uint32_t value;
+		std::memcpy(&value, p, sizeof(value));
+		return value;
+	}
+
+	uint32_t Hash(const uint8_t* p)
+	{
+		return (Load32(p) * 2654435761u) >> (32 - kHashBits);
+	}
+
+	int MatchLength(const uint8_t* a, const uint8_t* b, int limit)
+	{
+		int length = 0;
+		while (length + 8 <= limit)
+		{
+			uint64_t x, y;
+			std::memcpy(&x, a + length, 8);
+			std::memcpy(&y, b + length, 8);
+			if (x != y)
+			{
+				// Little-endian: the first differing byte is the lowest set one
+				return length + std::countr_zero(x ^ y) / 8;
+			}
+			length += 8;
+		}
+		while (length < limit && a[length] == b[length])
+			++length;
+		return length;
+	}
+}
+
+void DeflateEncoder::Compress(const uint8_t* data, size_t size, bool last, std::vector<uint8_t>& out)
+{
+	static_assert(std::endian::native == std::endian::little, "MatchLength assumes little-endian loads");
+
+	thread_local std::vector<int32_t> head;
+	thread_local std::vector<int32_t> chain;
+	thread_local std::vector<uint32_t> tokens;
+	head.assign(size_t{ 1 } << kHashBits, -1);
+	chain.resize(kWindowSize);
+	tokens.clear();
+	tokens.reserve(kBlockTokens);
+
+	BitWriter writer(out);
+	auto insert = [&](size_t position) {
+		const uint32_t hash = Hash(data + position);
+		chain[position & (kWindowSize - 1)] = head[hash];
+		head[hash] = static_cast<int32_t>(position);
+	};
+
+	size_t blockStart = 0;
+	size_t position = 0;
+	while (position < size)
+	{
+		int bestLength = 0, bestDistance = 0;
+		if (position + kMinMatch <= size)
+		{
+			const uint32_t hash = Hash(data + position);
+			int32_t candidate = head[hash];
+			chain[position & (kWindowSize - 1)] = candidate;
+			head[hash] = static_cast<int32_t>(position);
+
+			const int limit = static_cast<int>(std::min<size_t>(kMaxMatch, size - position));
+			for (int tries = 0; candidate >= 0 && tries < kMaxChain; ++tries)
+			{
+				const int distance = static_cast<int>(position - candidate);
+				if (distance > kWindowSize)
+					break;
+				// Cheap reject: the byte that would extend the best match
+				if (data[candidate + bestLength] == data[position + bestLength])
+				{
+					const int length = MatchLength(data + candidate, data + position, limit);
+					if (length > bestLength)
+					{
+						bestLength = length;
+						bestDistance = distance;
+						if (length == limit)
+							break;
+					}
+				}
+				const int32_t next = chain[candidate & (kWindowSize - 1)];
+				if (next >= candidate)
+					break; // Overwritten slot from a newer position
+				candidate = next;
+			}
+		}
+
+		if (bestLength >= kMinMatch)
+		{
+			tokens.push_back(MakeMatch(bestLength, bestDistance));
+			if (bestLength <= kMaxInsertLength)
+			{
+				const size_t end = std::min(position + bestLength, size - kMinMatch + 1);
+				for (size_t p = position + 1; p < end; ++p)
+					insert(p);
+			}
+			position += bestLength;
+		}
+		else
+		{
+			tokens.push_back(data[position]);
+			++position;
+		}
+
+		if (tokens.size() >= kBlockTokens)
+		{
+			WriteBlock(writer, tokens.data(), tokens.size(), data + blockStart, position - blockStart, false);
+			tokens.clear();
+			blockStart = position;
+		}
+	}
+
+	if (last)
+	{
+		WriteBlock(writer, tokens.data(), tokens.size(), data + blockStart, size - blockStart, true);
+	}
+	else
+	{
+		if (!tokens.empty())
+			WriteBlock(writer, tokens.data(), tokens.size(), data + blockStart, size - blockStart, false);
+		// Sync flush: an empty stored block ends byte-aligned
+		WriteStoredBlocks(writer, nullptr, 0, false);
+	}
+	writer.Align();
+}
+
+uint32_t Adler32(uint32_t adler, const uint8_t* data, size_t size)
+{
+	// Largest run before the sums can overflow 32 bits
+	constexpr size_t kRun = 5552;
+
+	uint32_t a = adler & 0xFFFF;
+	uint32_t b = adler >> 16;
+	while (size > 0)
+	{
+		const size_t run = std::min(size, kRun);
+		for (size_t i = 0; i < run; ++i)
+		{
+			a += data[i];
+			b += a;
+		}
+		a %= kAdlerBase;
+		b %= kAdlerBase;
+		data += run;
+		size -= run;
+	}
+	return (b << 16) | a;
+}
+
+uint32_t Adler32Combine(uint32_t adlerA, uint32_t adlerB, size_t sizeB)
+{
+	const uint32_t remainder = static_cast<uint32_t>(sizeB % kAdlerBase);
+	uint32_t sum1 = adlerA & 0xFFFF;
+	uint32_t sum2 = static_cast<uint32_t>((static_cast<uint64_t>(remainder) * sum1) % kAdlerBase);
+	sum1 += (adlerB & 0xFFFF) + kAdlerBase - 1;
+	sum2 += (adlerA >> 16) + (adlerB >> 16) + kAdlerBase - remainder;
+	if (sum1 >= kAdlerBase)
+		sum1 -= kAdlerBase;
+	if (sum1 >= kAdlerBase)
+		sum1 -= kAdlerBase;
+	if (sum2 >= kAdlerBase * 2)
+		sum2 -= kAdlerBase * 2;
+	if (sum2 >= kAdlerBase)
+		sum2 -= kAdlerBase;
+	return (sum2 << 16) | sum1;
+}
+
+uint32_t Crc32(uint32_t crc, const uint8_t* data, size_t size)
+{
+	crc = ~crc;
+	// Slicing by four: one table lookup per byte, four bytes per step
+	while (size >= 4)
+	{
+		crc ^= static_cast<uint32_t>(data[0]) | static_cast<uint32_t>(data[1]) << 8 |
+			   static_cast<uint32_t>(data[2]) << 16 | static_cast<uint32_t>(data[3]) << 24;
+		crc = kCrcTable[3][crc & 0xFF] ^ kCrcTable[2][(crc >> 8) & 0xFF] ^ kCrcTable[1][(crc >> 16) & 0xFF] ^ kCrcTable[0][crc >> 24];
+		data += 4;
+		size -= 4;
+	}
+	while (size-- > 0)
+		crc = (crc >> 8) ^ kCrcTable[0][(crc ^ *data++) & 0xFF];
+	return ~crc;
+}
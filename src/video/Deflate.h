@@ -0,0 +1,26 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// Raw DEFLATE (RFC 1951) compressor tuned for speed over ratio: greedy
+// LZ77 on 4-byte hashes with short chains, dynamic Huffman blocks, and
+// stored blocks when the data does not compress. Independent chunks can be
+// compressed in parallel and concatenated: every chunk but the last ends
+// with a sync flush, which leaves the stream byte-aligned and open.
+class DeflateEncoder
+{
+public:
+	// Appends `size` bytes of `data` to `out` as a run of blocks. `last`
+	// closes the stream with a final block; otherwise it ends in a sync flush.
+	static void Compress(const uint8_t* data, size_t size, bool last, std::vector<uint8_t>& out);
+};
+
+// Running checksums; start from the value returned for an empty input
+// (Adler32(1, ...) and Crc32(0, ...)).
+uint32_t Adler32(uint32_t adler, const uint8_t* data, size_t size);
+uint32_t Crc32(uint32_t crc, const uint8_t* data, size_t size);
+
+// Adler-32 of A followed by B, from the checksums of A and B and B's length
+uint32_t Adler32Combine(uint32_t adlerA, uint32_t adlerB, size_t sizeB);
@@ -0,0 +1,22 @@
+#pragma once
+
+#include "CpuFeatures.h"
+
+#include <cstddef>
+#include <cstdint>
+
+// Byte-span comparison for one instruction set. Spans are one pixel row of a
+// tile (256 bytes for a full 64-pixel tile), so kernels test a whole cache
+// line per branch and bail out at the first one that differs.
+struct DiffKernels
+{
+	SimdLevel level;
+
+	// True when the first `bytes` bytes of a and b are identical
+	bool (*equal)(const uint8_t* a, const uint8_t* b, size_t bytes);
+};
+
+const DiffKernels* GetScalarDiffKernels();
+const DiffKernels* GetSSE2DiffKernels();
+const DiffKernels* GetAVX2DiffKernels();
+const DiffKernels* GetNEONDiffKernels();
@@ -0,0 +1,42 @@
+#include "DiffKernels.h"
+
+#include <immintrin.h>
+
+#include <cstring>
+
+namespace
+{
+	inline __m256i Load(const uint8_t* p)
+	{
+		return _mm256_loadu_si256(reinterpret_cast<const __m256i*>(p));
+	}
+
+	// XOR-OR reduction: one vptest per 128 bytes
+	bool Equal(const uint8_t* a, const uint8_t* b, size_t bytes)
+	{
+		size_t i = 0;
+		for (; i + 128 <= bytes; i += 128)
+		{
+			const __m256i x0 = _mm256_xor_si256(Load(a + i), Load(b + i));
+			const __m256i x1 = _mm256_xor_si256(Load(a + i + 32), Load(b + i + 32));
+			const __m256i x2 = _mm256_xor_si256(Load(a + i + 64), Load(b + i + 64));
+			const __m256i x3 = _mm256_xor_si256(Load(a + i + 96), Load(b + i + 96));
+			const __m256i any = _mm256_or_si256(_mm256_or_si256(x0, x1), _mm256_or_si256(x2, x3));
+			if (!_mm256_testz_si256(any, any))
+				return false;
+		}
+		for (; i + 32 <= bytes; i += 32)
+		{
+			const __m256i x = _mm256_xor_si256(Load(a + i), Load(b + i));
+			if (!_mm256_testz_si256(x, x))
+				return false;
+		}
+		return std::memcmp(a + i, b + i, bytes - i) == 0;
+	}
+}
+
+const DiffKernels* GetAVX2DiffKernels()
+{
+	static const DiffKernels kernels = { SimdLevel::AVX2, Equal };
+	return &kernels;
+}
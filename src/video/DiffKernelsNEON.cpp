@@ -0,0 +1,35 @@
+#include "DiffKernels.h"
+
+#include <arm_neon.h>
+
+#include <cstring>
+
+namespace
+{
+	// XOR-OR reduction, one horizontal max per 64 bytes
+	bool Equal(const uint8_t* a, const uint8_t* b, size_t bytes)
+	{
+		size_t i = 0;
+		for (; i + 64 <= bytes; i += 64)
+		{
+			const uint8x16_t x0 = veorq_u8(vld1q_u8(a + i), vld1q_u8(b + i));
+			const uint8x16_t x1 = veorq_u8(vld1q_u8(a + i + 16), vld1q_u8(b + i + 16));
+			const uint8x16_t x2 = veorq_u8(vld1q_u8(a + i + 32), vld1q_u8(b + i + 32));
+			const uint8x16_t x3 = veorq_u8(vld1q_u8(a + i + 48), vld1q_u8(b + i + 48));
+			if (vmaxvq_u8(vorrq_u8(vorrq_u8(x0, x1), vorrq_u8(x2, x3))) != 0)
+				return false;
+		}
+		for (; i + 16 <= bytes; i += 16)
+		{
+			if (vmaxvq_u8(veorq_u8(vld1q_u8(a + i), vld1q_u8(b + i))) != 0)
+				return false;
+		}
+		return std::memcmp(a + i, b + i, bytes - i) == 0;
+	}
+}
+
+const DiffKernels* GetNEONDiffKernels()
+{
+	static const DiffKernels kernels = { SimdLevel::NEON, Equal };
+	return &kernels;
+}
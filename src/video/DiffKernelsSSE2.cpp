@@ -0,0 +1,40 @@
+#include "DiffKernels.h"
+
+#include <emmintrin.h>
+
+#include <cstring>
+
+namespace
+{
+	inline __m128i Load(const uint8_t* p)
+	{
+		return _mm_loadu_si128(reinterpret_cast<const __m128i*>(p));
+	}
+
+	bool Equal(const uint8_t* a, const uint8_t* b, size_t bytes)
+	{
+		size_t i = 0;
+		for (; i + 64 <= bytes; i += 64)
+		{
+			const __m128i eq0 = _mm_cmpeq_epi8(Load(a + i), Load(b + i));
+			const __m128i eq1 = _mm_cmpeq_epi8(Load(a + i + 16), Load(b + i + 16));
+			const __m128i eq2 = _mm_cmpeq_epi8(Load(a + i + 32), Load(b + i + 32));
+			const __m128i eq3 = _mm_cmpeq_epi8(Load(a + i + 48), Load(b + i + 48));
+			const __m128i all = _mm_and_si128(_mm_and_si128(eq0, eq1), _mm_and_si128(eq2, eq3));
+			if (_mm_movemask_epi8(all) != 0xFFFF)
+				return false;
+		}
+		for (; i + 16 <= bytes; i += 16)
+		{
+			if (_mm_movemask_epi8(_mm_cmpeq_epi8(Load(a + i), Load(b + i))) != 0xFFFF)
+				return false;
+		}
+		return std::memcmp(a + i, b + i, bytes - i) == 0;
+	}
+}
+
+const DiffKernels* GetSSE2DiffKernels()
+{
+	static const DiffKernels kernels = { SimdLevel::SSE2, Equal };
+	return &kernels;
+}
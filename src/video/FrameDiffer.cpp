@@ -0,0 +1,222 @@
+#include "FrameDiffer.h"
+#include "ThreadPool.h"
+#include "../capture/IGraphicsCapture.h"
+
+#include <algorithm>
+#include <cstring>
+
+namespace
+{
+	bool ScalarEqual(const uint8_t* a, const uint8_t* b, size_t bytes)
+	{
+		return std::memcmp(a, b, bytes) == 0;
+	}
+
+	const DiffKernels* SelectKernels()
+	{
+		const DiffKernels* kernels = nullptr;
+		switch (CpuFeatures::GetSimdLevel())
+		{
+		case SimdLevel::AVX512: // Bound by memory bandwidth; AVX2 is as fast
+		case SimdLevel::AVX2:
+			kernels = GetAVX2DiffKernels();
+			break;
+		case SimdLevel::SSE2:
+			kernels = GetSSE2DiffKernels();
+			break;
+		case SimdLevel::NEON:
+			kernels = GetNEONDiffKernels();
+			break;
+		case SimdLevel::Scalar:
+			break;
+		}
+		return kernels ? kernels : GetScalarDiffKernels();
+	}
+}
+
+const DiffKernels* GetScalarDiffKernels()
+{
+	static const DiffKernels kernels = { SimdLevel::Scalar, ScalarEqual };
+	return &kernels;
+}
+
+#ifndef VIDEO_ARCH_X86
+const DiffKernels* GetSSE2DiffKernels() { return nullptr; }
+const DiffKernels* GetAVX2DiffKernels() { return nullptr; }
+#endif
+#ifndef VIDEO_ARCH_ARM64
+const DiffKernels* GetNEONDiffKernels() { return nullptr; }
+#endif
+
+void FrameDiffer::Reset()
+{
+	m_width = 0;
+	m_height = 0;
+	m_tilesX = 0;
+	m_tilesY = 0;
+	m_reference.clear();
+	m_tiles.clear();
+}
+
+bool FrameDiffer::Update(const uint8_t* pixels, int stride, int width, int height, const FrameRect* hints, size_t hintCount,
+						 std::vector<FrameRect>& outRects, ThreadPool* pool)
+{
+	if (!m_kernels)
+		m_kernels = SelectKernels();
+
+	const size_t rowBytes = static_cast<size_t>(width) * 4;
+	if (width != m_width || height != m_height || m_reference.empty())
+	{
+		m_width = width;
+		m_height = height;
+		m_tilesX = (width + kTileSize - 1) / kTileSize;
+		m_tilesY = (height + kTileSize - 1) / kTileSize;
+		m_reference.resize(rowBytes * height);
+		for (int y = 0; y < height; ++y)
+			std::memcpy(m_reference.data() + y * rowBytes, pixels + static_cast<size_t>(y) * stride, rowBytes);
+
+		m_tiles.assign(static_cast<size_t>(m_tilesX) * m_tilesY, Changed);
+		BuildRects(outRects);
+		m_tiles.assign(m_tiles.size(), Unchanged);
+		return true;
+	}
+
+	if (hintCount == 0)
+	{
+		std::fill(m_tiles.begin(), m_tiles.end(), Candidate);
+	}
+	else
+	{
+		for (size_t i = 0; i < hintCount; ++i)
+		{
+			const int x0 = std::max(hints[i].x, 0);
+			const int y0 = std::max(hints[i].y, 0);
+			const int x1 = std::min(hints[i].x + hints[i].width, width);
+			const int y1 = std::min(hints[i].y + hints[i].height, height);
+			if (x1 <= x0 || y1 <= y0)
+				continue;
+
+			for (int ty = y0 / kTileSize; ty <= (y1 - 1) / kTileSize; ++ty)
+			{
+				uint8_t* row = m_tiles.data() + static_cast<size_t>(ty) * m_tilesX;
+				std::fill(row + x0 / kTileSize, row + (x1 - 1) / kTileSize + 1, Candidate);
+			}
+		}
+	}
+
+	// Tile rows are independent: each touches only its own states and rows
+	const int bandCount = pool ? std::clamp(m_tilesY, 1, pool->GetConcurrency()) : 1;
+	auto band = [&](int index) {
+		const int first = m_tilesY * index / bandCount;
+		const int last = m_tilesY * (index + 1) / bandCount;
+		for (int ty = first; ty < last; ++ty)
+			CompareTileRow(pixels, stride, ty);
+	};
+	if (bandCount > 1)
+		pool->ParallelFor(bandCount, band);
+	else
+		band(0);
+
+	BuildRects(outRects);
+	std::fill(m_tiles.begin(), m_tiles.end(), Unchanged);
+	return !outRects.empty();
+}
+
+void FrameDiffer::CompareTileRow(const uint8_t* pixels, int stride, int tileY)
+{
+	uint8_t* states = m_tiles.data() + static_cast<size_t>(tileY) * m_tilesX;
+	if (std::find(states, states + m_tilesX, Candidate) == states + m_tilesX)
+		return;
+
+	const size_t rowBytes = static_cast<size_t>(m_width) * 4;
+	const size_t tileBytes = static_cast<size_t>(kTileSize) * 4;
+	const int top = tileY * kTileSize;
+	const int bottom = std::min(top + kTileSize, m_height);
+
+	// Row-major so both frames stream through the cache once; a tile drops
+	// out as soon as one of its rows differs
+	for (int y = top; y < bottom; ++y)
+	{
+		const uint8_t* row = pixels + static_cast<size_t>(y) * stride;
+		const uint8_t* reference = m_reference.data() + y * rowBytes;
+		bool pending = false;
+		for (int tx = 0; tx < m_tilesX; ++tx)
+		{
+			if (states[tx] != Candidate)
+				continue;
+			const size_t offset = tx * tileBytes;
+			if (m_kernels->equal(row + offset, reference + offset, std::min(tileBytes, rowBytes - offset)))
+				pending = true;
+			else
+				states[tx] = Changed;
+		}
+		if (!pending)
+			break;
+	}
+
+	// Bring the reference up to date, one copy per run of changed tiles
+	for (int tx = 0; tx < m_tilesX;)
+	{
+		if (states[tx] != Changed)
+		{
+			++tx;
+			continue;
+		}
+		const int first = tx;
+		while (tx < m_tilesX && states[tx] == Changed)
+			++tx;
+
+		const size_t offset = first * tileBytes;
+		const size_t bytes = std::min(tx * tileBytes, rowBytes) - offset;
+		for (int y = top; y < bottom; ++y)
+			std::memcpy(m_reference.data() + y * rowBytes + offset, pixels + static_cast<size_t>(y) * stride + offset, bytes);
+	}
+}
+
+void FrameDiffer::BuildRects(std::vector<FrameRect>& outRects)
+{
+	outRects.clear();
+	m_open.clear();
+
+	// Runs of changed tiles in each tile row. A run with the same extent as a
+	// rect that reached the tile row above extends that rect instead of
+	// starting a new one. Both the runs and the open rects are ordered by x,
+	// so one cursor pairs them up.
+	for (int ty = 0; ty < m_tilesY; ++ty)
+	{
+		const uint8_t* states = m_tiles.data() + static_cast<size_t>(ty) * m_tilesX;
+		const int top = ty * kTileSize;
+		const int height = std::min(kTileSize, m_height - top);
+		size_t cursor = 0;
+		m_nextOpen.clear();
+
+		for (int tx = 0; tx < m_tilesX;)
+		{
+			if (states[tx] != Changed)
+			{
+				++tx;
+				continue;
+			}
+			const int first = tx;
+			while (tx < m_tilesX && states[tx] == Changed)
+				++tx;
+
+			const int x = first * kTileSize;
+			const int width = std::min(tx * kTileSize, m_width) - x;
+			while (cursor < m_open.size() && outRects[m_open[cursor]].x < x)
+				++cursor;
+
+			if (cursor < m_open.size() && outRects[m_open[cursor]].x == x && outRects[m_open[cursor]].width == width)
+			{
+				outRects[m_open[cursor]].height += height;
+				m_nextOpen.push_back(m_open[cursor]);
+			}
+			else
+			{
+				m_nextOpen.push_back(outRects.size());
+				outRects.push_back({ x, top, width, height });
+			}
+		}
+		std::swap(m_open, m_nextOpen);
+	}
+}
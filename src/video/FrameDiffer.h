@@ -0,0 +1,55 @@
+#pragma once
+
+#include "DiffKernels.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+struct FrameRect;
+class ThreadPool;
+
+// Finds the parts of a BGRA frame that differ from the previous one, at a
+// granularity of kTileSize x kTileSize tiles. The differ keeps its own copy
+// of the previous frame and refreshes only the tiles that changed, so callers
+// are free to reuse or patch their buffers in place between frames.
+class FrameDiffer
+{
+public:
+	static constexpr int kTileSize = 64;
+
+	// Forget the previous frame; the next Update() reports a full change
+	void Reset();
+
+	// Compares `pixels` with the previous frame and remembers it for the next
+	// call. With `hints` (areas the source already knows may have changed),
+	// only tiles touching a hint are compared and the rest count as unchanged.
+	// `outRects` receives tile-aligned rects clipped to the frame, merged
+	// across neighbouring tiles. Returns false when nothing changed.
+	bool Update(const uint8_t* pixels, int stride, int width, int height, const FrameRect* hints, size_t hintCount,
+				std::vector<FrameRect>& outRects, ThreadPool* pool = nullptr);
+
+	int GetTilesX() const { return m_tilesX; }
+	int GetTilesY() const { return m_tilesY; }
+
+private:
+	enum TileState : uint8_t
+	{
+		Unchanged,
+		Candidate, // To be compared this frame
+		Changed
+	};
+
+	void CompareTileRow(const uint8_t* pixels, int stride, int tileY);
+	void BuildRects(std::vector<FrameRect>& outRects);
+
+	int m_width = 0;
+	int m_height = 0;
+	int m_tilesX = 0;
+	int m_tilesY = 0;
+	std::vector<uint8_t> m_reference; // Previous frame, tightly packed
+	std::vector<uint8_t> m_tiles;	   // TileState per tile, row-major
+	std::vector<size_t> m_open;	   // BuildRects() scratch: rects reaching the current tile row
+	std::vector<size_t> m_nextOpen;
+	const DiffKernels* m_kernels = nullptr;
+};
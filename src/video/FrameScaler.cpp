@@ -0,0 +1,359 @@
+#include "FrameScaler.h"
+#include "ThreadPool.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+namespace
+{
+	constexpr double kPi = 3.14159265358979323846;
+
+	// Below this many output rows per band, splitting costs more than it saves
+	constexpr int kMinRowsPerBand = 16;
+
+	double Sinc(double x)
+	{
+		if (x == 0.0)
+			return 1.0;
+		x *= kPi;
+		return std::sin(x) / x;
+	}
+
+	double FilterRadius(ScaleFilter filter)
+	{
+		return filter == ScaleFilter::Lanczos3 ? 3.0 : 1.0;
+	}
+
+	double FilterWeight(ScaleFilter filter, double x)
+	{
+		x = std::abs(x);
+		if (filter == ScaleFilter::Lanczos3)
+			return x < 3.0 ? Sinc(x) * Sinc(x / 3.0) : 0.0;
+		return std::max(0.0, 1.0 - x);
+	}
+
+	uint8_t ClampToByte(int value)
+	{
+		return static_cast<uint8_t>(std::clamp(value, 0, 255));
+	}
+
+	void ScalarHorizontal(const uint8_t* src, int16_t* dst, int dstWidth, const int* starts, const int16_t* weights, int taps)
+	{
+		constexpr int shift = kScalerWeightBits - kScalerIntermediateBits;
+		for (int x = 0; x < dstWidth; ++x)
+		{
+			const uint8_t* p = src + starts[x] * 4;
+			const int16_t* w = weights + x * taps;
+			int sum[4] = {};
+			for (int k = 0; k < taps; ++k)
+				for (int c = 0; c < 4; ++c)
+					sum[c] += p[k * 4 + c] * w[k];
+			for (int c = 0; c < 4; ++c)
+				dst[x * 4 + c] = static_cast<int16_t>((sum[c] + (1 << (shift - 1))) >> shift);
+		}
+	}
+
+	void ScalarVertical(const int16_t* const* rows, const int16_t* weights, int taps, uint8_t* dst, int begin, int end)
+	{
+		constexpr int shift = kScalerWeightBits + kScalerIntermediateBits;
+		for (int i = begin; i < end; ++i)
+		{
+			int sum = 1 << (shift - 1);
+			for (int k = 0; k < taps; ++k)
+				sum += rows[k][i] * weights[k];
+			dst[i] = ClampToByte(sum >> shift);
+		}
+	}
+
+	void ScalarBox2(const uint8_t* row0, const uint8_t* row1, uint8_t* dst, int begin, int end)
+	{
+		for (int x = begin; x < end; ++x)
+		{
+			const uint8_t* a = row0 + x * 8;
+			const uint8_t* b = row1 + x * 8;
+			for (int c = 0; c < 4; ++c)
+				dst[x * 4 + c] = static_cast<uint8_t>((a[c] + a[c + 4] + b[c] + b[c + 4] + 2) >> 2);
+		}
+	}
+
+	void ScalarBox4(const uint8_t* const* rows, uint8_t* dst, int begin, int end)
+	{
+		for (int x = begin; x < end; ++x)
+		{
+			for (int c = 0; c < 4; ++c)
+			{
+				int sum = 8;
+				for (int r = 0; r < 4; ++r)
+					for (int i = 0; i < 4; ++i)
+						sum += rows[r][x * 16 + i * 4 + c];
+				dst[x * 4 + c] = static_cast<uint8_t>(sum >> 4);
+			}
+		}
+	}
+
+	const ScalerKernels* SelectKernels()
+	{
+		const ScalerKernels* kernels = nullptr;
+		switch (CpuFeatures::GetSimdLevel())
+		{
+		case SimdLevel::AVX512: // Memory bound at these widths; AVX2 is as fast
+		case SimdLevel::AVX2:
+			kernels = GetAVX2ScalerKernels();
+			break;
+		case SimdLevel::SSE2:
+			kernels = GetSSE2ScalerKernels();
+			break;
+		case SimdLevel::NEON:
+			kernels = GetNEONScalerKernels();
+			break;
+		case SimdLevel::Scalar:
+			break;
+		}
+		return kernels ? kernels : GetScalarScalerKernels();
+	}
+}
+
+const ScalerKernels* GetScalarScalerKernels()
+{
+	static const ScalerKernels kernels = {
+		SimdLevel::Scalar, ScalarHorizontal, ScalarVertical, 1, ScalarBox2, ScalarBox4, 1
+	};
+	return &kernels;
+}
+
+#ifndef VIDEO_ARCH_X86
+const ScalerKernels* GetSSE2ScalerKernels() { return nullptr; }
+const ScalerKernels* GetAVX2ScalerKernels() { return nullptr; }
+#endif
+#ifndef VIDEO_ARCH_ARM64
+const ScalerKernels* GetNEONScalerKernels() { return nullptr; }
+#endif
+
+void FrameScaler::BuildAxis(Axis& axis, int srcSize, int dstSize, ScaleFilter filter)
+{
+	const double scale = static_cast<double>(srcSize) / dstSize;
+	const double filterScale = std::max(scale, 1.0);
+	const double support = FilterRadius(filter) * filterScale;
+
+	// Every output index uses the same (even) tap count so the kernels need
+	// no bounds checks; short windows near the edges are padded with zeros
+	int taps = static_cast<int>(std::ceil(support)) * 2 + 1;
+	taps += taps & 1;
+	taps = std::min(taps, srcSize);
+
+	axis.taps = taps;
+	axis.starts.assign(dstSize, 0);
+	axis.weights.assign(static_cast<size_t>(dstSize) * taps, 0);
+
+	std::vector<double> weights(taps);
+	for (int i = 0; i < dstSize; ++i)
+	{
+		const double center = (i + 0.5) * scale;
+		const int first = std::max(static_cast<int>(std::floor(center - support + 0.5)), 0);
+		const int last = std::min(static_cast<int>(std::floor(center + support + 0.5)), srcSize);
+		const int start = std::clamp(first, 0, srcSize - taps);
+
+		double total = 0.0;
+		for (int k = 0; k < taps; ++k)
+		{
+			const int source = start + k;
+			weights[k] = source >= first && source < last ? FilterWeight(filter, (source + 0.5 - center) / filterScale) : 0.0;
+			total += weights[k];
+		}
+
+		// Quantize, then give the rounding error to the largest weight so every
+		// row sums exactly to one and flat areas stay flat
+		int16_t* quantized = axis.weights.data() + static_cast<size_t>(i) * taps;
+		int sum = 0, largest = 0;
+		for (int k = 0; k < taps; ++k)
+		{
+			const double normalized = total != 0.0 ? weights[k] / total : (k == 0 ? 1.0 : 0.0);
+			quantized[k] = static_cast<int16_t>(std::lround(normalized * (1 << kScalerWeightBits)));
+			sum += quantized[k];
+			if (quantized[k] > quantized[largest])
+				largest = k;
+		}
+		quantized[largest] = static_cast<int16_t>(quantized[largest] + (1 << kScalerWeightBits) - sum);
+		axis.starts[i] = start;
+	}
+}
+
+bool FrameScaler::Configure(int srcWidth, int srcHeight, int dstWidth, int dstHeight, ScaleFilter filter)
+{
+	if (srcWidth <= 0 || srcHeight <= 0 || dstWidth <= 0 || dstHeight <= 0)
+		return false;
+
+	m_srcWidth = srcWidth;
+	m_srcHeight = srcHeight;
+	m_dstWidth = dstWidth;
+	m_dstHeight = dstHeight;
+	m_kernels = SelectKernels();
+
+	m_boxFactor = 0;
+	if (filter == ScaleFilter::Box)
+	{
+		for (int factor : { 2, 4 })
+		{
+			if (srcWidth == dstWidth * factor && srcHeight == dstHeight * factor)
+				m_boxFactor = factor;
+		}
+		if (m_boxFactor == 0)
+			filter = ScaleFilter::Bilinear;
+	}
+	m_filter = filter;
+
+	if (m_boxFactor == 0)
+	{
+		BuildAxis(m_horizontal, srcWidth, dstWidth, filter);
+		BuildAxis(m_vertical, srcHeight, dstHeight, filter);
+	}
+	return true;
+}
+
+void FrameScaler::Scale(const uint8_t* src, int srcStride, uint8_t* dst, int dstStride, ThreadPool* pool) const
+{
+	if (!IsConfigured())
+		return;
+
+	if (m_srcWidth == m_dstWidth && m_srcHeight == m_dstHeight)
+	{
+		CopyImage(BgraView(src, m_srcWidth, m_srcHeight, srcStride), MutableBgraView(dst, m_dstWidth, m_dstHeight, dstStride));
+		return;
+	}
+
+	const int bandCount = pool ? std::clamp(m_dstHeight / kMinRowsPerBand, 1, pool->GetConcurrency()) : 1;
+	auto band = [&](int index) {
+		const int firstRow = m_dstHeight * index / bandCount;
+		const int lastRow = m_dstHeight * (index + 1) / bandCount;
+		if (m_boxFactor)
+			BoxBand(src, srcStride, dst, dstStride, firstRow, lastRow);
+		else
+			ScaleBand(src, srcStride, dst, dstStride, firstRow, lastRow);
+	};
+
+	if (bandCount > 1)
+		pool->ParallelFor(bandCount, band);
+	else
+		band(0);
+}
+
+bool FrameScaler::Scale(BgraView src, MutableBgraView dst, ThreadPool* pool) const
+{
+	if (!IsConfigured() || src.IsEmpty() || dst.IsEmpty() || src.width != m_srcWidth || src.height != m_srcHeight ||
+		dst.width != m_dstWidth || dst.height != m_dstHeight)
+		return false;
+
+	Scale(src.data, src.stride, dst.data, dst.stride, pool);
+	return true;
+}
+
+void FrameScaler::BoxBand(const uint8_t* src, int srcStride, uint8_t* dst, int dstStride, int firstRow, int lastRow) const
+{
+	const ScalerKernels& scalar = *GetScalarScalerKernels();
+	const int body = m_dstWidth - m_dstWidth % m_kernels->boxStep;
+
+	for (int y = firstRow; y < lastRow; ++y)
+	{
+		const uint8_t* rows[4];
+		for (int r = 0; r < m_boxFactor; ++r)
+			rows[r] = src + static_cast<size_t>(y * m_boxFactor + r) * srcStride;
+		uint8_t* out = dst + static_cast<size_t>(y) * dstStride;
+
+		if (m_boxFactor == 2)
+		{
+			m_kernels->box2(rows[0], rows[1], out, 0, body);
+			scalar.box2(rows[0], rows[1], out, body, m_dstWidth);
+		}
+		else
+		{
+			m_kernels->box4(rows, out, 0, body);
+			scalar.box4(rows, out, body, m_dstWidth);
+		}
+	}
+}
+
+void FrameScaler::ScaleBand(const uint8_t* src, int srcStride, uint8_t* dst, int dstStride, int firstRow, int lastRow) const
+{
+	const int taps = m_vertical.taps;
+	const int rowValues = m_dstWidth * 4;
+	const ScalerKernels& scalar = *GetScalarScalerKernels();
+
+	// The SIMD horizontal kernels work on pairs of taps
+	const auto horizontal = m_horizontal.taps % 2 == 0 ? m_kernels->horizontal : scalar.horizontal;
+	const int verticalBody = rowValues - rowValues % m_kernels->verticalStep;
+
+	// Horizontally filtered source rows, indexed by source row modulo taps.
+	// Windows only move forward, so each source row is filtered once per band.
+	thread_local std::vector<int16_t> ring;
+	thread_local std::vector<const int16_t*> rows;
+	ring.resize(static_cast<size_t>(taps) * rowValues);
+	rows.resize(taps);
+
+	int nextSourceRow = 0;
+	bool primed = false;
+	for (int y = firstRow; y < lastRow; ++y)
+	{
+		const int start = m_vertical.starts[y];
+		for (int r = primed ? std::max(nextSourceRow, start) : start; r < start + taps; ++r)
+		{
+			horizontal(src + static_cast<size_t>(r) * srcStride, ring.data() + static_cast<size_t>(r % taps) * rowValues,
+					   m_dstWidth, m_horizontal.starts.data(), m_horizontal.weights.data(), m_horizontal.taps);
+		}
+		nextSourceRow = start + taps;
+		primed = true;
+
+		for (int k = 0; k < taps; ++k)
+			rows[k] = ring.data() + static_cast<size_t>((start + k) % taps) * rowValues;
+
+		const int16_t* weights = m_vertical.weights.data() + static_cast<size_t>(y) * taps;
+		uint8_t* out = dst + static_cast<size_t>(y) * dstStride;
+		m_kernels->vertical(rows.data(), weights, taps, out, 0, verticalBody);
+		scalar.vertical(rows.data(), weights, taps, out, verticalBody, rowValues);
+	}
+}
+
+void FrameScaler::MapSourceSpan(bool horizontal, int begin, int end, int& outBegin, int& outEnd) const
+{
+	const int dstSize = horizontal ? m_dstWidth : m_dstHeight;
+	const int srcSize = horizontal ? m_srcWidth : m_srcHeight;
+	if (srcSize == dstSize)
+	{
+		outBegin = begin;
+		outEnd = end;
+		return;
+	}
+	if (m_boxFactor)
+	{
+		outBegin = begin / m_boxFactor;
+		outEnd = std::min((end + m_boxFactor - 1) / m_boxFactor, dstSize);
+		return;
+	}
+
+	// Window starts are monotonic, so the affected outputs are contiguous
+	const Axis& axis = horizontal ? m_horizontal : m_vertical;
+	const auto& starts = axis.starts;
+	const int taps = axis.taps;
+	outBegin = static_cast<int>(std::upper_bound(starts.begin(), starts.end(), begin - taps) - starts.begin());
+	outEnd = static_cast<int>(std::lower_bound(starts.begin(), starts.end(), end) - starts.begin());
+}
+
+void FrameScaler::FitWithin(int width, int height, int maxWidth, int maxHeight, int& outWidth, int& outHeight)
+{
+	double scale = 1.0;
+	if (maxWidth > 0)
+		scale = std::min(scale, static_cast<double>(maxWidth) / width);
+	if (maxHeight > 0)
+		scale = std::min(scale, static_cast<double>(maxHeight) / height);
+
+	if (scale >= 1.0)
+	{
+		outWidth = width;
+		outHeight = height;
+		return;
+	}
+
+	// Even sizes keep 4:2:0 chroma aligned downstream
+	outWidth = std::max(static_cast<int>(std::lround(width * scale)) & ~1, 2);
+	outHeight = std::max(static_cast<int>(std::lround(height * scale)) & ~1, 2);
+}
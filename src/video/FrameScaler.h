@@ -0,0 +1,71 @@
+#pragma once
+
+#include "ImageView.h"
+#include "ScalerKernels.h"
+
+#include <cstdint>
+#include <vector>
+
+class ThreadPool;
+
+enum class ScaleFilter
+{
+	Box,	  // Exact 2x2 or 4x4 averages; only for 2x and 4x reductions
+	Bilinear, // Triangle filter widened to the scale ratio, so downscales do not alias
+	Lanczos3  // Sharpest; worth it for text
+};
+
+// Resizes BGRA images. Configure() precomputes the filter for one source and
+// destination geometry; Scale() can then be called from any number of
+// threads. Separable filters run horizontally first, into a small ring of
+// intermediate rows per band, then vertically. Work is split into bands of
+// output rows on a ThreadPool.
+class FrameScaler
+{
+public:
+	// Box falls back to Bilinear unless both axes shrink by exactly 2 or 4
+	bool Configure(int srcWidth, int srcHeight, int dstWidth, int dstHeight, ScaleFilter filter);
+	bool IsConfigured() const { return m_dstWidth > 0; }
+
+	void Scale(const uint8_t* src, int srcStride, uint8_t* dst, int dstStride, ThreadPool* pool = nullptr) const;
+	// Views must have the configured sizes; returns false otherwise
+	bool Scale(BgraView src, MutableBgraView dst, ThreadPool* pool = nullptr) const;
+
+	int GetSourceWidth() const { return m_srcWidth; }
+	int GetSourceHeight() const { return m_srcHeight; }
+	int GetWidth() const { return m_dstWidth; }
+	int GetHeight() const { return m_dstHeight; }
+	ScaleFilter GetFilter() const { return m_filter; }
+
+	// Destination pixels affected by a change in source pixels [begin, end)
+	// along one axis, taking the filter support into account
+	void MapSourceSpan(bool horizontal, int begin, int end, int& outBegin, int& outEnd) const;
+
+	// Largest size with the source aspect ratio that fits in maxWidth x maxHeight
+	// (either may be 0 for "unbounded"); never upscales. Results are even.
+	static void FitWithin(int width, int height, int maxWidth, int maxHeight, int& outWidth, int& outHeight);
+
+private:
+	struct Axis
+	{
+		int taps = 0;
+		std::vector<int> starts;	   // First source index per output index
+		std::vector<int16_t> weights; // taps per output index
+	};
+
+	static void BuildAxis(Axis& axis, int srcSize, int dstSize, ScaleFilter filter);
+
+	void ScaleBand(const uint8_t* src, int srcStride, uint8_t* dst, int dstStride, int firstRow, int lastRow) const;
+	void BoxBand(const uint8_t* src, int srcStride, uint8_t* dst, int dstStride, int firstRow, int lastRow) const;
+
+	int m_srcWidth = 0;
+	int m_srcHeight = 0;
+	int m_dstWidth = 0;
+	int m_dstHeight = 0;
+	ScaleFilter m_filter = ScaleFilter::Bilinear;
+	int m_boxFactor = 0;
+
+	Axis m_horizontal;
+	Axis m_vertical;
+	const ScalerKernels* m_kernels = nullptr;
+};
@@ -0,0 +1,336 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <type_traits>
+
+// Pixel layouts with a compile-time description (PixelTraits). Views and the
+// generic kernels below are instantiated per format, so per-pixel work has
+// no format switch and compiles to straight loops the compiler vectorizes.
+enum class PixelFormat
+{
+	BGRA8, // What capture delivers; uint32 0xAARRGGBB on little-endian
+	RGBA8,
+	RGB8,
+	Gray8, // One 8-bit channel: luma, or a single Y/U/V plane
+	UV8	   // Interleaved 8-bit chroma pairs (the NV12 UV plane)
+};
+
+enum class YuvFormat
+{
+	I420, // Planar Y, U, V; chroma subsampled 2x2
+	NV12, // Planar Y, interleaved UV; chroma subsampled 2x2
+	I444  // Planar Y, U, V at full resolution; keeps coloured text sharp
+};
+
+struct Rgb8Pixel
+{
+	uint8_t r, g, b;
+};
+
+struct Uv8Pixel
+{
+	uint8_t u, v;
+};
+
+// Per-format pixel type and size. Colour formats also convert to and from
+// BGRA, which is what ConvertImage() goes through.
+template <PixelFormat Format>
+struct PixelTraits;
+
+template <>
+struct PixelTraits<PixelFormat::BGRA8>
+{
+	using Pixel = uint32_t;
+	static constexpr int kBytesPerPixel = 4;
+	static constexpr uint32_t ToBGRA(Pixel pixel) { return pixel; }
+	static constexpr Pixel FromBGRA(uint32_t bgra) { return bgra; }
+};
+
+template <>
+struct PixelTraits<PixelFormat::RGBA8>
+{
+	using Pixel = uint32_t;
+	static constexpr int kBytesPerPixel = 4;
+	static constexpr uint32_t ToBGRA(Pixel pixel) { return (pixel & 0xFF00FF00u) | ((pixel >> 16) & 0xFF) | ((pixel & 0xFF) << 16); }
+	static constexpr Pixel FromBGRA(uint32_t bgra) { return ToBGRA(bgra); } // The same swap both ways
+};
+
+template <>
+struct PixelTraits<PixelFormat::RGB8>
+{
+	using Pixel = Rgb8Pixel;
+	static constexpr int kBytesPerPixel = 3;
+	static constexpr uint32_t ToBGRA(Pixel pixel)
+	{
+		return 0xFF000000u | (uint32_t(pixel.r) << 16) | (uint32_t(pixel.g) << 8) | pixel.b;
+	}
+	static constexpr Pixel FromBGRA(uint32_t bgra)
+	{
+		return { uint8_t(bgra >> 16), uint8_t(bgra >> 8), uint8_t(bgra) };
+	}
+};
+
+template <>
+struct PixelTraits<PixelFormat::Gray8>
+{
+	using Pixel = uint8_t;
+	static constexpr int kBytesPerPixel = 1;
+	static constexpr uint32_t ToBGRA(Pixel pixel) { return 0xFF000000u | pixel * 0x010101u; }
+	// Full-range BT.601 luma in 8-bit fixed point
+	static constexpr Pixel FromBGRA(uint32_t bgra)
+	{
+		return uint8_t((((bgra >> 16) & 0xFF) * 77 + ((bgra >> 8) & 0xFF) * 150 + (bgra & 0xFF) * 29 + 128) >> 8);
+	}
+};
+
+template <>
+struct PixelTraits<PixelFormat::UV8>
+{
+	using Pixel = Uv8Pixel;
+	static constexpr int kBytesPerPixel = 2;
+};
+
+// A width x height window onto pixels owned by someone else (a pooled frame
+// buffer, a mapped texture). `stride` is in bytes and may exceed the row
+// size, so a view of a sub-rectangle (Crop) is just a pointer offset: no
+// pixels move. `Byte` is const uint8_t for read-only views and uint8_t for
+// writable ones; a writable view converts to a read-only one.
+template <PixelFormat Format, typename Byte = const uint8_t>
+struct ImageView
+{
+	static_assert(std::is_same_v<std::remove_const_t<Byte>, uint8_t>, "Views address bytes");
+
+	using Traits = PixelTraits<Format>;
+	using Pixel = std::conditional_t<std::is_const_v<Byte>, const typename Traits::Pixel, typename Traits::Pixel>;
+	static constexpr PixelFormat kFormat = Format;
+	static constexpr int kBytesPerPixel = Traits::kBytesPerPixel;
+
+	Byte* data = nullptr;
+	int width = 0;
+	int height = 0;
+	int stride = 0;
+
+	constexpr ImageView() = default;
+	// A stride of 0 means tightly packed rows
+	constexpr ImageView(Byte* data, int width, int height, int stride = 0)
+		: data(data)
+		, width(width)
+		, height(height)
+		, stride(stride > 0 ? stride : width * kBytesPerPixel)
+	{
+	}
+	constexpr ImageView(void* data, int width, int height, int stride = 0) requires(!std::is_const_v<Byte>)
+		: ImageView(static_cast<Byte*>(data), width, height, stride)
+	{
+	}
+	constexpr ImageView(const void* data, int width, int height, int stride = 0) requires std::is_const_v<Byte>
+		: ImageView(static_cast<Byte*>(data), width, height, stride)
+	{
+	}
+
+	constexpr operator ImageView<Format, const uint8_t>() const requires(!std::is_const_v<Byte>)
+	{
+		return { data, width, height, stride };
+	}
+
+	constexpr bool IsEmpty() const { return !data || width <= 0 || height <= 0; }
+	constexpr size_t RowBytes() const { return static_cast<size_t>(width) * kBytesPerPixel; }
+	constexpr bool IsContiguous() const { return static_cast<size_t>(stride) == RowBytes(); }
+
+	// Bytes from the first pixel to just past the last one (the last row has
+	// no padding to account for)
+	constexpr size_t SizeBytes() const
+	{
+		return IsEmpty() ? 0 : static_cast<size_t>(stride) * (height - 1) + RowBytes();
+	}
+
+	Byte* RowData(int y) const { return data + static_cast<ptrdiff_t>(y) * stride; }
+	Pixel* Row(int y) const { return reinterpret_cast<Pixel*>(RowData(y)); }
+
+	// The part of the image inside (x, y, width, height); empty if they do
+	// not overlap
+	constexpr ImageView Crop(int x, int y, int cropWidth, int cropHeight) const
+	{
+		const int left = std::clamp(x, 0, width);
+		const int top = std::clamp(y, 0, height);
+		const int right = std::clamp(x + cropWidth, left, width);
+		const int bottom = std::clamp(y + cropHeight, top, height);
+		return { data + static_cast<ptrdiff_t>(top) * stride + static_cast<ptrdiff_t>(left) * kBytesPerPixel,
+				 right - left, bottom - top, stride };
+	}
+};
+
+template <PixelFormat Format>
+using MutableImageView = ImageView<Format, uint8_t>;
+
+using BgraView = ImageView<PixelFormat::BGRA8>;
+using MutableBgraView = MutableImageView<PixelFormat::BGRA8>;
+
+// The planes of one YUV image. Chroma planes of the 4:2:0 formats are
+// ceil(width/2) x ceil(height/2); NV12 keeps both chroma channels in `u`
+// and leaves `v` empty.
+template <YuvFormat Format, typename Byte = const uint8_t>
+struct PlanarImageView
+{
+	static constexpr YuvFormat kFormat = Format;
+	static constexpr int kChromaShift = Format == YuvFormat::I444 ? 0 : 1;
+	using LumaView = ImageView<PixelFormat::Gray8, Byte>;
+	using ChromaView = std::conditional_t<Format == YuvFormat::NV12, ImageView<PixelFormat::UV8, Byte>,
+										  ImageView<PixelFormat::Gray8, Byte>>;
+
+	LumaView y;
+	ChromaView u;
+	ChromaView v;
+
+	constexpr operator PlanarImageView<Format, const uint8_t>() const requires(!std::is_const_v<Byte>)
+	{
+		return { y, u, v };
+	}
+
+	constexpr int Width() const { return y.width; }
+	constexpr int Height() const { return y.height; }
+	static constexpr int ChromaSize(int size) { return (size + kChromaShift) >> kChromaShift; }
+
+	// Tightly packed planes of a width x height image, one after another
+	// in a single allocation of GetBufferSize() bytes
+	static constexpr size_t GetBufferSize(int width, int height)
+	{
+		const size_t chroma = static_cast<size_t>(ChromaSize(width)) * ChromaSize(height);
+		return static_cast<size_t>(width) * height + chroma * 2;
+	}
+	static PlanarImageView FromBuffer(Byte* buffer, int width, int height)
+	{
+		const int chromaWidth = ChromaSize(width);
+		const int chromaHeight = ChromaSize(height);
+		PlanarImageView view;
+		view.y = LumaView(buffer, width, height);
+		Byte* chroma = buffer + static_cast<size_t>(width) * height;
+		view.u = ChromaView(chroma, chromaWidth, chromaHeight);
+		if constexpr (Format != YuvFormat::NV12)
+			view.v = ChromaView(chroma + static_cast<size_t>(chromaWidth) * chromaHeight, chromaWidth, chromaHeight);
+		return view;
+	}
+
+	// Subsampled formats crop on even luma coordinates so the chroma planes
+	// stay aligned with it; the origin moves up/left to the nearest one
+	constexpr PlanarImageView Crop(int x, int y0, int cropWidth, int cropHeight) const
+	{
+		const int mask = (1 << kChromaShift) - 1;
+		const int alignedX = std::max(x, 0) & ~mask;
+		const int alignedY = std::max(y0, 0) & ~mask;
+		cropWidth += std::max(x, 0) - alignedX + std::min(x, 0);
+		cropHeight += std::max(y0, 0) - alignedY + std::min(y0, 0);
+
+		PlanarImageView view;
+		view.y = y.Crop(alignedX, alignedY, cropWidth, cropHeight);
+		const int chromaX = alignedX >> kChromaShift;
+		const int chromaY = alignedY >> kChromaShift;
+		view.u = u.Crop(chromaX, chromaY, ChromaSize(view.y.width), ChromaSize(view.y.height));
+		view.v = v.Crop(chromaX, chromaY, ChromaSize(view.y.width), ChromaSize(view.y.height));
+		return view;
+	}
+};
+
+template <YuvFormat Format>
+using MutablePlanarImageView = PlanarImageView<Format, uint8_t>;
+
+// Generic kernels. Source and destination must be the same size; they
+// return false (and do nothing) otherwise.
+
+template <PixelFormat Format, typename SrcByte>
+bool CopyImage(ImageView<Format, SrcByte> src, MutableImageView<Format> dst)
+{
+	if (src.width != dst.width || src.height != dst.height || src.IsEmpty())
+		return false;
+
+	if (src.IsContiguous() && dst.IsContiguous())
+	{
+		std::memmove(dst.data, src.data, src.SizeBytes());
+		return true;
+	}
+	for (int y = 0; y < src.height; ++y)
+		std::memcpy(dst.RowData(y), src.RowData(y), src.RowBytes());
+	return true;
+}
+
+template <PixelFormat Format>
+void FillImage(MutableImageView<Format> dst, typename PixelTraits<Format>::Pixel pixel)
+{
+	for (int y = 0; y < dst.height; ++y)
+		std::fill_n(dst.Row(y), dst.width, pixel);
+}
+
+// Converts between colour formats through BGRA. Each format pair compiles to
+// its own branch-free row loop; equal formats are a plain copy.
+template <PixelFormat SrcFormat, typename SrcByte, PixelFormat DstFormat>
+bool ConvertImage(ImageView<SrcFormat, SrcByte> src, MutableImageView<DstFormat> dst)
+{
+	if constexpr (SrcFormat == DstFormat)
+	{
+		return CopyImage(src, dst);
+	}
+	else
+	{
+		using Src = PixelTraits<SrcFormat>;
+		using Dst = PixelTraits<DstFormat>;
+		if (src.width != dst.width || src.height != dst.height || src.IsEmpty())
+			return false;
+
+		for (int y = 0; y < src.height; ++y)
+		{
+			const auto* in = src.Row(y);
+			auto* out = dst.Row(y);
+			for (int x = 0; x < src.width; ++x)
+				out[x] = Dst::FromBGRA(Src::ToBGRA(in[x]));
+		}
+		return true;
+	}
+}
+
+// Splits an interleaved UV plane (NV12 chroma) into separate U and V planes
+// (I420 chroma), for consumers that only take planar input
+template <typename SrcByte>
+bool SplitChroma(ImageView<PixelFormat::UV8, SrcByte> uv, MutableImageView<PixelFormat::Gray8> u,
+				 MutableImageView<PixelFormat::Gray8> v)
+{
+	if (uv.width != u.width || uv.height != u.height || uv.width != v.width || uv.height != v.height || uv.IsEmpty())
+		return false;
+
+	for (int y = 0; y < uv.height; ++y)
+	{
+		const Uv8Pixel* in = uv.Row(y);
+		uint8_t* outU = u.Row(y);
+		uint8_t* outV = v.Row(y);
+		for (int x = 0; x < uv.width; ++x)
+		{
+			outU[x] = in[x].u;
+			outV[x] = in[x].v;
+		}
+	}
+	return true;
+}
+
+// Calls `fn` with std::integral_constant<PixelFormat, format>, turning a
+// runtime format into a template argument once per image rather than once
+// per pixel. `fn` must return the same type for every format.
+template <typename Fn>
+decltype(auto) DispatchPixelFormat(PixelFormat format, Fn&& fn)
+{
+	switch (format)
+	{
+	case PixelFormat::RGBA8:
+		return fn(std::integral_constant<PixelFormat, PixelFormat::RGBA8>{});
+	case PixelFormat::RGB8:
+		return fn(std::integral_constant<PixelFormat, PixelFormat::RGB8>{});
+	case PixelFormat::Gray8:
+		return fn(std::integral_constant<PixelFormat, PixelFormat::Gray8>{});
+	case PixelFormat::UV8:
+		return fn(std::integral_constant<PixelFormat, PixelFormat::UV8>{});
+	case PixelFormat::BGRA8:
+	default:
+		return fn(std::integral_constant<PixelFormat, PixelFormat::BGRA8>{});
+	}
+}
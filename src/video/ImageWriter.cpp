@@ -0,0 +1,392 @@
+#include "ImageWriter.h"
+#include "Deflate.h"
+#include "PngFilterKernels.h"
+#include "ThreadPool.h"
+
+#include <algorithm>
+#include <cctype>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+
+namespace
+{
+	// Rows per PNG strip. Each strip is deflated on its own (the LZ77 window
+	// restarts), which costs well under 1% at typical desktop widths.
+	constexpr int kPngStripRows = 64;
+
+	void PutBigEndian32(std::vector<uint8_t>& out, uint32_t value)
+	{
+		const uint8_t bytes[4] = { static_cast<uint8_t>(value >> 24), static_cast<uint8_t>(value >> 16),
+								   static_cast<uint8_t>(value >> 8), static_cast<uint8_t>(value) };
+		out.insert(out.end(), bytes, bytes + 4);
+	}
+
+	void PutLittleEndian(std::vector<uint8_t>& out, uint32_t value, int bytes)
+	{
+		for (int i = 0; i < bytes; ++i)
+			out.push_back(static_cast<uint8_t>(value >> (8 * i)));
+	}
+
+	// Chunks are built in place: Begin writes a length placeholder and the
+	// type, Finish fills in the length and appends the CRC
+	void BeginPngChunk(std::vector<uint8_t>& out, const char* type)
+	{
+		out.insert(out.end(), 4, 0);
+		out.insert(out.end(), type, type + 4);
+	}
+
+	void FinishPngChunk(std::vector<uint8_t>& out, size_t start)
+	{
+		const uint32_t length = static_cast<uint32_t>(out.size() - start - 8);
+		out[start] = static_cast<uint8_t>(length >> 24);
+		out[start + 1] = static_cast<uint8_t>(length >> 16);
+		out[start + 2] = static_cast<uint8_t>(length >> 8);
+		out[start + 3] = static_cast<uint8_t>(length);
+		PutBigEndian32(out, Crc32(0, out.data() + start + 4, length + 4));
+	}
+
+	void ToRgb(const uint8_t* bgra, int width, uint8_t* rgb)
+	{
+		for (int x = 0; x < width; ++x, bgra += 4, rgb += 3)
+		{
+			rgb[0] = bgra[2];
+			rgb[1] = bgra[1];
+			rgb[2] = bgra[0];
+		}
+	}
+
+	void ScalarFilterRow(const uint8_t* row, const uint8_t* previous, size_t bytes, uint8_t* sub, uint8_t* up,
+						 uint8_t* paeth, uint32_t sums[4])
+	{
+		sums[0] = sums[1] = sums[2] = sums[3] = 0;
+		FilterPngBytes(row, previous, 0, bytes, sub, up, paeth, sums);
+	}
+
+	const PngFilterKernels* SelectKernels()
+	{
+		const PngFilterKernels* kernels = nullptr;
+		switch (CpuFeatures::GetSimdLevel())
+		{
+		case SimdLevel::AVX512: // Bound by the deflate stage; AVX2 is as fast
+		case SimdLevel::AVX2:
+			kernels = GetAVX2PngFilterKernels();
+			break;
+		case SimdLevel::SSE2:
+			kernels = GetSSE2PngFilterKernels();
+			break;
+		case SimdLevel::NEON:
+			kernels = GetNEONPngFilterKernels();
+			break;
+		case SimdLevel::Scalar:
+			break;
+		}
+		return kernels ? kernels : GetScalarPngFilterKernels();
+	}
+
+	// Keeps the filter with the smallest sum of absolute (signed) residuals,
+	// the usual heuristic. Average rarely wins on screen content and is not
+	// tried. `scratch` holds 3 rows.
+	void FilterRow(const PngFilterKernels& kernels, const uint8_t* row, const uint8_t* previous, size_t bytes,
+				   uint8_t* scratch, uint8_t* out)
+	{
+		uint8_t* candidates[4] = { nullptr, scratch, scratch + bytes, scratch + bytes * 2 };
+		uint32_t sums[4];
+		kernels.filterRow(row, previous, bytes, candidates[1], candidates[2], candidates[3], sums);
+
+		static constexpr uint8_t kFilterTypes[4] = { 0, 1, 2, 4 }; // None, Sub, Up, Paeth
+		int best = 0;
+		for (int i = 1; i < 4; ++i)
+		{
+			if (sums[i] < sums[best])
+				best = i;
+		}
+		out[0] = kFilterTypes[best];
+		std::memcpy(out + 1, best == 0 ? row : candidates[best], bytes);
+	}
+
+	struct PngStrip
+	{
+		std::vector<uint8_t> chunk; // Complete IDAT chunk
+		uint32_t adler = 1;			// Of the filtered rows
+		size_t filteredSize = 0;
+	};
+
+	void EncodePngStrip(const PngFilterKernels& kernels, const uint8_t* pixels, int stride, int width, int firstRow,
+						int lastRow, bool first, bool last, PngStrip& strip)
+	{
+		const size_t rowBytes = static_cast<size_t>(width) * 3;
+		std::vector<uint8_t> rgb(rowBytes * 2);
+		std::vector<uint8_t> scratch(rowBytes * 3);
+		std::vector<uint8_t> filtered((rowBytes + 1) * (lastRow - firstRow));
+		uint8_t* current = rgb.data();
+		uint8_t* previous = rgb.data() + rowBytes;
+
+		// Filters look at the row above, which belongs to the previous strip
+		if (firstRow > 0)
+			ToRgb(pixels + static_cast<size_t>(firstRow - 1) * stride, width, previous);
+		else
+			std::fill(previous, previous + rowBytes, 0);
+
+		for (int y = firstRow; y < lastRow; ++y)
+		{
+			ToRgb(pixels + static_cast<size_t>(y) * stride, width, current);
+			uint8_t* out = filtered.data() + (rowBytes + 1) * (y - firstRow);
+			FilterRow(kernels, current, previous, rowBytes, scratch.data(), out);
+			std::swap(current, previous);
+		}
+
+		strip.filteredSize = filtered.size();
+		strip.adler = Adler32(1, filtered.data(), filtered.size());
+
+		auto& chunk = strip.chunk;
+		chunk.clear();
+		chunk.reserve(filtered.size() / 2 + 64);
+		BeginPngChunk(chunk, "IDAT");
+		if (first)
+		{
+			// zlib header: deflate, 32K window, fastest-compression hint
+			chunk.push_back(0x78);
+			chunk.push_back(0x01);
+		}
+		DeflateEncoder::Compress(filtered.data(), filtered.size(), last, chunk);
+		FinishPngChunk(chunk, 0);
+	}
+}
+
+const PngFilterKernels* GetScalarPngFilterKernels()
+{
+	static const PngFilterKernels kernels = { SimdLevel::Scalar, ScalarFilterRow };
+	return &kernels;
+}
+
+#ifndef VIDEO_ARCH_X86
+const PngFilterKernels* GetSSE2PngFilterKernels() { return nullptr; }
+const PngFilterKernels* GetAVX2PngFilterKernels() { return nullptr; }
+#endif
+#ifndef VIDEO_ARCH_ARM64
+const PngFilterKernels* GetNEONPngFilterKernels() { return nullptr; }
+#endif
+
+bool ImageWriter::FormatFromPath(const std::string& path, ImageFormat& outFormat)
+{
+	const size_t dot = path.find_last_of('.');
+	if (dot == std::string::npos)
+		return false;
+
+	std::string extension = path.substr(dot + 1);
+	std::transform(extension.begin(), extension.end(), extension.begin(),
+				   [](unsigned char c) { return static_cast<char>(std::tolower(c)); });
+	if (extension == "png")
+		outFormat = ImageFormat::Png;
+	else if (extension == "qoi")
+		outFormat = ImageFormat::Qoi;
+	else if (extension == "bmp")
+		outFormat = ImageFormat::Bmp;
+	else
+		return false;
+	return true;
+}
+
+void ImageWriter::Encode(ImageFormat format, const uint8_t* pixels, int stride, int width, int height,
+						 std::vector<uint8_t>& out, ThreadPool* pool)
+{
+	switch (format)
+	{
+	case ImageFormat::Png:
+		EncodePng(pixels, stride, width, height, out, pool);
+		break;
+	case ImageFormat::Qoi:
+		EncodeQoi(pixels, stride, width, height, out);
+		break;
+	case ImageFormat::Bmp:
+		EncodeBmp(pixels, stride, width, height, out);
+		break;
+	}
+}
+
+void ImageWriter::EncodePng(const uint8_t* pixels, int stride, int width, int height, std::vector<uint8_t>& out,
+							ThreadPool* pool)
+{
+	static constexpr uint8_t kSignature[8] = { 0x89, 'P', 'N', 'G', '\r', '\n', 0x1A, '\n' };
+	out.assign(kSignature, kSignature + 8);
+
+	size_t start = out.size();
+	BeginPngChunk(out, "IHDR");
+	PutBigEndian32(out, static_cast<uint32_t>(width));
+	PutBigEndian32(out, static_cast<uint32_t>(height));
+	const uint8_t format[5] = { 8, 2, 0, 0, 0 }; // 8-bit RGB, deflate, adaptive filtering, no interlace
+	out.insert(out.end(), format, format + 5);
+	FinishPngChunk(out, start);
+
+	// Strips are independent deflate runs ending in a sync flush, so their
+	// IDAT chunks concatenate into one valid zlib stream
+	static const PngFilterKernels* kernels = SelectKernels();
+	const int stripCount = std::max(1, (height + kPngStripRows - 1) / kPngStripRows);
+	std::vector<PngStrip> strips(stripCount);
+	auto encodeStrip = [&](int index) {
+		const int firstRow = index * kPngStripRows;
+		const int lastRow = std::min(height, firstRow + kPngStripRows);
+		EncodePngStrip(*kernels, pixels, stride, width, firstRow, lastRow, index == 0, index == stripCount - 1, strips[index]);
+	};
+	if (pool && stripCount > 1)
+		pool->ParallelFor(stripCount, encodeStrip);
+	else
+	{
+		for (int i = 0; i < stripCount; ++i)
+			encodeStrip(i);
+	}
+
+	uint32_t adler = strips[0].adler;
+	for (int i = 1; i < stripCount; ++i)
+		adler = Adler32Combine(adler, strips[i].adler, strips[i].filteredSize);
+
+	size_t total = out.size() + 32;
+	for (const auto& strip : strips)
+		total += strip.chunk.size();
+	out.reserve(total);
+	for (const auto& strip : strips)
+		out.insert(out.end(), strip.chunk.begin(), strip.chunk.end());
+
+	// The zlib trailer is only known once every strip is done
+	start = out.size();
+	BeginPngChunk(out, "IDAT");
+	PutBigEndian32(out, adler);
+	FinishPngChunk(out, start);
+
+	start = out.size();
+	BeginPngChunk(out, "IEND");
+	FinishPngChunk(out, start);
+}
+
+void ImageWriter::EncodeQoi(const uint8_t* pixels, int stride, int width, int height, std::vector<uint8_t>& out)
+{
+	// https://qoiformat.org/qoi-specification.pdf
+	constexpr uint8_t kOpIndex = 0x00;
+	constexpr uint8_t kOpDiff = 0x40;
+	constexpr uint8_t kOpLuma = 0x80;
+	constexpr uint8_t kOpRun = 0xC0;
+	constexpr uint8_t kOpRgb = 0xFE;
+	constexpr int kMaxRun = 62;
+
+	out.clear();
+	// Worst case is 4 bytes per pixel (QOI_OP_RGB)
+	out.reserve(14 + static_cast<size_t>(width) * height * 4 + 8);
+	out.insert(out.end(), { 'q', 'o', 'i', 'f' });
+	PutBigEndian32(out, static_cast<uint32_t>(width));
+	PutBigEndian32(out, static_cast<uint32_t>(height));
+	out.push_back(3); // RGB
+	out.push_back(0); // sRGB
+
+	// Pixels as 0xAARRGGBB with alpha forced opaque, so every op leaves it alone
+	uint32_t index[64] = {};
+	uint32_t previous = 0xFF000000u;
+	int run = 0;
+	for (int y = 0; y < height; ++y)
+	{
+		const auto* row = reinterpret_cast<const uint32_t*>(pixels + static_cast<size_t>(y) * stride);
+		for (int x = 0; x < width; ++x)
+		{
+			uint32_t pixel;
+			std::memcpy(&pixel, row + x, sizeof(pixel));
+			pixel |= 0xFF000000u;
+
+			if (pixel == previous)
+			{
+				if (++run == kMaxRun)
+				{
+					out.push_back(kOpRun | (run - 1));
+					run = 0;
+				}
+				continue;
+			}
+			if (run > 0)
+			{
+				out.push_back(kOpRun | (run - 1));
+				run = 0;
+			}
+
+			const int r = (pixel >> 16) & 0xFF;
+			const int g = (pixel >> 8) & 0xFF;
+			const int b = pixel & 0xFF;
+			const int hash = (r * 3 + g * 5 + b * 7 + 255 * 11) % 64;
+			if (index[hash] == pixel)
+			{
+				out.push_back(kOpIndex | hash);
+				previous = pixel;
+				continue;
+			}
+			index[hash] = pixel;
+
+			const int dr = static_cast<int8_t>(r - ((previous >> 16) & 0xFF));
+			const int dg = static_cast<int8_t>(g - ((previous >> 8) & 0xFF));
+			const int db = static_cast<int8_t>(b - (previous & 0xFF));
+			const int drg = dr - dg;
+			const int dbg = db - dg;
+			if (dr >= -2 && dr <= 1 && dg >= -2 && dg <= 1 && db >= -2 && db <= 1)
+			{
+				out.push_back(static_cast<uint8_t>(kOpDiff | (dr + 2) << 4 | (dg + 2) << 2 | (db + 2)));
+			}
+			else if (dg >= -32 && dg <= 31 && drg >= -8 && drg <= 7 && dbg >= -8 && dbg <= 7)
+			{
+				out.push_back(static_cast<uint8_t>(kOpLuma | (dg + 32)));
+				out.push_back(static_cast<uint8_t>((drg + 8) << 4 | (dbg + 8)));
+			}
+			else
+			{
+				const uint8_t op[4] = { kOpRgb, static_cast<uint8_t>(r), static_cast<uint8_t>(g), static_cast<uint8_t>(b) };
+				out.insert(out.end(), op, op + 4);
+			}
+			previous = pixel;
+		}
+	}
+	if (run > 0)
+		out.push_back(kOpRun | (run - 1));
+
+	out.insert(out.end(), { 0, 0, 0, 0, 0, 0, 0, 1 });
+}
+
+void ImageWriter::EncodeBmp(const uint8_t* pixels, int stride, int width, int height, std::vector<uint8_t>& out)
+{
+	constexpr uint32_t kHeadersSize = 14 + 40;
+	const size_t rowBytes = static_cast<size_t>(width) * 4;
+	const size_t imageSize = rowBytes * height;
+
+	out.clear();
+	out.reserve(kHeadersSize + imageSize);
+
+	// BITMAPFILEHEADER
+	out.push_back('B');
+	out.push_back('M');
+	PutLittleEndian(out, static_cast<uint32_t>(kHeadersSize + imageSize), 4);
+	PutLittleEndian(out, 0, 4);
+	PutLittleEndian(out, kHeadersSize, 4);
+
+	// BITMAPINFOHEADER; a negative height stores rows top-down, as captured
+	PutLittleEndian(out, 40, 4);
+	PutLittleEndian(out, static_cast<uint32_t>(width), 4);
+	PutLittleEndian(out, static_cast<uint32_t>(-height), 4);
+	PutLittleEndian(out, 1, 2);	 // Planes
+	PutLittleEndian(out, 32, 2); // Bits per pixel
+	PutLittleEndian(out, 0, 4);	 // BI_RGB
+	PutLittleEndian(out, static_cast<uint32_t>(imageSize), 4);
+	PutLittleEndian(out, 2835, 4); // 72 DPI
+	PutLittleEndian(out, 2835, 4);
+	PutLittleEndian(out, 0, 4);
+	PutLittleEndian(out, 0, 4);
+
+	for (int y = 0; y < height; ++y)
+	{
+		const uint8_t* row = pixels + static_cast<size_t>(y) * stride;
+		out.insert(out.end(), row, row + rowBytes);
+	}
+}
+
+bool ImageWriter::WriteFile(const std::string& path, const std::vector<uint8_t>& data)
+{
+	std::ofstream file(path, std::ios::binary | std::ios::trunc);
+	if (!file)
+		return false;
+	file.write(reinterpret_cast<const char*>(data.data()), static_cast<std::streamsize>(data.size()));
+	return static_cast<bool>(file);
+}
@@ -0,0 +1,34 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+class ThreadPool;
+
+enum class ImageFormat
+{
+	Png, // Lossless, compact; filtered and deflated in row strips on a ThreadPool
+	Qoi, // Lossless, a few times faster than PNG at a somewhat larger size
+	Bmp	 // Uncompressed 32-bit BGRA; a straight copy of the rows
+};
+
+// Encodes BGRA images into image files. Alpha is dropped (captured frames are
+// opaque) except in BMP, which stores the pixels exactly as given.
+class ImageWriter
+{
+public:
+	// From the file extension (.png, .qoi, .bmp, any case); false if unknown
+	static bool FormatFromPath(const std::string& path, ImageFormat& outFormat);
+
+	// Replaces the contents of `out` with the encoded file
+	static void Encode(ImageFormat format, const uint8_t* pixels, int stride, int width, int height,
+					   std::vector<uint8_t>& out, ThreadPool* pool = nullptr);
+
+	static void EncodePng(const uint8_t* pixels, int stride, int width, int height, std::vector<uint8_t>& out,
+						  ThreadPool* pool = nullptr);
+	static void EncodeQoi(const uint8_t* pixels, int stride, int width, int height, std::vector<uint8_t>& out);
+	static void EncodeBmp(const uint8_t* pixels, int stride, int width, int height, std::vector<uint8_t>& out);
+
+	static bool WriteFile(const std::string& path, const std::vector<uint8_t>& data);
+};
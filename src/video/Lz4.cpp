@@ -0,0 +1,168 @@
+#include "Lz4.h"
+
+#include <algorithm>
+#include <array>
+#include <cstring>
+
+namespace
+{
+	constexpr int kMinMatch = 4;
+	constexpr int kHashBits = 13;
+	constexpr size_t kMaxOffset = 65535;
+	constexpr size_t kLastLiterals = 5; // The format requires the block to end in literals
+	constexpr size_t kMatchSafety = 12; // No match may start this close to the end
+
+	uint32_t Read32(const uint8_t* data)
+	{
+		uint32_t value;
+		std::memcpy(&value, data, sizeof(value));
+		return value;
+	}
+
+	uint32_t Hash(uint32_t value)
+	{
+		return (value * 2654435761u) >> (32 - kHashBits);
+	}
+
+	void WriteLength(size_t length, std::vector<uint8_t>& out)
+	{
+		while (length >= 255)
+		{
+			out.push_back(255);
+			length -= 255;
+		}
+		out.push_back(static_cast<uint8_t>(length));
+	}
+
+	void WriteSequence(const uint8_t* literals, size_t literalCount, size_t offset, size_t matchLength,
+					   std::vector<uint8_t>& out)
+	{
+		const size_t matchCode = matchLength ? matchLength - kMinMatch : 0;
+		out.push_back(static_cast<uint8_t>((std::min<size_t>(literalCount, 15) << 4) | std::min<size_t>(matchCode, 15)));
+		if (literalCount >= 15)
+			WriteLength(literalCount - 15, out);
+		out.insert(out.end(), literals, literals + literalCount);
+		if (!matchLength)
+			return;
+
+		out.push_back(static_cast<uint8_t>(offset));
+		out.push_back(static_cast<uint8_t>(offset >> 8));
+		if (matchCode >= 15)
+			WriteLength(matchCode - 15, out);
+	}
+
+	bool ReadLength(const uint8_t*& in, const uint8_t* end, size_t& length)
+	{
+		uint8_t byte;
+		do
+		{
+			if (in >= end)
+				return false;
+			byte = *in++;
+			length += byte;
+		} while (byte == 255);
+		return true;
+	}
+}
+
+void Lz4::Compress(const uint8_t* data, size_t size, std::vector<uint8_t>& out)
+{
+	out.reserve(out.size() + GetMaxCompressedSize(size));
+
+	size_t anchor = 0;
+	if (size > kMatchSafety)
+	{
+		std::array<uint32_t, 1 << kHashBits> table;
+		table.fill(UINT32_MAX);
+
+		const size_t matchLimit = size - kLastLiterals;
+		const size_t lastMatchStart = size - kMatchSafety;
+		size_t position = 0;
+		while (position <= lastMatchStart)
+		{
+			const uint32_t sequence = Read32(data + position);
+			const uint32_t hash = Hash(sequence);
+			const uint32_t candidate = table[hash];
+			table[hash] = static_cast<uint32_t>(position);
+
+			if (candidate == UINT32_MAX || position - candidate > kMaxOffset || Read32(data + candidate) != sequence)
+			{
+				++position;
+				continue;
+			}
+
+			// Extend forwards, then backwards over pending literals
+			size_t length = kMinMatch;
+			while (position + length < matchLimit && data[candidate + length] == data[position + length])
+				++length;
+			size_t start = position;
+			size_t from = candidate;
+			while (start > anchor && from > 0 && data[start - 1] == data[from - 1])
+			{
+				--start;
+				--from;
+				++length;
+			}
+
+			WriteSequence(data + anchor, start - anchor, start - from, length, out);
+			position = start + length;
+			anchor = position;
+
+			// Seed the table inside long matches so runs stay findable
+			if (position - 2 <= lastMatchStart)
+				table[Hash(Read32(data + position - 2))] = static_cast<uint32_t>(position - 2);
+		}
+	}
+
+	WriteSequence(data + anchor, size - anchor, 0, 0, out);
+}
+
+bool Lz4::Decompress(const uint8_t* data, size_t size, uint8_t* out, size_t outSize)
+{
+	const uint8_t* in = data;
+	const uint8_t* const inEnd = data + size;
+	size_t written = 0;
+
+	while (in < inEnd)
+	{
+		const uint8_t token = *in++;
+
+		size_t literalCount = token >> 4;
+		if (literalCount == 15 && !ReadLength(in, inEnd, literalCount))
+			return false;
+		if (literalCount > static_cast<size_t>(inEnd - in) || literalCount > outSize - written)
+			return false;
+		std::memcpy(out + written, in, literalCount);
+		in += literalCount;
+		written += literalCount;
+
+		if (in == inEnd)
+			break; // The last sequence has no match
+
+		if (inEnd - in < 2)
+			return false;
+		const size_t offset = static_cast<size_t>(in[0]) | static_cast<size_t>(in[1]) << 8;
+		in += 2;
+		size_t length = token & 15;
+		if (length == 15 && !ReadLength(in, inEnd, length))
+			return false;
+		length += kMinMatch;
+		if (offset == 0 || offset > written || length > outSize - written)
+			return false;
+
+		// Overlapping copies repeat the last `offset` bytes, so go byte by
+		// byte when the source runs into the destination
+		uint8_t* dst = out + written;
+		const uint8_t* src = dst - offset;
+		if (offset >= length)
+			std::memcpy(dst, src, length);
+		else
+		{
+			for (size_t i = 0; i < length; ++i)
+				dst[i] = src[i];
+		}
+		written += length;
+	}
+
+	return written == outSize;
+}
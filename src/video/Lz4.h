@@ -0,0 +1,23 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// LZ4 block format (no frame header or checksums): greedy matching on
+// 4-byte hashes with a single candidate per hash. Several times faster than
+// DeflateEncoder at a lower ratio, which suits per-frame screen data where
+// latency matters more than the last few percent.
+class Lz4
+{
+public:
+	// Worst-case compressed size of `size` input bytes
+	static size_t GetMaxCompressedSize(size_t size) { return size + size / 255 + 16; }
+
+	// Appends one block holding `size` bytes of `data` to `out`
+	static void Compress(const uint8_t* data, size_t size, std::vector<uint8_t>& out);
+
+	// Decodes a block into exactly `outSize` bytes; false on corrupt or
+	// truncated input, or when the block does not fill `out` exactly
+	static bool Decompress(const uint8_t* data, size_t size, uint8_t* out, size_t outSize);
+};
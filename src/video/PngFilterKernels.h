@@ -0,0 +1,53 @@
+#pragma once
+
+#include "CpuFeatures.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+
+// PNG row filtering for one instruction set, on 8-bit RGB rows (3 bytes per
+// pixel). A kernel produces the Sub, Up and Paeth residuals of a row in one
+// pass, with the sum of absolute signed residuals for None, Sub, Up and
+// Paeth, from which the encoder picks the filter to keep.
+struct PngFilterKernels
+{
+	SimdLevel level;
+
+	void (*filterRow)(const uint8_t* row, const uint8_t* previous, size_t bytes, uint8_t* sub, uint8_t* up,
+					  uint8_t* paeth, uint32_t sums[4]);
+};
+
+const PngFilterKernels* GetScalarPngFilterKernels();
+const PngFilterKernels* GetSSE2PngFilterKernels();
+const PngFilterKernels* GetAVX2PngFilterKernels();
+const PngFilterKernels* GetNEONPngFilterKernels();
+
+// Reference filter for bytes [begin, end) of a row; SIMD kernels use it for
+// the first pixel and the tail
+inline void FilterPngBytes(const uint8_t* row, const uint8_t* previous, size_t begin, size_t end, uint8_t* sub,
+						   uint8_t* up, uint8_t* paeth, uint32_t sums[4])
+{
+	constexpr size_t kBpp = 3;
+	for (size_t i = begin; i < end; ++i)
+	{
+		const int a = i >= kBpp ? row[i - kBpp] : 0;
+		const int b = previous[i];
+		const int c = i >= kBpp ? previous[i - kBpp] : 0;
+
+		// Paeth predictor, rearranged so the comparisons are branch-free
+		const int pa = std::abs(b - c);
+		const int pb = std::abs(a - c);
+		const int pc = std::abs(a + b - 2 * c);
+		const int ab = pb < pa ? b : a;
+		const int predicted = pc < (pa < pb ? pa : pb) ? c : ab;
+
+		sub[i] = static_cast<uint8_t>(row[i] - a);
+		up[i] = static_cast<uint8_t>(row[i] - b);
+		paeth[i] = static_cast<uint8_t>(row[i] - predicted);
+		sums[0] += std::abs(static_cast<int8_t>(row[i]));
+		sums[1] += std::abs(static_cast<int8_t>(sub[i]));
+		sums[2] += std::abs(static_cast<int8_t>(up[i]));
+		sums[3] += std::abs(static_cast<int8_t>(paeth[i]));
+	}
+}
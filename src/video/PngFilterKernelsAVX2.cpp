@@ -0,0 +1,81 @@
+#include "PngFilterKernels.h"
+
+#include <immintrin.h>
+
+namespace
+{
+	inline __m256i Load(const uint8_t* p)
+	{
+		return _mm256_loadu_si256(reinterpret_cast<const __m256i*>(p));
+	}
+
+	// Paeth prediction for 16 pixels' worth of bytes widened to 16 bits
+	inline __m256i Predict(__m256i a, __m256i b, __m256i c)
+	{
+		const __m256i pa = _mm256_abs_epi16(_mm256_sub_epi16(b, c));
+		const __m256i pb = _mm256_abs_epi16(_mm256_sub_epi16(a, c));
+		const __m256i pc = _mm256_abs_epi16(_mm256_sub_epi16(_mm256_add_epi16(a, b), _mm256_add_epi16(c, c)));
+		const __m256i ab = _mm256_blendv_epi8(a, b, _mm256_cmpgt_epi16(pa, pb));
+		return _mm256_blendv_epi8(ab, c, _mm256_cmpgt_epi16(_mm256_min_epi16(pa, pb), pc));
+	}
+
+	// Sum of |int8| per 64-bit quarter
+	inline __m256i SumAbs(__m256i x)
+	{
+		return _mm256_sad_epu8(_mm256_abs_epi8(x), _mm256_setzero_si256());
+	}
+
+	uint64_t Total(__m256i sums)
+	{
+		const __m128i half = _mm_add_epi64(_mm256_castsi256_si128(sums), _mm256_extracti128_si256(sums, 1));
+		return static_cast<uint64_t>(_mm_cvtsi128_si64(half)) + static_cast<uint64_t>(_mm_extract_epi64(half, 1));
+	}
+
+	void FilterRow(const uint8_t* row, const uint8_t* previous, size_t bytes, uint8_t* sub, uint8_t* up, uint8_t* paeth,
+				   uint32_t sums[4])
+	{
+		constexpr size_t kBpp = 3;
+		sums[0] = sums[1] = sums[2] = sums[3] = 0;
+		const size_t head = bytes < kBpp ? bytes : kBpp;
+		FilterPngBytes(row, previous, 0, head, sub, up, paeth, sums);
+
+		// Unpack and pack both work within 128-bit lanes, so they cancel out
+		// and the predicted bytes come back in order
+		const __m256i zero = _mm256_setzero_si256();
+		__m256i noneSum = zero, subSum = zero, upSum = zero, paethSum = zero;
+		size_t i = head;
+		for (; i + 32 <= bytes; i += 32)
+		{
+			const __m256i x = Load(row + i);
+			const __m256i a = Load(row + i - kBpp);
+			const __m256i b = Load(previous + i);
+			const __m256i c = Load(previous + i - kBpp);
+
+			const __m256i predictedLow = Predict(_mm256_unpacklo_epi8(a, zero), _mm256_unpacklo_epi8(b, zero), _mm256_unpacklo_epi8(c, zero));
+			const __m256i predictedHigh = Predict(_mm256_unpackhi_epi8(a, zero), _mm256_unpackhi_epi8(b, zero), _mm256_unpackhi_epi8(c, zero));
+			const __m256i s = _mm256_sub_epi8(x, a);
+			const __m256i u = _mm256_sub_epi8(x, b);
+			const __m256i p = _mm256_sub_epi8(x, _mm256_packus_epi16(predictedLow, predictedHigh));
+			_mm256_storeu_si256(reinterpret_cast<__m256i*>(sub + i), s);
+			_mm256_storeu_si256(reinterpret_cast<__m256i*>(up + i), u);
+			_mm256_storeu_si256(reinterpret_cast<__m256i*>(paeth + i), p);
+
+			noneSum = _mm256_add_epi64(noneSum, SumAbs(x));
+			subSum = _mm256_add_epi64(subSum, SumAbs(s));
+			upSum = _mm256_add_epi64(upSum, SumAbs(u));
+			paethSum = _mm256_add_epi64(paethSum, SumAbs(p));
+		}
+
+		sums[0] += static_cast<uint32_t>(Total(noneSum));
+		sums[1] += static_cast<uint32_t>(Total(subSum));
+		sums[2] += static_cast<uint32_t>(Total(upSum));
+		sums[3] += static_cast<uint32_t>(Total(paethSum));
+		FilterPngBytes(row, previous, i, bytes, sub, up, paeth, sums);
+	}
+}
+
+const PngFilterKernels* GetAVX2PngFilterKernels()
+{
+	static const PngFilterKernels kernels = { SimdLevel::AVX2, FilterRow };
+	return &kernels;
+}
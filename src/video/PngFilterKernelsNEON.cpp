@@ -0,0 +1,71 @@
+#include "PngFilterKernels.h"
+
+#include <arm_neon.h>
+
+namespace
+{
+	// Paeth prediction for 8 pixels' worth of bytes widened to 16 bits
+	inline uint16x8_t Predict(uint16x8_t a, uint16x8_t b, uint16x8_t c)
+	{
+		const uint16x8_t pa = vabdq_u16(b, c);
+		const uint16x8_t pb = vabdq_u16(a, c);
+		const int16x8_t sum = vreinterpretq_s16_u16(vaddq_u16(a, b));
+		const int16x8_t twice = vreinterpretq_s16_u16(vaddq_u16(c, c));
+		const uint16x8_t pc = vreinterpretq_u16_s16(vabdq_s16(sum, twice));
+		const uint16x8_t ab = vbslq_u16(vcltq_u16(pb, pa), b, a);
+		return vbslq_u16(vcltq_u16(pc, vminq_u16(pa, pb)), c, ab);
+	}
+
+	// |int8| as unsigned (0x80 -> 128, like the scalar std::abs), widened
+	// pairwise into 32-bit lanes
+	inline uint32x4_t AccumulateAbs(uint32x4_t sums, uint8x16_t x)
+	{
+		const uint8x16_t magnitude = vminq_u8(x, vsubq_u8(vdupq_n_u8(0), x));
+		return vpadalq_u16(sums, vpaddlq_u8(magnitude));
+	}
+
+	void FilterRow(const uint8_t* row, const uint8_t* previous, size_t bytes, uint8_t* sub, uint8_t* up, uint8_t* paeth,
+				   uint32_t sums[4])
+	{
+		constexpr size_t kBpp = 3;
+		sums[0] = sums[1] = sums[2] = sums[3] = 0;
+		const size_t head = bytes < kBpp ? bytes : kBpp;
+		FilterPngBytes(row, previous, 0, head, sub, up, paeth, sums);
+
+		uint32x4_t noneSum = vdupq_n_u32(0), subSum = vdupq_n_u32(0), upSum = vdupq_n_u32(0), paethSum = vdupq_n_u32(0);
+		size_t i = head;
+		for (; i + 16 <= bytes; i += 16)
+		{
+			const uint8x16_t x = vld1q_u8(row + i);
+			const uint8x16_t a = vld1q_u8(row + i - kBpp);
+			const uint8x16_t b = vld1q_u8(previous + i);
+			const uint8x16_t c = vld1q_u8(previous + i - kBpp);
+
+			const uint16x8_t predictedLow = Predict(vmovl_u8(vget_low_u8(a)), vmovl_u8(vget_low_u8(b)), vmovl_u8(vget_low_u8(c)));
+			const uint16x8_t predictedHigh = Predict(vmovl_u8(vget_high_u8(a)), vmovl_u8(vget_high_u8(b)), vmovl_u8(vget_high_u8(c)));
+			const uint8x16_t s = vsubq_u8(x, a);
+			const uint8x16_t u = vsubq_u8(x, b);
+			const uint8x16_t p = vsubq_u8(x, vcombine_u8(vmovn_u16(predictedLow), vmovn_u16(predictedHigh)));
+			vst1q_u8(sub + i, s);
+			vst1q_u8(up + i, u);
+			vst1q_u8(paeth + i, p);
+
+			noneSum = AccumulateAbs(noneSum, x);
+			subSum = AccumulateAbs(subSum, s);
+			upSum = AccumulateAbs(upSum, u);
+			paethSum = AccumulateAbs(paethSum, p);
+		}
+
+		sums[0] += vaddvq_u32(noneSum);
+		sums[1] += vaddvq_u32(subSum);
+		sums[2] += vaddvq_u32(upSum);
+		sums[3] += vaddvq_u32(paethSum);
+		FilterPngBytes(row, previous, i, bytes, sub, up, paeth, sums);
+	}
+}
+
+const PngFilterKernels* GetNEONPngFilterKernels()
+{
+	static const PngFilterKernels kernels = { SimdLevel::NEON, FilterRow };
+	return &kernels;
+}
@@ -0,0 +1,90 @@
+#include "PngFilterKernels.h"
+
+#include <emmintrin.h>
+
+namespace
+{
+	inline __m128i Load(const uint8_t* p)
+	{
+		return _mm_loadu_si128(reinterpret_cast<const __m128i*>(p));
+	}
+
+	inline __m128i Abs16(__m128i x)
+	{
+		return _mm_max_epi16(x, _mm_sub_epi16(_mm_setzero_si128(), x));
+	}
+
+	inline __m128i Select(__m128i mask, __m128i ifTrue, __m128i ifFalse)
+	{
+		return _mm_or_si128(_mm_and_si128(mask, ifTrue), _mm_andnot_si128(mask, ifFalse));
+	}
+
+	// Paeth prediction for 8 pixels' worth of bytes widened to 16 bits
+	inline __m128i Predict(__m128i a, __m128i b, __m128i c)
+	{
+		const __m128i pa = Abs16(_mm_sub_epi16(b, c));
+		const __m128i pb = Abs16(_mm_sub_epi16(a, c));
+		const __m128i pc = Abs16(_mm_sub_epi16(_mm_add_epi16(a, b), _mm_add_epi16(c, c)));
+		const __m128i ab = Select(_mm_cmplt_epi16(pb, pa), b, a);
+		return Select(_mm_cmplt_epi16(pc, _mm_min_epi16(pa, pb)), c, ab);
+	}
+
+	// Sum of |int8| per 64-bit half: min(x, -x) as unsigned is the magnitude
+	inline __m128i SumAbs(__m128i x)
+	{
+		const __m128i zero = _mm_setzero_si128();
+		return _mm_sad_epu8(_mm_min_epu8(x, _mm_sub_epi8(zero, x)), zero);
+	}
+
+	uint64_t Total(__m128i sums)
+	{
+		return static_cast<uint64_t>(_mm_cvtsi128_si32(sums)) +
+			   static_cast<uint64_t>(_mm_cvtsi128_si32(_mm_unpackhi_epi64(sums, sums)));
+	}
+
+	void FilterRow(const uint8_t* row, const uint8_t* previous, size_t bytes, uint8_t* sub, uint8_t* up, uint8_t* paeth,
+				   uint32_t sums[4])
+	{
+		constexpr size_t kBpp = 3;
+		sums[0] = sums[1] = sums[2] = sums[3] = 0;
+		const size_t head = bytes < kBpp ? bytes : kBpp;
+		FilterPngBytes(row, previous, 0, head, sub, up, paeth, sums);
+
+		const __m128i zero = _mm_setzero_si128();
+		__m128i noneSum = zero, subSum = zero, upSum = zero, paethSum = zero;
+		size_t i = head;
+		for (; i + 16 <= bytes; i += 16)
+		{
+			const __m128i x = Load(row + i);
+			const __m128i a = Load(row + i - kBpp);
+			const __m128i b = Load(previous + i);
+			const __m128i c = Load(previous + i - kBpp);
+
+			const __m128i predictedLow = Predict(_mm_unpacklo_epi8(a, zero), _mm_unpacklo_epi8(b, zero), _mm_unpacklo_epi8(c, zero));
+			const __m128i predictedHigh = Predict(_mm_unpackhi_epi8(a, zero), _mm_unpackhi_epi8(b, zero), _mm_unpackhi_epi8(c, zero));
+			const __m128i s = _mm_sub_epi8(x, a);
+			const __m128i u = _mm_sub_epi8(x, b);
+			const __m128i p = _mm_sub_epi8(x, _mm_packus_epi16(predictedLow, predictedHigh));
+			_mm_storeu_si128(reinterpret_cast<__m128i*>(sub + i), s);
+			_mm_storeu_si128(reinterpret_cast<__m128i*>(up + i), u);
+			_mm_storeu_si128(reinterpret_cast<__m128i*>(paeth + i), p);
+
+			noneSum = _mm_add_epi64(noneSum, SumAbs(x));
+			subSum = _mm_add_epi64(subSum, SumAbs(s));
+			upSum = _mm_add_epi64(upSum, SumAbs(u));
+			paethSum = _mm_add_epi64(paethSum, SumAbs(p));
+		}
+
+		sums[0] += static_cast<uint32_t>(Total(noneSum));
+		sums[1] += static_cast<uint32_t>(Total(subSum));
+		sums[2] += static_cast<uint32_t>(Total(upSum));
+		sums[3] += static_cast<uint32_t>(Total(paethSum));
+		FilterPngBytes(row, previous, i, bytes, sub, up, paeth, sums);
+	}
+}
+
+const PngFilterKernels* GetSSE2PngFilterKernels()
+{
+	static const PngFilterKernels kernels = { SimdLevel::SSE2, FilterRow };
+	return &kernels;
+}
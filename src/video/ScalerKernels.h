@@ -0,0 +1,38 @@
+#pragma once
+
+#include "CpuFeatures.h"
+
+#include <cstdint>
+
+// Fixed point used by the separable filter: weights are Q14 and sum to
+// exactly 1 << 14. The horizontal pass keeps 6 extra bits of precision in
+// int16 (value * 64) so the vertical pass rounds only once; that leaves room
+// for Lanczos overshoot without overflow.
+constexpr int kScalerWeightBits = 14;
+constexpr int kScalerIntermediateBits = 6;
+
+// Row kernels for one instruction set, BGRA pixels throughout. Kernels with
+// a step work on [begin, end) so the caller can finish the part that is not a
+// multiple of the step with the scalar kernel.
+struct ScalerKernels
+{
+	SimdLevel level;
+
+	// dst[x] = sum(src[starts[x] + k] * weights[x * taps + k]) for dstWidth
+	// pixels. `taps` is even and every window lies inside the source row.
+	void (*horizontal)(const uint8_t* src, int16_t* dst, int dstWidth, const int* starts, const int16_t* weights, int taps);
+
+	// dst[i] = sum(rows[k][i] * weights[k]) for channel values i in [begin, end)
+	void (*vertical)(const int16_t* const* rows, const int16_t* weights, int taps, uint8_t* dst, int begin, int end);
+	int verticalStep;
+
+	// 2x2 and 4x4 averages for output pixels [begin, end)
+	void (*box2)(const uint8_t* row0, const uint8_t* row1, uint8_t* dst, int begin, int end);
+	void (*box4)(const uint8_t* const* rows, uint8_t* dst, int begin, int end);
+	int boxStep;
+};
+
+const ScalerKernels* GetScalarScalerKernels();
+const ScalerKernels* GetSSE2ScalerKernels();
+const ScalerKernels* GetAVX2ScalerKernels();
+const ScalerKernels* GetNEONScalerKernels();
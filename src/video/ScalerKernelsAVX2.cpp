@@ -0,0 +1,52 @@
+#include "ScalerKernels.h"
+
+#include <immintrin.h>
+
+// AVX2 scaler kernels. Only the vertical pass is widened: it touches every
+// intermediate value once per tap and dominates Lanczos cost. The horizontal
+// and box kernels are bound by loads, so the SSE2 versions are reused.
+
+namespace
+{
+	inline __m256i WeightPair(int16_t first, int16_t second)
+	{
+		return _mm256_set1_epi32(static_cast<int32_t>((static_cast<uint32_t>(static_cast<uint16_t>(second)) << 16) | static_cast<uint16_t>(first)));
+	}
+
+	void Vertical(const int16_t* const* rows, const int16_t* weights, int taps, uint8_t* dst, int begin, int end)
+	{
+		constexpr int shift = kScalerWeightBits + kScalerIntermediateBits;
+		const __m256i rounding = _mm256_set1_epi32(1 << (shift - 1));
+
+		for (int i = begin; i < end; i += 16)
+		{
+			__m256i lo = rounding, hi = rounding;
+			for (int k = 0; k < taps; k += 2)
+			{
+				const bool pair = k + 1 < taps;
+				const __m256i a = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(rows[k] + i));
+				const __m256i b = pair ? _mm256_loadu_si256(reinterpret_cast<const __m256i*>(rows[k + 1] + i)) : _mm256_setzero_si256();
+				const __m256i w = WeightPair(weights[k], pair ? weights[k + 1] : 0);
+				lo = _mm256_add_epi32(lo, _mm256_madd_epi16(_mm256_unpacklo_epi16(a, b), w));
+				hi = _mm256_add_epi32(hi, _mm256_madd_epi16(_mm256_unpackhi_epi16(a, b), w));
+			}
+			// unpack and packs mirror each other within lanes; packus leaves
+			// the 16 bytes in qwords 0 and 2
+			const __m256i values = _mm256_packs_epi32(_mm256_srai_epi32(lo, shift), _mm256_srai_epi32(hi, shift));
+			const __m256i bytes = _mm256_permute4x64_epi64(_mm256_packus_epi16(values, values), _MM_SHUFFLE(3, 1, 2, 0));
+			_mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i), _mm256_castsi256_si128(bytes));
+		}
+	}
+}
+
+const ScalerKernels* GetAVX2ScalerKernels()
+{
+	static const ScalerKernels kernels = [] {
+		ScalerKernels table = *GetSSE2ScalerKernels();
+		table.level = SimdLevel::AVX2;
+		table.vertical = Vertical;
+		table.verticalStep = 16;
+		return table;
+	}();
+	return &kernels;
+}
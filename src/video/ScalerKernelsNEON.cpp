@@ -0,0 +1,89 @@
+#include "ScalerKernels.h"
+
+#include <arm_neon.h>
+
+// NEON scaler kernels: widening multiply-accumulate per tap, and vld4 to
+// split channels for the box filters.
+
+namespace
+{
+	// One output pixel per iteration, all four channels in one register
+	void Horizontal(const uint8_t* src, int16_t* dst, int dstWidth, const int* starts, const int16_t* weights, int taps)
+	{
+		constexpr int shift = kScalerWeightBits - kScalerIntermediateBits;
+		for (int x = 0; x < dstWidth; ++x)
+		{
+			const uint8_t* p = src + starts[x] * 4;
+			const int16_t* w = weights + x * taps;
+			int32x4_t sum = vdupq_n_s32(0);
+			for (int k = 0; k < taps; k += 2)
+			{
+				const int16x8_t pixels = vreinterpretq_s16_u16(vmovl_u8(vld1_u8(p + k * 4)));
+				sum = vmlal_n_s16(sum, vget_low_s16(pixels), w[k]);
+				sum = vmlal_n_s16(sum, vget_high_s16(pixels), w[k + 1]);
+			}
+			vst1_s16(dst + x * 4, vmovn_s32(vrshrq_n_s32(sum, shift)));
+		}
+	}
+
+	void Vertical(const int16_t* const* rows, const int16_t* weights, int taps, uint8_t* dst, int begin, int end)
+	{
+		constexpr int shift = kScalerWeightBits + kScalerIntermediateBits;
+		const int32x4_t rounding = vdupq_n_s32(1 << (shift - 1));
+
+		for (int i = begin; i < end; i += 8)
+		{
+			int32x4_t lo = rounding, hi = rounding;
+			for (int k = 0; k < taps; ++k)
+			{
+				const int16x8_t values = vld1q_s16(rows[k] + i);
+				lo = vmlal_n_s16(lo, vget_low_s16(values), weights[k]);
+				hi = vmlal_n_s16(hi, vget_high_s16(values), weights[k]);
+			}
+			const int16x8_t narrowed = vcombine_s16(vshrn_n_s32(lo, shift), vshrn_n_s32(hi, shift));
+			vst1_u8(dst + i, vqmovun_s16(narrowed));
+		}
+	}
+
+	// Eight output pixels per iteration
+	void Box2(const uint8_t* row0, const uint8_t* row1, uint8_t* dst, int begin, int end)
+	{
+		for (int x = begin; x < end; x += 8)
+		{
+			const uint8x16x4_t a = vld4q_u8(row0 + x * 8);
+			const uint8x16x4_t b = vld4q_u8(row1 + x * 8);
+			uint8x8x4_t out;
+			for (int c = 0; c < 4; ++c)
+				out.val[c] = vrshrn_n_u16(vpadalq_u8(vpaddlq_u8(a.val[c]), b.val[c]), 2);
+			vst4_u8(dst + x * 4, out);
+		}
+	}
+
+	// Eight output pixels per iteration
+	void Box4(const uint8_t* const* rows, uint8_t* dst, int begin, int end)
+	{
+		for (int x = begin; x < end; x += 8)
+		{
+			uint16x8_t sums[4] = { vdupq_n_u16(0), vdupq_n_u16(0), vdupq_n_u16(0), vdupq_n_u16(0) };
+			for (int r = 0; r < 4; ++r)
+			{
+				const uint8x16x4_t first = vld4q_u8(rows[r] + x * 16);
+				const uint8x16x4_t second = vld4q_u8(rows[r] + x * 16 + 64);
+				for (int c = 0; c < 4; ++c)
+					sums[c] = vaddq_u16(sums[c], vpaddq_u16(vpaddlq_u8(first.val[c]), vpaddlq_u8(second.val[c])));
+			}
+			uint8x8x4_t out;
+			for (int c = 0; c < 4; ++c)
+				out.val[c] = vrshrn_n_u16(sums[c], 4);
+			vst4_u8(dst + x * 4, out);
+		}
+	}
+}
+
+const ScalerKernels* GetNEONScalerKernels()
+{
+	static const ScalerKernels kernels = {
+		SimdLevel::NEON, Horizontal, Vertical, 8, Box2, Box4, 8
+	};
+	return &kernels;
+}
@@ -0,0 +1,134 @@
+#include "ScalerKernels.h"
+
+#include <emmintrin.h>
+
+#include <cstring>
+
+// SSE2 scaler kernels. Every filter tap pair becomes one pmaddwd: the two
+// source values are interleaved into 16-bit lanes and multiplied-added
+// against the matching pair of Q14 weights.
+
+namespace
+{
+	inline __m128i WeightPair(const int16_t* weights)
+	{
+		int32_t pair;
+		std::memcpy(&pair, weights, sizeof(pair));
+		return _mm_set1_epi32(pair);
+	}
+
+	inline __m128i WeightPair(int16_t first, int16_t second)
+	{
+		return _mm_set1_epi32(static_cast<int32_t>((static_cast<uint32_t>(static_cast<uint16_t>(second)) << 16) | static_cast<uint16_t>(first)));
+	}
+
+	// One output pixel per iteration, all four channels in one register
+	void Horizontal(const uint8_t* src, int16_t* dst, int dstWidth, const int* starts, const int16_t* weights, int taps)
+	{
+		constexpr int shift = kScalerWeightBits - kScalerIntermediateBits;
+		const __m128i zero = _mm_setzero_si128();
+		const __m128i rounding = _mm_set1_epi32(1 << (shift - 1));
+
+		for (int x = 0; x < dstWidth; ++x)
+		{
+			const uint8_t* p = src + starts[x] * 4;
+			const int16_t* w = weights + x * taps;
+			__m128i sum = rounding;
+			for (int k = 0; k < taps; k += 2)
+			{
+				// Two adjacent pixels -> B0 B1 G0 G1 R0 R1 A0 A1
+				const __m128i pixels = _mm_unpacklo_epi8(_mm_loadl_epi64(reinterpret_cast<const __m128i*>(p + k * 4)), zero);
+				const __m128i paired = _mm_unpacklo_epi16(pixels, _mm_srli_si128(pixels, 8));
+				sum = _mm_add_epi32(sum, _mm_madd_epi16(paired, WeightPair(w + k)));
+			}
+			sum = _mm_srai_epi32(sum, shift);
+			_mm_storel_epi64(reinterpret_cast<__m128i*>(dst + x * 4), _mm_packs_epi32(sum, sum));
+		}
+	}
+
+	void Vertical(const int16_t* const* rows, const int16_t* weights, int taps, uint8_t* dst, int begin, int end)
+	{
+		constexpr int shift = kScalerWeightBits + kScalerIntermediateBits;
+		const __m128i rounding = _mm_set1_epi32(1 << (shift - 1));
+
+		for (int i = begin; i < end; i += 8)
+		{
+			__m128i lo = rounding, hi = rounding;
+			for (int k = 0; k < taps; k += 2)
+			{
+				const bool pair = k + 1 < taps;
+				const __m128i a = _mm_loadu_si128(reinterpret_cast<const __m128i*>(rows[k] + i));
+				const __m128i b = pair ? _mm_loadu_si128(reinterpret_cast<const __m128i*>(rows[k + 1] + i)) : _mm_setzero_si128();
+				const __m128i w = WeightPair(weights[k], pair ? weights[k + 1] : 0);
+				lo = _mm_add_epi32(lo, _mm_madd_epi16(_mm_unpacklo_epi16(a, b), w));
+				hi = _mm_add_epi32(hi, _mm_madd_epi16(_mm_unpackhi_epi16(a, b), w));
+			}
+			const __m128i values = _mm_packs_epi32(_mm_srai_epi32(lo, shift), _mm_srai_epi32(hi, shift));
+			_mm_storel_epi64(reinterpret_cast<__m128i*>(dst + i), _mm_packus_epi16(values, values));
+		}
+	}
+
+	// Sums of horizontally adjacent pixels in two rows of 4 pixels: 2 x 4 int16
+	inline __m128i PairSums(__m128i row0, __m128i row1)
+	{
+		const __m128i zero = _mm_setzero_si128();
+		const __m128i lo = _mm_add_epi16(_mm_unpacklo_epi8(row0, zero), _mm_unpacklo_epi8(row1, zero));
+		const __m128i hi = _mm_add_epi16(_mm_unpackhi_epi8(row0, zero), _mm_unpackhi_epi8(row1, zero));
+		return _mm_add_epi16(_mm_unpacklo_epi64(lo, hi), _mm_unpackhi_epi64(lo, hi));
+	}
+
+	// Four output pixels per iteration
+	void Box2(const uint8_t* row0, const uint8_t* row1, uint8_t* dst, int begin, int end)
+	{
+		const __m128i rounding = _mm_set1_epi16(2);
+		for (int x = begin; x < end; x += 4)
+		{
+			const uint8_t* a = row0 + x * 8;
+			const uint8_t* b = row1 + x * 8;
+			const __m128i first = PairSums(_mm_loadu_si128(reinterpret_cast<const __m128i*>(a)),
+										   _mm_loadu_si128(reinterpret_cast<const __m128i*>(b)));
+			const __m128i second = PairSums(_mm_loadu_si128(reinterpret_cast<const __m128i*>(a + 16)),
+											_mm_loadu_si128(reinterpret_cast<const __m128i*>(b + 16)));
+			const __m128i averaged0 = _mm_srli_epi16(_mm_add_epi16(first, rounding), 2);
+			const __m128i averaged1 = _mm_srli_epi16(_mm_add_epi16(second, rounding), 2);
+			_mm_storeu_si128(reinterpret_cast<__m128i*>(dst + x * 4), _mm_packus_epi16(averaged0, averaged1));
+		}
+	}
+
+	// Sum of a 4x4 block (16 bytes from each of four rows) in the low 4 x int16
+	inline __m128i BlockSum(const uint8_t* const* rows, int offset)
+	{
+		const __m128i zero = _mm_setzero_si128();
+		__m128i lo = zero, hi = zero;
+		for (int r = 0; r < 4; ++r)
+		{
+			const __m128i pixels = _mm_loadu_si128(reinterpret_cast<const __m128i*>(rows[r] + offset));
+			lo = _mm_add_epi16(lo, _mm_unpacklo_epi8(pixels, zero));
+			hi = _mm_add_epi16(hi, _mm_unpackhi_epi8(pixels, zero));
+		}
+		const __m128i pairs = _mm_add_epi16(lo, hi);
+		return _mm_add_epi16(pairs, _mm_srli_si128(pairs, 8));
+	}
+
+	// Four output pixels per iteration
+	void Box4(const uint8_t* const* rows, uint8_t* dst, int begin, int end)
+	{
+		const __m128i rounding = _mm_set1_epi16(8);
+		for (int x = begin; x < end; x += 4)
+		{
+			const __m128i first = _mm_unpacklo_epi64(BlockSum(rows, x * 16), BlockSum(rows, x * 16 + 16));
+			const __m128i second = _mm_unpacklo_epi64(BlockSum(rows, x * 16 + 32), BlockSum(rows, x * 16 + 48));
+			const __m128i averaged0 = _mm_srli_epi16(_mm_add_epi16(first, rounding), 4);
+			const __m128i averaged1 = _mm_srli_epi16(_mm_add_epi16(second, rounding), 4);
+			_mm_storeu_si128(reinterpret_cast<__m128i*>(dst + x * 4), _mm_packus_epi16(averaged0, averaged1));
+		}
+	}
+}
+
+const ScalerKernels* GetSSE2ScalerKernels()
+{
+	static const ScalerKernels kernels = {
+		SimdLevel::SSE2, Horizontal, Vertical, 8, Box2, Box4, 4
+	};
+	return &kernels;
+}
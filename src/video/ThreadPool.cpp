@@ -0,0 +1,105 @@
+#include "ThreadPool.h"
+
+#include <algorithm>
+
+ThreadPool::ThreadPool(int workerCount)
+{
+	if (workerCount <= 0)
+		workerCount = std::max(static_cast<int>(std::thread::hardware_concurrency()) - 1, 0);
+
+	m_workers.reserve(workerCount);
+	for (int i = 0; i < workerCount; ++i)
+		m_workers.emplace_back(&ThreadPool::WorkerThread, this);
+}
+
+ThreadPool::~ThreadPool()
+{
+	{
+		std::lock_guard lock(m_mutex);
+		m_stopping = true;
+	}
+	m_workAvailable.notify_all();
+
+	for (auto& worker : m_workers)
+		worker.join();
+}
+
+ThreadPool& ThreadPool::Shared()
+{
+	static ThreadPool pool;
+	return pool;
+}
+
+void ThreadPool::ParallelFor(int count, const std::function<void(int index)>& function)
+{
+	if (count <= 0)
+		return;
+	if (count == 1 || m_workers.empty())
+	{
+		for (int i = 0; i < count; ++i)
+			function(i);
+		return;
+	}
+
+	Batch batch;
+	batch.function = &function;
+	batch.count = count;
+	{
+		std::lock_guard lock(m_mutex);
+		m_batches.push_back(&batch);
+	}
+	m_workAvailable.notify_all();
+
+	RunBatch(batch);
+
+	// The batch lives on this stack frame: take it out of the queue so no new
+	// worker can pick it up, then wait for those still inside it
+	std::unique_lock lock(m_mutex);
+	auto it = std::find(m_batches.begin(), m_batches.end(), &batch);
+	if (it != m_batches.end())
+		m_batches.erase(it);
+	m_batchFinished.wait(lock, [&batch] {
+		return batch.completed.load(std::memory_order_acquire) == batch.count && batch.activeWorkers == 0;
+	});
+}
+
+void ThreadPool::RunBatch(Batch& batch)
+{
+	int index;
+	while ((index = batch.next.fetch_add(1, std::memory_order_relaxed)) < batch.count)
+	{
+		(*batch.function)(index);
+		if (batch.completed.fetch_add(1, std::memory_order_acq_rel) + 1 == batch.count)
+		{
+			// Pair with the waiter's predicate check so the wakeup cannot be lost
+			{
+				std::lock_guard lock(m_mutex);
+			}
+			m_batchFinished.notify_all();
+		}
+	}
+}
+
+void ThreadPool::WorkerThread()
+{
+	std::unique_lock lock(m_mutex);
+	while (true)
+	{
+		m_workAvailable.wait(lock, [this] { return m_stopping || !m_batches.empty(); });
+		if (m_stopping)
+			return;
+
+		Batch* batch = m_batches.front();
+		++batch->activeWorkers;
+		lock.unlock();
+
+		RunBatch(*batch);
+
+		lock.lock();
+		// Every index is claimed; later batches are next in line
+		if (!m_batches.empty() && m_batches.front() == batch)
+			m_batches.pop_front();
+		--batch->activeWorkers;
+		m_batchFinished.notify_all();
+	}
+}
@@ -0,0 +1,53 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// Fixed set of worker threads for data-parallel frame processing (row bands,
+// tiles). ParallelFor() blocks until every index has run; the calling thread
+// works on its own batch too, so a pool never deadlocks on a busy caller and
+// a single-core host simply runs everything inline. Several threads may call
+// ParallelFor() at once; their batches are served in order.
+class ThreadPool
+{
+public:
+	// 0 picks one worker per hardware thread, minus the caller
+	explicit ThreadPool(int workerCount = 0);
+	~ThreadPool();
+
+	ThreadPool(const ThreadPool&) = delete;
+	ThreadPool& operator=(const ThreadPool&) = delete;
+
+	// Threads that can work on one batch, including the caller
+	int GetConcurrency() const { return static_cast<int>(m_workers.size()) + 1; }
+
+	void ParallelFor(int count, const std::function<void(int index)>& function);
+
+	// Process-wide pool shared by the video and capture stages
+	static ThreadPool& Shared();
+
+private:
+	struct Batch
+	{
+		const std::function<void(int)>* function = nullptr;
+		int count = 0;
+		std::atomic<int> next = 0;
+		std::atomic<int> completed = 0;
+		int activeWorkers = 0; // Guarded by m_mutex
+	};
+
+	void RunBatch(Batch& batch);
+	void WorkerThread();
+
+	std::mutex m_mutex;
+	std::condition_variable m_workAvailable;
+	std::condition_variable m_batchFinished;
+	std::deque<Batch*> m_batches;
+	bool m_stopping = false;
+	std::vector<std::thread> m_workers;
+};
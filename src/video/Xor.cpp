@@ -0,0 +1,65 @@
+#include "Xor.h"
+#include "XorKernels.h"
+
+#include <cstring>
+
+namespace
+{
+	void ScalarXorInto(uint8_t* dst, const uint8_t* src, size_t bytes)
+	{
+		// Eight bytes at a time; memcpy keeps the loads legal at any alignment
+		size_t i = 0;
+		for (; i + 8 <= bytes; i += 8)
+		{
+			uint64_t a;
+			uint64_t b;
+			std::memcpy(&a, dst + i, 8);
+			std::memcpy(&b, src + i, 8);
+			a ^= b;
+			std::memcpy(dst + i, &a, 8);
+		}
+		for (; i < bytes; ++i)
+			dst[i] ^= src[i];
+	}
+
+	const XorKernels* SelectKernels()
+	{
+		const XorKernels* kernels = nullptr;
+		switch (CpuFeatures::GetSimdLevel())
+		{
+		case SimdLevel::AVX512: // Bound by memory bandwidth; AVX2 is as fast
+		case SimdLevel::AVX2:
+			kernels = GetAVX2XorKernels();
+			break;
+		case SimdLevel::SSE2:
+			kernels = GetSSE2XorKernels();
+			break;
+		case SimdLevel::NEON:
+			kernels = GetNEONXorKernels();
+			break;
+		case SimdLevel::Scalar:
+			break;
+		}
+		return kernels ? kernels : GetScalarXorKernels();
+	}
+}
+
+const XorKernels* GetScalarXorKernels()
+{
+	static const XorKernels kernels = { SimdLevel::Scalar, ScalarXorInto };
+	return &kernels;
+}
+
+#ifndef VIDEO_ARCH_X86
+const XorKernels* GetSSE2XorKernels() { return nullptr; }
+const XorKernels* GetAVX2XorKernels() { return nullptr; }
+#endif
+#ifndef VIDEO_ARCH_ARM64
+const XorKernels* GetNEONXorKernels() { return nullptr; }
+#endif
+
+void XorInto(uint8_t* dst, const uint8_t* src, size_t bytes)
+{
+	static const XorKernels* const kernels = SelectKernels();
+	kernels->xorInto(dst, src, bytes);
+}
@@ -0,0 +1,8 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+// dst[i] ^= src[i] over `bytes` bytes, with the best SIMD kernel the CPU
+// supports. The building block of XOR forward error correction.
+void XorInto(uint8_t* dst, const uint8_t* src, size_t bytes);
@@ -0,0 +1,22 @@
+#pragma once
+
+#include "CpuFeatures.h"
+
+#include <cstddef>
+#include <cstdint>
+
+// In-place XOR of byte spans for one instruction set. Spans are RTP
+// payloads (around 1200 bytes), so kernels run 128 bytes per iteration
+// with a scalar tail.
+struct XorKernels
+{
+	SimdLevel level;
+
+	// dst[i] ^= src[i] for the first `bytes` bytes
+	void (*xorInto)(uint8_t* dst, const uint8_t* src, size_t bytes);
+};
+
+const XorKernels* GetScalarXorKernels();
+const XorKernels* GetSSE2XorKernels();
+const XorKernels* GetAVX2XorKernels();
+const XorKernels* GetNEONXorKernels();
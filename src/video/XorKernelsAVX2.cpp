@@ -0,0 +1,50 @@
+#include "XorKernels.h"
+
+#include <immintrin.h>
+
+namespace
+{
+	inline __m256i Load(const uint8_t* p)
+	{
+		return _mm256_loadu_si256(reinterpret_cast<const __m256i*>(p));
+	}
+
+	inline void Store(uint8_t* p, __m256i v)
+	{
+		_mm256_storeu_si256(reinterpret_cast<__m256i*>(p), v);
+	}
+
+	void XorInto(uint8_t* dst, const uint8_t* src, size_t bytes)
+	{
+		size_t i = 0;
+		for (; i + 128 <= bytes; i += 128)
+		{
+			const __m256i x0 = _mm256_xor_si256(Load(dst + i), Load(src + i));
+			const __m256i x1 = _mm256_xor_si256(Load(dst + i + 32), Load(src + i + 32));
+			const __m256i x2 = _mm256_xor_si256(Load(dst + i + 64), Load(src + i + 64));
+			const __m256i x3 = _mm256_xor_si256(Load(dst + i + 96), Load(src + i + 96));
+			Store(dst + i, x0);
+			Store(dst + i + 32, x1);
+			Store(dst + i + 64, x2);
+			Store(dst + i + 96, x3);
+		}
+		for (; i + 32 <= bytes; i += 32)
+			Store(dst + i, _mm256_xor_si256(Load(dst + i), Load(src + i)));
+		// One 16-byte step keeps the scalar tail under 16 bytes
+		if (i + 16 <= bytes)
+		{
+			const __m128i x = _mm_xor_si128(_mm_loadu_si128(reinterpret_cast<const __m128i*>(dst + i)),
+											_mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i)));
+			_mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i), x);
+			i += 16;
+		}
+		for (; i < bytes; ++i)
+			dst[i] ^= src[i];
+	}
+}
+
+const XorKernels* GetAVX2XorKernels()
+{
+	static const XorKernels kernels = { SimdLevel::AVX2, XorInto };
+	return &kernels;
+}
@@ -0,0 +1,32 @@
+#include "XorKernels.h"
+
+#include <arm_neon.h>
+
+namespace
+{
+	void XorInto(uint8_t* dst, const uint8_t* src, size_t bytes)
+	{
+		size_t i = 0;
+		for (; i + 64 <= bytes; i += 64)
+		{
+			const uint8x16_t x0 = veorq_u8(vld1q_u8(dst + i), vld1q_u8(src + i));
+			const uint8x16_t x1 = veorq_u8(vld1q_u8(dst + i + 16), vld1q_u8(src + i + 16));
+			const uint8x16_t x2 = veorq_u8(vld1q_u8(dst + i + 32), vld1q_u8(src + i + 32));
+			const uint8x16_t x3 = veorq_u8(vld1q_u8(dst + i + 48), vld1q_u8(src + i + 48));
+			vst1q_u8(dst + i, x0);
+			vst1q_u8(dst + i + 16, x1);
+			vst1q_u8(dst + i + 32, x2);
+			vst1q_u8(dst + i + 48, x3);
+		}
+		for (; i + 16 <= bytes; i += 16)
+			vst1q_u8(dst + i, veorq_u8(vld1q_u8(dst + i), vld1q_u8(src + i)));
+		for (; i < bytes; ++i)
+			dst[i] ^= src[i];
+	}
+}
+
+const XorKernels* GetNEONXorKernels()
+{
+	static const XorKernels kernels = { SimdLevel::NEON, XorInto };
+	return &kernels;
+}
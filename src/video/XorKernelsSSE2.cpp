@@ -0,0 +1,42 @@
+#include "XorKernels.h"
+
+#include <emmintrin.h>
+
+namespace
+{
+	inline __m128i Load(const uint8_t* p)
+	{
+		return _mm_loadu_si128(reinterpret_cast<const __m128i*>(p));
+	}
+
+	inline void Store(uint8_t* p, __m128i v)
+	{
+		_mm_storeu_si128(reinterpret_cast<__m128i*>(p), v);
+	}
+
+	void XorInto(uint8_t* dst, const uint8_t* src, size_t bytes)
+	{
+		size_t i = 0;
+		for (; i + 64 <= bytes; i += 64)
+		{
+			const __m128i x0 = _mm_xor_si128(Load(dst + i), Load(src + i));
+			const __m128i x1 = _mm_xor_si128(Load(dst + i + 16), Load(src + i + 16));
+			const __m128i x2 = _mm_xor_si128(Load(dst + i + 32), Load(src + i + 32));
+			const __m128i x3 = _mm_xor_si128(Load(dst + i + 48), Load(src + i + 48));
+			Store(dst + i, x0);
+			Store(dst + i + 16, x1);
+			Store(dst + i + 32, x2);
+			Store(dst + i + 48, x3);
+		}
+		for (; i + 16 <= bytes; i += 16)
+			Store(dst + i, _mm_xor_si128(Load(dst + i), Load(src + i)));
+		for (; i < bytes; ++i)
+			dst[i] ^= src[i];
+	}
+}
+
+const XorKernels* GetSSE2XorKernels()
+{
+	static const XorKernels kernels = { SimdLevel::SSE2, XorInto };
+	return &kernels;
+}
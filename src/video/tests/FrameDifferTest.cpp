@@ -0,0 +1,55 @@
+#include "../FrameDiffer.h"
+#include "capture/IGraphicsCapture.h"
+#include "testing/Test.h"
+
+#include <vector>
+
+namespace
+{
+	constexpr int kWidth = 300; // Not a multiple of the tile size
+	constexpr int kHeight = 200;
+	constexpr int kStride = kWidth * 4;
+}
+
+TEST(FrameDiffer_FirstFrameIsAllChanged)
+{
+	FrameDiffer differ;
+	std::vector<uint8_t> frame(static_cast<size_t>(kStride) * kHeight, 0);
+	std::vector<FrameRect> rects;
+	CHECK(differ.Update(frame.data(), kStride, kWidth, kHeight, nullptr, 0, rects));
+	REQUIRE(rects.size() == 1);
+	CHECK((rects[0] == FrameRect{ 0, 0, kWidth, kHeight }));
+}
+
+TEST(FrameDiffer_ReportsTheChangedTilesOnly)
+{
+	FrameDiffer differ;
+	std::vector<uint8_t> frame(static_cast<size_t>(kStride) * kHeight, 0);
+	std::vector<FrameRect> rects;
+	differ.Update(frame.data(), kStride, kWidth, kHeight, nullptr, 0, rects);
+
+	CHECK(!differ.Update(frame.data(), kStride, kWidth, kHeight, nullptr, 0, rects));
+	CHECK(rects.empty());
+
+	// One pixel in the last, partial tile column and row
+	frame[static_cast<size_t>(kHeight - 1) * kStride + (kWidth - 1) * 4] = 1;
+	CHECK(differ.Update(frame.data(), kStride, kWidth, kHeight, nullptr, 0, rects));
+	REQUIRE(rects.size() == 1);
+	CHECK((rects[0] == FrameRect{ 256, 192, kWidth - 256, kHeight - 192 }));
+}
+
+TEST(FrameDiffer_HintsLimitTheComparison)
+{
+	FrameDiffer differ;
+	std::vector<uint8_t> frame(static_cast<size_t>(kStride) * kHeight, 0);
+	std::vector<FrameRect> rects;
+	differ.Update(frame.data(), kStride, kWidth, kHeight, nullptr, 0, rects);
+
+	// A change outside every hint is not looked for
+	frame[10] = 1;
+	const FrameRect hint = { 200, 100, 10, 10 };
+	CHECK(!differ.Update(frame.data(), kStride, kWidth, kHeight, &hint, 1, rects));
+	CHECK(differ.Update(frame.data(), kStride, kWidth, kHeight, nullptr, 0, rects));
+	REQUIRE(rects.size() == 1);
+	CHECK((rects[0] == FrameRect{ 0, 0, 64, 64 }));
+}
@@ -0,0 +1,242 @@
+#include "../ImageWriter.h"
+#include "testing/Test.h"
+
+#include <cstring>
+#include <random>
+#include <vector>
+
+#ifdef HAVE_ZLIB
+#include <zlib.h>
+#endif
+
+// Round-trips through independent decoders: QOI and BMP are simple enough to
+// decode here, PNG is inflated with zlib when the build found it.
+
+namespace
+{
+	constexpr int kWidth = 77;
+	constexpr int kHeight = 45;
+	constexpr int kStride = kWidth * 4 + 12; // Padded rows must not leak into the file
+
+	// Flat areas, gradients and noise, so every encoder path gets used
+	std::vector<uint8_t> MakeImage()
+	{
+		std::mt19937 random(11);
+		std::vector<uint8_t> image(static_cast<size_t>(kStride) * kHeight, 0xCD);
+		for (int y = 0; y < kHeight; ++y)
+		{
+			for (int x = 0; x < kWidth; ++x)
+			{
+				uint8_t* pixel = image.data() + static_cast<size_t>(y) * kStride + x * 4;
+				if (y < 15)
+					std::memset(pixel, x < 40 ? 0x30 : 0xE0, 3);
+				else if (y < 30)
+				{
+					pixel[0] = static_cast<uint8_t>(x * 3);
+					pixel[1] = static_cast<uint8_t>(y * 5);
+					pixel[2] = static_cast<uint8_t>(x + y);
+				}
+				else
+				{
+					pixel[0] = static_cast<uint8_t>(random());
+					pixel[1] = static_cast<uint8_t>(random());
+					pixel[2] = static_cast<uint8_t>(random());
+				}
+				pixel[3] = static_cast<uint8_t>(random());
+			}
+		}
+		return image;
+	}
+
+	uint32_t BigEndian32(const uint8_t* p)
+	{
+		return static_cast<uint32_t>(p[0]) << 24 | p[1] << 16 | p[2] << 8 | p[3];
+	}
+
+	uint32_t LittleEndian32(const uint8_t* p)
+	{
+		return static_cast<uint32_t>(p[3]) << 24 | p[2] << 16 | p[1] << 8 | p[0];
+	}
+
+	// True when `rgb` (R, G, B per pixel, rows packed) holds the image's colours
+	bool SameColors(const std::vector<uint8_t>& image, const uint8_t* rgb)
+	{
+		for (int y = 0; y < kHeight; ++y)
+		{
+			for (int x = 0; x < kWidth; ++x)
+			{
+				const uint8_t* bgra = image.data() + static_cast<size_t>(y) * kStride + x * 4;
+				const uint8_t* decoded = rgb + (static_cast<size_t>(y) * kWidth + x) * 3;
+				if (decoded[0] != bgra[2] || decoded[1] != bgra[1] || decoded[2] != bgra[0])
+					return false;
+			}
+		}
+		return true;
+	}
+
+	bool DecodeQoi(const std::vector<uint8_t>& file, std::vector<uint8_t>& rgb)
+	{
+		if (file.size() < 22 || std::memcmp(file.data(), "qoif", 4) != 0 || BigEndian32(&file[4]) != kWidth ||
+			BigEndian32(&file[8]) != kHeight)
+			return false;
+
+		uint8_t index[64][3] = {};
+		uint8_t pixel[3] = { 0, 0, 0 };
+		size_t at = 14;
+		int run = 0;
+		rgb.clear();
+		while (rgb.size() < static_cast<size_t>(kWidth) * kHeight * 3)
+		{
+			if (run > 0)
+				--run;
+			else
+			{
+				if (at >= file.size() - 8)
+					return false;
+				const uint8_t op = file[at++];
+				if (op == 0xFE)
+				{
+					std::memcpy(pixel, &file[at], 3);
+					at += 3;
+				}
+				else if ((op & 0xC0) == 0x00)
+					std::memcpy(pixel, index[op], 3);
+				else if ((op & 0xC0) == 0x40)
+				{
+					pixel[0] = static_cast<uint8_t>(pixel[0] + ((op >> 4) & 3) - 2);
+					pixel[1] = static_cast<uint8_t>(pixel[1] + ((op >> 2) & 3) - 2);
+					pixel[2] = static_cast<uint8_t>(pixel[2] + (op & 3) - 2);
+				}
+				else if ((op & 0xC0) == 0x80)
+				{
+					const int dg = (op & 0x3F) - 32;
+					const uint8_t second = file[at++];
+					pixel[0] = static_cast<uint8_t>(pixel[0] + dg + (second >> 4) - 8);
+					pixel[1] = static_cast<uint8_t>(pixel[1] + dg);
+					pixel[2] = static_cast<uint8_t>(pixel[2] + dg + (second & 0x0F) - 8);
+				}
+				else if (op == 0xFF)
+					return false; // RGBA is never written for opaque frames
+				else
+					run = op & 0x3F;
+				std::memcpy(index[(pixel[0] * 3 + pixel[1] * 5 + pixel[2] * 7 + 255 * 11) % 64], pixel, 3);
+			}
+			rgb.insert(rgb.end(), pixel, pixel + 3);
+		}
+		static constexpr uint8_t kEnd[8] = { 0, 0, 0, 0, 0, 0, 0, 1 };
+		return at + 8 == file.size() && std::memcmp(&file[at], kEnd, 8) == 0;
+	}
+}
+
+TEST(ImageWriter_QoiRoundTrip)
+{
+	const std::vector<uint8_t> image = MakeImage();
+	std::vector<uint8_t> file, rgb;
+	ImageWriter::EncodeQoi(image.data(), kStride, kWidth, kHeight, file);
+	REQUIRE(DecodeQoi(file, rgb));
+	CHECK(SameColors(image, rgb.data()));
+}
+
+TEST(ImageWriter_BmpRoundTrip)
+{
+	const std::vector<uint8_t> image = MakeImage();
+	std::vector<uint8_t> file;
+	ImageWriter::EncodeBmp(image.data(), kStride, kWidth, kHeight, file);
+
+	REQUIRE(file.size() == 54 + static_cast<size_t>(kWidth) * kHeight * 4);
+	CHECK(file[0] == 'B' && file[1] == 'M');
+	CHECK(LittleEndian32(&file[10]) == 54);
+	CHECK(LittleEndian32(&file[18]) == kWidth);
+	CHECK(static_cast<int32_t>(LittleEndian32(&file[22])) == -kHeight); // Top-down
+	// BMP keeps the pixels exactly, alpha included
+	for (int y = 0; y < kHeight; ++y)
+		CHECK(std::memcmp(&file[54 + static_cast<size_t>(y) * kWidth * 4], image.data() + static_cast<size_t>(y) * kStride,
+						  kWidth * 4) == 0);
+}
+
+TEST(ImageWriter_PngRoundTrip)
+{
+	const std::vector<uint8_t> image = MakeImage();
+	std::vector<uint8_t> file;
+	ImageWriter::EncodePng(image.data(), kStride, kWidth, kHeight, file);
+
+	static constexpr uint8_t kSignature[8] = { 0x89, 'P', 'N', 'G', '\r', '\n', 0x1A, '\n' };
+	REQUIRE(file.size() > 8 && std::memcmp(file.data(), kSignature, 8) == 0);
+
+	// Walk the chunks, checking each CRC and gathering the zlib stream
+	std::vector<uint8_t> zlibStream;
+	size_t at = 8;
+	bool sawEnd = false;
+	while (at + 12 <= file.size() && !sawEnd)
+	{
+		const uint32_t length = BigEndian32(&file[at]);
+		REQUIRE(at + 12 + length <= file.size());
+		const uint8_t* type = &file[at + 4];
+		const uint8_t* data = &file[at + 8];
+#ifdef HAVE_ZLIB
+		const uint32_t crc = static_cast<uint32_t>(crc32(crc32(0, nullptr, 0), type, length + 4));
+		CHECK(crc == BigEndian32(data + length));
+#endif
+		if (std::memcmp(type, "IHDR", 4) == 0)
+		{
+			CHECK(BigEndian32(data) == kWidth);
+			CHECK(BigEndian32(data + 4) == kHeight);
+			CHECK(data[8] == 8 && data[9] == 2); // 8-bit RGB
+		}
+		else if (std::memcmp(type, "IDAT", 4) == 0)
+			zlibStream.insert(zlibStream.end(), data, data + length);
+		sawEnd = std::memcmp(type, "IEND", 4) == 0;
+		at += 12 + length;
+	}
+	CHECK(sawEnd && at == file.size());
+
+#ifdef HAVE_ZLIB
+	const size_t rowBytes = 1 + static_cast<size_t>(kWidth) * 3;
+	std::vector<uint8_t> filtered(rowBytes * kHeight);
+	uLongf filteredSize = static_cast<uLongf>(filtered.size());
+	REQUIRE(uncompress(filtered.data(), &filteredSize, zlibStream.data(), static_cast<uLong>(zlibStream.size())) == Z_OK);
+	REQUIRE(filteredSize == filtered.size());
+
+	// Undo the per-row filters (PNG spec section 9)
+	std::vector<uint8_t> rgb(static_cast<size_t>(kWidth) * kHeight * 3);
+	for (int y = 0; y < kHeight; ++y)
+	{
+		const uint8_t filter = filtered[y * rowBytes];
+		const uint8_t* in = &filtered[y * rowBytes + 1];
+		uint8_t* out = &rgb[static_cast<size_t>(y) * kWidth * 3];
+		const uint8_t* above = y > 0 ? out - kWidth * 3 : nullptr;
+		REQUIRE(filter <= 4);
+		for (size_t i = 0; i < static_cast<size_t>(kWidth) * 3; ++i)
+		{
+			const int a = i >= 3 ? out[i - 3] : 0;
+			const int b = above ? above[i] : 0;
+			const int c = above && i >= 3 ? above[i - 3] : 0;
+			int predicted = 0;
+			switch (filter)
+			{
+			case 1: predicted = a; break;
+			case 2: predicted = b; break;
+			case 3: predicted = (a + b) / 2; break;
+			case 4:
+			{
+				const int p = a + b - c;
+				const int pa = std::abs(p - a), pb = std::abs(p - b), pc = std::abs(p - c);
+				predicted = pa <= pb && pa <= pc ? a : pb <= pc ? b : c;
+				break;
+			}
+			}
+			out[i] = static_cast<uint8_t>(in[i] + predicted);
+		}
+	}
+	CHECK(SameColors(image, rgb.data()));
+#endif
+}
+
+TEST(ImageWriter_FormatFromPath)
+{
+	ImageFormat format = ImageFormat::Bmp;
+	CHECK(ImageWriter::FormatFromPath("shot.PNG", format) && format == ImageFormat::Png);
+	CHECK(ImageWriter::FormatFromPath("a/b.qoi", format) && format == ImageFormat::Qoi);
+	CHECK(ImageWriter::FormatFromPath("x.bmp", format) && format == ImageFormat::Bmp);
+	CHECK(!ImageWriter::FormatFromPath("x.jpg", format));
+}
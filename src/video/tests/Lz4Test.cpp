@@ -0,0 +1,83 @@
+#include "../Lz4.h"
+#include "testing/Test.h"
+
+#include <random>
+#include <vector>
+
+namespace
+{
+	bool RoundTrips(const std::vector<uint8_t>& data)
+	{
+		std::vector<uint8_t> block;
+		Lz4::Compress(data.data(), data.size(), block);
+		if (block.size() > Lz4::GetMaxCompressedSize(data.size()))
+			return false;
+		std::vector<uint8_t> decoded(data.size());
+		return Lz4::Decompress(block.data(), block.size(), decoded.data(), decoded.size()) && decoded == data;
+	}
+
+	std::vector<uint8_t> Noise(size_t size)
+	{
+		std::mt19937 random(12);
+		std::vector<uint8_t> data(size);
+		for (auto& byte : data)
+			byte = static_cast<uint8_t>(random());
+		return data;
+	}
+}
+
+TEST(Lz4_RoundTripsCompressibleData)
+{
+	// Rows of a flat window with a little text: long matches and short literals
+	std::vector<uint8_t> data;
+	for (int row = 0; row < 200; ++row)
+	{
+		for (int x = 0; x < 256; ++x)
+			data.push_back(static_cast<uint8_t>(x % 37 == row % 37 ? 0x20 : 0xF0));
+	}
+	CHECK(RoundTrips(data));
+
+	std::vector<uint8_t> block;
+	Lz4::Compress(data.data(), data.size(), block);
+	CHECK(block.size() < data.size() / 4);
+}
+
+TEST(Lz4_RoundTripsIncompressibleAndTinyInputs)
+{
+	CHECK(RoundTrips(Noise(100000)));
+	CHECK(RoundTrips(std::vector<uint8_t>(1, 7)));
+	CHECK(RoundTrips(std::vector<uint8_t>(13, 7)));
+	CHECK(RoundTrips(std::vector<uint8_t>(70000, 0)));
+	CHECK(RoundTrips({}));
+}
+
+TEST(Lz4_AppendsToExistingOutput)
+{
+	const std::vector<uint8_t> data = Noise(500);
+	std::vector<uint8_t> out = { 1, 2, 3 };
+	Lz4::Compress(data.data(), data.size(), out);
+	std::vector<uint8_t> decoded(data.size());
+	CHECK(out[0] == 1 && out[1] == 2 && out[2] == 3);
+	CHECK(Lz4::Decompress(out.data() + 3, out.size() - 3, decoded.data(), decoded.size()) && decoded == data);
+}
+
+TEST(Lz4_RejectsCorruptOrTruncatedBlocks)
+{
+	std::vector<uint8_t> data(4096, 0x55);
+	data[1000] = 1;
+	std::vector<uint8_t> block;
+	Lz4::Compress(data.data(), data.size(), block);
+	std::vector<uint8_t> decoded(data.size());
+
+	CHECK(!Lz4::Decompress(block.data(), block.size() - 1, decoded.data(), decoded.size()));
+	CHECK(!Lz4::Decompress(block.data(), block.size(), decoded.data(), decoded.size() - 1));
+	CHECK(!Lz4::Decompress(block.data(), block.size(), decoded.data(), decoded.size() + 1));
+
+	// Every single-byte corruption either fails or stays inside the output
+	for (size_t i = 0; i < block.size(); ++i)
+	{
+		std::vector<uint8_t> corrupt = block;
+		corrupt[i] ^= 0xFF;
+		Lz4::Decompress(corrupt.data(), corrupt.size(), decoded.data(), decoded.size());
+	}
+}
@@ -0,0 +1,233 @@
+#include "../BlendKernels.h"
+#include "../ColorKernels.h"
+#include "../CpuFeatures.h"
+#include "../DiffKernels.h"
+#include "../PngFilterKernels.h"
+#include "../ScalerKernels.h"
+#include "../XorKernels.h"
+#include "testing/Test.h"
+
+#include <cstring>
+#include <initializer_list>
+#include <random>
+#include <vector>
+
+// Every SIMD kernel this CPU can run must produce the same bytes as the
+// scalar kernel of its table, which is what the rest of the tree relies on
+// when it picks the widest one at runtime.
+
+namespace
+{
+	template <typename Table>
+	std::vector<const Table*> RunnableTables(std::initializer_list<const Table* (*)()> getters)
+	{
+		std::vector<const Table*> tables;
+		for (auto getter : getters)
+		{
+			const Table* table = getter();
+			if (table && CpuFeatures::Supports(table->level))
+				tables.push_back(table);
+		}
+		return tables;
+	}
+
+	std::vector<uint8_t> RandomBytes(size_t size, uint32_t seed)
+	{
+		std::mt19937 random(seed);
+		std::vector<uint8_t> bytes(size);
+		for (auto& byte : bytes)
+			byte = static_cast<uint8_t>(random());
+		return bytes;
+	}
+
+	// BT.709 limited range in the fixed point of ColorKernels.h
+	constexpr ColorCoefficients kBt709 = {
+		{ 1016, 10074, 2991, 1056 },
+		{ 7196, -5548, -1648, 8224 },
+		{ -659, -6537, 7196, 8224 },
+	};
+}
+
+TEST(ColorKernels_MatchScalar)
+{
+	const ColorKernels& scalar = *GetScalarColorKernels();
+	const auto tables = RunnableTables({ GetSSE2ColorKernels, GetAVX2ColorKernels, GetAVX512ColorKernels, GetNEONColorKernels });
+#if defined(VIDEO_ARCH_X86) || defined(VIDEO_ARCH_ARM64)
+	CHECK(!tables.empty()); // SSE2 and NEON are baseline
+#endif
+	for (const ColorKernels* kernels : tables)
+	{
+		for (int width : { kernels->pixelsPerIteration, kernels->pixelsPerIteration * 5, 1920 - 1920 % kernels->pixelsPerIteration })
+		{
+			const std::vector<uint8_t> row0 = RandomBytes(static_cast<size_t>(width) * 4, 1);
+			const std::vector<uint8_t> row1 = RandomBytes(static_cast<size_t>(width) * 4, 2);
+			const size_t chroma = static_cast<size_t>(width) / 2;
+
+			std::vector<uint8_t> expected(width), actual(width);
+			scalar.rowToPlane(row0.data(), expected.data(), width, kBt709.y);
+			kernels->rowToPlane(row0.data(), actual.data(), width, kBt709.y);
+			CHECK(expected == actual);
+
+			std::vector<uint8_t> expectedU(chroma), expectedV(chroma), actualU(chroma), actualV(chroma);
+			scalar.rowPairToChroma(row0.data(), row1.data(), expectedU.data(), expectedV.data(), width, kBt709);
+			kernels->rowPairToChroma(row0.data(), row1.data(), actualU.data(), actualV.data(), width, kBt709);
+			CHECK(expectedU == actualU);
+			CHECK(expectedV == actualV);
+
+			std::vector<uint8_t> expectedUv(chroma * 2), actualUv(chroma * 2);
+			scalar.rowPairToChromaInterleaved(row0.data(), row1.data(), expectedUv.data(), width, kBt709);
+			kernels->rowPairToChromaInterleaved(row0.data(), row1.data(), actualUv.data(), width, kBt709);
+			CHECK(expectedUv == actualUv);
+		}
+	}
+}
+
+TEST(ScalerKernels_MatchScalar)
+{
+	const ScalerKernels& scalar = *GetScalarScalerKernels();
+	const auto tables = RunnableTables({ GetSSE2ScalerKernels, GetAVX2ScalerKernels, GetNEONScalerKernels });
+	std::mt19937 random(3);
+	for (const ScalerKernels* kernels : tables)
+	{
+		// A 6-tap filter with Lanczos-like negative lobes, summing to 1 << 14
+		constexpr int taps = 6;
+		constexpr int16_t kWeights[taps] = { -700, 2300, 6592, 6592, 2300, -700 };
+		constexpr int srcWidth = 1000;
+		constexpr int dstWidth = 333;
+		const std::vector<uint8_t> src = RandomBytes(static_cast<size_t>(srcWidth) * 4, 4);
+		std::vector<int> starts(dstWidth);
+		std::vector<int16_t> weights;
+		for (int x = 0; x < dstWidth; ++x)
+		{
+			starts[x] = std::min(x * srcWidth / dstWidth, srcWidth - taps);
+			weights.insert(weights.end(), kWeights, kWeights + taps);
+		}
+		std::vector<int16_t> expected(dstWidth * 4), actual(dstWidth * 4);
+		scalar.horizontal(src.data(), expected.data(), dstWidth, starts.data(), weights.data(), taps);
+		kernels->horizontal(src.data(), actual.data(), dstWidth, starts.data(), weights.data(), taps);
+		CHECK(expected == actual);
+
+		// Vertical pass over intermediates that overshoot 0-255 both ways
+		const int values = kernels->verticalStep * 40;
+		std::vector<std::vector<int16_t>> rowStorage(taps, std::vector<int16_t>(values));
+		std::vector<const int16_t*> rows;
+		for (auto& row : rowStorage)
+		{
+			for (auto& value : row)
+				value = static_cast<int16_t>(static_cast<int>(random() % 18000) - 1000);
+			rows.push_back(row.data());
+		}
+		std::vector<uint8_t> expectedBytes(values), actualBytes(values);
+		scalar.vertical(rows.data(), kWeights, taps, expectedBytes.data(), 0, values);
+		kernels->vertical(rows.data(), kWeights, taps, actualBytes.data(), 0, values);
+		CHECK(expectedBytes == actualBytes);
+
+		const int boxPixels = kernels->boxStep * 30;
+		std::vector<std::vector<uint8_t>> boxRows;
+		std::vector<const uint8_t*> boxPointers;
+		for (uint32_t i = 0; i < 4; ++i)
+		{
+			boxRows.push_back(RandomBytes(static_cast<size_t>(boxPixels) * 4 * 4, 10 + i));
+			boxPointers.push_back(boxRows.back().data());
+		}
+		std::vector<uint8_t> expectedBox(static_cast<size_t>(boxPixels) * 4), actualBox(expectedBox.size());
+		scalar.box2(boxPointers[0], boxPointers[1], expectedBox.data(), 0, boxPixels);
+		kernels->box2(boxPointers[0], boxPointers[1], actualBox.data(), 0, boxPixels);
+		CHECK(expectedBox == actualBox);
+		scalar.box4(boxPointers.data(), expectedBox.data(), 0, boxPixels);
+		kernels->box4(boxPointers.data(), actualBox.data(), 0, boxPixels);
+		CHECK(expectedBox == actualBox);
+	}
+}
+
+TEST(DiffKernels_MatchScalar)
+{
+	const DiffKernels& scalar = *GetScalarDiffKernels();
+	const auto tables = RunnableTables({ GetSSE2DiffKernels, GetAVX2DiffKernels, GetNEONDiffKernels });
+	const std::vector<uint8_t> a = RandomBytes(256, 5);
+	for (const DiffKernels* kernels : tables)
+	{
+		for (size_t bytes : { size_t(4), size_t(60), size_t(64), size_t(100), size_t(256) })
+		{
+			CHECK(kernels->equal(a.data(), a.data(), bytes));
+			// A difference at any position, including the last byte of a tail
+			for (size_t at = 0; at < bytes; ++at)
+			{
+				std::vector<uint8_t> b = a;
+				b[at] ^= 0x01;
+				CHECK(kernels->equal(a.data(), b.data(), bytes) == scalar.equal(a.data(), b.data(), bytes));
+			}
+		}
+	}
+}
+
+TEST(XorKernels_MatchScalar)
+{
+	const XorKernels& scalar = *GetScalarXorKernels();
+	const auto tables = RunnableTables({ GetSSE2XorKernels, GetAVX2XorKernels, GetNEONXorKernels });
+	const std::vector<uint8_t> src = RandomBytes(1500, 6);
+	for (const XorKernels* kernels : tables)
+	{
+		for (size_t bytes : { size_t(1), size_t(127), size_t(128), size_t(1200), size_t(1500) })
+		{
+			std::vector<uint8_t> expected = RandomBytes(bytes, 7);
+			std::vector<uint8_t> actual = expected;
+			scalar.xorInto(expected.data(), src.data(), bytes);
+			kernels->xorInto(actual.data(), src.data(), bytes);
+			CHECK(expected == actual);
+		}
+	}
+}
+
+TEST(BlendKernels_MatchScalar)
+{
+	const auto tables = RunnableTables({ GetScalarBlendKernels, GetSSE2BlendKernels, GetAVX2BlendKernels, GetNEONBlendKernels });
+	std::mt19937 random(8);
+	constexpr int count = 1027;
+	std::vector<uint32_t> src(count), dst(count);
+	for (int i = 0; i < count; ++i)
+	{
+		// Premultiplied: no channel above alpha
+		const uint32_t alpha = random() % 256;
+		uint32_t pixel = alpha << 24;
+		for (int shift = 0; shift < 24; shift += 8)
+			pixel |= (alpha ? random() % (alpha + 1) : 0) << shift;
+		src[i] = pixel;
+		dst[i] = random();
+	}
+	std::vector<uint32_t> expected(count);
+	for (int i = 0; i < count; ++i)
+		expected[i] = BlendPixelOver(dst[i], src[i]);
+
+	for (const BlendKernels* kernels : tables)
+	{
+		std::vector<uint32_t> actual = dst;
+		kernels->blendRow(actual.data(), src.data(), count);
+		CHECK(expected == actual);
+	}
+}
+
+TEST(PngFilterKernels_MatchScalar)
+{
+	const PngFilterKernels& scalar = *GetScalarPngFilterKernels();
+	const auto tables = RunnableTables({ GetSSE2PngFilterKernels, GetAVX2PngFilterKernels, GetNEONPngFilterKernels });
+	for (size_t bytes : { size_t(3), size_t(48), size_t(3 * 333), size_t(3 * 1920) })
+	{
+		const std::vector<uint8_t> row = RandomBytes(bytes, 9);
+		const std::vector<uint8_t> previous = RandomBytes(bytes, 10);
+		std::vector<uint8_t> sub(bytes), up(bytes), paeth(bytes);
+		uint32_t sums[4] = {};
+		scalar.filterRow(row.data(), previous.data(), bytes, sub.data(), up.data(), paeth.data(), sums);
+		for (const PngFilterKernels* kernels : tables)
+		{
+			std::vector<uint8_t> actualSub(bytes), actualUp(bytes), actualPaeth(bytes);
+			uint32_t actualSums[4] = {};
+			kernels->filterRow(row.data(), previous.data(), bytes, actualSub.data(), actualUp.data(), actualPaeth.data(),
+							   actualSums);
+			CHECK(sub == actualSub);
+			CHECK(up == actualUp);
+			CHECK(paeth == actualPaeth);
+			CHECK(std::memcmp(sums, actualSums, sizeof(sums)) == 0);
+		}
+	}
+}